@@ -0,0 +1,77 @@
+/*
+ * This file is part of the 3steppers project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "closedloop.h"
+
+// start of new move (not corrective)
+void cl_start(cl_state *c){
+    c->maxerr = 0;
+    c->corr = 0;
+    c->tries = 0;
+    c->stalled = 0;
+}
+
+/**
+ * @brief cl_step - check following error after next full step
+ * @param c - state
+ * @param stppos - commanded position (steps)
+ * @param encpos - encoder position (ticks)
+ * @param encperstep - encoder ticks per step
+ * @param maxcorr - max total correction per move (steps)
+ * @return amount of lost steps: should be substracted from `stppos`
+ */
+int32_t cl_step(cl_state *c, int32_t stppos, int32_t encpos, int32_t encperstep, uint16_t maxcorr){
+    int32_t err = stppos * encperstep - encpos;
+    c->err = err;
+    if(err < 0) err = -err;
+    if(err > c->maxerr) c->maxerr = err;
+    if(c->stalled || err <= CL_LAGMAX * encperstep) return 0;
+    int32_t lost = c->err / encperstep; // only whole steps, rest is lag
+    err /= encperstep;
+    if(c->corr + err > maxcorr){
+        c->stalled = 1;
+        return 0;
+    }
+    c->corr += err;
+    ++c->slips;
+    c->err -= lost * encperstep;
+    return lost;
+}
+
+/**
+ * @brief cl_final - check position after stop
+ * @param c - state
+ * @param targpos - target position (steps)
+ * @param encpos - encoder position (ticks)
+ * @param encperstep - encoder ticks per step
+ * @param tolerance - max allowed error (ticks)
+ * @param maxcorr - max total correction per move (steps)
+ * @return amount of steps to move (0 if position is good or correction isn't possible)
+ */
+int32_t cl_final(cl_state *c, int32_t targpos, int32_t encpos, int32_t encperstep, uint16_t tolerance, uint16_t maxcorr){
+    int32_t err = targpos * encperstep - encpos;
+    c->final = err;
+    if(err < 0) err = -err;
+    if(err <= tolerance || c->stalled) return 0;
+    int32_t steps = (c->final + (c->final < 0 ? -encperstep/2 : encperstep/2)) / encperstep;
+    err = (steps < 0) ? -steps : steps;
+    if(steps == 0 || c->tries >= CL_MAXTRIES || c->corr + err > maxcorr) return 0;
+    ++c->tries;
+    c->corr += err;
+    return steps;
+}
@@ -0,0 +1,54 @@
+/*
+ * This file is part of the 3steppers project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef CLOSEDLOOP_H__
+#define CLOSEDLOOP_H__
+
+#include <stdint.h>
+
+/*
+ * Closed-loop position correction by encoder (hardware-independent).
+ * cl_step() is called from step interrupt on each full step and checks following error
+ * (commanded position minus encoder position, encoder ticks). Lag up to CL_LAGMAX steps is
+ * normal (load angle), greater error means lost steps: their amount is returned as correction
+ * of step counter, so motor makes them once more. Total correction per move is limited by `maxcorr`,
+ * when limit is exceeded motor is marked as stalled.
+ * cl_final() after stop returns residual error (in steps) to correct by slow move.
+ */
+
+// max lag of normally moving motor (full steps)
+#define CL_LAGMAX       (2)
+// max amount of corrective moves after stop
+#define CL_MAXTRIES     (3)
+
+typedef struct{
+    int32_t err;        // last following error (encoder ticks)
+    int32_t maxerr;     // max |err| during current move
+    int32_t final;      // error after last stop (encoder ticks)
+    uint32_t slips;     // amount of slips (from start)
+    uint16_t corr;      // steps corrected during current move
+    uint8_t tries;      // corrective moves after stop
+    uint8_t stalled;    // 1 - correction limit exceeded
+} cl_state;
+
+void cl_start(cl_state *c);
+int32_t cl_step(cl_state *c, int32_t stppos, int32_t encpos, int32_t encperstep, uint16_t maxcorr);
+int32_t cl_final(cl_state *c, int32_t targpos, int32_t encpos, int32_t encperstep, uint16_t tolerance, uint16_t maxcorr);
+
+#endif // CLOSEDLOOP_H__
@@ -0,0 +1,201 @@
+/*
+ * This file is part of the 3steppers project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host simulator of closed-loop correction (../closedloop.c): stepper motor with load angle lag,
+// slips by 4 full steps (one electrical period), blocked rotor and noisy encoder. Steps are made
+// as in addmicrostep(), corrective moves after stop - as in chkstepper().
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+#include "../closedloop.h"
+
+#define ENCPERSTEP  (20)
+#define TOLERANCE   (10)
+#define MAXMOVE     (5000)
+
+typedef struct{
+    int32_t phase;      // steps really made by driver (coils' phase)
+    double slip;        // rotor lag by slips (steps)
+    double lag;         // load angle (steps)
+    double pslip;       // probability of slip on each step
+    int32_t blockat;    // rotor is blocked after this amount of steps (<0 - never)
+    double blockpos;    // position of blocked rotor
+    int32_t nsteps;     // steps made in current move
+} motor_t;
+
+static double rotor(const motor_t *m){
+    return m->phase - m->slip - m->lag;
+}
+
+static int32_t encoder(const motor_t *m){
+    return (int32_t)floor(rotor(m) * ENCPERSTEP + 0.5) + (int32_t)(lrand48() % 3) - 1;
+}
+
+// one step of driver: motor moves, firmware checks following error; @return 1 if stalled
+static int dostep(motor_t *m, cl_state *c, int32_t *stppos, int8_t dir, uint16_t maxcorr){
+    m->phase += dir;
+    ++m->nsteps;
+    if(m->blockat > -1 && m->nsteps >= m->blockat){
+        if(m->nsteps == m->blockat) m->blockpos = rotor(m);
+        m->slip = m->phase - m->lag - m->blockpos;
+    }else{
+        m->lag = dir * (0.3 + 1.2 * drand48()); // load angle of moving motor
+        if(drand48() < m->pslip) m->slip += 4 * dir;
+    }
+    *stppos += dir;
+    *stppos -= cl_step(c, *stppos, encoder(m), ENCPERSTEP, maxcorr);
+    return c->stalled;
+}
+
+// move to `targ` like addmicrostep(); @return 1 if stalled
+static int move(motor_t *m, cl_state *c, int32_t *stppos, int32_t targ, uint16_t maxcorr){
+    int8_t dir = (targ > *stppos) ? 1 : -1;
+    m->nsteps = 0;
+    while(dir > 0 ? *stppos < targ : *stppos > targ){
+        if(dostep(m, c, stppos, dir, maxcorr)) break;
+        if(m->nsteps > 4 * MAXMOVE) return 1; // never reach target
+    }
+    m->lag = 0.; // motor stopped
+    return c->stalled;
+}
+
+typedef struct{
+    int32_t final;      // |final error|, ticks
+    int32_t openloop;   // |error| without correction, steps
+    int stalled;
+    int slips;
+    int corr;
+    int tries;
+} result_t;
+
+// full move with corrections after stop (like chkstepper)
+static void fullmove(motor_t *m, int32_t start, int32_t targ, uint16_t maxcorr, result_t *r){
+    cl_state c;
+    memset(&c, 0, sizeof(c));
+    memset(r, 0, sizeof(result_t));
+    int32_t stppos = start;
+    double pslip = m->pslip;
+    m->phase = start; m->slip = 0.; m->lag = 0.;
+    cl_start(&c);
+    r->stalled = move(m, &c, &stppos, targ, maxcorr);
+    r->openloop = labs(lround(m->slip));
+    int32_t s;
+    m->pslip = 0.; // corrective moves are slow
+    while(!r->stalled && (s = cl_final(&c, targ, encoder(m), ENCPERSTEP, TOLERANCE, maxcorr))){
+        stppos = (int32_t)lround((double)encoder(m) / ENCPERSTEP); // getpos()
+        r->stalled = move(m, &c, &stppos, stppos + s, maxcorr);
+    }
+    m->pslip = pslip;
+    cl_final(&c, targ, encoder(m), ENCPERSTEP, TOLERANCE, maxcorr);
+    r->final = labs(c.final);
+    r->slips = c.slips;
+    r->corr = c.corr;
+    r->tries = c.tries;
+}
+
+#define NMOVES  (2000)
+
+static int32_t randtarget(int32_t start){
+    int32_t d = 1 + lrand48() % MAXMOVE;
+    return (lrand48() & 1) ? start + d : start - d;
+}
+
+// lag only: no corrections
+static int chklag(){
+    motor_t m = {.pslip = 0., .blockat = -1};
+    result_t r;
+    int bad = 0, badfinal = 0;
+    for(int i = 0; i < NMOVES; ++i){
+        int32_t start = lrand48() % 100000 - 50000;
+        fullmove(&m, start, randtarget(start), 100, &r);
+        if(r.slips || r.corr || r.stalled) ++bad;
+        if(r.final > TOLERANCE) ++badfinal;
+    }
+    if(bad) printf("%d false corrections\n", bad);
+    if(badfinal) printf("%d bad final positions\n", badfinal);
+    return chkfail("lag only", bad || badfinal);
+}
+
+// random slips: final position should be right
+static int chkslips(){
+    motor_t m = {.pslip = 1./500., .blockat = -1};
+    result_t r;
+    int badfinal = 0, stalled = 0, maxtries = 0;
+    long openloop = 0, nslips = 0;
+    for(int i = 0; i < NMOVES; ++i){
+        int32_t start = lrand48() % 100000 - 50000;
+        fullmove(&m, start, randtarget(start), 200, &r);
+        if(r.stalled){ ++stalled; continue; }
+        if(r.final > TOLERANCE) ++badfinal;
+        if(r.tries > maxtries) maxtries = r.tries;
+        openloop += r.openloop;
+        nslips += r.slips;
+    }
+    printf("%ld slips, open-loop error %ld steps, max corrective moves: %d\n", nslips, openloop, maxtries);
+    if(stalled) printf("%d moves stalled\n", stalled);
+    if(badfinal) printf("%d bad final positions\n", badfinal);
+    return chkfail("slips", badfinal || stalled || nslips == 0);
+}
+
+// blocked rotor: should stop after `maxcorr` corrections
+static int chkblock(){
+    motor_t m = {.pslip = 0.};
+    result_t r;
+    int bad = 0;
+    for(int i = 0; i < NMOVES; ++i){
+        uint16_t maxcorr = 10 + lrand48() % 200;
+        m.blockat = lrand48() % 1000;
+        int32_t start = lrand48() % 100000 - 50000;
+        int32_t targ = (lrand48() & 1) ? start + 2000 : start - 2000;
+        fullmove(&m, start, targ, maxcorr, &r);
+        // after blocking driver can make not more than maxcorr+lag steps
+        int32_t over = m.nsteps - m.blockat;
+        if(!r.stalled || r.corr > maxcorr || over > maxcorr + CL_LAGMAX + 2){
+            if(!bad) printf("maxcorr=%d, blockat=%d: stalled=%d, corr=%d, steps after block=%d\n",
+                maxcorr, m.blockat, r.stalled, r.corr, over);
+            ++bad;
+        }
+    }
+    return chkfail("blocked", bad);
+}
+
+// too many slips: stall instead of endless correction
+static int chkbudget(){
+    motor_t m = {.pslip = 1./50., .blockat = -1};
+    result_t r;
+    int bad = 0;
+    for(int i = 0; i < NMOVES/10; ++i){
+        fullmove(&m, 0, MAXMOVE, 20, &r);
+        if(r.corr > 20 || (!r.stalled && r.final > TOLERANCE)) ++bad;
+    }
+    return chkfail("budget", bad);
+}
+
+int main(int argc, char **argv){
+    hosttest_opts(argc, argv);
+    int ret = chklag();
+    ret |= chkslips();
+    ret |= chkblock();
+    ret |= chkbudget();
+    return hosttest_result(ret);
+}
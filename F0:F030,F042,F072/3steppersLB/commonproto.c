@@ -307,6 +307,26 @@ static errcodes eswreactparser(uint8_t par, int32_t *val){
     return ERR_OK;
 }
 
+static errcodes cltolparser(uint8_t par, int32_t *val){
+    uint8_t n; CHECKN(n, par);
+    if(ISSETTER(par)){
+        if(*val < 0 || *val > 0xffff) return ERR_BADVAL;
+        the_conf.cltolerance[n] = *val;
+    }
+    *val = the_conf.cltolerance[n];
+    return ERR_OK;
+}
+
+static errcodes clmaxcorrparser(uint8_t par, int32_t *val){
+    uint8_t n; CHECKN(n, par);
+    if(ISSETTER(par)){
+        if(*val < 0 || *val > 0xffff) return ERR_BADVAL;
+        the_conf.clmaxcorr[n] = *val;
+    }
+    *val = the_conf.clmaxcorr[n];
+    return ERR_OK;
+}
+
 static errcodes saveconfparser(uint8_t _U_ par, int32_t _U_ *val){
     NOPARCHK();
     if(store_userconf()) return ERR_CANTRUN;
@@ -385,6 +405,12 @@ static errcodes setposparser(uint8_t par, int32_t *val){
     return ret;
 }
 
+static errcodes followerrparser(uint8_t par, int32_t *val){
+    uint8_t n; CHECKN(n, par);
+    *val = getclstate(n)->err;
+    return ERR_OK;
+}
+
 static errcodes gotozeroparser(uint8_t par, _U_ int32_t *val){
     uint8_t n; CHECKN(n, par);
     return motor_goto0(n);
@@ -425,6 +451,8 @@ const fpointer cmdlist[CMD_AMOUNT] = {
     [CMD_ENCREV] = encrevparser,
     [CMD_MOTFLAGS] = motflagsparser,
     [CMD_ESWREACT] = eswreactparser,
+    [CMD_CLTOLERANCE] = cltolparser,
+    [CMD_CLMAXCORR] = clmaxcorrparser,
     // motor's commands
     [CMD_ABSPOS] = curposparser,
     [CMD_RELPOS] = relstepsparser,
@@ -437,6 +465,7 @@ const fpointer cmdlist[CMD_AMOUNT] = {
     [CMD_ENCPOS] = encposparser,
     [CMD_SETPOS] = setposparser,
     [CMD_GOTOZERO] = gotozeroparser,
+    [CMD_FOLLOWERR] = followerrparser,
 };
 
 
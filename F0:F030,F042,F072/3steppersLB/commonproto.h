@@ -88,6 +88,9 @@ enum{
     ,CMD_MOTORSTATE         // motor state
     ,CMD_ENCPOS             // position of encoder (independing on settings)
     ,CMD_SETPOS             // set motor position
+    ,CMD_CLTOLERANCE        // closed-loop: max final error (encoder ticks)
+    ,CMD_CLMAXCORR          // closed-loop: max corrected steps per move
+    ,CMD_FOLLOWERR          // closed-loop: last following error (encoder ticks)
     //,CMD_STOPDECEL
     //,CMD_FINDZERO
     // should be the last:
@@ -50,6 +50,8 @@ static uint32_t maxCnum = 1024 / sizeof(user_conf); // can't use blocksize here
     ,.encperstepmax = {23,23,23}            \
     ,.motflags = {DEFMF,DEFMF,DEFMF}        \
     ,.ESW_reaction = {ESW_IGNORE, ESW_IGNORE, ESW_IGNORE} \
+    ,.cltolerance = {10, 10, 10}            \
+    ,.clmaxcorr = {100, 100, 100}           \
     }
 static int erase_flash(const void*, const void*);
 static int write2flash(const void*, const void*, uint32_t);
@@ -221,6 +223,10 @@ void dump_userconf(_U_ char *txt){
         printuhex(*((uint8_t*)&the_conf.motflags[i]));
         PROPNAME("eswreaction");
         printu(the_conf.ESW_reaction[i]);
+        PROPNAME("cltolerance");
+        printu(the_conf.cltolerance[i]);
+        PROPNAME("clmaxcorr");
+        printu(the_conf.clmaxcorr[i]);
 #undef PROPNAME
     }
     NL();
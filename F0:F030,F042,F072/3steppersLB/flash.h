@@ -52,6 +52,7 @@ typedef struct{
     uint8_t donthold : 1;       // bit3 - clear power @ stop (don't hold motor when stopped)
     uint8_t eswinv : 1;         // bit4 - inverse end-switches
     uint8_t keeppos : 1;        // bit5 - keep current position (as servo motor)
+    uint8_t closedloop : 1;     // bit6 - correct lost steps by encoder
 } motflags_t;
 
 /*
@@ -71,6 +72,8 @@ typedef struct __attribute__((packed, aligned(4))){
     uint16_t encperstepmax[MOTORSNO]; // max amount of encoder ticks per one step
     motflags_t motflags[MOTORSNO];  // motor's flags
     uint8_t ESW_reaction[MOTORSNO]; // end-switches reaction (esw_react)
+    uint16_t cltolerance[MOTORSNO]; // closed-loop: max position error after stop (encoder ticks)
+    uint16_t clmaxcorr[MOTORSNO];   // closed-loop: max amount of corrected steps per move
 } user_conf;
 
 extern user_conf the_conf; // global user config (read from FLASH to RAM)
@@ -73,6 +73,15 @@ static mvto0state mvzerostate[MOTORSNO];
 
 static int8_t Nstalled[MOTORSNO] = {0}; // counter of STALL
 
+// closed-loop state
+static cl_state clstate[MOTORSNO];
+// amount of slips @ last check
+static uint32_t clslips[MOTORSNO] = {0};
+// ==1 when move was started and its result should be checked after stop
+static uint8_t clcheck[MOTORSNO] = {0};
+// ==1 for corrective move (don't clear counters)
+static uint8_t clcorrmove[MOTORSNO] = {0};
+
 // lowest ARR value (highest speed), highest (lowest speed)
 //static uint16_t stphighARR[MOTORSNO];
 // microsteps=1<<ustepsshift
@@ -120,9 +129,20 @@ void init_steppers(){
 
 // get absolute position by encoder
 int32_t encoder_position(uint8_t i){
-    int32_t pos = encpos[i];
-    if(the_conf.motflags[i].encreverse) pos -= enctimers[i]->CNT;
-    else pos += enctimers[i]->CNT;
+    int32_t pos, cnt;
+    uint32_t uif;
+    do{ // repeat if overflow happened while reading
+        pos = encpos[i];
+        uif = enctimers[i]->SR & TIM_SR_UIF;
+        cnt = enctimers[i]->CNT;
+    }while(pos != encpos[i] || uif != (enctimers[i]->SR & TIM_SR_UIF));
+    if(uif){ // overflow isn't processed yet (e.g. we are in step interrupt)
+        int32_t add = (cnt < the_conf.encrev[i]/2) ? the_conf.encrev[i] : -the_conf.encrev[i];
+        if(the_conf.motflags[i].encreverse) pos -= add;
+        else pos += add;
+    }
+    if(the_conf.motflags[i].encreverse) pos -= cnt;
+    else pos += cnt;
     return pos;
 }
 
@@ -258,6 +278,10 @@ errcodes motor_absmove(uint8_t i, int32_t newpos){
         return ERR_CANTRUN; // on end-switch
     }
     Nstalled[i] = (state[i] == STP_STALL) ? -(NSTALLEDMAX*4) : 0; // give some more chances to go out of stall state
+    if(!clcorrmove[i]) cl_start(&clstate[i]);
+    clcorrmove[i] = 0;
+    clslips[i] = clstate[i].slips;
+    clcheck[i] = the_conf.motflags[i].closedloop;
     stopflag[i] = 0;
     targstppos[i] = newpos;
     prevencpos[i] = encoder_position(i);
@@ -317,6 +341,14 @@ void addmicrostep(uint8_t i){
     if(++microsteps[i] == the_conf.microsteps[i]){
         microsteps[i] = 0;
         stppos[i] += motdir[i];
+        if(the_conf.motflags[i].closedloop && the_conf.motflags[i].haveencoder){
+            // correct lost steps: motor will make them once more
+            stppos[i] -= cl_step(&clstate[i], stppos[i], encoder_position(i), encperstep[i], the_conf.clmaxcorr[i]);
+            if(clstate[i].stalled){
+                stopflag[i] = 1;
+                stallflags[i] = STALL_STOP;
+            }
+        }
         uint8_t stop_at_pos = 0;
         if(motdir[i] > 0){
             if(stppos[i] >= targstppos[i]){ // reached stop position
@@ -361,6 +393,34 @@ void encoders_UPD(uint8_t i){
 // @return 0 if moving OK,
 static t_stalled chkSTALL(uint8_t i){
     if(!the_conf.motflags[i].haveencoder) return STALL_NO;
+    if(the_conf.motflags[i].closedloop){ // lost steps are checked in step interrupt
+        if(clstate[i].stalled == 1){ // correction limit exceeded
+            clstate[i].stalled = 2; // show message once
+#ifdef EBUG
+            SEND("MOTOR"); bufputchar('0'+i); SEND(" corrected "); printu(clstate[i].corr);
+            SEND(" steps  ---  STALL!");
+#else
+            SEND("ERRCODE="); bufputchar(ERR_CANTRUN+'0');
+            SEND("\nstate"); bufputchar(i+'0'); bufputchar('=');
+            bufputchar(STP_STALL + '0');
+#endif
+            NL();
+            stalleddir[i] = motdir[i];
+            return STALL_STOP;
+        }
+        if(clstate[i].slips != clslips[i]){ // steps lost: decrease speed
+            clslips[i] = clstate[i].slips;
+            uint16_t spd = curspeed[i] >> 1;
+            curspeed[i] = (spd > the_conf.minspd[i]) ? spd : the_conf.minspd[i];
+            calcacceleration(i);
+#ifdef EBUG
+            SEND("MOTOR"); bufputchar('0'+i); SEND(" slip, err="); printi(clstate[i].err);
+            SEND(", newspeed="); printu(curspeed[i]); NL();
+#endif
+            return STALL_ONCE;
+        }
+        return STALL_NO;
+    }
     int32_t curencpos = encoder_position(i), Denc = curencpos - prevencpos[i];
     int32_t curstppos = stppos[i], Dstp = curstppos - prevstppos[i];
     int difsign = 1;
@@ -461,6 +521,22 @@ static void chkstepper(int i){
 #endif
                     stppos[i] = i32;
                 }
+                if(clcheck[i]){ // move is over: check final position
+                    clcheck[i] = 0;
+                    if(mvzerostate[i] == M0RELAX){
+                        i32 = cl_final(&clstate[i], targstppos[i], encoder_position(i),
+                                       encperstep[i], the_conf.cltolerance[i], the_conf.clmaxcorr[i]);
+                        if(i32){
+#ifdef EBUG
+                            SEND("MOTOR"); bufputchar('0'+i);
+                            SEND(" final err="); printi(clstate[i].final); SEND(", correct by "); printi(i32); NL();
+#endif
+                            clcorrmove[i] = 1;
+                            if(ERR_OK == motor_relslow(i, i32)) break;
+                            clcorrmove[i] = 0;
+                        }
+                    }
+                }
                 if(the_conf.motflags[i].keeppos){ // keep old position
                     diff = targstppos[i] - i32; // check whether we need to change position
                     if(diff){ // try to correct position
@@ -640,6 +716,11 @@ void process_steppers(){
     }
 }
 
+// closed-loop state (for telemetry)
+const cl_state *getclstate(uint8_t i){
+    return &clstate[i];
+}
+
 uint8_t geteswreact(uint8_t i){
     return ESW_reaction[i];
 }
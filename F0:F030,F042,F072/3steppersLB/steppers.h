@@ -21,6 +21,7 @@
 #define STEPPERS_H__
 
 #include <stm32f0.h>
+#include "closedloop.h"
 #include "commonproto.h"
 
 #ifndef FALSE
@@ -76,6 +77,7 @@ errcodes motor_relslow(uint8_t i, int32_t relsteps);
 errcodes motor_goto0(uint8_t i);
 
 uint8_t geteswreact(uint8_t i);
+const cl_state *getclstate(uint8_t i);
 
 void emstopmotor(uint8_t i);
 void stopmotor(uint8_t i);
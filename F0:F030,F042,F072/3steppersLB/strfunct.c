@@ -22,6 +22,7 @@
 #include "commonproto.h"
 #include "flash.h"
 #include "hardware.h"
+#include "steppers.h"
 #include "strfunct.h"
 #include "usb.h"
 #include "version.inc"
@@ -393,6 +394,23 @@ void getcounter(_U_ char *txt){
     NL();
 }
 
+// closed-loop statistics
+void clstat(_U_ char *txt){
+    for(int i = 0; i < MOTORSNO; ++i){
+        const cl_state *c = getclstate(i);
+        if(i) newline();
+        SEND("clstat"); bufputchar('0'+i); bufputchar('=');
+        SEND("err="); printi(c->err);
+        SEND(", maxerr="); printi(c->maxerr);
+        SEND(", final="); printi(c->final);
+        SEND(", slips="); printu(c->slips);
+        SEND(", corr="); printu(c->corr);
+        SEND(", tries="); printu(c->tries);
+        if(c->stalled) SEND(", stalled");
+    }
+    NL();
+}
+
 void wdcheck(_U_ char *txt){
     while(1){nop();}
 }
@@ -452,6 +470,7 @@ enum{
     SCMD_DUMPERR,
     SCMD_DUMPCMD,
     SCMD_ERASEFLASH,
+    SCMD_CLSTAT,
     SCMD_AMOUNT
 };
 
@@ -475,6 +494,7 @@ static specfpointer speccmdlist[SCMD_AMOUNT] = {
     [SCMD_DUMPCMD] = dumpcmdcodes,
     [SCMD_DUMPERR] = dumperrcodes,
     [SCMD_ERASEFLASH] = eraseflash,
+    [SCMD_CLSTAT] = clstat,
 };
 
 typedef struct{
@@ -501,6 +521,8 @@ static const commands textcommands[] = {
     // configuration
     {CMD_NONE, "", "Confuguration:"},
     {CMD_ACCEL, "accel", "set/get accel/decel (steps/s^2)"},
+    {CMD_CLMAXCORR, "clmaxcorr", "closed-loop: max corrected steps per move"},
+    {CMD_CLTOLERANCE, "cltolerance", "closed-loop: max final error (encoder ticks)"},
     {CMD_ENCREV, "encrev", "set/get max encoder's pulses per revolution"},
     {CMD_ENCSTEPMAX, "encstepmax", "maximal encoder ticks per step"},
     {CMD_ENCSTEPMIN, "encstepmin", "minimal encoder ticks per step"},
@@ -518,6 +540,7 @@ static const commands textcommands[] = {
     {CMD_EMERGSTOPALL, "emerg", "emergency stop all motors"},
     {CMD_EMERGSTOP, "emstop", "emergency stop motor (right now)"},
     {CMD_ENCPOS, "encpos", "set/get encoder's position"},
+    {CMD_FOLLOWERR, "followerr", "get following error (encoder ticks)"},
     {CMD_GOTOZERO, "gotoz", "find zero position & refresh counters"},
     {CMD_REINITMOTORS, "motreinit", "re-init motors after configuration changed"},
     {CMD_RELPOS, "relpos", "set relative steps, get remaining"},
@@ -529,6 +552,7 @@ static const commands textcommands[] = {
     {CMD_NONE, "", "USB-only commands:"},
     {-SCMD_CANID, "canid", "get/set CAN ID"},
     {-SCMD_CANSPEED, "canspeed", "CAN bus speed"},
+    {-SCMD_CLSTAT, "clstat", "closed-loop statistics"},
     {-SCMD_DELIGNLIST, "delignlist", "delete ignore list"},
     {-SCMD_DFU, "dfu", "activate DFU mode"},
     {-SCMD_DUMPERR, "dumperr", "dump error codes"},
@@ -21,8 +21,11 @@
  *
  */
 #include "can.h"
+#include "flash.h"
 #include "hardware.h"
 #include "proto.h"
+#include "spi.h"
+#include "timesync.h"
 #include "usart.h"
 
 #include <string.h> // memcpy
@@ -35,6 +38,7 @@ static uint16_t oldspeed = 100; // speed of last init
 
 static uint16_t CANID = 0xFFFF;
 static CAN_status can_status = CAN_STOP;
+static volatile int8_t syncbox = -1; // TX mailbox with SYNC (-1 if none)
 
 static void can_process_fifo(uint8_t fifo_num);
 
@@ -149,8 +153,9 @@ void CAN_setup(uint16_t speed){
     while((CAN->MSR & CAN_MSR_INAK)==CAN_MSR_INAK) if(--tmout == 0) break; /* (6) */
     // init filter: accept data only for this board
     can_accept_one();
+    syncbox = -1;
 
-    CAN->IER |= CAN_IER_ERRIE | CAN_IER_FOVIE0 | CAN_IER_FOVIE1; /* (13) */
+    CAN->IER |= CAN_IER_ERRIE | CAN_IER_FOVIE0 | CAN_IER_FOVIE1 | CAN_IER_FMPIE0; /* (13) */
     /* Configure IT */
     /* (14) Set priority for CAN_IRQn */
     /* (15) Enable CAN_IRQn */
@@ -162,8 +167,10 @@ void CAN_setup(uint16_t speed){
 void can_proc(){
     // check for messages in FIFO0 & FIFO1
     if(CAN->RF0R & CAN_RF0R_FMP0){
+        CAN->IER &= ~CAN_IER_FMPIE0; // don't let IRQ to touch FIFO0
         can_process_fifo(0);
     }
+    CAN->IER |= CAN_IER_FMPIE0;
     if(CAN->RF1R & CAN_RF1R_FMP1){
         can_process_fifo(1);
     }
@@ -205,13 +212,14 @@ void can_proc(){
     }*/
 }
 
-CAN_status can_send(uint8_t *msg, uint8_t len, uint16_t target_id){
+// put message into free mailbox, return its number or -1 if all are busy; call it with IRQs disabled
+static int8_t send_box(uint8_t *msg, uint8_t len, uint16_t target_id){
     uint8_t mailbox = 0;
     // check first free mailbox
     if(CAN->TSR & (CAN_TSR_TME)){
         mailbox = (CAN->TSR & CAN_TSR_CODE) >> 24;
     }else{ // no free mailboxes
-        return CAN_BUSY;
+        return -1;
     }
     CAN_TxMailBox_TypeDef *box = &CAN->sTxMailBox[mailbox];
     uint32_t lb = 0, hb = 0;
@@ -244,7 +252,31 @@ CAN_status can_send(uint8_t *msg, uint8_t len, uint16_t target_id){
     box->TDHR = hb;
     box->TDTR = len;
     box->TIR  = (target_id & 0x7FF) << 21 | CAN_TI0R_TXRQ;
-    return CAN_OK;
+    return (int8_t)mailbox;
+}
+
+// can be called from IRQ (time-triggered messages)
+CAN_status can_send(uint8_t *msg, uint8_t len, uint16_t target_id){
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    int8_t mb = send_box(msg, len, target_id);
+    __set_PRIMASK(primask);
+    return (mb < 0) ? CAN_BUSY : CAN_OK;
+}
+
+/**
+ * @brief can_send_sync - send SYNC with given sequence number; time of its transmission will be
+ *      passed to TS_txsync() from CAN IRQ
+ */
+CAN_status can_send_sync(uint8_t seq){
+    if(syncbox >= 0) return CAN_BUSY; // previous SYNC is still waiting
+    __disable_irq();
+    // clear completion flags, so TX IRQ will come only after new transmissions
+    CAN->TSR = CAN_TSR_RQCP0 | CAN_TSR_RQCP1 | CAN_TSR_RQCP2;
+    syncbox = send_box(&seq, 1, the_conf.syncID);
+    if(syncbox >= 0) CAN->IER |= CAN_IER_TMEIE;
+    __enable_irq();
+    return (syncbox < 0) ? CAN_BUSY : CAN_OK;
 }
 
 /*
@@ -315,6 +347,28 @@ static void can_process_fifo(uint8_t fifo_num){
 }
 
 void cec_can_isr(){
+    uint32_t T = Tus();
+    // SYNC should be processed as soon as possible, all other messages - in can_proc()
+    if((CAN->IER & CAN_IER_FMPIE0) && (CAN->RF0R & CAN_RF0R_FMP0)){
+        CAN_FIFOMailBox_TypeDef *box = &CAN->sFIFOMailBox[0];
+        if(the_conf.syncID && (box->RIR >> 21) == the_conf.syncID){
+            SSI_sync();
+            TS_rxsync((box->RDTR & 0x0f) ? box->RDLR & 0xff : 0, T); // sequence number is optional
+            CAN->RF0R |= CAN_RF0R_RFOM0;
+        }else CAN->IER &= ~CAN_IER_FMPIE0;
+    }
+    if((CAN->IER & CAN_IER_TMEIE) && syncbox >= 0){ // some transmission completed
+        uint32_t tsr = CAN->TSR;
+        CAN->TSR = tsr & (CAN_TSR_RQCP0 | CAN_TSR_RQCP1 | CAN_TSR_RQCP2);
+        if(tsr & (CAN_TSR_RQCP0 << (8*syncbox))){ // SYNC is sent or aborted
+            if(tsr & (CAN_TSR_TXOK0 << (8*syncbox))){
+                SSI_sync();
+                TS_txsync(T);
+            }
+            syncbox = -1;
+            CAN->IER &= ~CAN_IER_TMEIE;
+        }
+    }
     if(CAN->RF0R & CAN_RF0R_FOVR0){ // FIFO overrun
         CAN->RF0R &= ~CAN_RF0R_FOVR0;
         can_status = CAN_FIFO_OVERRUN;
@@ -332,14 +386,20 @@ void cec_can_isr(){
     }
 }
 
-// accept only data for given device @ FIFO0, filter 0
+// accept only data for given device, SYNC and follow-up (if the_conf.syncID != 0) @ FIFO0, filter 0
 void can_accept_one(){
     CAN->FMR = CAN_FMR_FINIT; // Enter filter init mode, (16-bit + mask, bank 0 for FIFO 0)
     CAN->FA1R = CAN_FA1R_FACT0; // Acivate filter 0 for ID
     // main data - FIFO0, filter0
     CAN->FM1R = CAN_FM1R_FBM0; // Identifier list mode
-    CAN->sFilterRegister[0].FR1 = (CANID << 5) | (0x8f<<16); // Set the Id list
-    //CAN->sFilterRegister[0].FR2 = (0x8f<<16) | 0x8f;
+    if(the_conf.syncID){ // Set the Id list
+        uint32_t fupID = (the_conf.syncID + 1) & 0x7ff;
+        CAN->sFilterRegister[0].FR1 = (CANID << 5) | ((uint32_t)the_conf.syncID << 21);
+        CAN->sFilterRegister[0].FR2 = (fupID << 5) | (fupID << 21);
+    }else{
+        CAN->sFilterRegister[0].FR1 = (CANID << 5) | (0x8f<<16);
+        CAN->sFilterRegister[0].FR2 = (0x8f<<16) | 0x8f;
+    }
     CAN->FMR &= ~CAN_FMR_FINIT; // Leave filter init
 }
 // accept everything @ FIFO1, filter 4
@@ -75,6 +75,7 @@ void CAN_reinit(uint16_t speed);
 void CAN_setup(uint16_t speed);
 
 CAN_status can_send(uint8_t *msg, uint8_t len, uint16_t target_id);
+CAN_status can_send_sync(uint8_t seq);
 //void can_send_dummy();
 //void can_send_broadcast();
 void can_proc();
@@ -23,7 +23,9 @@
 #include "adc.h"
 #include "can.h"
 #include "can_process.h"
+#include "flash.h"
 #include "proto.h"
+#include "timesync.h"
 
 extern volatile uint32_t Tms; // timestamp data
 /*
@@ -72,6 +74,10 @@ void can_messages_proc(){
     }
 #endif
     IWDG->KR = IWDG_REFRESH;
+    if(the_conf.syncID && can_mesg->ID == the_conf.syncID + 1){ // follow-up
+        if(len == 8) TS_followup(can_mesg->data);
+        return;
+    }
     /*
     if(!len) return; // no data in message
     uint8_t *data = can_mesg->data;
@@ -0,0 +1,175 @@
+/*
+ * This file is part of the CANBUS_SSI project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cansync.h"
+
+// max rate correction in 2^-32 units
+#define MAXRATE     ((int64_t)CS_MAXPPM * 4295)
+// re-anchor reference point after this time, us
+#define REANCHOR    (1UL << 30)
+
+void cs_clrstat(cs_state *c){
+    c->maxerr = c->sumerr = c->nerr = 0;
+    c->nmeas = c->noutl = c->nreset = 0;
+}
+
+void cs_init(cs_state *c, uint32_t local){
+    c->state = CS_UNSYNC;
+    c->err = 0;
+    c->rate = 0;
+    c->lref = c->lastmeas = local;
+    c->gref = local;
+    c->acq = c->outl = 0;
+    cs_clrstat(c);
+}
+
+// local time could be a little earlier than reference point
+uint64_t cs_global(const cs_state *c, uint32_t local){
+    int32_t dl = (int32_t)(local - c->lref);
+    return c->gref + (int64_t)dl + (((int64_t)dl * c->rate) >> 32);
+}
+
+uint32_t cs_local(const cs_state *c, uint64_t global){
+    int64_t dg = (int64_t)(global - c->gref);
+    return c->lref + (uint32_t)(dg - dg * c->rate / ((1LL << 32) + c->rate));
+}
+
+// new reference point with the same mapping
+static void reanchor(cs_state *c, uint32_t local){
+    c->gref = cs_global(c, local);
+    c->lref = local;
+}
+
+// step to given time
+static void step(cs_state *c, uint32_t local, uint64_t global){
+    c->lref = c->lastmeas = local;
+    c->gref = global;
+    c->acq = 1;
+    c->outl = 0;
+    c->avgerr = CS_OUTMIN * 16;
+    c->state = CS_ACQ;
+    ++c->nmeas;
+}
+
+/**
+ * @brief cs_master - make this clock master (called on each SYNC transmitted)
+ * @param local - local time of SYNC transmission
+ */
+void cs_master(cs_state *c, uint32_t local){
+    if(c->state != CS_MASTER){
+        reanchor(c, local);
+        c->state = CS_MASTER;
+        c->rate = 0;
+        c->err = 0;
+    }
+    c->lastmeas = local;
+}
+
+/**
+ * @brief cs_measure - process next measurement
+ * @param local - local time of SYNC receiving
+ * @param global - master's time of SYNC transmission
+ * @return 1 if measurement accepted
+ */
+int cs_measure(cs_state *c, uint32_t local, uint64_t global){
+    if(c->state == CS_MASTER) return 0;
+    if(c->state == CS_UNSYNC){
+        c->err = 0;
+        step(c, local, global);
+        return 1;
+    }
+    int32_t dt = (int32_t)(local - c->lastmeas);
+    if(dt <= 0) return 0;
+    int64_t e64 = (int64_t)(global - cs_global(c, local));
+    int32_t e = (e64 > INT32_MAX) ? INT32_MAX : (e64 < -INT32_MAX) ? -INT32_MAX : (int32_t)e64;
+    uint32_t ae = (e < 0) ? -e : e;
+    c->err = e;
+    if(c->state == CS_ACQ){
+        if(c->acq > 1 && ae > CS_OUTLIER){ // rate was estimated, so big error is strange
+            ++c->noutl;
+            if(++c->outl < 2) return 0; // delayed IRQ?
+            c->rate = 0; // bad estimation: start from scratch
+            step(c, local, global);
+            return 1;
+        }
+        c->outl = 0;
+        // rate by phase drift since step (longer base - better estimation)
+        int64_t r = c->rate + ((int64_t)e << 32) / (int32_t)(local - c->lref);
+        if(r > MAXRATE || r < -MAXRATE) r = 0;
+        c->rate = (int32_t)r;
+        c->lastmeas = local;
+        ++c->nmeas;
+        if(c->acq > 1) c->avgerr = (c->avgerr * 7 + ae * 16) / 8; // will be used as clipping threshold
+        // lock only when rate estimated by previous measurements predicts this one well
+        if(c->acq < CS_ACQSAMPLES) ++c->acq;
+        else if(ae <= 3 * CS_OUTMIN){
+            c->lref = local;
+            c->gref = global;
+            c->state = CS_LOCKED;
+        }
+        return 1;
+    }
+    // locked
+    if(ae > CS_OUTLIER){ // IRQ was delayed too much or master changed its time
+        ++c->noutl;
+        if(++c->outl >= CS_MAXOUTL){
+            c->state = CS_UNSYNC;
+            ++c->nreset;
+        }
+        return 0;
+    }
+    c->outl = 0;
+    if(ae > c->maxerr) c->maxerr = ae;
+    c->sumerr += ae;
+    ++c->nerr;
+    // clip error by CS_OUTMIN + 3*(mean error): delayed IRQ can't shift clock much; clipped errors
+    // increase mean error slowly, so real drift is followed
+    int32_t thres = CS_OUTMIN + 3 * c->avgerr / 16;
+    if(e > thres || e < -thres){
+        e = (e > 0) ? thres : -thres;
+        ++c->noutl;
+        c->avgerr = (c->avgerr * 15 + thres * 16) / 16;
+    }else c->avgerr = (c->avgerr * 7 + ae * 16) / 8;
+    // PI-loop
+    reanchor(c, local);
+    c->gref += e / CS_KP;
+    int64_t r = c->rate + (((int64_t)e << 32) / dt) / CS_KI;
+    if(r > MAXRATE) r = MAXRATE;
+    else if(r < -MAXRATE) r = -MAXRATE;
+    c->rate = (int32_t)r;
+    c->lastmeas = local;
+    ++c->nmeas;
+    return 1;
+}
+
+/**
+ * @brief cs_check - check timeout and refresh reference point
+ * @param local - current local time
+ */
+void cs_check(cs_state *c, uint32_t local){
+    if((c->state == CS_ACQ || c->state == CS_LOCKED) && (int32_t)(local - c->lastmeas) > CS_TIMEOUT){
+        c->state = CS_UNSYNC;
+        ++c->nreset;
+    }
+    if((uint32_t)(local - c->lref) > REANCHOR) reanchor(c, local);
+}
+
+// rate correction, ppm
+int32_t cs_ppm(const cs_state *c){
+    return (int32_t)(((int64_t)c->rate * 1000000) >> 32);
+}
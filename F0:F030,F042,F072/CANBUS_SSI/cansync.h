@@ -0,0 +1,90 @@
+/*
+ * This file is part of the CANBUS_SSI project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef CANSYNC_H__
+#define CANSYNC_H__
+
+#include <stdint.h>
+
+/*
+ * Distributed clock disciplined by SYNC + follow-up (hardware-independent).
+ * Local clock is free-running 32-bit counter of microseconds, global time is 64-bit:
+ *      global = gref + dl + dl*rate/2^32, dl = local - lref
+ * Master: global time is its local clock (extended to 64 bits), it sends SYNC and then follow-up
+ * with global time of SYNC transmission.
+ * Slave: pair of local time of SYNC receiving and master's time from follow-up is a measurement.
+ * First CS_ACQSAMPLES measurements step phase and estimate rate, then PI-loop corrects both.
+ * Error of locked clock is clipped by CS_OUTMIN + 3*(mean error), so delayed IRQ can't shift clock much;
+ * measurements with error greater than CS_OUTLIER are rejected, CS_MAXOUTL of them in a row restart
+ * acquisition.
+ * cs_check() should be called more often than once per 2^31us to keep reference point fresh.
+ */
+
+// amount of measurements to acquire
+#define CS_ACQSAMPLES   (3)
+// max phase error of locked clock (greater are outliers), us
+#define CS_OUTLIER      (100)
+// min threshold of error clipping, us
+#define CS_OUTMIN       (4)
+// PI-loop gains: 1/CS_KP of phase error and 1/CS_KI of frequency error
+#define CS_KP           (4)
+#define CS_KI           (16)
+// max amount of outliers in a row
+#define CS_MAXOUTL      (4)
+// max rate correction, ppm
+#define CS_MAXPPM       (500)
+// lose lock if there was no measurements during this time, us
+#define CS_TIMEOUT      (10000000)
+
+typedef enum{
+    CS_UNSYNC,          // free-running clock
+    CS_ACQ,             // acquisition
+    CS_LOCKED,          // slave is locked to master
+    CS_MASTER           // this is master
+} cs_status;
+
+typedef struct{
+    cs_status state;
+    int32_t err;        // phase error of last measurement, us
+    uint32_t maxerr;    // max abs phase error of locked clock, us
+    uint32_t sumerr;    // sum of abs errors (for mean error)
+    uint32_t nerr;      // amount of errors summarized
+    uint32_t nmeas;     // amount of accepted measurements
+    uint32_t noutl;     // amount of outliers
+    uint32_t nreset;    // amount of acquisition restarts
+    int32_t rate;       // rate correction (2^-32)
+    // private
+    uint32_t lref;      // local time of reference point
+    uint64_t gref;      // global time @ lref
+    uint32_t lastmeas;  // local time of last measurement
+    uint32_t avgerr;    // mean abs error (exponential, 1/16us)
+    uint8_t acq;        // amount of acquisition measurements
+    uint8_t outl;       // amount of outliers in a row
+} cs_state;
+
+void cs_init(cs_state *c, uint32_t local);
+uint64_t cs_global(const cs_state *c, uint32_t local);
+uint32_t cs_local(const cs_state *c, uint64_t global);
+void cs_master(cs_state *c, uint32_t local);
+int cs_measure(cs_state *c, uint32_t local, uint64_t global);
+void cs_check(cs_state *c, uint32_t local);
+int32_t cs_ppm(const cs_state *c);
+void cs_clrstat(cs_state *c);
+
+#endif // CANSYNC_H__
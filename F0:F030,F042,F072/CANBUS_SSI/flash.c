@@ -38,6 +38,7 @@
 #include "adc.h"
 #include "flash.h"
 #include "proto.h"  // printout
+#include "ssi.h"
 #include <string.h> // memcpy
 
 // max amount of Config records stored (will be recalculate in flashstorage_init()
@@ -48,6 +49,13 @@ static uint32_t maxCnum = FLASH_BLOCK_SIZE / sizeof(user_conf);
     ,.CANspeed = 100                        \
     ,.encoderID = 8                         \
     ,.limitsID = 0xe                        \
+    ,.ssiperiod = 1000                      \
+    ,.ssibits = 25                          \
+    ,.ssiskip = 1                           \
+    ,.ssiflags = SSI_INVERT                 \
+    ,.ssivelwin = 8                         \
+    ,.ssidecim = 10                         \
+    ,.syncperiod = 1000                     \
     }
 
 static int erase_flash(const void*, const void*);
@@ -216,6 +224,18 @@ void dump_userconf(){
     SEND("\nCANspeed="); printu(the_conf.CANspeed);
     SEND("\nencoderID="); printuhex(the_conf.encoderID);
     SEND("\nlimitsID="); printuhex(the_conf.limitsID);
+    SEND("\nsendenc="); printu(the_conf.sendenc);
+    SEND("\nsendsw="); printu(the_conf.sendsw);
+    SEND("\nssiperiod="); printu(the_conf.ssiperiod);
+    SEND("\nssibits="); printu(the_conf.ssibits);
+    SEND("\nssiskip="); printu(the_conf.ssiskip);
+    SEND("\nssiflags="); printuhex(the_conf.ssiflags);
+    SEND("\nssivelwin="); printu(the_conf.ssivelwin);
+    SEND("\nssidecim="); printu(the_conf.ssidecim);
+    SEND("\nsyncID="); printuhex(the_conf.syncID);
+    SEND("\nsyncmaster="); printu(the_conf.syncmaster);
+    SEND("\nsyncperiod="); printu(the_conf.syncperiod);
+    SEND("\nsyncadj="); printi(the_conf.syncadj);
     newline();
     sendbuf();
 }
@@ -40,6 +40,16 @@ typedef struct __attribute__((packed, aligned(4))){
     uint16_t limitsID;          // ID to send limit-switches data
     uint8_t  sendenc;           // send encoder's measurements by CAN bus
     uint8_t sendsw;             // send limit switches values by CAN bus
+    uint16_t ssiperiod;         // SSI sampling period, us (0 - sample by request each ENCODER_PERIOD ms)
+    uint16_t syncID;            // ID of SYNC message (0 - don't sync)
+    uint8_t ssibits;            // amount of encoder data bits
+    uint8_t ssiskip;            // amount of leading bits to skip
+    uint8_t ssiflags;           // SSI_GRAY etc
+    uint8_t ssivelwin;          // velocity window, samples
+    uint8_t ssidecim;           // send each `ssidecim` sample by CAN
+    uint8_t syncmaster;         // ==1 if this node sends SYNC and follow-up
+    uint16_t syncperiod;        // SYNC period, ms
+    int16_t syncadj;            // slave's RX IRQ happens earlier than master's TX complete IRQ, us
 } user_conf;
 
 extern user_conf the_conf; // global user config (read from FLASH to RAM)
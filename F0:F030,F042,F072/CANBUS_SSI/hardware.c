@@ -93,14 +93,15 @@ void gpio_setup(){
     brdADDR = READ_BRD_ADDR();
 }
 
-// setup TIM2 to work as downcounting 32-bit timer (2mks period)
+// setup TIM2 to work as free-running 32-bit upcounting timer (1mks period) - local clock;
+// its CC1 is used for time-triggered messages
 void tim2_Setup(){
     RCC->APB1ENR |= RCC_APB1ENR_TIM2EN; // enable clocking
     TIM2->CR1 = 0; // turn off timer
-    TIM2->PSC = 95; // 500kHz
-    TIM2->ARR = 0xffffff; // 24 bit counter from 0xffffff to 0
-    // turn it on, downcounting
-    TIM2->CR1 = TIM_CR1_CEN | TIM_CR1_DIR;
+    TIM2->PSC = 47; // 1MHz
+    TIM2->ARR = 0xffffffff;
+    TIM2->EGR = TIM_EGR_UG;
+    TIM2->CR1 = TIM_CR1_CEN;
 }
 
 /*
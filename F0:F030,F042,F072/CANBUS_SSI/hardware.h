@@ -47,6 +47,8 @@
 #define ESW_STATE()     ((GPIOB->IDR & 0x07) | ((GPIOB->IDR>>7) & 0x08))
 
 extern volatile uint32_t Tms;
+// local time, us
+#define Tus()           (TIM2->CNT)
 
 void Jump2Boot();
 void gpio_setup();
@@ -25,6 +25,7 @@
 #include "hardware.h"
 #include "proto.h"
 #include "spi.h"
+#include "timesync.h"
 #include "usart.h"
 #include "usb.h"
 #include "usb_lib.h"
@@ -97,7 +98,7 @@ static char *get_USB(){
 
 // send encoder data
 static void CANsendEnc(uint8_t *buf){
-    uint32_t ctr = TIM2->CNT;
+    uint32_t ctr = 0xffffff - ((Tus() >> 1) & 0xffffff); // old format: 24-bit downcounter with 2us period
     uint8_t msg[8];
     memcpy(msg, buf, 4);
     msg[4] = 0;
@@ -106,6 +107,13 @@ static void CANsendEnc(uint8_t *buf){
     msg[7] = (ctr >> 0 ) & 0xff;
     can_send(msg, 8, the_conf.encoderID);
 }
+// send decoded SSI sample
+static void CANsendSSI(const ssi_state *s){
+    uint8_t msg[8];
+    ssi_pack(s, msg);
+    can_send(msg, 8, the_conf.encoderID);
+}
+
 // send limit-switches data
 static void CANsendLim(){
     uint8_t msg[8] = {0};
@@ -117,6 +125,8 @@ int main(void){
     uint32_t    lastT = 0,  // send buffer time
                 encT = 0    // send encoder & limit-switches data time
     ;
+    uint8_t lastseq = 0; // number of last SSI sample sent by CAN
+    ssi_state sample;
     sysreset();
     SysTick_Config(6000, 1);
     gpio_setup(); // + read board address
@@ -127,6 +137,8 @@ int main(void){
     USB_setup();
     spi_setup();
     tim2_Setup();
+    TS_setup();
+    SSI_start();
     iwdg_setup();
 
      while (1){
@@ -137,7 +149,7 @@ int main(void){
         }
         if((the_conf.sendenc || the_conf.sendsw) && Tms - encT > ENCODER_PERIOD){
             encT = Tms;
-            if(the_conf.sendenc) SPI_transmit(NULL, 4);
+            if(the_conf.sendenc && !SSI_active()) SPI_transmit(NULL, 4);
             if(the_conf.sendsw) CANsendLim();
         }
         can_proc();
@@ -154,6 +166,12 @@ int main(void){
         }
         IWDG->KR = IWDG_REFRESH;
         can_messages_proc();
+        SSI_proc();
+        TS_proc();
+        if(SSI_getsample(&sample) && the_conf.sendenc && (uint8_t)(sample.seq - lastseq) >= the_conf.ssidecim){
+            lastseq = sample.seq;
+            CANsendSSI(&sample);
+        }
         uint8_t buf[4];
         uint8_t a = SPI_getdata(buf, 4);
         if(a){
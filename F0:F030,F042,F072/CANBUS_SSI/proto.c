@@ -26,6 +26,7 @@
 #include "hardware.h"
 #include "proto.h"
 #include "spi.h"
+#include "timesync.h"
 #include "usart.h"
 #include "usb.h"
 #include <string.h> // strlen, strcpy(
@@ -116,6 +117,99 @@ static inline void showUIvals(){
     newline();
 }
 
+void printi(int32_t i){
+    if(i < 0){
+        bufputchar('-');
+        i = -i;
+    }
+    printu(i);
+}
+
+static void showSSI(){
+    ssi_state s;
+    if(!SSI_active()){
+        SEND("SSI sampling is off");
+        return;
+    }
+    uint32_t T0 = Tms;
+    while(!SSI_getsample(&s)){
+        IWDG->KR = IWDG_REFRESH;
+        if(Tms - T0 > 99){
+            SEND("No samples");
+            return;
+        }
+    }
+    SEND("raw="); printuhex(s.raw);
+    SEND("\npos="); printu(s.pos);
+    SEND("\nvel="); printi(s.vel);
+    SEND("\nT="); printu(s.T);
+    SEND("\nflags="); printuhex(s.flags);
+    SEND("\nseq="); printu(s.seq);
+    SEND("\nerrors="); printu(s.nerrors);
+}
+
+static void showSSIstat(){
+    ssi_stat st;
+    if(!SSI_active()){
+        SEND("SSI sampling is off");
+        return;
+    }
+    SSI_getstat(&st, 1);
+    SEND("samples="); printu(st.nsamples);
+    SEND("\nrate="); printu(st.rate);
+    SEND("\noverruns="); printu(st.overruns);
+    if(st.permax >= st.permin){
+        SEND("\nlatency="); printu(st.latmin); bufputchar('-'); printu(st.latmax);
+        SEND("\nperiod="); printu(st.permin); bufputchar('-'); printu(st.permax);
+        SEND("\njitter="); printu(st.permax - st.permin);
+    }
+    SEND("\nsyncs="); printu(st.nsync);
+    SEND("\nsyncskip="); printu(st.syncskip);
+    SEND("\nsyncerr="); printi(st.syncerr);
+    SEND("\nsyncmax="); printu(st.syncmax);
+}
+
+// print time (us) as seconds
+static void printtime(uint64_t t){
+    uint32_t us = (uint32_t)(t % 1000000);
+    printu((uint32_t)(t / 1000000));
+    bufputchar('.');
+    for(uint32_t d = 100000; d > us && d > 1; d /= 10) bufputchar('0');
+    printu(us);
+}
+
+static void showsync(){
+    const char *states[] = {"unsync", "acquisition", "locked", "master"};
+    cs_state c;
+    if(!the_conf.syncID){
+        SEND("Time sync is off");
+        return;
+    }
+    TS_getclock(&c, 1);
+    SEND("state="); SEND(states[c.state]);
+    SEND("\nppm="); printi(cs_ppm(&c));
+    SEND("\nerr="); printi(c.err);
+    if(c.nerr){
+        SEND("\nerrmax="); printu(c.maxerr);
+        SEND("\nerrmean="); printu(c.sumerr / c.nerr);
+    }
+    SEND("\nmeasurements="); printu(c.nmeas);
+    SEND("\noutliers="); printu(c.noutl);
+    SEND("\nresets="); printu(c.nreset);
+    for(uint8_t i = 0; i < TS_NSLOTS; ++i){
+        ts_slot s;
+        TS_getslot(i, &s);
+        if(!s.period) continue;
+        SEND("\nslot"); printu(i);
+        SEND(": period="); printu(s.period / 1000);
+        SEND(", ID="); printuhex(s.ID);
+        SEND(", sent="); printu(s.nsent);
+        SEND(", missed="); printu(s.nmiss);
+        SEND(", late="); printu(s.late);
+        SEND(", latemax="); printu(s.latemax);
+    }
+}
+
 // check address & return 0 if wrong or roll to next non-digit
 static char *chk485addr(char *txt){
     uint32_t N;
@@ -176,6 +270,35 @@ TRUE_INLINE void sendCANcommand(char *txt){
     }
 }
 
+// time-triggered message, format: slot period_ms ID data bytes (period 0 clears slot)
+TRUE_INLINE void schedule(char *txt){
+    uint32_t n, period;
+    char *nxt = getnum(txt, &n);
+    if(nxt == txt || n >= TS_NSLOTS){
+        SEND("Slot number should be from 0 to "); printu(TS_NSLOTS - 1);
+        return;
+    }
+    txt = nxt;
+    nxt = getnum(txt, &period);
+    if(nxt == txt){
+        SEND("No period given");
+        return;
+    }
+    if(!period){
+        TS_schedule(n, 0, 0, NULL, 0);
+        SEND("Slot cleared");
+        return;
+    }
+    if(period > 60000){
+        SEND("Period should be not greater than 60000ms");
+        return;
+    }
+    CAN_message *msg = parseCANmsg(nxt);
+    if(!msg) return;
+    TS_schedule(n, period * 1000, msg->ID, msg->data, msg->length);
+    SEND("Scheduled");
+}
+
 static uint8_t userconf_changed = 0; // ==1 if user_conf was changed
 TRUE_INLINE void userconf_manip(char *txt){
     txt = omit_spaces(txt);
@@ -228,6 +351,31 @@ static void chCAN(char val, uint8_t *ch){
     }
 }
 
+// check SSI frame format: data, skipped and error bits should fit into frame
+static uint8_t chkSSIframe(uint8_t bits, uint8_t skip, uint8_t flags){
+    uint8_t n = bits + skip;
+    if(flags & SSI_ERRBIT) ++n;
+    if(bits == 0 || n > 8*SSI_FRAMESZ){
+        SEND("Data, skipped and error bits should fit into 32 bits");
+        return 0;
+    }
+    return 1;
+}
+
+// change 8-bit SSI parameter and restart sampling
+static void chSSI(uint32_t new, uint32_t min, uint32_t max, uint8_t *par){
+    if(new < min || new > max){
+        SEND("Value should be from "); printu(min); SEND(" to "); printu(max);
+        return;
+    }
+    if(*par != (uint8_t)new){
+        *par = (uint8_t)new;
+        SEND("Changed to "); printu(new);
+        userconf_changed = 1;
+        if(SSI_active()) SSI_start();
+    }
+}
+
 // a set of setters for user_conf
 TRUE_INLINE void setters(char *txt){
     uint32_t U;
@@ -279,6 +427,109 @@ TRUE_INLINE void setters(char *txt){
             txt = omit_spaces(txt + 1);
             chCAN(*txt, &the_conf.sendsw);
         break;
+        case 'b':
+            if(nxt == txt + 1 || !chkSSIframe(U, the_conf.ssiskip, the_conf.ssiflags)) return;
+            chSSI(U, 1, 31, &the_conf.ssibits);
+        break;
+        case 'd':
+            if(nxt == txt + 1){
+                SEND("No decimation given");
+                return;
+            }
+            chSSI(U, 1, 255, &the_conf.ssidecim);
+        break;
+        case 'f':
+            if(nxt == txt + 1 || !chkSSIframe(the_conf.ssibits, the_conf.ssiskip, U)) return;
+            chSSI(U, 0, SSI_GRAY | SSI_INVERT | SSI_ERRBIT | SSI_ERRLOW, &the_conf.ssiflags);
+        break;
+        case 'o':
+            if(nxt == txt + 1 || !chkSSIframe(the_conf.ssibits, U, the_conf.ssiflags)) return;
+            chSSI(U, 0, 31, &the_conf.ssiskip);
+        break;
+        case 'p':
+            if(nxt == txt + 1){
+                SEND("No period given");
+                return;
+            }
+            if(U && (U < SSI_MINPERIOD || U > 0xffff)){
+                SEND("Period should be 0 or from 200 to 65535us");
+                return;
+            }
+            if(the_conf.ssiperiod != U){
+                the_conf.ssiperiod = U;
+                SEND("SSI period changed to "); printu(U);
+                userconf_changed = 1;
+            }
+            SSI_start();
+        break;
+        case 'w':
+            if(nxt == txt + 1){
+                SEND("No window given");
+                return;
+            }
+            chSSI(U, 2, SSI_VELWIN_MAX, &the_conf.ssivelwin);
+        break;
+        case 'A':{
+            uint8_t neg = 0;
+            txt = omit_spaces(txt + 1);
+            if(*txt == '-'){
+                neg = 1;
+                ++txt;
+            }
+            if(getnum(txt, &U) == txt){
+                SEND("No adjustment given");
+                return;
+            }
+            if(neg) U = -U;
+            if((int32_t)U < -1000 || (int32_t)U > 1000){
+                SEND("Adjustment should be from -1000 to 1000us");
+                return;
+            }
+            if(the_conf.syncadj != (int32_t)U){
+                the_conf.syncadj = (int16_t)U;
+                SEND("SYNC adjustment changed to "); printi(the_conf.syncadj);
+                userconf_changed = 1;
+            }
+        }
+        break;
+        case 'M':{
+            uint8_t old = the_conf.syncmaster;
+            txt = omit_spaces(txt + 1);
+            chCAN(*txt, &the_conf.syncmaster);
+            if(old != the_conf.syncmaster) TS_setup();
+        }
+        break;
+        case 'P':
+            if(nxt == txt + 1){
+                SEND("No period given");
+                return;
+            }
+            if(U < TS_MINPERIOD || U > 60000){
+                SEND("Period should be from 10 to 60000ms");
+                return;
+            }
+            if(the_conf.syncperiod != U){
+                the_conf.syncperiod = U;
+                SEND("SYNC period changed to "); printu(U);
+                userconf_changed = 1;
+            }
+        break;
+        case 'y':
+            if(nxt == txt + 1){
+                SEND("No ID given");
+                return;
+            }
+            if(U > 0x7FF){
+                SEND("ID should be from 0 to 0x7FF");
+                return;
+            }
+            if(the_conf.syncID != U){
+                the_conf.syncID = U;
+                SEND("SYNC ID changed to "); printuhex(U);
+                userconf_changed = 1;
+            }
+            can_accept_one();
+        break;
         default:
             SEND("\nSetters commands:\n"
                  "c - set default CAN speed\n"
@@ -286,6 +537,16 @@ TRUE_INLINE void setters(char *txt){
                  "Ex - autosend (1) or not (0) encoders val to CAN\n"
                  "l - set limitsID\n"
                  "Lx - autosend/not limit switches values to CAN\n"
+                 "b - SSI data bits\n"
+                 "d - send by CAN each d'th SSI sample\n"
+                 "f - SSI flags (1 - Gray code, 2 - inverted, 4 - error bit present, 8 - error bit is active low)\n"
+                 "o - amount of SSI leading bits to skip\n"
+                 "p - SSI sampling period, us (0 - read by request each 70ms)\n"
+                 "w - velocity window, samples\n"
+                 "y - SYNC ID (0 - don't sync), follow-up ID is y+1\n"
+                 "A - SYNC adjustment: slave's RX IRQ is earlier than master's TX IRQ by A us\n"
+                 "Mx - this node is (1) or not (0) SYNC master\n"
+                 "P - SYNC period, ms\n"
                 );
     }
 }
@@ -314,6 +575,10 @@ void cmd_parser(char *txt, uint8_t isUSB){
             setters(txt + 1);
             goto eof;
         break;
+        case 'Q':
+            schedule(txt + 1);
+            goto eof;
+        break;
         case 'U':
             userconf_manip(txt + 1);
             goto eof;
@@ -343,8 +608,14 @@ void cmd_parser(char *txt, uint8_t isUSB){
             SEND("\nCAN IN address (OUT=IN+1): ");
             printuhex(getCANID());
         break;
+        case 'e':
+            showSSI();
+        break;
+        case 'E':
+            showSSIstat();
+        break;
         case 'I':
-            spi_setup();
+            SSI_start();
             SEND("SPI reinited, status="); printu(SPI_status);
         break;
         case 'j':
@@ -370,7 +641,11 @@ void cmd_parser(char *txt, uint8_t isUSB){
         break;
         case 'T':
             SEND("Tms="); printu(Tms);
-            SEND("\nCounter="); printu(TIM2->CNT); // 24 bit downcounting 2us period
+            SEND("\nTus="); printu(Tus());
+            SEND("\nglobal="); printtime(TS_global());
+        break;
+        case 'Y':
+            showsync();
         break;
         case 'z':
             flashstorage_init();
@@ -381,17 +656,21 @@ void cmd_parser(char *txt, uint8_t isUSB){
             "@ - accept any IDs\n"
             "a - get raw ADC values\n"
             "b - switch to bootloader\n"
+            "e - show last SSI sample\n"
+            "E - show SSI sampling statistics (and reset it)\n"
             "g - get board address\n"
             "I - reinit SPI\n"
             "j - get MCU temperature\n"
             "k - get U values\n"
             "m - start/stop monitoring CAN bus\n"
-            "R - read 32 bits from SPI\n"
+            "Q - time-triggered message: Q slot(0..3) period_ms ID [byte0..7] (zero period clears slot)\n"
+            "R - read 32 bits from SPI (when periodic sampling is off)\n"
             "s - send data over CAN: s ID [byte0..7]\n"
             "S? - parameter setters\n"
             "t - send test sequence over RS-485\n"
-            "T - print current time\n"
+            "T - print current time (ms, local and global us)\n"
             "U? - options for user configuration\n"
+            "Y - show time sync status (and reset its statistics)\n"
             "z - reinit flash storage\n"
             );
         break;
@@ -46,6 +46,7 @@ void addtobuf(const char *txt);
 void bufputchar(char ch);
 void sendbuf();
 void printu(uint32_t val);
+void printi(int32_t val);
 void printuhex(uint32_t val);
 char *getnum(char *txt, uint32_t *N);
 
@@ -16,6 +16,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "flash.h"
 #include "hardware.h"
 #include "proto.h"
 #include "spi.h"
@@ -26,6 +27,20 @@
 static uint8_t inbuff[SPIBUFSZ], outbuf[SPIBUFSZ], rxrdy = 0;
 spiStatus SPI_status = SPI_NOTREADY;
 
+// time from trigger while SSI transfer is surely in progress, us
+#define SSI_XFERTIME    (100)
+// clear "synced" flag if there was no SYNC during this time, ms
+#define SSI_SYNCTMOUT   (2000)
+
+// periodic SSI sampling
+static ssi_state ssi;
+static ssi_stat stat;
+static const uint16_t ssitx[SSI_FRAMESZ/2] = {0}; // dummy data to generate clock
+static volatile uint8_t ssion = 0, newsample = 0, synced = 0;
+static volatile uint32_t trigT = 0; // time of last trigger, us
+static volatile int32_t tadj = 0;   // correction of current period after SYNC, us
+static uint32_t lastdoneT = 0, syncTms = 0, rateTms = 0, ratesamples = 0;
+
 //SPI: PA5 - SCK, PA6 -MISO, PA7 - MOSI
 void spi_setup(){
     /* (1) Select AF mode on PA5, PA6, PA7 */
@@ -77,6 +92,29 @@ void spi_setup(){
 }
 
 void dma1_channel2_3_isr(){
+    if(ssion){
+        if(DMA1->ISR & DMA_ISR_TCIF2){ // SSI frame received
+            DMA1->IFCR = DMA_IFCR_CTCIF2;
+            uint16_t lat = TIM3->CNT;
+            uint32_t raw = ((uint32_t)inbuff[0] << 24) | ((uint32_t)inbuff[1] << 16) | ((uint32_t)inbuff[2] << 8) | inbuff[3];
+            DMA1_Channel2->CCR &= ~DMA_CCR_EN;
+            DMA1_Channel2->CNDTR = SSI_FRAMESZ;
+            DMA1_Channel2->CCR |= DMA_CCR_EN;
+            ssi_sample(&ssi, raw, trigT, synced);
+            newsample = 1;
+            uint32_t done = trigT + lat;
+            if(stat.nsamples){
+                uint32_t p = done - lastdoneT;
+                if(p < stat.permin) stat.permin = p;
+                if(p > stat.permax) stat.permax = p;
+            }
+            lastdoneT = done;
+            if(lat < stat.latmin) stat.latmin = lat;
+            if(lat > stat.latmax) stat.latmax = lat;
+            ++stat.nsamples;
+        }
+        return;
+    }
     if(DMA1->ISR & DMA_ISR_TCIF3){
         DMA1->IFCR |= DMA_IFCR_CTCIF3;
         SPI_status = SPI_READY;
@@ -127,3 +165,137 @@ uint8_t SPI_getdata(uint8_t *buf, uint8_t len){
     if(buf && len) memcpy(buf, inbuff, len);
     return 1;
 }
+
+static void clrstat(){
+    stat.overruns = stat.syncskip = stat.syncmax = 0;
+    stat.latmin = 0xffff; stat.latmax = 0;
+    stat.permin = 0xffffffff; stat.permax = 0;
+}
+
+/**
+ * @brief SSI_start - start (the_conf.ssiperiod > 0) or stop periodic sampling of SSI encoder
+ * TIM3 (1MHz) update and CC4 events request DMA1_Channel3 to put two halfwords (four 8-bit frames)
+ * into SPI TX FIFO, so transfer starts by hardware without any jitter; data received by DMA1_Channel2
+ * is processed in its IRQ, timestamp is time of timer update.
+ */
+void SSI_start(){
+    uint16_t period = the_conf.ssiperiod;
+    TIM3->CR1 = 0;
+    TIM3->DIER = 0;
+    NVIC_DisableIRQ(TIM3_IRQn);
+    ssion = 0;
+    DMA1_Channel2->CCR = 0;
+    DMA1_Channel3->CCR = 0;
+    spi_setup(); // reset SPI & DMA to one-shot mode
+    if(period < SSI_MINPERIOD) return;
+    SPI1->CR2 &= ~SPI_CR2_TXDMAEN; // TX requests come from timer
+    SPI_status = SPI_BUSY; // forbid one-shot transfers
+    DMA1_Channel3->CCR = 0;
+    DMA1_Channel3->CMAR = (uint32_t)ssitx;
+    DMA1_Channel3->CNDTR = SSI_FRAMESZ/2;
+    // 16-bit circular memory to peripheral
+    DMA1_Channel3->CCR = DMA_CCR_MSIZE_0 | DMA_CCR_PSIZE_0 | DMA_CCR_MINC | DMA_CCR_CIRC | DMA_CCR_DIR | DMA_CCR_EN;
+    DMA1_Channel2->CCR = 0;
+    DMA1_Channel2->CNDTR = SSI_FRAMESZ;
+    DMA1_Channel2->CCR = DMA_CCR_MINC | DMA_CCR_TCIE | DMA_CCR_EN;
+    ssi_conf c = {.bits = the_conf.ssibits, .skip = the_conf.ssiskip, .flags = the_conf.ssiflags,
+                  .velwin = the_conf.ssivelwin};
+    ssi_init(&ssi, &c);
+    clrstat();
+    stat.nsamples = stat.rate = stat.nsync = 0;
+    stat.syncerr = 0;
+    newsample = synced = 0;
+    trigT = 0; tadj = 0;
+    ratesamples = 0; rateTms = Tms;
+    RCC->APB1ENR |= RCC_APB1ENR_TIM3EN;
+    TIM3->PSC = 47; // 1MHz
+    TIM3->ARR = period - 1;
+    TIM3->CCR4 = 2; // second halfword
+    TIM3->CR1 = TIM_CR1_URS;
+    TIM3->EGR = TIM_EGR_UG;
+    TIM3->CNT = TIM3->CCR4 + 1; // first DMA request should be update
+    TIM3->SR = 0;
+    TIM3->DIER = TIM_DIER_UDE | TIM_DIER_CC4DE | TIM_DIER_UIE;
+    ssion = 1;
+    NVIC_SetPriority(TIM3_IRQn, 0);
+    NVIC_EnableIRQ(TIM3_IRQn);
+    TIM3->CR1 = TIM_CR1_CEN;
+}
+
+uint8_t SSI_active(){return ssion;}
+
+// update of TIM3: transfer already started by DMA
+void tim3_isr(){
+    TIM3->SR = ~TIM_SR_UIF;
+    trigT += TIM3->ARR + 1 + tadj;
+    tadj = 0;
+    if(DMA1_Channel2->CNDTR != SSI_FRAMESZ){ // previous frame wasn't received: resync receiver
+        ++stat.overruns;
+        DMA1_Channel2->CCR &= ~DMA_CCR_EN;
+        while(SPI1->SR & SPI_SR_FRLVL) (void)*(volatile uint8_t*)&SPI1->DR;
+        (void)SPI1->SR; // clear OVR
+        DMA1_Channel2->CNDTR = SSI_FRAMESZ;
+        DMA1_Channel2->CCR |= DMA_CCR_EN;
+    }
+}
+
+/**
+ * @brief SSI_sync - align sampling by CAN SYNC (called from CAN IRQ)
+ * Next sample will be made SSI_SYNCDELAY us after SYNC receiving
+ */
+void SSI_sync(){
+    if(!ssion) return;
+    uint16_t cnt = TIM3->CNT, arr = TIM3->ARR;
+    if(cnt < SSI_XFERTIME || (TIM3->SR & TIM_SR_UIF) || DMA1_Channel2->CNDTR != SSI_FRAMESZ){
+        ++stat.syncskip;
+        return;
+    }
+    uint16_t newcnt = arr + 1 - SSI_SYNCDELAY;
+    TIM3->CNT = newcnt;
+    int32_t err = (int32_t)cnt - (int32_t)newcnt; // current period changes by `err` us
+    tadj = err;
+    if(err < -(int32_t)(arr + 1) / 2) err += arr + 1; // phase error modulo period
+    stat.syncerr = err;
+    if(err < 0) err = -err;
+    if((uint32_t)err > stat.syncmax) stat.syncmax = err;
+    ++stat.nsync;
+    synced = 1;
+    syncTms = Tms;
+}
+
+// calculate sampling rate & check SYNC timeout
+void SSI_proc(){
+    if(!ssion) return;
+    if(synced && Tms - syncTms > SSI_SYNCTMOUT) synced = 0;
+    if(Tms - rateTms < 1000) return;
+    rateTms += 1000;
+    uint32_t n = stat.nsamples;
+    stat.rate = n - ratesamples;
+    ratesamples = n;
+}
+
+/**
+ * @brief SSI_getsample - get copy of last sample
+ * @param s - copy of state
+ * @return 1 if there was new sample since last call
+ */
+uint8_t SSI_getsample(ssi_state *s){
+    if(!ssion || !newsample) return 0;
+    __disable_irq();
+    memcpy(s, &ssi, sizeof(ssi_state));
+    newsample = 0;
+    __enable_irq();
+    return 1;
+}
+
+/**
+ * @brief SSI_getstat - get copy of sampling statistics
+ * @param st - copy
+ * @param reset - !=0 to reset min/max values and error counters
+ */
+void SSI_getstat(ssi_stat *st, uint8_t reset){
+    __disable_irq();
+    memcpy(st, &stat, sizeof(ssi_stat));
+    if(reset) clrstat();
+    __enable_irq();
+}
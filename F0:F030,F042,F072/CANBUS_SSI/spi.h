@@ -21,9 +21,17 @@
 #define SPI_H__
 
 #include "stm32f0.h"
+#include "ssi.h"
 
 #define SPIBUFSZ    64
 
+// SSI frame length, bytes
+#define SSI_FRAMESZ     (4)
+// min sampling period (32 bits @ 375kHz is 85us), us
+#define SSI_MINPERIOD   (200)
+// delay of sample after SYNC received, us
+#define SSI_SYNCDELAY   (20)
+
 typedef enum{
     SPI_NOTREADY,
     SPI_READY,
@@ -32,8 +40,30 @@ typedef enum{
 
 extern spiStatus SPI_status;
 
+// statistics of periodic SSI sampling
+typedef struct{
+    uint32_t nsamples;  // total amount of samples
+    uint32_t rate;      // samples got during last second
+    uint32_t overruns;  // transfer wasn't done before next trigger
+    uint32_t nsync;     // amount of SYNC alignments
+    uint32_t syncskip;  // SYNC ignored (transfer was in progress)
+    int32_t syncerr;    // phase error @ last SYNC, us
+    uint32_t syncmax;   // max abs phase error, us
+    uint16_t latmin;    // min time from trigger to data processed, us
+    uint16_t latmax;    // max -//-
+    uint32_t permin;    // min period between data processed, us
+    uint32_t permax;    // max -//-
+} ssi_stat;
+
 void spi_setup();
 uint8_t SPI_transmit(const uint8_t *buf, uint8_t len);
 uint8_t SPI_getdata(uint8_t *buf, uint8_t len);
 
+void SSI_start();
+uint8_t SSI_active();
+void SSI_sync();
+void SSI_proc();
+uint8_t SSI_getsample(ssi_state *s);
+void SSI_getstat(ssi_stat *st, uint8_t reset);
+
 #endif // SPI_H__
@@ -0,0 +1,123 @@
+/*
+ * This file is part of the CANBUS_SSI project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ssi.h"
+
+uint32_t ssi_gray2bin(uint32_t g){
+    g ^= g >> 16;
+    g ^= g >> 8;
+    g ^= g >> 4;
+    g ^= g >> 2;
+    g ^= g >> 1;
+    return g;
+}
+
+/**
+ * @brief ssi_decode - decode raw SSI frame
+ * @param c - encoder configuration
+ * @param raw - raw frame (first received bit is MSB)
+ * @param pos - decoded position (not changed if line fault)
+ * @return SSI_FLAG_ERR and/or SSI_FLAG_LINE, or 0 if data is good
+ */
+uint8_t ssi_decode(const ssi_conf *c, uint32_t raw, uint32_t *pos){
+    if(raw == 0 || raw == 0xffffffff) return SSI_FLAG_LINE;
+    if(c->flags & SSI_INVERT) raw = ~raw;
+    uint8_t ret = 0;
+    uint32_t data = (raw << c->skip) >> (32 - c->bits);
+    if((c->flags & SSI_ERRBIT) && c->skip + c->bits < 32){
+        uint8_t e = (raw << (c->skip + c->bits)) >> 31;
+        if(c->flags & SSI_ERRLOW) e = !e;
+        if(e) ret = SSI_FLAG_ERR;
+    }
+    if(c->flags & SSI_GRAY) data = ssi_gray2bin(data);
+    *pos = data;
+    return ret;
+}
+
+void ssi_init(ssi_state *s, const ssi_conf *c){
+    s->conf = *c;
+    if(s->conf.velwin < 2) s->conf.velwin = 2;
+    else if(s->conf.velwin > SSI_VELWIN_MAX) s->conf.velwin = SSI_VELWIN_MAX;
+    s->raw = s->pos = s->T = s->nerrors = 0;
+    s->vel = 0;
+    s->flags = s->seq = 0;
+    s->hidx = s->hcnt = 0;
+}
+
+// velocity by oldest and newest samples in history
+static int32_t velocity(ssi_state *s){
+    uint8_t n = s->hcnt, last = (s->hidx + SSI_VELWIN_MAX - 1) % SSI_VELWIN_MAX;
+    if(n < 2) return 0;
+    uint8_t first = (s->hidx + SSI_VELWIN_MAX - n) % SSI_VELWIN_MAX;
+    uint32_t dt = s->hT[last] - s->hT[first];
+    if(!dt) return 0;
+    uint32_t range = 1UL << s->conf.bits, mask = range - 1;
+    int64_t d = (s->hpos[last] - s->hpos[first]) & mask; // position can wrap
+    if(d >= (int64_t)(range >> 1)) d -= range;
+    int64_t v = d * 1000000 / dt;
+    if(v > SSI_VELMAX){
+        v = SSI_VELMAX;
+        s->flags |= SSI_FLAG_VSAT;
+    }else if(v < -SSI_VELMAX){
+        v = -SSI_VELMAX;
+        s->flags |= SSI_FLAG_VSAT;
+    }
+    return (int32_t)v;
+}
+
+/**
+ * @brief ssi_sample - process next frame
+ * @param s - state
+ * @param raw - raw frame
+ * @param T - time of sampling, us
+ * @param synced - !=0 if sampling is aligned by SYNC
+ */
+void ssi_sample(ssi_state *s, uint32_t raw, uint32_t T, uint8_t synced){
+    uint32_t pos;
+    s->raw = raw;
+    s->T = T;
+    ++s->seq;
+    s->flags = ssi_decode(&s->conf, raw, &pos);
+    if(synced) s->flags |= SSI_FLAG_SYNC;
+    if(s->flags & (SSI_FLAG_ERR | SSI_FLAG_LINE)){ // don't use bad data
+        ++s->nerrors;
+        return;
+    }
+    s->pos = pos;
+    s->hpos[s->hidx] = pos;
+    s->hT[s->hidx] = T;
+    if(++s->hidx == SSI_VELWIN_MAX) s->hidx = 0;
+    if(s->hcnt < s->conf.velwin) ++s->hcnt;
+    s->vel = velocity(s);
+}
+
+/**
+ * @brief ssi_pack - pack last sample into CAN frame (big-endian):
+ *      0..3 - position, 4..6 - velocity (signed 24 bit), 7 - flags (high nibble) and sequence (low nibble)
+ */
+void ssi_pack(const ssi_state *s, uint8_t msg[8]){
+    uint32_t v = (uint32_t)s->vel;
+    msg[0] = s->pos >> 24;
+    msg[1] = (s->pos >> 16) & 0xff;
+    msg[2] = (s->pos >> 8) & 0xff;
+    msg[3] = s->pos & 0xff;
+    msg[4] = (v >> 16) & 0xff;
+    msg[5] = (v >> 8) & 0xff;
+    msg[6] = v & 0xff;
+    msg[7] = (uint8_t)((s->flags << 4) | (s->seq & 0x0f));
+}
@@ -0,0 +1,80 @@
+/*
+ * This file is part of the CANBUS_SSI project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef SSI_H__
+#define SSI_H__
+
+#include <stdint.h>
+
+/*
+ * SSI frame decoding and velocity calculation (hardware-independent).
+ * Raw frame is 32 bits clocked out MSB first (bytes in order of receiving):
+ *      [skip leading bits][`bits` data bits, MSB first][error bit (if SSI_ERRBIT)][rest]
+ * Frames with all zeros or all ones are treated as line fault.
+ * Velocity is calculated by `velwin` last good samples: difference of positions (modulo 2^bits)
+ * divided by difference of their timestamps.
+ */
+
+// encoder configuration flags
+#define SSI_GRAY        (1<<0)  // data is Gray code
+#define SSI_INVERT      (1<<1)  // data line is inverted
+#define SSI_ERRBIT      (1<<2)  // error bit follows data bits
+#define SSI_ERRLOW      (1<<3)  // error bit is active low
+
+// sample flags (4 bits)
+#define SSI_FLAG_ERR    (1<<0)  // encoder's error bit is active
+#define SSI_FLAG_LINE   (1<<1)  // line fault: all zeros or all ones
+#define SSI_FLAG_VSAT   (1<<2)  // velocity saturated
+#define SSI_FLAG_SYNC   (1<<3)  // sampling is aligned by CAN SYNC
+
+// max length of velocity window, samples
+#define SSI_VELWIN_MAX  (16)
+// max abs value of velocity (24 bits in CAN frame), counts per second
+#define SSI_VELMAX      (0x7fffff)
+
+typedef struct{
+    uint8_t bits;       // amount of data bits (1..31)
+    uint8_t skip;       // amount of leading bits to skip
+    uint8_t flags;      // SSI_GRAY etc
+    uint8_t velwin;     // velocity window (2..SSI_VELWIN_MAX)
+} ssi_conf;
+
+typedef struct{
+    uint32_t raw;       // last raw frame
+    uint32_t pos;       // position of last good sample
+    int32_t vel;        // velocity, counts per second
+    uint32_t T;         // timestamp of last sample, us
+    uint32_t nerrors;   // amount of bad frames
+    uint8_t flags;      // SSI_FLAG_* of last sample
+    uint8_t seq;        // sample number
+    // private
+    ssi_conf conf;
+    uint32_t hpos[SSI_VELWIN_MAX];  // history of good samples
+    uint32_t hT[SSI_VELWIN_MAX];
+    uint8_t hidx;       // index of next history cell
+    uint8_t hcnt;       // amount of samples in history
+} ssi_state;
+
+uint32_t ssi_gray2bin(uint32_t g);
+uint8_t ssi_decode(const ssi_conf *c, uint32_t raw, uint32_t *pos);
+void ssi_init(ssi_state *s, const ssi_conf *c);
+void ssi_sample(ssi_state *s, uint32_t raw, uint32_t T, uint8_t synced);
+void ssi_pack(const ssi_state *s, uint8_t msg[8]);
+
+#endif // SSI_H__
@@ -0,0 +1,226 @@
+/*
+ * This file is part of the CANBUS_SSI project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host checker of SSI decoder (../ssi.c): random frames are built for different encoder configurations
+// (Gray/binary, inversion, error bit) and decoded back; velocity is checked on simulated motion sampled
+// with period changes made by SYNC alignment, with position wrapping and bad frames inside.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+#include "../ssi.h"
+
+static uint32_t rand32(){
+    return ((uint32_t)lrand48() << 16) ^ (uint32_t)lrand48();
+}
+
+static uint32_t bin2gray(uint32_t b){
+    return b ^ (b >> 1);
+}
+
+// build frame: random leading and trailing bits around data and error bit
+static uint32_t mkframe(const ssi_conf *c, uint32_t pos, int err){
+    uint32_t data = (c->flags & SSI_GRAY) ? bin2gray(pos) : pos;
+    uint32_t raw = rand32();
+    int shift = 32 - c->skip - c->bits;
+    uint32_t mask = ((c->bits == 32) ? 0xffffffff : ((1UL << c->bits) - 1)) << shift;
+    raw = (raw & ~mask) | ((data << shift) & mask);
+    if(c->flags & SSI_ERRBIT){
+        uint32_t ebit = 1UL << (shift - 1);
+        int e = (c->flags & SSI_ERRLOW) ? !err : err;
+        if(e) raw |= ebit;
+        else raw &= ~ebit;
+    }
+    if(c->flags & SSI_INVERT) raw = ~raw;
+    return raw;
+}
+
+static void rndconf(ssi_conf *c){
+    c->flags = lrand48() & (SSI_GRAY | SSI_INVERT | SSI_ERRBIT | SSI_ERRLOW);
+    c->bits = 1 + lrand48() % 31;
+    int maxskip = 32 - c->bits - ((c->flags & SSI_ERRBIT) ? 1 : 0);
+    c->skip = maxskip ? lrand48() % (maxskip + 1) : 0;
+    c->velwin = 2 + lrand48() % (SSI_VELWIN_MAX - 1);
+}
+
+static int chkgray(){
+    int bad = 0;
+    for(int i = 0; i < 100000; ++i){
+        uint32_t b = rand32();
+        if(ssi_gray2bin(bin2gray(b)) != b){
+            if(verbose) printf("gray2bin(%08x) failed\n", bin2gray(b));
+            bad = 1;
+        }
+    }
+    for(uint32_t b = 0; b < 1000; ++b){ // neighbours differ by one bit
+        uint32_t x = bin2gray(b) ^ bin2gray(b + 1);
+        if(x & (x - 1)) bad = 1;
+    }
+    return chkfail("Gray code", bad);
+}
+
+static int chkdecode(){
+    int bad = 0;
+    for(int i = 0; i < 100000; ++i){
+        ssi_conf c;
+        rndconf(&c);
+        uint32_t pos = rand32() & ((1UL << c.bits) - 1), dec = 0;
+        int err = (c.flags & SSI_ERRBIT) ? (lrand48() & 1) : 0;
+        uint32_t raw = mkframe(&c, pos, err);
+        uint8_t f = ssi_decode(&c, raw, &dec);
+        if(raw == 0 || raw == 0xffffffff){
+            if(f != SSI_FLAG_LINE) bad = 1;
+            continue;
+        }
+        if(dec != pos || f != (err ? SSI_FLAG_ERR : 0)){
+            if(verbose) printf("bits=%d, skip=%d, flags=%d: raw=%08x, pos=%u, err=%d -> pos=%u, flags=%d\n",
+                               c.bits, c.skip, c.flags, raw, pos, err, dec, f);
+            bad = 1;
+        }
+    }
+    // line fault
+    ssi_conf c = {13, 1, SSI_INVERT, 8};
+    uint32_t dec = 12345;
+    if(ssi_decode(&c, 0, &dec) != SSI_FLAG_LINE || ssi_decode(&c, 0xffffffff, &dec) != SSI_FLAG_LINE || dec != 12345) bad = 1;
+    return chkfail("decode", bad);
+}
+
+/**
+ * @brief run - sample encoder rotating with constant speed
+ * @param c - configuration
+ * @param v - speed, counts per second
+ * @param period - sampling period, us
+ * @param pbad - probability of bad frame
+ * @param maxerr - max velocity error (counts per second)
+ * @return 1 if failed
+ */
+static int run(const ssi_conf *c, double v, uint32_t period, double pbad, double *maxerr){
+    ssi_state s;
+    ssi_init(&s, c);
+    uint32_t range = 1UL << c->bits, T = rand32(), nbad = 0;
+    double x0 = drand48() * range;
+    double t = 0.;
+    int bad = 0, ngood = 0;
+    *maxerr = 0.;
+    for(int i = 0; i < 5000; ++i){
+        // SYNC can make period longer or shorter
+        uint32_t dt = period;
+        if(lrand48() % 50 == 0) dt = period / 2 + lrand48() % period;
+        T += dt;
+        t += dt * 1e-6;
+        double x = x0 + v * t;
+        uint32_t pos = (uint32_t)(int64_t)floor(x) & (range - 1);
+        int b = drand48() < pbad;
+        uint32_t raw;
+        if(b){
+            if(lrand48() & 1) raw = 0xffffffff;
+            else if(c->flags & SSI_ERRBIT) raw = mkframe(c, pos ^ (range / 3), 1);
+            else raw = 0;
+            ++nbad;
+        }else{
+            raw = mkframe(c, pos, 0);
+            if(raw == 0 || raw == 0xffffffff){ // random frame looks like line fault
+                b = 1;
+                ++nbad;
+            }
+        }
+        ssi_sample(&s, raw, T, 0);
+        if(b){
+            if(!(s.flags & (SSI_FLAG_ERR | SSI_FLAG_LINE))) bad = 1;
+            continue;
+        }
+        if(s.pos != pos) bad = 1;
+        if(++ngood < SSI_VELWIN_MAX + 1) continue;
+        double err = fabs(s.vel - v);
+        if(err > *maxerr) *maxerr = err;
+    }
+    if(s.nerrors != nbad) bad = 1;
+    return bad;
+}
+
+static int chkvel(){
+    int bad = 0;
+    const double speeds[] = {0., 3., -50., 1000., -123456., 2e6, -3e6};
+    for(size_t i = 0; i < sizeof(speeds)/sizeof(speeds[0]); ++i){
+        for(int j = 0; j < 20; ++j){
+            ssi_conf c;
+            rndconf(&c);
+            if(c.bits < 12) c.bits = 12 + lrand48() % 8;
+            if(c.skip + c.bits + 1 > 32) c.skip = 0;
+            uint32_t period = 200 + lrand48() % 2000;
+            // window should be less than half of turn (with margin for bad frames and long periods)
+            if(fabs(speeds[i]) * period * 1e-6 * c.velwin > (1UL << c.bits) / 4) continue;
+            double maxerr;
+            int b = run(&c, speeds[i], period, 0.05, &maxerr);
+            // quantization: one count per window of at least (velwin-1)*period/2 us
+            double lim = 1e6 / ((c.velwin - 1) * period / 2.) + 1.;
+            if(maxerr > lim) b = 1;
+            if(b || verbose) printf("v=%g, bits=%d, win=%d, period=%u: max error %.1f (limit %.1f)\n",
+                                    speeds[i], c.bits, c.velwin, period, maxerr, lim);
+            bad |= b;
+        }
+    }
+    return chkfail("velocity", bad);
+}
+
+static int chksat(){
+    ssi_conf c = {24, 0, 0, 2};
+    ssi_state s;
+    ssi_init(&s, &c);
+    ssi_sample(&s, mkframe(&c, 0, 0), 0, 0);
+    ssi_sample(&s, mkframe(&c, 1000000, 0), 100000, 1); // 1e7 counts per second
+    int bad = !(s.flags & SSI_FLAG_VSAT) || !(s.flags & SSI_FLAG_SYNC) || s.vel != SSI_VELMAX;
+    ssi_sample(&s, mkframe(&c, 0, 0), 200000, 0);
+    if(!(s.flags & SSI_FLAG_VSAT) || s.vel != -SSI_VELMAX || (s.flags & SSI_FLAG_SYNC)) bad = 1;
+    return chkfail("saturation", bad);
+}
+
+static int chkpack(){
+    int bad = 0;
+    for(int i = 0; i < 10000; ++i){
+        ssi_state s;
+        s.pos = rand32();
+        s.vel = (int32_t)(rand32() % (2*SSI_VELMAX + 1)) - SSI_VELMAX;
+        s.flags = lrand48() & 0x0f;
+        s.seq = lrand48() & 0xff;
+        uint8_t m[8];
+        ssi_pack(&s, m);
+        uint32_t pos = ((uint32_t)m[0] << 24) | ((uint32_t)m[1] << 16) | ((uint32_t)m[2] << 8) | m[3];
+        int32_t vel = ((int32_t)m[4] << 16) | (m[5] << 8) | m[6];
+        if(vel & 0x800000) vel -= 0x1000000;
+        if(pos != s.pos || vel != s.vel || (m[7] >> 4) != s.flags || (m[7] & 0x0f) != (s.seq & 0x0f)){
+            if(verbose) printf("pos=%u, vel=%d -> %u, %d\n", s.pos, s.vel, pos, vel);
+            bad = 1;
+        }
+    }
+    return chkfail("CAN frame", bad);
+}
+
+int main(int argc, char **argv){
+    hosttest_opts(argc, argv);
+    int ret = chkgray();
+    ret |= chkdecode();
+    ret |= chkvel();
+    ret |= chksat();
+    ret |= chkpack();
+    return hosttest_result(ret);
+}
@@ -0,0 +1,253 @@
+/*
+ * This file is part of the CANBUS_SSI project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host checker of distributed clock (../cansync.c): master and slave have drifting crystals (slave's one
+// also wanders with temperature); master timestamps SYNC in TX complete IRQ, slave - in RX IRQ, both with
+// random latency and rare long delays; some SYNC and follow-up messages are lost. Skew between slave's
+// global time and master's clock is checked at random moments.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+#include "../cansync.h"
+
+// crystal: local = off + t*(1+drift) + wander
+typedef struct{
+    double off;     // initial value, us
+    double drift;   // relative
+    double wamp;    // wander amplitude (relative)
+    double wper;    // wander period, s
+} xtal_t;
+
+// local counter @ true time t (us)
+static uint32_t xlocal(const xtal_t *x, double t){
+    double w = 0.;
+    if(x->wamp != 0.) w = x->wamp * x->wper * 1e6 / (2.*M_PI) * (1. - cos(2.*M_PI * t * 1e-6 / x->wper));
+    double l = x->off + t * (1. + x->drift) + w;
+    return (uint32_t)(uint64_t)floor(fmod(l, 4294967296.));
+}
+
+// latency of IRQ, us: mostly `base` plus rare long delays
+static double latency(double base, double plong, double lmax){
+    double l = 1. + drand48() * base;
+    if(drand48() < plong) l += lmax * (0.2 + 0.8 * drand48());
+    return l;
+}
+
+typedef struct{
+    double maxskew;     // max abs skew after lock
+    double sumskew;
+    int nskew;
+    double locktime;    // time of first lock, s
+    int badstep;        // global time jumped back or too far
+    int gapstate;       // state of slave @ end of SYNC gap
+} stat_t;
+
+// RX IRQ happens earlier than TX complete IRQ (EOF isn't finished yet), us
+#define RXTXDELAY   (10.)
+// max skew of locked clock, us
+#define MAXSKEW     (25.)
+
+typedef struct{
+    xtal_t xm, xs;      // master and slave crystals
+    double period;      // SYNC period, s
+    double plost;       // probability to lose message
+    double plong;       // probability of long IRQ latency
+    double mstep;       // step of master's time @ `tstep` (restart), us
+    double tstep;
+    double tgap0, tgap1;// no SYNC in this interval, s
+    double settle;      // check skew after this time, s
+} sim_t;
+
+/**
+ * @brief run - simulate master and slave
+ * @param p - parameters
+ * @param dur - duration, s
+ * @param s - slave's clock (result)
+ * @param st - statistics
+ */
+static void run(const sim_t *p, double dur, cs_state *s, stat_t *st){
+    cs_state m;
+    xtal_t xm = p->xm;
+    memset(st, 0, sizeof(stat_t));
+    st->locktime = -1.;
+    st->gapstate = -1;
+    cs_init(&m, xlocal(&xm, 0.));
+    cs_init(s, xlocal(&p->xs, 0.));
+    int stepped = 0;
+    double lastcheck = 0.;
+    for(double tsync = p->period; tsync < dur; tsync += p->period){
+        double t = tsync * 1e6 + drand48() * 1000.; // EOF of SYNC
+        if(!stepped && p->mstep != 0. && tsync > p->tstep){ // master restarted
+            xm.off += p->mstep;
+            cs_init(&m, xlocal(&xm, t));
+            stepped = 1;
+        }
+        // check skew between SYNCs and call cs_check() every second
+        for(int i = 0; i < 10; ++i){
+            double tc = (tsync - p->period) * 1e6 + drand48() * p->period * 1e6;
+            if(tc - lastcheck > 1e6){
+                cs_check(&m, xlocal(&xm, tc));
+                cs_check(s, xlocal(&p->xs, tc));
+                lastcheck = tc;
+            }
+            uint64_t g = cs_global(s, xlocal(&p->xs, tc));
+            if(s->state != CS_LOCKED || tc < p->settle * 1e6) continue;
+            double skew = (double)(int64_t)(g - cs_global(&m, xlocal(&xm, tc)));
+            if(fabs(skew) > st->maxskew) st->maxskew = fabs(skew);
+            st->sumskew += fabs(skew);
+            ++st->nskew;
+        }
+        if(tsync > p->tgap0 && tsync < p->tgap1){
+            st->gapstate = s->state;
+            continue;
+        }
+        // master: TX complete IRQ
+        uint32_t ml = xlocal(&xm, t + latency(4., p->plong, 60.));
+        cs_master(&m, ml);
+        uint64_t mg = cs_global(&m, ml);
+        // slave: RX IRQ and follow-up
+        if(drand48() < p->plost) continue; // SYNC lost
+        uint32_t sl = xlocal(&p->xs, t - RXTXDELAY + latency(7., p->plong, 400.));
+        if(drand48() < p->plost) continue; // follow-up lost
+        uint64_t before = cs_global(s, sl);
+        cs_measure(s, sl, mg - (uint64_t)RXTXDELAY);
+        uint64_t after = cs_global(s, sl);
+        // global time shouldn't jump when locked (half of error <= CS_OUTLIER/2)
+        if(s->state == CS_LOCKED && (int64_t)(after - before) > CS_OUTLIER) ++st->badstep;
+        if(st->locktime < 0. && s->state == CS_LOCKED) st->locktime = tsync;
+        if(verbose > 1) printf("t=%.1f: state=%d, err=%d, ppm=%d\n", tsync, s->state, s->err, cs_ppm(s));
+    }
+}
+
+static void defsim(sim_t *p){
+    memset(p, 0, sizeof(sim_t));
+    p->xm.off = drand48() * 4e9;
+    p->xm.drift = (drand48() - 0.5) * 1e-4;
+    p->xs.off = drand48() * 4e9;
+    p->xs.drift = (drand48() - 0.5) * 1e-4;
+    p->xs.wamp = 2e-6;
+    p->xs.wper = 300.;
+    p->period = 1.;
+    p->plost = 0.03;
+    p->plong = 0.02;
+    p->settle = 60.;
+}
+
+static int chklock(){
+    int bad = 0;
+    const double periods[] = {1., 0.25, 2.};
+    for(size_t i = 0; i < sizeof(periods)/sizeof(periods[0]); ++i){
+        for(int j = 0; j < 5; ++j){
+            sim_t p;
+            defsim(&p);
+            p.period = periods[i];
+            cs_state s;
+            stat_t st;
+            run(&p, 600., &s, &st);
+            // latencies: 1..5us (master) and 1..8us (slave), so 7us of difference + crystal wander + delayed IRQs
+            int b = st.locktime < 0. || st.locktime > 20. * p.period || st.maxskew > MAXSKEW || st.badstep
+                    || s.state != CS_LOCKED;
+            if(b || verbose) printf("period=%g, drift=%.1f/%.1fppm: lock @ %gs, skew max=%.1f, mean=%.2fus, ppm=%d, "
+                                    "outliers=%u, resets=%u\n", p.period, p.xm.drift*1e6, p.xs.drift*1e6, st.locktime,
+                                    st.maxskew, st.sumskew / st.nskew, cs_ppm(&s), s.noutl, s.nreset);
+            bad |= b;
+        }
+    }
+    return chkfail("lock", bad);
+}
+
+// 2 hours: local counters wrap
+static int chkwrap(){
+    sim_t p;
+    defsim(&p);
+    p.xs.off = 4294967296. - 100e6;
+    p.xm.off = 4294967296. - 50e6;
+    cs_state s;
+    stat_t st;
+    run(&p, 7300., &s, &st);
+    int bad = st.maxskew > MAXSKEW || st.badstep || s.state != CS_LOCKED || s.nreset;
+    if(bad || verbose) printf("skew max=%.1f, mean=%.2fus, resets=%u\n", st.maxskew, st.sumskew / st.nskew, s.nreset);
+    return chkfail("counters overflow", bad);
+}
+
+// master restarts with other time
+static int chkrestart(){
+    sim_t p;
+    defsim(&p);
+    p.mstep = 5e6;
+    p.tstep = 100.;
+    p.settle = 160.;
+    cs_state s;
+    stat_t st;
+    run(&p, 300., &s, &st);
+    int bad = st.maxskew > MAXSKEW || s.state != CS_LOCKED || s.nreset < 1;
+    if(bad || verbose) printf("skew max=%.1f, resets=%u\n", st.maxskew, s.nreset);
+    return chkfail("master restart", bad);
+}
+
+// no SYNC for a long time
+static int chkgap(){
+    sim_t p;
+    defsim(&p);
+    p.tgap0 = 100.;
+    p.tgap1 = 130.;
+    p.plost = 0.;
+    p.settle = 170.;
+    cs_state s;
+    stat_t st;
+    run(&p, 200., &s, &st);
+    int bad = st.gapstate != CS_UNSYNC || s.nreset != 1 || s.state != CS_LOCKED || st.maxskew > MAXSKEW;
+    if(bad || verbose) printf("state in gap=%d, state=%d, resets=%u, skew max=%.1f\n", st.gapstate, s.state,
+                              s.nreset, st.maxskew);
+    return chkfail("SYNC loss", bad);
+}
+
+// inverse mapping
+static int chkinverse(){
+    int bad = 0;
+    cs_state s;
+    cs_init(&s, 123);
+    for(int i = 0; i < 100000; ++i){
+        s.lref = (uint32_t)lrand48();
+        s.gref = ((uint64_t)lrand48() << 20) ^ lrand48();
+        s.rate = (int32_t)((drand48() - 0.5) * 2. * CS_MAXPPM * 4295.);
+        uint64_t g = s.gref + (int64_t)((drand48() - 0.5) * 4e9 * (1. - CS_MAXPPM*1e-6)); // |dl| < 2^31
+        uint64_t g1 = cs_global(&s, cs_local(&s, g));
+        int64_t d = (int64_t)(g1 - g);
+        if(d > 2 || d < -2){ // rounding
+            if(verbose && !bad) printf("g=%llu -> %llu\n", (unsigned long long)g, (unsigned long long)g1);
+            bad = 1;
+        }
+    }
+    return chkfail("inverse mapping", bad);
+}
+
+int main(int argc, char **argv){
+    hosttest_opts(argc, argv);
+    int ret = chkinverse();
+    ret |= chklock();
+    ret |= chkwrap();
+    ret |= chkrestart();
+    ret |= chkgap();
+    return hosttest_result(ret);
+}
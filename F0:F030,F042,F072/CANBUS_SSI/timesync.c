@@ -0,0 +1,206 @@
+/*
+ * This file is part of the CANBUS_SSI project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "can.h"
+#include "flash.h"
+#include "hardware.h"
+#include "timesync.h"
+
+#include <string.h> // memcpy
+
+static cs_state clk;                // local clock disciplined by master
+static ts_slot slots[TS_NSLOTS];    // time-triggered messages
+static volatile uint8_t rxseq = 0, rxvalid = 0, txdone = 0;
+static volatile uint32_t rxT = 0, txT = 0; // local time of last SYNC received/transmitted
+static uint8_t seq = 0;             // number of last SYNC transmitted
+static uint8_t fup[8], fuppending = 0; // follow-up waiting for free mailbox
+static uint32_t syncTms = 0, checkTms = 0;
+
+/**
+ * @brief rearm - set TIM2 CC1 to the nearest time-triggered message (call it with IRQs disabled)
+ * Slots with next time far from current global time (new one or clock was stepped) are aligned to
+ * the next multiple of their period.
+ */
+static void rearm(){
+    uint64_t g = cs_global(&clk, Tus()), nearest = 0;
+    uint8_t have = 0;
+    for(int i = 0; i < TS_NSLOTS; ++i){
+        ts_slot *s = &slots[i];
+        if(!s->period) continue;
+        if(s->next > g + s->period || s->next + s->period < g) s->next = (g / s->period + 1) * s->period;
+        if(!have || s->next < nearest) nearest = s->next;
+        have = 1;
+    }
+    if(!have){
+        TIM2->DIER = 0;
+        return;
+    }
+    uint32_t l = cs_local(&clk, nearest);
+    TIM2->CCR1 = l;
+    TIM2->SR = ~TIM_SR_CC1IF;
+    TIM2->DIER = TIM_DIER_CC1IE;
+    if((int32_t)(l - Tus()) <= 0) TIM2->EGR = TIM_EGR_CC1G; // already late
+}
+
+/**
+ * @brief TS_setup - (re)start local clock (call it after TIM2 setup and after changing of sync options)
+ */
+void TS_setup(){
+    __disable_irq();
+    cs_init(&clk, Tus());
+    rxvalid = txdone = fuppending = 0;
+    TIM2->SR = 0;
+    rearm();
+    __enable_irq();
+    NVIC_SetPriority(TIM2_IRQn, 1); // CAN IRQ (timestamps) is more important
+    NVIC_EnableIRQ(TIM2_IRQn);
+}
+
+// time-triggered messages
+void tim2_isr(){
+    TIM2->SR = ~TIM_SR_CC1IF;
+    uint64_t g = cs_global(&clk, Tus());
+    uint8_t synced = (clk.state == CS_LOCKED || clk.state == CS_MASTER);
+    for(int i = 0; i < TS_NSLOTS; ++i){
+        ts_slot *s = &slots[i];
+        if(!s->period || s->next > g) continue;
+        uint32_t late = (uint32_t)(g - s->next);
+        if(synced && CAN_OK == can_send(s->data, s->len, s->ID)){
+            ++s->nsent;
+            s->late = late;
+            if(late > s->latemax) s->latemax = late;
+        }else ++s->nmiss;
+        s->next += s->period;
+    }
+    rearm();
+}
+
+/**
+ * @brief TS_proc - master sends SYNC and follow-up, slave checks SYNC timeout
+ */
+void TS_proc(){
+    if(!the_conf.syncID) return;
+    if(Tms - checkTms > 999){
+        checkTms = Tms;
+        __disable_irq();
+        cs_check(&clk, Tus());
+        __enable_irq();
+    }
+    if(!the_conf.syncmaster) return;
+    if(txdone){ // SYNC transmitted: send its global time
+        __disable_irq();
+        txdone = 0;
+        cs_master(&clk, txT);
+        uint64_t g = cs_global(&clk, txT);
+        __enable_irq();
+        fup[0] = seq;
+        for(int i = 7; i > 0; --i){
+            fup[i] = g & 0xff;
+            g >>= 8;
+        }
+        fuppending = 1;
+    }
+    if(fuppending){
+        if(CAN_OK == can_send(fup, 8, the_conf.syncID + 1)) fuppending = 0;
+        return;
+    }
+    if(Tms - syncTms >= the_conf.syncperiod && CAN_OK == can_send_sync(seq + 1)){
+        syncTms = Tms;
+        ++seq;
+    }
+}
+
+// SYNC received (called from CAN IRQ)
+void TS_rxsync(uint8_t n, uint32_t T){
+    if(the_conf.syncmaster) return;
+    rxseq = n;
+    rxT = T;
+    rxvalid = 1;
+}
+
+// SYNC transmitted (called from CAN IRQ)
+void TS_txsync(uint32_t T){
+    txT = T;
+    txdone = 1;
+}
+
+/**
+ * @brief TS_followup - process follow-up message: sequence number and global time of SYNC transmission
+ *      (56 bits, big-endian); RX IRQ happens `syncadj` us earlier than TX complete IRQ
+ */
+void TS_followup(const uint8_t data[8]){
+    if(the_conf.syncmaster) return;
+    uint64_t g = 0;
+    for(int i = 1; i < 8; ++i) g = (g << 8) | data[i];
+    g -= (int64_t)the_conf.syncadj;
+    __disable_irq();
+    if(rxvalid && data[0] == rxseq){
+        rxvalid = 0;
+        cs_measure(&clk, rxT, g);
+        rearm();
+    }
+    __enable_irq();
+}
+
+// current global time, us
+uint64_t TS_global(){
+    __disable_irq();
+    uint64_t g = cs_global(&clk, Tus());
+    __enable_irq();
+    return g;
+}
+
+/**
+ * @brief TS_getclock - get copy of clock state
+ * @param c - copy
+ * @param reset - !=0 to reset statistics
+ */
+void TS_getclock(cs_state *c, uint8_t reset){
+    __disable_irq();
+    memcpy(c, &clk, sizeof(cs_state));
+    if(reset) cs_clrstat(&clk);
+    __enable_irq();
+}
+
+/**
+ * @brief TS_schedule - set time-triggered message
+ * @param n - slot number
+ * @param period - period, us (0 to clear slot); messages are sent when global time is multiple of period
+ * @param ID, data, len - message
+ * @return 0 if slot number is wrong
+ */
+uint8_t TS_schedule(uint8_t n, uint32_t period, uint16_t ID, const uint8_t *data, uint8_t len){
+    if(n >= TS_NSLOTS || len > 8) return 0;
+    __disable_irq();
+    ts_slot *s = &slots[n];
+    memset(s, 0, sizeof(ts_slot));
+    s->period = period;
+    s->ID = ID;
+    s->len = len;
+    if(len) memcpy(s->data, data, len);
+    rearm();
+    __enable_irq();
+    return 1;
+}
+
+void TS_getslot(uint8_t n, ts_slot *s){
+    if(n >= TS_NSLOTS) return;
+    __disable_irq();
+    memcpy(s, &slots[n], sizeof(ts_slot));
+    __enable_irq();
+}
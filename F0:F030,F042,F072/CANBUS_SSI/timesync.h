@@ -0,0 +1,53 @@
+/*
+ * This file is part of the CANBUS_SSI project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef TIMESYNC_H__
+#define TIMESYNC_H__
+
+#include "cansync.h"
+
+// amount of time-triggered messages
+#define TS_NSLOTS       (4)
+// min SYNC period, ms
+#define TS_MINPERIOD    (10)
+
+// time-triggered CAN message
+typedef struct{
+    uint32_t period;    // period, us (0 - slot is empty)
+    uint64_t next;      // global time of next transmission
+    uint16_t ID;
+    uint8_t len;
+    uint8_t data[8];
+    uint32_t nsent;     // amount of messages sent
+    uint32_t nmiss;     // amount of missed (clock isn't synchronized or no free mailboxes)
+    uint32_t late;      // lateness of last message, us
+    uint32_t latemax;   // max lateness
+} ts_slot;
+
+void TS_setup();
+void TS_proc();
+void TS_rxsync(uint8_t seq, uint32_t T);
+void TS_txsync(uint32_t T);
+void TS_followup(const uint8_t data[8]);
+uint64_t TS_global();
+void TS_getclock(cs_state *c, uint8_t reset);
+uint8_t TS_schedule(uint8_t n, uint32_t period, uint16_t ID, const uint8_t *data, uint8_t len);
+void TS_getslot(uint8_t n, ts_slot *s);
+
+#endif // TIMESYNC_H__
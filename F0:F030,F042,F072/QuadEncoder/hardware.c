@@ -19,6 +19,9 @@
 #include "usart.h"
 
 volatile uint8_t tim3upd = 0;
+volatile uint32_t mtsamples = 0; // amount of velocity samples
+
+static mt_state mtstate;
 
 /**
  * @brief gpio_setup - setup GPIOs for external IO
@@ -52,10 +55,27 @@ static inline void timers_setup(){
     // enable update interrupt
     TIM3->DIER = TIM_DIER_UIE;
     // set ARR to 79 - generate interrupt each 80 counts (one revolution)
-    TIM3->ARR = 79;
+    TIM3->ARR = MT_ENCREV - 1;
+    // capture counter @ rising edges of channel A and send TRGO pulse to TIM1
+    TIM3->CCER = TIM_CCER_CC1E;
+    TIM3->CR2 = TIM_CR2_MMS_0 | TIM_CR2_MMS_1;
     // enable timer
     TIM3->CR1 = TIM_CR1_CEN; /* (4) */
     NVIC_EnableIRQ(TIM3_IRQn);
+    // TIM1 - 1MHz time base: CH1 captures time of edges (TRC = ITR2 = TIM3 TRGO),
+    // CH2 compare interrupt - velocity sampling
+    RCC->APB2ENR |= RCC_APB2ENR_TIM1EN;
+    TIM1->PSC = 47;
+    TIM1->ARR = 0xffff;
+    TIM1->SMCR = TIM_SMCR_TS_1;
+    TIM1->CCMR1 = TIM_CCMR1_CC1S;
+    TIM1->CCER = TIM_CCER_CC1E;
+    TIM1->CCR2 = MT_SAMPLE;
+    TIM1->DIER = TIM_DIER_CC2IE;
+    mt_init(&mtstate);
+    TIM1->CR1 = TIM_CR1_CEN;
+    NVIC_SetPriority(TIM1_CC_IRQn, 1);
+    NVIC_EnableIRQ(TIM1_CC_IRQn);
 }
 
 void hw_setup(){
@@ -65,6 +85,30 @@ void hw_setup(){
     USART1_config();
 }
 
+// get copy of velocity estimator state
+void mt_get(mt_state *m){
+    __disable_irq();
+    *m = mtstate;
+    __enable_irq();
+}
+
+// velocity sampling
+void tim1_cc_isr(){
+    if(!(TIM1->SR & TIM_SR_CC2IF)) return;
+    TIM1->SR = ~TIM_SR_CC2IF; // don't touch CC1IF
+    TIM1->CCR2 += MT_SAMPLE;
+    uint16_t capT, capcnt;
+    uint8_t newedge;
+    do{ // TIM1 captures a little later than TIM3, so read it first and repeat if new edge came
+        newedge = (TIM1->SR & TIM_SR_CC1IF) ? 1 : 0;
+        capT = TIM1->CCR1; // clear CC1IF
+        capcnt = TIM3->CCR1;
+    }while(TIM1->SR & TIM_SR_CC1IF);
+    uint16_t cnt = TIM3->CNT, now = TIM1->CNT;
+    mt_sample(&mtstate, cnt, capcnt, capT, newedge, now);
+    ++mtsamples;
+}
+
 void tim3_isr(){
     if(TIM3->SR & TIM_SR_UIF){
         tim3upd = 1;
@@ -19,9 +19,15 @@
 #ifndef HARDWARE_H__
 #define HARDWARE_H__
 #include "stm32f0.h"
+#include "mtvel.h"
+
+// velocity sampling period (TIM1 ticks, us)
+#define MT_SAMPLE   (1000)
 
 extern volatile uint8_t tim3upd;
 extern volatile uint32_t Tms;
+extern volatile uint32_t mtsamples;
 void hw_setup(void);
+void mt_get(mt_state *m);
 
 #endif // HARDWARE_H__
@@ -45,7 +45,8 @@ int main(void){
         if(txt){ // text waits for sending
             while(ALL_OK != usart1_send(txt, 0));
         }
-        if(Tms - T == 10){
+        if(mt_stream()) T = Tms; // binary stream is on: no text
+        else if(Tms - T == 10){
             T = Tms;
             if(tim3cnt != TIM3->CNT){
                 int32_t diff = TIM3->CNT - tim3cnt;
@@ -0,0 +1,244 @@
+/*
+ * This file is part of the QuadEncoder project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host checker of M/T velocity estimator (../mtvel.c): quadrature edge trains are generated with 1us
+// resolution for different motion profiles, TIM3 (encoder, ARR=79) and TIM1 (1MHz, capture of channel A
+// rising edges) are emulated and sampled every millisecond with random latency, like in tim1_cc_isr().
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+#include "../mtvel.h"
+
+// sampling period, us
+#define TSAMPLE     (1000)
+
+// motion profile: position (counts) @ time t (s)
+typedef struct{
+    double (*x)(const void *par, double t);
+    const void *par;
+} profile_t;
+
+// emulated hardware
+typedef struct{
+    int64_t n;          // true counter
+    uint64_t t;         // time, us
+    uint16_t capcnt;    // TIM3->CCR1
+    uint16_t capT;      // TIM1->CCR1
+    uint8_t newedge;    // TIM1 CC1IF
+    double edgeT;       // true time of last edge, s
+} hw_t;
+
+// statistics of one run
+typedef struct{
+    int badpos;         // samples with wrong position
+    int nmeas;          // amount of measured velocities checked
+    double maxverr;     // max relative velocity error
+    double maxcnterr;   // max error of counts in window
+    int signerr;        // wrong sign of velocity
+    double accsum;      // sum of acceleration values
+    double accmaxerr;   // max acceleration error
+    int nacc;
+} stat_t;
+
+// one microsecond of motion: generate quadrature counts and capture channel A rising edges
+static void hwstep(hw_t *h, const profile_t *p){
+    ++h->t;
+    double t = h->t * 1e-6;
+    int64_t n = (int64_t)floor(p->x(p->par, t));
+    while(n != h->n){
+        int dir = (n > h->n) ? 1 : -1;
+        h->n += dir;
+        int64_t ph = h->n & 3; // 0: A=0,B=0; 1: A=1,B=0; 2: A=1,B=1; 3: A=0,B=1
+        if((dir > 0 && ph == 1) || (dir < 0 && ph == 2)){ // A rising
+            h->capcnt = (uint16_t)(((h->n % MT_ENCREV) + MT_ENCREV) % MT_ENCREV);
+            h->capT = (uint16_t)(h->t - lrand48() % 3); // quantization and jitter
+            h->newedge = 1;
+            h->edgeT = t;
+        }
+    }
+}
+
+/**
+ * @brief run - simulate motion
+ * @param p - profile
+ * @param dur - duration, s
+ * @param skip - don't check velocity before this time, s
+ * @param accref - reference acceleration (NAN if don't check)
+ * @param m - estimator
+ * @param s - statistics
+ */
+static void run(const profile_t *p, double dur, double skip, double accref, mt_state *m, stat_t *s){
+    hw_t h = {0};
+    h.n = (int64_t)floor(p->x(p->par, 0.));
+    memset(s, 0, sizeof(stat_t));
+    mt_init(m);
+    double prevedge = -1.;
+    int64_t turns = -1; // estimator don't know full turns @ start
+    uint64_t end = (uint64_t)(dur * 1e6), next = lrand48() % TSAMPLE;
+    while(h.t < end){
+        hwstep(&h, p);
+        if(h.t < next) continue;
+        next += TSAMPLE;
+        uint16_t now = (uint16_t)(h.t + lrand48() % 5); // ISR latency
+        uint16_t cnt = (uint16_t)(((h.n % MT_ENCREV) + MT_ENCREV) % MT_ENCREV);
+        mt_sample(m, cnt, h.capcnt, h.capT, h.newedge, now);
+        h.newedge = 0;
+        if(turns < 0) turns = h.n - m->pos;
+        if(m->pos + turns != h.n){
+            if(!s->badpos && verbose) printf("t=%.3f: pos=%d, real=%ld\n", h.t*1e-6, m->pos, (long)h.n);
+            ++s->badpos;
+        }
+        double t = h.t * 1e-6;
+        if(!(m->flags & MT_FLAG_EDGE)){
+            prevedge = h.edgeT;
+            continue;
+        }
+        if(t > skip && prevedge > 0.){ // compare with real mean velocity between edges
+            double vreal = (p->x(p->par, h.edgeT) - p->x(p->par, prevedge)) / (h.edgeT - prevedge);
+            double vest = m->vel / 256., err = fabs(vest - vreal);
+            if(err * (h.edgeT - prevedge) > s->maxcnterr) s->maxcnterr = err * (h.edgeT - prevedge);
+            if(fabs(vreal) > 100.){
+                err /= fabs(vreal);
+                if(err > s->maxverr) s->maxverr = err;
+            }
+            if(fabs(vreal) > 100. && vest * vreal < 0.) ++s->signerr;
+            ++s->nmeas;
+            if(!isnan(accref)){
+                s->accsum += m->acc;
+                err = fabs(m->acc - accref) / fabs(accref);
+                if(err > s->accmaxerr) s->accmaxerr = err;
+                ++s->nacc;
+            }
+        }
+        prevedge = h.edgeT;
+    }
+}
+
+// constant speed
+typedef struct{ double x0, v; } const_t;
+static double cx(const void *par, double t){ const const_t *c = par; return c->x0 + c->v * t; }
+
+static int chkconst(){
+    const double speeds[] = {3., -7., 50., 1000., -5000., 20000., -30000.};
+    int bad = 0;
+    mt_state m;
+    stat_t s;
+    for(size_t i = 0; i < sizeof(speeds)/sizeof(speeds[0]); ++i){
+        const_t c = {drand48() * 79., speeds[i]};
+        profile_t p = {cx, &c};
+        double dur = (fabs(c.v) < 10.) ? 10. : 2.;
+        run(&p, dur, 0., NAN, &m, &s);
+        // 1us quantization of window (1ms for high speed) + +-1us jitter of each edge
+        int b = s.badpos || s.nmeas == 0 || s.maxverr > 0.005 || s.signerr || (m.flags & MT_FLAG_STOP);
+        if(b || verbose) printf("v=%g: %d measurements, max error %.3f%%, pos errors: %d\n",
+                                c.v, s.nmeas, s.maxverr*100., s.badpos);
+        bad |= b;
+    }
+    return chkfail("constant speed", bad);
+}
+
+// uniform acceleration
+typedef struct{ double x0, v0, a; } acc_t;
+static double ax(const void *par, double t){ const acc_t *c = par; return c->x0 + c->v0*t + c->a*t*t/2.; }
+
+static int chkaccel(){
+    const acc_t accs[] = {{10., 0., 10000.}, {10., 20000., -10000.}, {40., -100., -2000.}};
+    int bad = 0;
+    mt_state m;
+    stat_t s;
+    for(size_t i = 0; i < sizeof(accs)/sizeof(accs[0]); ++i){
+        profile_t p = {ax, &accs[i]};
+        run(&p, 1.8, 0.3, accs[i].a, &m, &s);
+        double mean = s.accsum / s.nacc;
+        int b = s.badpos || s.maxverr > 0.01 || fabs(mean - accs[i].a) > 0.02*fabs(accs[i].a) || s.accmaxerr > 0.2;
+        if(b || verbose) printf("a=%g: %d measurements, max v error %.3f%%, mean acc=%.0f, max acc error %.1f%%\n",
+                                accs[i].a, s.nmeas, s.maxverr*100., mean, s.accmaxerr*100.);
+        bad |= b;
+    }
+    return chkfail("acceleration", bad);
+}
+
+// oscillation with reverse
+typedef struct{ double x0, A, w; } sin_t;
+static double sx(const void *par, double t){ const sin_t *c = par; return c->x0 + c->A*sin(c->w*t); }
+
+static int chkreverse(){
+    sin_t c = {1000., 300., 2.*M_PI*2.};
+    profile_t p = {sx, &c};
+    mt_state m;
+    stat_t s;
+    run(&p, 3., 0.1, NAN, &m, &s);
+    // A rises @ count 4k+1 moving forward and @ 4k+2 moving backward (when position crosses 4k+3),
+    // so window with reverse inside can lose one count
+    int bad = s.badpos || s.signerr || s.maxcnterr > 1.05;
+    if(bad || verbose) printf("%d measurements, max error %.2f%% (%.2f counts in window), wrong sign: %d\n",
+                              s.nmeas, s.maxverr*100., s.maxcnterr, s.signerr);
+    return chkfail("reverse", bad);
+}
+
+// move with constant speed, then stop
+typedef struct{ double x0, v, tstop; } stop_t;
+static double stx(const void *par, double t){
+    const stop_t *c = par;
+    if(t > c->tstop) t = c->tstop;
+    return c->x0 + c->v * t;
+}
+
+static int chkstop(){
+    int bad = 0;
+    const double speeds[] = {500., -30.};
+    for(size_t i = 0; i < sizeof(speeds)/sizeof(speeds[0]); ++i){
+        stop_t c = {20., speeds[i], 1.};
+        profile_t p = {stx, &c};
+        mt_state m;
+        stat_t s;
+        // check decreasing of speed after stop
+        run(&p, c.tstop, 0., NAN, &m, &s);
+        int32_t vmax = abs(m.vel), pos = m.pos;
+        int b = s.badpos;
+        // continue from stop: edges are absent, feed estimator with the same values
+        uint16_t now = m.lastT;
+        uint16_t cnt = m.lastcnt;
+        double tzero = -1.;
+        for(int j = 1; j < (MT_STOPTIME / TSAMPLE) * 2; ++j){
+            now += TSAMPLE;
+            mt_sample(&m, cnt, cnt, 0, 0, now);
+            if(abs(m.vel) > vmax) b = 1;
+            vmax = abs(m.vel);
+            if(tzero < 0. && m.vel == 0) tzero = j * 1e-3;
+        }
+        if(!(m.flags & MT_FLAG_STOP) || m.vel || m.pos != pos || tzero < 0. || tzero > MT_STOPTIME * 1e-6 + 0.01) b = 1;
+        if(b || verbose) printf("v=%g: zero velocity after %gs of stop, flags=%d\n", c.v, tzero, m.flags);
+        bad |= b;
+    }
+    return chkfail("stop", bad);
+}
+
+int main(int argc, char **argv){
+    hosttest_opts(argc, argv);
+    int ret = chkconst();
+    ret |= chkaccel();
+    ret |= chkreverse();
+    ret |= chkstop();
+    return hosttest_result(ret);
+}
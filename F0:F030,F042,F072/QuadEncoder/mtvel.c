@@ -0,0 +1,89 @@
+/*
+ * This file is part of the QuadEncoder project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mtvel.h"
+
+// difference of two counter values modulo MT_ENCREV (-MT_ENCREV/2 .. MT_ENCREV/2-1)
+static int32_t cntdiff(uint16_t a, uint16_t b){
+    int32_t d = ((int32_t)a - (int32_t)b) % MT_ENCREV;
+    if(d >= MT_ENCREV/2) d -= MT_ENCREV;
+    else if(d < -MT_ENCREV/2) d += MT_ENCREV;
+    return d;
+}
+
+void mt_init(mt_state *m){
+    m->started = 0;
+}
+
+/**
+ * @brief mt_sample - next sample of encoder
+ * @param m - state
+ * @param cnt - current encoder counter
+ * @param capcnt - encoder counter captured @ last edge
+ * @param capT - time captured @ last edge (should be read before `now`)
+ * @param newedge - !=0 if there was edge after previous sample
+ * @param now - current time
+ */
+void mt_sample(mt_state *m, uint16_t cnt, uint16_t capcnt, uint16_t capT, uint8_t newedge, uint16_t now){
+    if(!m->started){
+        m->started = 1;
+        m->pos = m->edgepos = cnt;
+        m->lastcnt = cnt;
+        m->lastT = now;
+        m->T = m->edgeT = m->accT = now;
+        m->vel = m->acc = m->accvel = 0;
+        m->flags = MT_FLAG_STOP;
+        return;
+    }
+    m->T += (uint16_t)(now - m->lastT);
+    m->lastT = now;
+    m->pos += cntdiff(cnt, m->lastcnt);
+    m->lastcnt = cnt;
+    m->flags &= ~MT_FLAG_EDGE;
+    if(newedge){
+        int32_t epos = m->pos - cntdiff(cnt, capcnt);
+        uint32_t eT = m->T - (uint16_t)(now - capT);
+        if(m->flags & MT_FLAG_STOP){ // first edge after stop: start new measurement
+            m->flags &= ~MT_FLAG_STOP;
+            m->accT = eT;
+            m->accvel = 0;
+        }else if(eT != m->edgeT){
+            uint32_t dt = eT - m->edgeT;
+            m->vel = (int32_t)(((int64_t)(epos - m->edgepos) << 8) * 1000000 / dt);
+            m->flags |= MT_FLAG_EDGE;
+            dt = eT - m->accT;
+            if(dt >= MT_ACCWIN){
+                m->acc = (int32_t)((int64_t)(m->vel - m->accvel) * 1000000 / ((int64_t)dt << 8));
+                m->accvel = m->vel;
+                m->accT = eT;
+            }
+        }
+        m->edgepos = epos;
+        m->edgeT = eT;
+    }else if(!(m->flags & MT_FLAG_STOP)){
+        uint32_t dt = m->T - m->edgeT;
+        if(dt > MT_STOPTIME){
+            m->vel = m->acc = 0;
+            m->flags |= MT_FLAG_STOP;
+        }else if(dt){ // speed can't be greater than one period per `dt`
+            int32_t lim = (int32_t)(((int64_t)MT_EDGECOUNTS << 8) * 1000000 / dt);
+            if(m->vel > lim) m->vel = lim;
+            else if(m->vel < -lim) m->vel = -lim;
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ * This file is part of the QuadEncoder project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef MTVEL_H__
+#define MTVEL_H__
+
+#include <stdint.h>
+
+/*
+ * M/T velocity estimator (hardware-independent).
+ * mt_sample() is called with fixed rate and gets raw 16-bit timers' values:
+ *  - encoder counter (modulo MT_ENCREV);
+ *  - counter value and time (1us ticks) captured @ last rising edge of channel A;
+ *  - current time.
+ * Velocity is measured between last edges of neighbouring samples: amount of counts
+ * divided by exact time between them (M/T). When there's no edges, velocity is limited by
+ * one period of A (4 counts) divided by time from last edge, after MT_STOPTIME it's zero.
+ * Encoder shouldn't move more than MT_ENCREV/2 counts between samples.
+ */
+
+// counts per revolution (TIM3->ARR + 1)
+#define MT_ENCREV       (80)
+// counts per period of channel A
+#define MT_EDGECOUNTS   (4)
+// time without edges to decide that encoder stopped, us
+#define MT_STOPTIME     (2000000)
+// minimal time interval for acceleration calculation, us
+#define MT_ACCWIN       (50000)
+
+// flags
+#define MT_FLAG_EDGE    (1<<0)  // velocity measured @ this sample
+#define MT_FLAG_STOP    (1<<1)  // stopped (no edges during MT_STOPTIME)
+
+typedef struct{
+    int32_t pos;        // multi-turn position (counts)
+    int32_t vel;        // velocity (1/256 counts per second)
+    int32_t acc;        // acceleration (counts per second^2)
+    uint32_t T;         // time of last sample, us
+    uint8_t flags;      // MT_FLAG_*
+    // private
+    uint16_t lastcnt;   // last encoder counter value
+    uint16_t lastT;     // last 16-bit time
+    int32_t edgepos;    // position @ last edge
+    uint32_t edgeT;     // time of last edge
+    int32_t accvel;     // velocity @ start of acceleration window
+    uint32_t accT;      // time of start of acceleration window
+    uint8_t started;    // ==0 before first sample
+} mt_state;
+
+void mt_init(mt_state *m);
+void mt_sample(mt_state *m, uint16_t cnt, uint16_t capcnt, uint16_t capT, uint8_t newedge, uint16_t now);
+
+#endif // MTVEL_H__
@@ -19,7 +19,43 @@
 #include "protocol.h"
 #include "usart.h"
 
+static uint16_t streamperiod = 0; // period of binary stream (ms), 0 - off
 
+// print value in 1/256 with two decimal digits
+static void put_q8(int32_t val){
+    if(val < 0){
+        put_char('-');
+        val = -val;
+    }
+    put_uint(val >> 8);
+    put_char('.');
+    uint32_t frac = ((val & 0xff) * 100 + 128) >> 8;
+    if(frac < 10) put_char('0');
+    put_uint(frac);
+}
+
+/**
+ * @brief mt_stream - send binary packet when it's time
+ * @return 1 if binary stream is on
+ */
+int mt_stream(){
+    static uint32_t last = 0;
+    static uint16_t seq = 0;
+    if(!streamperiod) return 0;
+    if(mtsamples - last < streamperiod) return 1;
+    mt_state m;
+    mt_get(&m);
+    mt_packet p = {.magic = {MT_MAGIC0, MT_MAGIC1}, .seq = seq, .T = m.T,
+                   .pos = m.pos, .vel = m.vel, .acc = m.acc, .flags = m.flags};
+    uint8_t sum = 0, *ptr = (uint8_t*)&p.seq;
+    for(uint32_t i = 0; i < sizeof(p) - 3; ++i) sum += ptr[i];
+    p.csum = sum;
+    if(ALL_OK == usart1_send((const char*)&p, sizeof(p))){ // try again on next call if line is busy
+        last = mtsamples;
+        ++seq;
+    }
+    return 1;
+}
 
 /**
  * @brief process_command - command parser
@@ -33,14 +69,26 @@ char *process_command(const char *command){
         case '?': // help
             SEND_BLK(
                 "D - get rotation direction\n"
+                "B - binary stream of position/velocity with period N ms (0 - off)\n"
                 "R - reset\n"
                 "T - get timer value\n"
+                "V - get position, velocity and acceleration\n"
                 );
         break;
         case 'D':
             if(TIM3->CR1 & TIM_CR1_DIR) SEND("negative\n");
             else SEND("positive\n");
         break;
+        case 'B':{
+            int32_t N;
+            if(!getnum(command + 1, &N) || N < 0 || N > 0xffff){
+                SEND("Wrong period\n");
+                break;
+            }
+            if(N && N < MT_STREAM_MIN) N = MT_STREAM_MIN;
+            streamperiod = (uint16_t)N;
+        }
+        break;
         case 'R': // reset MCU
             NVIC_SystemReset();
         break;
@@ -49,6 +97,16 @@ char *process_command(const char *command){
             put_uint(TIM3->CNT);
             put_char('\n');
         break;
+        case 'V':{
+            mt_state m;
+            mt_get(&m);
+            put_string("pos="); put_int(m.pos);
+            put_string(", vel="); put_q8(m.vel);
+            put_string(", acc="); put_int(m.acc);
+            if(m.flags & MT_FLAG_STOP) put_string(", stopped");
+            put_char('\n');
+        }
+        break;
     }
     usart1_sendbuf();
     return ret;
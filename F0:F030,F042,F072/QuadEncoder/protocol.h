@@ -19,6 +19,25 @@
 #define PROTOCOL_H__
 #include <stm32f0.h>
 
+// min period of binary stream (ms): 22 bytes take 1.9ms @ 115200
+#define MT_STREAM_MIN   (2)
+// first bytes of binary packet
+#define MT_MAGIC0       (0xA5)
+#define MT_MAGIC1       (0x5A)
+
+// binary packet of velocity stream (little-endian)
+typedef struct __attribute__((packed)){
+    uint8_t magic[2];   // MT_MAGIC0, MT_MAGIC1
+    uint16_t seq;       // packet number
+    uint32_t T;         // time of sample, us
+    int32_t pos;        // multi-turn position, counts
+    int32_t vel;        // velocity, 1/256 counts per second
+    int32_t acc;        // acceleration, counts per second^2
+    uint8_t flags;      // bit0 - velocity measured @ this sample, bit1 - stopped
+    uint8_t csum;       // sum of all bytes from `seq` to `flags`
+} mt_packet;
+
 char *process_command(const char *command);
+int mt_stream();
 
 #endif // PROTOCOL_H__
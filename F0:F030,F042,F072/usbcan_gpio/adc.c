@@ -19,6 +19,7 @@
 #include <stm32f0.h>
 
 #include "adc.h"
+#include "gpio.h"
 
 /**
  * @brief ADC_array - array for ADC channels with median filtering:
@@ -28,7 +29,10 @@
  */
 #define TSENS_CHAN  (NUM_EXT_ADC_CH)
 #define VREF_CHAN   (NUM_EXT_ADC_CH + 1)
-static uint16_t ADC_array[MAX_ADC_CHANNELS*9];
+#define ADC_NSEQ    (9)
+static uint16_t ADC_array[MAX_ADC_CHANNELS*ADC_NSEQ];
+// first sequence that is incomplete at half transfer
+#define ADC_HALFSEQ (ADC_NSEQ * MAX_ADC_CHANNELS / 2 / MAX_ADC_CHANNELS)
 
 /*
  * ADC channels:
@@ -86,13 +90,27 @@ void adc_setup(){
     ADC1->CFGR1 |= ADC_CFGR1_DMAEN | ADC_CFGR1_DMACFG; /* (2) */
     DMA1_Channel1->CPAR = (uint32_t) (&(ADC1->DR)); /* (3) */
     DMA1_Channel1->CMAR = (uint32_t)(ADC_array); /* (4) */
-    DMA1_Channel1->CNDTR = MAX_ADC_CHANNELS * 9; /* (5) */
-    DMA1_Channel1->CCR |= DMA_CCR_MINC | DMA_CCR_MSIZE_0 | DMA_CCR_PSIZE_0 | DMA_CCR_CIRC; /* (6) */
+    DMA1_Channel1->CNDTR = MAX_ADC_CHANNELS * ADC_NSEQ; /* (5) */
+    DMA1_Channel1->CCR |= DMA_CCR_MINC | DMA_CCR_MSIZE_0 | DMA_CCR_PSIZE_0 | DMA_CCR_CIRC
+                        | DMA_CCR_HTIE | DMA_CCR_TCIE; /* (6) */
     DMA1_Channel1->CCR |= DMA_CCR_EN; /* (7) */
+    NVIC_SetPriority(DMA1_Channel1_IRQn, 1);
+    NVIC_EnableIRQ(DMA1_Channel1_IRQn);
     ADC1->CR |= ADC_CR_ADSTART; /* start the ADC conversions */
 }
 
 
+// half or full buffer is ready: check all conversion sequences completed since last interrupt by
+// software analog watchdog of monitored pins (DMA rewrites other half meanwhile)
+void dma1_channel1_isr(){
+    uint32_t isr = DMA1->ISR;
+    DMA1->IFCR = DMA_IFCR_CGIF1;
+    int first = 0, last = ADC_NSEQ;
+    if(!(isr & DMA_ISR_TCIF1)) last = ADC_HALFSEQ; // only first half is ready
+    else if(!(isr & DMA_ISR_HTIF1)) first = ADC_HALFSEQ;
+    for(int i = first; i < last; ++i) gpio_adcwatch(&ADC_array[i * MAX_ADC_CHANNELS]);
+}
+
 /**
  * @brief getADCval - calculate median value for `nch` channel
  * @param nch - number of channel
@@ -104,7 +122,7 @@ uint16_t getADCval(int nch){
 #define PIX_SORT(a,b) { if ((a)>(b)) PIX_SWAP((a),(b)); }
 #define PIX_SWAP(a,b) { temp=(a);(a)=(b);(b)=temp; }
     uint16_t p[9];
-    for(i = 0; i < 9; ++i, addr += MAX_ADC_CHANNELS) // first we should prepare array for optmed
+    for(i = 0; i < ADC_NSEQ; ++i, addr += MAX_ADC_CHANNELS) // first we should prepare array for optmed
         p[i] = ADC_array[addr];
     PIX_SORT(p[1], p[2]) ; PIX_SORT(p[4], p[5]) ; PIX_SORT(p[7], p[8]) ;
     PIX_SORT(p[0], p[1]) ; PIX_SORT(p[3], p[4]) ; PIX_SORT(p[6], p[7]) ;
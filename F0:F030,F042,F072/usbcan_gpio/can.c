@@ -18,7 +18,9 @@
 
 #include "can.h"
 #include "hardware.h"
+#include "canbin.h"
 #include "canproto.h"
+#include "swfilter.h"
 
 #define USBIF   ICAN
 #include "strfunc.h"
@@ -32,6 +34,7 @@ static uint8_t incrflood = 0; // ==1 for incremental flooding
 
 static uint32_t last_err_code = 0;
 static CAN_status can_status = CAN_STOP;
+static volatile uint32_t fifo_overruns = 0; // total amount of hardware FIFO overruns
 
 static void can_process_fifo(uint8_t fifo_num);
 
@@ -48,6 +51,11 @@ CAN_status CAN_get_status(){
     return st;
 }
 
+// amount of hardware FIFO overruns from start
+uint32_t CAN_overruns(){
+    return fifo_overruns;
+}
+
 // push next message into buffer; return 1 if buffer overfull
 static int CAN_messagebuf_push(CAN_message *msg){
 #ifdef EBUG
@@ -221,8 +229,10 @@ void can_proc(){
     }
     IWDG->KR = IWDG_REFRESH;
     if(CAN->ESR & (CAN_ESR_BOFF | CAN_ESR_EPVF | CAN_ESR_EWGF)){ // much errors - restart CAN BUS
-        SEND("\nToo much errors, restarting CAN!\n");
-        printCANerr();
+        if(!canbin_active()){ // don't break binary stream
+            SEND("\nToo much errors, restarting CAN!\n");
+            printCANerr();
+        }
         // request abort for all mailboxes
         CAN->TSR |= CAN_TSR_ABRQ0 | CAN_TSR_ABRQ1 | CAN_TSR_ABRQ2;
         // reset CAN bus
@@ -336,6 +346,11 @@ static void can_process_fifo(uint8_t fifo_num){
         uint8_t len = box->RDTR & 0x0f;
         msg.length = len;
         msg.ID = box->RIR >> 21;
+        if(!swf_pass(msg.ID)){ // ignored by software filter
+            *RFxR = CAN_RF0R_RFOM0;
+            continue;
+        }
+        msg.T = Tms;
         //msg.filterNo = (box->RDTR >> 8) & 0xff;
         //msg.fifoNum = fifo_num;
         if(len){ // message can be without data
@@ -377,10 +392,12 @@ void cec_can_isr(){
     if(CAN->RF0R & CAN_RF0R_FOVR0){ // FIFO overrun
         CAN->RF0R = CAN_RF0R_FOVR0;
         can_status = CAN_FIFO_OVERRUN;
+        ++fifo_overruns;
     }
     if(CAN->RF1R & CAN_RF1R_FOVR1){
         CAN->RF1R = CAN_RF1R_FOVR1;
         can_status = CAN_FIFO_OVERRUN;
+        ++fifo_overruns;
     }
     if(CAN->MSR & CAN_MSR_ERRI){ // Error
         CAN->MSR &= ~CAN_MSR_ERRI;
@@ -39,6 +39,7 @@ typedef struct{
     uint8_t data[8];    // up to 8 bytes of data
     uint8_t length;     // data length
     uint16_t ID;        // ID of receiver
+    uint32_t T;         // time of receiving (Tms)
 } CAN_message;
 
 typedef enum{
@@ -50,6 +51,7 @@ typedef enum{
 } CAN_status;
 
 CAN_status CAN_get_status();
+uint32_t CAN_overruns();
 
 int CAN_reinit(uint16_t speed);
 int CAN_setup(uint16_t speed);
@@ -0,0 +1,187 @@
+/*
+ * This file is part of the usbcangpio project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "canbin.h"
+#include "hardware.h"
+#include "usb_descr.h"
+#include "usb_dev.h"
+
+uint32_t canbin_stat[CANBIN_NSTAT] = {0};
+
+static uint8_t binmode = 0;
+// output packet (device -> host)
+static canbin_record outpk[CANBIN_RECPERPACK];
+static uint8_t outN = 0;        // amount of records in `outpk`
+static uint32_t outT0 = 0;      // time of first record in `outpk`
+static uint8_t nextflags = 0;   // flags for next record (lost/overrun)
+static uint32_t lastovr = 0;    // last value of CAN_overruns()
+// input record (host -> device)
+static canbin_record inrec;
+static uint8_t inlen = 0;       // amount of bytes in `inrec`
+static uint8_t inpending = 0;   // ==1 if `inrec` waits for free mailbox
+
+uint8_t canbin_active(){
+    return binmode;
+}
+
+void canbin_start(){
+    outN = 0;
+    inlen = 0;
+    inpending = 0;
+    nextflags = 0;
+    lastovr = CAN_overruns();
+    binmode = 1;
+}
+
+// send current packet or drop it if there's no space in USB buffer
+static void flushout(){
+    if(!outN) return;
+    int len = outN * sizeof(canbin_record);
+    if(USB_sendbufspace(ICAN) <= len){
+        canbin_stat[CANBIN_ST_USBDROP] += outN;
+        nextflags |= CANBIN_F_LOST;
+    }else{
+        USB_send(ICAN, (uint8_t*)outpk, len);
+        USB_flush(ICAN);
+    }
+    outN = 0;
+}
+
+void canbin_stop(){
+    flushout();
+    binmode = 0;
+}
+
+// get next free record in output packet (sending full packet)
+static canbin_record *nextrec(){
+    if(outN == CANBIN_RECPERPACK) flushout();
+    if(!outN) outT0 = Tms;
+    canbin_record *r = &outpk[outN++];
+    uint32_t ovr = CAN_overruns();
+    if(ovr != lastovr){
+        canbin_stat[CANBIN_ST_FIFOOVR] += ovr - lastovr;
+        lastovr = ovr;
+        nextflags |= CANBIN_F_OVR;
+    }
+    r->magic = CANBIN_MAGIC;
+    r->dlcflags = nextflags;
+    nextflags = 0;
+    return r;
+}
+
+// put received CAN message into output packet
+void canbin_put(CAN_message *msg){
+    canbin_record *r = nextrec();
+    uint8_t len = msg->length;
+    if(len > 8) len = 8;
+    r->dlcflags |= len;
+    r->ID = msg->ID;
+    r->T = msg->T;
+    memcpy(r->data, msg->data, len); // record is packed: no word access
+    if(len < 8) memset(r->data + len, 0, 8 - len);
+    ++canbin_stat[CANBIN_ST_RX];
+    if(outN == CANBIN_RECPERPACK) flushout();
+}
+
+static void sendstat(){
+    for(int i = 0; i < CANBIN_NSTAT; ++i){
+        canbin_record *r = nextrec();
+        r->dlcflags |= CANBIN_F_CTRL;
+        r->ID = (uint16_t)i;
+        r->T = canbin_stat[i];
+        memset(r->data, 0, 8);
+    }
+    flushout();
+}
+
+static void ctrlrec(){
+    switch(inrec.data[0]){
+        case CANBIN_CMD_EXIT:
+            canbin_stop();
+        break;
+        case CANBIN_CMD_STAT:
+            sendstat();
+        break;
+        case CANBIN_CMD_CLRSTAT:
+            memset(canbin_stat, 0, sizeof(canbin_stat));
+        break;
+        default:
+            ++canbin_stat[CANBIN_ST_BADREC];
+    }
+}
+
+// resynchronize `inrec` to first CANBIN_MAGIC
+static void resync(){
+    uint8_t *b = (uint8_t*)&inrec;
+    uint8_t i = 1;
+    while(i < inlen && b[i] != CANBIN_MAGIC) ++i;
+    canbin_stat[CANBIN_ST_BADBYTES] += i;
+    inlen -= i;
+    if(inlen) memmove(b, b + i, inlen);
+}
+
+// read host records and send them; not more than one packet per call
+static void getrecords(){
+    for(uint8_t n = 0; n < CANBIN_RECPERPACK; ++n){
+        if(inpending){ // don't read more until previous one was sent
+            if(CAN_BUSY == can_send(inrec.data, inrec.dlcflags & CANBIN_DLC_MASK, inrec.ID)){
+                ++canbin_stat[CANBIN_ST_TXBUSY];
+                return;
+            }
+            ++canbin_stat[CANBIN_ST_TX];
+            inpending = 0;
+            inlen = 0;
+        }
+        int l = USB_receive(ICAN, ((uint8_t*)&inrec) + inlen, sizeof(canbin_record) - inlen);
+        if(l < 0){ // buffer was cleared
+            ++canbin_stat[CANBIN_ST_USBOVR];
+            inlen = 0;
+            return;
+        }
+        if(l == 0) return;
+        inlen += l;
+        while(inlen && inrec.magic != CANBIN_MAGIC) resync();
+        if(inlen < sizeof(canbin_record)) continue;
+        if(inrec.dlcflags & CANBIN_F_CTRL){
+            inlen = 0;
+            ctrlrec();
+            if(!binmode) return;
+            continue;
+        }
+        if(inrec.ID > 0x7ff || (inrec.dlcflags & CANBIN_DLC_MASK) > 8){
+            ++canbin_stat[CANBIN_ST_BADREC];
+            inlen = 0;
+            continue;
+        }
+        inpending = 1;
+    }
+}
+
+// call this from CANUSB_process() instead of text protocol parsing
+void canbin_process(){
+    if(!binmode) return;
+    if(!IFconfig(ICAN, NULL)){ // host disconnected: return to text mode
+        outN = 0;
+        binmode = 0;
+        return;
+    }
+    if(outN && Tms - outT0 >= CANBIN_FLUSH_MS) flushout();
+    getrecords();
+}
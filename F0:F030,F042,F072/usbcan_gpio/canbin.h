@@ -0,0 +1,83 @@
+/*
+ * This file is part of the usbcangpio project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "can.h"
+
+/*
+ * Binary framing mode of CAN interface: fixed-size 16-byte records, four
+ * records per one 64-byte USB bulk packet (in both directions).
+ * All multibyte fields are little-endian.
+ * Host -> device: `flags` may contain CANBIN_F_CTRL, then data[0] is command (CANBIN_CMD_*),
+ *   else record is CAN frame to send (field `T` is ignored).
+ * Device -> host: received CAN frames; statistics reply is a sequence of CANBIN_NSTAT
+ *   records with CANBIN_F_CTRL flag, `ID` is counter index and `T` is its value.
+ */
+
+#define CANBIN_MAGIC        (0xA5)
+// size of USB bulk packet and amount of records in it
+#define CANBIN_PACKETSZ     (64)
+#define CANBIN_RECPERPACK   (CANBIN_PACKETSZ / sizeof(canbin_record))
+// max time (ms) to hold partially filled packet
+#define CANBIN_FLUSH_MS     (2)
+
+// flags (high nibble of `dlcflags`)
+#define CANBIN_F_CTRL       (1<<4)  // control/statistics record
+#define CANBIN_F_LOST       (1<<5)  // some records before this were lost (USB buffer overflow)
+#define CANBIN_F_OVR        (1<<6)  // hardware CAN FIFO overrun occured before this record
+#define CANBIN_DLC_MASK     (0x0f)
+
+// commands in data[0] of control records
+typedef enum{
+    CANBIN_CMD_EXIT,        // return to text mode
+    CANBIN_CMD_STAT,        // get statistics
+    CANBIN_CMD_CLRSTAT,     // clear statistics
+    CANBIN_CMD_AMOUNT
+} canbin_cmd;
+
+typedef struct __attribute__((packed)){
+    uint8_t magic;          // CANBIN_MAGIC - for resynchronization
+    uint8_t dlcflags;       // bits 0..3 - DLC, 4..7 - flags
+    uint16_t ID;            // 11-bit ID
+    uint32_t T;             // timestamp (ms from start)
+    uint8_t data[8];        // data (unused bytes are zeros)
+} canbin_record;
+
+// statistics counters
+typedef enum{
+    CANBIN_ST_RX,           // frames sent to host
+    CANBIN_ST_TX,           // frames got from host and sent to bus
+    CANBIN_ST_USBDROP,      // frames lost due to USB output buffer overflow
+    CANBIN_ST_FIFOOVR,      // hardware CAN FIFO overruns
+    CANBIN_ST_USBOVR,       // USB input buffer overflows
+    CANBIN_ST_BADBYTES,     // bytes skipped to resync stream
+    CANBIN_ST_BADREC,       // wrong records (bad ID/DLC/command)
+    CANBIN_ST_TXBUSY,       // attempts to send when all mailboxes were busy
+    CANBIN_NSTAT
+} canbin_statidx;
+
+extern uint32_t canbin_stat[CANBIN_NSTAT];
+
+uint8_t canbin_active();
+void canbin_start();
+void canbin_stop();
+void canbin_put(CAN_message *msg);
+void canbin_process();
@@ -0,0 +1,259 @@
+/*
+ * This file is part of the usbcangpio project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Reference encoder/decoder of binary CAN records (canbin.h) and replay benchmark
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "canbin.h"
+
+// decoder state: partial record and statistics
+typedef struct{
+    canbin_record rec;
+    size_t len;
+    size_t badbytes;
+    size_t lost;    // amount of records with CANBIN_F_LOST
+    size_t ovr;     // amount of records with CANBIN_F_OVR
+} decoder;
+
+static void encode(const CAN_message *m, canbin_record *r){
+    memset(r, 0, sizeof(canbin_record));
+    r->magic = CANBIN_MAGIC;
+    r->dlcflags = m->length & CANBIN_DLC_MASK;
+    r->ID = m->ID;
+    r->T = m->T;
+    memcpy(r->data, m->data, m->length);
+}
+
+static void ctrlrec(canbin_record *r, canbin_cmd cmd){
+    memset(r, 0, sizeof(canbin_record));
+    r->magic = CANBIN_MAGIC;
+    r->dlcflags = CANBIN_F_CTRL;
+    r->data[0] = cmd;
+}
+
+/**
+ * @brief decode - feed decoder with next portion of stream
+ * @param d - decoder
+ * @param buf - data
+ * @param len - its length
+ * @param handler - called for each full record
+ */
+static void decode(decoder *d, const uint8_t *buf, size_t len, void (*handler)(const canbin_record *r)){
+    uint8_t *rb = (uint8_t*)&d->rec;
+    while(len){
+        if(d->len == 0 && *buf != CANBIN_MAGIC){ // lost sync
+            ++d->badbytes; ++buf; --len;
+            continue;
+        }
+        size_t portion = sizeof(canbin_record) - d->len;
+        if(portion > len) portion = len;
+        memcpy(rb + d->len, buf, portion);
+        d->len += portion; buf += portion; len -= portion;
+        if(d->len < sizeof(canbin_record)) break;
+        d->len = 0;
+        if((d->rec.dlcflags & CANBIN_DLC_MASK) > 8){ // wrong record: resync from next byte after magic
+            ++d->badbytes;
+            decode(d, rb + 1, sizeof(canbin_record) - 1, handler);
+            continue;
+        }
+        if(d->rec.dlcflags & CANBIN_F_LOST) ++d->lost;
+        if(d->rec.dlcflags & CANBIN_F_OVR) ++d->ovr;
+        if(handler) handler(&d->rec);
+    }
+}
+
+// print record in the same format as text mode of device
+static void printrec(const canbin_record *r){
+    if(r->dlcflags & CANBIN_F_CTRL){
+        printf("STAT %u = %u\n", r->ID, r->T);
+        return;
+    }
+    printf("%u #0x%x", r->T, r->ID);
+    for(int i = 0; i < (r->dlcflags & CANBIN_DLC_MASK); ++i) printf(" 0x%x", r->data[i]);
+    printf("\n");
+}
+
+// parse line of text log "T #ID byte0 .. byteN"; @return 1 if OK
+static int parseline(char *str, CAN_message *m){
+    char *e;
+    memset(m, 0, sizeof(CAN_message));
+    m->T = strtoul(str, &e, 0);
+    if(e == str) return 0;
+    str = strchr(e, '#');
+    if(!str) return 0;
+    ++str;
+    unsigned long l = strtoul(str, &e, 0);
+    if(e == str || l > 0x7ff) return 0;
+    m->ID = (uint16_t)l;
+    for(str = e; m->length < 8; str = e){
+        l = strtoul(str, &e, 0);
+        if(e == str) break;
+        if(l > 0xff) return 0;
+        m->data[m->length++] = (uint8_t)l;
+    }
+    return 1;
+}
+
+static CAN_message *readlog(const char *name, size_t *N){
+    FILE *f = fopen(name, "r");
+    if(!f){ perror(name); exit(1); }
+    size_t sz = 1024, n = 0;
+    CAN_message *msgs = malloc(sz * sizeof(CAN_message));
+    char line[256];
+    while(fgets(line, sizeof(line), f)){
+        if(n == sz){
+            sz *= 2;
+            msgs = realloc(msgs, sz * sizeof(CAN_message));
+        }
+        if(parseline(line, &msgs[n])) ++n;
+    }
+    fclose(f);
+    *N = n;
+    return msgs;
+}
+
+static double dtime(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static const CAN_message *chkmsgs;
+static size_t chkidx, chkerr;
+static void checkrec(const canbin_record *r){
+    const CAN_message *m = &chkmsgs[chkidx++];
+    if(r->ID != m->ID || r->T != m->T || (r->dlcflags & CANBIN_DLC_MASK) != m->length
+        || memcmp(r->data, m->data, m->length)) ++chkerr;
+}
+
+// length of text representation of message (as device prints it)
+static size_t textlen(const CAN_message *m){
+    char buf[128];
+    int l = snprintf(buf, 128, "%u #0x%x", m->T, m->ID);
+    for(int i = 0; i < m->length; ++i) l += snprintf(buf, 128, " 0x%x", m->data[i]);
+    return l + 1;
+}
+
+static void benchmark(const char *name, int niter){
+    size_t N;
+    CAN_message *msgs = readlog(name, &N);
+    if(!N){ fprintf(stderr, "No frames in %s\n", name); exit(1); }
+    canbin_record *recs = malloc(N * sizeof(canbin_record));
+    size_t tlen = 0;
+    for(size_t i = 0; i < N; ++i) tlen += textlen(&msgs[i]);
+    double t0 = dtime();
+    for(int it = 0; it < niter; ++it)
+        for(size_t i = 0; i < N; ++i) encode(&msgs[i], &recs[i]);
+    double tenc = dtime() - t0;
+    decoder d = {0};
+    chkmsgs = msgs; chkerr = 0;
+    t0 = dtime();
+    for(int it = 0; it < niter; ++it){
+        chkidx = 0;
+        // feed by USB packets
+        const uint8_t *b = (const uint8_t*)recs;
+        size_t rest = N * sizeof(canbin_record);
+        while(rest){
+            size_t l = rest > CANBIN_PACKETSZ ? CANBIN_PACKETSZ : rest;
+            decode(&d, b, l, checkrec);
+            b += l; rest -= l;
+        }
+    }
+    double tdec = dtime() - t0;
+    double nfr = (double)N * niter;
+    printf("%zu frames x %d iterations, %zu mismatches, %zu bytes skipped\n", N, niter, chkerr, d.badbytes);
+    printf("encode: %.3g frames/s, decode: %.3g frames/s (%.3g MB/s)\n", nfr/tenc, nfr/tdec,
+           nfr*sizeof(canbin_record)/tdec/1e6);
+    double tfr = (double)tlen / N;
+    printf("bytes per frame: text %.1f, binary %zu\n", tfr, sizeof(canbin_record));
+    // saturated 1Mbit bus: standard frame with 8 data bytes is 111 bits + stuffing + 3 bits IFS ~ 130 bits
+    double fps = 1e6 / 130.;
+    printf("1Mbit saturated bus (%.0f frames/s): text %.0f kB/s, binary %.0f kB/s (%.0f USB packets/s)\n",
+           fps, fps*tfr/1e3, fps*sizeof(canbin_record)/1e3, fps/CANBIN_RECPERPACK);
+    free(recs); free(msgs);
+    if(chkerr) exit(2);
+}
+
+static void usage(const char *self){
+    fprintf(stderr, "Usage: %s -e log.txt > out.bin | -d in.bin | -b log.txt [-n iterations] | -c cmd\n", self);
+    fprintf(stderr, "\t-e - encode text log (device text format) into binary records\n");
+    fprintf(stderr, "\t-d - decode binary stream into text\n");
+    fprintf(stderr, "\t-b - replay benchmark: encode/decode/verify log\n");
+    fprintf(stderr, "\t-c - output control record (0 - exit, 1 - stat, 2 - clear stat)\n");
+    exit(1);
+}
+
+int main(int argc, char **argv){
+    int opt, niter = 1000;
+    char mode = 0, *arg = NULL;
+    while((opt = getopt(argc, argv, "e:d:b:n:c:")) != -1){
+        switch(opt){
+            case 'e': case 'd': case 'b': case 'c':
+                mode = (char)opt; arg = optarg;
+            break;
+            case 'n':
+                niter = atoi(optarg);
+                if(niter < 1) usage(argv[0]);
+            break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    canbin_record r;
+    switch(mode){
+        case 'e':{
+            size_t N;
+            CAN_message *msgs = readlog(arg, &N);
+            for(size_t i = 0; i < N; ++i){
+                encode(&msgs[i], &r);
+                fwrite(&r, sizeof(r), 1, stdout);
+            }
+            free(msgs);
+        }
+        break;
+        case 'd':{
+            FILE *f = fopen(arg, "r");
+            if(!f){ perror(arg); return 1; }
+            uint8_t buf[CANBIN_PACKETSZ];
+            size_t l;
+            decoder d = {0};
+            while((l = fread(buf, 1, sizeof(buf), f)) > 0) decode(&d, buf, l, printrec);
+            fclose(f);
+            fprintf(stderr, "Skipped %zu bytes, %zu records marked LOST, %zu marked OVR\n", d.badbytes, d.lost, d.ovr);
+        }
+        break;
+        case 'b':
+            benchmark(arg, niter);
+        break;
+        case 'c':{
+            int c = atoi(arg);
+            if(c < 0 || c >= CANBIN_CMD_AMOUNT) usage(argv[0]);
+            ctrlrec(&r, (canbin_cmd)c);
+            fwrite(&r, sizeof(r), 1, stdout);
+        }
+        break;
+        default:
+            usage(argv[0]);
+    }
+    return 0;
+}
@@ -19,19 +19,18 @@
 #include <stm32f0.h>
 
 #include "can.h"
+#include "canbin.h"
 #include "hardware.h"
 #include "canproto.h"
+#include "flash.h"
+#include "swfilter.h"
 
 #define USBIF   ICAN
 #include "strfunc.h"
 
-#define IGN_SIZE 10
-
 extern volatile uint8_t canerror;
 
 static uint8_t ShowMsgs = 1;
-static uint16_t Ignore_IDs[IGN_SIZE];
-static uint8_t IgnSz = 0;
 
 // parse `txt` to CAN_message
 static CAN_message *parseCANmsg(char *txt){
@@ -106,40 +105,89 @@ TRUE_INLINE void CANini(char *txt){
     printu(N); SEND("kbps\n");
 }
 
+/**
+ * @brief addIGN - add software filter rule
+ * @param txt - rule in format "[+]ID[-ID2|/MASK]"
+ * '+' - accept matching IDs (ignore by default), ID-ID2 - range, ID/MASK - mask
+ */
 TRUE_INLINE void addIGN(char *txt){
-    if(IgnSz == IGN_SIZE){
-        SEND("Ignore buffer is full\n");
-        return;
-    }
+    swfrule_t r = {0};
     txt = omit_spaces(txt);
+    if(*txt == '+'){
+        r.type = SWF_ACCEPT;
+        txt = omit_spaces(txt + 1);
+    }
     uint32_t N;
     char *n = getnum(txt, &N);
     if(txt == n){
         SEND("No ID given\n");
         return;
     }
-    if(N > 0x7ff){
-        SEND("ID should be 11-bit number!\n");
-        return;
+    r.id = r.arg = (uint16_t)(N > 0xffff ? 0xffff : N);
+    txt = omit_spaces(n);
+    if(*txt == '-' || *txt == '/'){
+        if(*txt == '/') r.type |= SWF_MASK;
+        ++txt;
+        n = getnum(txt, &N);
+        if(txt == n){
+            SEND("No second number given\n");
+            return;
+        }
+        r.arg = (uint16_t)(N > 0xffff ? 0xffff : N);
     }
-    Ignore_IDs[IgnSz++] = (uint16_t)(N & 0x7ff);
-    SEND("Added ID "); printu(N);
-    SEND("\nIgn buffer size: "); printu(IgnSz);
+    switch(swf_addrule(&r)){
+        case 1:
+            SEND("Filter list is full\n");
+            return;
+        break;
+        case 2:
+            SEND("Wrong rule: IDs and mask are 11-bit numbers, range is 'low-high'\n");
+            return;
+        break;
+    }
+    SEND("Rules: "); printu(swfilter.nrules);
     NL();
 }
 
 TRUE_INLINE void print_ign_buf(){
-    if(IgnSz == 0){
-        SEND("Ignore buffer is empty\n");
+    if(swfilter.nrules == 0){
+        SEND("Software filter is empty\n");
         return;
     }
-    SEND("Ignored IDs:\n");
-    for(int i = 0; i < IgnSz; ++i){
+    SEND("Software filter rules:\n");
+    for(int i = 0; i < swfilter.nrules; ++i){
+        swfrule_t *r = &swfilter.rules[i];
         printu(i);
-        SEND(": ");
-        printuhex(Ignore_IDs[i]);
+        SEND(r->type & SWF_ACCEPT ? ": accept " : ": ignore ");
+        printuhex(r->id);
+        if((r->type & SWF_TYPEMASK) == SWF_MASK){
+            SEND(" / "); printuhex(r->arg);
+        }else if(r->arg != r->id){
+            SEND(" - "); printuhex(r->arg);
+        }
+        SEND(", hits="); printu(swf_hits[i]);
         NL();
     }
+    SEND("Total ignored: "); printu(swf_dropped);
+    NL();
+}
+
+// load software filter from flash
+TRUE_INLINE void loadfilters(){
+    if(currentconfidx < 0){
+        SEND("No saved configuration\n");
+        return;
+    }
+    swfilter = Flash_Data[currentconfidx].canfilter;
+    swf_rebuild();
+    SEND("Loaded "); printu(swfilter.nrules); SEND(" rules\n");
+}
+
+// save software filter (and all current configuration) into flash
+TRUE_INLINE void savefilters(){
+    the_conf.canfilter = swfilter;
+    if(store_userconf()) SEND("Can't store configuration\n");
+    else SEND("Saved\n");
 }
 
 // print ID/mask of CAN->sFilterRegister[x] half
@@ -301,10 +349,11 @@ static void add_filter(char *str){
 
 static const char *helpmsg =
     REPOURL
-    "'a' - add ID to ignore list (max 10 IDs)\n"
+    "'a' - add software filter rule: a [+]ID[-ID2|/MASK] ('+' - accept, max 16 rules)\n"
     "'b' - reinit CAN with given baudrate or get current\n"
+    "'B' - switch to binary mode (16-byte records, see canbin.h)\n"
     "'c' - get CAN status\n"
-    "'d' - delete ignore list\n"
+    "'d' - delete software filter rules\n"
 #ifdef STM32F072xB
     "'D' - activate DFU mode\n"
 #endif
@@ -314,16 +363,37 @@ static const char *helpmsg =
     "'i' - send incremental flood message (ID == ID for `F`)\n"
     "'I' - reinit CAN\n"
     "'l' - list all active filters\n"
+    "'L' - load software filter rules from flash\n"
     "'o' - turn LEDs OFF\n"
     "'O' - turn LEDs ON\n"
-    "'p' - print ignore buffer\n"
+    "'p' - print software filter rules and their hits\n"
     "'P' - pause/resume in packets displaying\n"
     "'R' - software reset\n"
     "'s/S' - send data over CAN: s ID byte0 .. byteN\n"
     "'t' - change flood period (>=0ms)\n"
     "'T' - get time from start (ms)\n"
+    "'W' - save software filter rules (and all configuration) into flash\n"
+    "'x' - show binary mode statistics\n"
 ;
 
+static const char *const statnames[CANBIN_NSTAT] = {
+    [CANBIN_ST_RX] = "rx",
+    [CANBIN_ST_TX] = "tx",
+    [CANBIN_ST_USBDROP] = "usbdrop",
+    [CANBIN_ST_FIFOOVR] = "fifoovr",
+    [CANBIN_ST_USBOVR] = "usbovr",
+    [CANBIN_ST_BADBYTES] = "badbytes",
+    [CANBIN_ST_BADREC] = "badrec",
+    [CANBIN_ST_TXBUSY] = "txbusy",
+};
+
+TRUE_INLINE void getbinstat(){
+    for(int i = 0; i < CANBIN_NSTAT; ++i){
+        SEND(statnames[i]); PUTCHAR('=');
+        printu(canbin_stat[i]); NL();
+    }
+}
+
 TRUE_INLINE void getcanstat(){
     SEND("CAN_MSR=");
     printuhex(CAN->MSR);
@@ -352,6 +422,12 @@ static void CommandParser(char *txt){
             addIGN(txt);
             return;
         break;
+        case 'B':
+            SEND("BINARY\n");
+            USB_sendall(ICAN);
+            canbin_start();
+            return;
+        break;
         case 'b':
             CANini(txt);
             return;
@@ -380,7 +456,7 @@ static void CommandParser(char *txt){
             getcanstat();
         break;
         case 'd':
-            IgnSz = 0;
+            swf_clear();
         break;
         case 'e':
             printCANerr();
@@ -406,6 +482,9 @@ static void CommandParser(char *txt){
         case 'l':
             list_filters();
         break;
+        case 'L':
+            loadfilters();
+        break;
         case 'o':
             ledsON = 0;
             LED_off(LED0);
@@ -434,34 +513,35 @@ static void CommandParser(char *txt){
             printu(Tms);
             NL();
         break;
+        case 'W':
+            savefilters();
+        break;
+        case 'x':
+            getbinstat();
+        break;
         default: // help
             SEND(helpmsg);
         break;
     }
 }
 
-// check Ignore_IDs & return 1 if ID isn't in list
-static uint8_t isgood(uint16_t ID){
-    for(int i = 0; i < IgnSz; ++i)
-        if(Ignore_IDs[i] == ID) return 0;
-    return 1;
-}
-
 void CANUSB_process(){
     char inbuff[MAXSTRLEN];
     CAN_message *can_mesg;
     uint32_t lastT = 0;
     can_proc();
-    if(CAN_get_status() == CAN_FIFO_OVERRUN){
+    uint8_t bin = canbin_active();
+    if(!bin && CAN_get_status() == CAN_FIFO_OVERRUN){
         SEND("CAN bus fifo overrun occured!\n");
     }
     while((can_mesg = CAN_messagebuf_pop())){
         IWDG->KR = IWDG_REFRESH;
-        if(can_mesg && isgood(can_mesg->ID)){
+        if(can_mesg){ // ignored IDs were dropped by software filter
             LED_on(LED0);
             lastT = Tms;
             if(!lastT) lastT = 1;
-            if(ShowMsgs){ // new data in buff
+            if(bin) canbin_put(can_mesg);
+            else if(ShowMsgs){ // new data in buff
                 IWDG->KR = IWDG_REFRESH;
                 uint8_t len = can_mesg->length;
                 printu(Tms);
@@ -479,6 +559,10 @@ void CANUSB_process(){
         LED_off(LED0);
         lastT = 0;
     }
+    if(bin){
+        canbin_process();
+        return;
+    }
     int l = RECV(inbuff, MAXSTRLEN);
     if(l < 0) SEND("ERROR: USB buffer overflow or string was too long\n");
     else if(l) CommandParser(inbuff);
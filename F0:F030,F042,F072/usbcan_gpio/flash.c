@@ -112,6 +112,8 @@ void flashstorage_init(){
     if(currentconfidx > -1){
         memcpy(&the_conf, &Flash_Data[currentconfidx], sizeof(user_conf));
     }
+    swfilter = the_conf.canfilter;
+    swf_rebuild();
 }
 
 // store new configuration
@@ -25,6 +25,7 @@
 #include <stdint.h>
 
 #include "gpio.h"
+#include "swfilter.h"
 #include "usart.h"
 #include "usb_descr.h"
 
@@ -61,10 +62,12 @@ typedef struct __attribute__((packed, aligned(4))){
     pinconfig_t pinconfig[2][16];   // GPIOA, GPIOB
     usartconf_t usartconfig;
     uint8_t I2Cspeed;               // I2C speed index
+    swfilter_t canfilter;           // CAN software filter set
 } user_conf;
 
 extern user_conf the_conf; // global user config (read from FLASH to RAM)
 extern int currentconfidx;
+extern const user_conf *Flash_Data;
 
 // data from ld-file: start address of storage
 
@@ -22,13 +22,19 @@
 #include "adc.h"
 #include "flash.h"
 #include "gpio.h"
+#include "gpioevt.h"
+#include "hardware.h"
 #include "i2c.h"
 #include "pwm.h"
 #include "spi.h"
 #include "usart.h"
 
 static uint16_t monitor_mask[2] = {0}; // pins to monitor == 1 (ONLY GPIO and ADC)
+static volatile uint16_t exti_mask[2] = {0}; // monitored pins captured by EXTI
+static volatile uint16_t adc_mask[2] = {0}; // monitored pins checked in ADC DMA interrupt
+static uint8_t exti_port[16] = {0}; // port of each EXTI line
 static uint16_t oldstates[2][16] = {0}; // previous state (16 bits - as some pins could be analog)
+#define exti_mask_all()     (exti_mask[0] | exti_mask[1])
 
 // intermediate buffer to change pin's settings by user request; after checking in will be copied to the_conf
 static pinconfig_t pinconfig[2][16] = {0};
@@ -496,8 +502,12 @@ TRUE_INLINE int8_t get_adc_channel(uint8_t port, uint8_t pin){
 // reinit all GPIO registers due to config; also configure (if need) USART1/2, SPI1 and I2C1
 // return FALSE if found some errors in current configuration (and it was fixed to default)
 int gpio_reinit(){
+    EXTI->IMR &= ~0xffff; // turn off all GPIO EXTI lines
     bzero(monitor_mask, sizeof(monitor_mask));
+    bzero((void*)exti_mask, sizeof(exti_mask));
+    bzero((void*)adc_mask, sizeof(adc_mask));
     bzero(oldstates, sizeof(oldstates));
+    uint16_t extilines = 0;
     int ret = TRUE;
     int tocopy = chkpinconf(); // if config is wrong, don't copy it to flash
     for(int port = 0; port < 2; port++){
@@ -524,10 +534,18 @@ int gpio_reinit(){
                     int8_t chan = get_adc_channel(port, pin);
                     if(chan >= 0){
                         oldstates[port][pin] = getADCval(chan);
+                        adc_mask[port] |= (1 << pin);
                     }
                 }else{
                     // save old state for regular GPIO
                     oldstates[port][pin] = (gpio->IDR >> pin) & 1;
+                    if(!(extilines & (1 << pin))){ // EXTI line is free: capture by interrupt, else - poll
+                        extilines |= 1 << pin;
+                        exti_mask[port] |= 1 << pin;
+                        exti_port[pin] = port;
+                        int shift = (pin & 3) << 2;
+                        SYSCFG->EXTICR[pin >> 2] = (SYSCFG->EXTICR[pin >> 2] & ~(0xf << shift)) | (port << shift);
+                    }
                 }
             }
             // start/stop PWM on this pin
@@ -544,6 +562,19 @@ int gpio_reinit(){
             }
         }
     }
+    if(extilines){ // both edges
+        EXTI->RTSR = (EXTI->RTSR & ~0xffff) | extilines;
+        EXTI->FTSR = (EXTI->FTSR & ~0xffff) | extilines;
+        EXTI->PR = extilines;
+        EXTI->IMR |= extilines;
+        // the same priority as ADC DMA: event producers shouldn't preempt each other
+        NVIC_SetPriority(EXTI0_1_IRQn, 1);
+        NVIC_SetPriority(EXTI2_3_IRQn, 1);
+        NVIC_SetPriority(EXTI4_15_IRQn, 1);
+        NVIC_EnableIRQ(EXTI0_1_IRQn);
+        NVIC_EnableIRQ(EXTI2_3_IRQn);
+        NVIC_EnableIRQ(EXTI4_15_IRQn);
+    }
     // if all OK, copy to the_conf
     if(tocopy) memcpy(the_conf.pinconfig, pinconfig, sizeof(pinconfig));
     else ret = FALSE;
@@ -621,41 +652,74 @@ int16_t pin_in(uint8_t port, uint8_t pin){
 }
 
 /**
- * @brief gpio_alert - return bitmask for alerted pins (whos state changed over last check)
- *      AF don't checked! Use appropriate function for them
+ * @brief gpio_poll - check monitored pins that can't be captured by EXTI (EXTI line is busy by other port)
+ *      and put events for changed pins into FIFO; AF don't checked!
  * @param port - 0 for GPIOA, 1 for GPIOB
- * @return pin mask where 1 is for changed state
  */
-uint16_t gpio_alert(uint8_t port){
-    if(port > 1) return 0;
-    if(0 == monitor_mask[port]) return 0; // nothing to monitor
+void gpio_poll(uint8_t port){
+    if(port > 1) return;
+    uint16_t mask = monitor_mask[port] & ~(exti_mask[port] | adc_mask[port]);
+    if(0 == mask) return; // nothing to poll
     volatile GPIO_TypeDef * GPIOx = (port == 0) ? GPIOA : GPIOB;
     uint32_t moder = GPIOx->MODER;
     uint16_t curpinbit = 1; // shift each iteration
     uint16_t *oldstate = oldstates[port];
-    uint16_t alert = 0;
     for(int pin = 0; pin < 16; ++pin, curpinbit <<= 1, moder >>= 2){
-        uint8_t curm = moder & 3;
-        if((curm == MODE_AF) || 0 == (monitor_mask[port] & curpinbit)) continue; // monitor also OUT (if OD)
-        // TODO: add AIN
-        if(curm == MODE_ANALOG){
+        if((moder & 3) == MODE_AF || 0 == (mask & curpinbit)) continue; // monitor also OUT (if OD)
+        uint16_t curval = (GPIOx->IDR & curpinbit) ? 1 : 0;
+        if(oldstate[pin] != curval){
+            oldstate[pin] = curval;
+            __disable_irq(); // FIFO have single producer
+            gpioevt_push(port, pin, curval, getus());
+            __enable_irq();
+        }
+    }
+}
+
+/**
+ * @brief gpio_adcwatch - software analog watchdog (F0 ADC have only one AWD window for all channels):
+ *      compare new conversions with last reported values of monitored analog pins
+ * @param seq - full sequence of conversions (channel 0 first)
+ */
+void gpio_adcwatch(const uint16_t *seq){
+    uint32_t T = getus();
+    for(uint8_t port = 0; port < 2; ++port){
+        uint16_t mask = adc_mask[port];
+        for(uint8_t pin = 0; mask; ++pin, mask >>= 1){
+            if(!(mask & 1)) continue;
             int8_t chan = get_adc_channel(port, pin);
-            if(chan < 0) continue; // can't be in normal case
-            uint16_t cur = getADCval(chan);
-            uint16_t thresh = the_conf.pinconfig[port][pin].threshold;
-            uint16_t diff = (cur > oldstate[pin]) ? (cur - oldstate[pin]) : (oldstate[pin] - cur);
-            if(diff > thresh){
-                oldstate[pin] = cur;
-                alert |= curpinbit;
-            }
-        }else{
-            uint16_t curval = (GPIOx->IDR & curpinbit) ? 1 : 0;
-            if(oldstate[pin] != curval){
-                oldstate[pin] = curval;
-                alert |= curpinbit;
-            }
+            if(chan < 0) continue;
+            gpioevt_adcchk(&oldstates[port][pin], seq[(uint8_t)chan], the_conf.pinconfig[port][pin].threshold,
+                           port, pin, T);
         }
     }
-    return alert;
 }
 
+// common EXTI handler for monitored digital pins
+static void exti_handler(){
+    uint32_t T = getus();
+    uint16_t pr = EXTI->PR & exti_mask_all();
+    EXTI->PR = pr;
+    for(uint8_t line = 0; pr; ++line, pr >>= 1){
+        if(!(pr & 1)) continue;
+        uint8_t port = exti_port[line];
+        volatile GPIO_TypeDef * GPIOx = (port == 0) ? GPIOA : GPIOB;
+        uint16_t curval = (GPIOx->IDR >> line) & 1;
+        if(curval == oldstates[port][line]) // pulse shorter than IRQ latency: report both edges
+            gpioevt_push(port, line, !curval, T);
+        oldstates[port][line] = curval;
+        gpioevt_push(port, line, curval, T);
+    }
+}
+
+void exti0_1_isr(){
+    exti_handler();
+}
+
+void exti2_3_isr(){
+    exti_handler();
+}
+
+void exti4_15_isr(){
+    exti_handler();
+}
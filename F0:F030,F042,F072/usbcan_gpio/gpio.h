@@ -133,4 +133,5 @@ int gpio_reinit();
 
 int pin_out(uint8_t port, uint8_t pin, uint8_t newval);
 int16_t pin_in(uint8_t port, uint8_t pin);
-uint16_t gpio_alert(uint8_t port);
+void gpio_poll(uint8_t port);
+void gpio_adcwatch(const uint16_t *seq);
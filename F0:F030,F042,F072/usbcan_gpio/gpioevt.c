@@ -0,0 +1,73 @@
+/*
+ * This file is part of the usbcangpio project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "gpioevt.h"
+
+gpioevt_stat_t gpioevt_stat = {0};
+
+// single producer (interrupts of the same priority) / single consumer (main loop) FIFO:
+// `head` changes only by producer, `tail` - only by consumer, so no locks needed
+static gpioevt_t fifo[GPIOEVT_FIFOSZ];
+static volatile uint8_t head = 0, tail = 0;
+
+// put event into FIFO (call it only from EXTI/DMA interrupts)
+void gpioevt_push(uint8_t port, uint8_t pin, uint16_t value, uint32_t T){
+    uint8_t nxt = (head + 1) & (GPIOEVT_FIFOSZ - 1);
+    if(nxt == tail){
+        ++gpioevt_stat.lost;
+        return;
+    }
+    gpioevt_t *e = &fifo[head];
+    e->T = T;
+    e->value = value;
+    e->port = port;
+    e->pin = pin;
+    head = nxt;
+}
+
+// get next event; @return 0 if FIFO is empty
+int gpioevt_pop(gpioevt_t *e){
+    uint8_t t = tail;
+    if(t == head) return 0;
+    *e = fifo[t];
+    tail = (t + 1) & (GPIOEVT_FIFOSZ - 1);
+    return 1;
+}
+
+/**
+ * @brief gpioevt_adcchk - software analog watchdog of one channel (call it only from DMA interrupt)
+ * @param old (io) - last reported value, refreshed by `cur` when event is put
+ * @param cur - new conversion
+ * @param thres - put event if |cur - old| > thres
+ * @param port, pin, T - event parameters
+ * @return 1 if event was put
+ */
+int gpioevt_adcchk(uint16_t *old, uint16_t cur, uint16_t thres, uint8_t port, uint8_t pin, uint32_t T){
+    uint16_t diff = (cur > *old) ? (cur - *old) : (*old - cur);
+    if(diff <= thres) return 0;
+    *old = cur;
+    gpioevt_push(port, pin, cur, T);
+    return 1;
+}
+
+void gpioevt_clear(){
+    tail = head;
+    memset(&gpioevt_stat, 0, sizeof(gpioevt_stat));
+}
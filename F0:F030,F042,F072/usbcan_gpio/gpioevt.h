@@ -0,0 +1,48 @@
+/*
+ * This file is part of the usbcangpio project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// size of event FIFO (should be power of 2!)
+#define GPIOEVT_FIFOSZ      (64)
+
+// pin change event
+typedef struct{
+    uint32_t T;         // time of event, us
+    uint16_t value;     // new pin value (0/1 or ADU)
+    uint8_t port;       // 0 - GPIOA, 1 - GPIOB
+    uint8_t pin;        // 0..15
+} gpioevt_t;
+
+// events statistics
+typedef struct{
+    uint32_t events;    // amount of events reported
+    uint32_t lost;      // lost due to FIFO overflow
+    uint32_t unsent;    // taken from FIFO but not sent (USB disconnected)
+    uint32_t maxlat;    // max latency (time from event to sending), us
+    uint32_t sumlat;    // sum of latencies (to calculate mean value)
+} gpioevt_stat_t;
+
+extern gpioevt_stat_t gpioevt_stat;
+
+void gpioevt_push(uint8_t port, uint8_t pin, uint16_t value, uint32_t T);
+int gpioevt_pop(gpioevt_t *e);
+int gpioevt_adcchk(uint16_t *old, uint16_t cur, uint16_t thres, uint8_t port, uint8_t pin, uint32_t T);
+void gpioevt_clear();
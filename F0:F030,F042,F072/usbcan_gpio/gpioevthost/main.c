@@ -0,0 +1,113 @@
+/*
+ * This file is part of the usbcangpio project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host checker of GPIO events (../gpioevt.c): FIFO order and loss counting, software analog watchdog
+// on synthetic ADC signals (noise, steps, ramps).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+#include "gpioevt.h"
+
+static int chkfifo(){
+    int bad = 0;
+    gpioevt_t e;
+    gpioevt_clear();
+    bad |= gpioevt_pop(&e) != 0;
+    uint32_t T = 0;
+    for(int k = 0; k < 100 && !bad; ++k){ // random bursts
+        int n = lrand48() % (2 * GPIOEVT_FIFOSZ);
+        uint32_t lost = gpioevt_stat.lost;
+        for(int i = 0; i < n; ++i) gpioevt_push(i & 1, i & 15, (uint16_t)i, T + i);
+        int stored = (n < GPIOEVT_FIFOSZ - 1) ? n : GPIOEVT_FIFOSZ - 1; // one cell is always free
+        if(gpioevt_stat.lost - lost != (uint32_t)(n - stored)){
+            if(verbose) printf("burst of %d: lost %u\n", n, gpioevt_stat.lost - lost);
+            bad = 1;
+        }
+        for(int i = 0; i < stored && !bad; ++i){
+            if(!gpioevt_pop(&e) || e.value != i || e.T != T + i || e.port != (i & 1) || e.pin != (i & 15)){
+                if(verbose) printf("burst of %d: wrong event %d\n", n, i);
+                bad = 1;
+            }
+        }
+        bad |= gpioevt_pop(&e) != 0;
+        T += n;
+    }
+    return chkfail("event FIFO", bad);
+}
+
+// feed `n` samples of signal into watchdog, check that reported values track signal within threshold
+static int feed(const uint16_t *sig, int n, uint16_t thres, int *nevt){
+    uint16_t old = sig[0];
+    gpioevt_t e;
+    gpioevt_clear();
+    *nevt = 0;
+    for(int i = 1; i < n; ++i){
+        uint16_t prev = old;
+        int r = gpioevt_adcchk(&old, sig[i], thres, 1, 3, i);
+        int d = (int)sig[i] - (int)prev;
+        if(d < 0) d = -d;
+        if(r != (d > thres)) return 1;
+        if(r){
+            if(!gpioevt_pop(&e) || e.value != sig[i] || e.T != (uint32_t)i || e.port != 1 || e.pin != 3) return 1;
+            ++*nevt;
+        }else if(old != prev) return 1;
+        d = (int)sig[i] - (int)old;
+        if(d > thres || d < -thres) return 1; // last reported value is close to current
+    }
+    return gpioevt_pop(&e) != 0 || gpioevt_stat.lost != 0;
+}
+
+static int chkadc(){
+    static uint16_t sig[10000];
+    int bad = 0, nevt;
+    const uint16_t thres = 50;
+    // noise below threshold: no events
+    for(int i = 0; i < 10000; ++i) sig[i] = 2000 + lrand48() % (thres + 1) - thres / 2;
+    int b = feed(sig, 10000, thres, &nevt) || nevt;
+    if(b && verbose) printf("noise: %d events\n", nevt);
+    bad |= b;
+    // steps with noise: one event per step
+    for(int i = 0; i < 10000; ++i) sig[i] = ((i / 1000) & 1) * 1000 + 1500 + lrand48() % 21 - 10;
+    b = feed(sig, 10000, thres, &nevt) || nevt != 9;
+    if(b && verbose) printf("steps: %d events instead of 9\n", nevt);
+    bad |= b;
+    // slow ramp: event every thres+1 ADU
+    for(int i = 0; i < 4000; ++i) sig[i] = i;
+    b = feed(sig, 4000, thres, &nevt) || nevt != 3999 / (thres + 1);
+    if(b && verbose) printf("ramp: %d events instead of %d\n", nevt, 3999 / (thres + 1));
+    bad |= b;
+    // zero threshold: each change
+    for(int i = 0; i < 1000; ++i) sig[i] = lrand48() & 3;
+    int changes = 0;
+    for(int i = 1; i < 1000; ++i) if(sig[i] != sig[i-1]) ++changes;
+    b = feed(sig, 1000, 0, &nevt) || nevt != changes;
+    if(b && verbose) printf("zero threshold: %d events instead of %d\n", nevt, changes);
+    bad |= b;
+    return chkfail("analog watchdog", bad);
+}
+
+int main(int argc, char **argv){
+    hosttest_opts(argc, argv);
+    int ret = chkfifo();
+    ret |= chkadc();
+    return hosttest_result(ret);
+}
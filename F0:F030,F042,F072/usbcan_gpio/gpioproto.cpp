@@ -26,7 +26,9 @@ extern "C"{
 #include "can.h"
 #include "flash.h"
 #include "gpio.h"
+#include "gpioevt.h"
 #include "gpioproto.h"
+#include "hardware.h"
 #include "i2c.h"
 #include "pwm.h"
 #include "spi.h"
@@ -52,6 +54,7 @@ static uint8_t hex_input_mode = 0; // ==0 for text input, 1 for HEX + text in qu
     COMMAND(curpinconf, "dump current (maybe wrong) pin configuration") \
     COMMAND(dumpconf,   "dump global configuration") \
     COMMAND(eraseflash, "erase full flash storage") \
+    COMMAND(evtstat,    "monitoring events statistics (evtstat=0 to clear)") \
     COMMAND(help,       "show this help") \
     COMMAND(hexinput,   "input is text (0) or hex + text in quotes (1)") \
     COMMAND(iic,        "write data over I2C: I2C=addr data (hex)") \
@@ -699,6 +702,20 @@ static errcodes_t cmd_time(const char *cmd, char _U_ *args){
     return ERR_AMOUNT;
 }
 
+static errcodes_t cmd_evtstat(const char *cmd, char *args){
+    if(args && *args){
+        gpioevt_clear();
+        return ERR_OK;
+    }
+    gpioevt_stat_t st = gpioevt_stat;
+    SEND(cmd); SEND(".events"); SEND(EQ); SENDn(u2str(st.events));
+    SEND(cmd); SEND(".lost"); SEND(EQ); SENDn(u2str(st.lost));
+    SEND(cmd); SEND(".unsent"); SEND(EQ); SENDn(u2str(st.unsent));
+    SEND(cmd); SEND(".maxlatency"); SEND(EQ); SENDn(u2str(st.maxlat));
+    SEND(cmd); SEND(".meanlatency"); SEND(EQ); SENDn(u2str(st.events ? st.sumlat / st.events : 0));
+    return ERR_AMOUNT;
+}
+
 static errcodes_t cmd_mcureset(const char _U_ *cmd, char _U_ *args){
     NVIC_SystemReset();
     return ERR_CANTRUN; // never reached
@@ -1009,17 +1026,56 @@ static const char *CommandParser(char *str){
     return NULL;
 }
 
+// append string to `buf` at position `l`; @return new position
+static int addstr(char *buf, int l, const char *str){
+    while(*str) buf[l++] = *str++;
+    return l;
+}
+
+// send `l` bytes of buffered events; `s` - their statistics (counted only if they were sent)
+static void sendevtbuf(const char *buf, int l, const gpioevt_stat_t *s){
+    if(USB_send(IGPIO, (const uint8_t*)buf, l)){
+        gpioevt_stat.events += s->events;
+        gpioevt_stat.sumlat += s->sumlat;
+        if(s->maxlat > gpioevt_stat.maxlat) gpioevt_stat.maxlat = s->maxlat;
+    }else gpioevt_stat.unsent += s->events;
+}
+
+// send all pin change events by portions not more than MAXSTRLEN; events are taken from FIFO only
+// while USB output buffer have room for them (else they wait in FIFO and counted as lost on its overflow)
+static void sendevents(){
+    static char buf[MAXSTRLEN];
+    gpioevt_t e;
+    gpioevt_stat_t s = {};
+    int l = 0, room = USB_sendbufspace(IGPIO) - 1;
+    // "PXx = val @us\n" - not more than 30 symbols
+    while(room - l > 32 && gpioevt_pop(&e)){
+        if(l > MAXSTRLEN - 32){
+            sendevtbuf(buf, l, &s);
+            room -= l;
+            l = 0;
+            s = {};
+        }
+        l = addstr(buf, l, e.port == 0 ? "PA" : "PB");
+        l = addstr(buf, l, u2str(e.pin));
+        l = addstr(buf, l, EQ);
+        l = addstr(buf, l, u2str(e.value));
+        l = addstr(buf, l, " @");
+        l = addstr(buf, l, u2str(e.T));
+        buf[l++] = '\n';
+        uint32_t lat = getus() - e.T;
+        ++s.events;
+        s.sumlat += lat;
+        if(lat > s.maxlat) s.maxlat = lat;
+    }
+    if(l) sendevtbuf(buf, l, &s);
+}
+
 void GPIO_process(){
     int l;
     // TODO: check SPI/I2C etc
-    for(uint8_t port = 0; port < 2; ++port){
-        uint16_t alert = gpio_alert(port);
-        if(alert == 0) continue;
-        uint16_t pinmask = 1;
-        for(uint8_t i = 0; i < 16; ++i, pinmask <<= 1){
-            if(alert & pinmask) pin_getter(port, i);
-        }
-    }
+    for(uint8_t port = 0; port < 2; ++port) gpio_poll(port);
+    sendevents();
     l = usart_process(curbuf, MAXSTRLEN);
     if(l > 0) sendusartdata(curbuf, l);
     l = RECV((char*)curbuf, MAXSTRLEN);
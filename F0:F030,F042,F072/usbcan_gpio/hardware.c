@@ -45,6 +45,18 @@ void hardware_setup(){
     GPIO_init();
 }
 
+// time from start in microseconds (SysTick counts down from LOAD each millisecond)
+uint32_t getus(){
+    uint32_t ms, val;
+    do{
+        ms = Tms;
+        val = SysTick->VAL;
+    }while(ms != Tms);
+    // called from IRQ with SysTick pending: counter reloaded but Tms isn't incremented yet
+    if((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) && val > (SysTick->LOAD >> 1)) ++ms;
+    return ms * 1000 + (SysTick->LOAD - val) * 1000 / (SysTick->LOAD + 1);
+}
+
 void iwdg_setup(){
     uint32_t tmout = 16000000;
     /* Enable the peripheral clock RTC */
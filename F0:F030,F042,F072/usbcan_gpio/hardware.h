@@ -45,6 +45,7 @@ extern const uint32_t peripherial_clock;
 extern uint8_t ledsON;
 
 void hardware_setup();
+uint32_t getus();
 void iwdg_setup();
 #ifdef STM32F072xB
 void Jump2Boot();
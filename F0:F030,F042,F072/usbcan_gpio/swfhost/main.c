@@ -0,0 +1,141 @@
+/*
+ * This file is part of the usbcangpio project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host checker of software CAN filter (../swfilter.c): ID map is compared with old ignore list semantics
+// (linear scan of ignored IDs) and with linear evaluation of random range/mask/accept rules, including
+// per-rule hit counters.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+#include "swfilter.h"
+
+// old semantics: frame passes if its ID isn't in ignore list
+static int isgood(const uint16_t *ign, int n, uint16_t ID){
+    for(int i = 0; i < n; ++i)
+        if(ign[i] == ID) return 0;
+    return 1;
+}
+
+// reference: linear scan of rules, last matching wins; return deciding rule or -1
+static int decider(uint16_t ID){
+    for(int i = swfilter.nrules - 1; i > -1; --i){
+        const swfrule_t *r = &swfilter.rules[i];
+        int m = ((r->type & SWF_TYPEMASK) == SWF_MASK) ? (((ID ^ r->id) & r->arg) == 0) :
+                (ID >= r->id && ID <= r->arg);
+        if(m) return i;
+    }
+    return -1;
+}
+
+static int chkoldlist(){
+    int bad = 0;
+    for(int k = 0; k < 200 && !bad; ++k){
+        uint16_t ign[SWF_MAXRULES];
+        int n = lrand48() % (SWF_MAXRULES + 1);
+        swf_clear();
+        for(int i = 0; i < n; ++i){
+            ign[i] = lrand48() & 0x7ff;
+            swfrule_t r = {.id = ign[i], .arg = ign[i], .type = SWF_RANGE};
+            if(swf_addrule(&r)) bad = 1;
+        }
+        for(uint16_t ID = 0; ID < 0x800 && !bad; ++ID){
+            if(swf_pass(ID) != isgood(ign, n, ID)){
+                if(verbose) printf("ID 0x%03x: differs from ignore list\n", ID);
+                bad = 1;
+            }
+        }
+    }
+    return chkfail("single IDs vs ignore list", bad);
+}
+
+static void randrule(swfrule_t *r){
+    r->type = (lrand48() & 1) ? SWF_ACCEPT : 0;
+    if(lrand48() & 1){
+        r->type |= SWF_MASK;
+        r->id = lrand48() & 0x7ff;
+        r->arg = lrand48() & 0x7ff & ~((1 << (lrand48() % 8)) - 1); // low bits are "don't care"
+    }else{
+        r->id = lrand48() & 0x7ff;
+        r->arg = r->id + lrand48() % 300;
+        if(r->arg > 0x7ff) r->arg = 0x7ff;
+    }
+}
+
+static int chkrules(){
+    int bad = 0;
+    for(int k = 0; k < 300 && !bad; ++k){
+        swf_clear();
+        int n = 1 + lrand48() % SWF_MAXRULES;
+        for(int i = 0; i < n; ++i){
+            swfrule_t r;
+            randrule(&r);
+            if(swf_addrule(&r)) bad = 1;
+        }
+        uint32_t hits[SWF_MAXRULES] = {0}, dropped = 0;
+        for(int j = 0; j < 10000 && !bad; ++j){
+            uint16_t ID = lrand48() & 0x7ff;
+            int d = decider(ID), pass = (d < 0 || (swfilter.rules[d].type & SWF_ACCEPT));
+            if(!pass){
+                ++hits[d];
+                ++dropped;
+            }
+            if(swf_pass(ID) != pass){
+                if(verbose) printf("set %d, ID 0x%03x: pass=%d, should be %d\n", k, ID, !pass, pass);
+                bad = 1;
+            }
+        }
+        if(!bad && (dropped != swf_dropped || memcmp(hits, swf_hits, sizeof(hits)))){
+            if(verbose) printf("set %d: wrong hit counters (dropped %u/%u)\n", k, swf_dropped, dropped);
+            bad = 1;
+        }
+    }
+    return chkfail("random rules", bad);
+}
+
+static int chkadd(){
+    int bad = 0;
+    swf_clear();
+    swfrule_t r = {.id = 0x200, .arg = 0x100, .type = SWF_RANGE};
+    bad |= swf_addrule(&r) != 2;
+    r.id = 0x800; r.arg = 0x800;
+    bad |= swf_addrule(&r) != 2;
+    r.id = 0x10; r.arg = 0x900; r.type = SWF_MASK;
+    bad |= swf_addrule(&r) != 2;
+    r.id = r.arg = 0x10; r.type = SWF_RANGE;
+    for(int i = 0; i < SWF_MAXRULES; ++i) bad |= swf_addrule(&r) != 0;
+    bad |= swf_addrule(&r) != 1;
+    // the last of equal rules gets hits
+    bad |= swf_pass(0x10) != 0 || swf_hits[SWF_MAXRULES - 1] != 1 || swf_pass(0x11) != 1;
+    // wrong amount of rules from flash
+    swfilter.nrules = SWF_MAXRULES + 1;
+    swf_rebuild();
+    bad |= swfilter.nrules != 0 || swf_pass(0x10) != 1;
+    return chkfail("rules checking", bad);
+}
+
+int main(int argc, char **argv){
+    hosttest_opts(argc, argv);
+    int ret = chkoldlist();
+    ret |= chkrules();
+    ret |= chkadd();
+    return hosttest_result(ret);
+}
@@ -0,0 +1,90 @@
+/*
+ * This file is part of the usbcangpio project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "swfilter.h"
+
+swfilter_t swfilter = {0};
+uint32_t swf_hits[SWF_MAXRULES] = {0};
+uint32_t swf_dropped = 0;
+
+// bitmap of ignored 11-bit IDs (bit set - ignore); both swf_pass() and swf_rebuild() are called
+// from main loop only (CAN FIFOs are polled in can_proc()), so map can be rebuilt in place
+static uint8_t ignmap[2048/8];
+
+static int matches(const swfrule_t *r, uint16_t ID){
+    if((r->type & SWF_TYPEMASK) == SWF_MASK)
+        return ((ID ^ r->id) & r->arg) == 0;
+    return (ID >= r->id && ID <= r->arg);
+}
+
+// fill map by current rules
+void swf_rebuild(){
+    memset(ignmap, 0, sizeof(ignmap));
+    if(swfilter.nrules > SWF_MAXRULES) swfilter.nrules = 0; // wrong data from flash
+    for(int i = 0; i < swfilter.nrules; ++i){
+        const swfrule_t *r = &swfilter.rules[i];
+        uint8_t accept = r->type & SWF_ACCEPT;
+        for(uint16_t ID = 0; ID < 0x800; ++ID){
+            if(!matches(r, ID)) continue;
+            // last matching rule wins
+            if(accept) ignmap[ID >> 3] &= ~(1 << (ID & 7));
+            else ignmap[ID >> 3] |= 1 << (ID & 7);
+        }
+    }
+    memset(swf_hits, 0, sizeof(swf_hits));
+    swf_dropped = 0;
+}
+
+/**
+ * @brief swf_addrule - add new rule to the end of list
+ * @param r - rule
+ * @return 0 if all OK, 1 if list is full, 2 if rule is wrong
+ */
+int swf_addrule(const swfrule_t *r){
+    if(swfilter.nrules >= SWF_MAXRULES) return 1;
+    if(r->id > 0x7ff || r->arg > 0x7ff) return 2;
+    if((r->type & SWF_TYPEMASK) == SWF_RANGE && r->arg < r->id) return 2;
+    swfilter.rules[swfilter.nrules++] = *r;
+    swf_rebuild();
+    return 0;
+}
+
+void swf_clear(){
+    swfilter.nrules = 0;
+    swf_rebuild();
+}
+
+/**
+ * @brief swf_pass - check if frame with given ID should be passed
+ * @param ID - 11-bit ID
+ * @return 1 if frame passes filter, 0 if it should be ignored (and then counts hit of deciding rule)
+ */
+int swf_pass(uint16_t ID){
+    ID &= 0x7ff;
+    if(!(ignmap[ID >> 3] & (1 << (ID & 7)))) return 1;
+    ++swf_dropped;
+    // deciding rule: the last matching one
+    for(int i = swfilter.nrules - 1; i > -1; --i){
+        if(!matches(&swfilter.rules[i], ID)) continue;
+        ++swf_hits[i];
+        break;
+    }
+    return 0;
+}
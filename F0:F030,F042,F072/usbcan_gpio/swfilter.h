@@ -0,0 +1,54 @@
+/*
+ * This file is part of the usbcangpio project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// max amount of software filter rules
+#define SWF_MAXRULES        (16)
+
+// rule types
+#define SWF_RANGE           (0)     // `id` - low border, `arg` - high border (single ID: id == arg)
+#define SWF_MASK            (1)     // ID matches if (ID & arg) == (id & arg)
+#define SWF_TYPEMASK        (1)
+#define SWF_ACCEPT          (1<<7)  // flag: rule accepts matching IDs instead of ignoring them
+
+typedef struct __attribute__((packed)){
+    uint16_t id;    // ID or low border
+    uint16_t arg;   // high border or mask
+    uint8_t type;   // SWF_RANGE/SWF_MASK | SWF_ACCEPT
+} swfrule_t;
+
+// filter set (stored in flash as a part of user_conf)
+typedef struct __attribute__((packed)){
+    uint8_t nrules;
+    swfrule_t rules[SWF_MAXRULES];
+} swfilter_t;
+
+// current (working) filter set; rules are applied in order, last matching rule wins
+extern swfilter_t swfilter;
+// ignored frames counters for each rule
+extern uint32_t swf_hits[SWF_MAXRULES];
+// total amount of ignored frames
+extern uint32_t swf_dropped;
+
+int swf_addrule(const swfrule_t *r);
+void swf_clear();
+void swf_rebuild();
+int swf_pass(uint16_t ID);
@@ -222,6 +222,11 @@ int USB_sendall(uint8_t ifno){
     return TRUE;
 }
 
+// start transmission of buffered data (binary data have no '\n' to initiate it)
+void USB_flush(uint8_t ifno){
+    if(CDCready[ifno] && lastdsz[ifno] < 0) send_next(ifno);
+}
+
 // return amount of free space in buffer
 int USB_sendbufspace(uint8_t ifno){
     if(!CDCready[ifno]) return 0;
@@ -17,13 +17,10 @@
  */
 
 #include "as3935.h"
+#include "lightning.h"
 #include "spi.h"
 
-#define MODE_READ   (1 << 6)
-#define MODE_WRITE  (0)
-#define MODE_MASK   (0x3f)
-
-extern uint32_t Tms;
+extern volatile uint32_t Tms;
 
 // read one register
 int as3935_read(uint8_t reg, uint8_t *data){
@@ -107,12 +104,16 @@ int as3935_calib_rco(){
     if(!as3935_write(CALIB_RCO, DIRECT_COMMAND)) return FALSE;
     t.DISP_LCO = t.DISP_TRCO = 0;
     t.DISP_SRCO = 1;
-    if(!as3935_write(TUN_DISP, t.u8)) return FALSE;
-    uint32_t Tstart = Tms;
-    while(Tms - Tstart < 3) IWDG->KR = IWDG_REFRESH; // sleep for ~2ms
-    t.DISP_SRCO = 0;
-    if(!as3935_write(TUN_DISP, t.u8)) return FALSE;
-    return TRUE;
+    evt_enable(as3935_channel, 0); // IRQ pin will show SRCO
+    int ret = as3935_write(TUN_DISP, t.u8);
+    if(ret){
+        uint32_t Tstart = Tms;
+        while(Tms - Tstart < 3) IWDG->KR = IWDG_REFRESH; // sleep for ~2ms
+        t.DISP_SRCO = 0;
+        ret = as3935_write(TUN_DISP, t.u8);
+    }
+    evt_enable(as3935_channel, 1);
+    return ret;
 }
 
 int as3935_get_calib(uint8_t *n){
@@ -116,6 +116,11 @@ typedef union{
     }; uint8_t u8;
 } t_calib;
 
+// SPI command: read/write mode and register address
+#define MODE_READ   (1 << 6)
+#define MODE_WRITE  (0)
+#define MODE_MASK   (0x3f)
+
 // direct command send to PRESET_DEFAULT and CALIB_RCO
 #define DIRECT_COMMAND  (0x96)
 // distance out of range
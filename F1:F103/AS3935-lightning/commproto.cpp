@@ -26,6 +26,7 @@ extern "C"{
 #include "commproto.h"
 #include "flash.h"
 #include "hardware.h"
+#include "lightning.h"
 #include "spi.h"
 #include "strfunc.h"
 }
@@ -47,6 +48,9 @@ static uint8_t curbuf[MAXSTRLEN];
     COMMAND(dumpconf,   "dump current configuration") \
     COMMAND(energy,     "energy of last lightning") \
     COMMAND(eraseflash, "erase full flash storage") \
+    COMMAND(events,     "get events from ring (events=N - not more than N)") \
+    COMMAND(evtbatch,   "don't show events automatically, keep them for `events` (0/1)") \
+    COMMAND(evtstat,    "events statistics (evtstat=0 to clear)") \
     COMMAND(gain,       "change sensor's gain (0..1f)") \
     COMMAND(help,       "show this help") \
     COMMAND(intcode,    "last interrupt code") \
@@ -227,6 +231,66 @@ static errcodes_t cmd_restonstart(const char* cmd, char* args){
     return ERR_AMOUNT;
 }
 
+static errcodes_t cmd_evtbatch(const char* cmd, char* args){
+    int32_t val;
+    if(argsvals(args, NULL, &val)){ // setter
+        if(!val) the_conf.flags.evtbatch = 0;
+        else the_conf.flags.evtbatch = 1;
+    }
+    CMDEQ();
+    SEND(u2str(the_conf.flags.evtbatch));
+    SEND("\n");
+    return ERR_AMOUNT;
+}
+
+// send milliseconds with microseconds: `ms.uuu`
+static void sendtime(uint32_t T, uint16_t us){
+    char c[5];
+    c[0] = '.';
+    c[1] = '0' + (us / 100) % 10;
+    c[2] = '0' + (us / 10) % 10;
+    c[3] = '0' + us % 10;
+    c[4] = 0;
+    SEND(u2str(T)); SEND(c);
+}
+
+static errcodes_t cmd_events(const char *cmd, char *args){
+    int32_t N = EVT_RINGSZ;
+    if(argsvals(args, NULL, &N) && N < 1) return ERR_BADVAL;
+    uint8_t n = evt_amount();
+    if(N > n) N = n;
+    CMDEQ(); SEND(u2str(N)); SEND("\n");
+    // `ch time code energy distance`
+    lightning_evt_t e;
+    for(; N > 0 && evt_get(&e); --N){
+        SEND(u2str(e.ch)); SEND(" ");
+        sendtime(e.T, e.us); SEND(" ");
+        SEND(u2str(e.code)); SEND(" ");
+        SEND(u2str(e.energy)); SEND(" ");
+        SEND(u2str(e.distance)); SEND("\n");
+    }
+    return ERR_AMOUNT;
+}
+
+#define SHOWSTAT(x)  do{SEND(#x "="); SEND(u2str(evt_stat.x)); SEND("\n");}while(0)
+static errcodes_t cmd_evtstat(const char*, char *args){
+    int32_t val;
+    if(argsvals(args, NULL, &val)){
+        if(val) return ERR_BADVAL;
+        evt_clrstat();
+        return ERR_OK;
+    }
+    SHOWSTAT(events);
+    SHOWSTAT(lost);
+    SHOWSTAT(missed);
+    SHOWSTAT(stuck);
+    SHOWSTAT(spibusy);
+    SHOWSTAT(spierr);
+    SEND("inring="); SEND(u2str(evt_amount())); SEND("\n");
+    return ERR_AMOUNT;
+}
+#undef SHOWSTAT
+
 static void showpar(const char *par, uint8_t n, uint8_t v){
     char c[2];
     c[0] = '0' + n; c[1] = 0;
@@ -240,6 +304,7 @@ static errcodes_t cmd_dumpconf(const char*, char*){
     SEND("\ncapacity="); SEND(u2str(maxCnum-2));
     cmd_setiface("\nsetiface", NULL);
     cmd_restonstart("restonstart", NULL);
+    cmd_evtbatch("evtbatch", NULL);
     for(int i = 0; i < SENSORS_AMOUNT; ++i){
         showpar("gain", i, the_conf.spars[i].AFE_GB);
         showpar("\nlco_fdiv", i, the_conf.spars[i].LCO_FDIV);
@@ -307,7 +372,10 @@ static errcodes_t cmd_displco(const char *cmd, char *args){
     int32_t CHno, val;
     if(!argsvals(args, &CHno, &val)) return getta(cmd, CHno, as3935_get_displco);
     errcodes_t ret = senscmd8(CHno, as3935_displco, val);
-    if(ret == ERR_OK) DISPLCO[CHno] = val;
+    if(ret == ERR_OK){
+        DISPLCO[CHno] = val;
+        evt_enable(CHno, 1); // disable IRQ events if pin used as clock output
+    }
     return ret;
 }
 
@@ -456,12 +524,24 @@ const char *parse_cmd(int (*sendfun)(const char *), char *str){
     return NULL;
 }
 
-// show lightning information
-void lightning_info(int (*sendfun)(const char*), uint8_t CHno){
-    if(!sendfun || CHno >= SENSORS_AMOUNT) return;
-    char c[2];
-    c[0] = '0' + CHno; c[1] = 0;
+// show event (in `INTERRUPTx=...` format)
+void show_event(int (*sendfun)(const char*), const lightning_evt_t *e){
+    if(!sendfun || !e) return;
     SEND = sendfun;
-    cmd_energy("energy", c);
-    cmd_distance("distance", c);
+    const char *cmd = "evtime";
+    uint8_t code = e->code;
+    SEND("INTERRUPT"); SEND(u2str(e->ch)); SEND("=");
+    const char *delim = NULL, *comma = ",";
+    if(code & INT_NH){ SEND("NOICE"); delim = comma; code &= ~INT_NH; }
+    if(code & INT_D){ if(delim) SEND(delim); SEND("DISTURBER"); delim = comma; code &= ~INT_D; }
+    if(code & INT_L){ if(delim) SEND(delim); SEND("LIGHTNING"); code &= ~INT_L; }
+    if(code) SEND(u2str(code));
+    SEND("\n");
+    CMDEQP(e->ch); sendtime(e->T, e->us); SEND("\n");
+    if(e->code == INT_L){ // lightning: show energy and distance
+        cmd = "energy";
+        CMDEQP(e->ch); SEND(u2str(e->energy)); SEND("\n");
+        cmd = "distance";
+        CMDEQP(e->ch); SEND(u2str(e->distance)); SEND("\n");
+    }
 }
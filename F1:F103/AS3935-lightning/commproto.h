@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include "lightning.h"
 #include "version.inc"
 
 #ifdef EBUG
@@ -51,4 +52,4 @@ typedef enum{
 
 extern const char *EQ;
 const char *parse_cmd(int (*sendfun)(const char*), char *buf);
-void lightning_info(int (*sendfun)(const char*), uint8_t CHno);
+void show_event(int (*sendfun)(const char*), const lightning_evt_t *e);
@@ -45,6 +45,7 @@ typedef struct{
 
 typedef struct{
     uint8_t restore : 1;   // restore sensors' parameters on start
+    uint8_t evtbatch : 1;  // don't show events automatically, keep them in ring for `events` command
 } flags_t;
 
 /*
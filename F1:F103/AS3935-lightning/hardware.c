@@ -18,6 +18,7 @@
 
 #include "adc.h"
 #include "hardware.h"
+#include "lightning.h"
 #include "spi.h"
 
 /*
@@ -45,6 +46,14 @@ static inline void gpio_setup(){
                  CRL(3, CNF_PPOUTPUT|MODE_SLOW) | CRL(5, CNF_AFPP|MODE_FAST) | CRL(6, CNF_FLINPUT|MODE_INPUT) | CRL(7, CNF_AFPP|MODE_FAST);
     GPIOA->CRH = CRH(9, CNF_AFPP|MODE_FAST) | CRH(10, CNF_FLINPUT|MODE_INPUT) | CRH(15, CNF_PPOUTPUT|MODE_SLOW);
     CS_OFF();
+    // EXTI0/1 (PA0/PA1): rising edge of sensors' IRQ; the highest priority for precise timestamps
+    AFIO->EXTICR[0] = AFIO_EXTICR1_EXTI0_PA | AFIO_EXTICR1_EXTI1_PA;
+    EXTI->RTSR = EXTI_RTSR_TR0 | EXTI_RTSR_TR1;
+    EXTI->IMR = EXTI_IMR_MR0 | EXTI_IMR_MR1;
+    NVIC_SetPriority(EXTI0_IRQn, 0);
+    NVIC_SetPriority(EXTI1_IRQn, 0);
+    NVIC_EnableIRQ(EXTI0_IRQn);
+    NVIC_EnableIRQ(EXTI1_IRQn);
 }
 
 void hw_setup(){
@@ -53,6 +62,16 @@ void hw_setup(){
     spi_setup();
 }
 
+void exti0_isr(){ // INT0
+    EXTI->PR = EXTI_PR_PR0;
+    evt_irq(0);
+}
+
+void exti1_isr(){ // INT1
+    EXTI->PR = EXTI_PR_PR1;
+    evt_irq(1);
+}
+
 #ifndef EBUG
 void iwdg_setup(){
     uint32_t tmout = 16000000;
@@ -0,0 +1,171 @@
+/*
+ * This file is part of the as3935 project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "as3935.h"
+#include "hardware.h"
+#include "lightning.h"
+#include "spi.h"
+
+extern volatile uint32_t Tms;
+
+evt_stat_t evt_stat = {0};
+
+// events ring: written only in DMA IRQ, read in main loop
+static lightning_evt_t ring[EVT_RINGSZ + 1];
+static volatile uint8_t rhead = 0, rtail = 0;
+
+typedef enum{
+    EVST_IDLE,          // wait for IRQ
+    EVST_WAIT,          // got IRQ, wait EVT_READDELAY ms
+    EVST_READ           // registers reading in progress
+} evstate_t;
+
+// per-sensor event processing
+typedef struct{
+    lightning_evt_t e;  // current event
+    spi_xfer_t x;
+    uint8_t buf[6];     // command + INT_MASK_ANT, S_LIG_L, S_LIG_M, S_LIG_MM, DISTANCE (address autoincrement)
+    volatile uint8_t state;
+    uint8_t ticks;      // ms since IRQ or since IRQ pin is high in idle state
+} chstate_t;
+
+static chstate_t chst[SENSORS_AMOUNT];
+
+/**
+ * @brief evt_enable - enable or disable IRQ events of given sensor
+ * @param ch - sensor number
+ * @param en - ==1 to enable (only if IRQ pin isn't used for LCO display)
+ */
+void evt_enable(uint8_t ch, uint8_t en){
+    if(ch >= SENSORS_AMOUNT) return;
+    uint32_t bit = 1 << ch; // EXTI line == INT pin number
+    if(en && DISPLCO[ch] == DISPLCO_NOTHING){
+        EXTI->PR = bit;
+        EXTI->IMR |= bit;
+    }else EXTI->IMR &= ~bit;
+    chst[ch].ticks = 0;
+}
+
+// current time with microsecond resolution
+static void gettime(lightning_evt_t *e){
+    uint32_t T = Tms, val = SysTick->VAL;
+    // counter was reloaded, but SysTick IRQ isn't processed yet
+    if((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) && val > SysTick->LOAD / 2) ++T;
+    e->T = T;
+    e->us = (uint16_t)((SysTick->LOAD - val) * 1000 / (SysTick->LOAD + 1));
+}
+
+// rising edge on INT pin: store timestamp (EXTI IRQ)
+void evt_irq(uint8_t ch){
+    if(ch >= SENSORS_AMOUNT) return;
+    chstate_t *c = &chst[ch];
+    if(c->state != EVST_IDLE){
+        ++evt_stat.missed;
+        return;
+    }
+    gettime(&c->e);
+    c->ticks = 0;
+    c->state = EVST_WAIT;
+}
+
+// registers are read (DMA IRQ)
+static void readdone(spi_xfer_t *x){
+    chstate_t *c = &chst[x->ch];
+    if(x->done != SPI_XFER_OK){
+        ++evt_stat.spierr;
+        c->state = EVST_IDLE;
+        return;
+    }
+    lightning_evt_t *e = &c->e;
+    e->ch = x->ch;
+    e->code = c->buf[1] & 0x0f;
+    if(e->code & INT_L) e->energy = ((c->buf[4] & 0x1f) << 16) | (c->buf[3] << 8) | c->buf[2];
+    else e->energy = 0;
+    e->distance = c->buf[5] & 0x3f;
+    uint8_t next = (rtail + 1) % (EVT_RINGSZ + 1);
+    if(next == rhead) ++evt_stat.lost;
+    else{
+        ring[rtail] = *e;
+        rtail = next;
+        ++evt_stat.events;
+    }
+    c->state = EVST_IDLE;
+}
+
+// call this each millisecond (from SysTick IRQ)
+void evt_tick(){
+    for(uint8_t ch = 0; ch < SENSORS_AMOUNT; ++ch){
+        chstate_t *c = &chst[ch];
+        switch(c->state){
+            case EVST_WAIT:
+                if(++c->ticks <= EVT_READDELAY) break;
+                c->buf[0] = MODE_READ | INT_MASK_ANT;
+                for(uint8_t i = 1; i < sizeof(c->buf); ++i) c->buf[i] = 0;
+                c->x.buf = c->buf;
+                c->x.len = sizeof(c->buf);
+                c->x.ch = ch;
+                c->x.cb = readdone;
+                c->state = EVST_READ;
+                if(!spi_enqueue(&c->x)){ // try again next time
+                    ++evt_stat.spibusy;
+                    c->state = EVST_WAIT;
+                }
+            break;
+            case EVST_IDLE: // edge could be lost while previous event was processing
+                if(!(EXTI->IMR & (1 << ch)) || !CHK_INT(ch)){
+                    c->ticks = 0;
+                    break;
+                }
+                if(++c->ticks < EVT_STUCKTIME) break;
+                __disable_irq();
+                if(c->state == EVST_IDLE){
+                    gettime(&c->e);
+                    c->ticks = 0;
+                    c->state = EVST_WAIT;
+                    ++evt_stat.stuck;
+                }
+                __enable_irq();
+            break;
+            default:
+            break;
+        }
+    }
+}
+
+/**
+ * @brief evt_get - get next event from ring
+ * @param e (o) - event
+ * @return FALSE if ring is empty
+ */
+int evt_get(lightning_evt_t *e){
+    if(rhead == rtail) return FALSE;
+    if(e) *e = ring[rhead];
+    rhead = (rhead + 1) % (EVT_RINGSZ + 1);
+    return TRUE;
+}
+
+// amount of events in ring
+uint8_t evt_amount(){
+    int n = rtail - rhead;
+    if(n < 0) n += EVT_RINGSZ + 1;
+    return (uint8_t)n;
+}
+
+void evt_clrstat(){
+    evt_stat = (evt_stat_t){0};
+}
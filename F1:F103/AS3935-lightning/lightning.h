@@ -0,0 +1,57 @@
+/*
+ * This file is part of the as3935 project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// size of events ring
+#define EVT_RINGSZ      (32)
+// delay between IRQ and INT register reading (datasheet: >= 2ms)
+#define EVT_READDELAY   (2)
+// if IRQ pin is high for this time (ms) without event processing, read it anyway
+#define EVT_STUCKTIME   (10)
+
+// one event from sensor
+typedef struct{
+    uint32_t T;         // time of IRQ rising edge: ms
+    uint16_t us;        // and microseconds
+    uint8_t ch;         // sensor number
+    uint8_t code;       // interrupt code (INT_NH|INT_D|INT_L or 0 if distance changed)
+    uint32_t energy;    // S_LIG (only for lightning)
+    uint8_t distance;   // distance, km
+} lightning_evt_t;
+
+// events statistics
+typedef struct{
+    uint32_t events;    // total events stored in ring
+    uint32_t lost;      // events lost due to ring overflow
+    uint32_t missed;    // IRQs came while previous event of this sensor still processing
+    uint32_t stuck;     // events found by IRQ pin level instead of edge
+    uint32_t spibusy;   // SPI queue was full (reading retried)
+    uint32_t spierr;    // events lost due to SPI errors
+} evt_stat_t;
+
+extern evt_stat_t evt_stat;
+
+void evt_enable(uint8_t ch, uint8_t en);
+void evt_irq(uint8_t ch);
+void evt_tick();
+int evt_get(lightning_evt_t *e);
+uint8_t evt_amount();
+void evt_clrstat();
@@ -21,6 +21,7 @@
 #include "hardware.h"
 #include "commproto.h"
 #include "flash.h"
+#include "lightning.h"
 #include "spi.h"
 #include "strfunc.h"
 #include "usb_dev.h"
@@ -33,10 +34,10 @@ static char inbuff[RBINSZ];
 /* Called when systick fires */
 void sys_tick_handler(void){
     ++Tms;
+    evt_tick();
 }
 
 int main(){
-    uint8_t oldint[2] = {0}; // ==1 for interrupted pins
     uint32_t lastT = 0;
     StartHSE();
     //flashstorage_init();
@@ -79,30 +80,9 @@ int main(){
             const char *ans = parse_cmd(USB_sendstr, inbuff);
             if(ans) USB_sendstr(ans);
         }
-        for(uint8_t ch = 0; ch < SENSORS_AMOUNT; ++ch){
-            if(DISPLCO[ch] != DISPLCO_NOTHING) continue; // don't check IRQ in if it used as clock output
-            if(CHK_INT(ch)){
-                if(oldint[ch] == 0){
-                    oldint[ch] = 1;
-                    uint8_t code;
-                    as3935_channel = ch;
-                    int result = as3935_intcode(&code);
-                    if(!result) USB_sendstr("CANTGET\n");
-                    else if(code){
-                        uint8_t savedcode = code;
-                        USB_sendstr("INTERRUPT"); USB_putbyte('0'+ch); USB_putbyte('=');
-                        const char *delim = NULL, *comma = ",";
-                        if(code & INT_NH){ USB_sendstr("NOICE"); delim = comma; code &= ~INT_NH; }
-                        if(code & INT_D){ USB_sendstr(delim); USB_sendstr("DISTURBER"); delim = comma; code &= ~INT_D; }
-                        if(code & INT_L){ USB_sendstr(delim); USB_sendstr("LIGHTNING"); code &= ~INT_L; }
-                        if(code) USB_sendstr(u2str(code));
-                        newline();
-                        if(savedcode == INT_L){ // clear lightning - show distance and power
-                            lightning_info(USB_sendstr, ch);
-                        }
-                    }
-                }
-            }else oldint[ch] = 0;
+        if(!the_conf.flags.evtbatch){
+            lightning_evt_t e;
+            while(evt_get(&e)) if(e.code) show_event(USB_sendstr, &e);
         }
     }
     return 0;
@@ -28,34 +28,149 @@ static const uint32_t SPI_CR1 = SPI_CR1_MSTR | SPI_CR1_BR_2 | SPI_CR1_BR_0 | SPI
 spiStatus SPI_status = SPI_NOTREADY;
 uint8_t as3935_channel = 0;
 
+// transactions queue; queue[qhead] is current transaction when SPI_status == SPI_BUSY
+static spi_xfer_t *queue[SPI_QUEUESZ + 1];
+static volatile uint8_t qhead = 0, qtail = 0;
+
 void spi_setup(){
     // master, no slave select, BR=F/16, CPOL/CPHA - polarity.
     SPI1->CR1 = SPI_CR1;
+    SPI1->CR2 = SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+    RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+    // DMA1 Channel2 - SPI1_RX, Channel3 - SPI1_TX; 8bit, mem++
+    DMA1_Channel2->CPAR = (uint32_t)&SPI1->DR;
+    DMA1_Channel2->CCR = DMA_CCR_MINC | DMA_CCR_TCIE | DMA_CCR_TEIE; // per->mem, transfer end on Rx complete
+    DMA1_Channel3->CPAR = (uint32_t)&SPI1->DR;
+    DMA1_Channel3->CCR = DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_TEIE; // mem->per
+    NVIC_SetPriority(DMA1_Channel2_IRQn, 1);
+    NVIC_SetPriority(DMA1_Channel3_IRQn, 1);
+    NVIC_EnableIRQ(DMA1_Channel2_IRQn);
+    NVIC_EnableIRQ(DMA1_Channel3_IRQn);
     SPI_status = SPI_READY;
     SPI1->CR1 |= SPI_CR1_SPE; // enable SPI
 }
 
-volatile uint32_t wctr;
-#define WAITX(x)  do{wctr = 0; while((x) && (++wctr < 360000)) IWDG->KR = IWDG_REFRESH; if(wctr==360000) return -1;}while(0)
+// run next transaction from queue (call it with IRQs disabled or from DMA IRQ)
+static void startnext(){
+    DMA1_Channel2->CCR &= ~DMA_CCR_EN;
+    DMA1_Channel3->CCR &= ~DMA_CCR_EN;
+    if(qhead == qtail){
+        SPI_status = SPI_READY;
+        return;
+    }
+    SPI_status = SPI_BUSY;
+    spi_xfer_t *x = queue[qhead];
+    while(SPI1->SR & SPI_SR_RXNE) (void) SPI1->DR; // clear old data
+    // data replaced in place: Rx always lags behind Tx
+    DMA1_Channel2->CMAR = (uint32_t)x->buf;
+    DMA1_Channel2->CNDTR = x->len;
+    DMA1_Channel3->CMAR = (uint32_t)x->buf;
+    DMA1_Channel3->CNDTR = x->len;
+    CS(x->ch);
+    DMA1_Channel2->CCR |= DMA_CCR_EN;
+    DMA1_Channel3->CCR |= DMA_CCR_EN;
+}
+
+// current transaction is over
+static void xferdone(spixferStatus st){
+    CS_OFF();
+    spi_xfer_t *x = queue[qhead];
+    qhead = (qhead + 1) % (SPI_QUEUESZ + 1);
+    x->done = st;
+    if(x->cb) x->cb(x);
+    startnext();
+}
+
+/**
+ * @brief spi_enqueue - put transaction into queue and start it if SPI is free
+ * @param x - transaction (should be valid until x->done is set)
+ * @return TRUE if OK, FALSE if queue is full or bad data
+ */
+int spi_enqueue(spi_xfer_t *x){
+    if(!x || !x->buf || !x->len || SPI_status == SPI_NOTREADY) return FALSE;
+    int ret = FALSE;
+    x->done = SPI_XFER_QUEUED;
+    __disable_irq();
+    uint8_t next = (qtail + 1) % (SPI_QUEUESZ + 1);
+    if(next != qhead){
+        queue[qtail] = x;
+        qtail = next;
+        if(SPI_status == SPI_READY) startnext();
+        ret = TRUE;
+    }
+    __enable_irq();
+    return ret;
+}
+
+// remove transaction from queue (aborting it if it's current); call it with IRQs disabled
+static void dequeue(spi_xfer_t *x){
+    if(qhead == qtail) return;
+    if(queue[qhead] == x && SPI_status == SPI_BUSY){
+        DMA1_Channel2->CCR &= ~DMA_CCR_EN;
+        DMA1_Channel3->CCR &= ~DMA_CCR_EN;
+        DMA1->IFCR = DMA_IFCR_CGIF2 | DMA_IFCR_CGIF3;
+        CS_OFF();
+        qhead = (qhead + 1) % (SPI_QUEUESZ + 1);
+        x->done = SPI_XFER_ERR;
+        startnext();
+        return;
+    }
+    // waiting: shift the rest of queue
+    uint8_t i = qhead, j = qhead;
+    while(i != qtail){
+        if(queue[i] != x){
+            queue[j] = queue[i];
+            j = (j + 1) % (SPI_QUEUESZ + 1);
+        }
+        i = (i + 1) % (SPI_QUEUESZ + 1);
+    }
+    qtail = j;
+    x->done = SPI_XFER_ERR;
+}
+
+// transaction for blocking calls
+static spi_xfer_t syncx = {0};
 
 /**
- * @brief SPI_transmit - transmit data and receive new one
+ * @brief SPI_transmit - transmit data and receive new one (blocking)
  * @param buf - data to transmit/receive
  * @param len - its length
- * @return amount of transmitted data or -1 if error
+ * @return amount of transmitted data or 0 if error
  */
 uint8_t SPI_transmit(uint8_t *buf, uint8_t len){
     if(!buf || !len) return 0; // bad data format
-    if(SPI_status != SPI_READY) return 0; // spi not ready to transmit data
-    CS(as3935_channel);
-    for(uint8_t x = 0; x < len; ++x){
-        WAITX(!(SPI1->SR & SPI_SR_TXE));
-        SPI1->DR = buf[x];
-        WAITX(!(SPI1->SR & SPI_SR_BSY));
-        WAITX(!(SPI1->SR & SPI_SR_RXNE));
-        buf[x] = SPI1->DR;
+    syncx.buf = buf;
+    syncx.len = len;
+    syncx.ch = as3935_channel;
+    if(!spi_enqueue(&syncx)) return 0; // queue is full
+    uint32_t ctr = 0;
+    while(syncx.done == SPI_XFER_QUEUED){
+        IWDG->KR = IWDG_REFRESH;
+        if(++ctr == 360000){ // timeout: DMA shouldn't touch `buf` after return
+            __disable_irq();
+            if(syncx.done == SPI_XFER_QUEUED) dequeue(&syncx);
+            __enable_irq();
+            syncx.buf = NULL;
+            return 0;
+        }
     }
-    CS_OFF();
+    syncx.buf = NULL;
+    if(syncx.done != SPI_XFER_OK) return 0;
     return len;
 }
 
+// Rx complete or error
+void dma1_channel2_isr(){
+    uint32_t isr = DMA1->ISR;
+    DMA1->IFCR = DMA_IFCR_CGIF2;
+    if(SPI_status != SPI_BUSY) return;
+    if(isr & DMA_ISR_TEIF2) xferdone(SPI_XFER_ERR);
+    else if(isr & DMA_ISR_TCIF2) xferdone(SPI_XFER_OK);
+}
+
+// Tx error
+void dma1_channel3_isr(){
+    uint32_t isr = DMA1->ISR;
+    DMA1->IFCR = DMA_IFCR_CGIF3;
+    if(SPI_status == SPI_BUSY && (isr & DMA_ISR_TEIF3)) xferdone(SPI_XFER_ERR);
+}
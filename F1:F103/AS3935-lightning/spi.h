@@ -26,10 +26,34 @@ typedef enum{
     SPI_BUSY
 } spiStatus;
 
+// max amount of transactions waiting in queue
+#define SPI_QUEUESZ     (8)
+
+// `done` field of transaction
+typedef enum{
+    SPI_XFER_QUEUED,    // in queue or in progress
+    SPI_XFER_OK,        // done
+    SPI_XFER_ERR        // DMA error
+} spixferStatus;
+
+/*
+ * Asynchronous transaction: `buf` is transmitted and replaced by received data in place,
+ * so both structure and buffer should live until `done` != SPI_XFER_QUEUED.
+ * `cb` (if not NULL) is called from DMA interrupt after transaction ends.
+ */
+typedef struct spi_xfer{
+    uint8_t *buf;
+    uint8_t len;
+    uint8_t ch;                         // sensor number for `CS` macro
+    volatile uint8_t done;              // spixferStatus
+    void (*cb)(struct spi_xfer *x);
+} spi_xfer_t;
+
 extern spiStatus SPI_status;
 // SPI channel number for `CS` macro
 extern uint8_t as3935_channel;
 
 void spi_setup();
+int spi_enqueue(spi_xfer_t *x);
 uint8_t SPI_transmit(uint8_t *buf, uint8_t len);
 
@@ -37,9 +37,6 @@
 // waiting for starting moving - 0.25s
 #define MOVING_PAUSE    (250)
 
-// interval of canon_proc calls (10ms)
-#define CANONPROC_INTERVAL  (9)
-
 // `flooding` interval (250ms)
 #define FLOODING_INTERVAL   (249)
 
@@ -108,12 +105,14 @@ typedef enum{
     INI_S_AMOUNT
 } lensinit_state;
 
+void canon_setup();
 void canon_init();
 void canon_proc();
 void canon_disable();
 void canon_enable();
 int canon_diaphragm(char command);
 int canon_focus(int16_t val);
+int canon_focusrel(int16_t val);
 int canon_sendcmd(uint8_t cmd);
 int canon_asku16(uint8_t cmd);
 int canon_writeu16(uint8_t cmd, uint16_t u);
@@ -0,0 +1,504 @@
+/*
+ * This file is part of the canonmanage project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "canonq.h"
+
+#define ABS(x)      (((x) < 0) ? -(x) : (x))
+#define QIDX(i)     ((qhead + (i)) & (CQ_QLEN - 1))
+
+cq_stat cq_stats = {0};
+
+static cq_startfn startfn = NULL;
+static cq_abortfn abortfn = NULL;
+
+static cq_xfer queue[CQ_QLEN];
+static uint8_t qhead = 0, qlen = 0;
+
+// state of queue head execution
+typedef enum{
+    PH_IDLE,        // head isn't started
+    PH_XFER,        // head transaction is running
+    PH_POLLNEXT,    // head is sent, need next busy poll
+    PH_POLL,        // busy poll transaction is running
+} phase_t;
+
+static phase_t phase = PH_IDLE;
+static uint32_t Txfer = 0, Tpoll = 0, xferms = 0; // start of transaction and polling, duration of last transaction
+static uint8_t pollbuf[2];
+
+static lens_state state = LENS_DISCONNECTED;
+static lensinit_state inistate = INI_ERR;
+static uint8_t inierr = 0;
+// focus in steps from minimal position: pos = raw - Fdelta; Forig - position before initialization
+static int32_t Fdelta = 0, Forig = BADFOCVAL, Fmax = BADFOCVAL, Fcur = BADFOCVAL;
+
+// watching for focus motion: wait for stop or seek target
+typedef struct{
+    uint8_t active;     // watching is on
+    uint8_t seek;       // seek target (else just wait for stop)
+    uint8_t reading;    // position reading is in queue
+    uint8_t moved;      // lens moved after last move command
+    uint8_t retarget;   // target changed after last move command
+    uint8_t tries;      // amount of move commands
+    uint8_t status;     // result (cq_status)
+    int32_t target;     // target position
+    int32_t lastpos;    // previous position
+    int32_t v;          // velocity, 1/256 steps per ms
+    uint32_t Tlast;     // time of previous position
+    uint32_t Tcmd;      // time of last move command
+    uint32_t Tstart;    // start of watching
+    uint32_t Tnext;     // time of next position reading
+} motion_t;
+
+static motion_t mot = {0};
+
+/**
+ * @brief cq_init - clear engine
+ * @param start - function to start SPI transaction
+ * @param abort - function to abort it
+ */
+void cq_init(cq_startfn start, cq_abortfn abort){
+    startfn = start;
+    abortfn = abort;
+    qhead = qlen = 0;
+    phase = PH_IDLE;
+    state = LENS_DISCONNECTED;
+    inistate = INI_ERR;
+    Fdelta = 0; Forig = Fmax = Fcur = BADFOCVAL;
+    memset(&mot, 0, sizeof(mot));
+    memset(&cq_stats, 0, sizeof(cq_stats));
+}
+
+static int canpush(){
+    return (state == LENS_SLEEPING || state == LENS_INITIALIZED || state == LENS_READY);
+}
+
+// remove head of queue and run its callback
+static void complete(cq_status st, uint32_t T){
+    cq_xfer x = queue[qhead];
+    qhead = QIDX(1);
+    --qlen;
+    cq_stats.depth = qlen;
+    phase = PH_IDLE;
+    x.status = st;
+    x.latency = T - x.Tq;
+    if(st == CQ_ERR) ++cq_stats.errors;
+    if(!(x.flags & CQ_F_INT) && st != CQ_FLUSHED){
+        cq_stats.latency = x.latency;
+        if(x.latency > cq_stats.latmax) cq_stats.latmax = x.latency;
+    }
+    if(st == CQ_OK && x.cmd == CANON_GETSTPPOS) Fcur = (int16_t)(((x.buf[1] << 8) | x.buf[2]) - Fdelta);
+    if(x.cb) x.cb(&x);
+}
+
+/**
+ * @brief cq_flush - throw away all commands (their callbacks get CQ_FLUSHED) and change state
+ * @param newstate - new lens state
+ */
+void cq_flush(lens_state newstate){
+    if(phase == PH_XFER || phase == PH_POLL){
+        if(abortfn) abortfn();
+    }
+    state = newstate;
+    inistate = INI_ERR;
+    mot.active = 0;
+    while(qlen) complete(CQ_FLUSHED, queue[qhead].Tq);
+    phase = PH_IDLE;
+}
+
+/**
+ * @brief cq_push - put transaction into queue
+ * @param data - command and data
+ * @param dlen - data length (rest of transaction is zeros)
+ * @param len - transaction length
+ * @param flags - CQ_F_*
+ * @param cb - completion callback (or NULL)
+ * @param T - current time
+ * @return 0 if OK, 1 if lens isn't ready, 2 if bad length, 3 if queue is full
+ */
+int cq_push(const uint8_t *data, uint8_t dlen, uint8_t len, uint8_t flags, cq_cb cb, uint32_t T){
+    if(!canpush()) return 1;
+    if(dlen < 1 || dlen > len || len > MAXCMDLEN) return 2;
+    if(qlen == CQ_QLEN){
+        ++cq_stats.overflows;
+        return 3;
+    }
+    cq_xfer *x = &queue[QIDX(qlen)];
+    memset(x->buf, 0, MAXCMDLEN);
+    memcpy(x->buf, data, dlen);
+    x->cmd = data[0];
+    x->len = len;
+    x->flags = flags;
+    x->status = CQ_OK;
+    x->cb = cb;
+    x->Tq = T;
+    x->latency = 0;
+    cq_stats.depth = ++qlen;
+    if(qlen > cq_stats.maxdepth) cq_stats.maxdepth = qlen;
+    return 0;
+}
+
+// simple command with busy polling
+int cq_cmd(uint8_t cmd, cq_cb cb, uint32_t T){
+    if((cmd == CANON_FMIN || cmd == CANON_FMAX || cmd == CANON_FSTOP) && mot.seek){ // user overrides seeking
+        mot.active = mot.seek = 0;
+    }
+    return cq_push(&cmd, 1, 2, CQ_F_POLL, cb, T);
+}
+
+// read `nbytes` of answer
+int cq_read(uint8_t cmd, uint8_t nbytes, cq_cb cb, uint32_t T){
+    return cq_push(&cmd, 1, nbytes + 1, CQ_F_READ, cb, T);
+}
+
+/**
+ * @brief cq_diaphragm - open/close diaphragm; merged with waiting diaphragm command if can
+ * @param steps - relative steps (-CQ_DIA_MAXSTEPS..CQ_DIA_MAXSTEPS, negative - open), CQ_DIA_OPEN or CQ_DIA_CLOSE
+ * @param cb - completion callback
+ * @param T - current time
+ * @return the same as cq_push()
+ */
+int cq_diaphragm(int16_t steps, cq_cb cb, uint32_t T){
+    int full = (steps == CQ_DIA_OPEN || steps == CQ_DIA_CLOSE);
+    if(!full && ABS(steps) > CQ_DIA_MAXSTEPS) return 2;
+    if(!canpush()) return 1;
+    // look for waiting diaphragm command with only reads after it
+    for(int i = qlen - 1; i >= (phase == PH_IDLE ? 0 : 1); --i){
+        cq_xfer *x = &queue[QIDX(i)];
+        if(x->flags & CQ_F_DIA){
+            int16_t old = (int8_t)x->buf[1], sum = steps;
+            if(!full){
+                if(old == CQ_DIA_OPEN || old == CQ_DIA_CLOSE) break; // can't add steps to full open/close
+                sum += old;
+                if(ABS(sum) > CQ_DIA_MAXSTEPS) break;
+            }
+            x->buf[1] = (uint8_t)sum;
+            if(cb) x->cb = cb;
+            ++cq_stats.coalesced;
+            return 0;
+        }
+        if(!(x->flags & CQ_F_READ)) break;
+    }
+    uint8_t d[4] = {CANON_DIAPHRAGM, (uint8_t)steps, 0, 0};
+    return cq_push(d, 2, 4, CQ_F_POLL | CQ_F_DIA, cb, T);
+}
+
+// start watching of focus motion
+static void watch(int seek, int32_t target, uint32_t T){
+    mot.active = 1;
+    mot.seek = seek;
+    mot.target = target;
+    mot.moved = 0;
+    mot.retarget = seek;
+    mot.tries = seek ? 0 : 1; // waiting for stop means that move command was sent
+    mot.status = CQ_OK;
+    mot.lastpos = BADFOCVAL;
+    mot.v = 0;
+    mot.Tcmd = mot.Tstart = mot.Tnext = T;
+}
+
+static void moveend(cq_status st, uint32_t T){
+    mot.active = 0;
+    mot.status = st;
+    if(!mot.seek) return;
+    mot.seek = 0;
+    cq_stats.seeklat = T - mot.Tstart;
+    cq_stats.seekmoves = mot.tries;
+    if(st != CQ_OK) ++cq_stats.errors;
+}
+
+static void movecb(const cq_xfer *x){
+    if(x->status == CQ_ERR && mot.active) moveend(CQ_ERR, x->Tq + x->latency);
+}
+
+static void move(int32_t steps, uint32_t T){
+    if(steps > 0x7fff) steps = 0x7fff;
+    else if(steps < -0x7fff) steps = -0x7fff;
+    uint8_t d[4] = {CANON_FOCMOVE, (uint8_t)(steps >> 8), (uint8_t)steps, 0};
+    if(cq_push(d, 3, 4, CQ_F_POLL | CQ_F_INT, movecb, T)) return; // queue is full: try on next position
+    ++mot.tries;
+    mot.moved = 0;
+    mot.Tcmd = T;
+}
+
+// next step of target seeking by new position
+static void seekstep(int32_t pos, int stopped, uint32_t T){
+    int32_t e = mot.target - pos;
+    if(mot.retarget){ // first move or target changed: aim from position lens will have when command reaches it
+        mot.retarget = 0;
+        e -= mot.v * (int32_t)(xferms + 1) / 256;
+        if(ABS(e) > CQ_FOCUS_TOL){
+            move(e, T);
+            return;
+        }
+    }
+    if(stopped){
+        if(ABS(e) <= CQ_FOCUS_TOL) moveend(CQ_OK, T);
+        else if(mot.tries >= CQ_SEEK_MAXTRY) moveend(CQ_ERR, T);
+        else move(e, T);
+    }
+}
+
+// new focus position got
+static void poscb(const cq_xfer *x){
+    uint32_t T = x->Tq + x->latency;
+    mot.reading = 0;
+    if(!mot.active || x->status == CQ_FLUSHED) return;
+    mot.Tnext = T + CQ_SEEK_INTERVAL;
+    if(T - mot.Tstart > CQ_SEEK_TIMEOUT){
+        moveend(CQ_ERR, T);
+        return;
+    }
+    if(x->status != CQ_OK){
+        if(state == LENS_INITIALIZED) ++inierr;
+        return;
+    }
+    int32_t pos = Fcur;
+    int stopped = 0;
+    if(mot.lastpos != BADFOCVAL && T != mot.Tlast){
+        mot.v = (pos - mot.lastpos) * 256 / (int32_t)(T - mot.Tlast);
+        if(pos != mot.lastpos) mot.moved = 1;
+        else if(mot.moved || mot.tries == 0 || T - mot.Tcmd >= MOVING_PAUSE) stopped = 1;
+    }
+    mot.lastpos = pos;
+    mot.Tlast = T;
+    if(mot.seek) seekstep(pos, stopped, T);
+    else if(stopped) moveend(CQ_OK, T);
+}
+
+// internal reading of focus position
+static int readpos(cq_cb cb, uint32_t T){
+    uint8_t d = CANON_GETSTPPOS;
+    return cq_push(&d, 1, 4, CQ_F_READ | CQ_F_INT, cb, T);
+}
+
+/**
+ * @brief cq_focus - seek focus to given position; if seeking is already running, only target is changed
+ * @param target - position, steps from minimal
+ * @param T - current time
+ * @return 0 if OK, 1 if lens isn't initialized, 2 if target is out of range
+ */
+int cq_focus(int32_t target, uint32_t T){
+    if(inistate != INI_READY || state != LENS_READY) return 1;
+    if(target < 0 || target > Fmax) return 2;
+    if(mot.active && mot.seek){
+        mot.target = target;
+        mot.retarget = 1;
+        mot.tries = 0;
+        mot.Tstart = T;
+        ++cq_stats.coalesced;
+        return 0;
+    }
+    watch(1, target, T);
+    return 0;
+}
+
+/**
+ * @brief cq_focusrel - relative focus move: from current target if seeking, or from current position;
+ *        without initialization just send relative move command
+ * @param delta - steps
+ * @param T - current time
+ * @return the same as cq_focus()
+ */
+int cq_focusrel(int32_t delta, uint32_t T){
+    if(inistate != INI_READY || Fcur == BADFOCVAL){
+        if(delta > 0x7fff || delta < -0x7fff) return 2;
+        uint8_t d[4] = {CANON_FOCMOVE, (uint8_t)(delta >> 8), (uint8_t)delta, 0};
+        return cq_push(d, 3, 4, CQ_F_POLL, NULL, T);
+    }
+    int32_t target = ((mot.active && mot.seek) ? mot.target : Fcur) + delta;
+    if(target < 0) target = 0;
+    else if(target > Fmax) target = Fmax;
+    return cq_focus(target, T);
+}
+
+// initialization commands: any error means that lens is bad
+static void inicb(const cq_xfer *x){
+    if(x->status == CQ_ERR) cq_flush(LENS_ERR);
+}
+
+static void origcb(const cq_xfer *x){
+    if(x->status == CQ_OK) Forig = Fcur;
+    else if(x->status == CQ_ERR) ++inierr;
+}
+
+/**
+ * @brief cq_lensinit - start initialization: turn on power, find focus range and return to original position
+ * @param T - current time
+ */
+void cq_lensinit(uint32_t T){
+    cq_flush(LENS_INITIALIZED);
+    inistate = INI_START;
+    inierr = 0;
+    Fdelta = 0; Forig = Fmax = Fcur = BADFOCVAL;
+    uint8_t d = CANON_ID;
+    cq_push(&d, 1, MAXCMDLEN, CQ_F_INT, inicb, T);
+    d = CANON_POWERON;
+    cq_push(&d, 1, 2, CQ_F_POLL | CQ_F_INT, inicb, T);
+}
+
+// lens works without initialization (manual operations only)
+void cq_manual(){
+    cq_flush(LENS_SLEEPING);
+}
+
+// next step of initialization (called when queue is empty and focus isn't moving)
+static void initstep(uint32_t T){
+    uint8_t d;
+    if(inierr > CQ_INI_MAXERR){
+        inierr = 0;
+        inistate = INI_ERR;
+    }
+    switch(inistate){
+        case INI_START: // get original position and go to min
+            if(Forig == BADFOCVAL){
+                readpos(origcb, T);
+                return;
+            }
+            d = CANON_FMIN;
+            cq_push(&d, 1, 2, CQ_F_POLL | CQ_F_INT, inicb, T);
+            watch(0, 0, T);
+            inistate = INI_FGOTOZ;
+        break;
+        case INI_FGOTOZ:
+            if(mot.status != CQ_OK){
+                ++inierr;
+                watch(0, 0, T);
+                return;
+            }
+            Fdelta = mot.lastpos; // F@0
+            Forig = (int16_t)(Forig - Fdelta);
+            Fcur = (int16_t)(Fcur - Fdelta);
+            inistate = INI_FPREPMAX;
+        break;
+        case INI_FPREPMAX:
+            d = CANON_FMAX;
+            cq_push(&d, 1, 2, CQ_F_POLL | CQ_F_INT, inicb, T);
+            watch(0, 0, T);
+            inistate = INI_FGOTOMAX;
+        break;
+        case INI_FGOTOMAX:
+            if(mot.status != CQ_OK){
+                ++inierr;
+                watch(0, 0, T);
+                return;
+            }
+            Fmax = mot.lastpos;
+            inistate = INI_FPREPOLD;
+        break;
+        case INI_FPREPOLD:
+            watch(1, Forig, T);
+            inistate = INI_FGOTOOLD;
+        break;
+        case INI_FGOTOOLD:
+            d = CANON_FOCBYHANDS;
+            cq_push(&d, 1, 2, CQ_F_POLL | CQ_F_INT, NULL, T);
+            inistate = INI_READY;
+            state = LENS_READY;
+        break;
+        default: // some error - change lens state to `ready` despite of errini
+            state = LENS_READY;
+    }
+}
+
+/**
+ * @brief cq_xferdone - SPI transaction is over
+ * @param T - current time
+ */
+void cq_xferdone(uint32_t T){
+    if(phase != PH_XFER && phase != PH_POLL) return;
+    ++cq_stats.xfers;
+    xferms = T - Txfer;
+    if(phase == PH_POLL){
+        if(pollbuf[1] == CANON_POLLANS) complete(CQ_OK, T);
+        else if(T - Tpoll > POLLING_TIMEOUT){ // lens don't answer: reinit it
+            complete(CQ_ERR, T);
+            cq_flush(LENS_ERR);
+        }else phase = PH_POLLNEXT;
+        return;
+    }
+    if(queue[qhead].flags & CQ_F_POLL){
+        phase = PH_POLLNEXT;
+        Tpoll = T;
+        return;
+    }
+    complete(CQ_OK, T);
+}
+
+// start next transaction if can
+static void startnext(uint32_t T){
+    if(phase == PH_POLLNEXT){
+        pollbuf[0] = CANON_POLL; pollbuf[1] = 0;
+        if(startfn(pollbuf, 2)){
+            phase = PH_POLL;
+            Txfer = T;
+        }
+        return;
+    }
+    if(!qlen) return;
+    cq_xfer *x = &queue[qhead];
+    if(startfn(x->buf, x->len)){
+        phase = PH_XFER;
+        Txfer = T;
+    }
+}
+
+/**
+ * @brief cq_proc - engine process: timeouts, next transaction, focus watching and initialization
+ * @param T - current time
+ */
+void cq_proc(uint32_t T){
+    if(phase == PH_XFER || phase == PH_POLL){
+        if(T - Txfer <= CQ_XFER_TIMEOUT) return;
+        if(abortfn) abortfn();
+        ++cq_stats.timeouts;
+        int polling = (phase == PH_POLL);
+        complete(CQ_ERR, T);
+        if(polling) cq_flush(LENS_ERR);
+        return;
+    }
+    if(!canpush()) return;
+    if(mot.active && !mot.reading && (int32_t)(T - mot.Tnext) >= 0){
+        if(0 == readpos(poscb, T)) mot.reading = 1;
+    }
+    if(phase == PH_POLLNEXT || qlen) startnext(T);
+    else if(state == LENS_INITIALIZED && !mot.active) initstep(T);
+}
+
+// ==1 if focus is moving to target
+int cq_seeking(){
+    return (mot.active && mot.seek);
+}
+
+int32_t cq_focpos(){
+    return Fcur;
+}
+
+int32_t cq_focmax(){
+    return Fmax;
+}
+
+lens_state cq_state(){
+    return state;
+}
+
+lensinit_state cq_inistate(){
+    return inistate;
+}
@@ -0,0 +1,117 @@
+/*
+ * This file is part of the canonmanage project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "canon.h"
+
+/*
+ * Hardware-independent lens engine: queue of SPI transactions with completion callbacks,
+ * busy polling, initialization sequence, target-seeking focus and diaphragm coalescing.
+ * Nothing here waits: hardware layer starts transaction by `cq_startfn` and reports its
+ * end by `cq_xferdone()`, all the rest is done in `cq_proc()`.
+ */
+
+// queue length (power of 2)
+#define CQ_QLEN             (8)
+// timeout of single SPI transaction, ms
+#define CQ_XFER_TIMEOUT     (50)
+// interval of focus position reading while waiting for motion end, ms
+#define CQ_SEEK_INTERVAL    (10)
+// max allowed focus error, steps
+#define CQ_FOCUS_TOL        (1)
+// max amount of focus moves for one target
+#define CQ_SEEK_MAXTRY      (5)
+// max time of focus seeking, ms
+#define CQ_SEEK_TIMEOUT     (10000)
+// max amount of errors in initialization
+#define CQ_INI_MAXERR       (8)
+
+// special diaphragm values: open or close fully
+#define CQ_DIA_OPEN         (-128)
+#define CQ_DIA_CLOSE        (127)
+// max relative diaphragm steps in one command
+#define CQ_DIA_MAXSTEPS     (126)
+
+// flags of transaction
+#define CQ_F_POLL           (1<<0)  // wait for lens ready (busy polling) after command
+#define CQ_F_READ           (1<<1)  // don't change lens state (could be passed over on coalescing)
+#define CQ_F_DIA            (1<<2)  // diaphragm command (could be coalesced)
+#define CQ_F_INT            (1<<3)  // internal transaction (not counted in latency statistics)
+
+typedef enum{
+    CQ_OK,              // done
+    CQ_ERR,             // SPI error, timeout or lens not ready after command
+    CQ_FLUSHED,         // thrown away without execution (disconnect or reinit)
+} cq_status;
+
+typedef struct cq_xfer cq_xfer;
+
+// completion callback, called from cq_proc() or cq_flush()
+typedef void (*cq_cb)(const cq_xfer *x);
+// start SPI transaction: send `len` bytes of `buf` and put answer into it; @return 0 if can't
+typedef int (*cq_startfn)(uint8_t *buf, uint8_t len);
+// abort current transaction
+typedef void (*cq_abortfn)();
+
+struct cq_xfer{
+    uint8_t buf[MAXCMDLEN]; // command data; lens answer after execution
+    uint8_t cmd;            // command code (buf[0] is replaced by answer)
+    uint8_t len;            // length of transaction
+    uint8_t flags;          // CQ_F_*
+    uint8_t status;         // cq_status
+    cq_cb cb;               // completion callback or NULL
+    uint32_t Tq;            // time of queueing
+    uint32_t latency;       // from queueing to completion (including busy polling), ms
+};
+
+typedef struct{
+    uint32_t xfers;         // SPI transactions done
+    uint32_t errors;        // commands failed
+    uint32_t timeouts;      // SPI transactions aborted by timeout
+    uint32_t coalesced;     // commands merged with waiting ones
+    uint32_t overflows;     // commands rejected: queue is full
+    uint32_t latency;       // latency of last user command, ms
+    uint32_t latmax;        // max latency
+    uint32_t seeklat;       // duration of last focus seeking, ms
+    uint32_t seekmoves;     // amount of moves in last seeking
+    uint16_t depth;         // current queue depth
+    uint16_t maxdepth;      // max queue depth
+} cq_stat;
+
+extern cq_stat cq_stats;
+
+void cq_init(cq_startfn start, cq_abortfn abort);
+void cq_flush(lens_state newstate);
+void cq_lensinit(uint32_t T);
+void cq_manual();
+void cq_xferdone(uint32_t T);
+void cq_proc(uint32_t T);
+int cq_push(const uint8_t *data, uint8_t dlen, uint8_t len, uint8_t flags, cq_cb cb, uint32_t T);
+int cq_cmd(uint8_t cmd, cq_cb cb, uint32_t T);
+int cq_read(uint8_t cmd, uint8_t nbytes, cq_cb cb, uint32_t T);
+int cq_diaphragm(int16_t steps, cq_cb cb, uint32_t T);
+int cq_focus(int32_t target, uint32_t T);
+int cq_focusrel(int32_t delta, uint32_t T);
+int cq_seeking();
+int32_t cq_focpos();
+int32_t cq_focmax();
+lens_state cq_state();
+lensinit_state cq_inistate();
@@ -0,0 +1,348 @@
+/*
+ * This file is part of the canonmanage project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host checker of lens engine (../canonq.c) with simulated lens: initialization, focus seeking
+// with retargeting, diaphragm coalescing, queue overflow and lens loss
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+#include "../canonq.h"
+
+#define TICKUS      (100)       // simulation step, us
+#define BYTEUS      (215)       // SPI byte with pause after it, us
+#define RAWBASE     (64000)     // raw focus counter at minimal position (wraps over 0xffff)
+#define DIAMAX      (80)        // max diaphragm steps
+
+// simulated lens
+static struct{
+    int alive;                  // answers to commands
+    int powered;
+    double pos;                 // focus position, steps from minimal
+    double target;              // where it moves
+    double speed;               // steps per ms
+    int startdelay;             // ticks before motion starts after command
+    int backlash;               // max error of stop position after long move, steps
+    int busy;                   // ticks of busy state
+    uint8_t lastcmd;
+    int dia;                    // diaphragm, steps from fully open
+    int fmax;                   // focus range
+} lens;
+
+// SPI transaction in progress
+static uint8_t *xbuf = NULL;
+static uint8_t xlen = 0;
+static uint32_t xend = 0;       // time of transaction end, us
+static uint32_t now = 0;        // us
+static uint32_t diaxfers = 0, cbcount = 0, cbbad = 0;
+static uint32_t Tms(){ return now / 1000; }
+
+static int startxfer(uint8_t *buf, uint8_t len){
+    if(xbuf) return 0;
+    xbuf = buf;
+    xlen = len;
+    xend = now + len * BYTEUS;
+    return 1;
+}
+
+static void abortxfer(){
+    xbuf = NULL;
+}
+
+// lens reaction to whole transaction
+static void lenscmd(uint8_t *buf, uint8_t len){
+    uint8_t cmd = buf[0], b1 = buf[1];
+    int16_t steps = (int16_t)((buf[1] << 8) | buf[2]);
+    for(int i = 0; i < len; ++i) buf[i] = lens.alive ? 0 : 0xff;
+    if(!lens.alive) return;
+    if(cmd == CANON_POLL){
+        if(len > 1) buf[1] = (lens.busy || !lens.powered) ? lens.lastcmd : CANON_POLLANS;
+        return;
+    }
+    if(cmd == CANON_GETSTPPOS){
+        uint16_t raw = (uint16_t)(RAWBASE + (int)(lens.pos + 0.5));
+        if(len > 2){ buf[1] = raw >> 8; buf[2] = raw & 0xff; }
+        return;
+    }
+    if(cmd == CANON_GETMODEL){
+        if(len > 2){ buf[1] = 0; buf[2] = 200; }
+        return;
+    }
+    lens.lastcmd = cmd;
+    if(cmd == CANON_POWERON){
+        lens.powered = 1;
+        lens.busy = 20;
+        return;
+    }
+    if(!lens.powered) return;
+    int blmax = abs(steps) / 10; // stop error grows with move length
+    if(blmax > lens.backlash) blmax = lens.backlash;
+    double bl = (double)(lrand48() % (2 * blmax + 1) - blmax);
+    switch(cmd){
+        case CANON_FMIN:
+            lens.target = 0.;
+        break;
+        case CANON_FMAX:
+            lens.target = lens.fmax;
+        break;
+        case CANON_FOCMOVE: // new move replaces current one
+            lens.target = lens.pos + steps + bl;
+        break;
+        case CANON_FSTOP:
+            lens.target = lens.pos;
+        break;
+        case CANON_DIAPHRAGM:{
+            int8_t d = (int8_t)b1;
+            int old = lens.dia;
+            if(d == CQ_DIA_OPEN) lens.dia = 0;
+            else if(d == CQ_DIA_CLOSE) lens.dia = DIAMAX;
+            else lens.dia += d;
+            if(lens.dia < 0) lens.dia = 0;
+            else if(lens.dia > DIAMAX) lens.dia = DIAMAX;
+            lens.busy = 20 + 30 * abs(lens.dia - old);
+            ++diaxfers;
+            return;
+        }
+        default:
+            break;
+    }
+    if(lens.target < 0.) lens.target = 0.;
+    else if(lens.target > lens.fmax) lens.target = lens.fmax;
+    lens.busy = 20;
+    lens.startdelay = 50;
+}
+
+static void tick(){
+    now += TICKUS;
+    if(lens.busy) --lens.busy;
+    if(lens.startdelay) --lens.startdelay;
+    else{
+        double d = lens.target - lens.pos, s = lens.speed * TICKUS / 1000.;
+        if(d > s) d = s;
+        else if(d < -s) d = -s;
+        lens.pos += d;
+    }
+    if(xbuf && (int32_t)(now - xend) >= 0){
+        uint8_t *b = xbuf;
+        xbuf = NULL;
+        lenscmd(b, xlen);
+        cq_xferdone(Tms());
+    }
+    cq_proc(Tms());
+}
+
+// run simulation while condition is true or till timeout (ms); @return 0 if timed out
+static int runwhile(int (*cond)(), uint32_t tmout){
+    uint32_t T0 = now;
+    while(cond()){
+        if(now - T0 > tmout * 1000) return 0;
+        tick();
+    }
+    return 1;
+}
+
+static void run(uint32_t ms){
+    uint32_t T0 = now;
+    while(now - T0 < ms * 1000) tick();
+}
+
+static int notready(){ return cq_state() == LENS_INITIALIZED; }
+static int seeking(){ return cq_seeking(); }
+static int queued(){ return cq_stats.depth != 0; }
+static int alive(){ return cq_state() != LENS_ERR; }
+
+static void modelcb(const cq_xfer *x){
+    ++cbcount;
+    if(x->status != CQ_OK || x->buf[2] != 200) ++cbbad;
+}
+
+static void anycb(const cq_xfer *x){
+    ++cbcount;
+    if(x->status != CQ_OK) ++cbbad;
+}
+
+static int chkinit(int Forig){
+    lens.pos = lens.target = Forig;
+    cq_lensinit(Tms());
+    uint32_t T0 = now;
+    int bad = !runwhile(notready, 30000);
+    printf("init: %u ms, state=%d, inistate=%d, Fmax=%d, F=%.0f\n", (now - T0) / 1000, cq_state(),
+           cq_inistate(), cq_focmax(), lens.pos);
+    bad |= (cq_state() != LENS_READY || cq_inistate() != INI_READY);
+    bad |= (abs(cq_focmax() - lens.fmax) > 1 + lens.backlash);
+    run(500);
+    bad |= (abs((int)(lens.pos + 0.5) - Forig) > CQ_FOCUS_TOL);
+    return chkfail("init", bad);
+}
+
+/**
+ * @brief chkseek - seek random targets, sometimes change target while moving
+ * @param N - amount of targets
+ * @param pretarget - probability of target change
+ */
+static int chkseek(int N, double pretarget){
+    int bad = 0, nre = 0;
+    uint32_t latsum = 0, latmax = 0, movesum = 0, coal = cq_stats.coalesced;
+    for(int i = 0; i < N; ++i){
+        int target = (int)(lrand48() % (lens.fmax + 1));
+        if(cq_focus(target, Tms())){ bad = 1; break; }
+        if(drand48() < pretarget){
+            run(1 + (uint32_t)(lrand48() % 100));
+            target = (int)(lrand48() % (lens.fmax + 1));
+            if(cq_focus(target, Tms())){ bad = 1; break; }
+            ++nre;
+        }
+        if(!runwhile(seeking, CQ_SEEK_TIMEOUT + 1000)){
+            printf("target %d: timeout\n", target);
+            bad = 1;
+            break;
+        }
+        run(200); // lens could still move if seeking ended badly
+        int err = abs((int)(lens.pos + 0.5) - target);
+        if(err > CQ_FOCUS_TOL){
+            if(verbose || !bad) printf("target %d: got %.1f (%u moves)\n", target, lens.pos, cq_stats.seekmoves);
+            bad = 1;
+        }
+        latsum += cq_stats.seeklat;
+        if(cq_stats.seeklat > latmax) latmax = cq_stats.seeklat;
+        movesum += cq_stats.seekmoves;
+    }
+    printf("%d targets (%d changed while moving, %u coalesced): seeking %.1f ms mean, %u ms max; %.2f moves per target\n",
+           N, nre, cq_stats.coalesced - coal, (double)latsum / N, latmax, (double)movesum / N);
+    return chkfail("seek", bad);
+}
+
+// burst of diaphragm commands: result should be the same as for sequential execution
+static int chkdia(int N){
+    int bad = 0, expect = 0;
+    cq_diaphragm(CQ_DIA_OPEN, anycb, Tms());
+    runwhile(queued, 5000);
+    uint32_t x0 = diaxfers, c0 = cq_stats.coalesced;
+    cbcount = cbbad = 0;
+    for(int i = 0; i < N; ++i){
+        int s = (lrand48() & 1) ? 1 : -1;
+        if(expect + s < 0 || expect + s > DIAMAX) s = -s; // stay in range: lens limits aren't coalesced
+        if(cq_diaphragm(s, anycb, Tms())){ bad = 1; break; }
+        expect += s;
+        run((uint32_t)(lrand48() % 3));
+    }
+    if(!runwhile(queued, 5000)) bad = 1;
+    printf("%d diaphragm commands: %u transactions, %u coalesced; diaphragm %d (expected %d)\n",
+           N, diaxfers - x0, cq_stats.coalesced - c0, lens.dia, expect);
+    bad |= (lens.dia != expect || cbbad);
+    // full close after steps and steps after full close
+    cq_diaphragm(-5, anycb, Tms());
+    cq_diaphragm(CQ_DIA_CLOSE, anycb, Tms());
+    cq_diaphragm(-3, anycb, Tms());
+    runwhile(queued, 5000);
+    bad |= (lens.dia != DIAMAX - 3);
+    return chkfail("diaphragm", bad);
+}
+
+static int chkqueue(){
+    int accepted = 0, rejected = 0;
+    uint32_t ovr = cq_stats.overflows;
+    cbcount = cbbad = 0;
+    for(int i = 0; i < 2 * CQ_QLEN; ++i){
+        if(cq_read(CANON_GETMODEL, 2, modelcb, Tms())) ++rejected;
+        else ++accepted;
+    }
+    runwhile(queued, 1000);
+    printf("%d reads: %d accepted, %d rejected, %u callbacks; max depth %u, latency %u ms (max %u)\n",
+           2 * CQ_QLEN, accepted, rejected, cbcount, cq_stats.maxdepth, cq_stats.latency, cq_stats.latmax);
+    int bad = (accepted != CQ_QLEN || (int)cbcount != accepted || cbbad || cq_stats.overflows - ovr != (uint32_t)rejected);
+    return chkfail("queue", bad);
+}
+
+// lens stops answering: waiting commands should be flushed and state should be LENS_ERR
+static int chkloss(){
+    cbcount = cbbad = 0;
+    lens.alive = 0;
+    cq_cmd(CANON_FMIN, anycb, Tms());
+    cq_read(CANON_GETMODEL, 2, anycb, Tms());
+    uint32_t T0 = now;
+    int bad = !runwhile(alive, POLLING_TIMEOUT + 1000);
+    printf("lens lost: error after %u ms, %u callbacks (%u not OK)\n", (now - T0) / 1000, cbcount, cbbad);
+    bad |= (cbcount != 2 || cbbad != 2 || cq_stats.depth);
+    return chkfail("loss", bad);
+}
+
+static void usage(const char *self){
+    fprintf(stderr, "Usage: %s [options]\n", self);
+    fprintf(stderr, "\t-n - amount of focus targets (default 200)\n");
+    fprintf(stderr, "\t-p - probability of target change while moving (default 0.3)\n");
+    fprintf(stderr, "\t-v - focus speed, steps per ms (default 4)\n");
+    fprintf(stderr, "\t-b - max error of lens stop position, steps (default 2)\n");
+    fprintf(stderr, "\t-f - focus range, steps (default 3000)\n");
+    fprintf(stderr, "\t-s - seed for random generator\n");
+    fprintf(stderr, "\t-d - print all failed targets\n");
+    exit(1);
+}
+
+int main(int argc, char **argv){
+    int opt, N = 200;
+    long seed = 1;
+    double pretarget = 0.3;
+    lens.speed = 4.; lens.backlash = 2; lens.fmax = 3000;
+    while((opt = getopt(argc, argv, "n:p:v:b:f:s:d")) != -1){
+        switch(opt){
+            case 'n':
+                N = atoi(optarg);
+                if(N < 1) usage(argv[0]);
+            break;
+            case 'p':
+                pretarget = atof(optarg);
+                if(pretarget < 0. || pretarget > 1.) usage(argv[0]);
+            break;
+            case 'v':
+                lens.speed = atof(optarg);
+                if(lens.speed <= 0.) usage(argv[0]);
+            break;
+            case 'b':
+                lens.backlash = atoi(optarg);
+                if(lens.backlash < 0) usage(argv[0]);
+            break;
+            case 'f':
+                lens.fmax = atoi(optarg);
+                if(lens.fmax < 10 || lens.fmax > 30000) usage(argv[0]);
+            break;
+            case 's':
+                seed = atol(optarg);
+            break;
+            case 'd':
+                verbose = 1;
+            break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    srand48(seed);
+    lens.alive = 1;
+    cq_init(startxfer, abortxfer);
+    int ret = chkinit(lens.fmax / 3);
+    if(!ret){
+        ret |= chkseek(N, pretarget);
+        ret |= chkdia(100);
+        ret |= chkqueue();
+        ret |= chkloss();
+    }
+    printf("%u transactions, %u errors, %u timeouts\n", cq_stats.xfers, cq_stats.errors, cq_stats.timeouts);
+    return hosttest_result(ret);
+}
@@ -45,15 +45,12 @@ int main(void){
         USBPU_ON();
     }else CAN_setup(the_conf.canspeed, the_conf.canID);
     spi_setup();
+    canon_setup();
 
-    uint32_t SPIctr = Tms;
     while(1){
         // TODO: add CAN bus parsing
         IWDG->KR = IWDG_REFRESH;
-        if(Tms - SPIctr > CANONPROC_INTERVAL){ // not more than once per 10ms
-            SPIctr = Tms;
-            canon_proc();
-        }
+        canon_proc();
         int l = USB_receivestr(inbuff, 255);
         if(l > 0) parse_cmd(inbuff); // call it even for NULL (if `flood` is running)
     }
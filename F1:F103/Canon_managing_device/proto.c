@@ -19,6 +19,7 @@
 #include <string.h>
 
 #include "canon.h"
+#include "canonq.h"
 #include "flash.h"
 #include "hardware.h"
 #include "proto.h"
@@ -41,6 +42,7 @@ const char* helpmsg =
     "h - turn on hand focus management\n"
     "i - get lens information\n"
     "l - get lens model\n"
+    "q - show commands' queue statistics\n"
     "r - get regulators' state\n"
     "\t\tdebugging/conf commands:\n"
     "A - set (!0) or reset (0) autoinit\n"
@@ -97,9 +99,25 @@ static void errw(int e){
         USB_sendstr("Error with code ");
         USB_sendstr(u2str(e));
         if(e == 1) USB_sendstr(" (busy or need initialization)");
+        else if(e == 3) USB_sendstr(" (queue is full)");
     }else USB_sendstr(OK);
 }
 
+static void showstat(){
+    USB_sendstr("depth="); USB_sendstr(u2str(cq_stats.depth));
+    USB_sendstr("\nmaxdepth="); USB_sendstr(u2str(cq_stats.maxdepth));
+    USB_sendstr("\nlatency="); USB_sendstr(u2str(cq_stats.latency));
+    USB_sendstr("\nlatmax="); USB_sendstr(u2str(cq_stats.latmax));
+    USB_sendstr("\nseeking="); USB_sendstr(u2str(cq_seeking()));
+    USB_sendstr("\nseeklat="); USB_sendstr(u2str(cq_stats.seeklat));
+    USB_sendstr("\nseekmoves="); USB_sendstr(u2str(cq_stats.seekmoves));
+    USB_sendstr("\ncoalesced="); USB_sendstr(u2str(cq_stats.coalesced));
+    USB_sendstr("\noverflows="); USB_sendstr(u2str(cq_stats.overflows));
+    USB_sendstr("\nxfers="); USB_sendstr(u2str(cq_stats.xfers));
+    USB_sendstr("\nerrors="); USB_sendstr(u2str(cq_stats.errors));
+    USB_sendstr("\ntimeouts="); USB_sendstr(u2str(cq_stats.timeouts));
+}
+
 const char *connmsgs[LENS_S_AMOUNT+1] = {
     [LENS_DISCONNECTED] = "disconnected",
     [LENS_SLEEPING] = "sleeping, need init",
@@ -158,6 +176,9 @@ void parse_cmd(const char *buf){
             case 'l':
                 errw(canon_asku16(CANON_GETMODEL));
             break;
+            case 'q':
+                showstat();
+            break;
             case 'r':
                 errw(canon_asku16(CANON_GETREG));
             break;
@@ -256,10 +277,7 @@ void parse_cmd(const char *buf){
             nxt = getnum(buf, &D);
             if(nxt == buf) USB_sendstr("Need number");
             else if(D > 0x7fff) USB_sendstr("From -0x7fff to 0x7fff");
-            else{
-                if(canon_writeu16(CANON_FOCMOVE, neg * (int16_t)D)) USB_sendstr(OK);
-                else USB_sendstr(FAIL);
-            }
+            else errw(canon_focusrel(neg * (int16_t)D));
         break;
         case 'C':
             nxt = getnum(buf, &D);
@@ -35,15 +35,76 @@ static void mymemcpy(uint8_t *dest, uint8_t *src, int len){
 uint32_t SPI_CR1 = SPI_CR1_MSTR | SPI_CR1_BR | SPI_CR1_SSM | SPI_CR1_SSI | SPI_CR1_CPHA | SPI_CR1_CPOL;
 
 spiStatus SPI_status = SPI_NOTREADY;
+// DMA transaction is over
+volatile uint8_t SPI_xferdone = 0;
+
+// SPI1 clock: APB2, MHz
+#define SPI_PCLK_MHZ    (72)
+
+// period of bytes in DMA transaction: byte time (rounded up) + 100us pause for lens, us
+static uint16_t byteperiod(){
+    uint32_t br = (SPI_CR1 & SPI_CR1_BR) >> 3;
+    return (uint16_t)((8 * (2 << br) + SPI_PCLK_MHZ - 1) / SPI_PCLK_MHZ + 100);
+}
 
 void spi_setup(){
+    SPI_xferabort();
     RCC->APB2ENR |= SPI_APB2; // Enable the peripheral clock SPI1
+    RCC->APB1ENR |= RCC_APB1ENR_TIM3EN;
+    RCC->AHBENR |= RCC_AHBENR_DMA1EN;
     // master, no slave select, BR=F/16, CPOL/CPHA - polarity.
     SPIx->CR1 = SPI_CR1;
+    // TIM3 update requests DMA1_Channel3 to put next byte into SPI1->DR,
+    // DMA1_Channel2 gets answer by RXNE
+    TIM3->PSC = 71; // 1MHz
+    TIM3->DIER = TIM_DIER_UDE;
+    DMA1_Channel2->CPAR = (uint32_t)&SPIx->DR;
+    DMA1_Channel3->CPAR = (uint32_t)&SPIx->DR;
+    NVIC_EnableIRQ(DMA1_Channel2_IRQn);
     SPI_status = SPI_READY;
     SPIx->CR1 |= SPI_CR1_SPE; // enable SPI
 }
 
+/**
+ * @brief SPI_xferstart - start DMA transaction (bytes paced by TIM3), SPI_xferdone will be set at its end
+ * @param buf - data to transmit, will be replaced by answer
+ * @param len - its length
+ * @return 0 if SPI is busy
+ */
+int SPI_xferstart(uint8_t *buf, uint8_t len){
+    if(!buf || !len || SPI_status != SPI_READY) return 0;
+    SPI_status = SPI_BUSY;
+    SPI_xferdone = 0;
+    (void)SPIx->DR; // clear RXNE
+    DMA1_Channel2->CMAR = (uint32_t)buf;
+    DMA1_Channel2->CNDTR = len;
+    DMA1_Channel2->CCR = DMA_CCR_MINC | DMA_CCR_TCIE | DMA_CCR_EN;
+    DMA1_Channel3->CMAR = (uint32_t)buf; // byte is sent before its answer overwrites it
+    DMA1_Channel3->CNDTR = len;
+    DMA1_Channel3->CCR = DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_EN;
+    SPIx->CR2 |= SPI_CR2_RXDMAEN;
+    TIM3->ARR = byteperiod() - 1;
+    TIM3->EGR = TIM_EGR_UG; // first byte right now
+    TIM3->CR1 = TIM_CR1_CEN;
+    return 1;
+}
+
+// stop DMA transaction
+void SPI_xferabort(){
+    TIM3->CR1 = 0;
+    DMA1_Channel2->CCR = 0;
+    DMA1_Channel3->CCR = 0;
+    SPIx->CR2 &= ~SPI_CR2_RXDMAEN;
+    if(SPI_status == SPI_BUSY) SPI_status = SPI_READY;
+}
+
+// last byte received
+void dma1_channel2_isr(){
+    DMA1->IFCR = DMA_IFCR_CGIF2;
+    SPI_xferabort();
+    SPI_xferdone = 1;
+}
+
 volatile uint32_t wctr;
 #define WAITX(x)  do{wctr = 0; while((x) && (++wctr < 360000)) IWDG->KR = IWDG_REFRESH; if(wctr==360000) return -1;}while(0)
 
@@ -31,8 +31,11 @@ typedef enum{
 } spiStatus;
 
 extern spiStatus SPI_status;
+extern volatile uint8_t SPI_xferdone;
 
 void spi_setup();
 uint8_t SPI_transmit(uint8_t *buf, uint8_t len);
+int SPI_xferstart(uint8_t *buf, uint8_t len);
+void SPI_xferabort();
 
 #endif // SPI_H__
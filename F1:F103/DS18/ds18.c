@@ -17,6 +17,7 @@
  */
 
 #include "ds18.h"
+#include "onewire.h"
 #include "proto.h"
 #include "usb.h"
 
@@ -46,9 +47,6 @@
 #define RESET_BARRIER     ((uint16_t)550)
 #define ONE_ZERO_BARRIER  ((uint16_t)10)
 
-// answer for polling: conversion done
-#define CONVERSION_DONE     (0xff)
-
 /*
  * thermometer commands
  * send them with bus reset!
@@ -110,6 +108,8 @@
 #define DS18_MEASUR_LEN     (800)
 // maximal received data bytes
 #define IMAXCTR             (10)
+// max time of conversion polling (ms)
+#define DS18_CONV_TMOUT     (1000)
 
 static uint8_t DS18ID[8] = {0}, matchID = 0;
 
@@ -126,6 +126,14 @@ static uint8_t CC2array[NmeasurementMax];
 static uint8_t receivectr = 0; // data bytes amount to receive
 // prepare buffers to sending
 #define OW_reset_buffer()   do{cc1buff_ctr = 0; receivectr = 0; totbytesctr = 0;}while(0)
+// value of bit read in slot `idx`
+#define OW_BIT(idx)         (CC2array[idx] < ONE_ZERO_BARRIER)
+
+// devices found by Search ROM and their last temperatures
+static DS18_dev devs[DS18_MAXDEV];
+static uint8_t ndevs = 0, curdev = 0;
+static ow_search search;
+static uint32_t curTms = 0, Tconv = 0; // current time and time of Convert T start
 
 // several devices on line
 void DS18_setID(const uint8_t ID[8]){
@@ -169,6 +177,28 @@ static uint8_t OW_add_byte(uint8_t ow_byte){
 	return 1;
 }
 
+// add one bit to send
+static uint8_t OW_add_bit(uint8_t bit){
+    if(cc1buff_ctr == NmeasurementMax){
+        DBG("Tim2 buffer overflow\n");
+        return 0;
+    }
+    CC1array[cc1buff_ctr++] = bit ? BIT_ONE_P : BIT_ZERO_P;
+    return 1;
+}
+
+// add N read slots (bit values are OW_BIT(idx))
+static uint8_t OW_add_readbits(uint8_t N){
+    for(uint8_t i = 0; i < N; ++i){
+        if(cc1buff_ctr == NmeasurementMax){
+            DBG("Tim2 buffer overflow\n");
+            return 0;
+        }
+        CC1array[cc1buff_ctr++] = BIT_READ_P;
+    }
+    return 1;
+}
+
 /**
  * Adds Nbytes bytes 0xff  for reading sequence
  */
@@ -248,20 +278,20 @@ static void DS18_getReg(int n){
     printsp(r, n);
 }
 
-static int chkCRC(const uint8_t data[9]){
-    uint8_t crc = 0;
-    for(int n = 0; n < 8; ++n){
-        crc = crc ^ data[n];
-           for(int i = 0; i < 8; i++){
-               if(crc & 1)
-                   crc = (crc >> 1) ^ 0x8C;
-               else
-                   crc >>= 1;
-           }
+// calculate T (*10) by scratchpad data
+static int32_t calcT(const uint8_t r[9]){
+    uint16_t l = r[0], m = r[1], v;
+    int32_t t;
+    if(r[4] == 0xff){ // DS18S20
+        t = ((uint32_t)l) * 10;
+        t >>= 1;
+    }else{ // DS18B20
+        v = ((m & 7) << 8)| l;
+        t = ((uint32_t)v)*10;
+        t >>= 4;
     }
-    //USB_send("got crc: "); printhex(crc); USB_send("\n");
-    if(data[8] == crc) return 0;
-    return 1;
+    if(m & 0x80) t = -t;
+    return t;
 }
 
 // data processing functions
@@ -286,44 +316,30 @@ static void DS18_gettemp(){ // calculate T
         USB_send("Target ID not found");
         return;
     }
-    if(chkCRC(r)){
+    if(ow_crc8(r, 9)){
         USB_send("CRC is wrong\n");
         return;
     }
-    uint16_t l = r[0], m = r[1], v;
-    int32_t t;
-    if(r[4] == 0xff){ // DS18S20
-        t = ((uint32_t)l) * 10;
-        t >>= 1;
-	}else{ // DS18B20
-        v = ((m & 7) << 8)| l;
-        t = ((uint32_t)v)*10;
-        t >>= 4;
-	}
-    if(m & 0x80) t = -t;
-    printT(t);
+    printT(calcT(r));
 }
 static void DS18_pollt(){ // poll T
-    uint8_t *r;
-    if((r = OW_readbuf()) && receivectr == 1){
-        if(*r == CONVERSION_DONE){
-            OW_reset_buffer();
-            if(matchID){ // add MATCH command & target ID
-                OW_add_byte(OW_MATCH_ROM);
-                for(int i = 0; i < 8; ++i)
-                    OW_add_byte(DS18ID[i]);
-            }else{
-                OW_add_byte(OW_SKIP_ROM);
-            }
-            OW_add_byte(OW_READ_SCRATCHPAD);
-            OW_add_read_seq(9);
-            ow_process_resdata = DS18_gettemp;
-            DS18_detect(); // reset
-            return;
+    if(cc1buff_ctr && OW_BIT(cc1buff_ctr - 1)){ // read slot gives 1 when conversion done
+        OW_reset_buffer();
+        if(matchID){ // add MATCH command & target ID
+            OW_add_byte(OW_MATCH_ROM);
+            for(int i = 0; i < 8; ++i)
+                OW_add_byte(DS18ID[i]);
+        }else{
+            OW_add_byte(OW_SKIP_ROM);
         }
+        OW_add_byte(OW_READ_SCRATCHPAD);
+        OW_add_read_seq(9);
+        ow_process_resdata = DS18_gettemp;
+        DS18_detect(); // reset
+        return;
     }
     OW_reset_buffer();
-    OW_add_read_seq(1); // send read seq waiting for end of conversion
+    OW_add_readbits(1); // send read slot waiting for end of conversion
     ow_process_resdata = DS18_pollt;
     dsstate = DS18_RDYTOSEND;
 }
@@ -408,6 +424,7 @@ static void DS18_stopmeas(){
 
 // processing, Tms - current time in milliseconds
 void DS18_process(uint32_t Tms){
+    curTms = Tms;
     switch(dsstate){
         case DS18_DETDONE:
             DBG("TIM1->CCR2="); DBG(u2str(TIM1->CCR2)); DBG("\n");
@@ -442,7 +459,7 @@ int DS18_start(){
     OW_reset_buffer();
     OW_add_byte(OW_SKIP_ROM);
 	OW_add_byte(OW_CONVERT_T);
-	OW_add_read_seq(1); // send read seq waiting for end of conversion
+	OW_add_readbits(1); // send read slot waiting for end of conversion
     DBG("start()\n");
     ow_process_resdata = DS18_pollt; // after data will be done calculate T and show it
     DS18_detect();
@@ -490,7 +507,152 @@ void tim1_up_isr(){
 
 void DS18_poll(){
     OW_reset_buffer();
-    OW_add_read_seq(1); // send read seq waiting for end of conversion
+    OW_add_readbits(1); // send read slot waiting for end of conversion
     ow_process_resdata = DS18_pollt;
     dsstate = DS18_RDYTOSEND;
 }
+
+/* Search ROM: each step is a separate transaction without bus reset: write direction bit
+ * of previous ROM bit and read next bit with its complement */
+static void DS18_searchstep();
+
+static void searchpass(){
+    if(!ows_next(&search)){
+        USB_send("Found "); USB_send(u2str(ndevs)); USB_send(" devices\n");
+        return;
+    }
+    OW_reset_buffer();
+    OW_add_byte(OW_SEARCH_ROM);
+    OW_add_readbits(2);
+    ow_process_resdata = DS18_searchstep;
+    DS18_detect();
+}
+
+static void DS18_searchstep(){
+    int dir = ows_step(&search, OW_BIT(cc1buff_ctr - 2), OW_BIT(cc1buff_ctr - 1));
+    if(dir < 0){
+        USB_send("No devices answered\n");
+        return;
+    }
+    if(ows_done(&search)){ // got full ROM, last direction bit isn't needed: bus would be reset
+        if(ow_crc8(search.rom, 8)){
+            USB_send("Search ROM: wrong CRC\n");
+            return;
+        }
+        if(ndevs < DS18_MAXDEV){
+            DS18_dev *d = &devs[ndevs++];
+            for(int i = 0; i < 8; ++i) d->ID[i] = search.rom[i];
+            d->valid = 0;
+        }else USB_send("Too many devices\n");
+        searchpass();
+        return;
+    }
+    OW_reset_buffer();
+    OW_add_bit((uint8_t)dir);
+    OW_add_readbits(2);
+    ow_process_resdata = DS18_searchstep;
+    dsstate = DS18_RDYTOSEND;
+}
+
+/**
+ * @brief DS18_search - find all devices on bus (Search ROM)
+ * @return 0 if busy
+ */
+int DS18_search(){
+    if(dsstate != DS18_SLEEP && dsstate != DS18_ERROR) return 0;
+    ndevs = 0;
+    ows_init(&search);
+    searchpass();
+    return 1;
+}
+
+// read scratchpad of next device from cache
+static void DS18_readnext();
+
+static void DS18_getone(){
+    uint8_t *r = OW_readbuf();
+    DS18_dev *d = &devs[curdev];
+    if(r && receivectr == 9 && !ow_crc8(r, 9)){
+        d->T = (int16_t)calcT(r);
+        d->Tmeas = curTms;
+        d->valid = 1;
+    }else d->valid = 0;
+    ++curdev;
+    DS18_readnext();
+}
+
+static void DS18_readnext(){
+    if(curdev >= ndevs){
+        DS18_list();
+        return;
+    }
+    OW_reset_buffer();
+    OW_add_byte(OW_MATCH_ROM);
+    for(int i = 0; i < 8; ++i) OW_add_byte(devs[curdev].ID[i]);
+    OW_add_byte(OW_READ_SCRATCHPAD);
+    OW_add_read_seq(9);
+    ow_process_resdata = DS18_getone;
+    DS18_detect();
+}
+
+static void DS18_pollall(){
+    if(OW_BIT(cc1buff_ctr - 1)){ // all devices are ready
+        curdev = 0;
+        DS18_readnext();
+        return;
+    }
+    if(curTms - Tconv > DS18_CONV_TMOUT){
+        USB_send("Conversion timeout\n");
+        dsstate = DS18_ERROR;
+        return;
+    }
+    OW_reset_buffer();
+    OW_add_readbits(1);
+    ow_process_resdata = DS18_pollall;
+    dsstate = DS18_RDYTOSEND;
+}
+
+/**
+ * @brief DS18_startall - broadcast Convert T and then read scratchpads of all found devices
+ * @return 0 if busy or there's no devices found
+ */
+int DS18_startall(){
+    if(dsstate != DS18_SLEEP && dsstate != DS18_ERROR) return 0;
+    if(!ndevs) return 0;
+    OW_reset_buffer();
+    OW_add_byte(OW_SKIP_ROM);
+    OW_add_byte(OW_CONVERT_T);
+    OW_add_readbits(1);
+    Tconv = curTms;
+    ow_process_resdata = DS18_pollall;
+    DS18_detect();
+    return 1;
+}
+
+// show found devices and their last temperatures
+void DS18_list(){
+    USB_send("Ndevs="); USB_send(u2str(ndevs)); USB_send("\n");
+    for(int i = 0; i < ndevs; ++i){
+        DS18_dev *d = &devs[i];
+        USB_send("Dev"); USB_send(u2str(i)); USB_send(":");
+        for(int j = 0; j < 8; ++j){
+            USB_send(" 0x");
+            printhex(d->ID[j]);
+        }
+        if(d->valid){
+            USB_send(", T="); USB_send(i2str(d->T));
+            USB_send(", age="); USB_send(u2str(curTms - d->Tmeas)); USB_send("ms");
+        }else USB_send(", T=?");
+        USB_send("\n");
+    }
+}
+
+/**
+ * @brief DS18_getdev - get cached data of device
+ * @param n - device index
+ * @return NULL if there's no such device
+ */
+const DS18_dev *DS18_getdev(int n){
+    if(n < 0 || n >= ndevs) return NULL;
+    return &devs[n];
+}
@@ -34,6 +34,17 @@ typedef enum{
     DS18_ERROR
 } DS18_state;
 
+// max amount of devices on bus
+#define DS18_MAXDEV     (32)
+
+// cache of device data
+typedef struct{
+    uint8_t ID[8];      // ROM
+    int16_t T;          // last temperature (*10)
+    uint8_t valid;      // ==1 if T is valid
+    uint32_t Tmeas;     // time of last measurement (ms)
+} DS18_dev;
+
 void DS18_pinsetup();
 int DS18_start();
 int DS18_readID();
@@ -45,5 +56,10 @@ void DS18_poll();
 void DS18_clearID();
 void DS18_setID(const uint8_t ID[8]);
 
+int DS18_search();
+int DS18_startall();
+void DS18_list();
+const DS18_dev *DS18_getdev(int n);
+
 #endif // DHT_H__
 
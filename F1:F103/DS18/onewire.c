@@ -0,0 +1,99 @@
+/*
+ * This file is part of the DS18 project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "onewire.h"
+
+// Dallas CRC-8 (x^8 + x^5 + x^4 + 1, reflected: 0x8C)
+static const uint8_t crctab[256] = {
+    0x00, 0x5e, 0xbc, 0xe2, 0x61, 0x3f, 0xdd, 0x83, 0xc2, 0x9c, 0x7e, 0x20, 0xa3, 0xfd, 0x1f, 0x41,
+    0x9d, 0xc3, 0x21, 0x7f, 0xfc, 0xa2, 0x40, 0x1e, 0x5f, 0x01, 0xe3, 0xbd, 0x3e, 0x60, 0x82, 0xdc,
+    0x23, 0x7d, 0x9f, 0xc1, 0x42, 0x1c, 0xfe, 0xa0, 0xe1, 0xbf, 0x5d, 0x03, 0x80, 0xde, 0x3c, 0x62,
+    0xbe, 0xe0, 0x02, 0x5c, 0xdf, 0x81, 0x63, 0x3d, 0x7c, 0x22, 0xc0, 0x9e, 0x1d, 0x43, 0xa1, 0xff,
+    0x46, 0x18, 0xfa, 0xa4, 0x27, 0x79, 0x9b, 0xc5, 0x84, 0xda, 0x38, 0x66, 0xe5, 0xbb, 0x59, 0x07,
+    0xdb, 0x85, 0x67, 0x39, 0xba, 0xe4, 0x06, 0x58, 0x19, 0x47, 0xa5, 0xfb, 0x78, 0x26, 0xc4, 0x9a,
+    0x65, 0x3b, 0xd9, 0x87, 0x04, 0x5a, 0xb8, 0xe6, 0xa7, 0xf9, 0x1b, 0x45, 0xc6, 0x98, 0x7a, 0x24,
+    0xf8, 0xa6, 0x44, 0x1a, 0x99, 0xc7, 0x25, 0x7b, 0x3a, 0x64, 0x86, 0xd8, 0x5b, 0x05, 0xe7, 0xb9,
+    0x8c, 0xd2, 0x30, 0x6e, 0xed, 0xb3, 0x51, 0x0f, 0x4e, 0x10, 0xf2, 0xac, 0x2f, 0x71, 0x93, 0xcd,
+    0x11, 0x4f, 0xad, 0xf3, 0x70, 0x2e, 0xcc, 0x92, 0xd3, 0x8d, 0x6f, 0x31, 0xb2, 0xec, 0x0e, 0x50,
+    0xaf, 0xf1, 0x13, 0x4d, 0xce, 0x90, 0x72, 0x2c, 0x6d, 0x33, 0xd1, 0x8f, 0x0c, 0x52, 0xb0, 0xee,
+    0x32, 0x6c, 0x8e, 0xd0, 0x53, 0x0d, 0xef, 0xb1, 0xf0, 0xae, 0x4c, 0x12, 0x91, 0xcf, 0x2d, 0x73,
+    0xca, 0x94, 0x76, 0x28, 0xab, 0xf5, 0x17, 0x49, 0x08, 0x56, 0xb4, 0xea, 0x69, 0x37, 0xd5, 0x8b,
+    0x57, 0x09, 0xeb, 0xb5, 0x36, 0x68, 0x8a, 0xd4, 0x95, 0xcb, 0x29, 0x77, 0xf4, 0xaa, 0x48, 0x16,
+    0xe9, 0xb7, 0x55, 0x0b, 0x88, 0xd6, 0x34, 0x6a, 0x2b, 0x75, 0x97, 0xc9, 0x4a, 0x14, 0xf6, 0xa8,
+    0x74, 0x2a, 0xc8, 0x96, 0x15, 0x4b, 0xa9, 0xf7, 0xb6, 0xe8, 0x0a, 0x54, 0xd7, 0x89, 0x6b, 0x35,
+};
+
+/**
+ * @brief ow_crc8 - calculate CRC-8 of data
+ * @param data - data
+ * @param len - its length
+ * @return CRC (==0 if data includes right CRC in last byte)
+ */
+uint8_t ow_crc8(const uint8_t *data, int len){
+    uint8_t crc = 0;
+    while(len-- > 0) crc = crctab[crc ^ *data++];
+    return crc;
+}
+
+// start new search
+void ows_init(ow_search *s){
+    for(int i = 0; i < 8; ++i) s->rom[i] = 0;
+    s->lastdisc = s->lastzero = s->lastdev = 0;
+    s->bitno = 65;
+}
+
+/**
+ * @brief ows_next - prepare next pass (call it after bus reset and SEARCH_ROM)
+ * @param s - search state
+ * @return 0 if all devices are found
+ */
+int ows_next(ow_search *s){
+    if(s->lastdev) return 0;
+    s->bitno = 1;
+    s->lastzero = 0;
+    return 1;
+}
+
+/**
+ * @brief ows_step - process next ROM bit
+ * @param s - search state
+ * @param bit - bit read from bus
+ * @param cmp - its complement read from bus
+ * @return direction bit to write or -1 if no devices answered (search state is cleared)
+ */
+int ows_step(ow_search *s, uint8_t bit, uint8_t cmp){
+    if(ows_done(s)) return -1;
+    if(bit && cmp){ // no devices
+        ows_init(s);
+        return -1;
+    }
+    uint8_t n = s->bitno, idx = (n - 1) >> 3, mask = 1 << ((n - 1) & 7), dir;
+    if(bit != cmp) dir = bit; // all devices have the same bit
+    else{ // discrepancy
+        if(n < s->lastdisc) dir = (s->rom[idx] & mask) ? 1 : 0; // go the same way as last time
+        else dir = (n == s->lastdisc); // on last discrepancy go to 1-branch, after it - 0
+        if(!dir) s->lastzero = n;
+    }
+    if(dir) s->rom[idx] |= mask;
+    else s->rom[idx] &= ~mask;
+    if(++s->bitno > 64){ // pass done
+        s->lastdisc = s->lastzero;
+        if(!s->lastdisc) s->lastdev = 1;
+    }
+    return dir;
+}
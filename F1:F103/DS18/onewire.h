@@ -0,0 +1,45 @@
+/*
+ * This file is part of the DS18 project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef ONEWIRE_H__
+#define ONEWIRE_H__
+
+#include <stdint.h>
+
+/*
+ * Hardware-independent 1-wire helpers: CRC-8 and Search ROM algorithm (Maxim AN187).
+ * Search is made by steps: after bus reset and SEARCH_ROM command for each of 64 ROM bits
+ * read bit and its complement, call ows_step() and write returned direction bit.
+ */
+
+typedef struct{
+    uint8_t rom[8];     // ROM of last found device
+    uint8_t lastdisc;   // bit number of last discrepancy (1..64, 0 - none)
+    uint8_t lastzero;   // last discrepancy where 0 was chosen in current pass
+    uint8_t lastdev;    // ==1 if last device was found
+    uint8_t bitno;      // number of current bit (1..64, 65 - pass done)
+} ow_search;
+
+uint8_t ow_crc8(const uint8_t *data, int len);
+void ows_init(ow_search *s);
+int ows_next(ow_search *s);
+int ows_step(ow_search *s, uint8_t bit, uint8_t cmp);
+// all 64 bits of current pass are done
+#define ows_done(s)     ((s)->bitno > 64)
+
+#endif // ONEWIRE_H__
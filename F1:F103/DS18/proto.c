@@ -154,9 +154,12 @@ char *getnum(const char *txt, uint32_t *N){
 }
 
 static const char *helpmesg =
+        "'A' - measure all found devices (broadcast Convert T)\n"
         "'C' - clear match ROM\n"
         "'D' - get DS18 state\n"
+        "'F' - find all devices on bus (Search ROM)\n"
         "'I' - get DS18 ID\n"
+        "'L' - list found devices and their last temperatures\n"
         "'M' - start measurement\n"
         "'P' - read scratchpad\n"
         "'S' - set match ROM (S 0xaa 0xbb... - 8 bytes of ID)\n"
@@ -191,6 +194,10 @@ static void setROM(const char *buf){
 const char *parse_cmd(const char *buf){
     if(buf[1] == '\n'){
         switch(*buf){
+            case 'A':
+                if(DS18_startall()) return "Started\n";
+                else return "Busy or no devices found\n";
+            break;
             case 'C':
                 DS18_clearID();
                 return "Don't send MATCH ROM\n";
@@ -213,9 +220,16 @@ const char *parse_cmd(const char *buf){
                         return "Not found\n";
                 }
             break;
+            case 'F':
+                if(DS18_search()) return "Searching..\n";
+                else return "Wait a little\n";
+            break;
             case 'I':
                 if(DS18_readID()) return "Reading ID..\n";
                 else return "Error\n";
+            case 'L':
+                DS18_list();
+            break;
             case 'M':
                 if(DS18_start()) return "Started\n";
                 else return "Wait a little\n";
@@ -0,0 +1,214 @@
+/*
+ * This file is part of the DS18 project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host checker of 1-wire Search ROM and CRC (../onewire.c) on simulated bus
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../onewire.h"
+
+#define MAXDEVS     256
+
+// simulated bus: wired AND of all devices still selected
+static uint8_t roms[MAXDEVS][8], active[MAXDEVS];
+static int ndevs = 0;
+static double noise = 0.; // probability of wrong bit read
+static long nslots = 0;   // amount of time slots used
+
+static int getbit(const uint8_t *rom, int n){ // n = 1..64
+    return (rom[(n - 1) >> 3] >> ((n - 1) & 7)) & 1;
+}
+
+// reset + SEARCH_ROM: all devices are selected
+static void bus_reset(){
+    for(int i = 0; i < ndevs; ++i) active[i] = 1;
+    nslots += 8 + 8; // reset ~ 8 slots, command byte
+}
+
+// read bit (or its complement) of selected devices
+static uint8_t bus_read(int n, int compl){
+    uint8_t v = 1;
+    for(int i = 0; i < ndevs; ++i)
+        if(active[i] && (getbit(roms[i], n) ^ compl) == 0) v = 0;
+    if(noise > 0. && drand48() < noise) v ^= 1;
+    ++nslots;
+    return v;
+}
+
+// write direction: devices with other bit value are deselected
+static void bus_write(int n, int dir){
+    for(int i = 0; i < ndevs; ++i)
+        if(active[i] && getbit(roms[i], n) != dir) active[i] = 0;
+    ++nslots;
+}
+
+// bitwise CRC (as was in ds18.c) to check table
+static uint8_t crc_bits(const uint8_t *data, int len){
+    uint8_t crc = 0;
+    for(int n = 0; n < len; ++n){
+        crc ^= data[n];
+        for(int i = 0; i < 8; i++){
+            if(crc & 1) crc = (crc >> 1) ^ 0x8C;
+            else crc >>= 1;
+        }
+    }
+    return crc;
+}
+
+static void genrom(uint8_t *rom, int similar){
+    rom[0] = 0x28; // DS18B20 family
+    for(int j = 1; j < 7; ++j) rom[j] = similar ? (j < 3 ? (uint8_t)lrand48() : 0) : (uint8_t)lrand48();
+    rom[7] = ow_crc8(rom, 7);
+}
+
+static int find(const uint8_t *rom){
+    for(int i = 0; i < ndevs; ++i) if(!memcmp(roms[i], rom, 8)) return i;
+    return -1;
+}
+
+/**
+ * @brief search - run full search
+ * @param found (o) - found flags of each device
+ * @param bad (o) - amount of wrong ROMs accepted (good CRC but no such device)
+ * @return amount of found devices or -1 if search failed
+ */
+static int search(uint8_t *found, int *bad){
+    ow_search s;
+    int n = 0;
+    memset(found, 0, MAXDEVS);
+    *bad = 0;
+    ows_init(&s);
+    while(1){
+        bus_reset();
+        if(!ows_next(&s)) break;
+        while(!ows_done(&s)){
+            int b = s.bitno;
+            uint8_t bit = bus_read(b, 0), cmp = bus_read(b, 1);
+            int dir = ows_step(&s, bit, cmp);
+            if(dir < 0) return -1;
+            if(!ows_done(&s)) bus_write(b, dir);
+        }
+        if(ow_crc8(s.rom, 8)) return -1; // firmware stops on wrong CRC
+        int idx = find(s.rom);
+        if(idx < 0){ ++*bad; continue; }
+        if(found[idx]) return -1; // the same device twice
+        found[idx] = 1;
+        ++n;
+        if(n > MAXDEVS) return -1;
+    }
+    return n;
+}
+
+static double dtime(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static void usage(const char *self){
+    fprintf(stderr, "Usage: %s [options]\n", self);
+    fprintf(stderr, "\t-n - amount of devices on bus (1..%d, default 20)\n", MAXDEVS);
+    fprintf(stderr, "\t-i - amount of random buses to check (default 1000)\n");
+    fprintf(stderr, "\t-S - devices with similar ROMs (long common parts)\n");
+    fprintf(stderr, "\t-e - probability of wrong bit read\n");
+    fprintf(stderr, "\t-s - seed for random generator\n");
+    fprintf(stderr, "\t-v - print found ROMs of first bus\n");
+    exit(1);
+}
+
+int main(int argc, char **argv){
+    int opt, niter = 1000, similar = 0, verbose = 0;
+    long seed = 1;
+    while((opt = getopt(argc, argv, "n:i:Se:s:v")) != -1){
+        switch(opt){
+            case 'n':
+                ndevs = atoi(optarg);
+                if(ndevs < 1 || ndevs > MAXDEVS) usage(argv[0]);
+            break;
+            case 'i':
+                niter = atoi(optarg);
+                if(niter < 1) usage(argv[0]);
+            break;
+            case 'S':
+                similar = 1;
+            break;
+            case 'e':
+                noise = atof(optarg);
+                if(noise < 0. || noise > 1.) usage(argv[0]);
+            break;
+            case 's':
+                seed = atol(optarg);
+            break;
+            case 'v':
+                verbose = 1;
+            break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if(!ndevs) ndevs = 20;
+    srand48(seed);
+    // check CRC table
+    uint8_t buf[64];
+    for(int i = 0; i < 10000; ++i){
+        int l = 1 + (int)(lrand48() % 64);
+        for(int j = 0; j < l; ++j) buf[j] = (uint8_t)lrand48();
+        if(ow_crc8(buf, l) != crc_bits(buf, l)){
+            printf("CRC table is wrong!\n");
+            return 2;
+        }
+    }
+    int failed = 0, missed = 0, wrong = 0, ret = 0;
+    nslots = 0;
+    for(int it = 0; it < niter; ++it){
+        for(int i = 0; i < ndevs; ++i){
+            do genrom(roms[i], similar); while(find(roms[i]) != i); // unique ROMs
+        }
+        uint8_t found[MAXDEVS];
+        int bad, n = search(found, &bad);
+        wrong += bad;
+        if(n < 0){ ++failed; continue; }
+        if(n != ndevs) missed += ndevs - n;
+        if(verbose && it == 0){
+            for(int i = 0; i < ndevs; ++i){
+                if(!found[i]) continue;
+                for(int j = 0; j < 8; ++j) printf(" 0x%02x", roms[i][j]);
+                printf("\n");
+            }
+        }
+    }
+    printf("%d buses with %d devices: %d searches failed, %d devices missed, %d wrong ROMs accepted\n",
+           niter, ndevs, failed, missed, wrong);
+    printf("%.1f time slots per device\n", (double)nslots / niter / ndevs);
+    if(noise == 0. && (failed || missed || wrong)) ret = 2;
+    if(noise > 0. && wrong) ret = 2;
+    // CRC speed
+    double t0 = dtime();
+    uint8_t c = 0;
+    for(int i = 0; i < 1000000; ++i){ buf[0] = (uint8_t)i; c ^= crc_bits(buf, 9); }
+    double t1 = dtime();
+    for(int i = 0; i < 1000000; ++i){ buf[0] = (uint8_t)i; c ^= ow_crc8(buf, 9); }
+    double t2 = dtime();
+    printf("CRC of scratchpad: bitwise %.1f ns, table %.1f ns (%u)\n", (t1 - t0) * 1e3, (t2 - t1) * 1e3, c);
+    printf("%s\n", ret ? "FAILED" : "OK");
+    return ret;
+}
@@ -17,9 +17,35 @@
  */
 
 #include "adc.h"
+#include "flash.h"
+#include "hardware.h"
 
 uint16_t ADC_array[ADC_CHANNELS*9];
 
+// double buffer of injected conversions: one is filled by ISR, another is ready for reading
+static volatile adc_block accbuf[2];
+static volatile uint8_t curbuf = 0, readybuf = 0, bufready = 0;
+volatile uint32_t adc_ntrig = 0;     // total amount of triggers
+volatile uint32_t adc_overruns = 0;  // amount of blocks lost because previous one wasn't read
+
+// TIM2 @1MHz - trigger of injected conversions (TRGO on update)
+static void tim2_setup(){
+    RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
+    TIM2->CR1 = 0;
+    TIM2->PSC = 71;
+    TIM2->CR2 = TIM_CR2_MMS_1;
+    adc_setrate(the_conf.adcrate);
+    TIM2->EGR = TIM_EGR_UG;
+    TIM2->CR1 = TIM_CR1_CEN;
+}
+
+// set frequency of injected triggers
+void adc_setrate(uint16_t hz){
+    if(hz < ADC_MINRATE) hz = ADC_MINRATE;
+    else if(hz > ADC_MAXRATE) hz = ADC_MAXRATE;
+    TIM2->ARR = 1000000 / hz - 1;
+}
+
 void adc_setup(){
     uint32_t ctr = 0;
     // Enable clocking
@@ -33,15 +59,18 @@ void adc_setup(){
     DMA1_Channel1->CCR = DMA_CCR_MINC | DMA_CCR_MSIZE_0 | DMA_CCR_PSIZE_0
                           | DMA_CCR_CIRC | DMA_CCR_PL | DMA_CCR_EN;
     RCC->CFGR = (RCC->CFGR & ~(RCC_CFGR_ADCPRE)) | RCC_CFGR_ADCPRE_DIV8; // ADC clock = RCC / 8
-    // sampling time - 239.5 cycles for channels 0, 16 and 17
-    ADC1->SMPR2 = ADC_SMPR2_SMP0;
+    // sampling time - 239.5 cycles for channels 0, 16 and 17; 41.5 cycles for channel 7 (AD0)
+    ADC1->SMPR2 = ADC_SMPR2_SMP0 | ADC_SMPR2_SMP7_2;
     ADC1->SMPR1 = ADC_SMPR1_SMP16 | ADC_SMPR1_SMP17;
     // sequence order: 7[0] -> 16[tsen] -> 17[vdd]
     ADC1->SQR3 = (7 << 0) | (16<<5) | (17 << 10);
     ADC1->SQR1 = (ADC_CHANNELS - 1) << 20; // amount of conversions
-    ADC1->CR1 = ADC_CR1_SCAN; // scan mode
-    // DMA, continuous mode; enable vref & Tsens; enable SWSTART as trigger
-    ADC1->CR2 = ADC_CR2_DMA | ADC_CR2_TSVREFE | ADC_CR2_CONT | ADC_CR2_EXTSEL | ADC_CR2_EXTTRIG;
+    // injected sequence: ADC_INJ_NCONV conversions of channel 7
+    ADC1->JSQR = ((ADC_INJ_NCONV - 1) << 20) | (7 << 0) | (7 << 5) | (7 << 10) | (7 << 15);
+    ADC1->CR1 = ADC_CR1_SCAN | ADC_CR1_JEOCIE; // scan mode, interrupt on injected end of conversion
+    // DMA, continuous mode; enable vref & Tsens; enable SWSTART as trigger; TIM2_TRGO for injected
+    ADC1->CR2 = ADC_CR2_DMA | ADC_CR2_TSVREFE | ADC_CR2_CONT | ADC_CR2_EXTSEL | ADC_CR2_EXTTRIG |
+                ADC_CR2_JEXTSEL_1 | ADC_CR2_JEXTTRIG;
     // wake up ADC
     ADC1->CR2 |= ADC_CR2_ADON;
     __DSB();
@@ -56,6 +85,41 @@ void adc_setup(){
     // clear possible errors and start
     ADC1->SR = 0;
     ADC1->CR2 |= ADC_CR2_SWSTART;
+    NVIC_EnableIRQ(ADC1_2_IRQn);
+    tim2_setup();
+}
+
+/**
+ * @brief adc_getblock - get next accumulated block of injected conversions
+ * @param b (o) - block
+ * @return 0 if there's no new data
+ */
+int adc_getblock(adc_block *b){
+    if(!bufready) return 0;
+    __disable_irq();
+    *b = *(adc_block*)&accbuf[readybuf];
+    bufready = 0;
+    __enable_irq();
+    return 1;
+}
+
+// injected conversions done: accumulate them
+void adc1_2_isr(){
+    if(!(ADC1->SR & ADC_SR_JEOC)) return;
+    ADC1->SR = ~(uint32_t)(ADC_SR_JEOC | ADC_SR_JSTRT); // rc_w0
+    uint32_t s = ADC1->JDR1 + ADC1->JDR2 + ADC1->JDR3 + ADC1->JDR4;
+    volatile adc_block *b = &accbuf[curbuf];
+    b->sum += s;
+    b->sumsq += s * s;
+    ++adc_ntrig;
+    if(++b->n < the_conf.ovrsmpl) return;
+    b->Tend = getus();
+    if(bufready) ++adc_overruns; // previous block wasn't read
+    readybuf = curbuf;
+    bufready = 1;
+    curbuf ^= 1;
+    b = &accbuf[curbuf];
+    b->sum = 0; b->sumsq = 0; b->n = 0;
 }
 
 
@@ -33,9 +33,27 @@ enum{
  */
 extern uint16_t ADC_array[];
 
+// amount of injected conversions of AD0 on each trigger
+#define ADC_INJ_NCONV   (4)
+// limits of triggers frequency, Hz
+#define ADC_MINRATE     (10)
+#define ADC_MAXRATE     (5000)
+
+// accumulated injected conversions
+typedef struct{
+    uint64_t sumsq;     // sum of squares of trigger sums
+    uint32_t sum;       // sum of trigger sums (ADC_INJ_NCONV conversions each)
+    uint32_t n;         // amount of triggers
+    uint32_t Tend;      // time of last trigger, us
+} adc_block;
+
+extern volatile uint32_t adc_ntrig, adc_overruns;
+
 void adc_setup();
 int32_t getMCUtemp();
 uint32_t getVdd();
 uint16_t getADCval(int nch);
 uint32_t getADCvoltage(int nch);
+void adc_setrate(uint16_t hz);
+int adc_getblock(adc_block *b);
 
@@ -0,0 +1,186 @@
+/*
+ * This file is part of the hallinear project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host checker of calibration and statistics (../hallcal.c): fit of synthetic nonlinear
+// sensor curve, rejection of bad point sets, integer mean/RMS against double calculation
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+#include "../hallcal.h"
+
+#define XMAX        20000   // full stroke, um
+
+static double gauss(){
+    return sqrt(-2. * log(drand48() + 1e-12)) * cos(2. * M_PI * drand48());
+}
+
+// synthetic sensor: voltage (uV) by position (um), saturates at ends
+static double sensor(double X){
+    return 1650000. + 1200000. * tanh((X - XMAX / 2.) / 9000.);
+}
+
+static double isensor(double V){
+    return XMAX / 2. + 9000. * atanh((V - 1650000.) / 1200000.);
+}
+
+static int chksqrt(){
+    int bad = 0;
+    for(int i = 0; i < 1000000; ++i){
+        uint64_t x = (i < 1000) ? (uint64_t)i : ((uint64_t)lrand48() << 31 | (uint64_t)lrand48()) >> (lrand48() % 62);
+        uint64_t r = hc_isqrt(x);
+        if(r * r > x || (r + 1) * (r + 1) <= x){
+            if(!bad) printf("isqrt(%llu)=%llu\n", (unsigned long long)x, (unsigned long long)r);
+            bad = 1;
+        }
+    }
+    return chkfail("isqrt", bad);
+}
+
+// compare with double calculations on random blocks of noisy samples
+static int chkmeanrms(double sigma){
+    int bad = 0;
+    for(int iter = 0; iter < 1000; ++iter){
+        uint32_t n = 1 + (uint32_t)(lrand48() % 1024), k = 4, sum = 0;
+        uint64_t sumsq = 0;
+        double level = 10. + drand48() * 4075., dsum = 0., dsq = 0.;
+        for(uint32_t i = 0; i < n; ++i){
+            uint32_t v = 0;
+            for(uint32_t j = 0; j < k; ++j){
+                double s = level + sigma * gauss();
+                if(s < 0.) s = 0.;
+                else if(s > 4095.) s = 4095.;
+                v += (uint32_t)lround(s);
+            }
+            sum += v; sumsq += (uint64_t)v * v;
+            dsum += v; dsq += (double)v * v;
+        }
+        uint32_t mean, rms;
+        hc_meanrms(sum, sumsq, n, k, &mean, &rms);
+        double dmean = dsum / n / k * 16., dvar = dsq / n - (dsum / n) * (dsum / n);
+        double drms = (dvar > 0.) ? sqrt(dvar) / k * 16. : 0.;
+        if(fabs(mean - dmean) > 0.5 || fabs(rms - drms) > 1.){
+            if(!bad) printf("n=%u: mean=%u (%g), rms=%u (%g)\n", n, mean, dmean, rms, drms);
+            bad = 1;
+        }
+    }
+    return chkfail("meanrms", bad);
+}
+
+// errors of bad point sets
+static int chkreject(){
+    hc_lut l;
+    int32_t e;
+    hc_point one[] = {{1000, 10}, {1000, 20}};
+    hc_point nm[] = {{1000, 10}, {2000, 30}, {3000, 20}};
+    hc_point dec[] = {{3000, 10}, {1000, 30}, {2000, 20}};
+    int bad = (HC_TOOFEW != hc_fit(one, 2, &l, &e));
+    bad |= (HC_TOOFEW != hc_fit(one, 1, &l, &e));
+    bad |= (HC_NONMONOTONIC != hc_fit(nm, 3, &l, &e));
+    // decreasing function is OK, points are sorted
+    bad |= (HC_OK != hc_fit(dec, 3, &l, &e) || l.n != 3 || e != 0 || l.V[0] != 1000 || l.X[0] != 30);
+    return chkfail("reject", bad);
+}
+
+// interpolation and extrapolation on straight segments
+static int chkinterp(){
+    hc_lut l = {.n = 3, .V = {1000, 2000, 4000}, .X = {0, 100, 50}};
+    int bad = (hc_interp(&l, 1500) != 50) || (hc_interp(&l, 3000) != 75) || (hc_interp(&l, 2000) != 100);
+    bad |= (hc_interp(&l, 0) != -100) || (hc_interp(&l, 6000) != 0) || (hc_interp(&l, 1000) != 0);
+    l.n = 2; l.V[1] = 2000000000; l.X[1] = 2000000000;
+    bad |= (hc_interp(&l, 1000000000) != 999999499);
+    return chkfail("interp", bad);
+}
+
+/**
+ * @brief chkfit - fit of noisy points of synthetic sensor
+ * @param npts - amount of calibration points
+ * @param noise - voltage noise, uV
+ * @param tol - max allowed deviation from true curve, um
+ */
+static int chkfit(int npts, double noise, double tol){
+    hc_point pts[HC_MAXPTS];
+    hc_lut l;
+    int32_t maxerr;
+    for(int i = 0; i < npts; ++i){ // random order of points, as operator could set them
+        double X = XMAX * (double)((i * 7) % npts) / (npts - 1);
+        pts[i].X = (int32_t)X;
+        pts[i].V = (int32_t)lround(sensor(X) + noise * gauss());
+    }
+    hc_err r = hc_fit(pts, npts, &l, &maxerr);
+    if(r != HC_OK) return chkfail("fit", 1);
+    printf("%d points, noise %g uV: %u knots, max deviation of points %d um\n", npts, noise, l.n, maxerr);
+    double emax = 0.;
+    for(double X = 0.; X <= XMAX; X += 1.){
+        double e = fabs(hc_interp(&l, (int32_t)lround(sensor(X))) - isensor(lround(sensor(X))));
+        if(e > emax) emax = e;
+    }
+    printf("max error over stroke: %.1f um\n", emax);
+    return chkfail("fit", emax > tol);
+}
+
+static void usage(const char *self){
+    fprintf(stderr, "Usage: %s [options]\n", self);
+    fprintf(stderr, "\t-n - amount of calibration points (2..%d, default %d)\n", HC_MAXPTS, HC_MAXPTS);
+    fprintf(stderr, "\t-v - voltage noise of calibration points, uV (default 100)\n");
+    fprintf(stderr, "\t-a - ADC noise for mean/RMS check, LSB (default 3)\n");
+    fprintf(stderr, "\t-e - max allowed position error, um (default 100)\n");
+    fprintf(stderr, "\t-s - seed for random generator\n");
+    exit(1);
+}
+
+int main(int argc, char **argv){
+    int opt, npts = HC_MAXPTS;
+    long seed = 1;
+    double vnoise = 100., anoise = 3., tol = 100.;
+    while((opt = getopt(argc, argv, "n:v:a:e:s:")) != -1){
+        switch(opt){
+            case 'n':
+                npts = atoi(optarg);
+                if(npts < 2 || npts > HC_MAXPTS) usage(argv[0]);
+            break;
+            case 'v':
+                vnoise = atof(optarg);
+                if(vnoise < 0.) usage(argv[0]);
+            break;
+            case 'a':
+                anoise = atof(optarg);
+                if(anoise < 0.) usage(argv[0]);
+            break;
+            case 'e':
+                tol = atof(optarg);
+                if(tol <= 0.) usage(argv[0]);
+            break;
+            case 's':
+                seed = atol(optarg);
+            break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    srand48(seed);
+    int ret = chksqrt();
+    ret |= chkmeanrms(anoise);
+    ret |= chkreject();
+    ret |= chkinterp();
+    ret |= chkfit(npts, vnoise, tol);
+    return hosttest_result(ret);
+}
@@ -20,6 +20,7 @@
 #include "can.h"
 #include "canproto.h"
 #include "flash.h"
+#include "hallpos.h"
 #include "hardware.h"
 #include "strfunc.h"
 
@@ -126,6 +127,59 @@ static errcodes u32setget(CAN_message *msg){
     MSGP_SET_U32(msg, *ptr);
     return ERR_OK;
 }
+// position engine data getters
+static errcodes posget(CAN_message *msg){
+    uint16_t cmd = *(uint16_t*)msg->data;
+    uint32_t val;
+    switch(cmd){
+        case CMD_POSITION:
+            val = (uint32_t)hallpos.X;
+        break;
+        case CMD_VOLTAGE:
+            val = (uint32_t)hallpos.V;
+        break;
+        case CMD_NOISE:
+            val = hallpos.rmsuV;
+        break;
+        case CMD_LATENCY:
+            val = hallstat.delay + hallpos.latency;
+        break;
+        case CMD_TRIGRATE:
+            val = hallstat.trigrate;
+        break;
+        default:
+            return ERR_CANTRUN;
+    }
+    FIXDL(msg);
+    MSGP_SET_U32(msg, val);
+    return ERR_OK;
+}
+
+// common uint16_t setter/getter
+static errcodes u16setget(CAN_message *msg){
+    uint16_t cmd = *(uint16_t*)msg->data;
+    uint16_t *ptr = NULL;
+    switch(cmd){
+        case CMD_ADCRATE:
+            ptr = &the_conf.adcrate;
+        break;
+        case CMD_OVRSMPL:
+            ptr = &the_conf.ovrsmpl;
+        break;
+        case CMD_CANRATE:
+            ptr = &the_conf.canrate;
+        break;
+        default: break;
+    }
+    if(!ptr) return ERR_CANTRUN;
+    if(ISSETTER(msg->data)){
+        *ptr = (uint16_t)MSGP_GET_U32(msg);
+        if(cmd == CMD_ADCRATE) adc_setrate(*ptr);
+    }
+    FIXDL(msg);
+    MSGP_SET_U32(msg, *ptr);
+    return ERR_OK;
+}
 /************ END of all common functions list (for `funclist`) ************/
 
 typedef struct{
@@ -152,6 +206,14 @@ static const commonfunction funclist[CMD_AMOUNT] = {
     [CMD_MUL] = {u32setget, 1, 1>>20, 0},
     [CMD_SAVECONF] = {saveconf, 0, 0, 0},
     [CMD_ERASESTOR] = {erasestor, 0, 0, 0},
+    [CMD_POSITION] = {posget, 0, 0, 0},
+    [CMD_VOLTAGE] = {posget, 0, 0, 0},
+    [CMD_NOISE] = {posget, 0, 0, 0},
+    [CMD_LATENCY] = {posget, 0, 0, 0},
+    [CMD_TRIGRATE] = {posget, 0, 0, 0},
+    [CMD_ADCRATE] = {u16setget, ADC_MINRATE, ADC_MAXRATE, 0},
+    [CMD_OVRSMPL] = {u16setget, 1, HALL_MAXOVRSMPL, 0},
+    [CMD_CANRATE] = {u16setget, 0, 10000, 0},
 };
 
 
@@ -79,6 +79,14 @@ enum{
     CMD_MUL,        // get/set Mul
     CMD_SAVECONF,   // save configuration
     CMD_ERASESTOR,  // erase all flash storage
+    CMD_POSITION,   // position by calibration curve (um), also sent each `canrate` ms
+    CMD_VOLTAGE,    // averaged voltage (uV)
+    CMD_NOISE,      // RMS noise (uV)
+    CMD_LATENCY,    // latency: group delay of averaging + processing (us)
+    CMD_TRIGRATE,   // measured frequency of ADC triggers (Hz)
+    CMD_ADCRATE,    // get/set frequency of ADC triggers (Hz)
+    CMD_OVRSMPL,    // get/set amount of triggers per position
+    CMD_CANRATE,    // get/set period of position publishing (ms, 0 - off)
     // should be the last:
     CMD_AMOUNT     // amount of CAN commands
 };
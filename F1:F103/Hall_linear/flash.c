@@ -43,6 +43,9 @@ static uint32_t maxCnum = 1024 / sizeof(user_conf); // can't use blocksize here
     ,.canID = 1                         \
     ,.Div = 1                           \
     ,.Mul = 1                           \
+    ,.adcrate = 1000                    \
+    ,.ovrsmpl = 16                      \
+    ,.canrate = 100                     \
     }
 
 static int write2flash(const void*, const void*, uint32_t);
@@ -219,5 +222,9 @@ void dump_userconf(){
     USB_sendstr("\nCAN_ID="); printu(the_conf.canID);
     USB_sendstr("\nDiv="); printu(the_conf.Div);
     USB_sendstr("\nMul="); printu(the_conf.Mul);
+    USB_sendstr("\nADCrate="); printu(the_conf.adcrate);
+    USB_sendstr("\novrsmpl="); printu(the_conf.ovrsmpl);
+    USB_sendstr("\nCANrate="); printu(the_conf.canrate);
+    USB_sendstr("\nLUTn="); printu(the_conf.lut.n);
     newline();
 }
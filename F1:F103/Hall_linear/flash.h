@@ -20,6 +20,8 @@
 
 #include <stm32f1.h>
 
+#include "hallcal.h"
+
 #define FLASH_SIZE_REG      ((uint32_t)0x1FFFF7E0)
 #define FLASH_SIZE          *((uint16_t*)FLASH_SIZE_REG)
 
@@ -32,6 +34,11 @@ typedef struct __attribute__((packed, aligned(4))){
     uint32_t canspeed;          // CAN bus speed
     uint32_t Div;               // ADC val = (Raw * Mul) / Div
     uint32_t Mul;               // should be less than 2^20!!!
+    uint16_t adcrate;           // frequency of injected ADC triggers, Hz
+    uint16_t ovrsmpl;           // amount of triggers (4 conversions each) in one position sample
+    uint16_t canrate;           // period of position publishing over CAN, ms (0 - don't send)
+    uint16_t reserved;          // to align `lut`
+    hc_lut lut;                 // calibration curve: voltage -> position
 } user_conf;
 
 extern user_conf the_conf;
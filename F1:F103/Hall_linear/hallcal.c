@@ -0,0 +1,148 @@
+/*
+ * This file is part of the hallinear project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hallcal.h"
+
+// integer square root
+uint32_t hc_isqrt(uint64_t x){
+    uint64_t r = 0, bit = (uint64_t)1 << 62;
+    while(bit > x) bit >>= 2;
+    while(bit){
+        if(x >= r + bit){
+            x -= r + bit;
+            r = (r >> 1) + bit;
+        }else r >>= 1;
+        bit >>= 2;
+    }
+    return (uint32_t)r;
+}
+
+/**
+ * @brief hc_meanrms - mean and RMS of accumulated values
+ * @param sum - sum of `n` values, each is a sum of `k` ADC samples
+ * @param sumsq - sum of their squares
+ * @param n - amount of values
+ * @param k - amount of samples in each value
+ * @param mean (o) - mean of ADC sample, 1/16 LSB
+ * @param rms (o) - RMS of k-averaged value, 1/16 LSB
+ */
+void hc_meanrms(uint32_t sum, uint64_t sumsq, uint32_t n, uint32_t k, uint32_t *mean, uint32_t *rms){
+    if(!n || !k){
+        *mean = *rms = 0;
+        return;
+    }
+    *mean = (uint32_t)(((uint64_t)sum * 16 + n * k / 2) / (n * k));
+    uint64_t s2 = (uint64_t)sum * sum, ns = sumsq * n;
+    uint64_t var = (ns > s2) ? ns - s2 : 0; // var * n^2
+    *rms = (uint32_t)(((uint64_t)hc_isqrt(var * 256) + n * k / 2) / (n * k));
+}
+
+/**
+ * @brief hc_interp - convert voltage to position by piecewise-linear curve
+ *        (end segments are extrapolated)
+ * @param l - LUT (l->n should be >= 2)
+ * @param V - voltage, uV
+ * @return position, um
+ */
+int32_t hc_interp(const hc_lut *l, int32_t V){
+    int lo = 0, hi = l->n - 1;
+    while(hi - lo > 1){ // find segment [lo, hi] for V
+        int mid = (lo + hi) / 2;
+        if(V < l->V[mid]) hi = mid;
+        else lo = mid;
+    }
+    int64_t dV = l->V[hi] - l->V[lo];
+    if(dV == 0) return l->X[lo];
+    return l->X[lo] + (int32_t)(((int64_t)(V - l->V[lo]) * (l->X[hi] - l->X[lo])) / dV);
+}
+
+// max deviation of points from LUT, @return index of worst point
+static int worst(const hc_point *pts, int n, const hc_lut *l, int32_t *maxerr){
+    int idx = 0;
+    int32_t m = -1;
+    for(int i = 0; i < n; ++i){
+        int32_t e = hc_interp(l, pts[i].V) - pts[i].X;
+        if(e < 0) e = -e;
+        if(e > m){ m = e; idx = i; }
+    }
+    *maxerr = m;
+    return idx;
+}
+
+/**
+ * @brief hc_fit - build LUT by calibration points: sort them, average points with same voltage,
+ *        then (if there's more than HC_LUTMAX) choose knots by max deviation
+ * @param pts (io) - points (will be sorted and merged)
+ * @param n - their amount
+ * @param l (o) - LUT
+ * @param maxerr (o) - max deviation of points from LUT, um
+ * @return error code
+ */
+hc_err hc_fit(hc_point *pts, int n, hc_lut *l, int32_t *maxerr){
+    *maxerr = 0;
+    if(n < 2) return HC_TOOFEW;
+    for(int i = 1; i < n; ++i){ // insertion sort by voltage
+        hc_point p = pts[i];
+        int j = i - 1;
+        for(; j >= 0 && pts[j].V > p.V; --j) pts[j + 1] = pts[j];
+        pts[j + 1] = p;
+    }
+    int m = 0;
+    for(int i = 0; i < n;){ // merge points with same voltage
+        int j = i;
+        int64_t X = 0;
+        for(; j < n && pts[j].V == pts[i].V; ++j) X += pts[j].X;
+        pts[m].V = pts[i].V;
+        pts[m].X = (int32_t)(X / (j - i));
+        ++m;
+        i = j;
+    }
+    if(m < 2) return HC_TOOFEW;
+    int dir = (pts[1].X > pts[0].X) ? 1 : -1;
+    for(int i = 1; i < m; ++i){
+        int32_t d = pts[i].X - pts[i - 1].X;
+        if(d == 0 || (d > 0) != (dir > 0)) return HC_NONMONOTONIC;
+    }
+    l->n = 0;
+    if(m <= HC_LUTMAX){
+        for(int i = 0; i < m; ++i){
+            l->V[i] = pts[i].V;
+            l->X[i] = pts[i].X;
+        }
+        l->n = (uint16_t)m;
+        return HC_OK;
+    }
+    // start from end points and add the worst point while there's place
+    l->V[0] = pts[0].V; l->X[0] = pts[0].X;
+    l->V[1] = pts[m - 1].V; l->X[1] = pts[m - 1].X;
+    l->n = 2;
+    while(l->n < HC_LUTMAX){
+        int idx = worst(pts, m, l, maxerr);
+        if(*maxerr == 0) break;
+        int k = l->n;
+        for(; k > 0 && l->V[k - 1] > pts[idx].V; --k){ // insert knot
+            l->V[k] = l->V[k - 1];
+            l->X[k] = l->X[k - 1];
+        }
+        l->V[k] = pts[idx].V;
+        l->X[k] = pts[idx].X;
+        ++l->n;
+    }
+    worst(pts, m, l, maxerr);
+    return HC_OK;
+}
@@ -0,0 +1,53 @@
+/*
+ * This file is part of the hallinear project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Hardware-independent part of position engine: statistics of accumulated ADC data
+ * and piecewise-linear calibration curve (voltage -> position).
+ */
+
+// max amount of LUT knots (stored in flash)
+#define HC_LUTMAX       (16)
+// max amount of calibration points
+#define HC_MAXPTS       (32)
+
+typedef struct{
+    int32_t V;          // voltage, uV
+    int32_t X;          // position, um
+} hc_point;
+
+typedef struct{
+    uint16_t n;         // amount of knots (<2 - no calibration)
+    int32_t V[HC_LUTMAX];
+    int32_t X[HC_LUTMAX];
+} hc_lut;
+
+typedef enum{
+    HC_OK,
+    HC_TOOFEW,          // less than 2 different voltages
+    HC_NONMONOTONIC,    // position isn't monotonic function of voltage
+} hc_err;
+
+uint32_t hc_isqrt(uint64_t x);
+void hc_meanrms(uint32_t sum, uint64_t sumsq, uint32_t n, uint32_t k, uint32_t *mean, uint32_t *rms);
+int32_t hc_interp(const hc_lut *l, int32_t V);
+hc_err hc_fit(hc_point *pts, int n, hc_lut *l, int32_t *maxerr);
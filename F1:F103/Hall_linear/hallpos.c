@@ -0,0 +1,124 @@
+/*
+ * This file is part of the hallinear project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "adc.h"
+#include "can.h"
+#include "canproto.h"
+#include "flash.h"
+#include "hallpos.h"
+#include "hardware.h"
+
+hallpos_t hallpos = {0};
+hallstat_t hallstat = {0};
+
+static hc_point calpts[HC_MAXPTS]; // calibration points
+static int ncalpts = 0;
+
+// statistics window
+static uint32_t Tstat = 0, ntrigstat = 0, nposstat = 0, npos = 0;
+static uint32_t Tcan = 0; // time of last CAN sending
+
+// publish position over CAN with answer format of CMD_POSITION
+static void sendpos(){
+    CAN_message msg = {.ID = the_conf.canID, .length = 8};
+    MSG_SET_CMD(msg, CMD_POSITION);
+    MSG_SET_PARNO(msg, NO_PARNO);
+    MSG_SET_ERR(msg, ERR_OK);
+    MSG_SET_U32(msg, (uint32_t)hallpos.X);
+    if(CAN_OK != CAN_send(&msg)) ++hallstat.canlost;
+}
+
+static void refreshstat(){
+    uint32_t dt = Tms - Tstat;
+    if(dt < 1000) return;
+    uint32_t nt = adc_ntrig;
+    hallstat.trigrate = (nt - ntrigstat) * 1000 / dt;
+    hallstat.posrate = (npos - nposstat) * 1000 / dt;
+    ntrigstat = nt;
+    nposstat = npos;
+    Tstat = Tms;
+    hallstat.overruns = adc_overruns;
+    uint32_t r = the_conf.adcrate ? the_conf.adcrate : 1;
+    hallstat.delay = (the_conf.ovrsmpl - 1) * 500000 / r;
+}
+
+/**
+ * @brief hallpos_proc - process accumulated ADC data: position by calibration curve, noise, latency
+ * @param sendcan - ==1 to publish position over CAN with period the_conf.canrate
+ * @return 1 if new position is ready
+ */
+int hallpos_proc(int sendcan){
+    adc_block b;
+    refreshstat();
+    if(!adc_getblock(&b)) return 0;
+    uint32_t mean, rms;
+    hc_meanrms(b.sum, b.sumsq, b.n, ADC_INJ_NCONV, &mean, &rms);
+    uint32_t vdd = getVdd(); // V*100
+    hallpos.mean = mean;
+    hallpos.rms = rms;
+    hallpos.V = (int32_t)(((uint64_t)mean * vdd * 10000) / (4095 * 16));
+    hallpos.rmsuV = (uint32_t)(((uint64_t)hallpos.rms * vdd * 10000) / (4095 * 16));
+    if(the_conf.lut.n > 1) hallpos.X = hc_interp(&the_conf.lut, hallpos.V);
+    else hallpos.X = (int32_t)(((int64_t)hallpos.V * the_conf.Mul) / the_conf.Div);
+    hallpos.T = b.Tend;
+    hallpos.latency = getus() - b.Tend;
+    if(hallpos.latency > hallstat.latmax) hallstat.latmax = hallpos.latency;
+    ++npos;
+    if(sendcan && the_conf.canrate && Tms - Tcan >= the_conf.canrate){
+        Tcan = Tms;
+        sendpos();
+    }
+    return 1;
+}
+
+/**
+ * @brief hallcal_addpoint - add calibration point: last voltage at given position
+ * @param X - position, um
+ * @return 0 if there's no place or no data
+ */
+int hallcal_addpoint(int32_t X){
+    if(ncalpts >= HC_MAXPTS || npos == 0) return 0;
+    calpts[ncalpts].V = hallpos.V;
+    calpts[ncalpts].X = X;
+    ++ncalpts;
+    return 1;
+}
+
+void hallcal_clear(){
+    ncalpts = 0;
+}
+
+int hallcal_npoints(){
+    return ncalpts;
+}
+
+/**
+ * @brief hallcal_fit - build calibration curve by points got and put it into the_conf (save it manually)
+ * @param maxerr (o) - max deviation of points from curve, um
+ * @return error code
+ */
+hc_err hallcal_fit(int32_t *maxerr){
+    hc_lut l;
+    hc_point pts[HC_MAXPTS]; // hc_fit() sorts and merges them
+    memcpy(pts, calpts, sizeof(hc_point) * ncalpts);
+    hc_err e = hc_fit(pts, ncalpts, &l, maxerr);
+    if(e == HC_OK) the_conf.lut = l;
+    return e;
+}
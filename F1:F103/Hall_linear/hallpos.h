@@ -0,0 +1,56 @@
+/*
+ * This file is part of the hallinear project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "hallcal.h"
+
+// max amount of triggers per position
+#define HALL_MAXOVRSMPL     (1024)
+
+// last position sample
+typedef struct{
+    int32_t X;          // position, um
+    int32_t V;          // voltage, uV
+    uint32_t mean;      // mean ADC value, 1/16 LSB
+    uint32_t rms;       // RMS noise of trigger value (average of ADC_INJ_NCONV samples), 1/16 LSB
+    uint32_t rmsuV;     // the same, uV
+    uint32_t T;         // time of last trigger in block, us
+    uint32_t latency;   // from last trigger to position ready, us
+} hallpos_t;
+
+// statistics
+typedef struct{
+    uint32_t trigrate;  // measured frequency of triggers, Hz
+    uint32_t posrate;   // measured amount of positions per second
+    uint32_t delay;     // group delay of averaging, us
+    uint32_t latmax;    // max processing latency, us
+    uint32_t overruns;  // blocks lost (not processed in time)
+    uint32_t canlost;   // positions not sent over CAN (bus busy)
+} hallstat_t;
+
+extern hallpos_t hallpos;
+extern hallstat_t hallstat;
+
+int hallpos_proc(int sendcan);
+int hallcal_addpoint(int32_t X);
+void hallcal_clear();
+int hallcal_npoints();
+hc_err hallcal_fit(int32_t *maxerr);
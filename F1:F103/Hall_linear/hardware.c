@@ -53,3 +53,14 @@ void hw_setup(){
 #endif
 }
 
+// current time, us (SysTick is 1ms)
+uint32_t getus(){
+    uint32_t ms, val;
+    do{
+        ms = Tms;
+        val = SysTick->VAL;
+    }while(ms != Tms);
+    // called from ISR while SysTick interrupt is pending: counter already reloaded
+    if((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) && val > SysTick->LOAD / 2) ++ms;
+    return ms * 1000 + (SysTick->LOAD - val) / ((SysTick->LOAD + 1) / 1000);
+}
@@ -34,3 +34,4 @@
 extern volatile uint32_t Tms;
 
 void hw_setup();
+uint32_t getus();
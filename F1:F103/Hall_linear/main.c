@@ -19,6 +19,7 @@
 #include "adc.h"
 #include "can.h"
 #include "flash.h"
+#include "hallpos.h"
 #include "hardware.h"
 #include "proto.h"
 #include "usb.h"
@@ -60,5 +61,6 @@ int main(void){
         }else{
             CAN_proc();
         }
+        hallpos_proc(!isUSB);
     }
 }
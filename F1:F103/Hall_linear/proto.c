@@ -21,6 +21,7 @@
 #include "adc.h"
 #include "canproto.h" // errors
 #include "flash.h"
+#include "hallpos.h"
 #include "hardware.h"
 #include "proto.h"
 #include "strfunc.h"
@@ -30,10 +31,19 @@
 const char* helpmsg =
     "https://github.com/eddyem/stm32samples/tree/master/F1-nolib/Hall_linear  build#" BUILD_NUMBER " @ " BUILD_DATE "\n"
     "a - get ADC value (raw*Mul/Div)\n"
+    "c - set period of position publishing over CAN (ms, 0 - off)\n"
     "d - change Div\n"
+    "f - set frequency of ADC triggers (Hz)\n"
+    "k - add calibration point: current voltage is at given position (um)\n"
     "m - change Mul\n"
+    "o - set amount of triggers (4 conversions each) per position\n"
+    "p - get position (um), voltage (uV) and noise\n"
     "r - get Raw ADC value\n"
     "u - get ADC voltage (*100)\n"
+    "C - clear calibration points\n"
+    "K - fit calibration curve by points (save it by X)\n"
+    "L - show calibration curve\n"
+    "P - show statistics: rates, noise and latency\n"
     "\t\tdebugging/conf commands:\n"
     "D - dump current config\n"
     "E - erase full flash storage\n"
@@ -56,6 +66,52 @@ static const char* const errors_txt[ERR_AMOUNT] = {
     ,[ERR_CANTRUN] = "cantrun"
 };
 
+static void showpos(){
+    USB_sendstr("X="); printi(hallpos.X);
+    USB_sendstr("\nV="); printi(hallpos.V);
+    USB_sendstr("\nmean16="); printu(hallpos.mean);
+    USB_sendstr("\nrms16="); printu(hallpos.rms);
+    USB_sendstr("\nrmsuV="); printu(hallpos.rmsuV);
+    USB_sendstr("\nT="); printu(hallpos.T);
+    newline();
+}
+
+static void showstat(){
+    USB_sendstr("trigrate="); printu(hallstat.trigrate);
+    USB_sendstr("\nsamplerate="); printu(hallstat.trigrate * ADC_INJ_NCONV);
+    USB_sendstr("\nposrate="); printu(hallstat.posrate);
+    USB_sendstr("\nrmsuV="); printu(hallpos.rmsuV);
+    USB_sendstr("\ndelay="); printu(hallstat.delay);
+    USB_sendstr("\nlatency="); printu(hallpos.latency);
+    USB_sendstr("\nlatmax="); printu(hallstat.latmax);
+    USB_sendstr("\noverruns="); printu(hallstat.overruns);
+    USB_sendstr("\ncanlost="); printu(hallstat.canlost);
+    newline();
+}
+
+static void showlut(){
+    USB_sendstr("calpoints="); printu(hallcal_npoints()); newline();
+    for(int i = 0; i < the_conf.lut.n; ++i){
+        printi(the_conf.lut.V[i]); USB_sendstr(" -> ");
+        printi(the_conf.lut.X[i]); newline();
+    }
+}
+
+static errcodes fitlut(){
+    int32_t maxerr;
+    switch(hallcal_fit(&maxerr)){
+        case HC_TOOFEW:
+            USB_sendstr("Need at least two points\n");
+            return ERR_CANTRUN;
+        case HC_NONMONOTONIC:
+            USB_sendstr("Position isn't monotonic\n");
+            return ERR_BADVAL;
+        default: break;
+    }
+    USB_sendstr("maxerr="); printi(maxerr); newline();
+    return ERR_OK;
+}
+
 static void errtext(errcodes e){
     if(e != ERR_OK) USB_sendstr("error=");
     USB_sendstr(errors_txt[e]);
@@ -69,6 +125,25 @@ void parse_cmd(const char *buf){
     uint32_t U, nan = 0;
     if(buf[1] == '\n' || !buf[1]){ // one symbol commands
         switch(*buf){
+            case 'C':
+                hallcal_clear();
+                ret = ERR_OK;
+            break;
+            case 'K':
+                ret = fitlut();
+            break;
+            case 'L':
+                showlut();
+                return;
+            break;
+            case 'P':
+                showstat();
+                return;
+            break;
+            case 'p':
+                showpos();
+                return;
+            break;
             case 'D': // dump current config
                 dump_userconf();
                 return;
@@ -129,7 +204,40 @@ void parse_cmd(const char *buf){
         nan = 1;
         ret = ERR_BADVAL;
     }
+    int32_t I;
     switch(cmd){ // long messages
+        case 'c': // CAN publishing period
+            if(nan) break;
+            if(U > 10000) ret = ERR_BADVAL;
+            else{
+                the_conf.canrate = U;
+                ret = ERR_OK;
+            }
+        break;
+        case 'f': // ADC triggers frequency
+            if(nan) break;
+            if(U < ADC_MINRATE || U > ADC_MAXRATE) ret = ERR_BADVAL;
+            else{
+                the_conf.adcrate = U;
+                adc_setrate(U);
+                ret = ERR_OK;
+            }
+        break;
+        case 'k': // calibration point
+            if(getint(buf, &I) == buf) ret = ERR_BADVAL;
+            else if(hallcal_addpoint(I)){
+                USB_sendstr("V="); printi(hallpos.V); newline();
+                ret = ERR_OK;
+            }else ret = ERR_CANTRUN;
+        break;
+        case 'o': // oversampling
+            if(nan) break;
+            if(U < 1 || U > HALL_MAXOVRSMPL) ret = ERR_BADVAL;
+            else{
+                the_conf.ovrsmpl = U;
+                ret = ERR_OK;
+            }
+        break;
         case 'I': // can ID
             if(nan) break;
             else if(U >= 0x800) ret = ERR_WRONGLEN;
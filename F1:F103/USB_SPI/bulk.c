@@ -0,0 +1,196 @@
+/*
+ * This file is part of the USB_SPI project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// binary bulk mode: descriptors from USB are cut into chunks; while one chunk is transferred by SPI DMA,
+// next is filled from USB, received data of previous is sent to USB
+
+#include "bulk.h"
+#include "bulkparse.h"
+#include "hardware.h"
+#include "spi.h"
+#include "usb.h"
+
+// after bad descriptor input is dropped until pause of this length, ms
+#define ERRPAUSE    (50)
+
+// chunk flags
+#define CH_RET      (1<<0)  // return received data
+#define CH_DUMMY    (1<<1)  // send 0xff instead of data
+#define CH_LAST     (1<<2)  // last chunk of descriptor
+
+typedef struct{
+    uint8_t buf[BULKBUFSZ]; // TX data, replaced by RX
+    uint16_t len;
+    uint8_t cs;
+    uint8_t flags;
+} chunk;
+
+uint8_t bulkON = 0;
+bulk_stat bulkstat = {0};
+
+static chunk chunks[2];
+static uint8_t head = 0;    // oldest queued chunk
+static uint8_t nq = 0;      // amount of queued chunks (the next after them is filling)
+static uint8_t busy = 0;    // head chunk is in work
+static uint8_t cssel = 0;   // selected chip
+static uint16_t pkt[USB_RXBUFSZ / 2]; // last USB packet
+static const uint8_t *pktptr = NULL;
+static int pktlen = 0;      // rest of data in packet
+static bparser parser;
+static uint8_t curcs = 0, curflags = 0; // CS and chunk flags of current descriptor
+static uint32_t rdrest = 0; // rest of BK_READ length
+static uint8_t ending = 0, exitmode = 0, err = 0;
+static uint32_t errTms = 0;
+// current batch
+static uint16_t ndesc = 0;
+static uint32_t nbytes = 0, tstart = 0;
+
+static void cs_set(uint8_t cs){
+    cs &= BK_CSMASK;
+    if(cs == cssel) return;
+    CS_OFF();
+    if(cs == 1) pin_clear(CS_port, CS0_pin);
+    else if(cs == 2) pin_clear(CS_port, CS1_pin);
+    cssel = cs;
+}
+
+void bulk_start(){
+    bp_init(&parser);
+    head = nq = busy = 0;
+    chunks[0].len = chunks[1].len = 0;
+    pktlen = 0;
+    rdrest = 0;
+    ending = exitmode = err = 0;
+    ndesc = 0;
+    nbytes = 0;
+    cs_set(0);
+    bulkON = 1;
+}
+
+static void start(){
+    chunk *c = &chunks[head];
+    cs_set(c->cs);
+    if(c->len && !SPI_exchange(c->buf, c->len, c->flags & CH_DUMMY)) return; // try later
+    busy = 1;
+}
+
+static void finish(){
+    chunk *c = &chunks[head];
+    busy = 0;
+    if((c->flags & CH_LAST) && !(c->cs & BK_CSHOLD)) cs_set(0);
+    nbytes += c->len;
+    head ^= 1;
+    --nq;
+    if(nq) start(); // next chunk is transferred while we send this one
+    if(c->flags & CH_RET) USB_write(c->buf, c->len);
+    c->len = 0;
+}
+
+static void enqueue(chunk *c, uint8_t last){
+    c->cs = curcs;
+    c->flags = curflags;
+    if(last) c->flags |= CH_LAST;
+    ++nq;
+}
+
+// fill chunks from USB
+static void fill(){
+    while(nq < 2 && !ending){
+        chunk *c = &chunks[(head + nq) & 1];
+        if(rdrest){ // read: no input needed
+            uint16_t l = (rdrest > BULKBUFSZ) ? BULKBUFSZ : (uint16_t)rdrest;
+            c->len = l;
+            rdrest -= l;
+            enqueue(c, !rdrest);
+            continue;
+        }
+        if(!pktlen){
+            pktlen = USB_receive((char*)pkt);
+            pktptr = (const uint8_t*)pkt;
+            if(!pktlen) return;
+        }
+        const uint8_t *data;
+        int dlen;
+        switch(bp_feed(&parser, &pktptr, &pktlen, BULKBUFSZ - c->len, &data, &dlen)){
+            case BP_DESC:
+                if(!ndesc++) tstart = Tus();
+                curcs = parser.d.cs;
+                switch(parser.d.op){
+                    case BK_END:
+                    case BK_EXIT:
+                        ending = 1;
+                        exitmode = (parser.d.op == BK_EXIT);
+                    break;
+                    case BK_READ:
+                        curflags = CH_RET | CH_DUMMY;
+                        rdrest = parser.d.len;
+                        if(!rdrest) enqueue(c, 1); // only CS change
+                    break;
+                    default:
+                        curflags = (parser.d.op == BK_XFER) ? CH_RET : 0;
+                        if(!parser.d.len) enqueue(c, 1);
+                }
+            break;
+            case BP_DATA:
+                for(int i = 0; i < dlen; ++i) c->buf[c->len + i] = data[i];
+                c->len += dlen;
+                if(!parser.rest) enqueue(c, 1);
+                else if(c->len == BULKBUFSZ) enqueue(c, 0);
+            break;
+            case BP_ERROR:
+                if(!ndesc) tstart = Tus();
+                ending = exitmode = err = 1;
+                ++bulkstat.nerr;
+                c->len = 0;
+                pktlen = 0;
+                errTms = Tms;
+            break;
+            default: // BP_MORE
+            break;
+        }
+    }
+}
+
+void bulk_proc(){
+    if(!bulkON) return;
+    if(busy && SPI_status == SPI_READY) finish();
+    if(!busy && nq) start();
+    fill();
+    if(!ending || nq || busy) return;
+    if(err){ // drop the rest of input
+        char tmp[USB_RXBUFSZ] __attribute__((aligned(2)));
+        if(USB_receive(tmp)) errTms = Tms;
+        if(Tms - errTms < ERRPAUSE) return;
+    }
+    bk_trailer t = {.magic = {'O', 'K'}, .ndesc = ndesc, .nbytes = nbytes, .tus = Tus() - tstart};
+    if(err){
+        t.magic[0] = 'E'; t.magic[1] = 'R';
+    }
+    USB_write((const uint8_t*)&t, sizeof(t));
+    ++bulkstat.nbatches;
+    bulkstat.ndesc += ndesc;
+    bulkstat.nbytes += nbytes;
+    bulkstat.tus += t.tus;
+    ndesc = 0;
+    nbytes = 0;
+    ending = 0;
+    if(exitmode){
+        cs_set(0);
+        bulkON = 0;
+    }
+}
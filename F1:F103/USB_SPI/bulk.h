@@ -0,0 +1,43 @@
+/*
+ * This file is part of the USB_SPI project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef BULK_H__
+#define BULK_H__
+
+#include <stdint.h>
+
+// size of each of two DMA buffers
+#define BULKBUFSZ   (256)
+
+// statistics of all batches
+typedef struct{
+    uint32_t nbatches;
+    uint32_t ndesc;
+    uint32_t nbytes;    // bytes transferred over SPI
+    uint32_t tus;       // total time of batches, us
+    uint32_t nerr;      // amount of bad descriptors
+} bulk_stat;
+
+extern uint8_t bulkON;
+extern bulk_stat bulkstat;
+
+void bulk_start();
+void bulk_proc();
+
+#endif // BULK_H__
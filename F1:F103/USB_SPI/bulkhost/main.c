@@ -0,0 +1,224 @@
+/*
+ * This file is part of the USB_SPI project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host checker of bulk mode descriptor parser (../bulkparse.c): random batches are split into
+// USB packets of random size and parsed with random data portion limits, result is compared with source;
+// bad descriptors should stop parser.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+#include "../bulkparse.h"
+
+#define MAXDESC     (64)
+#define MAXDATA     (2000)
+#define STREAMSZ    (MAXDESC * (BK_HDRSZ + MAXDATA))
+
+typedef struct{
+    bk_desc d;
+    uint8_t data[MAXDATA];
+} desc_t;
+
+static desc_t src[MAXDESC], dst[MAXDESC];
+static uint8_t stream[STREAMSZ];
+
+static int puthdr(uint8_t *s, uint8_t op, uint8_t cs, uint32_t len){
+    s[0] = op;
+    s[1] = cs;
+    for(int i = 0; i < 4; ++i) s[2 + i] = (len >> (8 * i)) & 0xff;
+    return BK_HDRSZ;
+}
+
+// random batch ended by BK_END, return stream length
+static int genbatch(int *nd){
+    const uint8_t ops[] = {BK_XFER, BK_WRITE, BK_READ};
+    int n = 1 + lrand48() % (MAXDESC - 1), l = 0;
+    for(int i = 0; i < n - 1; ++i){
+        bk_desc *d = &src[i].d;
+        d->op = ops[lrand48() % 3];
+        d->cs = (lrand48() % (BK_CSMAX + 1)) | ((lrand48() & 1) ? BK_CSHOLD : 0);
+        switch(lrand48() % 4){
+            case 0: d->len = 0; break;
+            case 1: d->len = 1 + lrand48() % 8; break;
+            default: d->len = lrand48() % MAXDATA;
+        }
+        if(d->op == BK_READ && !(lrand48() % 4)) d->len = (uint32_t)lrand48() << 1; // long read
+        l += puthdr(stream + l, d->op, d->cs, d->len);
+        if(d->op == BK_READ) continue;
+        for(uint32_t j = 0; j < d->len; ++j) src[i].data[j] = stream[l++] = lrand48() & 0xff;
+    }
+    src[n - 1].d.op = (lrand48() & 1) ? BK_END : BK_EXIT;
+    src[n - 1].d.cs = 0;
+    src[n - 1].d.len = 0;
+    l += puthdr(stream + l, src[n - 1].d.op, 0, 0);
+    *nd = n;
+    return l;
+}
+
+/**
+ * @brief parse - parse stream split into random packets
+ * @param p - parser
+ * @param l - stream length
+ * @param nd (o) - amount of descriptors got
+ * @param maxdata - max data portion (0 - random)
+ * @return last event
+ */
+static bp_event parse(bparser *p, int l, int *nd, int maxdata){
+    int pos = 0, n = -1;
+    uint32_t got = 0;
+    bp_event e = BP_MORE;
+    while(pos < l){
+        int plen = 1 + lrand48() % 64;
+        if(plen > l - pos) plen = l - pos;
+        const uint8_t *buf = stream + pos;
+        int len = plen;
+        pos += plen;
+        while(len){
+            const uint8_t *data;
+            int dlen, max = maxdata ? maxdata : 1 + lrand48() % 256;
+            e = bp_feed(p, &buf, &len, max, &data, &dlen);
+            if(e == BP_MORE) break;
+            if(e == BP_ERROR){
+                *nd = n + 1;
+                return e;
+            }
+            if(e == BP_DESC){
+                if(++n == MAXDESC) return BP_ERROR;
+                dst[n].d = p->d;
+                got = 0;
+            }else{ // BP_DATA
+                if(n < 0 || dlen > max || got + dlen > dst[n].d.len || got + dlen + p->rest != dst[n].d.len){
+                    if(verbose) printf("desc %d: bad data portion %d (got %u, rest %u)\n", n, dlen, got, p->rest);
+                    return BP_ERROR;
+                }
+                memcpy(dst[n].data + got, data, dlen);
+                got += dlen;
+            }
+        }
+    }
+    *nd = n + 1;
+    return e;
+}
+
+static int cmpdesc(int n){
+    for(int i = 0; i < n; ++i){
+        bk_desc *s = &src[i].d, *d = &dst[i].d;
+        if(s->op != d->op || s->cs != d->cs || s->len != d->len){
+            if(verbose) printf("desc %d: op=%d/%d, cs=%d/%d, len=%u/%u\n", i, s->op, d->op, s->cs, d->cs, s->len, d->len);
+            return 1;
+        }
+        if(s->op != BK_READ && memcmp(src[i].data, dst[i].data, s->len)){
+            if(verbose) printf("desc %d: data differs\n", i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int chkrandom(){
+    int bad = 0;
+    bparser p;
+    bp_init(&p);
+    for(int i = 0; i < 2000 && !bad; ++i){ // the same parser for all batches
+        int n, ngot;
+        int l = genbatch(&n);
+        bp_event e = parse(&p, l, &ngot, (i & 1) ? 0 : 256);
+        bad = e == BP_ERROR || ngot != n || p.rest || cmpdesc(n);
+        if(bad && verbose) printf("batch %d: %d descriptors of %d, event %d\n", i, ngot, n, e);
+    }
+    return chkfail("random batches", bad);
+}
+
+// header split into single bytes, data portions of 1 byte
+static int chksplit(){
+    int bad = 0;
+    bparser p;
+    bp_init(&p);
+    for(int i = 0; i < 200 && !bad; ++i){
+        int n, ngot;
+        int l = genbatch(&n);
+        const uint8_t *buf = stream;
+        int pos = 0, k = -1;
+        uint32_t got = 0;
+        while(pos < l && !bad){
+            int len = 1;
+            const uint8_t *data;
+            int dlen;
+            buf = stream + pos++;
+            bp_event e = bp_feed(&p, &buf, &len, 1, &data, &dlen);
+            if(e == BP_ERROR) bad = 1;
+            else if(e == BP_DESC){
+                dst[++k].d = p.d;
+                got = 0;
+            }else if(e == BP_DATA) dst[k].data[got++] = *data;
+            if(len) bad = 1; // byte should be consumed
+        }
+        ngot = k + 1;
+        bad |= ngot != n || cmpdesc(n);
+    }
+    return chkfail("split by bytes", bad);
+}
+
+static int chkerrors(){
+    int bad = 0;
+    struct{
+        const char *name;
+        uint8_t op, cs;
+        uint32_t len;
+    } wrong[] = {
+        {"unknown op", 0x04, 0, 10},
+        {"unknown op", 0x80, 1, 0},
+        {"bad CS number", BK_XFER, 3, 1},
+        {"bad CS flags", BK_WRITE, 0x41, 1},
+        {"END with length", BK_END, 0, 1},
+        {"EXIT with CS", BK_EXIT, 1, 0},
+    };
+    for(size_t i = 0; i < sizeof(wrong)/sizeof(wrong[0]); ++i){
+        bparser p;
+        bp_init(&p);
+        // good descriptor, bad one and good again
+        int l = puthdr(stream, BK_XFER, 1, 3);
+        stream[l++] = 1; stream[l++] = 2; stream[l++] = 3;
+        l += puthdr(stream + l, wrong[i].op, wrong[i].cs, wrong[i].len);
+        l += puthdr(stream + l, BK_END, 0, 0);
+        int n;
+        bp_event e = parse(&p, l, &n, 0);
+        const uint8_t *buf = stream;
+        int len = BK_HDRSZ, dlen;
+        const uint8_t *data;
+        int b = e != BP_ERROR || n != 1 || dst[0].d.len != 3 || memcmp(dst[0].data, "\1\2\3", 3)
+                || bp_feed(&p, &buf, &len, 256, &data, &dlen) != BP_ERROR; // sticky
+        bp_init(&p);
+        b |= bp_feed(&p, &buf, &len, 256, &data, &dlen) != BP_DESC || p.d.op != BK_XFER;
+        if(b && verbose) printf("%s (op=0x%02x, cs=0x%02x, len=%u): not detected\n", wrong[i].name,
+                                wrong[i].op, wrong[i].cs, wrong[i].len);
+        bad |= b;
+    }
+    return chkfail("bad descriptors", bad);
+}
+
+int main(int argc, char **argv){
+    hosttest_opts(argc, argv);
+    int ret = chkrandom();
+    ret |= chksplit();
+    ret |= chkerrors();
+    return hosttest_result(ret);
+}
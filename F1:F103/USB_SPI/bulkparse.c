@@ -0,0 +1,91 @@
+/*
+ * This file is part of the USB_SPI project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bulkparse.h"
+
+void bp_init(bparser *p){
+    p->d.op = BK_END;
+    p->d.cs = 0;
+    p->d.len = 0;
+    p->rest = 0;
+    p->hpos = 0;
+    p->err = 0;
+}
+
+// check header and fill descriptor
+static int chkhdr(bparser *p){
+    bk_desc *d = &p->d;
+    d->op = p->hdr[0];
+    d->cs = p->hdr[1];
+    d->len = p->hdr[2] | (p->hdr[3] << 8) | (p->hdr[4] << 16) | ((uint32_t)p->hdr[5] << 24);
+    if((d->cs & ~(BK_CSMASK | BK_CSHOLD)) || (d->cs & BK_CSMASK) > BK_CSMAX) return 0;
+    switch(d->op){
+        case BK_END:
+        case BK_EXIT:
+            if(d->len || d->cs) return 0;
+            p->rest = 0;
+        break;
+        case BK_READ:
+            p->rest = 0; // no data
+        break;
+        case BK_XFER:
+        case BK_WRITE:
+            p->rest = d->len;
+        break;
+        default:
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief bp_feed - parse next portion of input
+ * @param p - parser
+ * @param buf, len (io) - input data and its length; moved to first unparsed byte
+ * @param maxdata - max length of data portion
+ * @param data, dlen (o) - data portion (pointer into input) for BP_DATA
+ * @return event; p->d is current descriptor, p->rest - amount of its data bytes to come
+ */
+bp_event bp_feed(bparser *p, const uint8_t **buf, int *len, int maxdata, const uint8_t **data, int *dlen){
+    if(p->err) return BP_ERROR;
+    if(*len <= 0) return BP_MORE;
+    if(p->rest){ // data of current descriptor
+        int l = *len;
+        if(l > maxdata) l = maxdata;
+        if((uint32_t)l > p->rest) l = (int)p->rest;
+        if(l <= 0) return BP_MORE;
+        *data = *buf;
+        *dlen = l;
+        *buf += l;
+        *len -= l;
+        p->rest -= l;
+        return BP_DATA;
+    }
+    while(*len && p->hpos < BK_HDRSZ){
+        p->hdr[p->hpos++] = **buf;
+        ++*buf;
+        --*len;
+    }
+    if(p->hpos < BK_HDRSZ) return BP_MORE;
+    p->hpos = 0;
+    if(!chkhdr(p)){
+        p->err = 1;
+        return BP_ERROR;
+    }
+    return BP_DESC;
+}
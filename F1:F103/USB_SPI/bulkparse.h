@@ -0,0 +1,80 @@
+/*
+ * This file is part of the USB_SPI project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef BULKPARSE_H__
+#define BULKPARSE_H__
+
+#include <stdint.h>
+
+/*
+ * Binary bulk mode protocol (all numbers are little-endian).
+ * Host sends stream of descriptors: header (op, cs, 32-bit length) followed by `length` bytes
+ * of data for BK_XFER and BK_WRITE. Data could be split between USB packets arbitrarily.
+ * Device returns received bytes of BK_XFER and BK_READ descriptors in the same order and
+ * bk_trailer after BK_END or BK_EXIT.
+ */
+
+// descriptor header size
+#define BK_HDRSZ    (6)
+
+// descriptor operations
+#define BK_END      (0x00)  // end of batch: wait for all transfers and send trailer
+#define BK_XFER     (0x01)  // send data and return received bytes
+#define BK_WRITE    (0x02)  // send data, received bytes are dropped
+#define BK_READ     (0x03)  // send `length` bytes of 0xff and return received (no data follows)
+#define BK_EXIT     (0xff)  // end of batch and return to text protocol
+
+// CS byte: chip select number (0 - release all) and flag to keep it after transfer
+#define BK_CSMASK   (0x03)
+#define BK_CSMAX    (2)
+#define BK_CSHOLD   (0x80)
+
+typedef struct{
+    uint8_t op;
+    uint8_t cs;
+    uint32_t len;
+} bk_desc;
+
+// answer on BK_END/BK_EXIT
+typedef struct __attribute__((packed)){
+    char magic[2];      // "OK" or "ER" (bad descriptor, rest of input was dropped)
+    uint16_t ndesc;     // amount of descriptors in batch (including last)
+    uint32_t nbytes;    // amount of bytes transferred over SPI
+    uint32_t tus;       // time from first descriptor receiving till end of batch, us
+} bk_trailer;
+
+typedef enum{
+    BP_MORE,            // all input consumed, need more
+    BP_DESC,            // got new descriptor header
+    BP_DATA,            // got portion of descriptor's data
+    BP_ERROR            // bad descriptor, parser stays in this state until bp_init()
+} bp_event;
+
+typedef struct{
+    bk_desc d;          // current descriptor
+    uint32_t rest;      // rest of its data bytes
+    uint8_t hdr[BK_HDRSZ];
+    uint8_t hpos;       // amount of header bytes got
+    uint8_t err;
+} bparser;
+
+void bp_init(bparser *p);
+bp_event bp_feed(bparser *p, const uint8_t **buf, int *len, int maxdata, const uint8_t **data, int *dlen);
+
+#endif // BULKPARSE_H__
@@ -27,7 +27,10 @@ static inline void gpio_setup(){
     // Set led as opendrain output
     GPIOC->CRH = CRH(13, CNF_ODOUTPUT | MODE_SLOW);
     // setup SPI GPIO - alternate function PP (PA5 - SCK, PA6 - MISO, PA7 - MOSI)
-    GPIOA->CRL = CRL(5, CNF_AFPP|MODE_FAST) | CRL(6, CNF_FLINPUT) | CRL(7, CNF_AFPP|MODE_FAST);
+    // and chip selects (PA3, PA4)
+    CS_OFF();
+    GPIOA->CRL = CRL(3, CNF_PPOUTPUT|MODE_FAST) | CRL(4, CNF_PPOUTPUT|MODE_FAST) |
+                 CRL(5, CNF_AFPP|MODE_FAST) | CRL(6, CNF_FLINPUT) | CRL(7, CNF_AFPP|MODE_FAST);
     // USB pullup (PA15) - pushpull output
     USBPU_OFF();
     GPIOA->CRH = CRH(15, CNF_PPOUTPUT | MODE_SLOW);
@@ -37,3 +40,12 @@ void hw_setup(){
     gpio_setup();
 }
 
+// time in microseconds (SysTick: 72MHz, 1ms period); don't call it with disabled IRQs
+uint32_t Tus(){
+    uint32_t ms, val;
+    do{
+        ms = Tms;
+        val = SysTick->VAL;
+    }while(ms != Tms);
+    return ms * 1000 + (71999 - val) / 72;
+}
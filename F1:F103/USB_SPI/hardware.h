@@ -35,9 +35,16 @@
 #define USBPU_ON()  pin_set(USBPU_port, USBPU_pin)
 #define USBPU_OFF() pin_clear(USBPU_port, USBPU_pin)
 
+// chip selects for bulk mode (active low): CS0 - PA4, CS1 - PA3
+#define CS_port     GPIOA
+#define CS0_pin     (1<<4)
+#define CS1_pin     (1<<3)
+#define CS_OFF()    pin_set(CS_port, CS0_pin | CS1_pin)
+
 extern volatile uint32_t Tms;
 
 void hw_setup();
+uint32_t Tus();
 
 // SPI RX/TX max len
 #define SPIBUFSZ        (128)
@@ -16,6 +16,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "bulk.h"
 #include "hardware.h"
 #include "proto.h"
 #include "spi.h"
@@ -67,6 +68,10 @@ int main(void){
         }
         char *txt = NULL;
         usb_proc();
+        if(bulkON){
+            bulk_proc();
+            continue;
+        }
         if((txt = get_USB())){
             const char *ans = parse_cmd(txt);
             if(ans) USB_send(ans);
@@ -16,6 +16,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "bulk.h"
 #include "hardware.h"
 #include "proto.h"
 #include "spi.h"
@@ -154,6 +155,8 @@ char *getnum(const char *txt, uint32_t *N){
 
 const char* helpmsg =
     "https://github.com/eddyem/stm32samples/tree/master/F1-nolib/USB_SPI build#" BUILD_NUMBER " @ " BUILD_DATE "\n"
+    "b - bulk mode statistics\n"
+    "B - enter binary bulk mode\n"
     "F - change SPI flags (F f val), f== l-LSBFIRST, b-BR [18MHz/2^(b+1)], p-CPOL, h-CPHA\n"
     "G - get SPI status\n"
     "I - reinit SPI\n"
@@ -181,6 +184,25 @@ const char *parse_cmd(const char *buf){
     initbuf();
     if(buf[1] == '\n' || !buf[1]){ // one symbol commands
         switch(*buf){
+            case 'b':
+                add2buf("batches="); add2buf(u2str(bulkstat.nbatches));
+                add2buf("\ndescriptors="); add2buf(u2str(bulkstat.ndesc));
+                add2buf("\nbytes="); add2buf(u2str(bulkstat.nbytes));
+                add2buf("\ntime_us="); add2buf(u2str(bulkstat.tus));
+                add2buf("\nerrors="); add2buf(u2str(bulkstat.nerr));
+                if(bulkstat.tus){ // bytes per us == MB/s
+                    uint32_t kBps = (uint32_t)((uint64_t)bulkstat.nbytes * 1000 / bulkstat.tus);
+                    add2buf("\nspeed="); add2buf(u2str(kBps / 1000)); add2buf(".");
+                    kBps %= 1000;
+                    if(kBps < 100) add2buf("0");
+                    if(kBps < 10) add2buf("0");
+                    add2buf(u2str(kBps)); add2buf("MB/s");
+                }
+            break;
+            case 'B':
+                USB_send("BULK\n");
+                bulk_start();
+            return NULL;
             case 'F': // just watch SPI->CR1 value
                 add2buf("SPI1->CR1="); add2buf(u2hexstr(SPI_CR1));
             break;
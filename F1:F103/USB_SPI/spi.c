@@ -55,6 +55,28 @@ void spi_setup(){
     SPIx->CR1 |= SPI_CR1_SPE; // enable SPI
 }
 
+// start DMA exchange; tx==NULL to send 0xff
+static void dmastart(const uint8_t *tx, uint8_t *rx, uint16_t len){
+    static const uint8_t dummybyte = 0xff;
+    DMA_SPI_TxChannel->CCR &=~ DMA_CCR_EN;
+    DMA_SPI_RxChannel->CCR &=~ DMA_CCR_EN;
+    // refresh broken CMAR
+    if(tx){
+        DMA_SPI_TxChannel->CMAR = (uint32_t)tx;
+        DMA_SPI_TxChannel->CCR |= DMA_CCR_MINC;
+    }else{
+        DMA_SPI_TxChannel->CMAR = (uint32_t)&dummybyte;
+        DMA_SPI_TxChannel->CCR &= ~DMA_CCR_MINC;
+    }
+    DMA_SPI_RxChannel->CMAR = (uint32_t)rx;
+    // set CNDTR
+    DMA_SPI_TxChannel->CNDTR = len;
+    DMA_SPI_RxChannel->CNDTR = len;
+    SPI_status = SPI_BUSY;
+    DMA_SPI_RxChannel->CCR |= DMA_CCR_EN;
+    DMA_SPI_TxChannel->CCR |= DMA_CCR_EN;
+}
+
 /**
  * @brief SPI_transmit - transmit data over SPI DMA
  * @param buf - data to transmit
@@ -79,22 +101,26 @@ uint8_t SPI_transmit(const uint8_t *buf, uint8_t len){
 #endif
     if(len > SPIBUFSZ) len = SPIBUFSZ; // buflen too much
     mymemcpy(outbuff, (uint8_t*)buf, len);
-    DMA_SPI_TxChannel->CCR &=~ DMA_CCR_EN;
-    DMA_SPI_RxChannel->CCR &=~ DMA_CCR_EN;
-    // refresh broken CMAR
-    DMA_SPI_TxChannel->CMAR = (uint32_t)outbuff;
-    DMA_SPI_RxChannel->CMAR = (uint32_t)inbuff;
-    // set CNDTR
-    DMA_SPI_TxChannel->CNDTR = len;
-    DMA_SPI_RxChannel->CNDTR = len;
-    SPI_status = SPI_BUSY;
+    dmastart(outbuff, inbuff, len);
     lastlen = len;
-    DMA_SPI_RxChannel->CCR |= DMA_CCR_EN;
-    DMA_SPI_TxChannel->CCR |= DMA_CCR_EN;
     return len;
 
 }
 
+/**
+ * @brief SPI_exchange - start DMA transfer in place: received data overwrites `buf`
+ * (TX DMA reads each byte before RX DMA writes it)
+ * @param buf - data buffer
+ * @param len - its length
+ * @param dummy - !=0 to send 0xff instead of `buf` content
+ * @return 0 if SPI is busy
+ */
+uint8_t SPI_exchange(uint8_t *buf, uint16_t len, uint8_t dummy){
+    if(!buf || !len || SPI_status != SPI_READY) return 0;
+    dmastart(dummy ? NULL : buf, buf, len);
+    return 1;
+}
+
 /**
  * @brief SPI_receive - get received data
  * @param buf - buffer with len >= maxlen
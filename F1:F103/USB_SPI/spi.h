@@ -35,5 +35,6 @@ extern spiStatus SPI_status;
 void spi_setup();
 uint8_t SPI_transmit(const uint8_t *buf, uint8_t len);
 uint8_t SPI_receive(uint8_t *buf, uint8_t maxlen);
+uint8_t SPI_exchange(uint8_t *buf, uint16_t len, uint8_t dummy);
 
 #endif // SPI_H__
@@ -38,20 +38,24 @@ void send_next(){
     lastdsz = buflen;
 }
 
-// put `buf` into queue to send
+// put `len` bytes of `buf` into queue to send
+void USB_write(const uint8_t *buf, int len){
+    if(!buf || !usbON || len <= 0) return;
+    while(len){
+        if(tx_succesfull) send_next();
+        int a = RB_write((const char*)buf, len);
+        len -= a;
+        buf += a;
+    }
+}
+
+// put string `buf` into queue to send
 void USB_send(const char *buf){
     if(!buf || !usbON) return;
     int len = 0;
     const char *b = buf;
     while(*b++) ++len;
-    if(!usbON || !len) return;
-    int l = len;
-    while(l){
-        if(tx_succesfull) send_next();
-        int a = RB_write(buf, l);
-        l -= a;
-        buf += a;
-    }
+    USB_write((const uint8_t*)buf, len);
 }
 
 // interrupt IN handler (never used?)
@@ -29,6 +29,7 @@ extern volatile uint8_t tx_succesfull;
 void usb_proc();
 void send_next();
 void USB_send(const char *buf);
+void USB_write(const uint8_t *buf, int len);
 uint8_t USB_receive(char *buf);
 
 #endif // __USB_H__
@@ -21,6 +21,7 @@
 
 #include "GPS.h"
 #include "hardware.h"
+#include "nmea.h"
 #include "time.h"
 #include "usart.h"
 #include "str.h"
@@ -30,31 +31,13 @@
 #define GPS_send_string(str) do{usart_send(GPS_USART, str);}while(0)
 
 gps_status GPS_status = GPS_NOTFOUND;
+nmea_parser GPS_parser = {0};
 int need2startseq = 1;
 
 static uint8_t hex(uint8_t n){
     return ((n < 10) ? (n+'0') : (n+'A'-10));
 }
 
-/**
- * Check checksum
- */
-static int checksum_true(const char *buf){
-    char *eol;
-    uint8_t checksum = 0, cs[3];
-    if(*buf != '$' || !(eol = getchr(buf, '*'))){
-        return 0;
-    }
-    while(++buf != eol)
-        checksum ^= (uint8_t)*buf;
-    ++buf;
-    cs[0] = hex(checksum >> 4);
-    cs[1] = hex(checksum & 0x0f);
-    if(buf[0] == cs[0] && buf[1] == cs[1])
-        return 1;
-    return 0;
-}
-
 static void send_chksum(uint8_t chs){
     usart_putchar(GPS_USART, hex(chs >> 4));
     usart_putchar(GPS_USART, hex(chs & 0x0f));
@@ -99,15 +82,15 @@ static void write_with_checksum(const char *buf){
  *      1st - 0-disable, 1-after 1st fix, 2-3D only, 3-2D/3D only, 4-always
  *      2nd - 2..998 - pulse width
  * 314 - PMTK_API_SET_NMEA_OUTPUT - set output messages, N== N fixes per output,
- *      order of messages: GLL,RMC,VTG,GGA,GSA,GSV,GRS,GST, only RMC per every pos fix:
- *      $PMTK314,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+ *      order of messages: GLL,RMC,VTG,GGA,GSA,GSV,GRS,GST, ... ,ZDA(18th),MCHN; RMC, GGA, GSA & ZDA per every pos fix:
+ *      $PMTK314,0,1,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,1,0
  * 386 - PMTK_API_SET_STATIC_NAV_THD speed threshold (m/s) for static navigation
  *      $PMTK386,1.5
  * ;
  */
 
 /**
- * Send starting sequences (get only RMC messages)
+ * Send starting sequences (get RMC, GGA, GSA and ZDA messages)
  */
 void GPS_send_start_seq(){
     DBG("Send start seq");
@@ -115,8 +98,8 @@ void GPS_send_start_seq(){
     write_with_checksum("PMTK255,1");
     // set pulse width to 10ms with working after 1st fix
     write_with_checksum("PMTK285,1,10");
-    // set only RMC:
-    write_with_checksum("PMTK314,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0");
+    // set RMC, GGA, GSA and ZDA:
+    write_with_checksum("PMTK314,0,1,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,1,0");
     // set static speed threshold
     write_with_checksum("PMTK386,1.5");
     need2startseq = 0;
@@ -128,52 +111,31 @@ void GPS_send_FullColdStart(){
 }
 
 /**
- * Parse answer from GPS module
- *
- * Recommended minimum specific GPS/Transit data
- * $GPRMC,hhmmss.sss,status,latitude,N,longitude,E,spd,cog,ddmmyy,mv,mvE,mode*cs
- * 1    = UTC of position fix
- * 2    = Data status (V=valid, A=invalid)
- * 3    = Latitude (ddmm.mmmm)
- * 4    = N or S
- * 5    = Longitude (dddmm.mmmm)
- * 6    = E or W
- * 7    = Speed over ground in knots
- * 8    = Cource over ground in degrees
- * 9    = UT date (ddmmyy)
- * 10   = Magnetic variation degrees (Easterly var. subtracts from true course)
- * 11   = E or W
- * 12   = Mode: N(bad), E(approx), A(auto), D(diff)
- * 213457.00,A,4340.59415,N,04127.47560,E,2.494,,290615,,,A*7B
+ * Parse data from GPS module (any portion: part of sentence, one or several sentences)
+ * Time is taken from RMC, GGA/GSA give quality of fix, ZDA - full date;
+ * see nmea.c for fields description
  */
 void GPS_parse_answer(const char *buf){
-    char *ptr;
-    if(buf[1] == 'P') return; // answers to proprietary messages
-    if(cmpstr(buf+3, "RMC", 3)){ // not RMC message
-        //need2startseq = 1;
-        return;
-    }
-    if(!checksum_true(buf)){
-        return; // wrong checksum
-    }
-    if(showGPSstr){
-        showGPSstr = 0;
-        sendstring(buf);
-    }
-    buf += 7; // skip header
-    if(*buf == ','){ // time unknown
-        GPS_status = GPS_WAIT;
-        return;
-    }
-    ptr = getchr(buf, ',');
-    if(!ptr ) return;
-    *ptr++ = 0;
-    if(*ptr == 'A'){
-        GPS_status = GPS_VALID;
-        set_time(buf);
-    }else{
-        uint8_t goth = (buf[0]-'0')*10 + buf[1]-'0';
-        if(current_time.H != goth) set_time(buf); // set time once per hour even if it's not valid
-        GPS_status = GPS_NOT_VALID;
+    const nmea_data *d = &GPS_parser.data;
+    const char *line = buf;
+    while(*buf){
+        if(nmea_putc(&GPS_parser, *buf++) != NMEA_RMC) continue;
+        // "$" + `len` symbols + "*hh"
+        const char *start = buf - (GPS_parser.len + 4);
+        if(showGPSstr && start >= line){
+            showGPSstr = 0;
+            sendstring(start);
+        }
+        if(!d->timevalid){ // time unknown
+            GPS_status = GPS_WAIT;
+            continue;
+        }
+        if(d->rmcvalid){
+            GPS_status = GPS_VALID;
+            set_time(d->H, d->M, d->S);
+        }else{
+            if(current_time.H != d->H) set_time(d->H, d->M, d->S); // set time once per hour even if it's not valid
+            GPS_status = GPS_NOT_VALID;
+        }
     }
 }
@@ -24,6 +24,7 @@
 #define __GPS_H__
 
 #include "stm32f1.h"
+#include "nmea.h"
 
 extern int need2startseq;
 
@@ -35,6 +36,7 @@ typedef enum{
 } gps_status;
 
 extern gps_status GPS_status;
+extern nmea_parser GPS_parser;
 
 void GPS_parse_answer(const char *string);
 void GPS_send_start_seq();
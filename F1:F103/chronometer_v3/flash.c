@@ -64,6 +64,8 @@ uint32_t maxLnum = FLASH_BLOCK_SIZE / sizeof(user_conf);
     ,.defflags = 0                          \
     ,.NLfreeWarn = 100                      \
     ,.ledshow_time = 5000                   \
+    ,.lidar_hyst = LIDAR_DIST_THRES         \
+    ,.lidar_median = LIDAR_MEDIAN_DEF       \
     }
 
 // change to placement
@@ -152,6 +154,9 @@ void flashstorage_init(){
     currentconfidx = binarySearch((int)maxCnum-2, (const uint8_t*)Flash_Data, sizeof(user_conf));
     if(currentconfidx > -1){
         memcpy(&the_conf, &Flash_Data[currentconfidx], sizeof(user_conf));
+        // config stored by older firmware or broken: 0xff or even value would reset median filter forever
+        if(the_conf.lidar_median < 1 || the_conf.lidar_median > LIDAR_MEDIAN_MAX || !(the_conf.lidar_median & 1))
+            the_conf.lidar_median = LIDAR_MEDIAN_DEF;
     }
     currentlogidx = binarySearch((int)maxLnum-2, (const uint8_t*)logsstart, sizeof(event_log));
 }
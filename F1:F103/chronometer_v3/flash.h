@@ -45,6 +45,8 @@ typedef struct __attribute__((packed, aligned(4))){
     uint32_t LIDAR_speed;       // USART3 speed (115200 by default)
     uint16_t trigpause[TRIGGERS_AMOUNT]; // pause (ms) for false shots
     uint16_t ledshow_time;      // shutter events display time (ms)
+    uint16_t lidar_hyst;        // LIDAR trigger hysteresis (cm)
+    uint8_t  lidar_median;      // length of LIDAR median filter
 } user_conf;
 
 // values for user_conf.defflags:
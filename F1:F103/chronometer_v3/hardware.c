@@ -25,6 +25,7 @@
 #include "hardware.h"
 #include "flash.h"
 #include "lidar.h"
+#include "pps.h"
 #include "str.h"
 #include "time.h"
 #include "usart.h"
@@ -47,6 +48,12 @@ uint32_t shotms[TRIGGERS_AMOUNT];
 int16_t triglen[TRIGGERS_AMOUNT];
 // if trigger[N] shots, the bit N will be 1
 uint8_t trigger_shot = 0;
+// PPS disciplining of TIM2/TIM3 counters
+pps_t pps;
+// time of last and previous PPS
+static curtime ppstime = TMNOTINI, prevppstime = TMNOTINI;
+// high halves of 32-bit TIM2/TIM3 counters
+static volatile uint16_t tim2hi = 0, tim3hi = 0;
 
 static inline void gpio_setup(){
     BUZZER_OFF(); // turn off buzzer @start
@@ -61,34 +68,30 @@ static inline void gpio_setup(){
 // PORTA
     // pullups: PA1 - PPS, PA15 - USB pullup
     GPIOA->ODR = (1<<1)|(1<<15);
-    // PPS pin (PA1) - input with weak pullup, PA6 - SCLK of LED screen
+    // PPS pin (PA1, TIM2_CH2) - input with weak pullup, PA6 - SCLK of LED screen
     GPIOA->CRL = CRL(1, CNF_PUDINPUT|MODE_INPUT) | CRL(6, CNF_PPOUTPUT|MODE_SLOW);
-    EXTI->IMR = EXTI_IMR_MR1; // mask PA1
-    // interrupt on pulse front: buttons - 1->0, PPS - 0->1
-    EXTI->RTSR = EXTI_RTSR_TR1; // rising trigger for PPS
-    NVIC_EnableIRQ(EXTI1_IRQn); // enable PPS interrupt
     // Set USB pullup (PA15) - opendrain output
     GPIOA->CRH = CRH(15, CNF_ODOUTPUT|MODE_SLOW);
 // PORTB
     // Set leds (PB8/9) as opendrain output
     GPIOB->CRH = CRH(8, CNF_ODOUTPUT|MODE_SLOW) | CRH(9, CNF_ODOUTPUT|MODE_SLOW);
-    // TRIGGERS: PB0,1,3; SCREEN pins: A,B - PB6,PB7;
+    // TRIGGERS: PB0,1,3 (PB0/1 - TIM3_CH3/4); SCREEN pins: A,B - PB6,PB7;
     GPIOB->CRL = CRL(0, CNF_PUDINPUT|MODE_INPUT) | CRL(1, CNF_PUDINPUT|MODE_INPUT) | CRL(3, CNF_PUDINPUT|MODE_INPUT) |
             CRL(6, CNF_PPOUTPUT|MODE_SLOW) | CRL(7, CNF_PPOUTPUT|MODE_SLOW);
 // PORTC
     // buzzer (PC13): pushpull output
     GPIOC->CRH = CRH(13, CNF_PPOUTPUT|MODE_SLOW);
-    // exti: PB0, 3; PA1
-    AFIO->EXTICR[0] = AFIO_EXTICR1_EXTI0_PB | AFIO_EXTICR1_EXTI1_PA | AFIO_EXTICR1_EXTI3_PB;
+    // exti: PB3
+    AFIO->EXTICR[0] = AFIO_EXTICR1_EXTI3_PB;
     // PB0/1/3 - triggers
     for(int i = 0; i < DIGTRIG_AMOUNT; ++i){
         uint16_t pin = trigpin[i];
-        if(pin == 1<<1) continue; // omit PB1
         // fill trigstate array
         uint8_t trgs = (the_conf.trigstate & (1<<i)) ? 1 : 0;
         trigstate[i] = trgs;
+        if(pin == 1<<1) continue; // omit PB1
         trigport[i]->ODR |= pin; // turn on pullups
-        if(i != 1){ // turn interrupts on
+        if(i == 2){ // turn interrupts on (TRIG0/1 are on timer capture)
             EXTI->IMR |= pin;
             if(trgs){ // triggered @1 -> rising interrupt
                 EXTI->RTSR |= pin;
@@ -99,11 +102,51 @@ static inline void gpio_setup(){
     }
     // ---------------------> config-depengent block, interrupts & pullup inputs:
     // !!! change AFIO_EXTICRx if some triggers not @GPIOA
-    NVIC_EnableIRQ(EXTI0_IRQn); // PB0
+    NVIC_SetPriority(EXTI3_IRQn, 0);
     NVIC_EnableIRQ(EXTI3_IRQn); // PB3
     // <---------------------
 }
 
+/*
+ * Timestamping timers: TIM2 and TIM3 count at 72MHz, TIM3 is started by TIM2 enable (TRGO), so
+ * their counters are equal (with resynchronization delay ~1 tick); high halves are counted in
+ * update interrupts. PA1 - TIM2_CH2 (PPS), PB0 - TIM3_CH3 (TRIG0), PB1 - TIM3_CH4 (TRIG1).
+ * PB3 (TRIG2) can be only TIM2_CH2 with remap, so it stays on EXTI with software capture.
+ */
+static inline void timers_setup(){
+    pps_init(&pps);
+    RCC->APB1ENR |= RCC_APB1ENR_TIM2EN | RCC_APB1ENR_TIM3EN;
+    // TIM3: slave in trigger mode (SMS=110) by ITR1 (TIM2)
+    TIM3->PSC = 0;
+    TIM3->ARR = 0xffff;
+    TIM3->SMCR = TIM_SMCR_TS_0 | TIM_SMCR_SMS_2 | TIM_SMCR_SMS_1;
+    // CC3/CC4 - input capture from TI3/TI4, filter: fCK_INT, N=8
+    TIM3->CCMR2 = TIM_CCMR2_CC3S_0 | TIM_CCMR2_IC3F_0 | TIM_CCMR2_IC3F_1 |
+                  TIM_CCMR2_CC4S_0 | TIM_CCMR2_IC4F_0 | TIM_CCMR2_IC4F_1;
+    uint16_t ccer = TIM_CCER_CC3E | TIM_CCER_CC4E;
+    if(!trigstate[0]) ccer |= TIM_CCER_CC3P; // triggered @0 -> falling edge
+    if(!trigstate[1]) ccer |= TIM_CCER_CC4P;
+    TIM3->CCER = ccer;
+    // TIM2: master, TRGO = enable
+    TIM2->PSC = 0;
+    TIM2->ARR = 0xffff;
+    TIM2->CR2 = TIM_CR2_MMS_0;
+    // CC2 - input capture from TI2 by rising edge, filter: fCK_INT, N=8
+    TIM2->CCMR1 = TIM_CCMR1_CC2S_0 | TIM_CCMR1_IC2F_0 | TIM_CCMR1_IC2F_1;
+    TIM2->CCER = TIM_CCER_CC2E;
+    TIM2->EGR = TIM_EGR_UG;
+    TIM3->EGR = TIM_EGR_UG;
+    TIM2->SR = 0;
+    TIM3->SR = 0;
+    TIM2->DIER = TIM_DIER_UIE | TIM_DIER_CC2IE;
+    TIM3->DIER = TIM_DIER_UIE | TIM_DIER_CC3IE | TIM_DIER_CC4IE;
+    NVIC_SetPriority(TIM2_IRQn, 0);
+    NVIC_SetPriority(TIM3_IRQn, 0);
+    NVIC_EnableIRQ(TIM2_IRQn);
+    NVIC_EnableIRQ(TIM3_IRQn);
+    TIM2->CR1 = TIM_CR1_CEN; // start both
+}
+
 static inline void adc_setup(){
     GPIOB->CRL |= CRL(0, CNF_ANALOG|MODE_INPUT);
     uint32_t ctr = 0;
@@ -141,12 +184,59 @@ static inline void adc_setup(){
 void hw_setup(){
     gpio_setup();
     adc_setup();
+    timers_setup();
+}
+
+/**
+ * @brief ext32 - extend 16-bit counter value by high half
+ * @param hi - high half (not counting unprocessed update)
+ * @param cap - captured value
+ * @param sr - timer's SR read after capture
+ * @return 32-bit value
+ */
+static uint32_t ext32(uint16_t hi, uint16_t cap, uint32_t sr){
+    // update isn't processed yet: values after overflow are small
+    if((sr & TIM_SR_UIF) && cap < 0x8000) ++hi;
+    return ((uint32_t)hi << 16) | cap;
+}
+
+// current value of 32-bit counter (software capture)
+uint32_t getcounter(){
+    __disable_irq();
+    uint16_t cnt = TIM3->CNT;
+    uint32_t val = ext32(tim3hi, cnt, TIM3->SR);
+    __enable_irq();
+    return val;
 }
 
 static trigtime trgtm;
-void savetrigtime(){
-    trgtm.millis = Timer;
-    memcpy(&trgtm.Time, &current_time, sizeof(curtime));
+/**
+ * @brief cnt2time - convert counter value into trigger time
+ * If PPS isn't locked or was lost, use millisecond timer as before
+ */
+static void cnt2time(uint32_t cnt){
+    int32_t d = (int32_t)(cnt - pps.lastcap);
+    const curtime *t = &ppstime;
+    uint32_t us = 1000000;
+    if(d < 0){ // event before last PPS, but processed after it
+        d = (int32_t)(cnt - pps.prevcap);
+        t = &prevppstime;
+    }
+    if(pps_locked(&pps) && d >= 0) us = pps_ticks2us(&pps, (uint32_t)d);
+    if(us < 1000000){
+        trgtm.millis = us / 1000;
+        trgtm.micros = us % 1000;
+        memcpy(&trgtm.Time, t, sizeof(curtime));
+    }else{
+        trgtm.millis = Timer;
+        trgtm.micros = 0;
+        memcpy(&trgtm.Time, &current_time, sizeof(curtime));
+    }
+}
+
+// save time of event by its counter value (for events processed later, e.g. lidar)
+void savetrigcnt(uint32_t cnt){
+    cnt2time(cnt);
 }
 
 /**
@@ -180,7 +270,7 @@ void fillunshotms(){
                 rdy = 1;
             }else triglen[i] = (int16_t) len;
             if(i == LIDAR_TRIGGER){
-                if(!parse_lidar_data(NULL)) rdy = 1;
+                if(!lidar_triggered()) rdy = 1;
             }else{
                 uint8_t pinval = (trigport[i]->IDR & trigpin[i]) ? 1 : 0;
                 if(pinval != trigstate[i]) rdy = 1; // trigger is OFF
@@ -198,42 +288,45 @@ void fillunshotms(){
     }
 }
 
-void exti0_isr(){ // PB0 - trig0
-    EXTI->PR = EXTI_PR_PR0;
+// TIM3_CH3/TIM3_CH4 captures
+static void trigcapture(int i, uint32_t cnt){
     if(!chkshtr) return;
-    savetrigtime();
-    fillshotms(0);
+    cnt2time(cnt);
+    fillshotms(i);
 }
 
-void exti1_isr(){ // PPS - PA1
-    systick_correction();
-    LED_off(); // turn off LED0 @ each PPS
-    EXTI->PR = EXTI_PR_PR1;
+void tim2_isr(){
+    uint32_t sr = TIM2->SR;
+    if(sr & TIM_SR_CC2IF){ // PPS
+        uint32_t cap = ext32(tim2hi, TIM2->CCR2, sr);
+        if(pps_update(&pps, cap) != PPS_BAD){ // glitch don't touch time: `ppstime` corresponds to `pps.lastcap`
+            prevppstime = ppstime;
+            systick_correction();
+            ppstime = current_time;
+        }
+        LED_off(); // turn off LED0 @ each PPS
+    }
+    if(sr & TIM_SR_UIF){
+        TIM2->SR = ~TIM_SR_UIF;
+        ++tim2hi;
+    }
 }
 
-void chkTrig1(){
-    // ================> HARD HARDWARE DEPENDENT: PB1 trigger
-    if(!chkshtr) return;
-    static uint8_t oldstate = 0;
-    uint8_t curstate = GPIOB->IDR & 2;
-    if(Tms < 100){ // don't mind for first 100ms
-        oldstate = curstate;
-        return;
-    }
-    if(curstate == oldstate){ // state didn't changed
-        return;
+void tim3_isr(){
+    uint32_t sr = TIM3->SR;
+    if(sr & TIM_SR_CC3IF) trigcapture(0, ext32(tim3hi, TIM3->CCR3, sr)); // PB0 - trig0
+    if(sr & TIM_SR_CC4IF) trigcapture(1, ext32(tim3hi, TIM3->CCR4, sr)); // PB1 - trig1
+    if(sr & TIM_SR_UIF){
+        TIM3->SR = ~TIM_SR_UIF;
+        ++tim3hi;
     }
-    oldstate = curstate;
-    if(curstate != (the_conf.trigstate & 2)) return; // relax from trigger
-    savetrigtime();
-    fillshotms(1);
-    // <================
 }
 
 void exti3_isr(){ // PB3 - trig2
+    uint32_t cnt = getcounter();
     EXTI->PR = EXTI_PR_PR3;
     if(!chkshtr) return;
-    savetrigtime();
+    cnt2time(cnt);
     fillshotms(2);
 }
 
@@ -25,6 +25,7 @@
 #define __HARDWARE_H__
 
 #include "stm32f1.h"
+#include "pps.h"
 #include "time.h"
 
 #ifdef EBUG
@@ -72,7 +73,8 @@ extern uint8_t buzzer_on;
 uint8_t gettrig(uint8_t N);
 void fillshotms(int i);
 void fillunshotms();
-void savetrigtime();
+void savetrigcnt(uint32_t cnt);
+uint32_t getcounter();
 #define GET_PPS()       ((GPIOA->IDR & (1<<1)) ? 1 : 0)
 
 // USB pullup - PA15
@@ -109,6 +111,7 @@ void savetrigtime();
 typedef struct{
     uint32_t millis;
     curtime Time;
+    uint16_t micros;    // microseconds (0 if there was no PPS)
 } trigtime;
 
 // turn on/off LEDs:
@@ -121,11 +124,11 @@ extern int16_t triglen[TRIGGERS_AMOUNT];
 extern uint8_t trigger_shot;
 // Tms value when they shot
 extern uint32_t shotms[TRIGGERS_AMOUNT];
+// PPS disciplining of timestamping counter
+extern pps_t pps;
 
 void chk_buzzer();
 void buzzer_squeak();
 void hw_setup();
 
-void chkTrig1();
-
 #endif // __HARDWARE_H__
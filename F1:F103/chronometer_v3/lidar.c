@@ -16,66 +16,95 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include "flash.h"
+#include "hardware.h"
 #include "lidar.h"
 #include "usart.h"
 
-uint16_t last_lidar_dist = 0;
-uint16_t last_lidar_stren = 0;
-uint16_t lidar_triggered_dist = 0;
+lidar_t lidar = {0};
+uint32_t lidar_ringovr = 0; // ring buffer overflows
+uint16_t lidar_fps = 0;     // good frames per last second
+
+// Rx ring: bytes and timestamping counter values of header bytes
+static uint8_t ring[LIDAR_RINGSZ];
+static uint32_t ringcnt[LIDAR_RINGSZ];
+static volatile uint8_t rhead = 0;
+static uint8_t rtail = 0;
 
 extern uint32_t shotms[];
 
 /**
- * @brief parse_lidar_data - parsing of string from lidar
- * @param txt - the string or NULL (if you want just check trigger state)
- * @return trigger state
+ * @brief lidar_putbyte - put next received byte into ring buffer (call from USART Rx ISR)
+ * @param b - byte
  */
-uint8_t parse_lidar_data(char *txt){
-    static uint8_t triggered = 0;
-    if(!txt){
-        // clear trigger state after timeout -> need to monitor lidar
-        uint32_t len = Tms - shotms[LIDAR_TRIGGER];
-        //if(len > MAX_TRIG_LEN || len > (uint32_t)the_conf.trigpause[LIDAR_TRIGGER]){
-        if(len > MAX_TRIG_LEN){
-            triggered = 0;
-            DBG("MAX time gone, untrigger!");
-        }
-        return triggered;
+void lidar_putbyte(uint8_t b){
+    uint8_t next = (rhead + 1) & (LIDAR_RINGSZ - 1);
+    if(next == rtail){
+        ++lidar_ringovr;
+        return;
     }
-    last_lidar_dist = txt[2] | (txt[3] << 8);
-    last_lidar_stren = txt[4] | (txt[5] << 8);
-    if(last_lidar_stren < LIDAR_LOWER_STREN) return 0; // weak signal
-    if(!lidar_triggered_dist){ // first run
-        lidar_triggered_dist = last_lidar_dist;
-        return 0;
-    }
-    IWDG->KR = IWDG_REFRESH;
-    if(triggered){ // check if body gone
-        if(last_lidar_dist < the_conf.dist_min || last_lidar_dist > the_conf.dist_max || last_lidar_dist > lidar_triggered_dist + LIDAR_DIST_THRES){
-            triggered = 0;
+    // only header bytes can start frame, so don't waste time for others
+    if(b == LIDAR_FRAME_HEADER) ringcnt[rhead] = getcounter();
+    ring[rhead] = b;
+    rhead = next;
+}
+
+/**
+ * @brief lidar_process - decode all data collected in ring buffer and check trigger
+ */
+void lidar_process(){
+    static uint32_t Tsec = 0, Fsec = 0;
+    if(lidar.medlen != the_conf.lidar_median) lidar_init(&lidar, the_conf.lidar_median);
+    lidar.dmin = the_conf.dist_min;
+    lidar.dmax = the_conf.dist_max;
+    lidar.hyst = the_conf.lidar_hyst;
+    while(rtail != rhead){
+        IWDG->KR = IWDG_REFRESH;
+        lidar_evt e = lidar_putc(&lidar, ring[rtail], ringcnt[rtail]);
+        rtail = (rtail + 1) & (LIDAR_RINGSZ - 1);
+        if(e == LIDAR_TRIG){
+            savetrigcnt(lidar.trigtag);
+            fillshotms(LIDAR_TRIGGER);
 #ifdef EBUG
-            SEND("Untriggered! distance=");
-            printu(1, last_lidar_dist);
+            SEND("Triggered! distance=");
+            printu(1, lidar.median);
             SEND(" signal=");
-            printu(1, last_lidar_stren);
+            printu(1, lidar.stren);
             newline(1);
 #endif
         }
-    }else{
-        if(last_lidar_dist > the_conf.dist_min && last_lidar_dist < the_conf.dist_max){
-            savetrigtime();
-            triggered = 1;
-            lidar_triggered_dist = last_lidar_dist;
-            fillshotms(LIDAR_TRIGGER);
 #ifdef EBUG
-            SEND("Triggered! distance=");
-            printu(1, last_lidar_dist);
+        else if(e == LIDAR_UNTRIG){
+            SEND("Untriggered! distance=");
+            printu(1, lidar.median);
             SEND(" signal=");
-            printu(1, last_lidar_stren);
+            printu(1, lidar.stren);
             newline(1);
-#endif
         }
+#endif
+    }
+    if(Tms - Tsec >= 1000){
+        Tsec = Tms;
+        lidar_fps = (uint16_t)(lidar.stat.frames - Fsec);
+        Fsec = lidar.stat.frames;
+    }
+}
+
+/**
+ * @brief lidar_triggered - check trigger state
+ * @return trigger state (clear it after timeout -> need to monitor lidar)
+ */
+uint8_t lidar_triggered(){
+    if(lidar.triggered && Tms - shotms[LIDAR_TRIGGER] > MAX_TRIG_LEN){
+        lidar.triggered = 0;
+        DBG("MAX time gone, untrigger!");
     }
-    return triggered;
+    return lidar.triggered;
+}
+
+void lidar_clrstat(){
+    memset(&lidar.stat, 0, sizeof(lidar_stat_t));
+    lidar_ringovr = 0;
 }
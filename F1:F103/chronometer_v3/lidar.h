@@ -20,20 +20,24 @@
 #define LIDAR_H__
 #include <stm32f1.h>
 
-#define LIDAR_FRAME_LEN     (9)
-// frame header
-#define LIDAR_FRAME_HEADER  (0x59)
-// lower strength limit
-#define LIDAR_LOWER_STREN   (10)
-// triggered distance threshold - 1 meter
+#include "lidardec.h"
+
+// triggered distance threshold (default hysteresis) - 1 meter
 #define LIDAR_DIST_THRES    (100)
 #define LIDAR_MIN_DIST      (50)
 #define LIDAR_MAX_DIST      (1000)
+// default median length
+#define LIDAR_MEDIAN_DEF    (3)
+// size of Rx ring buffer (power of 2, less than 256)
+#define LIDAR_RINGSZ        (128)
 
-extern uint16_t last_lidar_dist;
-extern uint16_t lidar_triggered_dist;
-extern uint16_t last_lidar_stren;
+extern lidar_t lidar;
+extern uint32_t lidar_ringovr;
+extern uint16_t lidar_fps;
 
-uint8_t parse_lidar_data(char *txt);
+void lidar_putbyte(uint8_t b);
+void lidar_process();
+uint8_t lidar_triggered();
+void lidar_clrstat();
 
 #endif // LIDAR_H__
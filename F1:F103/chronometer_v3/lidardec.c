@@ -0,0 +1,123 @@
+/*
+ * This file is part of the chronometer project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "lidardec.h"
+
+/**
+ * @brief lidar_init - clear decoder and filter, set median length
+ * @param l - lidar
+ * @param medlen - median length (will be odd and in 1..LIDAR_MEDIAN_MAX)
+ * configuration of trigger zone is kept
+ */
+void lidar_init(lidar_t *l, uint8_t medlen){
+    uint16_t dmin = l->dmin, dmax = l->dmax, hyst = l->hyst;
+    memset(l, 0, sizeof(lidar_t));
+    l->dmin = dmin; l->dmax = dmax; l->hyst = hyst;
+    if(medlen < 1) medlen = 1;
+    else if(medlen > LIDAR_MEDIAN_MAX) medlen = LIDAR_MEDIAN_MAX;
+    l->medlen = medlen | 1;
+}
+
+// throw away bytes of `frame` till next possible header
+static void resync(lidar_t *l){
+    uint8_t i = 1;
+    for(; i < l->len; ++i){
+        if(l->frame[i] != LIDAR_FRAME_HEADER) continue;
+        if(i + 1 == l->len || l->frame[i + 1] == LIDAR_FRAME_HEADER) break;
+    }
+    l->stat.skipped += i;
+    l->len -= i;
+    if(l->len){
+        memmove(l->frame, l->frame + i, l->len);
+        memmove(l->ftag, l->ftag + i, l->len * sizeof(uint32_t));
+    }
+}
+
+static uint16_t median(const lidar_t *l){
+    uint16_t s[LIDAR_MEDIAN_MAX];
+    uint8_t n = l->hn;
+    for(uint8_t i = 0; i < n; ++i){ // insertion sort
+        uint16_t v = l->hist[i];
+        int8_t j = (int8_t)i - 1;
+        for(; j >= 0 && s[j] > v; --j) s[j + 1] = s[j];
+        s[j + 1] = v;
+    }
+    return s[n / 2];
+}
+
+// process good frame
+static lidar_evt frame(lidar_t *l, uint32_t tag){
+    ++l->stat.frames;
+    l->dist = l->frame[2] | (l->frame[3] << 8);
+    l->stren = l->frame[4] | (l->frame[5] << 8);
+    if(l->stren < LIDAR_LOWER_STREN || l->stren == 0xffff){ // weak or saturated signal
+        ++l->stat.weak;
+        return LIDAR_FRAME;
+    }
+    l->hist[l->hpos] = l->dist;
+    l->htag[l->hpos] = tag;
+    if(++l->hpos == l->medlen) l->hpos = 0;
+    if(l->hn < l->medlen) ++l->hn;
+    if(l->hn < l->medlen) return LIDAR_FRAME; // not enough data
+    uint16_t m = l->median = median(l);
+    if(!l->triggered){
+        if(m < l->dmin || m > l->dmax) return LIDAR_FRAME;
+        l->triggered = 1;
+        l->trigdist = m;
+        // median changes after (medlen+1)/2 new values: take time of first of them
+        int8_t idx = (int8_t)l->hpos - (int8_t)(l->medlen + 1) / 2;
+        if(idx < 0) idx += l->medlen;
+        l->trigtag = l->htag[idx];
+        return LIDAR_TRIG;
+    }
+    if((int32_t)m < (int32_t)l->dmin - l->hyst || (int32_t)m > (int32_t)l->dmax + l->hyst
+        || (int32_t)m > (int32_t)l->trigdist + l->hyst){
+        l->triggered = 0;
+        return LIDAR_UNTRIG;
+    }
+    return LIDAR_FRAME;
+}
+
+/**
+ * @brief lidar_putc - put next byte of lidar stream into decoder
+ * @param l - lidar
+ * @param c - byte
+ * @param tag - its timestamp (e.g. counter value when byte received)
+ * @return event
+ */
+lidar_evt lidar_putc(lidar_t *l, uint8_t c, uint32_t tag){
+    l->frame[l->len] = c;
+    l->ftag[l->len] = tag;
+    ++l->len;
+    if(l->len < 3){ // header
+        if(c != LIDAR_FRAME_HEADER) resync(l);
+        return LIDAR_NONE;
+    }
+    if(l->len < LIDAR_FRAME_LEN) return LIDAR_NONE;
+    uint8_t cs = 0;
+    for(int i = 0; i < LIDAR_FRAME_LEN - 1; ++i) cs += l->frame[i];
+    if(cs != l->frame[LIDAR_FRAME_LEN - 1]){
+        ++l->stat.badcs;
+        resync(l);
+        return LIDAR_NONE;
+    }
+    l->len = 0;
+    return frame(l, l->ftag[0]);
+}
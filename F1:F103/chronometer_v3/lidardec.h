@@ -0,0 +1,84 @@
+/*
+ * This file is part of the chronometer project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef LIDARDEC_H__
+#define LIDARDEC_H__
+
+#include <stdint.h>
+
+/*
+ * Hardware-independent decoder of TF-mini binary frames and trigger logic:
+ * 0x59 0x59 DistL DistH StrenL StrenH x x CS, CS = low byte of sum of first 8 bytes.
+ * Frames with bad header or checksum are rejected, decoder resyncs to next
+ * header inside rejected bytes. Distances of frames with enough signal strength
+ * pass through sliding median, trigger fires when median enters [dmin, dmax]
+ * and releases when it goes out of [dmin-hyst, dmax+hyst] or farther than
+ * triggered distance + hyst.
+ */
+
+#define LIDAR_FRAME_LEN     (9)
+// frame header
+#define LIDAR_FRAME_HEADER  (0x59)
+// lower strength limit
+#define LIDAR_LOWER_STREN   (10)
+// max length of median filter
+#define LIDAR_MEDIAN_MAX    (15)
+
+typedef enum{
+    LIDAR_NONE,         // frame isn't ready (or rejected)
+    LIDAR_FRAME,        // got frame, trigger state not changed
+    LIDAR_TRIG,         // trigger fired
+    LIDAR_UNTRIG        // trigger released
+} lidar_evt;
+
+typedef struct{
+    uint32_t frames;    // good frames
+    uint32_t badcs;     // frames with wrong checksum
+    uint32_t skipped;   // bytes skipped to resync
+    uint32_t weak;      // frames with too low signal strength
+} lidar_stat_t;
+
+typedef struct{
+    // configuration
+    uint16_t dmin;      // trigger zone, cm
+    uint16_t dmax;
+    uint16_t hyst;      // hysteresis, cm
+    uint8_t medlen;     // length of median filter (odd, 1..LIDAR_MEDIAN_MAX)
+    // decoder
+    uint8_t len;        // amount of bytes in `frame`
+    uint8_t frame[LIDAR_FRAME_LEN];
+    uint32_t ftag[LIDAR_FRAME_LEN]; // tags (timestamps) of bytes in `frame`
+    // filter
+    uint16_t hist[LIDAR_MEDIAN_MAX]; // last distances
+    uint32_t htag[LIDAR_MEDIAN_MAX]; // and their timestamps
+    uint8_t hpos;       // position of next record in `hist`
+    uint8_t hn;         // amount of records in `hist`
+    // results
+    uint16_t dist;      // last frame distance, signal strength
+    uint16_t stren;
+    uint16_t median;    // current median
+    uint16_t trigdist;  // median when triggered
+    uint32_t trigtag;   // tag of frame which caused trigger (taking into account median delay)
+    uint8_t triggered;
+    lidar_stat_t stat;
+} lidar_t;
+
+void lidar_init(lidar_t *l, uint8_t medlen);
+lidar_evt lidar_putc(lidar_t *l, uint8_t c, uint32_t tag);
+
+#endif // LIDARDEC_H__
@@ -0,0 +1,238 @@
+/*
+ * This file is part of the chronometer project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host checker of lidar decoder (../lidardec.c): decode recorded raw streams, damage them, benchmark
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+#include "../lidardec.h"
+
+static uint8_t *readfile(const char *name, size_t *len){
+    FILE *f = fopen(name, "r");
+    if(!f){ perror(name); exit(1); }
+    size_t sz = 65536, n = 0, l;
+    uint8_t *buf = malloc(sz);
+    while((l = fread(buf + n, 1, sz - n, f)) > 0){
+        n += l;
+        if(n == sz){
+            sz *= 2;
+            buf = realloc(buf, sz);
+        }
+    }
+    fclose(f);
+    *len = n;
+    return buf;
+}
+
+static void putframe(uint16_t dist, uint16_t stren){
+    uint8_t f[LIDAR_FRAME_LEN] = {LIDAR_FRAME_HEADER, LIDAR_FRAME_HEADER, dist & 0xff, dist >> 8,
+                                  stren & 0xff, stren >> 8, 0, 0, 0};
+    for(int i = 0; i < LIDAR_FRAME_LEN - 1; ++i) f[LIDAR_FRAME_LEN - 1] += f[i];
+    fwrite(f, LIDAR_FRAME_LEN, 1, stdout);
+}
+
+static double gauss(){
+    return sqrt(-2. * log(drand48() + 1e-12)) * cos(2. * M_PI * drand48());
+}
+
+/**
+ * @brief generate - synthetic stream: background at 9m with noise, single-frame spikes,
+ *                   weak frames and passes of objects (30 frames at 3m) every 500 frames
+ * @param N - amount of frames
+ */
+static void generate(long N){
+    for(long i = 0; i < N; ++i){
+        double d = (i % 500 >= 250 && i % 500 < 280) ? 300. : 900.;
+        d += 5. * gauss();
+        uint16_t stren = (uint16_t)(200 + 20 * gauss());
+        double r = drand48();
+        if(r < 0.01) d = drand48() * 1200.; // spike
+        else if(r < 0.02) stren = (uint16_t)(drand48() * LIDAR_LOWER_STREN); // weak
+        putframe((uint16_t)d, stren);
+    }
+}
+
+/**
+ * @brief slip - damage stream: drop, insert or change bytes
+ * @param buf - data
+ * @param len (io) - its length (can change)
+ * @param rate - probability of damage for each byte
+ * @return new buffer
+ */
+static uint8_t *slip(const uint8_t *buf, size_t *len, double rate){
+    size_t l = *len, n = 0;
+    uint8_t *out = malloc(2 * l + 1);
+    for(size_t i = 0; i < l; ++i){
+        if(drand48() >= rate){
+            out[n++] = buf[i];
+            continue;
+        }
+        double r = drand48();
+        if(r < 1./3.) continue; // drop
+        if(r < 2./3.) out[n++] = (uint8_t)lrand48(); // insert
+        else{ // change
+            out[n++] = (uint8_t)lrand48();
+            continue;
+        }
+        out[n++] = buf[i];
+    }
+    *len = n;
+    return out;
+}
+
+// print events and frames
+static void parse(lidar_t *l, const uint8_t *buf, size_t len){
+    for(size_t i = 0; i < len; ++i){
+        lidar_evt e = lidar_putc(l, buf[i], (uint32_t)i);
+        switch(e){
+            case LIDAR_FRAME:
+                if(verbose > 1) printf("%zu: dist=%u, stren=%u, median=%u\n", i, l->dist, l->stren, l->median);
+            break;
+            case LIDAR_TRIG:
+                printf("TRIG @ byte %u (detected @ %zu), median=%u\n", l->trigtag, i, l->median);
+            break;
+            case LIDAR_UNTRIG:
+                printf("UNTRIG @ byte %zu, median=%u\n", i, l->median);
+            break;
+            default:
+            break;
+        }
+    }
+}
+
+// @return amount of triggers
+static size_t count(lidar_t *l, const uint8_t *buf, size_t len){
+    size_t ntrig = 0;
+    for(size_t i = 0; i < len; ++i)
+        if(LIDAR_TRIG == lidar_putc(l, buf[i], (uint32_t)i)) ++ntrig;
+    return ntrig;
+}
+
+static void printstat(const lidar_stat_t *s, size_t ntrig){
+    printf("frames: %u, bad checksum: %u, skipped bytes: %u, weak: %u; %zu triggers\n",
+           s->frames, s->badcs, s->skipped, s->weak, ntrig);
+}
+
+static double dtime(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static void usage(const char *self){
+    fprintf(stderr, "Usage: %s -g N > out.bin | [options] file.bin\n", self);
+    fprintf(stderr, "\t-g - generate N frames of synthetic stream\n");
+    fprintf(stderr, "\t-d - print trigger events (twice - all frames)\n");
+    fprintf(stderr, "\t-m - median length (default 3)\n");
+    fprintf(stderr, "\t-l, -u - lower and upper distance of trigger zone (default 50 and 1000 cm)\n");
+    fprintf(stderr, "\t-y - hysteresis (default 100 cm)\n");
+    fprintf(stderr, "\t-r - damage stream (drop/insert/change bytes) with given probability\n");
+    fprintf(stderr, "\t-s - seed for random generator\n");
+    fprintf(stderr, "\t-b - benchmark: parse file `iterations` times (-n, default 1000)\n");
+    exit(1);
+}
+
+int main(int argc, char **argv){
+    int opt, niter = 1000, bench = 0, medlen = 3;
+    long gen = 0, seed = 1;
+    double rate = 0.;
+    lidar_t l = {.dmin = 50, .dmax = 1000, .hyst = 100};
+    while((opt = getopt(argc, argv, "g:dm:l:u:y:r:s:bn:")) != -1){
+        switch(opt){
+            case 'g':
+                gen = atol(optarg);
+                if(gen < 1) usage(argv[0]);
+            break;
+            case 'd':
+                ++verbose;
+            break;
+            case 'm':
+                medlen = atoi(optarg);
+            break;
+            case 'l':
+                l.dmin = (uint16_t)atoi(optarg);
+            break;
+            case 'u':
+                l.dmax = (uint16_t)atoi(optarg);
+            break;
+            case 'y':
+                l.hyst = (uint16_t)atoi(optarg);
+            break;
+            case 'r':
+                rate = atof(optarg);
+                if(rate < 0. || rate > 1.) usage(argv[0]);
+            break;
+            case 's':
+                seed = atol(optarg);
+            break;
+            case 'b':
+                bench = 1;
+            break;
+            case 'n':
+                niter = atoi(optarg);
+                if(niter < 1) usage(argv[0]);
+            break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    srand48(seed);
+    if(gen){
+        generate(gen);
+        return 0;
+    }
+    if(optind != argc - 1) usage(argv[0]);
+    size_t len;
+    uint8_t *buf = readfile(argv[optind], &len);
+    lidar_init(&l, (uint8_t)medlen);
+    printf("%zu bytes, median length %u\n", len, l.medlen);
+    if(verbose){
+        parse(&l, buf, len);
+        lidar_init(&l, (uint8_t)medlen);
+    }
+    size_t ntrig = count(&l, buf, len);
+    printstat(&l.stat, ntrig);
+    if(rate > 0.){
+        size_t dlen = len;
+        uint8_t *dmg = slip(buf, &dlen, rate);
+        lidar_init(&l, (uint8_t)medlen);
+        size_t nd = count(&l, dmg, dlen);
+        printf("Damaged stream (%zu bytes):\n", dlen);
+        printstat(&l.stat, nd);
+        free(dmg);
+    }
+    if(bench){
+        double t0 = dtime();
+        for(int i = 0; i < niter; ++i){
+            lidar_init(&l, (uint8_t)medlen);
+            count(&l, buf, len);
+        }
+        double t = dtime() - t0;
+        double nb = (double)len * niter;
+        printf("%d iterations: %.3g bytes/s (%.2f ns/byte), %.3g frames/s\n", niter, nb/t, t/nb*1e9,
+               nb / LIDAR_FRAME_LEN / t);
+    }
+    free(buf);
+    return 0;
+}
@@ -317,21 +317,19 @@ int main(void){
                 GPS_parse_answer(txt);
             }
         }
-        if(usartrx(LIDAR_USART)){
-            IWDG->KR = IWDG_REFRESH;
-            r = usart_getline(LIDAR_USART, &txt);
-            if(r){
-                if(the_conf.defflags & FLAG_NOLIDAR){
+        if(the_conf.defflags & FLAG_NOLIDAR){
+            if(usartrx(LIDAR_USART)){
+                IWDG->KR = IWDG_REFRESH;
+                r = usart_getline(LIDAR_USART, &txt);
+                if(r){
                     usart_send(LIDAR_USART, txt);
                     if(*txt != '\n'){
                         parse_CMD(txt);
                     }
-                }else
-                    parse_lidar_data(txt);
+                }
             }
-        }
+        }else lidar_process();
         chk_buzzer(); // should we turn off buzzer?
-        chkTrig1(); // check trigger without interrupt
     }
     return 0;
 }
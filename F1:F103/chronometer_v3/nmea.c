@@ -0,0 +1,243 @@
+/*
+ * This file is part of the chronometer project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "nmea.h"
+
+enum{
+    ST_IDLE,    // wait for '$'
+    ST_DATA,    // sentence body
+    ST_CS1,     // first and second checksum symbols
+    ST_CS2
+};
+
+static const struct{
+    char name[4];
+    nmea_type type;
+} types[] = {
+    {"RMC", NMEA_RMC},
+    {"GGA", NMEA_GGA},
+    {"ZDA", NMEA_ZDA},
+    {"GSA", NMEA_GSA}
+};
+#define NTYPES  (sizeof(types) / sizeof(types[0]))
+
+void nmea_init(nmea_parser *p){
+    memset(p, 0, sizeof(nmea_parser));
+}
+
+static int hex2u(char c){
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// get sentence type by address field and clear values it will change
+static void gettype(nmea_parser *p){
+    nmea_data *d = &p->tmp;
+    p->type = NMEA_OTHER;
+    if(p->fld.len != 5 || p->addr[0] == 'P') return; // proprietary or wrong
+    for(uint32_t i = 0; i < NTYPES; ++i){
+        const char *n = types[i].name;
+        if(p->addr[2] == n[0] && p->addr[3] == n[1] && p->addr[4] == n[2]){
+            p->type = types[i].type;
+            break;
+        }
+    }
+    switch(p->type){
+        case NMEA_RMC:
+            d->timevalid = d->rmcvalid = d->datevalid = 0;
+        break;
+        case NMEA_GGA:
+            d->timevalid = d->fixquality = d->satused = 0;
+        break;
+        case NMEA_ZDA:
+            d->timevalid = d->datevalid = 0;
+            d->day = d->month = 0; d->year = 0;
+        break;
+        case NMEA_GSA:
+            d->fixmode = d->gsasats = 0;
+        break;
+        default:
+        break;
+    }
+}
+
+// numeric field without garbage?
+#define NUMERIC(f)  ((f)->len && !(f)->nondigit)
+
+// hhmmss[.sss]
+static void settime(nmea_data *d, const nmea_field *f){
+    if(!NUMERIC(f) || f->len < 6) return;
+    uint32_t v = f->ival;
+    uint8_t H = (uint8_t)(v / 10000), M = (uint8_t)((v / 100) % 100), S = (uint8_t)(v % 100);
+    if(H > 23 || M > 59 || S > 60) return; // 60 - leap second
+    uint16_t ms = f->frac;
+    for(uint8_t i = f->nfrac; i < 3; ++i) ms *= 10;
+    d->H = H; d->M = M; d->S = S; d->ms = ms;
+    d->timevalid = 1;
+}
+
+// ddmmyy of RMC
+static void setdate(nmea_data *d, const nmea_field *f){
+    if(!NUMERIC(f) || f->len != 6) return;
+    uint32_t v = f->ival;
+    d->day = (uint8_t)(v / 10000);
+    d->month = (uint8_t)((v / 100) % 100);
+    d->year = (uint16_t)(2000 + v % 100);
+    d->datevalid = (d->day > 0 && d->day < 32 && d->month > 0 && d->month < 13);
+}
+
+static uint8_t getu8(const nmea_field *f){
+    if(!NUMERIC(f) || f->ival > 255) return 0;
+    return (uint8_t)f->ival;
+}
+
+/*
+ * Fields used:
+ * $--RMC,hhmmss.sss,A,lat,N,lon,E,spd,cog,ddmmyy,mv,mvE,mode*cs
+ *        1          2                     9
+ * $--GGA,hhmmss.sss,lat,N,lon,E,quality,nsat,hdop,alt,M,geoid,M,age,station*cs
+ *        1                      6       7
+ * $--ZDA,hhmmss.sss,dd,mm,yyyy,zh,zm*cs
+ *        1          2  3  4
+ * $--GSA,mode,fix,prn1,...,prn12,pdop,hdop,vdop*cs
+ *             2   3        14
+ */
+static void fieldend(nmea_parser *p){
+    nmea_field *f = &p->fld;
+    nmea_data *d = &p->tmp;
+    uint8_t N = p->nfield;
+    if(N == 0) gettype(p);
+    else switch(p->type){
+        case NMEA_RMC:
+            if(N == 1) settime(d, f);
+            else if(N == 2) d->rmcvalid = (f->first == 'A');
+            else if(N == 9) setdate(d, f);
+        break;
+        case NMEA_GGA:
+            if(N == 1) settime(d, f);
+            else if(N == 6) d->fixquality = getu8(f);
+            else if(N == 7) d->satused = getu8(f);
+        break;
+        case NMEA_ZDA:
+            if(N == 1) settime(d, f);
+            else if(N == 2) d->day = getu8(f);
+            else if(N == 3) d->month = getu8(f);
+            else if(N == 4){
+                if(NUMERIC(f) && f->ival < 65536) d->year = (uint16_t)f->ival;
+                d->datevalid = (d->day > 0 && d->day < 32 && d->month > 0 && d->month < 13 && d->year);
+            }
+        break;
+        case NMEA_GSA:
+            if(N == 2) d->fixmode = getu8(f);
+            else if(N > 2 && N < 15 && f->len) ++d->gsasats;
+        break;
+        default:
+        break;
+    }
+    if(N < 255) p->nfield = N + 1;
+    memset(f, 0, sizeof(nmea_field));
+}
+
+static void fieldchar(nmea_parser *p, char c){
+    nmea_field *f = &p->fld;
+    if(p->nfield == 0 && f->len < 5) p->addr[f->len] = c;
+    if(f->len++ == 0) f->first = c;
+    if(c >= '0' && c <= '9'){
+        if(f->dot){
+            if(f->nfrac < 3){
+                f->frac = (uint16_t)(f->frac * 10 + c - '0');
+                ++f->nfrac;
+            }
+        }else f->ival = f->ival * 10 + (uint32_t)(c - '0');
+    }else if(c == '.' && !f->dot) f->dot = 1;
+    else f->nondigit = 1;
+}
+
+/**
+ * @brief nmea_putc - put next symbol into parser
+ * @param p - parser
+ * @param c - symbol
+ * @return type of sentence if this symbol completes good sentence (its values are in p->data), else NMEA_NONE
+ */
+nmea_type nmea_putc(nmea_parser *p, char c){
+    int x;
+    if(c == '$'){ // start of new sentence
+        if(p->state != ST_IDLE) ++p->stat.syntax; // previous wasn't finished
+        p->state = ST_DATA;
+        p->tmp = p->data;
+        p->type = NMEA_NONE;
+        p->nfield = p->len = p->cs = 0;
+        memset(&p->fld, 0, sizeof(nmea_field));
+        return NMEA_NONE;
+    }
+    switch(p->state){
+        case ST_DATA:
+            if(c == '*'){
+                fieldend(p);
+                p->state = ST_CS1;
+                break;
+            }
+            if(c < ' ' || c > '~'){ // EOL before checksum or garbage
+                ++p->stat.syntax;
+                p->state = ST_IDLE;
+                break;
+            }
+            if(++p->len > NMEA_MAXLEN){
+                ++p->stat.toolong;
+                p->state = ST_IDLE;
+                break;
+            }
+            p->cs ^= (uint8_t)c;
+            if(c == ',') fieldend(p);
+            else fieldchar(p, c);
+        break;
+        case ST_CS1:
+        case ST_CS2:
+            x = hex2u(c);
+            if(x < 0){
+                ++p->stat.syntax;
+                p->state = ST_IDLE;
+                break;
+            }
+            if(p->state == ST_CS1){
+                p->rcs = (uint8_t)(x << 4);
+                p->state = ST_CS2;
+                break;
+            }
+            p->rcs |= (uint8_t)x;
+            p->state = ST_IDLE;
+            if(p->rcs != p->cs){
+                ++p->stat.badcs;
+                break;
+            }
+            ++p->stat.good;
+            if(p->type == NMEA_OTHER){
+                ++p->stat.other;
+                return NMEA_OTHER;
+            }
+            p->data = p->tmp;
+            return p->type;
+        default: // ST_IDLE: skip everything till '$'
+        break;
+    }
+    return NMEA_NONE;
+}
@@ -0,0 +1,93 @@
+/*
+ * This file is part of the chronometer project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef NMEA_H__
+#define NMEA_H__
+
+#include <stdint.h>
+
+/*
+ * Incremental NMEA-0183 parser: fed by one byte, doesn't store sentence at all.
+ * Each field is converted to number while receiving, checksum is calculated
+ * on the fly; values of sentence are applied to `data` only if its checksum is right.
+ * Any '$' restarts parser, so it resyncs after garbage or lost bytes.
+ */
+
+// max length of sentence between '$' and '*' (standard: 82 with "$", "*hh\r\n")
+#define NMEA_MAXLEN     (100)
+
+typedef enum{
+    NMEA_NONE,      // sentence isn't ready yet (or was rejected)
+    NMEA_RMC,
+    NMEA_GGA,
+    NMEA_ZDA,
+    NMEA_GSA,
+    NMEA_OTHER      // good checksum, but sentence isn't supported (e.g. proprietary)
+} nmea_type;
+
+typedef struct{
+    uint8_t H, M, S;    // UTC time of last sentence with time field
+    uint16_t ms;        // and its fractional part (milliseconds)
+    uint8_t timevalid;  // ==1 if time field of last sentence wasn't empty
+    uint8_t rmcvalid;   // RMC status: 1 - 'A' (valid), 0 - 'V'
+    uint8_t day, month; // date (RMC or ZDA)
+    uint16_t year;
+    uint8_t datevalid;
+    uint8_t fixquality; // GGA: 0 - invalid, 1 - GPS, 2 - DGPS, 6 - estimated etc
+    uint8_t satused;    // GGA: satellites in use
+    uint8_t fixmode;    // GSA: 1 - no fix, 2 - 2D, 3 - 3D
+    uint8_t gsasats;    // GSA: amount of PRNs used in solution
+} nmea_data;
+
+typedef struct{
+    uint32_t good;      // sentences with right checksum
+    uint32_t badcs;     // wrong checksum
+    uint32_t syntax;    // bad symbols, no checksum
+    uint32_t toolong;   // longer than NMEA_MAXLEN
+    uint32_t other;     // unsupported sentences (with good checksum)
+} nmea_stat;
+
+// current field
+typedef struct{
+    uint32_t ival;      // all digits before '.'
+    uint16_t frac;      // first three digits after '.'
+    uint8_t nfrac;      // amount of digits in `frac`
+    uint8_t len;        // field length
+    uint8_t dot;        // ==1 after '.'
+    uint8_t nondigit;   // ==1 if there was any symbol except digits and '.'
+    char first;         // first symbol of field
+} nmea_field;
+
+typedef struct{
+    nmea_data data;     // values of last good sentences
+    nmea_data tmp;      // values of current sentence
+    nmea_stat stat;
+    nmea_field fld;
+    char addr[6];       // address field (talker + type), e.g. "GPRMC"
+    nmea_type type;     // type of current sentence
+    uint8_t state;
+    uint8_t nfield;     // current field number (0 - address)
+    uint8_t len;        // current sentence length
+    uint8_t cs;         // calculated checksum
+    uint8_t rcs;        // received checksum
+} nmea_parser;
+
+void nmea_init(nmea_parser *p);
+nmea_type nmea_putc(nmea_parser *p, char c);
+
+#endif // NMEA_H__
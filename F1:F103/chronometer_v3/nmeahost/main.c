@@ -0,0 +1,347 @@
+/*
+ * This file is part of the chronometer project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host checker of NMEA parser (../nmea.c): decode GPS streams comparing with expected results,
+// corrupt them checking that exactly damaged sentences are rejected, benchmark
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../nmea.h"
+
+static const char *tnames[] = {"NONE", "RMC", "GGA", "ZDA", "GSA", "OTHER"};
+
+// result of sentence and offsets of its first ('$') and last byte in stream
+typedef struct{
+    size_t start;
+    size_t offset;
+    nmea_type type;
+    nmea_data data;
+} result;
+
+static uint8_t *readfile(const char *name, size_t *len){
+    FILE *f = fopen(name, "r");
+    if(!f){ perror(name); exit(1); }
+    size_t sz = 65536, n = 0, l;
+    uint8_t *buf = malloc(sz);
+    while((l = fread(buf + n, 1, sz - n, f)) > 0){
+        n += l;
+        if(n == sz){
+            sz *= 2;
+            buf = realloc(buf, sz);
+        }
+    }
+    fclose(f);
+    *len = n;
+    return buf;
+}
+
+/**
+ * @brief corrupt - damage stream without changing its length (so offsets of sentences are the same)
+ * @param buf - data
+ * @param len - its length
+ * @param rate - probability of damage for each byte
+ * @param mask (o) - ==1 for changed bytes
+ * @return amount of damaged bytes
+ */
+static size_t corrupt(uint8_t *buf, size_t len, double rate, uint8_t *mask){
+    size_t n = 0;
+    for(size_t i = 0; i < len; ++i){
+        mask[i] = 0;
+        if(drand48() >= rate) continue;
+        uint8_t old = buf[i];
+        if(drand48() < 0.5) buf[i] ^= (uint8_t)(1 << (lrand48() & 7)); // single bit error
+        else buf[i] = (uint8_t)lrand48(); // random byte
+        if(buf[i] == old) continue;
+        mask[i] = 1;
+        ++n;
+    }
+    return n;
+}
+
+// parse whole buffer, store results (if `res` isn't NULL); @return amount of results
+static size_t parse(nmea_parser *p, const uint8_t *buf, size_t len, result *res){
+    size_t n = 0, start = 0;
+    for(size_t i = 0; i < len; ++i){
+        if(buf[i] == '$') start = i;
+        nmea_type t = nmea_putc(p, (char)buf[i]);
+        if(t == NMEA_NONE) continue;
+        if(res){
+            res[n].start = start;
+            res[n].offset = i;
+            res[n].type = t;
+            res[n].data = p->data;
+        }
+        ++n;
+    }
+    return n;
+}
+
+static void printres(FILE *f, const result *r){
+    const nmea_data *d = &r->data;
+    fprintf(f, "%-5s ", tnames[r->type]);
+    switch(r->type){
+        case NMEA_RMC:
+        case NMEA_GGA:
+        case NMEA_ZDA:
+            if(d->timevalid) fprintf(f, "%02u:%02u:%02u.%03u", d->H, d->M, d->S, d->ms);
+            else fprintf(f, "--:--:--.---");
+        break;
+        default:
+        break;
+    }
+    switch(r->type){
+        case NMEA_RMC:
+            fprintf(f, " %s", d->rmcvalid ? "valid" : "not valid");
+            // fall through
+        case NMEA_ZDA:
+            if(d->datevalid) fprintf(f, " %02u.%02u.%04u", d->day, d->month, d->year);
+        break;
+        case NMEA_GGA:
+            fprintf(f, " quality=%u, satellites=%u", d->fixquality, d->satused);
+        break;
+        case NMEA_GSA:
+            fprintf(f, "mode=%uD, PRNs=%u", d->fixmode, d->gsasats);
+        break;
+        default:
+        break;
+    }
+    fprintf(f, "\n");
+}
+
+static void printstat(FILE *f, const nmea_stat *s){
+    fprintf(f, "good: %u (unsupported: %u), bad checksum: %u, syntax errors: %u, too long: %u\n",
+               s->good, s->other, s->badcs, s->syntax, s->toolong);
+}
+
+static double dtime(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// copy only values given by sentence of type `t` (others stay from previous sentences)
+static void ownfields(nmea_type t, const nmea_data *d, nmea_data *o){
+    memset(o, 0, sizeof(nmea_data));
+    switch(t){
+        case NMEA_RMC:
+            o->rmcvalid = d->rmcvalid;
+            // fall through
+        case NMEA_ZDA:
+            o->day = d->day; o->month = d->month; o->year = d->year; o->datevalid = d->datevalid;
+            // fall through
+        case NMEA_GGA:
+            o->H = d->H; o->M = d->M; o->S = d->S; o->ms = d->ms; o->timevalid = d->timevalid;
+            if(t != NMEA_GGA) break;
+            o->fixquality = d->fixquality; o->satused = d->satused;
+        break;
+        case NMEA_GSA:
+            o->fixmode = d->fixmode; o->gsasats = d->gsasats;
+        break;
+        default:
+        break;
+    }
+}
+
+// compare results of damaged stream with clean one; @return amount of wrong sentences accepted
+static size_t falseaccepted(const result *clean, size_t nclean, const result *dmg, size_t ndmg){
+    size_t j = 0, bad = 0;
+    for(size_t i = 0; i < ndmg; ++i){
+        while(j < nclean && clean[j].offset < dmg[i].offset) ++j;
+        int wrong = (j == nclean || clean[j].offset != dmg[i].offset || clean[j].type != dmg[i].type);
+        if(!wrong){
+            nmea_data c, d;
+            ownfields(clean[j].type, &clean[j].data, &c);
+            ownfields(dmg[i].type, &dmg[i].data, &d);
+            wrong = memcmp(&c, &d, sizeof(nmea_data));
+        }
+        if(wrong){
+            ++bad;
+            printf("False accepted @%zu: ", dmg[i].offset);
+            printres(stdout, &dmg[i]);
+        }
+    }
+    return bad;
+}
+
+// does sentence buf[start..end] have right checksum (damage wasn't detectable)?
+static int goodcs(const uint8_t *buf, size_t start, size_t end){
+    if(end < start + 3 || buf[end - 2] != '*') return 0;
+    uint8_t cs = 0;
+    for(size_t i = start + 1; i < end - 2; ++i){
+        if(buf[i] < ' ' || buf[i] > '~' || buf[i] == '$') return 0;
+        cs ^= buf[i];
+    }
+    char h[3] = {(char)buf[end - 1], (char)buf[end], 0}, *e;
+    return (strtoul(h, &e, 16) == cs && *e == 0);
+}
+
+/**
+ * @brief chkrejected - check that all sentences with damaged bytes and only they were rejected
+ * (except damaged sentences with right checksum: NMEA checksum can't detect them)
+ * @return amount of errors
+ */
+static size_t chkrejected(const uint8_t *buf, const uint8_t *mask, const result *clean, size_t nclean,
+                          const result *dmg, size_t ndmg){
+    size_t j = 0, ndamaged = 0, nrej = 0, nundet = 0, bad = 0;
+    for(size_t i = 0; i < nclean; ++i){
+        int damaged = 0;
+        for(size_t k = clean[i].start; k <= clean[i].offset && !damaged; ++k) damaged = mask[k];
+        while(j < ndmg && dmg[j].offset < clean[i].offset) ++j;
+        int accepted = (j < ndmg && dmg[j].offset == clean[i].offset);
+        ndamaged += damaged;
+        if(!accepted) ++nrej;
+        if(damaged && accepted){
+            if(goodcs(buf, clean[i].start, clean[i].offset)) ++nundet;
+            else{
+                printf("Damaged sentence with wrong checksum accepted @%zu\n", clean[i].offset);
+                ++bad;
+            }
+        }else if(!damaged && !accepted){
+            printf("Good sentence rejected @%zu\n", clean[i].offset);
+            ++bad;
+        }
+    }
+    printf("%zu sentences damaged, %zu rejected, %zu damages undetectable by checksum\n", ndamaged, nrej, nundet);
+    return bad;
+}
+
+/**
+ * @brief chkexpected - compare decoded sentences and statistics with expected
+ * @param name - file with expected `-d` output (without line of sizes)
+ * @return amount of different lines
+ */
+static size_t chkexpected(const char *name, const result *res, size_t N, const nmea_stat *st){
+    char *out;
+    size_t outlen, elen, bad = 0, line = 0;
+    FILE *f = open_memstream(&out, &outlen);
+    for(size_t i = 0; i < N; ++i) printres(f, &res[i]);
+    printstat(f, st);
+    fclose(f);
+    char *exp = (char*)readfile(name, &elen);
+    exp = realloc(exp, elen + 1);
+    exp[elen] = 0;
+    char *o = out, *e = exp;
+    while(*o || *e){ // compare line by line ignoring trailing spaces
+        char *oe = strchr(o, '\n'), *ee = strchr(e, '\n');
+        if(!oe) oe = o + strlen(o);
+        if(!ee) ee = e + strlen(e);
+        size_t ol = oe - o, el = ee - e;
+        while(ol && o[ol - 1] == ' ') --ol;
+        while(el && e[el - 1] == ' ') --el;
+        ++line;
+        if(ol != el || strncmp(o, e, ol)){
+            if(bad++ < 10) printf("Line %zu: got '%.*s', expected '%.*s'\n", line, (int)ol, o, (int)el, e);
+        }
+        o = *oe ? oe + 1 : oe;
+        e = *ee ? ee + 1 : ee;
+    }
+    printf("%s: %zu lines, %zu differ\n", name, line, bad);
+    free(out);
+    free(exp);
+    return bad;
+}
+
+static void usage(const char *self){
+    fprintf(stderr, "Usage: %s [-d | -b] [-e file.expect] [-r rate] [-s seed] [-n iterations] file.nmea\n", self);
+    fprintf(stderr, "\t-d - print all decoded sentences\n");
+    fprintf(stderr, "\t-e - compare decoded sentences and statistics with file (`-d` output without first line)\n");
+    fprintf(stderr, "\t-b - benchmark: parse file `iterations` times (default 1000)\n");
+    fprintf(stderr, "\t-r - corrupt each byte with given probability and check that no wrong data was accepted\n");
+    fprintf(stderr, "\t     and all damaged sentences were rejected\n");
+    fprintf(stderr, "\t-s - seed for random generator\n");
+    exit(1);
+}
+
+int main(int argc, char **argv){
+    int opt, niter = 1000, verbose = 0, bench = 0;
+    double rate = 0.;
+    long seed = 1;
+    const char *expected = NULL;
+    while((opt = getopt(argc, argv, "de:br:s:n:")) != -1){
+        switch(opt){
+            case 'd':
+                verbose = 1;
+            break;
+            case 'e':
+                expected = optarg;
+            break;
+            case 'b':
+                bench = 1;
+            break;
+            case 'r':
+                rate = atof(optarg);
+                if(rate < 0. || rate > 1.) usage(argv[0]);
+            break;
+            case 's':
+                seed = atol(optarg);
+            break;
+            case 'n':
+                niter = atoi(optarg);
+                if(niter < 1) usage(argv[0]);
+            break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if(optind != argc - 1) usage(argv[0]);
+    srand48(seed);
+    size_t len;
+    uint8_t *buf = readfile(argv[optind], &len);
+    // shortest possible sentence is "$*hh"
+    result *clean = malloc((len / 4 + 1) * sizeof(result));
+    nmea_parser p;
+    nmea_init(&p);
+    size_t N = parse(&p, buf, len, clean);
+    printf("%zu bytes, %zu sentences\n", len, N);
+    printstat(stdout, &p.stat);
+    if(verbose) for(size_t i = 0; i < N; ++i) printres(stdout, &clean[i]);
+    int ret = 0;
+    if(expected && chkexpected(expected, clean, N, &p.stat)) ret = 2;
+    if(rate > 0.){
+        result *dmg = malloc((len / 4 + 1) * sizeof(result));
+        uint8_t *mask = malloc(len);
+        size_t nd = corrupt(buf, len, rate, mask);
+        nmea_init(&p);
+        size_t Nd = parse(&p, buf, len, dmg);
+        printf("Damaged %zu bytes, %zu sentences accepted\n", nd, Nd);
+        printstat(stdout, &p.stat);
+        size_t bad = falseaccepted(clean, N, dmg, Nd);
+        printf("%zu false accepted\n", bad);
+        bad += chkrejected(buf, mask, clean, N, dmg, Nd);
+        if(bad) ret = 2;
+        free(mask);
+        free(dmg);
+    }
+    if(bench){
+        nmea_init(&p);
+        size_t n = 0;
+        double t0 = dtime();
+        for(int i = 0; i < niter; ++i) n += parse(&p, buf, len, NULL);
+        double t = dtime() - t0;
+        double nb = (double)len * niter;
+        printf("%d iterations: %.3g bytes/s (%.2f ns/byte), %.3g sentences/s\n", niter, nb/t, t/nb*1e9, n/t);
+    }
+    free(clean);
+    free(buf);
+    if(expected || rate > 0.) printf("%s\n", ret ? "FAILED" : "OK");
+    return ret;
+}
@@ -0,0 +1,148 @@
+/*
+ * This file is part of the chronometer project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "pps.h"
+
+void pps_init(pps_t *p){
+    memset(p, 0, sizeof(pps_t));
+    p->freq = (uint32_t)PPS_NOMFREQ << PPS_Q;
+}
+
+void pps_clrstat(pps_t *p){
+    p->npulses = p->nbad = p->nmissed = p->nstat = 0;
+    p->resmin = p->resmax = 0;
+    p->ressq = 0;
+}
+
+// restart frequency acquisition
+static void restart(pps_t *p){
+    p->ngood = 0;
+    p->nbadrow = 0;
+    p->freq = (uint32_t)PPS_NOMFREQ << PPS_Q;
+}
+
+// take `cap` as new reference pulse
+static void setref(pps_t *p, uint32_t cap){
+    p->prevcap = p->lastcap;
+    p->lastcap = cap;
+    p->started = 1;
+}
+
+/**
+ * @brief pps_update - process next PPS
+ * Rejected pulse doesn't replace reference (last good pulse), so next good pulse is measured
+ * from reference; after PPS_MAXBAD rejections in a row reference is considered wrong.
+ * @param p - filter
+ * @param cap - counter value captured by PPS
+ * @return result of measurement (PPS_FIRST - pulse is new reference)
+ */
+ppsres_t pps_update(pps_t *p, uint32_t cap){
+    ++p->npulses;
+    if(!p->started){
+        setref(p, cap);
+        return PPS_FIRST;
+    }
+    uint32_t N = cap - p->lastcap;
+    uint32_t f = p->freq >> PPS_Q, maxdev = p->ngood ? PPS_MAXDEV : PPS_ACQDEV;
+    // amount of seconds between pulses
+    uint32_t k = (N + f / 2) / f;
+    if(k < 1 || k > PPS_MAXMISS){ // too short or too long interval
+        ++p->nbad;
+        if(k > PPS_MAXMISS){ // long pause: start measurement from this pulse
+            restart(p);
+            setref(p, cap);
+            return PPS_FIRST;
+        }
+        goto bad;
+    }
+    int32_t meas = (int32_t)(((uint64_t)N << PPS_Q) / k);
+    int32_t res = meas - (int32_t)p->freq;
+    if(res > (int32_t)(maxdev << PPS_Q) || res < -(int32_t)(maxdev << PPS_Q)){
+        ++p->nbad;
+        goto bad;
+    }
+    setref(p, cap);
+    p->nmissed += k - 1;
+    p->nbadrow = 0;
+    if(p->ngood == 0) p->freq = (uint32_t)meas;
+    else{
+        uint32_t n = (p->ngood < PPS_AVERN) ? p->ngood + 1 : PPS_AVERN;
+        p->freq = (uint32_t)((int32_t)p->freq + res / (int32_t)n);
+    }
+    if(pps_locked(p)){ // statistics only for stable frequency
+        if(p->nstat == 0 || res < p->resmin) p->resmin = res;
+        if(p->nstat == 0 || res > p->resmax) p->resmax = res;
+        p->ressq += (uint64_t)((int64_t)res * res);
+        ++p->nstat;
+    }
+    ++p->ngood;
+    return PPS_GOOD;
+bad:
+    if(++p->nbadrow >= PPS_MAXBAD){ // maybe reference was wrong
+        restart(p);
+        setref(p, cap);
+        return PPS_FIRST;
+    }
+    return PPS_BAD;
+}
+
+/**
+ * @brief pps_ticks2us - convert counter ticks into microseconds
+ * @param p - filter
+ * @param ticks - amount of ticks (e.g. from last PPS)
+ * @return microseconds
+ */
+uint32_t pps_ticks2us(const pps_t *p, uint32_t ticks){
+    return (uint32_t)(((((uint64_t)ticks * 1000000) << PPS_Q) + p->freq / 2) / p->freq);
+}
+
+// Q4 ticks -> ns
+static int32_t q2ns(const pps_t *p, int32_t res){
+    return (int32_t)(((int64_t)res * 1000000000) / (int64_t)p->freq);
+}
+
+static uint32_t isqrt(uint64_t x){
+    uint64_t r = 0, bit = 1ULL << 62;
+    while(bit > x) bit >>= 2;
+    while(bit){
+        if(x >= r + bit){
+            x -= r + bit;
+            r = (r >> 1) + bit;
+        }else r >>= 1;
+        bit >>= 2;
+    }
+    return (uint32_t)r;
+}
+
+/**
+ * @brief pps_getjitter - get statistics of residuals
+ * @param p - filter
+ * @param j (o) - min, max and RMS of residuals in nanoseconds
+ */
+void pps_getjitter(const pps_t *p, pps_jitter_t *j){
+    if(!p->nstat){
+        j->min = j->max = 0;
+        j->rms = 0;
+        return;
+    }
+    j->min = q2ns(p, p->resmin);
+    j->max = q2ns(p, p->resmax);
+    j->rms = (uint32_t)q2ns(p, (int32_t)isqrt(p->ressq / p->nstat));
+}
@@ -0,0 +1,86 @@
+/*
+ * This file is part of the chronometer project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifndef PPS_H__
+#define PPS_H__
+
+#include <stdint.h>
+
+/*
+ * Hardware-independent PPS disciplining of free-running 32-bit counter:
+ * estimates counter ticks per second by PPS captures (averaging for first
+ * PPS_AVERN seconds, then exponential filter), rejects outliers and
+ * keeps statistics of residuals (PPS jitter + counter clock wander).
+ */
+
+// nominal counter frequency (ticks per second)
+#define PPS_NOMFREQ     (72000000)
+// fractional bits of frequency and residuals
+#define PPS_Q           (4)
+// max deviation of first measured second from nominal (500ppm)
+#define PPS_ACQDEV      (PPS_NOMFREQ / 2000)
+// max deviation of next seconds from current estimate (20ppm)
+#define PPS_MAXDEV      (PPS_NOMFREQ / 50000)
+// amount of seconds for plain averaging, then freq += (meas - freq) / PPS_AVERN
+#define PPS_AVERN       (16)
+// amount of good seconds to consider frequency valid
+#define PPS_LOCKCNT     (4)
+// restart acquisition after this amount of bad seconds in a row
+#define PPS_MAXBAD      (3)
+// max amount of missed pulses between two good
+#define PPS_MAXMISS     (5)
+
+typedef enum{
+    PPS_FIRST,          // new reference pulse (first, after long pause or after bad ones): nothing to measure
+    PPS_GOOD,           // measurement accepted
+    PPS_BAD             // measurement rejected
+} ppsres_t;
+
+typedef struct{
+    uint32_t lastcap;   // counter value @ last PPS
+    uint32_t prevcap;   // and @ previous PPS
+    uint32_t freq;      // estimated ticks per second, Q4
+    uint32_t ngood;     // good measurements since acquisition start
+    uint8_t nbadrow;    // bad measurements in a row
+    uint8_t started;    // ==1 if `lastcap` is valid
+    // statistics
+    uint32_t npulses;   // total amount of pulses
+    uint32_t nbad;      // rejected
+    uint32_t nmissed;   // missed pulses (detected by gaps of 2..PPS_MAXMISS seconds)
+    uint32_t nstat;     // amount of residuals in statistics
+    int32_t resmin;     // min/max residuals (Q4 ticks)
+    int32_t resmax;
+    uint64_t ressq;     // sum of squared residuals
+} pps_t;
+
+// statistics in nanoseconds
+typedef struct{
+    int32_t min;
+    int32_t max;
+    uint32_t rms;
+} pps_jitter_t;
+
+#define pps_locked(p)   ((p)->ngood >= PPS_LOCKCNT)
+
+void pps_init(pps_t *p);
+ppsres_t pps_update(pps_t *p, uint32_t cap);
+uint32_t pps_ticks2us(const pps_t *p, uint32_t ticks);
+void pps_getjitter(const pps_t *p, pps_jitter_t *j);
+void pps_clrstat(pps_t *p);
+
+#endif // PPS_H__
@@ -0,0 +1,240 @@
+/*
+ * This file is part of the chronometer project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host checker of PPS filter (../pps.c) by synthetic PPS sequences: counter with frequency offset and drift
+// (starting from random value, so it wraps), gaussian PPS jitter, missing pulses, long pauses,
+// spurious pulses and shifted pulses.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+#include "../pps.h"
+
+#define NSECONDS    (3600)
+// PPS jitter, seconds
+#define JITTER      (30e-9)
+// allowed error of frequency (ppm) and of pps_ticks2us() (us)
+#define MAXPPM      (0.1)
+#define MAXUSERR    (1)
+
+typedef struct{
+    double base;        // counter value @ start of current second (from c0)
+    double F;           // current frequency (ticks per second)
+    double drift;       // its change per second
+    uint32_t c0;        // starting value of counter
+} sim_t;
+
+static double gauss(){
+    return sqrt(-2. * log(drand48() + 1e-12)) * cos(2. * M_PI * drand48());
+}
+
+// counter frequency: offset up to 300ppm and drift up to 1ppm per hour
+static void siminit(sim_t *s){
+    s->base = 0.;
+    s->F = PPS_NOMFREQ * (1. + (drand48() - 0.5) * 600e-6);
+    s->drift = PPS_NOMFREQ * (drand48() - 0.5) * 2e-6 / NSECONDS;
+    s->c0 = (uint32_t)lrand48();
+}
+
+static void simnext(sim_t *s){
+    s->base += s->F;
+    s->F += s->drift;
+}
+
+// counter value at `dt` seconds from current second start
+static uint32_t simcap(const sim_t *s, double dt){
+    return s->c0 + (uint32_t)(uint64_t)floor(s->base + s->F * dt);
+}
+
+// true pulse (with jitter)
+static uint32_t pulse(const sim_t *s){
+    return simcap(s, JITTER * gauss());
+}
+
+// check frequency estimate and ticks->us conversion; @return 0 if OK
+static int chkfreq(const pps_t *p, const sim_t *s){
+    double F = (double)p->freq / (1 << PPS_Q), err = (F - s->F) / s->F * 1e6;
+    if(fabs(err) > MAXPPM){
+        if(verbose) printf("\tfrequency error %.3fppm\n", err);
+        return 1;
+    }
+    for(int i = 0; i < 10; ++i){
+        uint32_t d = (uint32_t)(drand48() * s->F);
+        double us = pps_ticks2us(p, d), tus = d / s->F * 1e6;
+        if(fabs(us - tus) > MAXUSERR){
+            if(verbose) printf("\t%u ticks -> %gus instead of %gus\n", d, us, tus);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// check statistics of residuals: should be near jitter of difference of two pulses; @return 0 if OK
+static int chkjitter(const pps_t *p){
+    pps_jitter_t j;
+    pps_getjitter(p, &j);
+    double sigma = JITTER * 1e9, q = 1e9 / PPS_NOMFREQ; // jitter and quantization (ns)
+    if(verbose > 1) printf("\tresiduals: min=%dns, max=%dns, rms=%uns (%u measurements)\n", j.min, j.max, j.rms, p->nstat);
+    if(p->nstat == 0 || j.rms < sigma || j.rms > 3. * sigma) return 1;
+    // difference of two pulses has jitter sigma*sqrt(2)
+    if(j.min < -8. * M_SQRT2 * sigma - q || j.max > 8. * M_SQRT2 * sigma + q) return 1;
+    return 0;
+}
+
+// clean sequence: all pulses accepted, fast lock, accurate frequency
+static int chkclean(){
+    int bad = 0;
+    for(int r = 0; r < 10 && !bad; ++r){
+        pps_t p;
+        sim_t s;
+        pps_init(&p);
+        siminit(&s);
+        bad |= pps_update(&p, pulse(&s)) != PPS_FIRST;
+        for(int i = 1; i < NSECONDS && !bad; ++i){
+            simnext(&s);
+            if(pps_update(&p, pulse(&s)) != PPS_GOOD){
+                if(verbose) printf("\tsecond %d: rejected\n", i);
+                bad = 1;
+            }
+            if(i == PPS_LOCKCNT) bad |= !pps_locked(&p);
+            if(i > 2 * PPS_AVERN) bad |= chkfreq(&p, &s);
+        }
+        bad |= p.nbad != 0 || p.nmissed != 0 || chkjitter(&p);
+    }
+    return chkfail("clean PPS", bad);
+}
+
+// missing pulses: gaps up to PPS_MAXMISS seconds are counted and don't break lock,
+// longer gap restarts acquisition
+static int chkmissing(){
+    int bad = 0;
+    for(int r = 0; r < 10 && !bad; ++r){
+        pps_t p;
+        sim_t s;
+        pps_init(&p);
+        siminit(&s);
+        pps_update(&p, pulse(&s));
+        uint32_t missed = 0, lastgood = 0;
+        for(int i = 1; i < NSECONDS && !bad; ++i){
+            simnext(&s);
+            if(i > 10 && i % 600 == 0){ // long pause
+                for(int j = 0; j < 2 * PPS_MAXMISS; ++j) simnext(&s);
+                bad |= pps_update(&p, pulse(&s)) != PPS_FIRST || pps_locked(&p);
+                lastgood = i;
+                continue;
+            }
+            if(i > 1 && drand48() < 0.05){ // 1..PPS_MAXMISS-1 pulses lost
+                int n = 1 + lrand48() % (PPS_MAXMISS - 1);
+                for(int j = 0; j < n; ++j) simnext(&s);
+                missed += n;
+            }
+            if(pps_update(&p, pulse(&s)) != PPS_GOOD){
+                if(verbose) printf("\tsecond %d: rejected\n", i);
+                bad = 1;
+            }
+            if(i - lastgood > 2 * PPS_AVERN) bad |= chkfreq(&p, &s);
+        }
+        if(p.nmissed != missed || p.nbad != NSECONDS / 600 - 1){
+            if(verbose) printf("\tmissed: %u instead of %u, bad: %u\n", p.nmissed, missed, p.nbad);
+            bad = 1;
+        }
+        bad |= chkjitter(&p);
+    }
+    return chkfail("missing pulses", bad);
+}
+
+// outliers: spurious pulses inside second and true pulses shifted by 50..500us are rejected
+// and don't break lock, statistics and measurement of next pulse
+static int chkoutliers(){
+    int bad = 0;
+    for(int r = 0; r < 10 && !bad; ++r){
+        pps_t p;
+        sim_t s;
+        pps_init(&p);
+        siminit(&s);
+        pps_update(&p, pulse(&s));
+        uint32_t nout = 0, missed = 0;
+        for(int i = 1; i < NSECONDS && !bad; ++i){
+            int locked = pps_locked(&p), n = 0;
+            if(i > PPS_LOCKCNT && drand48() < 0.05){ // spurious pulses, up to PPS_MAXBAD-1 in a row
+                n = 1 + lrand48() % (PPS_MAXBAD - 1);
+                for(int j = 0; j < n; ++j){
+                    bad |= pps_update(&p, simcap(&s, 0.01 + 0.98 * drand48())) != PPS_BAD;
+                    ++nout;
+                }
+            }
+            simnext(&s);
+            if(i > PPS_LOCKCNT && n == 0 && drand48() < 0.02){ // shifted pulse: rejected and counted as missed
+                double sh = (50e-6 + 450e-6 * drand48()) * (drand48() < 0.5 ? -1. : 1.);
+                bad |= pps_update(&p, simcap(&s, sh)) != PPS_BAD;
+                ++nout; ++missed;
+                simnext(&s);
+                ++i;
+            }
+            if(pps_update(&p, pulse(&s)) != PPS_GOOD){
+                if(verbose) printf("\tsecond %d: rejected\n", i);
+                bad = 1;
+            }
+            if(locked && !pps_locked(&p)) bad = 1;
+            if(i > 2 * PPS_AVERN) bad |= chkfreq(&p, &s);
+        }
+        if(p.nbad != nout || p.nmissed != missed){
+            if(verbose) printf("\tbad: %u instead of %u, missed: %u instead of %u\n", p.nbad, nout, p.nmissed, missed);
+            bad = 1;
+        }
+        bad |= chkjitter(&p);
+    }
+    return chkfail("outliers", bad);
+}
+
+// wrong reference (first pulse is spurious): acquisition restarts after PPS_MAXBAD rejections
+static int chkbadref(){
+    int bad = 0;
+    for(int r = 0; r < 100 && !bad; ++r){
+        pps_t p;
+        sim_t s;
+        pps_init(&p);
+        siminit(&s);
+        bad |= pps_update(&p, simcap(&s, 0.1 + 0.8 * drand48())) != PPS_FIRST;
+        int i;
+        for(i = 1; i < PPS_MAXBAD; ++i){
+            simnext(&s);
+            bad |= pps_update(&p, pulse(&s)) != PPS_BAD;
+        }
+        simnext(&s);
+        bad |= pps_update(&p, pulse(&s)) != PPS_FIRST;
+        for(i = 0; i < PPS_LOCKCNT; ++i){
+            simnext(&s);
+            bad |= pps_update(&p, pulse(&s)) != PPS_GOOD;
+        }
+        bad |= !pps_locked(&p);
+    }
+    return chkfail("wrong reference", bad);
+}
+
+int main(int argc, char **argv){
+    hosttest_opts(argc, argv);
+    int ret = chkclean();
+    ret |= chkmissing();
+    ret |= chkoutliers();
+    ret |= chkbadref();
+    return hosttest_result(ret);
+}
@@ -23,6 +23,7 @@
 #include "fonts.h"
 #include "hardware.h"
 #include "lidar.h"
+#include "pps.h"
 #include "screen.h"
 #include "str.h"
 #include "time.h"
@@ -74,14 +75,13 @@ char *getchr(const char *str, char symbol){
 
 #define sendu(x) do{sendstring(u2str(x));}while(0)
 
-/*
 static void sendi(int32_t I){
     if(I < 0){
         sendchar('-');
         I = -I;
     }
     sendstring(u2str((uint32_t)I));
-}*/
+}
 
 // echo '1' if true or '0' if false
 static void checkflag(uint8_t f){
@@ -116,9 +116,47 @@ static void showuserconf(){
     sendstring("\nLIDAR=");
     checkflag(!(f & FLAG_NOLIDAR));
     sendstring("\nEVTLEN="); sendu(the_conf.ledshow_time);
+    sendstring("\nLIDHYST="); sendu(the_conf.lidar_hyst);
+    sendstring("\nLIDMEDIAN="); sendu(the_conf.lidar_median);
     sendstring("\n"); // <-- sendstring @ the end to initialize data transmission
 }
 
+/**
+ * @brief showppsstat - show PPS disciplining state and jitter statistics
+ */
+static void showppsstat(){
+    pps_jitter_t j;
+    pps_getjitter(&pps, &j);
+    sendstring("PPSLOCKED="); checkflag(pps_locked(&pps));
+    sendstring("\nPPSFREQ="); sendu(pps.freq >> PPS_Q);
+    // fractional part: 4 digits
+    uint32_t frac = (pps.freq & ((1<<PPS_Q)-1)) * (10000 >> PPS_Q);
+    sendchar('.');
+    for(uint32_t d = 1000; d > frac && d > 1; d /= 10) sendchar('0');
+    sendu(frac);
+    sendstring("\nPPSPULSES="); sendu(pps.npulses);
+    sendstring("\nPPSBAD="); sendu(pps.nbad);
+    sendstring("\nPPSMISSED="); sendu(pps.nmissed);
+    sendstring("\nJITTERN="); sendu(pps.nstat);
+    sendstring("\nJITTERMIN="); sendi(j.min);
+    sendstring("\nJITTERMAX="); sendi(j.max);
+    sendstring("\nJITTERRMS="); sendu(j.rms);
+    sendstring("\n");
+}
+
+/**
+ * @brief showlidstat - show LIDAR decoder statistics
+ */
+static void showlidstat(){
+    sendstring("LIDFPS="); sendu(lidar_fps);
+    sendstring("\nLIDFRAMES="); sendu(lidar.stat.frames);
+    sendstring("\nLIDBADCS="); sendu(lidar.stat.badcs);
+    sendstring("\nLIDSKIPPED="); sendu(lidar.stat.skipped);
+    sendstring("\nLIDWEAK="); sendu(lidar.stat.weak);
+    sendstring("\nLIDRINGOVR="); sendu(lidar_ringovr);
+    sendstring("\n");
+}
+
 extern uint8_t USB_connected; // need to reset USB
 /**
  * @brief parse_USBCMD - parsing of string buffer got by USB
@@ -154,6 +192,9 @@ void parse_CMD(char *cmd){
                     CMD_LEDS        "S - turn leds on/off (1/0)\n"
                     CMD_LIDAR       "S - switch between LIDAR (1) or command TTY (0)\n"
                     CMD_LIDARSPEED  "N - set LIDAR speed to N\n"
+                    CMD_LIDHYST     "N - LIDAR trigger hysteresis (cm)\n"
+                    CMD_LIDMEDIAN   "N - LIDAR median filter length (odd, 1..15)\n"
+                    CMD_LIDSTAT     "C - LIDAR frames statistics; C - clear\n"
                     CMD_GETMCUTEMP  " - MCU temperature\n"
                     CMD_MESG        " str - show 'str' at display (no more than 7 chars)\n"
                     CMD_DUMPN       "N - dump Nth log & show on screen (-N - Nth from last)\n"
@@ -169,6 +210,7 @@ void parse_CMD(char *cmd){
                     CMD_STORECONF   " - store new configuration in flash\n"
                     CMD_STORTEST    " - add test trigger event record into flash\n"
                     CMD_STREND      "C - string ends with \\n (C=n) or \\r\\n (C=r)\n"
+                    CMD_PPSSTAT     "C - PPS disciplining state and jitter (ns); C - clear statistics\n"
                     CMD_PRINTTIME   " - print current time\n"
                     CMD_TRIGLVL     "NS - working trigger N level S\n"
                     CMD_TRGPAUSE    "NP - pause (P, ms) after trigger N shots\n"
@@ -305,6 +347,13 @@ void parse_CMD(char *cmd){
             sendstring(", PPS working\n");
         else
             sendstring(", no PPS\n");
+        const nmea_data *d = &GPS_parser.data;
+        sendstring("FIXQUALITY="); sendu(d->fixquality);
+        sendstring("\nSATUSED="); sendu(d->satused);
+        sendstring("\nFIXMODE="); sendu(d->fixmode);
+        sendstring("\nNMEAGOOD="); sendu(GPS_parser.stat.good);
+        sendstring("\nNMEABAD="); sendu(GPS_parser.stat.badcs + GPS_parser.stat.syntax + GPS_parser.stat.toolong);
+        sendstring("\n");
     }else if(CMP(cmd, CMD_USARTSPD) == 0){ // USART speed
         GETNUM(CMD_USARTSPD);
         if(N < 400 || N > 3000000) goto bad_number;
@@ -405,11 +454,13 @@ void parse_CMD(char *cmd){
         succeed = 1;
     }else if(CMP(cmd, CMD_CURDIST) == 0){ // current LIDAR distance
         sendstring("DIST=");
-        sendu(last_lidar_dist);
+        sendu(lidar.dist);
         sendstring("\nSTREN=");
-        sendu(last_lidar_stren);
+        sendu(lidar.stren);
+        sendstring("\nMEDIAN=");
+        sendu(lidar.median);
         sendstring("\nTRIGDIST=");
-        sendu(lidar_triggered_dist);
+        sendu(lidar.trigdist);
         sendstring("\nTms=");
         sendu(Tms);
         sendstring("\nshotms=");
@@ -539,6 +590,34 @@ void parse_CMD(char *cmd){
     }else if(CMP(cmd, CMD_DUMPN) == 0){ // dump Nth event
         if(getnum(cmd+sizeof(CMD_DUMPN)-1, &N)) N = -1; // default - last
         if(dump_log(N, 1)) sendstring("Wrong index!\n");
+    }else if(CMP(cmd, CMD_PPSSTAT) == 0){ // PPS statistics
+        char c = cmd[sizeof(CMD_PPSSTAT) - 1];
+        if(c == 'c' || c == 'C'){
+            pps_clrstat(&pps);
+            succeed = 1;
+        }else showppsstat();
+    }else if(CMP(cmd, CMD_LIDHYST) == 0){ // LIDAR hysteresis
+        GETNUM(CMD_LIDHYST);
+        if(N < 0 || N > 1000) goto bad_number;
+        if(the_conf.lidar_hyst != (uint16_t)N){
+            the_conf.lidar_hyst = (uint16_t)N;
+            conf_modified = 1;
+        }
+        succeed = 1;
+    }else if(CMP(cmd, CMD_LIDMEDIAN) == 0){ // LIDAR median length
+        GETNUM(CMD_LIDMEDIAN);
+        if(N < 1 || N > LIDAR_MEDIAN_MAX || !(N & 1)) goto bad_number;
+        if(the_conf.lidar_median != (uint8_t)N){
+            the_conf.lidar_median = (uint8_t)N;
+            conf_modified = 1;
+        }
+        succeed = 1;
+    }else if(CMP(cmd, CMD_LIDSTAT) == 0){ // LIDAR statistics
+        char c = cmd[sizeof(CMD_LIDSTAT) - 1];
+        if(c == 'c' || c == 'C'){
+            lidar_clrstat();
+            succeed = 1;
+        }else showlidstat();
     }else if(CMP(cmd, CMD_SQUEAK) == 0){ // make a short squeak
         buzzer_squeak();
     }else{
@@ -565,7 +644,7 @@ void parse_CMD(char *cmd){
  * @return string with data
  */
 char *get_trigger_shot(int number, const event_log *logdata){
-    static char buf[64];
+    static char buf[96];
     char *bptr = buf;
     if(number > -1){
         bptr = strcp(bptr, u2str(number));
@@ -581,7 +660,7 @@ char *get_trigger_shot(int number, const event_log *logdata){
     }
     *bptr++ = '=';
     IWDG->KR = IWDG_REFRESH;
-    bptr = strcp(bptr, get_time(&logdata->shottime.Time, logdata->shottime.millis));
+    bptr = strcp(bptr, get_time_us(&logdata->shottime.Time, logdata->shottime.millis, logdata->shottime.micros));
     bptr = strcp(bptr, ", len=");
     if(logdata->triglen < 0) bptr = strcp(bptr, ">1s");
     else bptr = strcp(bptr, u2str((uint32_t) logdata->triglen));
@@ -605,7 +684,7 @@ void show_trigger_shot(uint8_t tshot){
         else continue;
         lastTtrig = Tms;
         lastLog.trigno = i;
-        if(i == LIDAR_TRIGGER) lastLog.lidar_dist = lidar_triggered_dist;
+        if(i == LIDAR_TRIGGER) lastLog.lidar_dist = lidar.trigdist;
         lastLog.shottime = shottime[i];
         lastLog.triglen = triglen[i];
         sendstring(get_trigger_shot(-1, &lastLog));
@@ -48,8 +48,12 @@
 #define CMD_LEDS        "leds"
 #define CMD_LIDAR       "lidar"
 #define CMD_LIDARSPEED  "lidspd"
+#define CMD_LIDHYST     "lidhyst"
+#define CMD_LIDMEDIAN   "lidmed"
+#define CMD_LIDSTAT     "lidstat"
 #define CMD_MESG        "mesg"
 #define CMD_NFREE       "nfree"
+#define CMD_PPSSTAT     "ppsstat"
 #define CMD_PRINTTIME   "time"
 #define CMD_RESET       "reset"
 #define CMD_SAVEEVTS    "se"
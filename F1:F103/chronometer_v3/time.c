@@ -27,21 +27,15 @@
 volatile uint32_t Timer; // milliseconds counter
 curtime current_time = TMNOTINI;
 
-// convert two-digit decimal string into number
-static inline uint8_t atou(const char *b){
-    return (uint8_t)((b[0]-'0')*10 + b[1]-'0');
-}
-
 /**
  * @brief set_time - set current time from GPS data
- * @param buf - buffer with time data (HHMMSS)
+ * @param H, M, S - UTC time
  */
-void set_time(const char *buf){
-    uint8_t H = atou(buf);// + TIMEZONE_GMT_PLUS;
-    if(H > 23) H -= 24;
+void set_time(uint8_t H, uint8_t M, uint8_t S){
+    if(S > 59) S = 59; // leap second
     current_time.H = H;
-    current_time.M = atou(&buf[2]);
-    current_time.S = atou(&buf[4]);
+    current_time.M = M;
+    current_time.S = S;
 /*
 #ifdef EBUG
     SEND("set_time, Tms: "); printu(1, Tms);
@@ -98,14 +92,22 @@ static void ms2str(char **str, uint32_t T){
     *str = bptr;
 }
 
-/**
- * print time: Tm - time structure, T - milliseconds
- */
-char *get_time(const curtime *Tm, uint32_t T){
+// add three digits of microseconds
+static void us2str(char **str, int32_t us){
+    if(us < 0) return;
+    char *bptr = *str;
+    *bptr++ = (char)(us/100 + '0');
+    us %= 100;
+    *bptr++ = (char)(us/10 + '0');
+    *bptr++ = (char)(us%10 + '0');
+    *str = bptr;
+}
+
+static char *gettm(const curtime *Tm, uint32_t T, int32_t us){
     static char buf[64];
     char *bstart = &buf[5], *bptr = bstart;
     int S = 0;
-    if(T > 999) return "Wrong time";
+    if(T > 999 || us > 999) return "Wrong time";
     if(Tm->S < 60 && Tm->M < 60 && Tm->H < 24)
         S = Tm->S + Tm->H*3600 + Tm->M*60; // seconds from day beginning
     if(!S) *(--bstart) = '0';
@@ -115,12 +117,14 @@ char *get_time(const curtime *Tm, uint32_t T){
     }
     // now bstart is buffer starting index; bptr points to decimal point
     ms2str(&bptr, T);
+    us2str(&bptr, us);
     // put current time in HH:MM:SS format into buf
     *bptr++ = ' '; *bptr++ = '(';
     bptr = puttwo(Tm->H, bptr); *bptr++ = ':';
     bptr = puttwo(Tm->M, bptr); *bptr++ = ':';
     bptr = puttwo(Tm->S, bptr);
     ms2str(&bptr, T);
+    us2str(&bptr, us);
     *bptr++ = ')';
     if(GPS_status == GPS_NOTFOUND){
         strcpy(bptr, " GPS not found");
@@ -130,6 +134,24 @@ char *get_time(const curtime *Tm, uint32_t T){
     return bstart;
 }
 
+/**
+ * print time: Tm - time structure, T - milliseconds
+ */
+char *get_time(const curtime *Tm, uint32_t T){
+    return gettm(Tm, T, -1);
+}
+
+/**
+ * @brief get_time_us - the same as get_time, but with microseconds
+ * @param Tm - time structure
+ * @param T - milliseconds
+ * @param us - microseconds
+ * @return string allocated here
+ */
+char *get_time_us(const curtime *Tm, uint32_t T, uint16_t us){
+    return gettm(Tm, T, us);
+}
+
 /**
  * @brief get_scrntime - the same as get_time, but for screen (HH:MM:SS.S)
  * @param T - time structure
@@ -58,8 +58,9 @@ extern uint32_t trigger_ms[];
 extern volatile int need_sync;
 
 char *get_time(const curtime *T, uint32_t m);
+char *get_time_us(const curtime *Tm, uint32_t T, uint16_t us);
 char *get_scrntime(const curtime *T, uint32_t m);
-void set_time(const char *buf);
+void set_time(uint8_t H, uint8_t M, uint8_t S);
 void time_increment();
 void systick_correction();
 
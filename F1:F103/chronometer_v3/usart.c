@@ -236,29 +236,9 @@ void usart3_isr(){
         usart_isr(3, USART3);
         return;
     }
-    // LIDAR - check for different things
+    // LIDAR - put data into ring buffer
     IWDG->KR = IWDG_REFRESH;
-    if(USART3->SR & USART_SR_RXNE){ // RX not emty - receive next char
-        char rb = (char)USART3->DR;
-        uint8_t L = idatalen[3][rbufno[3]];
-        if(rb != LIDAR_FRAME_HEADER && (L == 0 || L == 1)){ // bad starting sequence
-            idatalen[3][rbufno[3]] = 0;
-            return;
-        }
-        if(L < LIDAR_FRAME_LEN){ // put next char into buf
-            rbuf[3][rbufno[3]][idatalen[3][rbufno[3]]++] = rb;
-            if(L == LIDAR_FRAME_LEN-1){ // got LIDAR_FRAME_LEN bytes - line ready
-                linerdy[3] = 1;
-                dlen[3] = idatalen[3][rbufno[3]];
-                recvdata[3] = rbuf[3][rbufno[3]];
-                // prepare other buffer
-                rbufno[3] = !rbufno[3];
-                idatalen[3][rbufno[3]] = 0;
-            }
-        }else{ // buffer overrun
-            idatalen[3][rbufno[3]] = 0;
-        }
-    }
+    if(USART3->SR & USART_SR_RXNE) lidar_putbyte((uint8_t)USART3->DR);
 }
 
 // print 32bit unsigned int
@@ -0,0 +1,114 @@
+/*
+ * This file is part of the ws2815 project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "effects.h"
+#include "hsv.h"
+
+eff_params eff = {
+    .effect = EFF_RAINBOW,
+    .hue1 = 0,
+    .hue2 = 170,
+    .sat = 255,
+    .val = 127,
+    .speed = 11,
+    .length = 43,
+    .fps = 100,
+    .npal = 4,
+    .palette = {0, 43, 85, 170},
+};
+
+// hue between h1 and h2 by shortest arc, frac = 0..255
+static uint8_t huemix(uint8_t h1, uint8_t h2, uint32_t frac){
+    int32_t d = (int8_t)(h2 - h1);
+    return (uint8_t)(h1 + ((d * (int32_t)frac) >> 8));
+}
+
+static void rainbow(uint32_t *buf, uint16_t n, uint32_t frame){
+    uint8_t h0 = eff.hue1 + ((frame * eff.speed) >> 4);
+    for(uint16_t i = 0; i < n; ++i)
+        buf[i] = hsv2grb8(h0 + (i * eff.length) / n, eff.sat, eff.val);
+}
+
+static void gradient(uint32_t *buf, uint16_t n, uint32_t frame){
+    uint32_t span = (uint8_t)(eff.hue2 - eff.hue1), len = 2*n*16;
+    uint32_t x = (frame * eff.speed) % len;
+    for(uint16_t i = 0; i < n; ++i, x += 16){
+        if(x >= len) x -= len;
+        uint32_t t = (x < len/2) ? x : len - x; // 0..n*16 and back
+        buf[i] = hsv2grb8(eff.hue1 + (span * t) / (n*16), eff.sat, eff.val);
+    }
+}
+
+static void chase(uint32_t *buf, uint16_t n, uint32_t frame){
+    uint32_t len = n*16, head = (frame * eff.speed) % len, tail = eff.length * 16;
+    if(tail == 0) tail = 16;
+    for(uint16_t i = 0; i < n; ++i){
+        uint32_t d = (head + len - i*16) % len; // distance behind head
+        if(d < tail) buf[i] = hsv2grb8(eff.hue1, eff.sat, (eff.val * (tail - d)) / tail);
+        else buf[i] = 0;
+    }
+}
+
+static void fade(uint32_t *buf, uint16_t n, uint32_t frame){
+    uint32_t x = (frame * eff.speed) >> 4;
+    uint32_t l = x & 0x1ff;
+    if(l > 255) l = 511 - l;
+    uint32_t c = hsv2grb8((x & 0x200) ? eff.hue2 : eff.hue1, eff.sat, (eff.val * l) / 255);
+    for(uint16_t i = 0; i < n; ++i) buf[i] = c;
+}
+
+static void palette(uint32_t *buf, uint16_t n, uint32_t frame){
+    uint32_t np = eff.npal, len = n*16;
+    if(np == 0) np = 1;
+    else if(np > EFF_PALMAX) np = EFF_PALMAX;
+    uint32_t x = (frame * eff.speed) % len;
+    for(uint16_t i = 0; i < n; ++i, x += 16){
+        if(x >= len) x -= len;
+        uint32_t pos = x * np; // position in palette, 1/len units
+        uint32_t idx = pos / len, nxt = idx + 1;
+        if(nxt == np) nxt = 0;
+        uint32_t frac = ((pos % len) << 8) / len;
+        buf[i] = hsv2grb8(huemix(eff.palette[idx], eff.palette[nxt], frac), eff.sat, eff.val);
+    }
+}
+
+/**
+ * @brief eff_render - render one frame of current effect
+ * @param buf - GRB buffer
+ * @param n - its length (amount of LEDs)
+ * @param frame - frame number
+ */
+void eff_render(uint32_t *buf, uint16_t n, uint32_t frame){
+    if(n == 0) return;
+    switch(eff.effect){
+        case EFF_GRADIENT:
+            gradient(buf, n, frame);
+        break;
+        case EFF_CHASE:
+            chase(buf, n, frame);
+        break;
+        case EFF_FADE:
+            fade(buf, n, frame);
+        break;
+        case EFF_PALETTE:
+            palette(buf, n, frame);
+        break;
+        default:
+            rainbow(buf, n, frame);
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ * This file is part of the ws2815 project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef EFFECTS_H__
+#define EFFECTS_H__
+
+#include <stdint.h>
+
+/*
+ * Hardware-independent effects engine: renders frame number `frame` of current effect
+ * into GRB buffer; colors are made by hsv2grb8() (hue & gamma lookup tables).
+ * Speed is given in 1/16 of step per frame: step is one pixel for moving effects,
+ * one hue unit for rainbow and one brightness unit for fade.
+ */
+
+// max amount of colors in palette
+#define EFF_PALMAX      (8)
+// frame rate limits, Hz
+#define EFF_FPSMIN      (1)
+#define EFF_FPSMAX      (100)
+
+typedef enum{
+    EFF_RAINBOW,        // running rainbow: `length` hue units along strip starting from hue1
+    EFF_GRADIENT,       // gradient from hue1 to hue2 and back, moving along strip
+    EFF_CHASE,          // running spot of `length` pixels with fading tail, color hue1
+    EFF_FADE,           // whole strip fades in/out, changing color hue1<->hue2 each time
+    EFF_PALETTE,        // palette colors interpolated along strip, cycling
+    EFF_AMOUNT
+} eff_type;
+
+typedef struct{
+    uint8_t effect;     // eff_type
+    uint8_t hue1;       // hues, 0..255
+    uint8_t hue2;
+    uint8_t sat;        // saturation, 0..255
+    uint8_t val;        // value (brightness), 0..255
+    uint8_t speed;      // 1/16 of step per frame
+    uint8_t length;     // rainbow: hue span; chase: spot length
+    uint8_t fps;        // frame rate
+    uint8_t npal;       // amount of colors in palette
+    uint8_t palette[EFF_PALMAX];
+} eff_params;
+
+extern eff_params eff;
+
+void eff_render(uint32_t *buf, uint16_t n, uint32_t frame);
+
+#endif // EFFECTS_H__
@@ -0,0 +1,263 @@
+/*
+ * This file is part of the ws2815 project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host renderer of effects (../effects.c): saves frames as PPM image (one row per frame)
+// and checks lookup tables against floating point HSV conversion and effects' geometry
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+#include "../effects.h"
+#include "../hsv.h"
+
+#define NMAX    (1024)
+
+static uint8_t R(uint32_t c){ return (c >> 8) & 0xff; }
+static uint8_t G(uint32_t c){ return c & 0xff; }
+static uint8_t B(uint32_t c){ return (c >> 16) & 0xff; }
+
+static int chkgamma(){
+    int bad = (gamma8[0] != 0 || gamma8[255] != 255);
+    for(int i = 1; i < 256; ++i){
+        if(gamma8[i] < gamma8[i-1]) bad = 1;
+        if(abs(gamma8[i] - (int)lround(255. * pow(i / 255., 2.2))) > 0) bad = 1;
+    }
+    return chkfail("gamma", bad);
+}
+
+// compare hsv2grb8 with floating point hexcone model
+static int chkhsv(){
+    int bad = 0, emax = 0;
+    for(int h = 0; h < 256; ++h) for(int s = 0; s < 256; s += 15) for(int v = 0; v < 256; v += 15){
+        double H = h * 6. / 256., S = s / 255., V = v / 255., rgb[3];
+        int sec = (int)H;
+        double f = H - sec, c[6][3] = {{1,f,0},{1-f,1,0},{0,1,f},{0,1-f,1},{f,0,1},{1,0,1-f}};
+        for(int i = 0; i < 3; ++i){
+            double x = (1. - S * (1. - c[sec][i])) * V;
+            rgb[i] = 255. * pow(x, 2.2);
+        }
+        uint32_t grb = hsv2grb8(h, s, v);
+        int e[3] = {abs(R(grb) - (int)lround(rgb[0])), abs(G(grb) - (int)lround(rgb[1])), abs(B(grb) - (int)lround(rgb[2]))};
+        for(int i = 0; i < 3; ++i) if(e[i] > emax){
+            emax = e[i];
+            if(emax > 6 && !bad){
+                printf("h=%d, s=%d, v=%d: %d/%d/%d instead of %.1f/%.1f/%.1f\n", h, s, v,
+                       R(grb), G(grb), B(grb), rgb[0], rgb[1], rgb[2]);
+                bad = 1;
+            }
+        }
+    }
+    if(hsv2grb(0, 100, 100) != GRB(255, 0, 0) || hsv2grb(120, 100, 100) != GRB(0, 255, 0)
+       || hsv2grb(240, 100, 100) != GRB(0, 0, 255) || hsv2grb(77, 0, 100) != GRB(255, 255, 255)
+       || hsv2grb(200, 100, 0) != 0) bad = 1;
+    printf("max LUT error: %d\n", emax);
+    return chkfail("hsv", bad);
+}
+
+// brightest pixel
+static int maxpix(const uint32_t *buf, int n){
+    int imax = 0, max = -1;
+    for(int i = 0; i < n; ++i){
+        int l = R(buf[i]) + G(buf[i]) + B(buf[i]);
+        if(l > max){ max = l; imax = i; }
+    }
+    return imax;
+}
+
+// render with canary after buffer end
+static int render(uint32_t *buf, int n, uint32_t frame){
+    buf[n] = 0xdeadbeef;
+    eff_render(buf, n, frame);
+    return buf[n] != 0xdeadbeef;
+}
+
+static int chkeffects(int n){
+    uint32_t buf[NMAX+1];
+    eff_params old = eff;
+    int bad = 0;
+    // all effects: no buffer overrun, colors fit into 24 bits
+    for(int e = 0; e < EFF_AMOUNT; ++e){
+        eff.effect = e;
+        for(uint32_t f = 0; f < 2000; f += 7){
+            if(render(buf, n, f)) bad = 1;
+            for(int i = 0; i < n; ++i) if(buf[i] & 0xff000000) bad = 1;
+        }
+    }
+    bad = chkfail("bounds", bad);
+    // chase: head moves one pixel per frame with speed 16
+    int b = 0;
+    eff.effect = EFF_CHASE; eff.speed = 16; eff.length = 5; eff.val = 255;
+    for(uint32_t f = 0; f < 3 * (uint32_t)n; ++f){
+        render(buf, n, f);
+        if(maxpix(buf, n) != (int)(f % n)) b = 1;
+        int lit = 0;
+        for(int i = 0; i < n; ++i) if(buf[i]) ++lit;
+        if(lit > eff.length) b = 1;
+    }
+    bad |= chkfail("chase", b);
+    // fade: dark at start, full brightness of hue1 at half of period, hue2 in next period
+    b = 0;
+    eff.effect = EFF_FADE; eff.speed = 16; eff.hue1 = 0; eff.hue2 = 85;
+    render(buf, n, 0);
+    for(int i = 0; i < n; ++i) if(buf[i]) b = 1;
+    render(buf, n, 255);
+    for(int i = 0; i < n; ++i) if(buf[i] != hsv2grb8(0, eff.sat, 255)) b = 1;
+    render(buf, n, 512 + 255);
+    if(buf[0] != hsv2grb8(85, eff.sat, 255)) b = 1;
+    bad |= chkfail("fade", b);
+    // palette: each palette color at its place, pattern shifts by one pixel with speed 16
+    b = 0;
+    eff.effect = EFF_PALETTE; eff.npal = 4;
+    uint8_t pal[4] = {0, 64, 128, 192};
+    memcpy(eff.palette, pal, 4);
+    render(buf, n, 0);
+    for(int i = 0; i < 4; ++i) if(buf[i * n / 4] != hsv2grb8(pal[i], eff.sat, eff.val)) b = 1;
+    uint32_t buf1[NMAX+1];
+    render(buf1, n, 1);
+    for(int i = 0; i < n - 1; ++i) if(buf1[i] != buf[i+1]) b = 1;
+    bad |= chkfail("palette", b);
+    // gradient: hue1 at start, hue2 at end
+    b = 0;
+    eff.effect = EFF_GRADIENT; eff.hue1 = 10; eff.hue2 = 100;
+    render(buf, n, 0);
+    if(buf[0] != hsv2grb8(10, eff.sat, eff.val)) b = 1;
+    if(abs((int)G(buf[n-1]) - (int)G(hsv2grb8(100, eff.sat, eff.val))) > 8) b = 1;
+    bad |= chkfail("gradient", b);
+    eff = old;
+    return bad;
+}
+
+// render time of one frame, us
+static double rendertime(int n){
+    uint32_t buf[NMAX+1];
+    double tmax = 0.;
+    for(int e = 0; e < EFF_AMOUNT; ++e){
+        eff.effect = e;
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for(uint32_t f = 0; f < 10000; ++f) eff_render(buf, n, f);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double t = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / 1e7;
+        printf("effect %d: %.2f us per frame\n", e, t);
+        if(t > tmax) tmax = t;
+    }
+    return tmax;
+}
+
+// one row per frame, each LED is `zoom` pixels width
+static int saveppm(const char *name, int n, int nframes, int zoom){
+    FILE *f = fopen(name, "w");
+    if(!f){
+        perror(name);
+        return 1;
+    }
+    uint32_t buf[NMAX+1];
+    fprintf(f, "P6\n%d %d\n255\n", n * zoom, nframes);
+    for(int fr = 0; fr < nframes; ++fr){
+        eff_render(buf, n, fr);
+        for(int i = 0; i < n; ++i) for(int z = 0; z < zoom; ++z){
+            uint8_t rgb[3] = {R(buf[i]), G(buf[i]), B(buf[i])};
+            fwrite(rgb, 3, 1, f);
+        }
+    }
+    fclose(f);
+    printf("%s: %d frames of effect %d\n", name, nframes, eff.effect);
+    return 0;
+}
+
+static void usage(const char *self){
+    fprintf(stderr, "Usage: %s [options]\n", self);
+    fprintf(stderr, "\t-n - amount of LEDs (8..%d, default 60)\n", NMAX);
+    fprintf(stderr, "\t-o - save frames into this PPM file\n");
+    fprintf(stderr, "\t-N - amount of frames in image (default 500)\n");
+    fprintf(stderr, "\t-z - width of one LED in image, pixels (default 4)\n");
+    fprintf(stderr, "\t-e - effect (0..%d)\n", EFF_AMOUNT - 1);
+    fprintf(stderr, "\t-x - speed\n");
+    fprintf(stderr, "\t-l - length\n");
+    fprintf(stderr, "\t-h, -H - hue1 and hue2\n");
+    fprintf(stderr, "\t-P - palette (comma-separated hues)\n");
+    exit(1);
+}
+
+static uint8_t u8arg(const char *self){
+    int x = atoi(optarg);
+    if(x < 0 || x > 255) usage(self);
+    return x;
+}
+
+int main(int argc, char **argv){
+    int opt, n = 60, nframes = 500, zoom = 4;
+    char *out = NULL;
+    while((opt = getopt(argc, argv, "n:o:N:z:e:x:l:h:H:P:")) != -1){
+        switch(opt){
+            case 'n':
+                n = atoi(optarg);
+                if(n < 8 || n > NMAX) usage(argv[0]);
+            break;
+            case 'o':
+                out = optarg;
+            break;
+            case 'N':
+                nframes = atoi(optarg);
+                if(nframes < 1) usage(argv[0]);
+            break;
+            case 'z':
+                zoom = atoi(optarg);
+                if(zoom < 1 || zoom > 64) usage(argv[0]);
+            break;
+            case 'e':
+                eff.effect = u8arg(argv[0]);
+                if(eff.effect >= EFF_AMOUNT) usage(argv[0]);
+            break;
+            case 'x':
+                eff.speed = u8arg(argv[0]);
+            break;
+            case 'l':
+                eff.length = u8arg(argv[0]);
+            break;
+            case 'h':
+                eff.hue1 = u8arg(argv[0]);
+            break;
+            case 'H':
+                eff.hue2 = u8arg(argv[0]);
+            break;
+            case 'P':
+                eff.npal = 0;
+                for(char *tok = strtok(optarg, ","); tok; tok = strtok(NULL, ",")){
+                    int h = atoi(tok);
+                    if(eff.npal == EFF_PALMAX || h < 0 || h > 255) usage(argv[0]);
+                    eff.palette[eff.npal++] = h;
+                }
+                if(eff.npal == 0) usage(argv[0]);
+            break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if(out) return saveppm(out, n, nframes, zoom);
+    int ret = chkgamma();
+    ret |= chkhsv();
+    ret |= chkeffects(n);
+    rendertime(n);
+    return hosttest_result(ret);
+}
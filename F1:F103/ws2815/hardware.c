@@ -83,3 +83,13 @@ void iwdg_setup(){
     while(IWDG->SR){if(--tmout == 0) break;}
     IWDG->KR = IWDG_REFRESH;
 }
+
+// current time in microseconds (SysTick ticks each 1ms)
+uint32_t getus(){
+    uint32_t ms, val;
+    do{
+        ms = Tms;
+        val = SysTick->VAL;
+    }while(ms != Tms);
+    return ms * 1000 + (SysTick->LOAD - val) / ((SysTick->LOAD + 1) / 1000);
+}
@@ -54,11 +54,14 @@ extern DMA_TypeDef * const WS2815DMA;
 // DMA interrupt
 #define WSDMAISR    dma1_channel5_isr
 
+extern volatile uint32_t Tms;
+
 void hw_setup();
 void iwdg_setup();
 void startdata();
 void stopdata();
 void startreset();
 void sendones();
+uint32_t getus();
 
 #endif // __HARDWARE_H__
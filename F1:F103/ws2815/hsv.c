@@ -18,6 +18,79 @@
 
 #include "hsv.h"
 
+// gamma correction (2.2) of LED brightness
+const uint8_t gamma8[256] = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+      3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+      6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+     12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+     20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+     30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,
+     42,  43,  43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,
+     56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+     73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,  87,  88,  89,  90,
+     91,  93,  94,  95,  97,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+    113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+    137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+    163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+    192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255,
+};
+
+// r, g, b of pure colors (S=V=255) for 8-bit hue (256 == 360 degrees)
+static const uint8_t hue8[256][3] = {
+    {255,  0,  0}, {255,  6,  0}, {255, 12,  0}, {255, 18,  0}, {255, 24,  0}, {255, 30,  0}, {255, 36,  0}, {255, 42,  0},
+    {255, 48,  0}, {255, 54,  0}, {255, 60,  0}, {255, 66,  0}, {255, 72,  0}, {255, 78,  0}, {255, 84,  0}, {255, 90,  0},
+    {255, 96,  0}, {255,102,  0}, {255,108,  0}, {255,114,  0}, {255,120,  0}, {255,126,  0}, {255,132,  0}, {255,138,  0},
+    {255,144,  0}, {255,150,  0}, {255,156,  0}, {255,162,  0}, {255,168,  0}, {255,174,  0}, {255,180,  0}, {255,186,  0},
+    {255,192,  0}, {255,198,  0}, {255,204,  0}, {255,210,  0}, {255,216,  0}, {255,222,  0}, {255,228,  0}, {255,234,  0},
+    {255,240,  0}, {255,246,  0}, {255,252,  0}, {253,255,  0}, {247,255,  0}, {241,255,  0}, {235,255,  0}, {229,255,  0},
+    {223,255,  0}, {217,255,  0}, {211,255,  0}, {205,255,  0}, {199,255,  0}, {193,255,  0}, {187,255,  0}, {181,255,  0},
+    {175,255,  0}, {169,255,  0}, {163,255,  0}, {157,255,  0}, {151,255,  0}, {145,255,  0}, {139,255,  0}, {133,255,  0},
+    {127,255,  0}, {121,255,  0}, {115,255,  0}, {109,255,  0}, {103,255,  0}, { 97,255,  0}, { 91,255,  0}, { 85,255,  0},
+    { 79,255,  0}, { 73,255,  0}, { 67,255,  0}, { 61,255,  0}, { 55,255,  0}, { 49,255,  0}, { 43,255,  0}, { 37,255,  0},
+    { 31,255,  0}, { 25,255,  0}, { 19,255,  0}, { 13,255,  0}, {  7,255,  0}, {  1,255,  0}, {  0,255,  4}, {  0,255, 10},
+    {  0,255, 16}, {  0,255, 22}, {  0,255, 28}, {  0,255, 34}, {  0,255, 40}, {  0,255, 46}, {  0,255, 52}, {  0,255, 58},
+    {  0,255, 64}, {  0,255, 70}, {  0,255, 76}, {  0,255, 82}, {  0,255, 88}, {  0,255, 94}, {  0,255,100}, {  0,255,106},
+    {  0,255,112}, {  0,255,118}, {  0,255,124}, {  0,255,130}, {  0,255,136}, {  0,255,142}, {  0,255,148}, {  0,255,154},
+    {  0,255,160}, {  0,255,166}, {  0,255,172}, {  0,255,178}, {  0,255,184}, {  0,255,190}, {  0,255,196}, {  0,255,202},
+    {  0,255,208}, {  0,255,214}, {  0,255,220}, {  0,255,226}, {  0,255,232}, {  0,255,238}, {  0,255,244}, {  0,255,250},
+    {  0,255,255}, {  0,249,255}, {  0,243,255}, {  0,237,255}, {  0,231,255}, {  0,225,255}, {  0,219,255}, {  0,213,255},
+    {  0,207,255}, {  0,201,255}, {  0,195,255}, {  0,189,255}, {  0,183,255}, {  0,177,255}, {  0,171,255}, {  0,165,255},
+    {  0,159,255}, {  0,153,255}, {  0,147,255}, {  0,141,255}, {  0,135,255}, {  0,129,255}, {  0,123,255}, {  0,117,255},
+    {  0,111,255}, {  0,105,255}, {  0, 99,255}, {  0, 93,255}, {  0, 87,255}, {  0, 81,255}, {  0, 75,255}, {  0, 69,255},
+    {  0, 63,255}, {  0, 57,255}, {  0, 51,255}, {  0, 45,255}, {  0, 39,255}, {  0, 33,255}, {  0, 27,255}, {  0, 21,255},
+    {  0, 15,255}, {  0,  9,255}, {  0,  3,255}, {  2,  0,255}, {  8,  0,255}, { 14,  0,255}, { 20,  0,255}, { 26,  0,255},
+    { 32,  0,255}, { 38,  0,255}, { 44,  0,255}, { 50,  0,255}, { 56,  0,255}, { 62,  0,255}, { 68,  0,255}, { 74,  0,255},
+    { 80,  0,255}, { 86,  0,255}, { 92,  0,255}, { 98,  0,255}, {104,  0,255}, {110,  0,255}, {116,  0,255}, {122,  0,255},
+    {128,  0,255}, {134,  0,255}, {140,  0,255}, {146,  0,255}, {152,  0,255}, {158,  0,255}, {164,  0,255}, {170,  0,255},
+    {176,  0,255}, {182,  0,255}, {188,  0,255}, {194,  0,255}, {200,  0,255}, {206,  0,255}, {212,  0,255}, {218,  0,255},
+    {224,  0,255}, {230,  0,255}, {236,  0,255}, {242,  0,255}, {248,  0,255}, {254,  0,255}, {255,  0,251}, {255,  0,245},
+    {255,  0,239}, {255,  0,233}, {255,  0,227}, {255,  0,221}, {255,  0,215}, {255,  0,209}, {255,  0,203}, {255,  0,197},
+    {255,  0,191}, {255,  0,185}, {255,  0,179}, {255,  0,173}, {255,  0,167}, {255,  0,161}, {255,  0,155}, {255,  0,149},
+    {255,  0,143}, {255,  0,137}, {255,  0,131}, {255,  0,125}, {255,  0,119}, {255,  0,113}, {255,  0,107}, {255,  0,101},
+    {255,  0, 95}, {255,  0, 89}, {255,  0, 83}, {255,  0, 77}, {255,  0, 71}, {255,  0, 65}, {255,  0, 59}, {255,  0, 53},
+    {255,  0, 47}, {255,  0, 41}, {255,  0, 35}, {255,  0, 29}, {255,  0, 23}, {255,  0, 17}, {255,  0, 11}, {255,  0,  5},
+};
+
+/**
+ * @brief hsv2grb8 - convert HSV to 24bit GRB by lookup tables (with gamma correction)
+ * @param h (0..255) - Hue (256 == 360 degrees)
+ * @param s (0..255) - Saturation
+ * @param v (0..255) - Value
+ * @return 24-bit color
+ */
+uint32_t hsv2grb8(uint8_t h, uint8_t s, uint8_t v){
+    const uint8_t *c = hue8[h];
+    uint8_t rgb[3];
+    for(int i = 0; i < 3; ++i){
+        uint32_t x = 255 - (((255 - c[i]) * (s + 1)) >> 8); // add white
+        rgb[i] = gamma8[(x * (v + 1)) >> 8];
+    }
+    return GRB(rgb[0], rgb[1], rgb[2]);
+}
+
 /**
  * @brief hsv2grb - convert HSV to 24bit GRB
  * @param h (0..359) - Hue in degrees
@@ -27,38 +100,7 @@
  */
 uint32_t hsv2grb(uint16_t h, uint8_t s, uint8_t v){
     if(h > 359) h %= 360;
-    if(s > 100) s %= 101;
-    if(v > 100) v %= 101;
-    int Hi = (h/60) % 6;
-    int Vmin = (100 - s) * v;
-    Vmin /= 100;
-    int a = (v - Vmin) * (h % 60);
-    a /= 60;
-    int Vinc = Vmin + a;
-    int Vdec = v - a;
-    int r, g, b;
-    switch(Hi){
-        case 1:
-            r = Vdec; g = v; b = Vmin;
-        break;
-        case 2:
-            r = Vmin; g = v; b = Vinc;
-        break;
-        case 3:
-            r = Vmin; g = Vdec; b = v;
-        break;
-        case 4:
-            r = Vinc; g = Vmin; b = v;
-        break;
-        case 5:
-            r = v; g = Vmin; b = Vdec;
-        break;
-        default:
-            r = v; g = Vinc; b = Vmin;
-    }
-    // now convert r/g/b from percents to 0..255
-    r = (r*255)/100;
-    g = (g*255)/100;
-    b = (b*255)/100;
-    return ((b<<16) | (r<<8) | g); // little endian!!!
+    if(s > 100) s = 100;
+    if(v > 100) v = 100;
+    return hsv2grb8((h * 256) / 360, (s * 255) / 100, (v * 255) / 100);
 }
@@ -20,8 +20,14 @@
 #ifndef HSV_H__
 #define HSV_H__
 
-#include <stm32f1.h>
+#include <stdint.h>
+
+// pack 8-bit r, g, b into colorbuf word (sent as G, R, B, little endian!!!)
+#define GRB(r, g, b)    (((uint32_t)(b) << 16) | ((uint32_t)(r) << 8) | (uint32_t)(g))
+
+extern const uint8_t gamma8[256];
 
 uint32_t hsv2grb(uint16_t h, uint8_t s, uint8_t v);
+uint32_t hsv2grb8(uint8_t h, uint8_t s, uint8_t v);
 
 #endif // HSV_H__
@@ -21,7 +21,7 @@
 #include "usb.h"
 #include "usb_lib.h"
 #include "ws2815.h"
-#include "hsv.h"
+#include "effects.h"
 
 volatile uint32_t Tms = 0;
 
@@ -50,19 +50,27 @@ char *get_USB(){
     return NULL;
 }
 
-static uint16_t Harray[LEDS_NUM]; // Hue
+// max time of frame transmission; after it ws2815 is restarted even if busy
+#define FRAME_TIMEOUT   (50)
 
-static void rstarray(){
-    rstcounter = 0;
-    for(uint16_t i = 0; i < LEDS_NUM; ++i){
-        Harray[i] = i;
-        ws2815setpix(i, hsv2grb(Harray[i], S, V));
+// render next frame of current effect and send it
+static void nextframe(){
+    if(rstcounter){
+        rstcounter = 0;
+        frameno = 0;
     }
+    uint32_t t0 = getus();
+    eff_render(ws2815colors(), LEDS_NUM, frameno);
+    rendertm = getus() - t0;
+    if(rendertm > rendermax) rendermax = rendertm;
     ws2815start();
+    ++frames;
+    if(!pause) ++frameno;
 }
 
 int main(void){
     uint32_t lastT = 0, lastTc = 0;
+    uint8_t late = 0;
     sysreset();
     StartHSE();
     hw_setup();
@@ -75,24 +83,26 @@ int main(void){
     iwdg_setup();
     USBPU_ON();
 
-    rstarray();
+    nextframe();
     while (1){
         IWDG->KR = IWDG_REFRESH; // refresh watchdog
         if(Tms - lastT > 499){
             LED_blink(LED0);
             lastT = Tms;
         }
-        if(Tms - lastTc > 9){
-            lastTc = Tms;
-            if(rstcounter){
-                rstarray();
-            }else if(!pause){
-                for(uint16_t i = 0; i < LEDS_NUM; ++i){
-                    if(++Harray[i] > 359) Harray[i] = 0;
-                    uint16_t H = Harray[i];
-                       ws2815setpix(i, hsv2grb(H, S, V));
+        // fixed frame rate, next frame is rendered only after previous one is sent
+        uint32_t period = 1000 / eff.fps, dT = Tms - lastTc;
+        if(dT >= period){
+            if(ws2815busy() && dT < period + FRAME_TIMEOUT){
+                if(!late){
+                    late = 1;
+                    ++framelate;
                 }
-                ws2815start();
+            }else{
+                late = 0;
+                if(dT < 2*period) lastTc += period;
+                else lastTc = Tms;
+                nextframe();
             }
         }
         usb_proc();
@@ -16,20 +16,155 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "effects.h"
 #include "proto.h"
 #include "usb.h"
 #include "ws2815.h"
 
 #define USND(str)  do{USB_send((uint8_t*)str, sizeof(str)-1);}while(0)
 
-uint8_t S = 100, V = 50; // saturation and value
 uint8_t pause = 0, rstcounter = 0;
+// frame statistics: current effect frame, frames sent, late frames, render time (last & max), us
+uint32_t frameno = 0, frames = 0, framelate = 0, rendertm = 0, rendermax = 0;
+
+static char ansbuf[256], *aptr;
+
+static void addstr(const char *s){
+    while(*s && aptr < &ansbuf[sizeof(ansbuf)-1]) *aptr++ = *s++;
+    *aptr = 0;
+}
+
+static void addnum(uint32_t u){
+    char buf[11], *p = &buf[10];
+    *p = 0;
+    do{
+        *--p = '0' + u % 10;
+        u /= 10;
+    }while(u);
+    addstr(p);
+}
+
+static void addu(const char *name, uint32_t u){
+    addstr(name); addnum(u); addstr("\n");
+}
+
+/**
+ * @brief getnum - read decimal number
+ * @param str - string (leading spaces are omitted)
+ * @param N (o) - number
+ * @return pointer to first symbol after number or NULL if no number found
+ */
+static const char *getnum(const char *str, uint32_t *N){
+    while(*str == ' ' || *str == '\t') ++str;
+    if(*str < '0' || *str > '9') return NULL;
+    uint32_t n = 0;
+    while(*str >= '0' && *str <= '9'){
+        n = n * 10 + (*str++ - '0');
+        if(n > 0xffff) return NULL;
+    }
+    *N = n;
+    return str;
+}
+
+static const char *showinfo(){
+    aptr = ansbuf;
+    addu("effect=", eff.effect);
+    addu("hue1=", eff.hue1);
+    addu("hue2=", eff.hue2);
+    addu("sat=", eff.sat);
+    addu("val=", eff.val);
+    addu("speed=", eff.speed);
+    addu("length=", eff.length);
+    addu("fps=", eff.fps);
+    addstr("palette=");
+    for(int i = 0; i < eff.npal; ++i){
+        if(i) addstr(",");
+        addnum(eff.palette[i]);
+    }
+    addstr("\n");
+    addu("frame=", frameno);
+    addu("frames=", frames);
+    addu("late=", framelate);
+    addu("rendertime=", rendertm);
+    addu("rendermax=", rendermax);
+    return ansbuf;
+}
+
+// set palette from list of hues
+static const char *setpal(const char *buf){
+    uint8_t pal[EFF_PALMAX];
+    int n = 0;
+    uint32_t N;
+    while((buf = getnum(buf, &N))){
+        if(n == EFF_PALMAX || N > 255) return "Wrong palette\n";
+        pal[n++] = N;
+        while(*buf == ' ' || *buf == ',') ++buf;
+    }
+    if(n == 0) return "Need at least one hue\n";
+    for(int i = 0; i < n; ++i) eff.palette[i] = pal[i];
+    eff.npal = n;
+    return NULL;
+}
+
+// commands with numeric parameter
+static const char *setpar(const char *buf){
+    char cmd = *buf++;
+    if(cmd == 'P') return setpal(buf);
+    uint32_t N;
+    buf = getnum(buf, &N);
+    if(!buf) return "Need number\n";
+    uint32_t max = 255;
+    uint8_t *par;
+    switch(cmd){
+        case 'e':
+            par = &eff.effect;
+            max = EFF_AMOUNT - 1;
+        break;
+        case 'f':
+            if(N < EFF_FPSMIN || N > EFF_FPSMAX) return "Wrong fps\n";
+            par = &eff.fps;
+        break;
+        case 'h':
+            par = &eff.hue1;
+        break;
+        case 'H':
+            par = &eff.hue2;
+        break;
+        case 'l':
+            par = &eff.length;
+        break;
+        case 'S':
+            par = &eff.sat;
+        break;
+        case 'V':
+            par = &eff.val;
+        break;
+        case 'x':
+            par = &eff.speed;
+        break;
+        default:
+            return NULL;
+    }
+    if(N > max) return "Too big\n";
+    *par = N;
+    return NULL;
+}
+
+// step of s/S/v/V (10%)
+#define SVSTEP  (25)
 
 const char *parse_cmd(const char *buf){
-    if(buf[1] != '\n') return buf;
+    if(buf[1] != '\n'){
+        if(buf[1] == ' ' || (buf[1] >= '0' && buf[1] <= '9')) return setpar(buf);
+        return buf;
+    }
     switch(*buf){
         case 'c':
             rstcounter = 1;
+            frames = framelate = rendermax = 0;
+        break;
+        case 'i':
+            return showinfo();
         break;
         case 'p':
             pause = !pause;
@@ -39,18 +174,20 @@ const char *parse_cmd(const char *buf){
             NVIC_SystemReset();
         break;
         case 's':
-            if(S > 9) S -= 10;
-            else S = 0;
+            if(eff.sat > SVSTEP) eff.sat -= SVSTEP;
+            else eff.sat = 0;
         break;
         case 'S':
-            if(S < 91) S += 10;
-            else S = 100;
+            if(eff.sat < 255 - SVSTEP) eff.sat += SVSTEP;
+            else eff.sat = 255;
         break;
         case 'v':
-            if(V > 9) V -= 10;
+            if(eff.val > SVSTEP) eff.val -= SVSTEP;
+            else eff.val = 0;
         break;
         case 'V':
-            if(V < 91) V += 10;
+            if(eff.val < 255 - SVSTEP) eff.val += SVSTEP;
+            else eff.val = 255;
         break;
         case 'W':
             USND("Wait for reboot\n");
@@ -58,12 +195,19 @@ const char *parse_cmd(const char *buf){
         break;
         default: // help
             return
-            "'c' - reset counter\n"
+            "'c' - reset counter and statistics\n"
+            "'e n' - select effect (0 - rainbow, 1 - gradient, 2 - chase, 3 - fade, 4 - palette)\n"
+            "'f n' - frame rate (1..100Hz)\n"
+            "'h n', 'H n' - hue1 and hue2 (0..255)\n"
+            "'i' - effect parameters and frame statistics\n"
+            "'l n' - length (rainbow hue span or chase spot length)\n"
             "'p' - toggle pause\n"
+            "'P h0 h1 ...' - set palette (up to 8 hues)\n"
             "'R' - software reset\n"
-            "'s/S' - decrement/increment Saturation\n"
-            "'v/V' - decrement/increment Value\n"
+            "'s/S' - decrement/increment Saturation ('S n' - set it, 0..255)\n"
+            "'v/V' - decrement/increment Value ('V n' - set it, 0..255)\n"
             "'W' - test watchdog\n"
+            "'x n' - speed (1/16 step per frame)\n"
             ;
         break;
     }
@@ -22,6 +22,7 @@
 #include <stm32f1.h>
 
 const char *parse_cmd(const char *buf);
-extern uint8_t S, V, pause, rstcounter;
+extern uint8_t pause, rstcounter;
+extern uint32_t frameno, frames, framelate, rendertm, rendermax;
 
 #endif // PROTO_H__
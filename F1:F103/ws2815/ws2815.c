@@ -31,6 +31,8 @@ static uint8_t dmabuf[DMABUFSIZE];
 // buffer for GRB colors
 static uint32_t colorbuf[LEDS_NUM];
 static int currLED = 0; // currrent led number
+// frame is transmitting: colorbuf could be changed only when all LEDs are converted
+static volatile uint8_t busy = 0;
 
 // change color of led with number LEDno
 /**
@@ -64,6 +66,7 @@ static void convertcolor(int halfno, uint32_t colr){
         // On small frequencies comment this line and allow CC1 IRQ
         TIM1->CCR1 = 0;
         currLED = 0;
+        busy = 0;
         return;
     }
 #if 0
@@ -83,8 +86,19 @@ static void convertcolor(int halfno, uint32_t colr){
     }
 }
 
+// buffer for effects rendering (don't touch while ws2815busy())
+uint32_t *ws2815colors(){
+    return colorbuf;
+}
+
+// @return 1 while colorbuf is used by frame transmission
+int ws2815busy(){
+    return busy;
+}
+
 void ws2815start(){
     WS2815TIM->CR1 = 0; // stop timer
+    busy = 1;
     WS2815DMAch->CCR &= ~DMA_CCR_EN; // disable DMA to reconfigure
     convertcolor(0, colorbuf[currLED]);
     if(currLED < LEDS_NUM - 1)
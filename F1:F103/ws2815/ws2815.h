@@ -25,4 +25,6 @@
 int ws2815setpix(uint16_t LEDno, uint32_t colr);
 void ws2815start();
 uint32_t ws2815getpix(uint16_t LEDno);
+uint32_t *ws2815colors();
+int ws2815busy();
 #endif // WS2815_H__
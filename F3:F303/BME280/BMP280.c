@@ -50,7 +50,6 @@
 #include "usb_dev.h" // DBG
 #ifdef EBUG
 #include "strfunc.h"
-extern volatile uint32_t Tms;
 #endif
 
 #include <string.h>
@@ -83,8 +82,6 @@ extern volatile uint32_t Tms;
 #define BMP280_REG_ID           0xD0
 
 #define BMP280_REG_CALIBA       0x88
-#define BMP280_CALIBA_SIZE      (26)  // 26 bytes of calibration registers sequence from 0x88 to 0xa1
-#define BMP280_CALIBB_SIZE      (7)   // 7 bytes of calibration registers sequence from 0xe1 to 0xe7
 #define BMP280_REG_CALIBB       0xE1
 
 #define BMP280_MODE_FORSED      (1)  // force single measurement
@@ -99,6 +96,10 @@ static uint8_t curaddress = BMP280_I2C_ADDRESS_0<<1;
 static uint8_t* (*read_regs)(uint8_t addr, uint8_t reg, uint8_t nbytes) = NULL;
 // write data to register
 static uint8_t (*write_data)(uint8_t addr, uint8_t *data, uint8_t nbytes) = NULL;
+// start DMA reading of N registers
+static uint8_t (*read_regs_dma)(uint8_t addr, uint8_t reg, uint8_t nbytes) = NULL;
+// check DMA reading: 1 - ready (data in *buf), 0 - busy, -1 - error
+static int (*dma_state)(uint8_t **buf) = NULL;
 
 static int read_reg(uint8_t reg, uint8_t *val){
     uint8_t *got = read_regs(curaddress, reg, 1);
@@ -113,32 +114,8 @@ static int write_reg(uint8_t reg, uint8_t val){
     return 1;
 }
 
-static struct {
-    // temperature
-    uint16_t dig_T1;    // 0x88 (LSB), 0x98 (MSB)
-    int16_t  dig_T2;    // ...
-    int16_t  dig_T3;
-    // pressure
-    uint16_t dig_P1;
-    int16_t  dig_P2;
-    int16_t  dig_P3;
-    int16_t  dig_P4;
-    int16_t  dig_P5;
-    int16_t  dig_P6;
-    int16_t  dig_P7;
-    int16_t  dig_P8;
-    int16_t  dig_P9;    // 0x9e, 0x9f
-    // humidity (partially calculated from EEE struct)
-    uint8_t unused;     // 0xA0
-    uint8_t dig_H1;     // 0xA1
-    int16_t dig_H2;     // --------------------
-    uint8_t dig_H3;     // only from EEE
-    uint16_t dig_H4;
-    uint16_t dig_H5;
-    int8_t dig_H6;
-    // data is ready
-    uint8_t  rdy;
-} __attribute__ ((packed)) CaliData = {0};
+static bme_calib CaliData;
+static uint8_t calrdy = 0; // calibration data is ready
 
 //T: 28222 26310 50
 //P: 37780 -10748 3024 7965 -43 -7 9900 -10230 4285
@@ -149,18 +126,32 @@ static struct{
     BMP280_Oversampling p_os;   // oversampling for pressure
     BMP280_Oversampling t_os;   // -//- temperature
     BMP280_Oversampling h_os;   // -//- humidity
+    uint8_t standby;            // t_sb - standby time in normal mode (0..7)
     uint8_t ID;                 // identificator
     uint8_t regctl;             // control register base value [(params.t_os << 5) | (params.p_os << 2)]
+    uint8_t cont;               // ==1 in continuous (normal) mode
 } params = {
     .filter = BMP280_FILTER_OFF,
     .p_os   = BMP280_OVERS16,
     .t_os   = BMP280_OVERS16,
     .h_os   = BMP280_OVERS16,
+    .standby= 5,
     .ID     = 0
 };
 
 static BMP280_status bmpstatus = BMP280_NOTINIT;
 
+// burst reading of data registers
+static uint8_t dmaactive = 0;   // DMA reading in progress
+static uint8_t datasz = 8;      // amount of bytes to read (6 for BMP280)
+static uint8_t msrseen = 0;     // `measuring` bit was set after last reading (normal mode)
+static uint32_t Tread = 0;      // Tms of last reading start
+static uint32_t Tpoll = 0;      // Tms of last status polling in normal mode
+static uint32_t period = 1;     // period of readings in normal mode, ms
+static uint32_t tsbms = 0;      // standby time of normal mode, ms (rounded down)
+static bme_sample lastsample;   // last compensated data
+static bme_ring samples;        // all compensated data in normal mode
+
 BMP280_status BMP280_get_status(){
     return bmpstatus;
 }
@@ -191,19 +182,35 @@ static uint8_t spi_write(uint8_t _U_ address, uint8_t *data, uint8_t n){
     SPI_CS_1();
     return r;
 }
+static uint8_t spi_readregs_dma(uint8_t _U_ address, uint8_t reg, uint8_t len){
+    if(len > SPI_BUFSIZE-2) return 0;
+    bzero(SPIbuf, len + 1);
+    SPIbuf[0] = reg | 0x80;
+    return spi_writeread_dma(SPIbuf, len + 1);
+}
+static int spi_dmastate(uint8_t **buf){
+    int r = spi_dma_state();
+    if(r == 1) *buf = SPIbuf + 1;
+    return r;
+}
 
 // address: 0 or 1
 void BMP280_setup(uint8_t address, uint8_t isI2C){
     bmpstatus = BMP280_NOTINIT;
+    dmaactive = 0;
     if(isI2C){
         curaddress = (BMP280_I2C_ADDRESS_MASK | (address & 1))<<1;
         read_regs = i2c_read_regs;
         write_data = i2c_write;
+        read_regs_dma = i2c_read_regs_dma;
+        dma_state = i2c_dma_state;
         i2c_setup(I2C_SPEED_400K);
     }else{
         curaddress = BMP280_I2C_ADDRESS_MASK | (address & 1);
         read_regs = spi_readregs;
         write_data = spi_write;
+        read_regs_dma = spi_readregs_dma;
+        dma_state = spi_dmastate;
         spi_setup();
     }
 }
@@ -224,22 +231,53 @@ void BMP280_setOSp(BMP280_Oversampling os){
 void BMP280_setOSh(BMP280_Oversampling os){
     params.h_os = os;
 }
+// standby time (t_sb) for normal mode, 0..7; change will be applied on next start
+void BMP280_setstandby(uint8_t tsb){
+    params.standby = tsb & 7;
+}
+uint8_t BMP280_getstandby(){
+    return params.standby;
+}
 // get compensation data, return 1 if OK
 static int readcompdata(){
-    uint8_t *got = read_regs(curaddress, BMP280_REG_CALIBA, BMP280_CALIBA_SIZE);
+    uint8_t A[BME_CALIBA_SIZE];
+    uint8_t *got = read_regs(curaddress, BMP280_REG_CALIBA, BME_CALIBA_SIZE);
     if(!got) return 0;
-    memcpy(&CaliData, got, BMP280_CALIBA_SIZE);
-    CaliData.rdy = 1;
+    memcpy(A, got, BME_CALIBA_SIZE);
+    got = NULL;
     if(params.ID == BME280_CHIP_ID){
-        got = read_regs(curaddress, BMP280_REG_CALIBB, BMP280_CALIBB_SIZE);
-        if(got){
-            CaliData.dig_H2 = (got[1] << 8) | got[0];
-            CaliData.dig_H3 = got[2];
-            CaliData.dig_H4 = (got[3] << 4) | (got[4] & 0x0f);
-            CaliData.dig_H5 = (got[5] << 4) | (got[4] >> 4);
-            CaliData.dig_H6 = got[6];
-        }
+        got = read_regs(curaddress, BMP280_REG_CALIBB, BME_CALIBB_SIZE);
+        if(!got) return 0;
     }
+    bme_parsecalib(&CaliData, A, got);
+    calrdy = 1;
+    return 1;
+}
+
+// amount of samples for oversampling `os`
+#define OSN(os)     ((os) ? (1 << ((os) - 1)) : 0)
+
+// calculate period of normal mode: t_sb + max measurement time (datasheet, 9.1)
+static void calcperiod(){
+    static const uint32_t tsb_us[8] = {500, 62500, 125000, 250000, 500000, 1000000, 10000, 20000};
+    uint32_t t = tsb_us[params.standby];
+    if(params.ID == BMP280_CHIP_ID){ // BMP280 have other two last values
+        if(params.standby == 6) t = 2000000;
+        else if(params.standby == 7) t = 4000000;
+    }
+    tsbms = t / 1000;
+    t += 1250 + 2300 * OSN(params.t_os);
+    if(params.p_os) t += 2300 * OSN(params.p_os) + 575;
+    if(params.ID == BME280_CHIP_ID && params.h_os) t += 2300 * OSN(params.h_os) + 575;
+    period = (t + 999) / 1000;
+}
+
+// write settings for given mode (sleep, forced or normal)
+static int setmode(uint8_t mode){
+    // CONFIG could be changed only in sleep mode
+    if(!write_reg(BMP280_REG_CTRL, params.regctl)) return 0;
+    if(!write_reg(BMP280_REG_CONFIG, (params.standby << 5) | (params.filter << 2))) return 0;
+    if(mode && !write_reg(BMP280_REG_CTRL, params.regctl | mode)) return 0;
     return 1;
 }
 
@@ -247,6 +285,7 @@ static int readcompdata(){
 int BMP280_init(){
     IWDG->KR = IWDG_REFRESH;
     DBG("INI:");
+    dmaactive = 0;
     if(!read_reg(BMP280_REG_ID, &params.ID)){
         DBG("Can't get ID");
         return 0;
@@ -276,23 +315,21 @@ int BMP280_init(){
         DBG("Can't read calibration data");
         return 0;
     }
-    // write filter configuration
-    reg = params.filter << 2;
-    if(!write_reg(BMP280_REG_CONFIG, reg)){DBG("Can't save filter settings");}
-    reg = (params.t_os << 5) | (params.p_os << 2); // oversampling for P/T, sleep mode
-    if(!write_reg(BMP280_REG_CTRL, reg)){
-        DBG("Can't write settings for P/T");
-        return 0;
-    }
-    params.regctl = reg;
-    if(params.ID == BME280_CHIP_ID){ // write CTRL_HUM only AFTER CTRL!
+    datasz = (params.ID == BME280_CHIP_ID) ? BME_DATA_SIZE : 6;
+    if(params.ID == BME280_CHIP_ID){ // CTRL_HUM is applied only after writing CTRL
         reg = params.h_os;
         if(!write_reg(BMP280_REG_CTRL_HUM, reg)){
             DBG("Can't write settings for H");
             return 0;
         }
     }
+    params.regctl = (params.t_os << 5) | (params.p_os << 2); // oversampling for P/T, sleep mode
+    if(!setmode(0)){
+        DBG("Can't write settings");
+        return 0;
+    }
     bmpstatus = BMP280_RELAX;
+    if(params.cont) BMP280_startcont();
     return 1;
 }
 
@@ -305,9 +342,9 @@ int BMP280_read_ID(uint8_t *devid){
 
 // start measurement, @return 1 if all OK
 int BMP280_start(){
-    if(!CaliData.rdy || bmpstatus == BMP280_BUSY){
+    if(!calrdy || bmpstatus == BMP280_BUSY || bmpstatus == BMP280_CONT){
 #ifdef EBUG
-        USB_sendstr("rdy="); USB_sendstr(u2str(CaliData.rdy));
+        USB_sendstr("rdy="); USB_sendstr(u2str(calrdy));
         USB_sendstr("\nbmpstatus="); USB_sendstr(u2str(bmpstatus));
         newline();
 #endif
@@ -322,101 +359,133 @@ int BMP280_start(){
     return 1;
 }
 
+/**
+ * @brief BMP280_startcont - start continuous measurements in normal mode
+ * all data registers are read by one DMA transaction each t_sb + t_measure
+ * @return 0 if failed
+ */
+int BMP280_startcont(){
+    if(!calrdy || bmpstatus == BMP280_NOTINIT) return 0;
+    if(bmpstatus == BMP280_BUSY) return 0; // wait for end of forced measurement
+    params.cont = 1;
+    if(dmaactive) return 1; // already running
+    if(!setmode(BMP280_MODE_NORMAL)){
+        DBG("Can't start normal mode");
+        return 0;
+    }
+    calcperiod();
+    msrseen = 0;
+    Tread = Tms - tsbms; // first conversion starts right now: begin polling of status
+    bmpstatus = BMP280_CONT;
+    return 1;
+}
+
+// stop continuous measurements (go into sleep mode)
+void BMP280_stopcont(){
+    params.cont = 0;
+    if(bmpstatus != BMP280_CONT) return;
+    if(dmaactive) return; // will be stopped after reading
+    bmpstatus = BMP280_RELAX;
+    setmode(0);
+}
+
+// start burst reading of all data registers
+static void startread(){
+    Tread = Tms;
+    msrseen = 0;
+    if(!read_regs_dma(curaddress, BMP280_REG_ALLDATA, datasz)){
+        DBG("Can't start DMA");
+        bmpstatus = BMP280_ERR;
+        return;
+    }
+    dmaactive = 1;
+}
+
+// check burst reading and compensate data
+static void getread(){
+    uint8_t *data;
+    int r = dma_state(&data);
+    if(r == 0) return;
+    dmaactive = 0;
+    if(r < 0){
+        DBG("DMA error");
+        bmpstatus = BMP280_ERR;
+        return;
+    }
+    if(bmpstatus == BMP280_CONT && !params.cont){ // stop was requested while reading
+        bmpstatus = BMP280_RELAX;
+        setmode(0);
+        return;
+    }
+    bme_sample s = {.Tms = Tread};
+    if(!bme_compensate(&CaliData, data, &s)){
+        if(bmpstatus == BMP280_BUSY) bmpstatus = BMP280_RELAX;
+        return;
+    }
+    lastsample = s;
+    if(bmpstatus == BMP280_BUSY) bmpstatus = BMP280_RDY; // data ready
+    else bme_ringput(&samples, &s);
+}
+
 void BMP280_process(){
     if(bmpstatus == BMP280_NOTINIT){
         BMP280_init(); return;
     }
+    if(dmaactive){
+        getread(); return;
+    }
+    if(bmpstatus == BMP280_CONT){
+        // data registers are refreshed when `measuring` bit falls: no more than one reading per conversion
+        uint32_t dT = Tms - Tread;
+        if(dT < tsbms || Tms == Tpoll) return; // standby time (or already polled in this ms)
+        Tpoll = Tms;
+        uint8_t reg;
+        if(!read_reg(BMP280_REG_STATUS, &reg)) return;
+        if(reg & BMP280_STATUS_MSRNG){
+            // `period` is max time of cycle, so this is the next conversion: the end of previous was missed
+            if(msrseen && dT > period) startread();
+            else msrseen = 1;
+        }else if(msrseen || dT > 2 * period) startread(); // conversion is over (or wasn't seen at all)
+        return;
+    }
     if(bmpstatus != BMP280_BUSY) return;
     // BUSY state: poll data ready
     uint8_t reg;
     if(!read_reg(BMP280_REG_STATUS, &reg)) return;
     if(reg & (BMP280_STATUS_MSRNG | BMP280_STATUS_IMCOPY)) return; // still busy
-   /* if(params.ID == BME280_CHIP_ID && !(reg & BME280_STATUS_MSRGOOD)){ // check if data is good
-        DBG("Wrong data!");
-        bmpstatus = BMP280_RELAX;
-        read_regs(curaddress, BMP280_REG_ALLDATA, 8);
-        return;
-    }*/
-    bmpstatus = BMP280_RDY; // data ready
-}
-
-// return T*100 degC
-static inline int32_t compTemp(int32_t adc_temp, int32_t *t_fine){
-	int32_t var1, var2;
-	var1 = ((((adc_temp >> 3) - ((int32_t) CaliData.dig_T1 << 1)))
-			* (int32_t) CaliData.dig_T2) >> 11;
-	var2 = (((((adc_temp >> 4) - (int32_t) CaliData.dig_T1)
-			* ((adc_temp >> 4) - (int32_t) CaliData.dig_T1)) >> 12)
-			* (int32_t) CaliData.dig_T3) >> 14;
-	*t_fine = var1 + var2;
-	return (*t_fine * 5 + 128) >> 8;
+    startread();
 }
 
-// return p*256 hPa
-static inline uint32_t compPres(int32_t adc_press, int32_t fine_temp) {
-	int64_t var1, var2, p;
-	var1 = (int64_t) fine_temp - 128000;
-	var2 = var1 * var1 * (int64_t) CaliData.dig_P6;
-	var2 = var2 + ((var1 * (int64_t) CaliData.dig_P5) << 17);
-	var2 = var2 + (((int64_t) CaliData.dig_P4) << 35);
-	var1 = ((var1 * var1 * (int64_t) CaliData.dig_P3) >> 8)
-			+ ((var1 * (int64_t) CaliData.dig_P2) << 12);
-	var1 = (((int64_t) 1 << 47) + var1) * ((int64_t) CaliData.dig_P1) >> 33;
-	if (var1 == 0){
-		return 0;  // avoid exception caused by division by zero
-	}
-	p = 1048576 - adc_press;
-	p = (((p << 31) - var2) * 3125) / var1;
-	var1 = ((int64_t) CaliData.dig_P9 * (p >> 13) * (p >> 13)) >> 25;
-	var2 = ((int64_t) CaliData.dig_P8 * p) >> 19;
-	p = ((p + var1 + var2) >> 8) + ((int64_t) CaliData.dig_P7 << 4);
-	return p;
+/**
+ * @brief BMP280_getdata - get data of forced measurement
+ * @param s (o) - sample
+ * @return 0 if there's no new data
+ */
+int BMP280_getdata(bme_sample *s){
+    if(bmpstatus != BMP280_RDY) return 0;
+    bmpstatus = BMP280_RELAX;
+    *s = lastsample;
+    return 1;
 }
 
-// return H*1024 %
-static inline uint32_t compHum(int32_t adc_hum, int32_t fine_temp){
-	int32_t v_x1_u32r;
-	v_x1_u32r = fine_temp - (int32_t) 76800;
-	v_x1_u32r = ((((adc_hum << 14) - (((int32_t)CaliData.dig_H4) << 20)
-			- (((int32_t)CaliData.dig_H5) * v_x1_u32r)) + (int32_t)16384) >> 15)
-			* (((((((v_x1_u32r * ((int32_t)CaliData.dig_H6)) >> 10)
-					* (((v_x1_u32r * ((int32_t)CaliData.dig_H3)) >> 11)
-							+ (int32_t)32768)) >> 10) + (int32_t)2097152)
-					* ((int32_t)CaliData.dig_H2) + 8192) >> 14);
-	v_x1_u32r = v_x1_u32r
-			- (((((v_x1_u32r >> 15) * (v_x1_u32r >> 15)) >> 7)
-					* ((int32_t)CaliData.dig_H1)) >> 4);
-	v_x1_u32r = v_x1_u32r < 0 ? 0 : v_x1_u32r;
-	v_x1_u32r = v_x1_u32r > 419430400 ? 419430400 : v_x1_u32r;
-	return v_x1_u32r >> 12;
+/**
+ * @brief BMP280_getsamples - get batch of oldest samples of continuous measurements
+ * @param buf (o) - buffer for samples
+ * @param max - its length
+ * @param lost (o) - amount of overwritten samples since last call (or NULL)
+ * @return amount of samples in `buf`
+ */
+int BMP280_getsamples(bme_sample *buf, int max, uint32_t *lost){
+    if(lost){
+        *lost = samples.lost;
+        samples.lost = 0;
+    }
+    return bme_ringget(&samples, buf, max);
 }
 
-
-// read data & convert it
-int BMP280_getdata(float *T, float *P, float *H){
-    if(bmpstatus != BMP280_RDY) return 0;
-    bmpstatus = BMP280_RELAX;
-    uint8_t datasz = 8; // amount of bytes to read
-    if(params.ID != BME280_CHIP_ID){
-        if(H) *H = 0;
-        H = NULL;
-        datasz = 6;
-    }
-    uint8_t *data = read_regs(curaddress, BMP280_REG_ALLDATA, datasz);
-    if(!data) return 0;
-    int32_t p = (data[0] << 12) | (data[1] << 4) | (data[2] >> 4);
-    int32_t t = (data[3] << 12) | (data[4] << 4) | (data[5] >> 4);
-    int32_t t_fine;
-    if(T){
-        int32_t Temp = compTemp(t, &t_fine);
-        *T = ((float)Temp)/100.f;
-    }
-    if(P) *P = ((float)compPres(p, t_fine)) / 256.f;
-    if(H){
-        int32_t h = (data[6] << 8) | data[7];
-        *H = ((float)compHum(h, t_fine))/1024.;
-    }
-    return 1;
+// period of continuous measurements, ms
+uint32_t BMP280_getperiod(){
+    return period;
 }
 
 // dewpoint calculation (T in degrC, H in percents)
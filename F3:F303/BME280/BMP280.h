@@ -48,6 +48,8 @@
 
 #include <stm32f3.h>
 
+#include "bmecomp.h"
+
 #define BMP280_CHIP_ID  0x58
 #define BME280_CHIP_ID  0x60
 
@@ -76,6 +78,7 @@ typedef enum{
     BMP280_ERR,         // error in I2C
     BMP280_RELAX,       // relaxed state
     BMP280_RDY,         // data ready - can get it
+    BMP280_CONT,        // continuous measurements in normal mode
 } BMP280_status;
 
 
@@ -86,11 +89,17 @@ BMP280_Filter BMP280_getfilter();
 void BMP280_setOSt(BMP280_Oversampling os);
 void BMP280_setOSp(BMP280_Oversampling os);
 void BMP280_setOSh(BMP280_Oversampling os);
+void BMP280_setstandby(uint8_t tsb);
+uint8_t BMP280_getstandby();
 int BMP280_read_ID(uint8_t *devid);
 BMP280_status BMP280_get_status();
 int BMP280_start();
 void BMP280_process();
-int BMP280_getdata(float *T, float *P, float *H);
+int BMP280_startcont();
+void BMP280_stopcont();
+int BMP280_getdata(bme_sample *s);
+int BMP280_getsamples(bme_sample *buf, int max, uint32_t *lost);
+uint32_t BMP280_getperiod();
 float Tdew(float T, float H);
 
 #endif // BMP280_H__
@@ -0,0 +1,141 @@
+/*
+ * This file is part of the bme280 project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "bmecomp.h"
+
+#define U16(p)  ((uint16_t)((p)[0] | ((p)[1] << 8)))
+#define S16(p)  ((int16_t)U16(p))
+
+/**
+ * @brief bme_parsecalib - fill calibration structure by registers content
+ * @param c - calibration
+ * @param a - BME_CALIBA_SIZE bytes from 0x88
+ * @param b - BME_CALIBB_SIZE bytes from 0xE1 (NULL for BMP280)
+ */
+void bme_parsecalib(bme_calib *c, const uint8_t *a, const uint8_t *b){
+    memset(c, 0, sizeof(bme_calib));
+    c->T1 = U16(a);      c->T2 = S16(a + 2);  c->T3 = S16(a + 4);
+    c->P1 = U16(a + 6);  c->P2 = S16(a + 8);  c->P3 = S16(a + 10);
+    c->P4 = S16(a + 12); c->P5 = S16(a + 14); c->P6 = S16(a + 16);
+    c->P7 = S16(a + 18); c->P8 = S16(a + 20); c->P9 = S16(a + 22);
+    if(!b) return;
+    c->hashum = 1;
+    c->H1 = a[25];
+    c->H2 = S16(b);
+    c->H3 = b[2];
+    // H4 and H5 are 12-bit signed: 0xE4[7:0]/0xE5[3:0] and 0xE6[7:0]/0xE5[7:4]
+    c->H4 = (int16_t)((int8_t)b[3] * 16) | (b[4] & 0x0f);
+    c->H5 = (int16_t)((int8_t)b[5] * 16) | (b[4] >> 4);
+    c->H6 = (int8_t)b[6];
+}
+
+// return T*100 degC
+int32_t compTemp(const bme_calib *c, int32_t adc_temp, int32_t *t_fine){
+    int32_t var1, var2;
+    var1 = ((((adc_temp >> 3) - ((int32_t) c->T1 << 1))) * (int32_t) c->T2) >> 11;
+    var2 = (((((adc_temp >> 4) - (int32_t) c->T1) * ((adc_temp >> 4) - (int32_t) c->T1)) >> 12)
+            * (int32_t) c->T3) >> 14;
+    *t_fine = var1 + var2;
+    return (*t_fine * 5 + 128) >> 8;
+}
+
+// return p*256 Pa
+uint32_t compPres(const bme_calib *c, int32_t adc_press, int32_t t_fine){
+    int64_t var1, var2, p;
+    var1 = (int64_t) t_fine - 128000;
+    var2 = var1 * var1 * (int64_t) c->P6;
+    var2 = var2 + ((var1 * (int64_t) c->P5) << 17);
+    var2 = var2 + (((int64_t) c->P4) << 35);
+    var1 = ((var1 * var1 * (int64_t) c->P3) >> 8) + ((var1 * (int64_t) c->P2) << 12);
+    var1 = (((int64_t) 1 << 47) + var1) * ((int64_t) c->P1) >> 33;
+    if(var1 == 0) return 0;  // avoid exception caused by division by zero
+    p = 1048576 - adc_press;
+    p = (((p << 31) - var2) * 3125) / var1;
+    var1 = ((int64_t) c->P9 * (p >> 13) * (p >> 13)) >> 25;
+    var2 = ((int64_t) c->P8 * p) >> 19;
+    p = ((p + var1 + var2) >> 8) + ((int64_t) c->P7 << 4);
+    return (uint32_t) p;
+}
+
+// return H*1024 %
+uint32_t compHum(const bme_calib *c, int32_t adc_hum, int32_t t_fine){
+    int32_t v_x1_u32r;
+    v_x1_u32r = t_fine - (int32_t) 76800;
+    v_x1_u32r = ((((adc_hum << 14) - (((int32_t) c->H4) << 20)
+            - (((int32_t) c->H5) * v_x1_u32r)) + (int32_t) 16384) >> 15)
+            * (((((((v_x1_u32r * ((int32_t) c->H6)) >> 10)
+            * (((v_x1_u32r * ((int32_t) c->H3)) >> 11) + (int32_t) 32768)) >> 10)
+            + (int32_t) 2097152) * ((int32_t) c->H2) + 8192) >> 14);
+    v_x1_u32r = v_x1_u32r - (((((v_x1_u32r >> 15) * (v_x1_u32r >> 15)) >> 7) * ((int32_t) c->H1)) >> 4);
+    v_x1_u32r = v_x1_u32r < 0 ? 0 : v_x1_u32r;
+    v_x1_u32r = v_x1_u32r > 419430400 ? 419430400 : v_x1_u32r;
+    return (uint32_t)(v_x1_u32r >> 12);
+}
+
+/**
+ * @brief bme_compensate - convert burst of data registers into sample
+ * @param c - calibration
+ * @param raw - BME_DATA_SIZE bytes from 0xF7 (only 6 for BMP280)
+ * @param s (o) - sample (Tms isn't touched)
+ * @return 0 if temperature measurement was skipped
+ */
+int bme_compensate(const bme_calib *c, const uint8_t *raw, bme_sample *s){
+    int32_t p = (raw[0] << 12) | (raw[1] << 4) | (raw[2] >> 4);
+    int32_t t = (raw[3] << 12) | (raw[4] << 4) | (raw[5] >> 4);
+    int32_t t_fine;
+    if(t == BME_SKIPPED_PT) return 0;
+    s->T = compTemp(c, t, &t_fine);
+    s->P = (p == BME_SKIPPED_PT) ? 0 : compPres(c, p, t_fine);
+    s->H = 0;
+    if(c->hashum){
+        int32_t h = (raw[6] << 8) | raw[7];
+        if(h != BME_SKIPPED_H) s->H = compHum(c, h, t_fine);
+    }
+    return 1;
+}
+
+// put next sample, the oldest is overwritten when ring is full
+void bme_ringput(bme_ring *r, const bme_sample *s){
+    uint16_t idx = r->head + r->len;
+    if(idx >= BME_RINGSZ) idx -= BME_RINGSZ;
+    r->s[idx] = *s;
+    if(r->len < BME_RINGSZ) ++r->len;
+    else{
+        if(++r->head == BME_RINGSZ) r->head = 0;
+        ++r->lost;
+    }
+}
+
+/**
+ * @brief bme_ringget - get batch of oldest samples
+ * @param r - ring
+ * @param buf (o) - buffer for samples
+ * @param max - its length
+ * @return amount of samples read
+ */
+int bme_ringget(bme_ring *r, bme_sample *buf, int max){
+    int n = 0;
+    while(n < max && r->len){
+        buf[n++] = r->s[r->head];
+        if(++r->head == BME_RINGSZ) r->head = 0;
+        --r->len;
+    }
+    return n;
+}
@@ -0,0 +1,72 @@
+/*
+ * This file is part of the bme280 project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Hardware-independent part of BMP280/BME280 driver: calibration parsing,
+ * integer (Bosch 32/64-bit) compensation and ring of timestamped samples.
+ * All values are kept in fixed point, float conversion is only for output.
+ */
+
+#define BME_CALIBA_SIZE     (26)    // registers 0x88..0xA1
+#define BME_CALIBB_SIZE     (7)     // registers 0xE1..0xE7
+#define BME_DATA_SIZE       (8)     // burst of data registers 0xF7..0xFE (BMP280 - only 6)
+
+// value of data registers when measurement is skipped (oversampling is 0)
+#define BME_SKIPPED_PT      (0x80000)
+#define BME_SKIPPED_H       (0x8000)
+
+// length of samples ring
+#define BME_RINGSZ          (64)
+
+typedef struct{
+    uint16_t T1;
+    int16_t  T2, T3;
+    uint16_t P1;
+    int16_t  P2, P3, P4, P5, P6, P7, P8, P9;
+    uint8_t  H1, H3;
+    int16_t  H2, H4, H5;
+    int8_t   H6;
+    uint8_t  hashum;        // ==1 for BME280
+} bme_calib;
+
+typedef struct{
+    uint32_t Tms;           // time of reading
+    int32_t  T;             // degC * 100
+    uint32_t P;             // Pa * 256 (Q24.8)
+    uint32_t H;             // % * 1024 (Q22.10), 0 for BMP280
+} bme_sample;
+
+typedef struct{
+    bme_sample s[BME_RINGSZ];
+    uint16_t head;          // index of oldest sample
+    uint16_t len;           // amount of samples stored
+    uint32_t lost;          // amount of overwritten samples
+} bme_ring;
+
+void bme_parsecalib(bme_calib *c, const uint8_t *a, const uint8_t *b);
+int32_t compTemp(const bme_calib *c, int32_t adc_temp, int32_t *t_fine);
+uint32_t compPres(const bme_calib *c, int32_t adc_press, int32_t t_fine);
+uint32_t compHum(const bme_calib *c, int32_t adc_hum, int32_t t_fine);
+int bme_compensate(const bme_calib *c, const uint8_t *raw, bme_sample *s);
+
+void bme_ringput(bme_ring *r, const bme_sample *s);
+int bme_ringget(bme_ring *r, bme_sample *buf, int max);
@@ -0,0 +1,240 @@
+/*
+ * This file is part of the bme280 project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host checker of BMP280/BME280 compensation (../bmecomp.c): datasheet example,
+// comparison with Bosch floating point formulas, calibration parsing, samples ring
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../bmecomp.h"
+
+// BMP280 datasheet, 3.12: calibration and results of example
+static const bme_calib dscalib = {.T1 = 27504, .T2 = 26435, .T3 = -1000,
+    .P1 = 36477, .P2 = -10685, .P3 = 3024, .P4 = 2855, .P5 = 140, .P6 = -7,
+    .P7 = 15500, .P8 = -14600, .P9 = 6000};
+#define DS_ADC_T    (519888)
+#define DS_ADC_P    (415148)
+#define DS_TFINE    (128422)
+#define DS_T        (2508)
+#define DS_P        (100653.27) // Pa
+
+// real BME280 calibration (see comment in ../BMP280.c; H2 there was byte-swapped)
+static const bme_calib realcalib = {.T1 = 28222, .T2 = 26310, .T3 = 50,
+    .P1 = 37780, .P2 = -10748, .P3 = 3024, .P4 = 7965, .P5 = -43, .P6 = -7,
+    .P7 = 9900, .P8 = -10230, .P9 = 4285,
+    .H1 = 75, .H2 = 356, .H3 = 0, .H4 = 334, .H5 = 50, .H6 = 30, .hashum = 1};
+
+// Bosch floating point compensation (BME280 datasheet, 8.1)
+static double dTemp(const bme_calib *c, int32_t adc_T, double *t_fine){
+    double var1 = (adc_T / 16384. - c->T1 / 1024.) * c->T2;
+    double var2 = (adc_T / 131072. - c->T1 / 8192.) * (adc_T / 131072. - c->T1 / 8192.) * c->T3;
+    *t_fine = var1 + var2;
+    return *t_fine / 5120.;
+}
+
+static double dPres(const bme_calib *c, int32_t adc_P, double t_fine){
+    double var1 = t_fine / 2. - 64000.;
+    double var2 = var1 * var1 * c->P6 / 32768.;
+    var2 = var2 + var1 * c->P5 * 2.;
+    var2 = var2 / 4. + c->P4 * 65536.;
+    var1 = (c->P3 * var1 * var1 / 524288. + c->P2 * var1) / 524288.;
+    var1 = (1. + var1 / 32768.) * c->P1;
+    if(var1 == 0.) return 0.;
+    double p = 1048576. - adc_P;
+    p = (p - var2 / 4096.) * 6250. / var1;
+    var1 = c->P9 * p * p / 2147483648.;
+    var2 = p * c->P8 / 32768.;
+    return p + (var1 + var2 + c->P7) / 16.;
+}
+
+static double dHum(const bme_calib *c, int32_t adc_H, double t_fine){
+    double h = t_fine - 76800.;
+    h = (adc_H - (c->H4 * 64. + c->H5 / 16384. * h)) *
+        (c->H2 / 65536. * (1. + c->H6 / 67108864. * h * (1. + c->H3 / 67108864. * h)));
+    h = h * (1. - c->H1 * h / 524288.);
+    if(h > 100.) h = 100.;
+    else if(h < 0.) h = 0.;
+    return h;
+}
+
+// registers content for given calibration
+static void mkregs(const bme_calib *c, uint8_t *a, uint8_t *b){
+    uint16_t w[12] = {c->T1, (uint16_t)c->T2, (uint16_t)c->T3, c->P1, (uint16_t)c->P2, (uint16_t)c->P3,
+                      (uint16_t)c->P4, (uint16_t)c->P5, (uint16_t)c->P6, (uint16_t)c->P7, (uint16_t)c->P8,
+                      (uint16_t)c->P9};
+    for(int i = 0; i < 12; ++i){ a[2*i] = w[i] & 0xff; a[2*i + 1] = w[i] >> 8; }
+    a[24] = 0; a[25] = c->H1;
+    b[0] = (uint16_t)c->H2 & 0xff; b[1] = (uint16_t)c->H2 >> 8;
+    b[2] = c->H3;
+    b[3] = (uint8_t)(c->H4 >> 4);
+    b[4] = (uint8_t)((c->H4 & 0x0f) | ((c->H5 & 0x0f) << 4));
+    b[5] = (uint8_t)(c->H5 >> 4);
+    b[6] = (uint8_t)c->H6;
+}
+
+static void mkraw(int32_t adc_T, int32_t adc_P, int32_t adc_H, uint8_t *raw){
+    raw[0] = adc_P >> 12; raw[1] = (adc_P >> 4) & 0xff; raw[2] = (adc_P & 0x0f) << 4;
+    raw[3] = adc_T >> 12; raw[4] = (adc_T >> 4) & 0xff; raw[5] = (adc_T & 0x0f) << 4;
+    raw[6] = adc_H >> 8; raw[7] = adc_H & 0xff;
+}
+
+static double dtime(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static int check(const char *name, int ok){
+    printf("%-44s %s\n", name, ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+// random calibration around real one
+static void randcalib(bme_calib *c){
+    *c = realcalib;
+    c->T1 += lrand48() % 2000 - 1000;
+    c->T2 += lrand48() % 2000 - 1000;
+    c->P4 += lrand48() % 2000 - 1000;
+    c->P8 += lrand48() % 2000 - 1000;
+    c->H2 += lrand48() % 100 - 50;
+    c->H4 += lrand48() % 200 - 100;
+    c->H5 = (int16_t)(lrand48() % 200 - 100);
+    c->H6 = (int8_t)(lrand48() % 60);
+    c->H3 = (uint8_t)(lrand48() % 10);
+}
+
+static void usage(const char *self){
+    fprintf(stderr, "Usage: %s [options]\n", self);
+    fprintf(stderr, "\t-n - amount of random values to compare (default 1000000)\n");
+    fprintf(stderr, "\t-s - seed for random generator\n");
+    exit(1);
+}
+
+int main(int argc, char **argv){
+    int opt, nval = 1000000, failed = 0;
+    long seed = 1;
+    while((opt = getopt(argc, argv, "n:s:")) != -1){
+        switch(opt){
+            case 'n':
+                nval = atoi(optarg);
+                if(nval < 1) usage(argv[0]);
+            break;
+            case 's':
+                seed = atol(optarg);
+            break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    srand48(seed);
+    // datasheet example
+    int32_t t_fine;
+    int32_t T = compTemp(&dscalib, DS_ADC_T, &t_fine);
+    uint32_t P = compPres(&dscalib, DS_ADC_P, t_fine);
+    printf("Datasheet example: T=%d (%d), t_fine=%d (%d), P=%.2f (%.2f) Pa\n", T, DS_T, t_fine, DS_TFINE,
+           P / 256., DS_P);
+    failed += check("datasheet vector", T == DS_T && t_fine == DS_TFINE && fabs(P / 256. - DS_P) < 0.05);
+    // calibration parsing
+    uint8_t a[BME_CALIBA_SIZE], b[BME_CALIBB_SIZE];
+    int parsed = 1;
+    for(int i = 0; i < 1000 && parsed; ++i){
+        bme_calib c, p;
+        randcalib(&c);
+        c.H4 = (int16_t)(lrand48() % 4096 - 2048); // all 12-bit values
+        c.H5 = (int16_t)(lrand48() % 4096 - 2048);
+        mkregs(&c, a, b);
+        bme_parsecalib(&p, a, b);
+        if(memcmp(&c, &p, sizeof(c))) parsed = 0;
+    }
+    failed += check("calibration parsing (signed H4/H5)", parsed);
+    // comparison with floating point
+    double dTmax = 0., dPmax = 0., dHmax = 0.;
+    for(int i = 0; i < nval; ++i){
+        bme_calib c;
+        if(i) randcalib(&c);
+        else c = realcalib;
+        // -40..+85 degC, 300..1100 hPa, 0..100%
+        int32_t aT = 420000 + (int32_t)(lrand48() % 250000);
+        int32_t aP = 200000 + (int32_t)(lrand48() % 450000);
+        int32_t aH = (int32_t)(lrand48() % 65535);
+        if(aP == BME_SKIPPED_PT || aH == BME_SKIPPED_H) continue;
+        uint8_t raw[BME_DATA_SIZE];
+        mkraw(aT, aP, aH, raw);
+        bme_sample s;
+        if(!bme_compensate(&c, raw, &s)) continue;
+        double tf, dT = dTemp(&c, aT, &tf), dP = dPres(&c, aP, tf), dH = dHum(&c, aH, tf);
+        // out of sensor ranges (integer formulas aren't valid there)
+        if(dT < -40. || dT > 85. || dP < 30000. || dP > 110000. || dH <= 0. || dH >= 100.) continue;
+        double e = fabs(s.T / 100. - dT);
+        if(e > dTmax) dTmax = e;
+        e = fabs(s.P / 256. - dP);
+        if(e > dPmax) dPmax = e;
+        e = fabs(s.H / 1024. - dH);
+        if(e > dHmax) dHmax = e;
+    }
+    printf("Max deviation from floating point: T=%.4f degC, P=%.3f Pa, H=%.4f %%\n", dTmax, dPmax, dHmax);
+    failed += check("T/P/H vs floating point", dTmax <= 0.01 && dPmax < 1. && dHmax < 0.02);
+    // skipped measurements
+    {
+        uint8_t raw[BME_DATA_SIZE];
+        bme_sample s;
+        mkraw(BME_SKIPPED_PT, 415148, 30000, raw);
+        int ok = !bme_compensate(&realcalib, raw, &s);
+        mkraw(519888, BME_SKIPPED_PT, BME_SKIPPED_H, raw);
+        ok = ok && bme_compensate(&realcalib, raw, &s) && s.P == 0 && s.H == 0;
+        failed += check("skipped measurements", ok);
+    }
+    // ring
+    {
+        bme_ring r;
+        bme_sample s = {0}, buf[10];
+        memset(&r, 0, sizeof(r));
+        for(int i = 0; i < BME_RINGSZ + 5; ++i){ s.Tms = i; bme_ringput(&r, &s); }
+        int ok = (r.lost == 5 && r.len == BME_RINGSZ);
+        uint32_t next = 5;
+        int n;
+        while((n = bme_ringget(&r, buf, 10)) > 0)
+            for(int i = 0; i < n; ++i) if(buf[i].Tms != next++) ok = 0;
+        ok = ok && next == BME_RINGSZ + 5 && r.len == 0;
+        failed += check("samples ring", ok);
+    }
+    // speed
+    {
+        uint8_t raw[BME_DATA_SIZE];
+        bme_sample s;
+        volatile uint32_t sum = 0;
+        volatile double dsum = 0.;
+        mkraw(519888, 415148, 30000, raw);
+        double t0 = dtime();
+        for(int i = 0; i < nval; ++i){ raw[5] = i << 4; bme_compensate(&realcalib, raw, &s); sum += s.P; }
+        double t1 = dtime();
+        for(int i = 0; i < nval; ++i){
+            double tf; dTemp(&realcalib, 519888 + (i & 0xf), &tf);
+            dsum += dPres(&realcalib, 415148, tf) + dHum(&realcalib, 30000, tf);
+        }
+        double t2 = dtime();
+        printf("Compensation of T/P/H: integer %.1f ns, double %.1f ns\n", (t1 - t0) / nval * 1e9, (t2 - t1) / nval * 1e9);
+    }
+    printf("%s\n", failed ? "FAILED" : "OK");
+    return failed ? 2 : 0;
+}
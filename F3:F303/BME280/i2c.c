@@ -28,6 +28,10 @@ static uint32_t cntr;
 volatile uint8_t i2c_scanmode = 0; // == 1 when I2C is in scan mode
 static uint8_t i2caddr  = I2C_ADDREND; // current address in scan mode
 static uint8_t I2Cbuf[I2C_BUFSIZE];
+static volatile uint8_t I2Cbusy = 0, goterr = 0, i2c_got_DMA = 0; // DMA transfer in progress, error, data ready
+static uint32_t dmastart; // Tms of DMA start
+
+#define DMARXCCR    (DMA_CCR_MINC | DMA_CCR_TCIE | DMA_CCR_TEIE)
 
 // GPIO Resources: I2C1_SCL - PB6 (AF4), I2C1_SDA - PB7 (AF4)
 void i2c_setup(i2c_speed_t speed){
@@ -85,7 +89,13 @@ void i2c_setup(i2c_speed_t speed){
     }
     I2C1->TIMINGR = (PRESC<<I2C_TIMINGR_PRESC_Pos) | (SCLDEL<<I2C_TIMINGR_SCLDEL_Pos) |
                     (SDADEL<<I2C_TIMINGR_SDADEL_Pos) | (SCLH<<I2C_TIMINGR_SCLH_Pos) | (SCLL<< I2C_TIMINGR_SCLL_Pos);
-    I2C1->CR1 = I2C_CR1_PE;
+    I2C1->CR1 = I2C_CR1_PE | I2C_CR1_RXDMAEN;
+    // DMA1 channel 7 - I2C1_Rx
+    RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+    DMA1_Channel7->CCR = 0;
+    DMA1_Channel7->CPAR = (uint32_t) &I2C1->RXDR;
+    NVIC_EnableIRQ(DMA1_Channel7_IRQn);
+    I2Cbusy = 0;
     i2c_curspeed = speed;
 }
 
@@ -161,6 +171,7 @@ static uint8_t i2c_writes(uint8_t addr, uint8_t *data, uint8_t nbytes, uint8_t s
 }
 
 uint8_t i2c_write(uint8_t addr, uint8_t *data, uint8_t nbytes){
+    if(I2Cbusy) return 0;
     return i2c_writes(addr, data, nbytes, 1);
 }
 
@@ -191,17 +202,63 @@ tmout:
 }
 
 uint8_t *i2c_read(uint8_t addr, uint8_t nbytes){
-    if(!waitISRbit(I2C_ISR_BUSY, 0)) return 0;
+    if(I2Cbusy || !waitISRbit(I2C_ISR_BUSY, 0)) return 0;
     return i2c_readb(addr, nbytes);
 }
 
 // read register reg
 uint8_t *i2c_read_regs(uint8_t addr, uint8_t reg, uint8_t nbytes){
-    if(!waitISRbit(I2C_ISR_BUSY, 0)) return NULL;
+    if(I2Cbusy || !waitISRbit(I2C_ISR_BUSY, 0)) return NULL;
     if(!i2c_writes(addr, &reg, 1, 0)) return NULL;
     return i2c_readb(addr, nbytes);
 }
 
+/**
+ * @brief i2c_read_regs_dma - start reading of `nbytes` registers from `reg` over DMA
+ * register address is sent by CPU, data is read by DMA; check result by `i2c_dma_state`
+ * @return 0 if bus is busy or device didn't answer
+ */
+uint8_t i2c_read_regs_dma(uint8_t addr, uint8_t reg, uint8_t nbytes){
+    if(I2Cbusy || !nbytes || !waitISRbit(I2C_ISR_BUSY, 0)) return 0;
+    if(!i2c_writes(addr, &reg, 1, 0)) return 0;
+    goterr = 0;
+    i2c_got_DMA = 0;
+    DMA1_Channel7->CCR = DMARXCCR;
+    DMA1_Channel7->CMAR = (uint32_t) I2Cbuf;
+    DMA1_Channel7->CNDTR = nbytes;
+    (void) I2C1->RXDR; // avoid wrong first byte
+    DMA1_Channel7->CCR = DMARXCCR | DMA_CCR_EN; // init DMA before START sequence
+    dmastart = Tms;
+    I2Cbusy = 1;
+    i2c_startr(addr, nbytes, 1);
+    return 1;
+}
+
+/**
+ * @brief i2c_dma_state - check state of DMA reading
+ * @param buf (o) - data buffer when ready
+ * @return 1 if data ready, 0 if still reading, -1 in case of error or timeout
+ */
+int i2c_dma_state(uint8_t **buf){
+    if(I2Cbusy){
+        if(Tms - dmastart <= I2C_TIMEOUT) return 0;
+        DMA1_Channel7->CCR = 0;
+        I2Cbusy = 0;
+        goterr = 1;
+        I2C1->CR1 = 0; // reset I2C state machine
+        I2C1->ICR = 0x3f38;
+        I2C1->CR1 = I2C_CR1_PE | I2C_CR1_RXDMAEN;
+    }
+    if(goterr){
+        goterr = 0;
+        return -1;
+    }
+    if(!i2c_got_DMA) return -1; // nothing was started
+    i2c_got_DMA = 0;
+    if(buf) *buf = I2Cbuf;
+    return 1;
+}
+
 void i2c_init_scan_mode(){
     i2caddr = 1; // start from 1 as 0 is a broadcast address
     i2c_scanmode = 1;
@@ -211,6 +268,7 @@ void i2c_init_scan_mode(){
 // if addresses are over, return 1 and set addr to I2C_NOADDR
 // if scan mode inactive, return 0 and set addr to I2C_NOADDR
 int i2c_scan_next_addr(uint8_t *addr){
+    if(I2Cbusy) return 0;
     *addr = i2caddr;
     if(i2caddr == I2C_ADDREND){
         *addr = I2C_ADDREND;
@@ -220,3 +278,12 @@ int i2c_scan_next_addr(uint8_t *addr){
     if(!i2c_read((i2caddr++)<<1, 1)) return 0;
     return 1;
 }
+
+// I2C1_Rx
+void dma1_channel7_isr(){
+    if(DMA1->ISR & DMA_ISR_TEIF7) goterr = 1;
+    else i2c_got_DMA = 1;
+    DMA1_Channel7->CCR = 0;
+    I2Cbusy = 0;
+    DMA1->IFCR = DMA_IFCR_CGIF7;
+}
@@ -39,6 +39,8 @@ void i2c_setup(i2c_speed_t speed);
 
 uint8_t *i2c_read(uint8_t addr, uint8_t nbytes);
 uint8_t *i2c_read_regs(uint8_t addr, uint8_t reg, uint8_t nbytes);
+uint8_t i2c_read_regs_dma(uint8_t addr, uint8_t reg, uint8_t nbytes);
+int i2c_dma_state(uint8_t **buf);
 
 uint8_t i2c_write(uint8_t addr, uint8_t *data, uint8_t nbytes);
 
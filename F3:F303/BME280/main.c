@@ -44,7 +44,7 @@ int main(void){
     USBPU_OFF();
     USB_setup();
     //BMP280_setup(0, 1);
-    uint32_t ctr = Tms, Tmeas = 0;
+    uint32_t ctr = Tms;
     USBPU_ON();
     while(1){
         if(Tms - ctr > 499){
@@ -62,20 +62,8 @@ int main(void){
             if(s == BMP280_ERR) BMP280_init();
             else{
                 BMP280_process();
-                s = BMP280_get_status(); // refresh status after processing
-                float Temperature, Pressure, Humidity, Dewpoint;
-                if(s == BMP280_RDY && BMP280_getdata(&Temperature, &Pressure, &Humidity)){
-                    Dewpoint = Tdew(Temperature, Humidity);
-                    USB_sendstr("Tdeg="); USB_sendstr(float2str(Temperature, 2)); USB_sendstr("\nPpa=");
-                    USB_sendstr(float2str(Pressure, 3));
-                    USB_sendstr("\nPmm="); USB_sendstr(float2str(Pressure * 0.00750062f, 2));
-                    USB_sendstr("\nH="); USB_sendstr(float2str(Humidity, 2));
-                    USB_sendstr("\nTdew="); USB_sendstr(float2str(Dewpoint, 1));
-                    newline();
-                }
-                if(contmeas && (Tms - Tmeas > 999)){
-                    if(BMP280_start()) Tmeas = Tms;
-                }
+                bme_sample sample;
+                if(BMP280_getdata(&sample)) printsample(&sample);
             }
         }
         if(i2c_scanmode){
@@ -31,18 +31,19 @@
 static uint8_t locBuffer[LOCBUFFSZ];
 static const char *ERR = "ERR\n", *OK = "OK\n";
 extern volatile uint32_t Tms;
-int contmeas = 0; // continuous measurements each 1s
 
 const char *helpstring =
         "https://github.com/eddyem/stm32samples/tree/master/F3:F303/xxx build#" BUILD_NUMBER " @ " BUILD_DATE "\n"
-        "c - set/reset continuous measurements\n"
+        "c - start/stop continuous measurements (normal mode)\n"
         "s - send up to 32 bytes of data over SPI and read answer\n"
         "Axi - init BME280 with address x (0/1) and interface i (I/S - I2C/SPI)\n"
+        "Bx - set standby time of normal mode to x (0..7)\n"
         "Fx- set filter to x (0..4)\n"
         "I - [re]init I2C\n"
         "Is - scan I2C bus\n"
         "M - start measurement\n"
         "Ovx - set oversampling of v(t, h or p) to x(0..5)\n"
+        "R - read all stored samples of continuous measurements\n"
         "S - [re]init SPI1\n"
         "T - print current Tms\n"
 ;
@@ -72,6 +73,39 @@ TRUE_INLINE const char* spirdwr(const char *buf){
     return NULL;
 }
 
+/**
+ * @brief printsample - print sample (the only place where data is converted to float)
+ * @param s - sample
+ */
+void printsample(const bme_sample *s){
+    float T = (float)s->T / 100.f, P = (float)s->P / 256.f, H = (float)s->H / 1024.f;
+    USB_sendstr("Tms="); USB_sendstr(u2str(s->Tms));
+    USB_sendstr("\nTdeg="); USB_sendstr(float2str(T, 2)); USB_sendstr("\nPpa=");
+    USB_sendstr(float2str(P, 3));
+    USB_sendstr("\nPmm="); USB_sendstr(float2str(P * 0.00750062f, 2));
+    USB_sendstr("\nH="); USB_sendstr(float2str(H, 2));
+    USB_sendstr("\nTdew="); USB_sendstr(float2str(Tdew(T, H), 1));
+    newline();
+}
+
+// print stored samples by batches, one line per sample: Tms T P H
+static void readsamples(){
+    bme_sample buf[16];
+    uint32_t lost;
+    int n, total = 0;
+    while((n = BMP280_getsamples(buf, 16, &lost)) > 0){
+        for(int i = 0; i < n; ++i){
+            USB_sendstr(u2str(buf[i].Tms)); USB_putbyte(' ');
+            USB_sendstr(float2str((float)buf[i].T / 100.f, 2)); USB_putbyte(' ');
+            USB_sendstr(float2str((float)buf[i].P / 256.f, 3)); USB_putbyte(' ');
+            USB_sendstr(float2str((float)buf[i].H / 1024.f, 2)); newline();
+        }
+        total += n;
+        if(lost){ USB_sendstr("lost="); USB_sendstr(u2str(lost)); newline(); }
+    }
+    USB_sendstr("samples="); USB_sendstr(u2str(total)); newline();
+}
+
 TRUE_INLINE const char* bmeinint(const char *buf){
     buf = omit_spaces(buf);
     char c = *buf;
@@ -139,6 +173,12 @@ const char *parse_cmd(const char *buf){
                 return spirdwr(buf);
             case 'A':
                 return bmeinint(buf);
+            case 'B':
+                buf = omit_spaces(buf);
+                if(buf != getnum(buf, &U32) && U32 < 8){
+                    BMP280_setstandby((uint8_t)U32);
+                    return OK;
+                }else return ERR;
             case 'F':
                 buf = omit_spaces(buf);
                 if(buf != getnum(buf, &U32) && U32 < BMP280_FILTERMAX){
@@ -158,11 +198,13 @@ const char *parse_cmd(const char *buf){
     // "short" commands
     switch(*buf){
         case 'c':
-            contmeas = !contmeas;
-            if(contmeas){
-                if(BMP280_start()) return OK;
-                return ERR;
+            if(BMP280_get_status() == BMP280_CONT){
+                BMP280_stopcont();
+                return OK;
             }
+            if(!BMP280_startcont()) return ERR;
+            USB_sendstr("period="); USB_sendstr(u2str(BMP280_getperiod()));
+            newline();
             return OK;
         case 'I':
             i2c_setup(I2C_SPEED_400K);
@@ -171,6 +213,9 @@ const char *parse_cmd(const char *buf){
             if(!BMP280_start()) return ERR;
             else return OK;
         break;
+        case 'R':
+            readsamples();
+        break;
         case 'S':
             spi_setup();
             return OK;
@@ -18,6 +18,8 @@
 
 #pragma once
 
-extern int contmeas;
+#include "BMP280.h"
+
 char *parse_cmd(char *buf);
+void printsample(const bme_sample *s);
 
@@ -26,6 +26,10 @@
 #endif
 
 spiStatus spi_status = SPI_NOTREADY;
+static volatile uint8_t spi_got_DMA = 0, spi_dmaerr = 0;
+static uint32_t dmastart; // Tms of DMA start
+// timeout of DMA transfer, ms
+#define SPI_DMA_TIMEOUT     (5)
 #define WAITX(x)  do{volatile uint32_t  wctr = 0; while((x) && (++wctr < 360000)) IWDG->KR = IWDG_REFRESH; if(wctr==360000){ DBG("timeout"); return 0;}}while(0)
 
 // init SPI @ ~280kHz (36MHz/128)
@@ -46,6 +50,13 @@ void spi_setup(){
     // hardware NSS management, RXNE after 8bit; 8bit transfer (default)
     // DS=8bit; RXNE generates after 8bit of data in FIFO;
     SPI1->CR2 = SPI_CR2_SSOE | SPI_CR2_FRXTH | SPI_CR2_DS_2|SPI_CR2_DS_1|SPI_CR2_DS_0;
+    // DMA1 channel 2 - SPI1_Rx, channel 3 - SPI1_Tx; only Rx completion is interesting
+    RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+    DMA1_Channel2->CCR = 0;
+    DMA1_Channel3->CCR = 0;
+    DMA1_Channel2->CPAR = (uint32_t) &SPI1->DR;
+    DMA1_Channel3->CPAR = (uint32_t) &SPI1->DR;
+    NVIC_EnableIRQ(DMA1_Channel2_IRQn);
     spi_status = SPI_READY;
     DBG("SPI works");
 }
@@ -111,3 +122,62 @@ uint8_t spi_read(uint8_t *data, uint8_t n){
     return 1;
 }
 
+
+/**
+ * @brief spi_writeread_dma - start full-duplex DMA transfer, CS is set low till its end
+ * @param data - data to write/read (received bytes will be there)
+ * @param n - length of data
+ * @return 0 if failed
+ */
+uint8_t spi_writeread_dma(uint8_t *data, uint8_t n){
+    if(spi_status != SPI_READY || !data || !n) return 0;
+    spi_status = SPI_BUSY;
+    spi_got_DMA = 0;
+    spi_dmaerr = 0;
+    for(int i = 0; i < 4; ++i) (void) SPI1->DR;
+    DMA1_Channel2->CMAR = (uint32_t) data;
+    DMA1_Channel2->CNDTR = n;
+    DMA1_Channel3->CMAR = (uint32_t) data;
+    DMA1_Channel3->CNDTR = n;
+    // order from reference manual: RXDMAEN, channels, TXDMAEN, SPE
+    SPI1->CR2 |= SPI_CR2_RXDMAEN;
+    DMA1_Channel2->CCR = DMA_CCR_MINC | DMA_CCR_TCIE | DMA_CCR_TEIE | DMA_CCR_EN;
+    DMA1_Channel3->CCR = DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_EN;
+    SPI1->CR2 |= SPI_CR2_TXDMAEN;
+    dmastart = Tms;
+    SPI_CS_0();
+    spi_onoff(TRUE);
+    return 1;
+}
+
+static void spi_dmastop(){
+    DMA1_Channel2->CCR = 0;
+    DMA1_Channel3->CCR = 0;
+    spi_onoff(FALSE);
+    SPI1->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+    SPI_CS_1();
+    spi_status = SPI_READY;
+}
+
+/**
+ * @brief spi_dma_state - check state of DMA transfer
+ * @return 1 if done, 0 if in progress, -1 in case of error or timeout
+ */
+int spi_dma_state(){
+    if(spi_status == SPI_BUSY){
+        if(Tms - dmastart <= SPI_DMA_TIMEOUT) return 0;
+        spi_dmastop();
+        return -1;
+    }
+    if(spi_dmaerr || !spi_got_DMA) return -1;
+    spi_got_DMA = 0;
+    return 1;
+}
+
+// SPI1_Rx: all data received
+void dma1_channel2_isr(){
+    if(DMA1->ISR & DMA_ISR_TEIF2) spi_dmaerr = 1;
+    else spi_got_DMA = 1;
+    DMA1->IFCR = DMA_IFCR_CGIF2 | DMA_IFCR_CGIF3;
+    spi_dmastop();
+}
@@ -33,3 +33,5 @@ void spi_setup();
 uint8_t spi_waitbsy();
 uint8_t spi_writeread(uint8_t *data, uint8_t n);
 uint8_t spi_read(uint8_t *data, uint8_t n);
+uint8_t spi_writeread_dma(uint8_t *data, uint8_t n);
+int spi_dma_state();
@@ -0,0 +1,271 @@
+/*
+ * This file is part of the multiiface project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host simulation of U[S]ART -> USB bridge (../ubridge.c): five channels at full speed,
+// slow or paused USB host; check that every lost byte is counted
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../ubridge.h"
+
+#define NCHANS      5
+#define RINGSZ      512     // DMARXBUFSZ
+#define USBRINGSZ   256     // RBOUTSZ
+#define USBPKT      64      // USB_TXBUFSZ
+#define IRQCHAN     4       // UART5 is interrupt-driven, others use DMA
+#define TICKUS      10      // simulation step, us
+
+// USB output ringbuffer: data and its offsets in U[S]ART stream
+typedef struct{
+    uint8_t data[USBRINGSZ];
+    uint32_t off[USBRINGSZ];
+    int head, len;
+} usbring;
+
+typedef struct{
+    ub_chan c;
+    uint8_t ring[RINGSZ];
+    uint16_t dmapos;        // DMA write position
+    uint8_t need2send;
+    // sender
+    double acc;             // fractional amount of bytes to send
+    uint32_t seq;           // number of next byte
+    int burst;              // bytes left in current burst
+    int gap;                // ticks of pause left
+    int skid;               // bytes sender still sends after RTS deasserted
+    uint8_t idlearmed;      // IDLE interrupt will fire when line stops
+    uint32_t *seqof;        // number of byte at given offset of ring stream (interrupt-driven)
+    size_t seqsz;
+    // host
+    usbring usb;
+    int pause;              // ms of host pause left
+    uint32_t nextseq;       // expected number of next byte
+    uint64_t got, gaps, bad;
+} simchan;
+
+static simchan ch[NCHANS];
+static int flowctl = 0, skidlen = 16, maxburst = 4096;
+
+static uint8_t pattern(int n, uint32_t seq){
+    uint32_t x = (seq + 1) * 2654435761u ^ (uint32_t)n * 0x9e3779b9u;
+    return (uint8_t)(x >> 24);
+}
+
+// USB_trysend() analog
+static int trysend(uint8_t ifno, const uint8_t *buf, int len){
+    simchan *s = &ch[ifno];
+    usbring *u = &s->usb;
+    int space = USBRINGSZ - 1 - u->len;
+    if(len > space) len = space;
+    uint32_t off = s->c.rtail; // offset of buf[0]: reader is moved only after send
+    for(int i = 0; i < len; ++i){
+        int idx = (u->head + u->len) % USBRINGSZ;
+        u->data[idx] = buf[i];
+        u->off[idx] = off + (uint32_t)i;
+        ++u->len;
+    }
+    return len;
+}
+
+static void forward(int n){
+    if(n != IRQCHAN) ub_dmapos(&ch[n].c, ch[n].dmapos);
+    ub_forward(&ch[n].c, trysend, (uint8_t)n);
+    if(ub_datalen(&ch[n].c)) ch[n].need2send = 1;
+}
+
+// byte came into U[S]ART
+static void rxbyte(int n, uint8_t b){
+    simchan *s = &ch[n];
+    s->idlearmed = 1;
+    if(n == IRQCHAN){
+        if(ub_put(&s->c, b)){
+            uint32_t off = s->c.whead - 1;
+            if(off >= s->seqsz){
+                s->seqsz = s->seqsz ? s->seqsz * 2 : 65536;
+                s->seqof = realloc(s->seqof, s->seqsz * sizeof(uint32_t));
+            }
+            s->seqof[off] = s->seq;
+        }
+        if(ub_datalen(&s->c) >= USBPKT) forward(n);
+        return;
+    }
+    s->ring[s->dmapos++] = b;
+    if(s->dmapos == RINGSZ / 2 || s->dmapos == RINGSZ){ // HT or TC interrupt
+        if(s->dmapos == RINGSZ) s->dmapos = 0;
+        forward(n);
+    }
+}
+
+static void sender(int n, double bytespertick){
+    simchan *s = &ch[n];
+    if(flowctl){
+        if(s->c.stop){
+            if(s->skid == 0) s->acc = 0.;
+        }else s->skid = skidlen;
+    }
+    int stopped = flowctl && s->c.stop && s->skid == 0;
+    if(stopped || (s->burst == 0 && s->gap > 0)){
+        if(!stopped) --s->gap;
+        if(s->idlearmed){ // line is idle
+            s->idlearmed = 0;
+            forward(n);
+        }
+        return;
+    }
+    if(s->burst == 0){
+        s->burst = 1 + (int)(lrand48() % maxburst);
+        s->gap = 1 + (int)(lrand48() % 100);
+    }
+    s->acc += bytespertick;
+    while(s->acc >= 1. && s->burst){
+        s->acc -= 1.;
+        rxbyte(n, pattern(n, s->seq));
+        ++s->seq;
+        --s->burst;
+        if(flowctl && s->c.stop && s->skid && --s->skid == 0) break;
+    }
+}
+
+// USB host reads data
+static void host(int n, int budget){
+    simchan *s = &ch[n];
+    usbring *u = &s->usb;
+    while(budget-- && u->len){
+        uint8_t b = u->data[u->head];
+        uint32_t off = u->off[u->head];
+        u->head = (u->head + 1) % USBRINGSZ;
+        --u->len;
+        uint32_t seq = (n == IRQCHAN) ? s->seqof[off] : off;
+        if(b != pattern(n, seq) || seq < s->nextseq) ++s->bad;
+        else s->gaps += seq - s->nextseq;
+        s->nextseq = seq + 1;
+        ++s->got;
+    }
+}
+
+static void usage(const char *self){
+    fprintf(stderr, "Usage: %s [options]\n", self);
+    fprintf(stderr, "\t-b - baudrate of all channels (default 921600)\n");
+    fprintf(stderr, "\t-u - USB throughput, bytes per ms (default 1000)\n");
+    fprintf(stderr, "\t-p - probability of host pause for each channel every ms (default 0.01)\n");
+    fprintf(stderr, "\t-P - max pause length, ms (default 50)\n");
+    fprintf(stderr, "\t-t - simulation time, ms (default 10000)\n");
+    fprintf(stderr, "\t-f - senders obey RTS (flow control)\n");
+    fprintf(stderr, "\t-k - bytes sender sends after RTS deasserted (default 16)\n");
+    fprintf(stderr, "\t-m - max burst length (default 4096)\n");
+    fprintf(stderr, "\t-s - seed for random generator\n");
+    exit(1);
+}
+
+int main(int argc, char **argv){
+    int opt, usbrate = 1000, maxpause = 50;
+    long baud = 921600, T = 10000, seed = 1;
+    double pausep = 0.01;
+    while((opt = getopt(argc, argv, "b:u:p:P:t:fk:m:s:")) != -1){
+        switch(opt){
+            case 'b':
+                baud = atol(optarg);
+                if(baud < 300) usage(argv[0]);
+            break;
+            case 'u':
+                usbrate = atoi(optarg);
+                if(usbrate < 1) usage(argv[0]);
+            break;
+            case 'p':
+                pausep = atof(optarg);
+                if(pausep < 0. || pausep > 1.) usage(argv[0]);
+            break;
+            case 'P':
+                maxpause = atoi(optarg);
+                if(maxpause < 1) usage(argv[0]);
+            break;
+            case 't':
+                T = atol(optarg);
+                if(T < 1) usage(argv[0]);
+            break;
+            case 'f':
+                flowctl = 1;
+            break;
+            case 'k':
+                skidlen = atoi(optarg);
+                if(skidlen < 0) usage(argv[0]);
+            break;
+            case 'm':
+                maxburst = atoi(optarg);
+                if(maxburst < 1) usage(argv[0]);
+            break;
+            case 's':
+                seed = atol(optarg);
+            break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    srand48(seed);
+    for(int n = 0; n < NCHANS; ++n) ub_init(&ch[n].c, ch[n].ring, RINGSZ);
+    double bpt = baud / 10. * TICKUS * 1e-6; // 8N1
+    int rr = 0;
+    for(long t = 0; t < T * 1000 / TICKUS; ++t){
+        for(int n = 0; n < NCHANS; ++n) sender(n, bpt);
+        for(int n = 0; n < NCHANS; ++n) if(ch[n].need2send){ // main loop
+            ch[n].need2send = 0;
+            forward(n);
+        }
+        if(t % (1000 / TICKUS)) continue;
+        // next USB frame: round-robin packets of non-paused channels
+        int budget = usbrate, any = 1;
+        for(int n = 0; n < NCHANS; ++n){
+            if(ch[n].pause) --ch[n].pause;
+            else if(drand48() < pausep) ch[n].pause = 1 + (int)(lrand48() % maxpause);
+        }
+        while(budget > 0 && any){
+            any = 0;
+            for(int i = 0; i < NCHANS && budget > 0; ++i){
+                int n = (rr + i) % NCHANS;
+                if(ch[n].pause || !ch[n].usb.len) continue;
+                int l = ch[n].usb.len;
+                if(l > USBPKT) l = USBPKT;
+                if(l > budget) l = budget;
+                host(n, l);
+                budget -= l;
+                any = 1;
+            }
+            rr = (rr + 1) % NCHANS;
+        }
+    }
+    int ret = 0;
+    printf("%ld ms, %ld baud, USB %d bytes/ms, flow control %s\n", T, baud, usbrate, flowctl ? "on" : "off");
+    printf("IF     sent      got     lost   stalls    stops   missed  corrupt\n");
+    for(int n = 0; n < NCHANS; ++n){
+        simchan *s = &ch[n];
+        if(n != IRQCHAN) ub_dmapos(&s->c, s->dmapos); // bytes got after last interrupt
+        uint64_t inflight = ub_datalen(&s->c) + (uint64_t)s->usb.len;
+        // all not delivered bytes should be counted as lost
+        int64_t silent = (int64_t)s->seq - (int64_t)s->got - (int64_t)inflight - (int64_t)s->c.stat.lost;
+        printf("%d %9u %8llu %8u %8u %8u %8lld %8llu\n", n + 1, s->seq, (unsigned long long)s->got,
+               s->c.stat.lost, s->c.stat.stalls, s->c.stat.stops, (long long)silent, (unsigned long long)s->bad);
+        if(silent || s->bad || s->gaps > s->c.stat.lost) ret = 2;
+        if(flowctl && s->c.stat.lost) ret = 2;
+        free(s->seqof);
+    }
+    printf("%s\n", ret ? "FAILED" : "OK");
+    return ret;
+}
@@ -47,6 +47,7 @@ const char *helpstring =
         "R - soft reset\n"
         "S - store new parameters into flash\n"
         "T - print current Tms\n"
+        "U - show U[S]ART bridge statistics and throughput (since previous call)\n"
 ;
 
 // dump flash configuration
@@ -138,6 +139,34 @@ static void Uconfig(){
     }
 }
 
+#define USTATNO 5
+// U[S]ART bridge statistics
+static void Ustat(){
+    static uint32_t Tlast = 0, rxlast[USTATNO] = {0}, txlast[USTATNO] = {0};
+    uint32_t dT = Tms - Tlast;
+    Tlast = Tms;
+    if(dT == 0) dT = 1;
+    for(int i = 0; i < USTATNO; ++i){
+        const ub_stat *s = usart_stat(i);
+        if(!s) continue;
+        if(s->rx < rxlast[i]) rxlast[i] = 0; // statistics was cleared by restart
+        if(s->tx < txlast[i]) txlast[i] = 0;
+        CFGWR("Interface "); USB_putbyte(ICFG, '0' + i);
+        CFGWR(": rx="); CFGWR(u2str(s->rx));
+        CFGWR(", fwd="); CFGWR(u2str(s->fwd));
+        CFGWR(", tx="); CFGWR(u2str(s->tx));
+        CFGWR(", lost="); CFGWR(u2str(s->lost));
+        CFGWR(", ore="); CFGWR(u2str(s->ore));
+        CFGWR(", stalls="); CFGWR(u2str(s->stalls));
+        CFGWR(", stops="); CFGWR(u2str(s->stops));
+        // bytes per second
+        CFGWR("; rxrate="); CFGWR(u2str((uint32_t)((uint64_t)(s->rx - rxlast[i]) * 1000 / dT)));
+        CFGWR(", txrate="); CFGWRn(u2str((uint32_t)((uint64_t)(s->tx - txlast[i]) * 1000 / dT)));
+        rxlast[i] = s->rx;
+        txlast[i] = s->tx;
+    }
+}
+
 static const char* setCANspeed(char *buf){
     uint32_t N;
     if(buf == getnum(buf, &N)) return sERRn;
@@ -193,6 +222,9 @@ const char *parse_cmd(char *buf){
             CFGWR("T=");
             CFGWRn(u2str(Tms));
             break;
+        case 'U':
+            Ustat();
+            break;
         default: // help
             CFGWR(helpstring);
         break;
@@ -0,0 +1,113 @@
+/*
+ * This file is part of the multiiface project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "ubridge.h"
+
+/**
+ * @brief ub_init - clear channel and its statistics
+ * @param c - channel
+ * @param buf - ring buffer (for DMA-driven: DMA circular buffer)
+ * @param size - its size
+ */
+void ub_init(ub_chan *c, uint8_t *buf, uint16_t size){
+    memset(c, 0, sizeof(ub_chan));
+    c->buf = buf;
+    c->size = size;
+}
+
+/**
+ * @brief ub_put - put next byte (interrupt-driven channel)
+ * @param c - channel
+ * @param byte - data
+ * @return 0 if ring is full (byte lost)
+ */
+int ub_put(ub_chan *c, uint8_t byte){
+    ++c->stat.rx;
+    if(c->whead - c->rtail >= c->size){
+        ++c->stat.lost;
+        return 0;
+    }
+    c->buf[c->widx] = byte;
+    if(++c->widx == c->size) c->widx = 0;
+    ++c->whead;
+    return 1;
+}
+
+/**
+ * @brief ub_dmapos - refresh writer position of DMA-driven channel
+ * should be called at least twice per ring (half and full transfer interrupts) to not miss laps
+ * @param c - channel
+ * @param pos - index of next byte DMA will write (size - CNDTR)
+ */
+void ub_dmapos(ub_chan *c, uint16_t pos){
+    if(pos >= c->size) pos = 0; // CNDTR reloaded
+    uint32_t n = (pos >= c->widx) ? pos - c->widx : c->size - c->widx + pos;
+    c->widx = pos;
+    c->stat.rx += n;
+    c->whead += n;
+}
+
+// amount of data waiting for forwarding
+uint32_t ub_datalen(const ub_chan *c){
+    return c->whead - c->rtail;
+}
+
+static void skip(ub_chan *c, uint32_t n){
+    c->ridx = (uint16_t)((c->ridx + n) % c->size);
+    c->rtail += n;
+}
+
+/**
+ * @brief ub_forward - send to USB as much data as it can accept now
+ * @param c - channel
+ * @param send - non-blocking send function
+ * @param ifno - its interface number
+ * @return amount of bytes forwarded
+ */
+int ub_forward(ub_chan *c, ub_sendfn send, uint8_t ifno){
+    uint32_t len = c->whead - c->rtail;
+    if(len >= c->size){ // DMA lapped reader: oldest data is overwritten, leave only last half of ring
+        uint32_t drop = len - c->size / 2;
+        skip(c, drop);
+        c->stat.lost += drop;
+        len -= drop;
+    }
+    int total = 0;
+    while(len){
+        uint32_t chunk = c->size - c->ridx;
+        if(chunk > len) chunk = len;
+        int s = send(ifno, c->buf + c->ridx, (int)chunk);
+        if(s < 1) break;
+        skip(c, (uint32_t)s);
+        total += s;
+        len -= (uint32_t)s;
+        if((uint32_t)s < chunk) break; // no more credits
+    }
+    c->stat.fwd += (uint32_t)total;
+    if(len){
+        if(!c->stalled) ++c->stat.stalls;
+        c->stalled = 1;
+    }else c->stalled = 0;
+    if(!c->stop && len > UB_STOP_LEVEL(c->size)){
+        c->stop = 1;
+        ++c->stat.stops;
+    }else if(c->stop && len < UB_GO_LEVEL(c->size)) c->stop = 0;
+    return total;
+}
@@ -0,0 +1,66 @@
+/*
+ * This file is part of the multiiface project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Hardware-independent part of U[S]ART -> USB bridge.
+ * Each channel has Rx ring filled by DMA (circular mode) or by RXNE interrupt.
+ * Data is forwarded only in amount that USB side can accept right now ("credits" =
+ * free space in USB output ringbuffer), rest stays in ring till next try.
+ * When ring fills over UB_STOP_LEVEL `stop` flag is set (deassert RTS), it's cleared
+ * when data length becomes less than UB_GO_LEVEL.
+ * Nothing is thrown away silently: all lost bytes are counted in `stat.lost`.
+ */
+
+// flow control levels (part of ring size)
+#define UB_STOP_LEVEL(sz)   ((sz) * 3 / 4)
+#define UB_GO_LEVEL(sz)     ((sz) / 4)
+
+// non-blocking send: @return amount of bytes accepted (0 if no space or busy)
+typedef int (*ub_sendfn)(uint8_t ifno, const uint8_t *buf, int len);
+
+typedef struct{
+    uint32_t rx;        // bytes got from U[S]ART
+    uint32_t fwd;       // bytes forwarded to USB
+    uint32_t tx;        // bytes sent to U[S]ART (counted by caller)
+    uint32_t lost;      // bytes lost due to ring overflow
+    uint32_t ore;       // hardware overruns (counted by caller)
+    uint32_t stalls;    // amount of times when forwarding was stopped by lack of USB credits
+    uint32_t stops;     // amount of `stop` flag settings
+} ub_stat;
+
+typedef struct{
+    uint8_t *buf;               // ring data
+    uint16_t size;              // and its size
+    uint16_t widx;              // writer position (DMA position for DMA-driven)
+    uint16_t ridx;              // reader position
+    volatile uint32_t whead;    // total amount of bytes written
+    volatile uint32_t rtail;    // total amount of bytes read (forwarded or dropped)
+    volatile uint8_t stop;      // ==1 if sender should be stopped (RTS deasserted)
+    uint8_t stalled;            // ==1 if last forwarding was limited by USB
+    ub_stat stat;
+} ub_chan;
+
+void ub_init(ub_chan *c, uint8_t *buf, uint16_t size);
+int ub_put(ub_chan *c, uint8_t byte);
+void ub_dmapos(ub_chan *c, uint16_t pos);
+uint32_t ub_datalen(const ub_chan *c);
+int ub_forward(ub_chan *c, ub_sendfn send, uint8_t ifno);
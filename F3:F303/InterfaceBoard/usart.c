@@ -22,6 +22,7 @@
 #include "Debug.h"
 #include "hardware.h"
 #include "strfunc.h"
+#include "ubridge.h"
 #include "usart.h"
 #include "usb_descr.h" // InterfacesAmount, IFx, bufsz
 #include "usb_dev.h" // get fresh USB input data
@@ -34,12 +35,17 @@ typedef struct {
     uint32_t pclk_freq;                             // APB1/APB2 frequency
     int16_t  UIRQn;                                 // USART IRQ number
     int16_t  DIRQn;                                 // DMA Tx IRQ number (for DMA-driven)
+    int16_t  RIRQn;                                 // DMA Rx IRQ number (half/full transfer)
     volatile DMA_TypeDef *dma_controller;           // DMA1/DMA2 or NULL if not used
     volatile DMA_Channel_TypeDef *dma_rx_channel;   // e.g., DMA_Channel_5 or NULL if not used
     volatile DMA_Channel_TypeDef *dma_tx_channel;   // e.g., DMA_Channel_4 or NULL if not used
     uint32_t TTCflag;                               // Tx transfer complete flag
     volatile GPIO_TypeDef *DEport;                  // if RS485 - DE GPIO port (NULL for RS-232 or RS-422)
     uint32_t DEpin;                                 // -//- pin
+    volatile GPIO_TypeDef *RTSport;                 // flow control hooks: RTS output (NULL if not used)
+    uint32_t RTSpin;
+    volatile GPIO_TypeDef *CTSport;                 // CTS input (NULL if not used)
+    uint32_t CTSpin;
 } USART_Config;
 
 //   IF    U[S]ART bus  freq    TxDMA    RxDMA   DE (if 485)
@@ -55,24 +61,56 @@ static const USART_Config UC[USARTSNO] = {
 #ifdef SPIDMA
     [0] = {.instance = USART3, .pclk_freq = 36000000, .UIRQn = USART3_IRQn, .dma_controller = NULL, .DEport = GPIOB, .DEpin = 1<<14 },
 #else
-    [0] = {.instance = USART3, .pclk_freq = 36000000, .UIRQn = USART3_IRQn, .DIRQn = DMA1_Channel2_IRQn, .dma_controller = DMA1, .dma_rx_channel = DMA1_Channel3, .dma_tx_channel = DMA1_Channel2, .TTCflag = DMA_ISR_TCIF2, .DEport = GPIOB, .DEpin = 1<<14 },
+    [0] = {.instance = USART3, .pclk_freq = 36000000, .UIRQn = USART3_IRQn, .DIRQn = DMA1_Channel2_IRQn, .RIRQn = DMA1_Channel3_IRQn, .dma_controller = DMA1, .dma_rx_channel = DMA1_Channel3, .dma_tx_channel = DMA1_Channel2, .TTCflag = DMA_ISR_TCIF2, .DEport = GPIOB, .DEpin = 1<<14 },
 #endif
-    [1] = {.instance = USART1, .pclk_freq = 72000000, .UIRQn = USART1_IRQn, .DIRQn = DMA1_Channel4_IRQn, .dma_controller = DMA1, .dma_rx_channel = DMA1_Channel5, .dma_tx_channel = DMA1_Channel4, .TTCflag = DMA_ISR_TCIF4, .DEport = GPIOB, .DEpin = 1<<0  },
-    [2] = {.instance = USART2, .pclk_freq = 36000000, .UIRQn = USART2_IRQn, .DIRQn = DMA1_Channel7_IRQn, .dma_controller = DMA1, .dma_rx_channel = DMA1_Channel6, .dma_tx_channel = DMA1_Channel7, .TTCflag = DMA_ISR_TCIF7, .DEport = GPIOA, .DEpin = 1<<1  },
-    [3] = {.instance = UART4,  .pclk_freq = 36000000, .UIRQn = UART4_IRQn,  .DIRQn = DMA2_Channel5_IRQn, .dma_controller = DMA2, .dma_rx_channel = DMA2_Channel3, .dma_tx_channel = DMA2_Channel5, .TTCflag = DMA_ISR_TCIF5 },
+    [1] = {.instance = USART1, .pclk_freq = 72000000, .UIRQn = USART1_IRQn, .DIRQn = DMA1_Channel4_IRQn, .RIRQn = DMA1_Channel5_IRQn, .dma_controller = DMA1, .dma_rx_channel = DMA1_Channel5, .dma_tx_channel = DMA1_Channel4, .TTCflag = DMA_ISR_TCIF4, .DEport = GPIOB, .DEpin = 1<<0  },
+    [2] = {.instance = USART2, .pclk_freq = 36000000, .UIRQn = USART2_IRQn, .DIRQn = DMA1_Channel7_IRQn, .RIRQn = DMA1_Channel6_IRQn, .dma_controller = DMA1, .dma_rx_channel = DMA1_Channel6, .dma_tx_channel = DMA1_Channel7, .TTCflag = DMA_ISR_TCIF7, .DEport = GPIOA, .DEpin = 1<<1  },
+    [3] = {.instance = UART4,  .pclk_freq = 36000000, .UIRQn = UART4_IRQn,  .DIRQn = DMA2_Channel5_IRQn, .RIRQn = DMA2_Channel3_IRQn, .dma_controller = DMA2, .dma_rx_channel = DMA2_Channel3, .dma_tx_channel = DMA2_Channel5, .TTCflag = DMA_ISR_TCIF5 },
     [4] = {.instance = UART5,  .pclk_freq = 36000000, .UIRQn = UART5_IRQn }, // no DMA
 };
 
 // buffers for DMA or interrupt-driven data management
-static uint8_t  inbuffers[USARTSNO][DMARXBUFSZ];
-static uint16_t inbufidx[USARTSNO] = {0};       // for interrupt-driven - index of next character (also amount of received bytes)
+static uint8_t  inbuffers[USARTSNO][DMARXBUFSZ]; // Rx rings
+static ub_chan  uch[USARTSNO];                  // and their management
 static uint8_t  outbuffers[USARTSNO][DMATXBUFSZ];
 static uint16_t outbufidx[USARTSNO] = {0};      // index of next char to transmit over interrupt
 static uint16_t outbuflen[USARTSNO] = {0};      // length of data to transmit over interrupt [equal 0 if nothing to send]
-static uint8_t  need2send[USARTSNO] = {0};      // flags from IDLE interrupt to send data portion
+static volatile uint8_t need2send[USARTSNO] = {0}; // data left in ring: USB had no credits or forwarding was busy
+static volatile uint8_t fwdbusy[USARTSNO] = {0}; // forwarding is in progress
 static uint8_t  TXrdy[USARTSNO] = {1,1,1,1,1};  // TX DMA ready
-static int      dma_read_idx[USARTSNO] = {0};   // start of data in DMA inbuffers
-// there's no way to tell recipient about overfull, so we will just "eat" spare data!
+// if USB can't accept data, it stays in Rx ring and sender is stopped by RTS (if present);
+// when ring overflows, lost bytes are counted in statistics
+
+// RTS is active low: set pin to stop sender
+static void RTS_set(const USART_Config *cfg, uint8_t stop){
+    if(!cfg->RTSport) return;
+    if(stop) cfg->RTSport->BSRR = cfg->RTSpin;
+    else cfg->RTSport->BRR = cfg->RTSpin;
+}
+// @return 1 if recipient is ready (CTS is low or absent)
+static int CTS_ok(const USART_Config *cfg){
+    if(!cfg->CTSport) return 1;
+    return !(cfg->CTSport->IDR & cfg->CTSpin);
+}
+
+/**
+ * @brief forward - forward received data to USB (from main loop or from U[S]ART/DMA interrupts)
+ * @param ifNo - interface index
+ */
+static void forward(uint8_t ifNo){
+    if(fwdbusy[ifNo]){ // interrupt came while main loop is forwarding this channel
+        need2send[ifNo] = 1;
+        return;
+    }
+    fwdbusy[ifNo] = 1;
+    const USART_Config *cfg = &UC[ifNo];
+    // refresh DMA position here (not only in interrupts) to have actual ring fill level
+    if(cfg->dma_controller) ub_dmapos(&uch[ifNo], DMARXBUFSZ - cfg->dma_rx_channel->CNDTR);
+    ub_forward(&uch[ifNo], USB_trysend, ifNo);
+    if(ub_datalen(&uch[ifNo])) need2send[ifNo] = 1; // try again later
+    RTS_set(cfg, uch[ifNo].stop);
+    fwdbusy[ifNo] = 0;
+}
 
 
 /**
@@ -177,13 +215,12 @@ void usart_config(uint8_t ifNo, usb_LineCoding *lc){
         R->CPAR = (uint32_t) &U->RDR;
         R->CMAR = (uint32_t) inbuffers[ifNo];
         R->CNDTR = DMARXBUFSZ;
-        R->CCR = DMA_CCR_MINC | DMA_CCR_CIRC | DMA_CCR_EN; // manage circular buffer in polling
+        R->CCR = DMA_CCR_MINC | DMA_CCR_CIRC | DMA_CCR_HTIE | DMA_CCR_TCIE | DMA_CCR_EN; // forward on half and full ring
         // enable U[S]ART DMA
         U->CR3 = USART_CR3_DMAT | USART_CR3_DMAR;
     }else{
         DBG("IRQ-driven");
         cr1 |= USART_CR1_RXNEIE; // interrupt-driven
-        inbufidx[ifNo] = 0;
         outbufidx[ifNo] = 0;
     }
 
@@ -203,17 +240,20 @@ void usart_config(uint8_t ifNo, usb_LineCoding *lc){
 void usart_start(uint8_t ifNo){
     if(ifNo >= USARTSNO || UC[ifNo].instance == NULL) return;
     const USART_Config *cfg = &UC[ifNo];
+    ub_init(&uch[ifNo], inbuffers[ifNo], DMARXBUFSZ);
+    need2send[ifNo] = 0;
+    RTS_set(cfg, 0);
     cfg->instance->CR1 |= USART_CR1_UE;
     NVIC_EnableIRQ(cfg->UIRQn);
     if(cfg->dma_controller){ // reset Rx DMA
         volatile DMA_Channel_TypeDef *R = cfg->dma_rx_channel;
-        dma_read_idx[ifNo] = 0;
         R->CCR = 0;
         R->CPAR = (uint32_t) &cfg->instance->RDR;
         R->CMAR = (uint32_t) inbuffers[ifNo];
         R->CNDTR = DMARXBUFSZ;
-        R->CCR = DMA_CCR_MINC | DMA_CCR_CIRC | DMA_CCR_EN;
+        R->CCR = DMA_CCR_MINC | DMA_CCR_CIRC | DMA_CCR_HTIE | DMA_CCR_TCIE | DMA_CCR_EN;
         NVIC_EnableIRQ(cfg->DIRQn);
+        NVIC_EnableIRQ(cfg->RIRQn);
     }
     DBGch('0' + ifNo);
     DBG("U[S]ART started");
@@ -229,6 +269,7 @@ void usart_stop(uint8_t ifNo){
     cfg->instance->CR1 &= ~USART_CR1_UE;
     if(cfg->dma_controller){
         NVIC_DisableIRQ(cfg->DIRQn);
+        NVIC_DisableIRQ(cfg->RIRQn);
     }
     NVIC_DisableIRQ(cfg->UIRQn);
     if(cfg->DEport) RX485(cfg->DEport, cfg->DEpin);
@@ -238,102 +279,58 @@ void usart_stop(uint8_t ifNo){
 
 /**
  * @brief usarts_process - send/receive processing
- * Try to send data from output ringbuffer, check input DMA buffer and full input ringbuffer
+ * Input data is forwarded to USB from interrupts (IDLE, DMA half/full transfer), here we only
+ * retry forwarding of data rest USB had no place for; send new data from USB
  */
 void usarts_process(){
     for(int i = 0; i < USARTSNO; ++i){ // index by interfaces number!!!
         const USART_Config *cfg = &UC[i];
-        if(!(cfg->instance->CR1 & USART_CR1_UE)) continue; // USART disabled
+        volatile USART_TypeDef *U = cfg->instance;
+        if(!(U->CR1 & USART_CR1_UE)) continue; // USART disabled
+        // Input data
+        if(need2send[i]){
+            need2send[i] = 0;
+            forward(i);
+        }
+        // Output data
+        if(!TXrdy[i] || !CTS_ok(cfg)) continue; // busy or recipient isn't ready
+        int got = USB_receive(i, outbuffers[i], DMATXBUFSZ);
+        if(got < 1) continue;
+        uch[i].stat.tx += got;
+        if(cfg->DEport){ // switch to Tx
+            DBG("485 -> TX");
+            TX485(cfg->DEport, cfg->DEpin);
+            U->CR1 &= ~USART_CR1_RE;
+            U->CR1 |= USART_CR1_TE;
+        }
+        TXrdy[i] = 0;
         if(cfg->dma_controller){ // DMA-driven
-            // Input data
-            int write_idx = DMARXBUFSZ - cfg->dma_rx_channel->CNDTR; // next symbol to be written
-            int available = (write_idx - dma_read_idx[i] + DMARXBUFSZ) % DMARXBUFSZ; // length of data available
-            if(need2send[i] && available == 0) need2send[i] = 0;
-            if(available >= USB_TXBUFSZ || need2send[i]){ // enough data or lonely couple of bytes
-                // copy data in one or two chunks (wrap handling)
-                if(dma_read_idx[i] + available <= DMARXBUFSZ){ // head before tail
-                    USB_send(i, &inbuffers[i][dma_read_idx[i]], available);
-                }else{ // head after tail - two chunks
-                    uint32_t first = DMARXBUFSZ - dma_read_idx[i];
-                    USB_send(i, &inbuffers[i][dma_read_idx[i]], first);
-                    USB_send(i, inbuffers[i], available - first);
-                }
-                DBG("USART -> USB over DMA");
-                dma_read_idx[i] = write_idx; // update read pointer
-            }
-#if 0
-            if(DMARXBUFSZ - cfg->dma_rx_channel->CNDTR > DMARXBUFSZ/2 || need2send[i]){
-               volatile DMA_Channel_TypeDef *R = cfg->dma_rx_channel;
-                R->CCR &= ~DMA_CCR_EN; // pause DMA input transactions
-                register int l = DMARXBUFSZ - R->CNDTR;
-                if(l){ // have some input data -> send and restart DMA
-                    DBG("need");
-                    if(USB_send(i, inbuffers[i], l)){
-                        DBG("USART -> USB over DMA");
-                        // restart DMA only in case of succesfull sent or if failed, but have ability of buffer overfull
-                        R->CMAR = (uint32_t) inbuffers[i];
-                        R->CNDTR = DMARXBUFSZ;
-                        need2send[i] = 0;
-                    }
-                }
-                R->CCR |= DMA_CCR_EN; // re-enable DMA
-            }
-#endif
-            // Output data
-            if(TXrdy[i]){ // ready to send new data
-                int got = USB_receive(i, outbuffers[i], DMATXBUFSZ);
-                if(got > 0){ // send next data portion
-                    volatile DMA_Channel_TypeDef *T = cfg->dma_tx_channel;
-                    //cfg->dma_controller->IFCR = cfg->TTCflag; // now we can clear TC flag (TC and CTC are the same)
-                    T->CCR &= ~DMA_CCR_EN;
-                    T->CMAR = (uint32_t) outbuffers[i];
-                    T->CNDTR = got;
-                    if(cfg->DEport){ // switch to Tx
-                        DBG("485 -> TX");
-                        TX485(cfg->DEport, cfg->DEpin);
-                        cfg->instance->CR1 &= ~USART_CR1_RE;
-                        cfg->instance->CR1 |= USART_CR1_TE;
-                    }
-                    TXrdy[i] = 0;
-                    T->CCR |= DMA_CCR_EN; // start new transmission
-                    DBG("USB -> USART over DMA");
-                }
-            }
+            volatile DMA_Channel_TypeDef *T = cfg->dma_tx_channel;
+            T->CCR &= ~DMA_CCR_EN;
+            T->CMAR = (uint32_t) outbuffers[i];
+            T->CNDTR = got;
+            T->CCR |= DMA_CCR_EN; // start new transmission
+            DBG("USB -> USART over DMA");
         }else{ // interrupt-driven
-            // Input data
-            volatile USART_TypeDef *U = cfg->instance;
-            U->CR1 &= ~USART_CR1_RXNEIE; // temporarily disable interrupt
-            register int l = inbufidx[i];
-            if(l > DMARXBUFSZ/2 || need2send[i]){
-                if(l && USB_send(i, inbuffers[i], l)){
-                    need2send[i] = 0;
-                    inbufidx[i] = 0;
-                    DBG("USART -> USB over irq");
-                }
-            }
-            U->CR1 |= USART_CR1_RXNEIE; // restore irq reaction
-            // output data
-            if(TXrdy[i]){
-                int got = USB_receive(i, outbuffers[i], DMATXBUFSZ);
-                if(got > 0){
-                    if(cfg->DEport){ // switch to Tx
-                        DBG("485 -> TX");
-                        TX485(cfg->DEport, cfg->DEpin);
-                        U->CR1 &= ~USART_CR1_RE;
-                        U->CR1 |= USART_CR1_TE;
-                    }
-                    outbufidx[i] = 1; // continue from next symbol
-                    outbuflen[i] = got;
-                    TXrdy[i] = 0;
-                    U->TDR = outbuffers[i][0]; // start transmission
-                    U->CR1 |= USART_CR1_TXEIE; // enable TXE interrupt
-                    DBG("USB -> USART over irq");
-                }
-            }
+            outbufidx[i] = 1; // continue from next symbol
+            outbuflen[i] = got;
+            U->TDR = outbuffers[i][0]; // start transmission
+            U->CR1 |= USART_CR1_TXEIE; // enable TXE interrupt
+            DBG("USB -> USART over irq");
         }
     }
 }
 
+/**
+ * @brief usart_stat - get statistics of interface
+ * @param ifNo - interface index
+ * @return pointer to statistics or NULL if there's no U[S]ART at this interface
+ */
+const ub_stat *usart_stat(uint8_t ifNo){
+    if(ifNo >= USARTSNO || UC[ifNo].instance == NULL) return NULL;
+    return &uch[ifNo].stat;
+}
+
 // Use this function only for debug purpose
 int usart_send(uint8_t ifNo, const uint8_t *data, int len){
     if(ifNo >= USARTSNO || !data || len < 1) return 0;
@@ -379,14 +376,18 @@ static void usart_isr(uint8_t ifno){
     const USART_Config *cfg = &UC[ifno];
     volatile USART_TypeDef *U = cfg->instance;
     // for every flag we should also check if it's IRQ active
+    if(U->ISR & USART_ISR_ORE){ // data lost in hardware
+        ++uch[ifno].stat.ore;
+        U->ICR = USART_ICR_ORECF;
+    }
     if((U->ISR & USART_ISR_RXNE) && (U->CR1 & USART_CR1_RXNEIE)){ // got new byte
-        if(inbufidx[ifno] == DMARXBUFSZ) (void) U->RDR; // throw away data: buffer overfull
-        else inbuffers[ifno][ inbufidx[ifno]++ ] = U->RDR; // put new byte into buffer
+        ub_put(&uch[ifno], U->RDR); // if buffer is overfull, byte will be counted as lost
+        if(ub_datalen(&uch[ifno]) >= USB_TXBUFSZ) forward(ifno); // full USB packet collected
     }
     // IDLE active for both DMA- and interrupt-driven transitions
-    if(U->ISR & USART_ISR_IDLE){ // try to send collected data (DMA-driven)
-        need2send[ifno] = 1; // seems like data portion is over - try to send it
+    if(U->ISR & USART_ISR_IDLE){ // seems like data portion is over - try to send it
         U->ICR = USART_ICR_IDLECF;
+        forward(ifno);
     }
     if((U->ISR & USART_ISR_TXE) && (U->CR1 & USART_CR1_TXEIE)){ // send next byte if need (interrupt-driven)
         if(outbuflen[ifno] > outbufidx[ifno]){
@@ -413,6 +414,14 @@ void usart3_exti28_isr(){ usart_isr(0); }
 void uart4_exti34_isr(){  usart_isr(3); }
 void uart5_exti35_isr(){  usart_isr(4); }
 
+// DMA Rx interrupts: half and full transfer of ring - forward next portion
+#ifndef SPIDMA
+void dma1_channel3_isr(){ DMA1->IFCR = DMA_IFCR_CGIF3; forward(0); }
+#endif
+void dma1_channel5_isr(){ DMA1->IFCR = DMA_IFCR_CGIF5; forward(1); }
+void dma1_channel6_isr(){ DMA1->IFCR = DMA_IFCR_CGIF6; forward(2); }
+void dma2_channel3_isr(){ DMA2->IFCR = DMA_IFCR_CGIF3; forward(3); }
+
 // DMA Tx interrupts (to arm ready flag)
 #ifndef SPIDMA
 void dma1_channel2_isr(){ TXrdy[0] = 1; DMA1->IFCR = DMA_IFCR_CTCIF2; }
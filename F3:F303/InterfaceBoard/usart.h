@@ -19,6 +19,7 @@
 #pragma once
 
 #include "hardware.h"
+#include "ubridge.h"
 #include "usb_dev.h"
 
 // DMA linear buffers for Rx/Tx
@@ -30,6 +31,7 @@ void usart_start(uint8_t ifNo);
 void usart_stop(uint8_t ifNo);
 
 void usarts_process();
+const ub_stat *usart_stat(uint8_t ifNo);
 
 int usart_send(uint8_t ifNo, const uint8_t *data, int len);
 //int usart_receive(uint8_t ifNo, uint8_t *data, int len);
@@ -268,6 +268,23 @@ int USB_send(uint8_t ifno, const uint8_t *buf, int len){
     return TRUE;
 }
 
+/**
+ * @brief USB_trysend - non-blocking variant of USB_send: put into queue as much data as free space allows
+ * @return amount of bytes queued (0 if buffer is full or busy)
+ */
+int USB_trysend(uint8_t ifno, const uint8_t *buf, int len){
+    if(!buf || !CDCready[ifno] || len < 1) return 0;
+    int l = RB_datalen((ringbuffer*)&rbout[ifno]);
+    if(l < 0) return 0;
+    int space = rbout[ifno].length - 1 - l;
+    if(len > space) len = space;
+    int w = 0;
+    if(len > 0) w = RB_write((ringbuffer*)&rbout[ifno], buf, len);
+    if(w < 0) w = 0;
+    if(lastdsz[ifno] < 0) send_next(ifno); // start transmission if it's not active
+    return w;
+}
+
 /* only try to add data to USB buffer, without sending
 int USB_adddata(uint8_t ifno, const uint8_t *buf, int len){
     return RB_write((ringbuffer*)&rbout[ifno], buf, len);
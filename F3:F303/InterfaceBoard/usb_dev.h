@@ -58,6 +58,7 @@ void linecoding_handler(uint8_t ifno, usb_LineCoding *lc);
 int USB_sendbufspace(uint8_t ifno);
 int USB_sendall(uint8_t ifno);
 int USB_send(uint8_t ifno, const uint8_t *buf, int len);
+int USB_trysend(uint8_t ifno, const uint8_t *buf, int len);
 //int USB_adddata(uint8_t ifno, const uint8_t *buf, int len);
 int USB_putbyte(uint8_t ifno, uint8_t byte);
 int USB_sendstr(uint8_t ifno, const char *string);
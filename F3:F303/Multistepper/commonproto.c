@@ -418,6 +418,42 @@ errcodes cu_screen(uint8_t _U_ par, int32_t _U_ *val){
     return ERR_BADCMD;
 }
 
+// write StallGuard/CoolStep settings into driver, restore old value if failed
+static errcodes sgsetter(uint8_t n, uint8_t *par, int32_t val, int32_t max){
+    if(ismoving(n)) return ERR_CANTRUN;
+    if(val < 0 || val > max) return ERR_BADVAL;
+    if(the_conf.motflags[n].drvtype != DRVTYPE_UART) return ERR_BADCMD;
+    uint8_t old = *par;
+    *par = (uint8_t)val;
+    if(!pdnuart_sgconf(n)){
+        *par = old;
+        return ERR_CANTRUN;
+    }
+    return ERR_OK;
+}
+
+errcodes cu_semin(uint8_t par, int32_t *val){
+    uint8_t n; CHECKN(n, par);
+    errcodes ret = ERR_OK;
+    if(ISSETTER(par)) ret = sgsetter(n, &the_conf.semin[n], *val, 15);
+    *val = the_conf.semin[n];
+    return ret;
+}
+
+errcodes cu_sgload(uint8_t par, int32_t *val){
+    uint8_t n; CHECKN(n, par);
+    *val = getsgload(n);
+    return ERR_OK;
+}
+
+errcodes cu_sgthrs(uint8_t par, int32_t *val){
+    uint8_t n; CHECKN(n, par);
+    errcodes ret = ERR_OK;
+    if(ISSETTER(par)) ret = sgsetter(n, &the_conf.sgthrs[n], *val, 255);
+    *val = the_conf.sgthrs[n];
+    return ret;
+}
+
 errcodes cu_speedlimit(uint8_t _U_ par, int32_t _U_ *val){
     uint8_t n; CHECKN(n, par);
     *val = getSPD(n, 0xffff);
@@ -504,8 +540,11 @@ const fpointer cancmdlist[CCMD_AMOUNT] = {
 //  [CCMD_UDATA] = cu_udata,
 //  [CCMD_USARTSTATUS] = cu_usartstatus,
     [CCMD_VDRIVE] = cu_vdrive,
-    [CCMD_VFIVE] = cu_vfive
+    [CCMD_VFIVE] = cu_vfive,
     // Leave all commands upper for back-compatability with 3steppers
+    [CCMD_SGTHRS] = cu_sgthrs,
+    [CCMD_SEMIN] = cu_semin,
+    [CCMD_SGLOAD] = cu_sgload,
 };
 
 const char* cancmds[CCMD_AMOUNT] = {
@@ -547,4 +586,7 @@ const char* cancmds[CCMD_AMOUNT] = {
     [CCMD_MOTNO] = STR_MOTNO,
     [CCMD_DRVTYPE] = STR_DRVTYPE,
     [CCMD_MOTCURRENT] = STR_MOTCURRENT,
+    [CCMD_SGTHRS] = STR_SGTHRS,
+    [CCMD_SEMIN] = STR_SEMIN,
+    [CCMD_SGLOAD] = STR_SGLOAD,
 };
@@ -97,6 +97,9 @@ enum{
     ,CCMD_MOTNO              // motor number for next PDN command
     ,CCMD_DRVTYPE            // driver type (0 - only step/dir, 1 - UART, 2 - SPI, 3 - reserved)
     ,CCMD_MOTCURRENT         // motor current (1..32 for 1/32..32/32 of max current)
+    ,CCMD_SGTHRS             // StallGuard threshold
+    ,CCMD_SEMIN              // CoolStep lower threshold
+    ,CCMD_SGLOAD             // averaged SG_RESULT
     // should be the last:
     ,CCMD_AMOUNT             // amount of common commands
 };
@@ -137,6 +140,9 @@ errcodes cu_relpos(uint8_t par, int32_t *val);
 errcodes cu_relslow(uint8_t par, int32_t *val);
 errcodes cu_saveconf(uint8_t par, int32_t *val);
 errcodes cu_screen(uint8_t par, int32_t *val);
+errcodes cu_semin(uint8_t par, int32_t *val);
+errcodes cu_sgload(uint8_t par, int32_t *val);
+errcodes cu_sgthrs(uint8_t par, int32_t *val);
 errcodes cu_speedlimit(uint8_t par, int32_t *val);
 errcodes cu_state(uint8_t par, int32_t *val);
 errcodes cu_stop(uint8_t par, int32_t *val);
@@ -48,7 +48,6 @@ static uint32_t maxCnum = 1024 / sizeof(user_conf); // can't use blocksize here
     ,.motcurrent = {31,31,31,31,31,31,31,31} \
     }
 
-static int write2flash(const void*, const void*, uint32_t);
 // don't write `static` here, or get error:
 //      'memcpy' forming offset 8 is out of the bounds [0, 4] of object '__varsstart' with type 'uint32_t'
 const user_conf *Flash_Data = (const user_conf *)(&__varsstart);
@@ -57,6 +56,18 @@ user_conf the_conf = USERCONF_INITIALIZER;
 
 static int currentconfidx = -1; // index of current configuration
 
+// size of user conf storage (from `__varsstart` to telemetry log area)
+static uint32_t storage_size(){
+    uint32_t flsz = 0;
+    if(FLASH_SIZE > 0 && FLASH_SIZE < 20000){
+        flsz = FLASH_SIZE * 1024; // size in bytes
+        flsz -= (uint32_t)(&__varsstart) - FLASH_BASE;
+        if(flsz > FLASHLOG_NPAGES * FLASH_blocksize) flsz -= FLASHLOG_NPAGES * FLASH_blocksize;
+        else flsz = 0;
+    }
+    return flsz;
+}
+
 /**
  * @brief binarySearch - binary search in flash for last non-empty cell
  *          any struct searched should have its sizeof() @ the first field!!!
@@ -89,11 +100,8 @@ static int binarySearch(int r, const uint8_t *start, int stor_size){
  * run in once @ start
  */
 void flashstorage_init(){
-    if(FLASH_SIZE > 0 && FLASH_SIZE < 20000){
-        uint32_t flsz = FLASH_SIZE * 1024; // size in bytes
-        flsz -= (uint32_t)(&__varsstart) - FLASH_BASE;
-        maxCnum = flsz / sizeof(user_conf);
-    }
+    uint32_t flsz = storage_size();
+    if(flsz) maxCnum = flsz / sizeof(user_conf);
     // -1 if there's no data at all & flash is clear; maxnum-1 if flash is full
     currentconfidx = binarySearch((int)maxCnum-2, (const uint8_t*)Flash_Data, sizeof(user_conf));
     if(currentconfidx > -1){
@@ -111,11 +119,19 @@ int store_userconf(){
         curidx = 0;
         if(erase_storage(-1)) return 1;
     }else ++curidx; // take next data position (0 - within first run after firmware flashing)
-    int r = write2flash((const void*)&Flash_Data[curidx], &the_conf, sizeof(the_conf));
+    int r = flash_write((const void*)&Flash_Data[curidx], &the_conf, sizeof(the_conf));
     if(0 == r) currentconfidx = curidx; // refresh counter only if succeed
+    return r;
 }
 
-static int write2flash(const void *start, const void *wrdata, uint32_t stor_size){
+/**
+ * @brief flash_write - write data into erased flash
+ * @param start - flash address (should be halfword-aligned)
+ * @param wrdata - data to write
+ * @param stor_size - its size (in bytes)
+ * @return 0 if all OK
+ */
+int flash_write(const void *start, const void *wrdata, uint32_t stor_size){
     int ret = 0;
     if (FLASH->CR & FLASH_CR_LOCK){ // unloch flash
         FLASH->KEYR = FLASH_KEY1;
@@ -126,7 +142,9 @@ static int write2flash(const void *start, const void *wrdata, uint32_t stor_size
     FLASH->CR |= FLASH_CR_PG;
     const uint16_t *data = (const uint16_t*) wrdata;
     volatile uint16_t *address = (volatile uint16_t*) start;
+#ifdef EBUG
     USB_sendstr("Start address="); printuhex((uint32_t)start); newline();
+#endif
     uint32_t i, count = (stor_size + 1) / 2;
     for(i = 0; i < count; ++i){
         IWDG->KR = IWDG_REFRESH;
@@ -148,11 +166,13 @@ static int write2flash(const void *start, const void *wrdata, uint32_t stor_size
     return ret;
 }
 
-// erase Nth page of flash storage (flash should be prepared!)
-static int erase_pageN(int N){
+// erase page with given address (flash should be prepared!)
+static int erase_page(uint32_t addr){
     int ret = 0;
-    USB_sendstr("Erase block #"); printu(N); newline();
-    FLASH->AR = (uint32_t)Flash_Data + N*FLASH_blocksize;
+#ifdef EBUG
+    USB_sendstr("Erase block @"); printuhex(addr); newline();
+#endif
+    FLASH->AR = addr;
     FLASH->CR |= FLASH_CR_STRT;
     while(FLASH->SR & FLASH_SR_BSY) IWDG->KR = IWDG_REFRESH;
     FLASH->SR = FLASH_SR_EOP;
@@ -163,14 +183,24 @@ static int erase_pageN(int N){
     return ret;
 }
 
+// erase one page of flash by its address; @return 0 if all OK
+int flash_erasepage(const void *addr){
+    if((FLASH->CR & FLASH_CR_LOCK) != 0){
+        FLASH->KEYR = FLASH_KEY1;
+        FLASH->KEYR = FLASH_KEY2;
+    }
+    while(FLASH->SR & FLASH_SR_BSY) IWDG->KR = IWDG_REFRESH;
+    FLASH->SR = FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPERR;
+    FLASH->CR |= FLASH_CR_PER;
+    int ret = erase_page((uint32_t)addr);
+    FLASH->CR &= ~FLASH_CR_PER;
+    return ret;
+}
+
 // erase full storage (npage < 0) or its nth page; @return 0 if all OK
 int erase_storage(int npage){
     int ret = 0;
-    uint32_t end = 1, start = 0, flsz = 0;
-    if(FLASH_SIZE > 0 && FLASH_SIZE < 20000){
-        flsz = FLASH_SIZE * 1024; // size in bytes
-        flsz -= (uint32_t)Flash_Data - FLASH_BASE;
-    }
+    uint32_t end = 1, start = 0, flsz = storage_size();
     end = flsz / FLASH_blocksize;
     if(end == 0 || end >= FLASH_SIZE) return 1;
     if(npage > -1){ // erase only one page
@@ -192,7 +222,7 @@ int erase_storage(int npage){
     FLASH->CR |= FLASH_CR_PER;
     for(uint32_t i = start; i < end; ++i){
         IWDG->KR = IWDG_REFRESH;
-        if(erase_pageN(i)){
+        if(erase_page((uint32_t)Flash_Data + i*FLASH_blocksize)){
             ret = 1;
             break;
         }
@@ -224,6 +254,10 @@ int fn_dumpmot(uint32_t _U_ hash, char _U_ *args){ // "dumpmot" (1224122507)
     printuhex(*((uint8_t*)&the_conf.motflags[i]));
     PROPNAME("eswreact");
     printu(the_conf.ESW_reaction[i]);
+    PROPNAME("sgthrs");
+    printu(the_conf.sgthrs[i]);
+    PROPNAME("semin");
+    printu(the_conf.semin[i]);
 #undef PROPNAME
     newline();
     return RET_GOOD;
@@ -238,6 +272,7 @@ int fn_dumpconf(uint32_t _U_ hash, char _U_ *args){ // "dumpconf" (3271513185)
     USB_sendstr("\nuserconf_sz="); printu(the_conf.userconf_sz);
     USB_sendstr("\ncanspeed="); printu(the_conf.CANspeed);
     USB_sendstr("\ncanid="); printu(the_conf.CANID);
+    USB_sendstr("\nlogperiod="); printu(the_conf.logperiod);
     newline();
     char x[2] = {0};
     // motors' data
@@ -38,6 +38,9 @@
 
 #define FLASH_SIZE          *((uint16_t*)FLASH_SIZE_REG)
 
+// amount of last flash pages reserved for telemetry log (telemetry.c)
+#define FLASHLOG_NPAGES     (32)
+
 #define MOTFLAGS_AMOUNT     7
 
 enum{
@@ -74,6 +77,9 @@ typedef struct __attribute__((packed, aligned(4))){
     motflags_t motflags[MOTORSNO];  // motor's flags
     uint8_t ESW_reaction[MOTORSNO]; // end-switches reaction (esw_react)
     uint8_t motcurrent[MOTORSNO];   // IRUN as fraction of max current (1..32)
+    uint32_t logperiod;             // telemetry log period (ms), 0 - don't log
+    uint8_t sgthrs[MOTORSNO];       // StallGuard threshold (SGTHRS), 0 - don't detect stall
+    uint8_t semin[MOTORSNO];        // CoolStep lower threshold (SEMIN, 0..15), 0 - CoolStep off
 } user_conf;
 
 extern user_conf the_conf; // global user config (read from FLASH to RAM)
@@ -83,4 +89,6 @@ extern user_conf the_conf; // global user config (read from FLASH to RAM)
 void flashstorage_init();
 int store_userconf();
 int erase_storage(int npage);
+int flash_write(const void *start, const void *wrdata, uint32_t stor_size);
+int flash_erasepage(const void *addr);
 
@@ -0,0 +1 @@
+../../snippets/flashlog.c
\ No newline at end of file
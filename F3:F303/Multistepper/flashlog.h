@@ -0,0 +1 @@
+../../snippets/flashlog.h
\ No newline at end of file
@@ -97,6 +97,16 @@ uint8_t MSB(uint16_t val){
     return ((uint8_t)r + bval[val]);
 }
 
+// current time in microseconds (SysTick ticks each 1ms)
+uint32_t getus(){
+    uint32_t ms, val;
+    do{
+        ms = Tms;
+        val = SysTick->VAL;
+    }while(ms != Tms);
+    return ms * 1000 + (SysTick->LOAD - val) / ((SysTick->LOAD + 1) / 1000);
+}
+
 // setup here ALL GPIO pins (due to table in Readme.md)
 // leave SWD as default AF; high speed for CLK and some other AF; med speed for some another AF
 TRUE_INLINE void gpio_setup(){
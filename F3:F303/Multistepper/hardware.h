@@ -95,5 +95,6 @@ extern volatile uint32_t Tms;
 
 uint8_t ESW_state(uint8_t MOTno);
 uint8_t MSB(uint16_t val);
+uint32_t getus();
 void hw_setup();
 void mottimers_setup();
@@ -80,6 +80,18 @@ int fn_gpioconf(uint32_t _U_ hash, char _U_ *args) WAL; // "gpioconf" (130972156
 
 int fn_help(uint32_t _U_ hash, char _U_ *args) WAL; // "help" (4288288686)
 
+int fn_logdump(uint32_t _U_ hash, char _U_ *args) WAL; // "logdump" (2432012925)
+
+int fn_logerase(uint32_t _U_ hash, char _U_ *args) WAL; // "logerase" (467338327)
+
+int fn_logflush(uint32_t _U_ hash, char _U_ *args) WAL; // "logflush" (731713897)
+
+int fn_logperiod(uint32_t _U_ hash, char _U_ *args) WAL; // "logperiod" (2999944778)
+
+int fn_logstat(uint32_t _U_ hash, char _U_ *args) WAL; // "logstat" (2464195075)
+
+int fn_looptime(uint32_t _U_ hash, char _U_ *args) WAL; // "looptime" (1539520110)
+
 int fn_maxspeed(uint32_t _U_ hash, char _U_ *args) WAL; // "maxspeed" (1498078812)
 
 int fn_maxsteps(uint32_t _U_ hash, char _U_ *args) WAL; // "maxsteps" (1506667002)
@@ -104,6 +116,8 @@ int fn_motreinit(uint32_t _U_ hash, char _U_ *args) WAL; // "motreinit" (1996827
 
 int fn_pdn(uint32_t _U_ hash, char _U_ *args) WAL; // "pdn" (2963275719)
 
+int fn_pdnstat(uint32_t _U_ hash, char _U_ *args) WAL; // "pdnstat" (1386127491)
+
 int fn_ping(uint32_t _U_ hash, char _U_ *args) WAL; // "ping" (10561715)
 
 int fn_relpos(uint32_t _U_ hash, char _U_ *args) WAL; // "relpos" (1278646042)
@@ -116,6 +130,14 @@ int fn_saveconf(uint32_t _U_ hash, char _U_ *args) WAL; // "saveconf" (141102426
 
 int fn_screen(uint32_t _U_ hash, char _U_ *args) WAL; // "screen" (2100809349)
 
+int fn_semin(uint32_t _U_ hash, char _U_ *args) WAL; // "semin" (2184626849)
+
+int fn_sgload(uint32_t _U_ hash, char _U_ *args) WAL; // "sgload" (3195786623)
+
+int fn_sgstream(uint32_t _U_ hash, char _U_ *args) WAL; // "sgstream" (3174530027)
+
+int fn_sgthrs(uint32_t _U_ hash, char _U_ *args) WAL; // "sgthrs" (3212845856)
+
 int fn_speedlimit(uint32_t _U_ hash, char _U_ *args) WAL; // "speedlimit" (1654184245)
 
 int fn_state(uint32_t _U_ hash, char _U_ *args) WAL; // "state" (2216628902)
@@ -126,6 +148,8 @@ int fn_time(uint32_t _U_ hash, char _U_ *args) WAL; // "time" (19148340)
 
 int fn_tmcbus(uint32_t _U_ hash, char _U_ *args) WAL; // "tmcbus" (1906135955)
 
+int fn_tmcstat(uint32_t _U_ hash, char _U_ *args) WAL; // "tmcstat" (1114877189)
+
 int fn_udata(uint32_t _U_ hash, char _U_ *args) WAL; // "udata" (2736127636)
 
 int fn_usartstatus(uint32_t _U_ hash, char _U_ *args) WAL; // "usartstatus" (4007098968)
@@ -254,6 +278,24 @@ int parsecmd(const char *str){
         case CMD_HELP:
             return fn_help(h, args);
         break;
+        case CMD_LOGDUMP:
+            return fn_logdump(h, args);
+        break;
+        case CMD_LOGERASE:
+            return fn_logerase(h, args);
+        break;
+        case CMD_LOGFLUSH:
+            return fn_logflush(h, args);
+        break;
+        case CMD_LOGPERIOD:
+            return fn_logperiod(h, args);
+        break;
+        case CMD_LOGSTAT:
+            return fn_logstat(h, args);
+        break;
+        case CMD_LOOPTIME:
+            return fn_looptime(h, args);
+        break;
         case CMD_MAXSPEED:
             return fn_maxspeed(h, args);
         break;
@@ -290,6 +332,9 @@ int parsecmd(const char *str){
         case CMD_PDN:
             return fn_pdn(h, args);
         break;
+        case CMD_PDNSTAT:
+            return fn_pdnstat(h, args);
+        break;
         case CMD_PING:
             return fn_ping(h, args);
         break;
@@ -308,6 +353,18 @@ int parsecmd(const char *str){
         case CMD_SCREEN:
             return fn_screen(h, args);
         break;
+        case CMD_SEMIN:
+            return fn_semin(h, args);
+        break;
+        case CMD_SGLOAD:
+            return fn_sgload(h, args);
+        break;
+        case CMD_SGSTREAM:
+            return fn_sgstream(h, args);
+        break;
+        case CMD_SGTHRS:
+            return fn_sgthrs(h, args);
+        break;
         case CMD_SPEEDLIMIT:
             return fn_speedlimit(h, args);
         break;
@@ -323,6 +380,9 @@ int parsecmd(const char *str){
         case CMD_TMCBUS:
             return fn_tmcbus(h, args);
         break;
+        case CMD_TMCSTAT:
+            return fn_tmcstat(h, args);
+        break;
         case CMD_UDATA:
             return fn_udata(h, args);
         break;
@@ -50,6 +50,12 @@ extern char lastcmd[];
 #define CMD_GPIO            (4286324660)
 #define CMD_GPIOCONF        (1309721562)
 #define CMD_HELP            (4288288686)
+#define CMD_LOGDUMP         (2432012925)
+#define CMD_LOGERASE        (467338327)
+#define CMD_LOGFLUSH        (731713897)
+#define CMD_LOGPERIOD       (2999944778)
+#define CMD_LOGSTAT         (2464195075)
+#define CMD_LOOPTIME        (1539520110)
 #define CMD_MAXSPEED        (1498078812)
 #define CMD_MAXSTEPS        (1506667002)
 #define CMD_MCUT            (4022718)
@@ -62,17 +68,23 @@ extern char lastcmd[];
 #define CMD_MOTNO           (544673586)
 #define CMD_MOTREINIT       (199682784)
 #define CMD_PDN             (2963275719)
+#define CMD_PDNSTAT         (1386127491)
 #define CMD_PING            (10561715)
 #define CMD_RELPOS          (1278646042)
 #define CMD_RELSLOW         (1742971917)
 #define CMD_RESET           (1907803304)
 #define CMD_SAVECONF        (141102426)
 #define CMD_SCREEN          (2100809349)
+#define CMD_SEMIN           (2184626849)
+#define CMD_SGLOAD          (3195786623)
+#define CMD_SGSTREAM        (3174530027)
+#define CMD_SGTHRS          (3212845856)
 #define CMD_SPEEDLIMIT      (1654184245)
 #define CMD_STATE           (2216628902)
 #define CMD_STOP            (17184971)
 #define CMD_TIME            (19148340)
 #define CMD_TMCBUS          (1906135955)
+#define CMD_TMCSTAT         (1114877189)
 #define CMD_UDATA           (2736127636)
 #define CMD_USARTSTATUS     (4007098968)
 #define CMD_VDRIVE          (2172773525)
@@ -113,6 +125,12 @@ extern char lastcmd[];
 #define STR_GPIO            "gpio"
 #define STR_GPIOCONF        "gpioconf"
 #define STR_HELP            "help"
+#define STR_LOGDUMP         "logdump"
+#define STR_LOGERASE        "logerase"
+#define STR_LOGFLUSH        "logflush"
+#define STR_LOGPERIOD       "logperiod"
+#define STR_LOGSTAT         "logstat"
+#define STR_LOOPTIME        "looptime"
 #define STR_MAXSPEED        "maxspeed"
 #define STR_MAXSTEPS        "maxsteps"
 #define STR_MCUT            "mcut"
@@ -125,17 +143,23 @@ extern char lastcmd[];
 #define STR_MOTNO           "motno"
 #define STR_MOTREINIT       "motreinit"
 #define STR_PDN             "pdn"
+#define STR_PDNSTAT         "pdnstat"
 #define STR_PING            "ping"
 #define STR_RELPOS          "relpos"
 #define STR_RELSLOW         "relslow"
 #define STR_RESET           "reset"
 #define STR_SAVECONF        "saveconf"
 #define STR_SCREEN          "screen"
+#define STR_SEMIN           "semin"
+#define STR_SGLOAD          "sgload"
+#define STR_SGSTREAM        "sgstream"
+#define STR_SGTHRS          "sgthrs"
 #define STR_SPEEDLIMIT      "speedlimit"
 #define STR_STATE           "state"
 #define STR_STOP            "stop"
 #define STR_TIME            "time"
 #define STR_TMCBUS          "tmcbus"
+#define STR_TMCSTAT         "tmcstat"
 #define STR_UDATA           "udata"
 #define STR_USARTSTATUS     "usartstatus"
 #define STR_VDRIVE          "vdrive"
@@ -24,6 +24,7 @@
 #include "pdnuart.h"
 #include "proto.h"
 #include "steppers.h"
+#include "telemetry.h"
 #include "usb_dev.h"
 
 #define MAXSTRLEN    RBINSZ
@@ -45,22 +46,29 @@ int main(void){
     hw_setup(); // GPIO, ADC, timers, watchdog etc.
     USBPU_OFF(); // make a reconnection
     flashstorage_init();
+    telemetry_init();
     USB_setup();
     CAN_setup(the_conf.CANspeed);
     adc_setup();
     pdnuart_setup();
     // steppers will be initted later, in process_steppers()
     USBPU_ON();
-    uint32_t ctr = 0;
+    uint32_t ctr = 0, Tloop = getus();
     CAN_message *can_mesg;
     while(1){
         IWDG->KR = IWDG_REFRESH;
+        uint32_t T = getus();
+        looptime = T - Tloop;
+        if(looptime > loopmax) loopmax = looptime;
+        Tloop = T;
         if(Tms - ctr > 499){
             ctr = Tms;
             LED_blink();
         }
         CAN_proc();
+        pdnuart_proc();
         process_steppers();
+        process_sgstream();
         if(CAN_get_status() == CAN_FIFO_OVERRUN){
             USB_sendstr("CAN_FIFO_OVERRUN\n");
         }
@@ -87,5 +95,6 @@ int main(void){
             if(ans) USB_sendstr(ans);
         }
         process_keys();
+        telemetry_process();
     }
 }
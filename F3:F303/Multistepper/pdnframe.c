@@ -0,0 +1,92 @@
+/*
+ * This file is part of the multistepper project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pdnframe.h"
+
+/**
+ * @brief pdn_crc - CRC8 of TMC2209 datagram (polynomial x^8+x^2+x+1, bits are taken LSB first)
+ * @param data - datagram
+ * @param len - its length without CRC byte
+ * @return CRC
+ */
+uint8_t pdn_crc(const uint8_t *data, int len){
+    uint8_t crc = 0;
+    for(int i = 0; i < len; ++i){
+        uint8_t currentByte = data[i];
+        for(int j = 0; j < 8; ++j){
+            if((crc >> 7) ^ (currentByte & 0x01)) crc = (crc << 1) ^ 0x07;
+            else crc <<= 1;
+            currentByte = currentByte >> 1;
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief pdn_mkrequest - make read or write request
+ * @param buf (o) - buffer for datagram (PDN_DGLEN bytes at least)
+ * @param addr - slave address (0..3)
+ * @param reg - register (0..0x7f)
+ * @param data - data to write
+ * @param w - !=0 for writing
+ * @return length of datagram
+ */
+int pdn_mkrequest(uint8_t *buf, uint8_t addr, uint8_t reg, uint32_t data, int w){
+    int len = PDN_RDLEN - 1;
+    buf[0] = PDN_SYNC;
+    buf[1] = addr & 3;
+    buf[2] = reg & 0x7f;
+    if(w){
+        buf[2] |= PDN_WRITE;
+        for(int i = 6; i > 2; --i){
+            buf[i] = data & 0xff;
+            data >>= 8;
+        }
+        len = PDN_DGLEN - 1;
+    }
+    buf[len] = pdn_crc(buf, len);
+    return len + 1;
+}
+
+/**
+ * @brief pdn_parse - check received data: echo of request and (for reading) reply
+ * @param tx - request
+ * @param txlen - its length
+ * @param rx - received data
+ * @param rxlen - its length
+ * @param data (o) - register value (if reading)
+ * @return status
+ */
+pdn_status pdn_parse(const uint8_t *tx, int txlen, const uint8_t *rx, int rxlen, uint32_t *data){
+    if(rxlen < txlen) return PDN_ERR_LEN;
+    for(int i = 0; i < txlen; ++i)
+        if(rx[i] != tx[i]) return PDN_ERR_ECHO;
+    if(tx[2] & PDN_WRITE) return PDN_OK; // nothing to read
+    rx += txlen; rxlen -= txlen;
+    if(rxlen < PDN_DGLEN) return PDN_ERR_LEN;
+    if((rx[0] & 0x0f) != PDN_SYNC || rx[1] != PDN_MASTER) return PDN_ERR_SYNC;
+    if(rx[2] != tx[2]) return PDN_ERR_REG;
+    if(rx[7] != pdn_crc(rx, PDN_DGLEN - 1)) return PDN_ERR_CRC;
+    uint32_t o = 0;
+    for(int i = 3; i < 7; ++i){
+        o <<= 8;
+        o |= rx[i];
+    }
+    if(data) *data = o;
+    return PDN_OK;
+}
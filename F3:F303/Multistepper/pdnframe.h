@@ -0,0 +1,54 @@
+/*
+ * This file is part of the multistepper project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * TMC2209 PDN-UART datagrams (hardware-independent):
+ *   read request:  sync, slave address, register, CRC
+ *   write request: sync, slave address, register|0x80, data (MSB first), CRC
+ *   read reply:    sync, 0xff, register, data (MSB first), CRC
+ * Single-wire bus: all transmitted bytes come back into receiver (echo) before reply.
+ */
+
+#define PDN_SYNC        (0x05)
+#define PDN_MASTER      (0xff)
+#define PDN_WRITE       (0x80)
+// length of read request
+#define PDN_RDLEN       (4)
+// length of write request and read reply
+#define PDN_DGLEN       (8)
+// max length of received data: echo of read request + reply
+#define PDN_RXMAX       (PDN_RDLEN + PDN_DGLEN)
+
+typedef enum{
+    PDN_OK,             // all OK
+    PDN_ERR_ECHO,       // echo differs from transmitted data (collision or bus is broken)
+    PDN_ERR_SYNC,       // bad sync byte or master address in reply
+    PDN_ERR_REG,        // answer for another register
+    PDN_ERR_CRC,        // bad CRC of reply
+    PDN_ERR_LEN,        // not enough data received
+    PDN_ERR_TIMEOUT,    // no answer
+    PDN_ERR_AMOUNT
+} pdn_status;
+
+uint8_t pdn_crc(const uint8_t *data, int len);
+int pdn_mkrequest(uint8_t *buf, uint8_t addr, uint8_t reg, uint32_t data, int w);
+pdn_status pdn_parse(const uint8_t *tx, int txlen, const uint8_t *rx, int rxlen, uint32_t *data);
@@ -0,0 +1,127 @@
+/*
+ * This file is part of the multistepper project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host checker of PDN-UART framing (../pdnframe.c): CRC against independent CRC-8 implementation,
+// requests' layout, echo skipping and reply checking with all single-bit errors
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+#include "../pdnframe.h"
+
+// CRC-8 (poly 0x07, MSB first, init 0)
+static uint8_t crc8(const uint8_t *data, int len){
+    uint8_t crc = 0;
+    for(int i = 0; i < len; ++i){
+        crc ^= data[i];
+        for(int j = 0; j < 8; ++j) crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+    }
+    return crc;
+}
+
+static uint8_t rev8(uint8_t b){
+    uint8_t r = 0;
+    for(int i = 0; i < 8; ++i) if(b & (1 << i)) r |= 0x80 >> i;
+    return r;
+}
+
+// TMC CRC takes bits LSB first == CRC-8 of bit-reversed bytes
+static int chkcrc(){
+    int bad = (crc8((const uint8_t*)"123456789", 9) != 0xf4);
+    uint8_t buf[PDN_DGLEN], rbuf[PDN_DGLEN];
+    for(int iter = 0; iter < 100000; ++iter){
+        int len = 1 + lrand48() % PDN_DGLEN;
+        for(int i = 0; i < len; ++i){
+            buf[i] = lrand48();
+            rbuf[i] = rev8(buf[i]);
+        }
+        if(pdn_crc(buf, len) != crc8(rbuf, len)) bad = 1;
+    }
+    return chkfail("crc", bad);
+}
+
+static int chkrequest(){
+    uint8_t buf[PDN_DGLEN];
+    int bad = 0;
+    if(pdn_mkrequest(buf, 2, 0x6f, 0, 0) != PDN_RDLEN) bad = 1;
+    if(buf[0] != PDN_SYNC || buf[1] != 2 || buf[2] != 0x6f || buf[3] != pdn_crc(buf, 3)) bad = 1;
+    if(pdn_mkrequest(buf, 3, 0x10, 0x12345678, 1) != PDN_DGLEN) bad = 1;
+    if(buf[1] != 3 || buf[2] != 0x90 || buf[3] != 0x12 || buf[4] != 0x34 || buf[5] != 0x56
+       || buf[6] != 0x78 || buf[7] != pdn_crc(buf, 7)) bad = 1;
+    return chkfail("request", bad);
+}
+
+// make echo + reply of slave
+static int mkanswer(uint8_t *rx, const uint8_t *tx, int txlen, uint32_t val){
+    memcpy(rx, tx, txlen);
+    if(tx[2] & PDN_WRITE) return txlen;
+    uint8_t *r = rx + txlen;
+    r[0] = PDN_SYNC; r[1] = PDN_MASTER; r[2] = tx[2];
+    for(int i = 6; i > 2; --i){
+        r[i] = val & 0xff;
+        val >>= 8;
+    }
+    r[7] = pdn_crc(r, 7);
+    return txlen + PDN_DGLEN;
+}
+
+static int chkparse(){
+    uint8_t tx[PDN_DGLEN], rx[PDN_RXMAX];
+    int bad = 0, undetected = 0;
+    for(int iter = 0; iter < 1000; ++iter){
+        int w = iter & 1;
+        uint32_t val = mrand48(), got = 0;
+        int txlen = pdn_mkrequest(tx, lrand48() & 3, lrand48() & 0x7f, val, w);
+        int rxlen = mkanswer(rx, tx, txlen, val);
+        if(pdn_parse(tx, txlen, rx, rxlen, &got) != PDN_OK || (!w && got != val)){
+            if(!bad) printf("good datagram rejected\n");
+            bad = 1;
+        }
+        // all single-bit errors should be detected
+        for(int i = 0; i < rxlen; ++i) for(int b = 0; b < 8; ++b){
+            rx[i] ^= 1 << b;
+            pdn_status st = pdn_parse(tx, txlen, rx, rxlen, &got);
+            // high nibble of sync byte is reserved
+            if(st == PDN_OK && !(i == txlen && b > 3)) ++undetected;
+            if(i < txlen && st != PDN_ERR_ECHO) bad = 1;
+            rx[i] ^= 1 << b;
+        }
+        // lost bytes
+        if(pdn_parse(tx, txlen, rx, rxlen - 1, &got) != PDN_ERR_LEN) bad = 1;
+        if(pdn_parse(tx, txlen, rx, txlen - 1, &got) != PDN_ERR_LEN) bad = 1;
+        // answer for other register
+        if(!w){
+            rx[txlen + 2] ^= 1;
+            rx[txlen + 7] = pdn_crc(rx + txlen, 7);
+            if(pdn_parse(tx, txlen, rx, rxlen, &got) != PDN_ERR_REG) bad = 1;
+        }
+    }
+    if(undetected) printf("%d undetected errors\n", undetected);
+    return chkfail("parse", bad || undetected);
+}
+
+int main(int argc, char **argv){
+    hosttest_opts(argc, argv);
+    int ret = chkcrc();
+    ret |= chkrequest();
+    ret |= chkparse();
+    return hosttest_result(ret);
+}
@@ -20,131 +20,294 @@
 
 #include "flash.h"
 #include "hardware.h"
+#include "pdnuart.h"
 #include "proto.h"
 #include "tmc2209.h"
 
 extern volatile uint32_t Tms;
 static uint8_t motorno = 0;
 
-#define MAXBUFLEN           (8)
-// timeout, milliseconds
-#define PDNU_TMOUT          (5)
-
-// buffers format: 0 - sync+reserved, 1 - address (0..3 - slave, 0xff - master)
-//      2 - register<<1 | RW, 3 - CRC (r) or [ 3..6 - MSB data, 7 - CRC ]
-// buf[0] - USART2, buf[1] - USART3
-//static uint8_t notfound = 0; // not found mask (LSB - 0, MSB - 7)
-
-// datalen == 3 for read request or 7 for writing
-static void calcCRC(uint8_t *outbuf, int datalen){
-    uint8_t crc = 0;
-    for(int i = 0; i < datalen; ++i){
-        uint8_t currentByte = outbuf[i];
-        for(int j = 0; j < 8; ++j){
-            if((crc >> 7) ^ (currentByte & 0x01)) crc = (crc << 1) ^ 0x07;
-            else crc <<= 1;
-            currentByte = currentByte >> 1;
-        }
-    }
-    outbuf[datalen] = crc;
-}
+pdn_mailbox pdn_mbox[MOTORSNO];
+pdn_stat pdn_stats[2];
+
+typedef enum{
+    PDNB_IDLE,      // nothing to do
+    PDNB_BUSY,      // DMA transaction is running
+    PDNB_DONE,      // transaction is over, status is ready
+} pdnbus_state;
+
+// registers polled in background
+static const uint8_t pollregs[] = {TMC2209Reg_GSTAT, TMC2209Reg_DRV_STATUS, TMC2209Reg_SG_RESULT};
+#define NPOLLREGS   (sizeof(pollregs))
+
+typedef struct{
+    pdn_rq q[PDNQ_LEN];             // requests, q[tail] is current
+    uint8_t head, tail;
+    volatile uint8_t state;         // pdnbus_state
+    uint8_t txlen;
+    uint8_t tx[PDN_DGLEN];
+    uint8_t rx[PDN_RXMAX];
+    uint8_t pollmot;                // motor (0..3) and register index to poll next
+    uint8_t pollreg;
+    uint32_t Tstart;                // start of current transaction
+    uint32_t Tpoll;                 // time of last polling transaction
+    uint32_t Tcycle;                // start of polling cycle
+} pdnbus;
+
+static pdnbus bus[2];
 
 static volatile USART_TypeDef *USART[2] = {USART2, USART3};
+static volatile DMA_Channel_TypeDef *TxDMA[2] = {DMA1_Channel7, DMA1_Channel2};
+static volatile DMA_Channel_TypeDef *RxDMA[2] = {DMA1_Channel6, DMA1_Channel3};
 
 static void setup_usart(int no){
     USART[no]->ICR = 0xffffffff; // clear all flags
+    TxDMA[no]->CCR = 0;
+    TxDMA[no]->CPAR = (uint32_t) &USART[no]->TDR;
+    TxDMA[no]->CCR = DMA_CCR_MINC | DMA_CCR_DIR; // 8bit, mem++, mem->per
+    RxDMA[no]->CCR = 0;
+    RxDMA[no]->CPAR = (uint32_t) &USART[no]->RDR;
+    RxDMA[no]->CCR = DMA_CCR_MINC | DMA_CCR_TCIE; // 8bit, mem++, per->mem, transfer complete IRQ
     USART[no]->BRR = 72000000 / 256000; // 256 kbaud
-    USART[no]->CR3 = USART_CR3_HDSEL; // enable DMA Tx/Rx, single wire
+    // enable DMA Tx/Rx, single wire, don't stop receiving on overrun
+    USART[no]->CR3 = USART_CR3_DMAT | USART_CR3_DMAR | USART_CR3_HDSEL | USART_CR3_OVRDIS;
     USART[no]->CR1 = USART_CR1_TE | USART_CR1_RE | USART_CR1_UE; // 1start,8data,nstop; enable Rx,Tx,USART
     uint32_t tmout = 16000000;
     while(!(USART[no]->ISR & USART_ISR_TC)){if(--tmout == 0) break;} // polling idle frame Transmission
     USART[no]->ICR = 0xffffffff; // clear all flags again
 }
 
-// USART2 (ch0..3), USART3 (ch4..7)
+// USART2 (ch0..3): DMA1ch6 (Rx), DMA1_ch7 (Tx)
+// USART3 (ch4..7): DMA1ch3 (Rx), DMA1_ch2 (Tx)
 // pins are setting up in `hardware.c`
 void pdnuart_setup(){
     RCC->APB1ENR |= RCC_APB1ENR_USART2EN | RCC_APB1ENR_USART3EN;
+    RCC->AHBENR |= RCC_AHBENR_DMA1EN;
     setup_usart(0);
     setup_usart(1);
+    NVIC_EnableIRQ(DMA1_Channel3_IRQn);
+    NVIC_EnableIRQ(DMA1_Channel6_IRQn);
 }
 
-static int rwreg(uint8_t reg, uint32_t data, int w){
-    if(motorno >= MOTORSNO || reg & 0x80){
+/**
+ * @brief pdnuart_push - put request into queue
+ * @param motor - motor number
+ * @param reg - register
+ * @param data - data to write
+ * @param w - !=0 to write
+ * @param cb - completion callback
+ * @return FALSE if queue is full or bad arguments
+ */
+int pdnuart_push(uint8_t motor, uint8_t reg, uint32_t data, int w, pdn_cb cb){
+    if(motor >= MOTORSNO || reg & 0x80){
         DBG("Wrong motno or reg");
         return FALSE;
     }
-    uint32_t x = Tms;
-    while(Tms - x < 1);
-    int no = motorno >> 2;
-    uint8_t outbuf[MAXBUFLEN];
-    outbuf[0] = 0x05;
-    outbuf[1] = motorno - (no << 2);
-    outbuf[2] = reg;
-    int nbytes = 3;
-    if(w){
-        outbuf[2] |= 0x80;
-        for(int i = 6; i > 2; --i){
-            outbuf[i] = data & 0xff;
-            data >>= 8;
+    int no = motor >> 2;
+    pdnbus *b = &bus[no];
+    uint8_t nxt = (b->head + 1) & (PDNQ_LEN - 1);
+    if(nxt == b->tail){
+        ++pdn_stats[no].overflows;
+        return FALSE;
+    }
+    pdn_rq *r = &b->q[b->head];
+    r->motor = motor;
+    r->reg = reg;
+    r->data = data;
+    r->write = w ? 1 : 0;
+    r->cb = cb;
+    r->status = PDN_OK;
+    b->head = nxt;
+    uint16_t depth = (b->head - b->tail) & (PDNQ_LEN - 1);
+    pdn_stats[no].depth = depth;
+    if(depth > pdn_stats[no].maxdepth) pdn_stats[no].maxdepth = depth;
+    return TRUE;
+}
+
+// start transaction of q[tail]
+static void startxfer(int no){
+    pdnbus *b = &bus[no];
+    pdn_rq *r = &b->q[b->tail];
+    b->txlen = pdn_mkrequest(b->tx, r->motor & 3, r->reg, r->data, r->write);
+    RxDMA[no]->CCR &= ~DMA_CCR_EN;
+    TxDMA[no]->CCR &= ~DMA_CCR_EN;
+    USART[no]->RQR = USART_RQR_RXFRQ; // flush old data
+    USART[no]->ICR = 0xffffffff;
+    RxDMA[no]->CMAR = (uint32_t) b->rx;
+    RxDMA[no]->CNDTR = b->txlen + (r->write ? 0 : PDN_DGLEN); // echo + reply
+    TxDMA[no]->CMAR = (uint32_t) b->tx;
+    TxDMA[no]->CNDTR = b->txlen;
+    b->Tstart = Tms;
+    b->state = PDNB_BUSY;
+    RxDMA[no]->CCR |= DMA_CCR_EN;
+    TxDMA[no]->CCR |= DMA_CCR_EN;
+}
+
+// Rx DMA transfer complete: check data
+static void rxdone(int no){
+    pdnbus *b = &bus[no];
+    TxDMA[no]->CCR &= ~DMA_CCR_EN;
+    RxDMA[no]->CCR &= ~DMA_CCR_EN;
+    if(b->state != PDNB_BUSY) return;
+    pdn_rq *r = &b->q[b->tail];
+    int rxlen = b->txlen + (r->write ? 0 : PDN_DGLEN);
+    r->status = pdn_parse(b->tx, b->txlen, b->rx, rxlen, &r->data);
+    b->state = PDNB_DONE;
+}
+
+// USART3 Rx
+void dma1_channel3_isr(){
+    DMA1->IFCR = DMA_IFCR_CGIF3;
+    rxdone(1);
+}
+
+// USART2 Rx
+void dma1_channel6_isr(){
+    DMA1->IFCR = DMA_IFCR_CGIF6;
+    rxdone(0);
+}
+
+// store polling results
+static void pollcb(const pdn_rq *r){
+    pdn_mailbox *m = &pdn_mbox[r->motor];
+    if(r->status != PDN_OK){
+        ++m->errors;
+        return;
+    }
+    switch(r->reg){
+        case TMC2209Reg_GSTAT:
+            m->gstat = r->data;
+            m->fresh |= PDN_MB_GSTAT;
+        break;
+        case TMC2209Reg_DRV_STATUS:
+            m->drvstatus = r->data;
+            m->fresh |= PDN_MB_DRVSTATUS;
+        break;
+        case TMC2209Reg_SG_RESULT:
+            m->sgresult = r->data;
+            m->fresh |= PDN_MB_SGRESULT;
+        break;
+        default:
+        break;
+    }
+    m->Tupd = Tms;
+}
+
+// put next polling request of bus `no` into its queue
+static void nextpoll(int no){
+    pdnbus *b = &bus[no];
+    if(Tms - b->Tpoll < PDNU_POLLINT) return;
+    for(int i = 0; i < 4; ++i){
+        uint8_t motor = (no << 2) + b->pollmot;
+        if(the_conf.motflags[motor].drvtype == DRVTYPE_UART){
+            if(pdnuart_push(motor, pollregs[b->pollreg], 0, 0, pollcb)){
+                b->Tpoll = Tms;
+                if(++b->pollreg == NPOLLREGS){
+                    b->pollreg = 0;
+                    if(++b->pollmot == 4){
+                        b->pollmot = 0;
+                        pdn_stats[no].cycle = Tms - b->Tcycle;
+                        b->Tcycle = Tms;
+                    }
+                }
+            }
+            return;
+        }
+        b->pollreg = 0;
+        if(++b->pollmot == 4){
+            b->pollmot = 0;
+            b->Tcycle = Tms;
         }
-        nbytes = 7;
     }
-    calcCRC(outbuf, nbytes);
-    ++nbytes;
-    for(int i = 0; i < nbytes; ++i){
+}
+
+static uint8_t inproc = 0;
+
+/**
+ * @brief pdnuart_proc - process queues: check timeouts, run callbacks, start next transactions
+ */
+void pdnuart_proc(){
+    inproc = 1;
+    for(int no = 0; no < 2; ++no){
+        pdnbus *b = &bus[no];
+        if(b->state == PDNB_BUSY && Tms - b->Tstart > PDNU_TMOUT){
+            NVIC_DisableIRQ(no ? DMA1_Channel3_IRQn : DMA1_Channel6_IRQn);
+            if(b->state == PDNB_BUSY){ // still no answer
+                TxDMA[no]->CCR &= ~DMA_CCR_EN;
+                RxDMA[no]->CCR &= ~DMA_CCR_EN;
+                b->q[b->tail].status = PDN_ERR_TIMEOUT;
+                b->state = PDNB_DONE;
+            }
+            NVIC_EnableIRQ(no ? DMA1_Channel3_IRQn : DMA1_Channel6_IRQn);
+        }
+        if(b->state == PDNB_DONE){
+            pdn_rq r = b->q[b->tail]; // copy: callback could push new request into this place
+            ++pdn_stats[no].xfers;
+            if(r.status != PDN_OK){
+                ++pdn_stats[no].errors[r.status];
+                DBG("PDN-UART error");
+            }
+            b->state = PDNB_IDLE;
+            b->tail = (b->tail + 1) & (PDNQ_LEN - 1);
+            pdn_stats[no].depth = (b->head - b->tail) & (PDNQ_LEN - 1);
+            if(r.cb) r.cb(&r);
+        }
+        if(b->state != PDNB_IDLE) continue;
+        if(b->head == b->tail) nextpoll(no);
+        if(b->head != b->tail) startxfer(no);
+    }
+    inproc = 0;
+}
+
+// synchronous access: result of last request
+static struct{
+    uint32_t data;
+    uint8_t status;
+    uint8_t done;
+} syncres;
+
+static void synccb(const pdn_rq *r){
+    syncres.data = r->data;
+    syncres.status = r->status;
+    syncres.done = 1;
+}
+
+// blocking read/write (for configuration only), waits until all requests before are done
+static int rwsync(uint8_t no, uint8_t reg, uint32_t *data, int w){
+    if(inproc) return FALSE; // called from callback
+    syncres.done = 0;
+    if(!pdnuart_push(no, reg, w ? *data : 0, w, synccb)) return FALSE;
+    uint32_t Tstart = Tms;
+    while(!syncres.done){
         IWDG->KR = IWDG_REFRESH;
-        USART[no]->TDR = outbuf[i]; // transmit
-        while(!(USART[no]->ISR & USART_ISR_TXE));
-        int l = 0;
-        for(; l < 10000; ++l) if(USART[no]->ISR & USART_ISR_RXNE) break;
-        // clear Rx
-        (void) USART[no]->RDR;
+        pdnuart_proc();
+        // each transaction in queue is finished by timeout in the worst case
+        if(Tms - Tstart > PDNQ_LEN * (PDNU_TMOUT + 2)){
+            DBG("PDN-UART queue is stuck");
+            return FALSE;
+        }
     }
+    if(syncres.status != PDN_OK) return FALSE;
+    if(!w) *data = syncres.data;
     return TRUE;
 }
 
 // return FALSE if failed
 int pdnuart_writereg(uint8_t reg, uint32_t data){
-    return rwreg(reg, data, 1);
+    return rwsync(motorno, reg, &data, 1);
 }
 
 // return FALSE if failed
 int pdnuart_readreg(uint8_t reg, uint32_t *data){
-    if(!rwreg(reg, 0, 0)) return FALSE;
-    uint32_t Tstart = Tms;
-    uint8_t buf[8];
-    int no = motorno >> 2;
-    for(int i = 0; i < 8; ++i){
-        IWDG->KR = IWDG_REFRESH;
-        while(!(USART[no]->ISR & USART_ISR_RXNE))
-            if(Tms - Tstart > PDNU_TMOUT){
-                DBG("Read timeout");
-                return FALSE;
-            }
-        buf[i] = USART[no]->RDR;
-    }
-    uint32_t o = 0;
-    for(int i = 3; i < 7; ++i){
-        o <<= 8;
-        o |= buf[i];
-    }
-    *data = o;
-    return TRUE;
+    return rwsync(motorno, reg, data, 0);
 }
 
 static int readregister(uint8_t no, uint8_t reg, uint32_t *data){
-    int n = motorno; motorno = no;
-    int r = pdnuart_readreg(reg, data);
-    motorno = n;
-    return r;
+    return rwsync(no, reg, data, 0);
 }
 
 static int writeregister(uint8_t no, uint8_t reg, uint32_t data){
-    int n = motorno; motorno = no;
-    int r = pdnuart_writereg(reg, data);
-    motorno = n;
-    return r;
+    return rwsync(no, reg, &data, 1);
 }
 
 uint8_t pdnuart_getmotno(){
@@ -188,6 +351,24 @@ int pdnuart_microsteps(uint8_t no, uint32_t val){
     return e;
 }
 
+// write StallGuard/CoolStep settings of n'th motor from the_conf
+int pdnuart_sgconf(uint8_t no){
+    TMC2209_sgthrs_reg_t thrs = {.value = 0};
+    thrs.threshold = the_conf.sgthrs[no];
+    if(!writeregister(no, TMC2209Reg_SGTHRS, thrs.value)) return FALSE;
+    // StallGuard output and CoolStep are active when TSTEP <= TCOOLTHRS, so turn them on at any speed
+    TMC2209_tcoolthrs_reg_t tcool = {.value = 0};
+    if(the_conf.sgthrs[no] || the_conf.semin[no]) tcool.tcoolthrs = 0xfffff;
+    if(!writeregister(no, TMC2209Reg_TCOOLTHRS, tcool.value)) return FALSE;
+    TMC2209_coolconf_reg_t cool = {.value = 0};
+    cool.semin = the_conf.semin[no];
+    cool.seup = TMC2209_SEUP;
+    cool.semax = TMC2209_SEMAX;
+    cool.sedn = TMC2209_SEDN;
+    cool.seimin = TMC2209_SEIMIN;
+    return writeregister(no, TMC2209Reg_COOLCONF, cool.value);
+}
+
 // init driver number `no`, return FALSE if failed
 int pdnuart_init(uint8_t no){
     TMC2209_gconf_reg_t gconf;
@@ -209,6 +390,10 @@ int pdnuart_init(uint8_t no){
         USB_sendstr("Can't write GCONF\n");
         return FALSE;
     }
+    if(!pdnuart_sgconf(no)){
+        USB_sendstr("Can't write StallGuard settings\n");
+        return FALSE;
+    }
     return TRUE;
 }
 
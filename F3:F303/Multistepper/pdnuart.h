@@ -20,11 +20,72 @@
 
 #include <stdint.h>
 
+#include "hardware.h"
+#include "pdnframe.h"
+
+/*
+ * Non-blocking PDN-UART engine: each bus (USART2 - motors 0..3, USART3 - motors 4..7)
+ * has its own queue of requests. Transactions are made by DMA, reply is checked in
+ * Rx DMA interrupt, callbacks are called from pdnuart_proc().
+ * When queue is empty, GSTAT, DRV_STATUS and SG_RESULT of UART-driven motors are polled
+ * by turns, results are stored into `pdn_mbox`.
+ */
+
+// requests queue length for each bus (power of 2)
+#define PDNQ_LEN            (8)
+// timeout of one transaction, milliseconds
+#define PDNU_TMOUT          (5)
+// pause between background polling transactions, milliseconds
+#define PDNU_POLLINT        (1)
+
+// mailbox flags: value was updated
+#define PDN_MB_GSTAT        (1<<0)
+#define PDN_MB_DRVSTATUS    (1<<1)
+#define PDN_MB_SGRESULT     (1<<2)
+
+typedef struct pdn_rq pdn_rq;
+// completion callback (called from pdnuart_proc)
+typedef void (*pdn_cb)(const pdn_rq *r);
+
+struct pdn_rq{
+    uint32_t data;          // data to write or value read
+    pdn_cb cb;              // callback or NULL
+    uint8_t motor;          // motor number (0..MOTORSNO-1)
+    uint8_t reg;            // register
+    uint8_t write;          // ==1 for writing
+    uint8_t status;         // pdn_status
+};
+
+// results of background polling
+typedef struct{
+    uint32_t gstat;
+    uint32_t drvstatus;
+    uint32_t sgresult;
+    uint32_t Tupd;          // time of last successful reading
+    uint32_t errors;        // failed readings
+    uint8_t fresh;          // PDN_MB_* flags of values updated after last check
+} pdn_mailbox;
+
+typedef struct{
+    uint32_t xfers;         // transactions done
+    uint32_t errors[PDN_ERR_AMOUNT]; // errors by code
+    uint32_t overflows;     // requests rejected: queue is full
+    uint32_t cycle;         // time of last full polling cycle, ms
+    uint16_t depth;         // current queue depth
+    uint16_t maxdepth;      // max queue depth
+} pdn_stat;
+
+extern pdn_mailbox pdn_mbox[MOTORSNO];
+extern pdn_stat pdn_stats[2];
+
 void pdnuart_setup();
+void pdnuart_proc();
+int pdnuart_push(uint8_t motor, uint8_t reg, uint32_t data, int w, pdn_cb cb);
 int pdnuart_writereg(uint8_t reg, uint32_t data);
 int pdnuart_readreg(uint8_t reg, uint32_t *data);
 int pdnuart_setmotno(uint8_t no);
 uint8_t pdnuart_getmotno();
 int pdnuart_setcurrent(uint8_t no, uint8_t val);
 int pdnuart_microsteps(uint8_t no, uint32_t val);
+int pdnuart_sgconf(uint8_t no);
 int pdnuart_init(uint8_t no);
@@ -26,6 +26,7 @@
 #include "flash.h"
 #include "hardware.h"
 #include "hdr.h"
+#include "pdnuart.h"
 #include "proto.h"
 #include "steppers.h"
 #include "version.inc"
@@ -36,6 +37,7 @@
 extern volatile uint32_t Tms;
 
 uint8_t ShowMsgs = 1;
+uint32_t looptime = 0, loopmax = 0;
 // software ignore buffers
 static uint16_t Ignore_IDs[IGN_SIZE];
 static uint8_t IgnSz = 0;
@@ -418,7 +420,8 @@ static const char *eswfl[ESW_AMOUNT] = {
     [ESW_IGNORE]  = "ignore both end-switches",
     [ESW_IGNORE1] = "ignore ESW1, ESW0 stops only when negative mowing",
     [ESW_ANYSTOP] = "stop @ esw in any moving direction",
-    [ESW_STOPDIR] = "stop only when moving in given direction (e.g. to minus @ESW0)"
+    [ESW_STOPDIR] = "stop only when moving in given direction (e.g. to minus @ESW0)",
+    [ESW_STALL]   = "ignore end-switches, find zero by stall (StallGuard)"
 };
 int fn_dumpmotflags(uint32_t _U_ hash,  char _U_ *args){ // "dumpmotflags" (36159640)
     USB_sendstr("Motor flags:");
@@ -449,7 +452,7 @@ static const char* motstates[STP_STATE_AMOUNT] = {
     [STP_MOVE] = "moving",
     [STP_MVSLOW] = "moving at lowest speed",
     [STP_DECEL] = "deceleration",
-    [STP_STALL] = "stalled (not used here!)",
+    [STP_STALL] = "stalled (StallGuard)",
     [STP_ERR] = "error"
 };
 int fn_dumpstates(uint32_t _U_ hash,  char _U_ *args){ // "dumpstates" (4235564367)
@@ -461,6 +464,68 @@ int fn_dumpstates(uint32_t _U_ hash,  char _U_ *args){ // "dumpstates" (42355643
     return RET_GOOD;
 }
 
+int fn_looptime(uint32_t _U_ hash, char *args){ // "looptime" (1539520110)
+    if(args && strchr(args, '=')) loopmax = 0;
+    USB_sendstr("looptime="); printu(looptime);
+    USB_sendstr("\nloopmax="); printu(loopmax);
+    newline();
+    return RET_GOOD;
+}
+
+int fn_sgstream(uint32_t _U_ hash, char *args){ // "sgstream" (3174530027)
+    if(args && *args){
+        uint32_t N;
+        const char *eq = strchr(args, '=');
+        if(!eq) return RET_WRONGCMD;
+        ++eq;
+        if(getnum(eq, &N) == eq) return RET_WRONGCMD;
+        sgstream = N;
+    }
+    USB_sendstr("sgstream="); printu(sgstream);
+    newline();
+    return RET_GOOD;
+}
+
+static const char *pdnerrs[PDN_ERR_AMOUNT] = {
+    [PDN_OK] = "ok",
+    [PDN_ERR_ECHO] = "echo",
+    [PDN_ERR_SYNC] = "sync",
+    [PDN_ERR_REG] = "reg",
+    [PDN_ERR_CRC] = "crc",
+    [PDN_ERR_LEN] = "len",
+    [PDN_ERR_TIMEOUT] = "timeout",
+};
+int fn_pdnstat(uint32_t _U_ hash, char _U_ *args){ // "pdnstat" (1386127491)
+    for(int i = 0; i < 2; ++i){
+        pdn_stat *s = &pdn_stats[i];
+        USB_sendstr("bus"); printu(i);
+        USB_sendstr(": xfers="); printu(s->xfers);
+        for(int e = 1; e < PDN_ERR_AMOUNT; ++e){
+            USB_putbyte(' '); USB_sendstr(pdnerrs[e]); USB_putbyte('='); printu(s->errors[e]);
+        }
+        USB_sendstr(" overflows="); printu(s->overflows);
+        USB_sendstr(" depth="); printu(s->depth);
+        USB_sendstr(" maxdepth="); printu(s->maxdepth);
+        USB_sendstr(" cycle="); printu(s->cycle);
+        newline();
+    }
+    return RET_GOOD;
+}
+
+int fn_tmcstat(uint32_t _U_ hash, char *args){ // "tmcstat" (1114877189)
+    uint32_t N;
+    if(!args || getnum(args, &N) == args || N >= MOTORSNO) return RET_WRONGCMD;
+    pdn_mailbox *m = &pdn_mbox[N];
+    USB_sendstr("GSTAT"); printu(N); USB_putbyte('='); printuhex(m->gstat);
+    USB_sendstr("\nDRV_STATUS"); printu(N); USB_putbyte('='); printuhex(m->drvstatus);
+    USB_sendstr("\nSG_RESULT"); printu(N); USB_putbyte('='); printu(m->sgresult);
+    USB_sendstr("\nsgload"); printu(N); USB_putbyte('='); printu(getsgload(N));
+    USB_sendstr("\nage"); printu(N); USB_putbyte('='); printu(Tms - m->Tupd);
+    USB_sendstr("\nerrors"); printu(N); USB_putbyte('='); printu(m->errors);
+    newline();
+    return RET_GOOD;
+}
+
 int fn_canid(uint32_t _U_ hash, char *args){ // "canid" (2040257924)
     if(args && *args){
         int good = FALSE;
@@ -620,6 +685,15 @@ static int canusb_function(uint32_t hash, char *args){
         case CMD_SCREEN:
             e = cu_screen(par, &val);
         break;
+        case CMD_SEMIN:
+            e = cu_semin(par, &val);
+        break;
+        case CMD_SGLOAD:
+            e = cu_sgload(par, &val);
+        break;
+        case CMD_SGTHRS:
+            e = cu_sgthrs(par, &val);
+        break;
         case CMD_SPEEDLIMIT:
             e = cu_speedlimit(par, &val);
         break;
@@ -699,6 +773,9 @@ int fn_relpos(uint32_t _U_ hash,  char _U_ *args) AL; //* "relpos" (1278646042)
 int fn_relslow(uint32_t _U_ hash,  char _U_ *args) AL; //* "relslow" (1742971917)
 int fn_saveconf(uint32_t _U_ hash,  char _U_ *args) AL; //* "saveconf" (141102426)
 int fn_screen(uint32_t _U_ hash,  char _U_ *args) AL; //* "screen" (2100809349)
+int fn_semin(uint32_t _U_ hash,  char _U_ *args) AL; //* "semin" (2184626849)
+int fn_sgload(uint32_t _U_ hash,  char _U_ *args) AL; //* "sgload" (3195786623)
+int fn_sgthrs(uint32_t _U_ hash,  char _U_ *args) AL; //* "sgthrs" (3212845856)
 int fn_speedlimit(uint32_t _U_ hash,  char _U_ *args) AL; //* "speedlimit" (1654184245)
 int fn_state(uint32_t _U_ hash,  char _U_ *args) AL; //* "state" (2216628902)
 int fn_stop(uint32_t _U_ hash,  char _U_ *args) AL; //* "stop" (17184971)
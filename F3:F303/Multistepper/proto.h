@@ -38,6 +38,7 @@
 #define printf(x)       do{USB_sendstr(float2str(x, 2));}while(0)
 
 extern uint8_t ShowMsgs; // show CAN messages flag
+extern uint32_t looptime, loopmax; // main loop latency (last and max), us
 
 const char *cmd_parser(const char *txt);
 uint8_t isgood(uint16_t ID);
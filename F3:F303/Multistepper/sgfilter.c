@@ -0,0 +1,68 @@
+/*
+ * This file is part of the multistepper project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sgfilter.h"
+
+static uint16_t median3(uint16_t a, uint16_t b, uint16_t c){
+    if(a > b){ uint16_t t = a; a = b; b = t; }
+    if(b > c) b = c;
+    return (a > b) ? a : b;
+}
+
+// restart detection (call on each start of moving); last load value is kept
+void sgf_reset(sgfilter *f){
+    f->blank = SGF_BLANK;
+    f->nlow = 0;
+}
+
+/**
+ * @brief sgf_put - analyze next SG_RESULT sample
+ * @param f - filter
+ * @param sg - SG_RESULT value
+ * @param thrs - SGTHRS (0 - don't detect stall, only collect load)
+ * @param valid - !=0 if motor moves with constant speed
+ * @return 1 if stall detected
+ */
+int sgf_put(sgfilter *f, uint16_t sg, uint8_t thrs, int valid){
+    if(!valid){
+        sgf_reset(f);
+        return 0;
+    }
+    sg &= 0x3ff; // 10 bits
+    uint16_t m = median3(sg, f->last[0], f->last[1]);
+    f->last[1] = f->last[0];
+    f->last[0] = sg;
+    if(f->blank){
+        if(--f->blank == 0) f->ema = sg << SGF_EMASHIFT;
+        return 0;
+    }
+    f->ema = f->ema - (f->ema >> SGF_EMASHIFT) + m;
+    if(thrs == 0) return 0;
+    if(sg > 2 * (uint16_t)thrs){
+        f->nlow = 0;
+        return 0;
+    }
+    if(++f->nlow < SGF_CONFIRM) return 0;
+    f->nlow = SGF_CONFIRM;
+    return 1;
+}
+
+// averaged SG_RESULT (higher value - lower load)
+uint16_t sgf_load(const sgfilter *f){
+    return f->ema >> SGF_EMASHIFT;
+}
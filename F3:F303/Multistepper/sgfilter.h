@@ -0,0 +1,56 @@
+/*
+ * This file is part of the multistepper project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * StallGuard4 stall detector (hardware-independent).
+ * SG_RESULT of TMC2209 falls with motor load, the driver itself signals stall by DIAG
+ * when SG_RESULT <= 2*SGTHRS. Single readings are noisy and have no sense while motor
+ * accelerates or stands, so:
+ *   - only samples marked as valid (motor moves with constant speed) are analyzed;
+ *   - first SGF_BLANK valid samples after (re)start are skipped;
+ *   - stall is reported when SG_RESULT stays <= 2*SGTHRS during SGF_CONFIRM successive samples,
+ *     so short (up to SGF_CONFIRM-1 samples) dropouts are ignored.
+ * Exponential average (weight 1/2^SGF_EMASHIFT) of median of last three samples is kept
+ * as load telemetry.
+ */
+
+// amount of valid samples to skip after start (not less than 2: median needs history)
+#define SGF_BLANK       (3)
+// amount of successive low samples to detect stall
+#define SGF_CONFIRM     (3)
+// EMA weight of new sample: 1/2^SGF_EMASHIFT
+#define SGF_EMASHIFT    (3)
+
+#if SGF_BLANK < 2
+#error "SGF_BLANK should be >= 2"
+#endif
+
+typedef struct{
+    uint16_t last[2];   // two previous samples
+    uint16_t ema;       // average << SGF_EMASHIFT
+    uint8_t blank;      // samples left to skip
+    uint8_t nlow;       // amount of successive low samples
+} sgfilter;
+
+void sgf_reset(sgfilter *f);
+int sgf_put(sgfilter *f, uint16_t sg, uint8_t thrs, int valid);
+uint16_t sgf_load(const sgfilter *f);
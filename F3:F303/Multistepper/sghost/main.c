@@ -0,0 +1,236 @@
+/*
+ * This file is part of the multistepper project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host checker of StallGuard stall detector (../sgfilter.c).
+// Without `-f` runs synthetic SG_RESULT traces (noise, short dropouts, acceleration, stall) and checks
+// that there's no false alarms, stalls are detected fast enough and load average is right.
+// With `-f` runs detector over recorded `sgstream` output ("SG Tms state0 sg0 ... state7 sg7" lines).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+#include "../sgfilter.h"
+
+// motor state of constant speed moving (STP_MOVE) and number of motors in `sgstream` lines
+#define STATE_MOVE      (2)
+#define MOTORSNO        (8)
+// max delay of stall detection (samples)
+#define MAXLATENCY      (SGF_CONFIRM + 3)
+
+// noisy value around `mean`: sum of three uniform randoms in [-amp, amp]
+static int noisy(int mean, int amp){
+    int v = mean;
+    for(int i = 0; i < 3; ++i) v += (int)(lrand48() % (2*amp + 1)) - amp;
+    if(v < 0) v = 0;
+    if(v > 1023) v = 1023;
+    return v;
+}
+
+typedef struct{
+    int base;       // SG_RESULT of free running motor
+    int thrs;       // SGTHRS: stall level is base/3
+    int nacc;       // amount of samples while accelerating
+    int stallat;    // index of first stalled sample or -1
+} trace_t;
+
+// generate trace of `len` samples: sg[] - values, valid[] - constant speed flag
+static void gentrace(trace_t *t, int *sg, int *valid, int len, int withstall){
+    t->base = 150 + lrand48() % 300;
+    t->thrs = t->base / 6;
+    t->nacc = 5 + lrand48() % 20;
+    t->stallat = withstall ? t->nacc + SGF_BLANK + lrand48() % (len - t->nacc - SGF_BLANK - 2*MAXLATENCY) : -1;
+    int amp = t->base / 15;
+    for(int i = 0; i < len; ++i){
+        if(i < t->nacc){ // acceleration: garbage
+            sg[i] = lrand48() % 600;
+            valid[i] = 0;
+            continue;
+        }
+        valid[i] = 1;
+        if(t->stallat > -1 && i >= t->stallat){
+            // load grows during one sample, then SG_RESULT stays near zero
+            sg[i] = (i == t->stallat) ? noisy(t->base / 2, amp) : noisy(t->base / 12, amp / 2);
+            continue;
+        }
+        sg[i] = noisy(t->base, amp);
+        if(lrand48() % 100 == 0){ // dropout of 1 or 2 samples, next sample is normal
+            sg[i] = lrand48() % (t->base / 4);
+            if(i + 1 < len && (lrand48() & 1)){
+                ++i;
+                valid[i] = 1;
+                sg[i] = lrand48() % (t->base / 4);
+            }
+            if(++i < len){
+                valid[i] = 1;
+                sg[i] = noisy(t->base, amp);
+            }
+        }
+    }
+}
+
+// run filter over trace, @return index of detection or -1
+static int runtrace(const int *sg, const int *valid, int len, int thrs, sgfilter *f){
+    memset(f, 0, sizeof(sgfilter));
+    sgf_reset(f);
+    for(int i = 0; i < len; ++i)
+        if(sgf_put(f, sg[i], thrs, valid[i])) return i;
+    return -1;
+}
+
+#define TRLEN   (2000)
+#define NTRACES (2000)
+
+static int chkfree(){
+    int sg[TRLEN], valid[TRLEN], false = 0, badload = 0;
+    trace_t t;
+    sgfilter f;
+    for(int n = 0; n < NTRACES; ++n){
+        gentrace(&t, sg, valid, TRLEN, 0);
+        if(runtrace(sg, valid, TRLEN, t.thrs, &f) > -1) ++false;
+        // mean of load over second half of trace
+        memset(&f, 0, sizeof(f));
+        sgf_reset(&f);
+        long sum = 0;
+        for(int i = 0; i < TRLEN; ++i){
+            sgf_put(&f, sg[i], 0, valid[i]);
+            if(i >= TRLEN/2) sum += sgf_load(&f);
+        }
+        int load = sum / (TRLEN - TRLEN/2);
+        if(abs(load - t.base) > t.base / 20) ++badload;
+    }
+    if(false) printf("%d false stalls\n", false);
+    if(badload) printf("%d bad load values\n", badload);
+    int bad = chkfail("free run", false);
+    return bad | chkfail("load", badload);
+}
+
+static int chkstall(){
+    int sg[TRLEN], valid[TRLEN], early = 0, missed = 0, maxlat = 0, disabled = 0;
+    trace_t t;
+    sgfilter f;
+    for(int n = 0; n < NTRACES; ++n){
+        gentrace(&t, sg, valid, TRLEN, 1);
+        int len = t.stallat + 2*MAXLATENCY;
+        int d = runtrace(sg, valid, len, t.thrs, &f);
+        if(d < 0) ++missed;
+        else if(d < t.stallat) ++early;
+        else if(d - t.stallat > maxlat) maxlat = d - t.stallat;
+        if(runtrace(sg, valid, len, 0, &f) > -1) ++disabled;
+    }
+    printf("max latency: %d samples\n", maxlat);
+    if(early) printf("%d early detections\n", early);
+    if(missed) printf("%d missed stalls\n", missed);
+    int bad = chkfail("stall", early || missed || maxlat > MAXLATENCY);
+    return bad | chkfail("disabled", disabled);
+}
+
+// low values while accelerating and during blanking shouldn't be detected
+static int chkblank(){
+    int sg[64], valid[64], bad = 0;
+    sgfilter f;
+    for(int nacc = 0; nacc < 32; ++nacc){
+        for(int i = 0; i < 64; ++i){
+            sg[i] = 0;
+            valid[i] = (i >= nacc);
+        }
+        int d = runtrace(sg, valid, 64, 100, &f);
+        if(d != nacc + SGF_BLANK + SGF_CONFIRM - 1) bad = 1;
+    }
+    return chkfail("blanking", bad);
+}
+
+// process `sgstream` output of motor `m`
+static int chkfile(const char *name, int m, int thrs){
+    FILE *fp = fopen(name, "r");
+    if(!fp){
+        perror(name);
+        return 1;
+    }
+    char line[512];
+    sgfilter f;
+    memset(&f, 0, sizeof(f));
+    sgf_reset(&f);
+    int nline = 0, nsamples = 0, nstalls = 0;
+    while(fgets(line, sizeof(line), fp)){
+        ++nline;
+        if(strncmp(line, "SG ", 3)) continue;
+        char *p = line + 3, *e;
+        long T = strtol(p, &e, 10), v[2*MOTORSNO];
+        if(e == p) continue;
+        int n = 0;
+        for(; n < 2*MOTORSNO; ++n){
+            p = e;
+            v[n] = strtol(p, &e, 10);
+            if(e == p) break;
+        }
+        if(n != 2*MOTORSNO) continue;
+        ++nsamples;
+        if(sgf_put(&f, v[2*m+1], thrs, v[2*m] == STATE_MOVE)){
+            printf("stall at line %d, T=%ld, load=%d\n", nline, T, sgf_load(&f));
+            ++nstalls;
+            sgf_reset(&f);
+        }
+    }
+    fclose(fp);
+    printf("%d samples, %d stalls, last load=%d\n", nsamples, nstalls, sgf_load(&f));
+    return 0;
+}
+
+static void usage(const char *self){
+    fprintf(stderr, "Usage: %s [options]\n", self);
+    fprintf(stderr, "\t-f file - process `sgstream` output instead of synthetic traces\n");
+    fprintf(stderr, "\t-m N - motor number in file (default 0)\n");
+    fprintf(stderr, "\t-s - seed for random generator\n");
+    fprintf(stderr, "\t-t thrs - SGTHRS for file processing (default 50)\n");
+    exit(1);
+}
+
+int main(int argc, char **argv){
+    int opt, m = 0, thrs = 50;
+    long seed = 1;
+    const char *file = NULL;
+    while((opt = getopt(argc, argv, "f:m:s:t:")) != -1){
+        switch(opt){
+            case 'f':
+                file = optarg;
+            break;
+            case 'm':
+                m = atoi(optarg);
+                if(m < 0 || m >= MOTORSNO) usage(argv[0]);
+            break;
+            case 's':
+                seed = atol(optarg);
+            break;
+            case 't':
+                thrs = atoi(optarg);
+                if(thrs < 0 || thrs > 255) usage(argv[0]);
+            break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if(file) return chkfile(file, m, thrs);
+    srand48(seed);
+    int ret = chkfree();
+    ret |= chkstall();
+    ret |= chkblank();
+    return hosttest_result(ret);
+}
@@ -21,6 +21,7 @@
 #include "hdr.h"
 #include "pdnuart.h"
 #include "proto.h"
+#include "sgfilter.h"
 #include "steppers.h"
 #include "strfunc.h"
 #include "tmc2209.h"
@@ -30,7 +31,8 @@
 typedef enum{
     M0RELAX,        // normal moving
     M0FAST,         // fast move to zero
-    M0SLOW          // slowest move from ESW
+    M0SLOW,         // slowest move from ESW
+    M0STALL         // sensorless homing: move to zero until stall
 } mvto0state;
 
 #ifdef EBUG
@@ -59,6 +61,12 @@ static uint8_t stopflag[MOTORSNO];
 static stp_state state[MOTORSNO];
 // move to zero state
 static mvto0state mvzerostate[MOTORSNO];
+// StallGuard filters of UART-driven motors
+static sgfilter sgf[MOTORSNO];
+// ==1 when motor is stopping due to stall
+static uint8_t sgstalled[MOTORSNO];
+
+uint32_t sgstream = 0;
 
 // lowest ARR value (highest speed), highest (lowest speed)
 //static uint16_t stphighARR[MOTORSNO];
@@ -226,6 +234,8 @@ errcodes motor_absmove(uint8_t i, int32_t newpos){
         return ERR_CANTRUN; // on end-switch
     }
     stopflag[i] = 0;
+    sgstalled[i] = 0;
+    sgf_reset(&sgf[i]);
     targstppos[i] = newpos;
     prevstppos[i] = stppos[i];
     curspeed[i] = the_conf.minspd[i];
@@ -317,6 +327,21 @@ uint8_t motdiagn(uint8_t i){
     return DIAG();
 }
 
+// averaged SG_RESULT of i'th motor
+uint16_t getsgload(uint8_t i){
+    return sgf_load(&sgf[i]);
+}
+
+// StallGuard readings are meaningful only at constant (and not too low) speed
+#define SGVALID(i)  (state[i] == STP_MOVE)
+
+// stall detected: stop motor at nearest step, final state will be set in chkstepper
+static void sgstall(int i){
+    if(sgstalled[i]) return;
+    sgstalled[i] = 1;
+    emstopmotor(i);
+}
+
 // count steps @tim 14/15/16
 void addmicrostep(uint8_t i){
     static volatile uint16_t microsteps[MOTORSNO] = {0}; // current microsteps position
@@ -371,37 +396,47 @@ static void chkstepper(int i){
     if(!the_conf.motflags[i].nocheck){
     if(state[i] != STP_ERR && (the_conf.motflags[i].drvtype == DRVTYPE_UART || the_conf.motflags[i].drvtype == DRVTYPE_SPI)){
         if(the_conf.motflags[i].nodiag){ // check by pdn-uart
-            uint32_t u32;
             switch(the_conf.motflags[i].drvtype){
-                case DRVTYPE_UART:
-                    pdnuart_setmotno(i);
-                    if(pdnuart_readreg(TMC2209Reg_GSTAT, &u32)){
-                        TMC2209_gstat_reg_t s;
-                        s.value = u32;
-                        if(s.drv_err || s.uv_cp){
-                            if(pdnuart_readreg(TMC2209Reg_DRV_STATUS, &u32)){
-                                //TMC2209_drv_status_reg_t d;
-                                //d.value = u32;
-                                USB_sendstr("DRV_STATUS"); USB_putbyte(Nch);
-                                USB_putbyte('='); USB_sendstr(u2str(u32));
-                                newline();
-                            }
-                            USB_sendstr("state"); USB_putbyte(Nch);
-                            USB_sendstr("=6\n");
-                            emstopmotor(i);
-                            state[i] = STP_ERR;
+                case DRVTYPE_UART:{ // values are polled in background by pdnuart_proc()
+                    pdn_mailbox *m = &pdn_mbox[i];
+                    if(!(m->fresh & PDN_MB_GSTAT)) break;
+                    m->fresh &= ~PDN_MB_GSTAT;
+                    TMC2209_gstat_reg_t s;
+                    s.value = m->gstat;
+                    if(s.drv_err || s.uv_cp){
+                        if(m->fresh & PDN_MB_DRVSTATUS){
+                            USB_sendstr("DRV_STATUS"); USB_putbyte(Nch);
+                            USB_putbyte('='); USB_sendstr(u2str(m->drvstatus));
+                            newline();
                         }
+                        USB_sendstr("state"); USB_putbyte(Nch);
+                        USB_sendstr("=6\n");
+                        emstopmotor(i);
+                        state[i] = STP_ERR;
                     }
+                }
                 break;
                 default:
                 break;
             }
         }else if(DIAG()){ // error occured - DIAGN is low
-            emstopmotor(i);
-            state[i] = STP_ERR;
-            return;
+            if(the_conf.sgthrs[i] && SGVALID(i)){ // DIAG also signals StallGuard event
+                sgstall(i);
+            }else{
+                emstopmotor(i);
+                state[i] = STP_ERR;
+                return;
+            }
         }
     }}
+    // StallGuard: analyze new SG_RESULT value
+    if(the_conf.motflags[i].drvtype == DRVTYPE_UART){
+        pdn_mailbox *m = &pdn_mbox[i];
+        if(m->fresh & PDN_MB_SGRESULT){
+            m->fresh &= ~PDN_MB_SGRESULT;
+            if(sgf_put(&sgf[i], m->sgresult, the_conf.sgthrs[i], SGVALID(i))) sgstall(i);
+        }
+    }
 #ifdef EBUG
     if(stp[i]){
         stp[i] = 0;
@@ -474,6 +509,18 @@ static void chkstepper(int i){
         default: // do nothing, check mvzerostate
         break;
     }
+    if(sgstalled[i] && !ismoving(i)){ // motor stopped after stall
+        sgstalled[i] = 0;
+        if(mvzerostate[i] == M0STALL){ // sensorless homing: we are at zero
+            DBG("Stall @ zero");
+            prevstppos[i] = targstppos[i] = stppos[i] = 0;
+            mvzerostate[i] = M0RELAX;
+        }else if(state[i] == STP_RELAX){
+            state[i] = STP_STALL;
+            USB_sendstr("state"); USB_putbyte(Nch);
+            USB_sendstr("=5\n");
+        }
+    }
     switch(mvzerostate[i]){
         case M0FAST:
             if(state[i] == STP_RELAX || state[i] == STP_STALL){ // stopped -> move to +
@@ -508,12 +555,25 @@ static void chkstepper(int i){
                 mvzerostate[i] = M0RELAX;
             }
         break;
+        case M0STALL:
+            if(!sgstalled[i] && !ismoving(i)){ // stopped without stall: reached -maxsteps or stopped by user
+                DBG("No stall found");
+                if(state[i] == STP_RELAX) state[i] = STP_ERR;
+                mvzerostate[i] = M0RELAX;
+            }
+        break;
         default: // RELAX, STALL: do nothing
         break;
     }
 }
 
 errcodes motor_goto0(uint8_t i){
+    if(the_conf.ESW_reaction[i] == ESW_STALL){ // sensorless homing
+        if(the_conf.motflags[i].drvtype != DRVTYPE_UART || !the_conf.sgthrs[i]) return ERR_CANTRUN;
+        errcodes e = motor_absmove(i, -the_conf.maxsteps[i]);
+        if(ERR_OK == e) mvzerostate[i] = M0STALL;
+        return e;
+    }
     errcodes e = motor_absmove(i, -the_conf.maxsteps[i]);
     if(ERR_OK != e){
         if(!esw_block(i)) return e; // limit switch not block -> error
@@ -566,3 +626,16 @@ void process_steppers(){
 uint8_t geteswreact(uint8_t i){
     return ESW_reaction[i];
 }
+
+// print SG_RESULT and state of all motors every `sgstream` ms: "SG Tms state0 sg0 ... state7 sg7"
+void process_sgstream(){
+    static uint32_t Tlast = 0;
+    if(!sgstream || Tms - Tlast < sgstream) return;
+    Tlast = Tms;
+    USB_sendstr("SG "); printu(Tms);
+    for(int i = 0; i < MOTORSNO; ++i){
+        USB_putbyte(' '); printu(state[i]);
+        USB_putbyte(' '); printu(pdn_mbox[i].sgresult);
+    }
+    newline();
+}
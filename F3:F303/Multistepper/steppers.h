@@ -35,7 +35,7 @@ typedef enum{
     STP_MOVE,       // 2 - moving with constant speed
     STP_MVSLOW,     // 3 - moving with slowest constant speed (end of moving)
     STP_DECEL,      // 4 - moving with deceleration
-    STP_STALL,      // 5 - stalled (UNUSED)
+    STP_STALL,      // 5 - stalled (detected by StallGuard)
     STP_ERR ,       // 6 - wrong/error state
     STP_STATE_AMOUNT
 } stp_state;
@@ -46,9 +46,13 @@ enum{
     ESW_IGNORE1,    // ignore ESW1
     ESW_ANYSTOP,    // stop @ esw in any moving direction
     ESW_STOPDIR,    // stop only when moving in given direction (e.g. to minus @ESW0 or to plus @ESW1)
+    ESW_STALL,      // ignore end-switches, find zero by StallGuard (sensorless homing, UART drivers only)
     ESW_AMOUNT      // number of records
 };
 
+// period of SG_RESULT streaming (ms), 0 - off
+extern uint32_t sgstream;
+
 // find zero stages: fast -> 0, slow -> +, slow -> 0
 
 void addmicrostep(uint8_t i);
@@ -72,4 +76,6 @@ stp_state getmotstate(uint8_t i);
 uint8_t ismoving(uint8_t i);
 uint8_t isanymoving();
 uint8_t motdiagn(uint8_t i);
+uint16_t getsgload(uint8_t i);
 void process_steppers();
+void process_sgstream();
@@ -0,0 +1,149 @@
+/*
+ * This file is part of the multistepper project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stm32f3.h>
+#include <string.h>
+
+#include "adc.h"
+#include "flash.h"
+#include "flashlog.h"
+#include "hdr.h"
+#include "proto.h"
+#include "steppers.h"
+#include "strfunc.h"
+#include "telemetry.h"
+#include "usb_dev.h"
+
+extern volatile uint32_t Tms;
+extern const uint32_t _BLOCKSIZE;
+
+static const uint32_t FLASH_blocksize = (uint32_t)&_BLOCKSIZE;
+// record with telemetry_t payload
+#define TLM_RECSZ   FLASHLOG_RECSZ(sizeof(telemetry_t))
+
+static uint8_t haslog = 0;      // log area is configured
+static uint32_t lastT = 0;      // time of last telemetry record
+
+// flashlog.c backend
+int flashlog_program(const uint8_t *addr, const void *data, uint32_t len){
+    return flash_write(addr, data, len);
+}
+
+int flashlog_erasepage(const uint8_t *page){
+    return flash_erasepage(page);
+}
+
+int flashlog_busy(){ // flash programming stalls CPU
+    return isanymoving();
+}
+
+/**
+ * @brief telemetry_init - configure log in last FLASHLOG_NPAGES of flash, run once @ start after flashstorage_init()
+ */
+void telemetry_init(){
+    extern const uint32_t __varsstart;
+    haslog = 0;
+    if(FLASH_SIZE == 0 || FLASH_SIZE >= 20000) return;
+    uint32_t start = FLASH_BASE + FLASH_SIZE * 1024 - FLASHLOG_NPAGES * FLASH_blocksize;
+    // at least one page should stay for user_conf
+    if(start < (uint32_t)&__varsstart + FLASH_blocksize) return;
+    flashlog_cfg c = {.area = (const uint8_t*)start, .npages = FLASHLOG_NPAGES,
+                      .pagesz = FLASH_blocksize, .recsz = TLM_RECSZ};
+    if(flashlog_init(&c)) return;
+    haslog = 1;
+}
+
+// periodically store telemetry; run from main loop
+void telemetry_process(){
+    if(!haslog || !the_conf.logperiod) return;
+    if(Tms - lastT < the_conf.logperiod) return;
+    lastT = Tms;
+    telemetry_t t;
+    for(int i = 0; i < MOTORSNO; ++i){
+        int32_t pos = 0;
+        getpos(i, &pos);
+        t.pos[i] = pos;
+        t.state[i] = (getmotstate(i) & 0x0f) | (ESW_state(i) << 4);
+    }
+    t.vdrive = (uint16_t)(getADCvoltage(ADC_VDRIVE) * 11);
+    t.vfive = (uint16_t)(getADCvoltage(ADC_VFIVE) * 2);
+    t.mcut = (int16_t)(getMCUtemp() / 10);
+    flashlog_put(Tms, &t, sizeof(t));
+}
+
+/********** USB commands **********/
+
+int fn_logperiod(uint32_t _U_ hash, char *args){ // "logperiod" (2999944778)
+    if(args && *args){
+        uint32_t N;
+        const char *eq = strchr(args, '=');
+        if(!eq) return RET_WRONGCMD;
+        ++eq;
+        if(getnum(eq, &N) == eq) return RET_WRONGCMD;
+        the_conf.logperiod = N;
+    }
+    USB_sendstr("logperiod="); printu(the_conf.logperiod); newline();
+    return RET_GOOD;
+}
+
+int fn_logstat(uint32_t _U_ hash, char _U_ *args){ // "logstat" (2464195075)
+    if(!haslog){
+        USND("nolog");
+        return RET_GOOD;
+    }
+    flashlog_stat s;
+    flashlog_getstat(&s);
+    USB_sendstr("logaddr="); printuhex(FLASH_BASE + FLASH_SIZE * 1024 - FLASHLOG_NPAGES * FLASH_blocksize);
+    USB_sendstr("\nrecsize="); printu(TLM_RECSZ);
+    USB_sendstr("\ncapacity="); printu(s.capacity);
+    USB_sendstr("\nheadpage="); printu(s.headpage);
+    USB_sendstr("\nseq="); printu(s.seq);
+    USB_sendstr("\npending="); printu(s.pending);
+    USB_sendstr("\nlost="); printu(s.lost);
+    USB_sendstr("\nerases="); printu(s.erases);
+    USB_sendstr("\nwrites="); printu(s.writes);
+    newline();
+    return RET_GOOD;
+}
+
+int fn_logflush(uint32_t _U_ hash, char _U_ *args){ // "logflush" (731713897)
+    if(flashlog_flush()) USND("FAIL");
+    else USND("OK");
+    return RET_GOOD;
+}
+
+int fn_logerase(uint32_t _U_ hash, char _U_ *args){ // "logerase" (467338327)
+    if(flashlog_erase()) USND("FAIL");
+    else USND("OK");
+    return RET_GOOD;
+}
+
+static void dumpsend(const uint8_t *buf, uint32_t len){
+    IWDG->KR = IWDG_REFRESH;
+    USB_send(buf, (int)len);
+}
+
+/*
+ * Binary dump: text line "logdump=N\n" and then N raw records (oldest first) including
+ * records in RAM buffer that weren't stored yet.
+ */
+int fn_logdump(uint32_t _U_ hash, char _U_ *args){ // "logdump" (2432012925)
+    USB_sendstr("logdump="); printu(flashlog_dump(NULL)); newline();
+    flashlog_dump(dumpsend);
+    return RET_GOOD;
+}
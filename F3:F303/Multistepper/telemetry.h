@@ -0,0 +1,35 @@
+/*
+ * This file is part of the multistepper project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "hardware.h"
+
+// telemetry of multistepper (payload of flash log records, see flashlog.h)
+typedef struct __attribute__((packed)){
+    int32_t pos[MOTORSNO];          // motors' positions
+    uint8_t state[MOTORSNO];        // bits 0..3 - motor state, 4..5 - end-switches
+    uint16_t vdrive;                // Vdrive, mV
+    uint16_t vfive;                 // 5V bus, mV
+    int16_t mcut;                   // MCU T (degC*100)
+} telemetry_t;
+
+void telemetry_init();
+void telemetry_process();
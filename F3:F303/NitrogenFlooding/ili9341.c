@@ -223,6 +223,36 @@ int ili9341_writedata(uint8_t *data, uint32_t N){
     return dmardwr(data, NULL, N);
 }
 
+/**
+ * @brief ili9341_startdata - start non-blocking data writing over DMA
+ * @param data - data to write (don't touch it until ili9341_datadone() returns 1!)
+ * @param N - its length
+ * @return 0 if failed
+ */
+int ili9341_startdata(const uint8_t *data, uint32_t N){
+    if(!data || !N) return 0;
+    SCRN_Data();
+    SCRN_CS_set(0);
+    if(!spi_write_dma(data, NULL, N)){
+        SCRN_Command();
+        SCRN_CS_set(1);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief ili9341_datadone - check end of transmission started by ili9341_startdata()
+ * @return 1 if transmission is over (and screen is deselected)
+ */
+int ili9341_datadone(){
+    if(spi_status != SPI_READY) return 0;
+    if(!spi_waitbsy()) return 0;
+    SCRN_Command();
+    SCRN_CS_set(1);
+    return 1;
+}
+
 // blocking read data by DMA
 int ili9341_readdata(uint8_t *data, uint32_t N){
     return dmardwr(data, data, N);
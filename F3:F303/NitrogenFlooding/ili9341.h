@@ -181,6 +181,8 @@ int ili9341_writereg16(uint8_t reg, uint16_t data);
 int ili9341_writereg32(uint8_t reg, uint16_t data1, uint16_t data2);
 int ili9341_writecmd(uint8_t cmd);
 int ili9341_writedata(uint8_t *data, uint32_t N);
+int ili9341_startdata(const uint8_t *data, uint32_t N);
+int ili9341_datadone();
 int ili9341_readdata(uint8_t *data, uint32_t N);
 int ili9341_readregdma(uint8_t reg, uint8_t *data, uint32_t N);
 
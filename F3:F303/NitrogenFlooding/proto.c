@@ -340,6 +340,7 @@ static int scls(const char *cmd, int parno, const char *c, int32_t i){
     return RET_GOOD;
 }
 static int srefr(const char _U_ *cmd, int _U_ parno, const char _U_ *c, int32_t _U_ i){
+    MarkDirty(0, SCRNH-1);
     UpdateScreen(0, SCRNH-1);
     USB_sendstr(OK);
     return RET_GOOD;
@@ -376,9 +377,6 @@ static int sstate(const char _U_ *cmd, int _U_ parno, const char _U_ *c, int32_t
         case SCREEN_RELAX:
             s = "relax";
         break;
-        case SCREEN_CONVBUF:
-            s = "convert buffer";
-        break;
         case SCREEN_UPDATENXT:
             s = "update next";
         break;
@@ -389,6 +387,14 @@ static int sstate(const char _U_ *cmd, int _U_ parno, const char _U_ *c, int32_t
     USB_sendstr("ScreenState="); USB_sendstr(s); newline();
     return RET_GOOD;
 }
+static int supdtime(const char _U_ *cmd, int _U_ parno, const char _U_ *c, int32_t _U_ i){
+    sendkeyu("FULLUS", -1, ScrnStat.fullus);
+    sendkeyu("NFULL", -1, ScrnStat.nfull);
+    sendkeyu("PARTUS", -1, ScrnStat.partus);
+    sendkeyu("PARTROWS", -1, ScrnStat.partrows);
+    sendkeyu("NPART", -1, ScrnStat.npart);
+    return RET_GOOD;
+}
 static int sfscale(const char *cmd, int _U_ parno, const char _U_ *c, int32_t i){
     sendkeyu(cmd, -1, SetFontScale((uint8_t)i));
     return RET_GOOD;
@@ -450,6 +456,7 @@ commands cmdlist[] = {
     {scolor, "Scolor", "seg color fg=bg"},
     {sputstr, "Sstr", "put string y=string"},
     {sstate, "Sstate", "current screen state"},
+    {supdtime, "Supdtime", "time (us) of last full and partial screen updates"},
     {sfscale, "Sfscale", "set/get =font scale"},
     {NULL, "ADC commands", NULL},
     {adcval, "ADC", "get ADCx value (without x - for all)"},
@@ -52,12 +52,26 @@ static uint8_t screenbuf[SCREENBUF_SZ];
 // color buffers
 static uint16_t foreground[SPRITE_SZ];
 static uint16_t background[SPRITE_SZ];
-// borders of string numbers to update screen (including!)
-static int uy0, uy1;
+// "dirty" rows (changed after last update) bitmask
+static uint32_t dirty[(SCRNH + 31) / 32];
+// borders of requested update window and of current band (including!)
+static int reqy0, reqy1, uy0, uy1;
+// ==1 if there's an update request
+static uint8_t updreq = 0;
 // index of pixel in given updating block
-static int updidx = 0; // ==-1 to initialize update
-// next data portion size (in bytes!), total amount of bytes in update buffer
+static int updidx = 0;
+// next data portion size (in pixels), total amount of pixels in current band
 static int portionsz = 0, updbuffsz;
+// ping-pong color buffers: one is converted while other is sent by DMA
+static uint16_t colorbuf2[COLORBUFSZ];
+static uint16_t *cbufs[2] = {colorbuf, colorbuf2};
+static uint8_t cbufidx = 0; // index of buffer to convert into
+static int havenext = 0; // next portion is converted and waits for transmission
+// last SPI activity time (for timeout)
+static uint32_t Tscr_last = 0;
+// update time statistics
+static uint32_t updstart = 0, updrows = 0;
+scrn_updstat ScrnStat = {0};
 // font scale
 uint8_t fontscale = 1;
 int fontheight = 0, fontbase = 0;
@@ -75,12 +89,27 @@ screen_state ScrnState = SCREEN_INIT;
 void UpdateScreen(int y0, int y1){
     //if(y0 > y1) SWAPINT(y0, y1);
     if(y0 < 0) y0 = 0;
-    if(y1 > SCRNH || y1 < 0) y1 = SCRNH - 1;
-    uy0 = y0; uy1 = y1;
-    updidx = -1;
-    updbuffsz = SCRNW * (1 + y1 - y0);
+    if(y1 > SCRNH - 1 || y1 < 0) y1 = SCRNH - 1;
+    if(updreq){ // merge with previous request
+        if(y0 < reqy0) reqy0 = y0;
+        if(y1 > reqy1) reqy1 = y1;
+    }else{
+        reqy0 = y0; reqy1 = y1;
+        updreq = 1;
+    }
 }
 
+/**
+ * @brief MarkDirty - mark rows y0..y1 (including) as changed, so they will be sent on next update
+ */
+void MarkDirty(int y0, int y1){
+    if(y0 < 0) y0 = 0;
+    if(y1 > SCRNH - 1) y1 = SCRNH - 1;
+    for(int y = y0; y <= y1; ++y) dirty[y / 32] |= 1UL << (y % 32);
+}
+
+#define ISDIRTY(y)  (dirty[(y) / 32] & (1UL << ((y) % 32)))
+
 /**
  * @brief FillScreen - fill screen buffer with current bgColor
  */
@@ -90,6 +119,7 @@ void ClearScreen(){
         foreground[i] = fgColor;
         background[i] = bgColor;
     }
+    MarkDirty(0, SCRNH-1);
     UpdateScreen(0, SCRNH-1);
 }
 
@@ -110,6 +140,7 @@ void ClearScreen(){
  */
 void DrawPix(int X, int Y, uint8_t pix){
     DRAWPIX(X, Y, pix);
+    MarkDirty(Y, Y);
 }
 
 /**
@@ -126,6 +157,7 @@ void invertSpriteColor(int xmin, int xmax, int ymin, int ymax){
     // convert to sprite coordinates
     xmin /= SPRITEWD; xmax = (xmax + SPRITEWD - 1) / SPRITEWD;
     ymin /= SPRITEHT; ymax = (ymax + SPRITEHT - 1) / SPRITEHT;
+    MarkDirty(ymin * SPRITEHT, (ymax + 1) * SPRITEHT - 1);
     for(int y = ymin; y <= ymax; ++y){
         int idx = y * SCRNSPRITEW + xmin;
         uint16_t *f = foreground + idx, *b = background + idx;
@@ -163,6 +195,7 @@ uint8_t DrawCharAt(int X, int Y, uint8_t Char){
     // height and width of letter in pixels
     uint8_t h = curfont->height, w = *curchar++; // now curchar is pointer to bits array
     uint8_t lw = curfont->bytes / h; // width of letter in bytes
+    MarkDirty(Y, Y + h * fontscale - 1);
     for(uint8_t row = 0; row < h; ++row){
         int Y1 = Y + fontscale * row;
         for(uint8_t col = 0; col < w; ++col){
@@ -213,7 +246,7 @@ int strpixlen(const char *str){
     return l * fontscale;
 }
 
-// convert buffer  to update (return 0 if all sent)
+// convert next portion of current band into cbufs[cbufidx] (return 0 if all converted)
 static int convbuf(){
 //    DBG("convert buffer");
     int rest = updbuffsz - updidx;
@@ -225,7 +258,7 @@ static int convbuf(){
     portionsz = rest;
 //   USB_sendstr("portionsz="); USB_sendstr(i2str(portionsz)); newline();
     int Y = uy0 + updidx / SCRNW; // starting Y of updating string
-    uint16_t *o = colorbuf; // output color data
+    uint16_t *o = cbufs[cbufidx]; // output color data
     uint8_t *i = screenbuf + (Y*SCRNSPRITEW); // starting portion of pixel info
     while(rest > 0){
         int spidx = (Y/SPRITEHT)*SCRNSPRITEW; // index in color array
@@ -240,16 +273,68 @@ static int convbuf(){
                 ++updidx; --rest;
             }
         }
+        dirty[Y / 32] &= ~(1UL << (Y % 32)); // row converted: new changes will be sent on next update
+        ++updrows;
         ++Y;
     }
     return 1;
 }
 
+// find next band of dirty rows in update window; @return 0 if there's nothing to update
+static int nextband(){
+    int y = reqy0;
+    while(y <= reqy1 && !ISDIRTY(y)) ++y;
+    if(y > reqy1) return 0;
+    uy0 = y;
+    while(y <= reqy1 && ISDIRTY(y)) ++y;
+    uy1 = y - 1;
+    updidx = 0;
+    updbuffsz = SCRNW * (1 + uy1 - uy0);
+    return 1;
+}
+
+// current time in microseconds (SysTick counts down from LOAD each millisecond)
+static uint32_t getus(){
+    uint32_t ms, val;
+    do{
+        ms = Tms;
+        val = SysTick->VAL;
+    }while(ms != Tms);
+    return ms * 1000 + (SysTick->LOAD - val) / ((SysTick->LOAD + 1) / 1000);
+}
+
+// all dirty rows in window are sent: store statistics
+static void updone(){
+    updreq = 0;
+    if(!updrows) return;
+    uint32_t t = getus() - updstart;
+    if(updrows >= SCRNH){
+        ScrnStat.fullus = t;
+        ++ScrnStat.nfull;
+    }else{
+        ScrnStat.partus = t;
+        ScrnStat.partrows = updrows;
+        ++ScrnStat.npart;
+    }
+    updrows = 0;
+}
+
+// start transmission of converted portion and convert next one while DMA works
+static int sendportion(){
+    // portionsz in pixels (uint16_t), sending size in bytes!
+    if(!ili9341_startdata((uint8_t*)cbufs[cbufidx], portionsz * 2)) return 0;
+    Tscr_last = Tms; // wait DMA writing timeout
+    cbufidx = !cbufidx;
+    havenext = convbuf();
+    return 1;
+}
+
 // check SPI timeout
-static uint32_t Tscr_last = 0;
 static int chk_tmout(){
     if(Tms - Tscr_last > SCRN_SPI_TIMEOUT){
         ScrnState = SCREEN_INIT;
+        updrows = 0;
+        MarkDirty(0, SCRNH-1); // state of screen is unknown
         UpdateScreen(0, SCRNH-1);
         return 1;
     }
@@ -275,44 +360,43 @@ void process_screen(){
             if(Tms - Tscr_last > SCRN_W4INI_TIMEOUT) ScrnState = SCREEN_INIT;
         break;
         case SCREEN_RELAX: // check need of updating
-            if(updidx > -1) return;
+            if(!updreq) return;
+            if(!nextband()){ // all requested rows are up to date
+                updone();
+                return;
+            }
             //DBG("Need to update");
             if(!ili9341_setcol(0, SCRNW-1)) return;
             if(!ili9341_setrow(uy0, uy1)) return;
             if(!ili9341_writecmd(ILI9341_RAMWR)) return;
-            updidx = 0;
+            if(!updrows) updstart = getus();
+            havenext = convbuf();
             Tscr_last = Tms;
-            ScrnState = SCREEN_ACTIVE; // now we are ready to update screen
+            ScrnState = SCREEN_UPDATENXT; // now we are ready to update screen
         // fallthrough
-        case SCREEN_ACTIVE: // SPI transmission active
+        case SCREEN_UPDATENXT: // send next data portion
             if(chk_tmout()){
                 DBG("timeout");
                 return;
             }
-            if(spi_status != SPI_READY){
-                DBG("SPI not ready");
-                return;
-            }
-            // convert & update next field
-            ScrnState = SCREEN_CONVBUF;
-        // fallthrough
-        case SCREEN_CONVBUF: // convert buffer for sending
-            if(!convbuf()){
+            if(!havenext){ // band is empty?
                 ScrnState = SCREEN_RELAX;
                 return;
             }
-            Tscr_last = Tms; // for DMA writing timeout
-            ScrnState = SCREEN_UPDATENXT;
+            if(!sendportion()) return;
+            ScrnState = SCREEN_ACTIVE;
         // fallthrough
-        case SCREEN_UPDATENXT: // send next data portion
+        case SCREEN_ACTIVE: // SPI transmission active
             if(chk_tmout()){
                 DBG("timeout");
                 return;
             }
-            // portionsz in pixels (uint16_t), sending size in bytes!
-            if(!ili9341_writedata((uint8_t*)colorbuf, portionsz * 2)) return;
-            Tscr_last = Tms; // wait DMA writing timeout
-            ScrnState = SCREEN_ACTIVE;
+            if(!ili9341_datadone()) return;
+            if(!havenext){ // band sent, check next
+                ScrnState = SCREEN_RELAX;
+                return;
+            }
+            if(!sendportion()) ScrnState = SCREEN_UPDATENXT;
         break;
         default:
         break;
@@ -25,9 +25,8 @@ typedef enum{ // screen states
      SCREEN_INIT        // init stage
     ,SCREEN_W4INIT      // wait after last unsuccessfull update
     ,SCREEN_RELAX       // nothing to do (screen is off)
-    ,SCREEN_CONVBUF     // convert next buffer portion
-    ,SCREEN_UPDATENXT   // update next block
-    ,SCREEN_ACTIVE      // transmission active - wait for SPI transfer ends
+    ,SCREEN_UPDATENXT   // start sending of next converted block
+    ,SCREEN_ACTIVE      // transmission active - next block converted, wait for SPI transfer ends
 
 } screen_state;
 
@@ -89,11 +88,22 @@ typedef enum{ // screen states
 #define COLOR_YELLOWGREEN 0x9E66
 
 
+// screen update times (us)
+typedef struct{
+    uint32_t fullus;    // last full screen update
+    uint32_t partus;    // last partial update
+    uint32_t partrows;  // amount of rows sent in last partial update
+    uint32_t nfull;     // amount of full and partial updates
+    uint32_t npart;
+} scrn_updstat;
+
 extern screen_state ScrnState;
+extern scrn_updstat ScrnStat;
 extern int fontheight, fontbase;
 
 void ClearScreen();
 void UpdateScreen(int y0, int y1);
+void MarkDirty(int y0, int y1);
 void setBGcolor(uint16_t c);
 void setFGcolor(uint16_t c);
 void invertSpriteColor(int xmin, int xmax, int ymin, int ymax);
@@ -17,8 +17,8 @@
  */
 
 #include <stm32g0.h>
-#include <string.h> // memcpy
 #include "flash.h"
+#include "kvstore.h"
 #include "strfunc.h"
 #include "usart.h"
 
@@ -26,11 +26,6 @@ extern const uint32_t __varsstart, _BLOCKSIZE;
 
 static const uint32_t blocksize = (uint32_t)&_BLOCKSIZE;
 
-// max amount of Config records stored (will be recalculate in flashstorage_init()
-static uint32_t maxCnum = 1024 / sizeof(user_conf); // can't use blocksize here
-
-#define DEFMF   {.haveencoder = 1, .donthold = 1, .eswinv = 1, .keeppos = 1}
-
 #define USERCONF_INITIALIZER  {             \
      .userconf_sz = sizeof(user_conf)       \
     ,.flagU16 = 0xabcd                      \
@@ -42,66 +37,26 @@ static int erase_flash(const void*, const void*);
 static int write2flash(const void*, const void*, uint32_t);
 // don't write `static` here, or get error:
 //      'memcpy' forming offset 8 is out of the bounds [0, 4] of object '__varsstart' with type 'uint32_t'
-const user_conf *Flash_Data = (const user_conf *)(&__varsstart);
+const uint8_t *Flash_Data = (const uint8_t *)(&__varsstart);
+#define SECTOR(n)   (Flash_Data + (n) * blocksize)
 
 user_conf the_conf = USERCONF_INITIALIZER;
 
-static int currentconfidx = -1; // index of current configuration
+// backend of kvstore.c: two pages after firmware
+const uint8_t *kv_sector(int n){
+    return SECTOR(n);
+}
 
-/**
- * @brief binarySearch - binary search in flash for last non-empty cell
- *          any struct searched should have its sizeof() @ the first field!!!
- * @param l - left index
- * @param r - right index (should be @1 less than last index!)
- * @param start - starting address
- * @param stor_size - size of structure to search
- * @return index of non-empty cell or -1
- */
-static int binarySearch(int r, const uint8_t *start, int stor_size){
-    int l = 0;
-    while(r >= l){
-        int mid = l + (r - l) / 2;
-        const uint8_t *s = start + mid * stor_size;
-        if(*((const uint16_t*)s) == stor_size){
-            if(*((const uint16_t*)(s + stor_size)) == 0xffff){ // next is free
-                return mid;
-            }else{ // element is to the right
-                l = mid + 1;
-            }
-        }else{ // element is to the left
-            r = mid - 1;
-        }
-    }
-    return -1; // not found
+uint32_t kv_sectsize(){
+    return blocksize;
 }
 
-/**
- * @brief flashstorage_init - initialization of user conf storage
- * run in once @ start
- */
-void flashstorage_init(){
-    if(FLASH_SIZE > 0 && FLASH_SIZE < 20000){
-        uint32_t flsz = FLASH_SIZE * 1024; // size in bytes
-        flsz -= (uint32_t)(&__varsstart) - FLASH_BASE;
-        maxCnum = flsz / sizeof(user_conf);
-    }
-    // -1 if there's no data at all & flash is clear; maxnum-1 if flash is full
-    currentconfidx = binarySearch((int)maxCnum-2, (const uint8_t*)Flash_Data, sizeof(user_conf));
-    if(currentconfidx > -1){
-        memcpy(&the_conf, &Flash_Data[currentconfidx], sizeof(user_conf));
-    }
+int kv_erase(int n){
+    return erase_flash(SECTOR(n), SECTOR(n + 1));
 }
 
-// store new configuration
-// @return 0 if all OK
-int store_userconf(){
-    // maxnum - 3 means that there always should be at least one empty record after last data
-    // for binarySearch() checking that there's nothing more after it!
-    if(currentconfidx > (int)maxCnum - 3){ // there's no more place
-        currentconfidx = 0;
-        if(erase_flash(Flash_Data, NULL)) return 1;
-    }else ++currentconfidx; // take next data position (0 - within first run after firmware flashing)
-    return write2flash((const void*)&Flash_Data[currentconfidx], &the_conf, sizeof(the_conf));
+int kv_program(const uint8_t *addr, const void *data, uint32_t len){
+    return write2flash(addr, data, len);
 }
 
 static int write2flash(const void *start, const void *wrdata, uint32_t stor_size){
@@ -149,7 +104,7 @@ static int erase_flash(const void *start, const void *end){
     if(!start) return 1;
     uint32_t startb = (((uint32_t)start - FLASH_BASE) + blocksize - 1) / blocksize, endb;
     if(!end){ // erase all remaining
-        endb = FLASH_SIZE * 1024 / blocksize;
+        endb = FLASH_SIZE / blocksize; // FLASH_SIZE is in bytes for G0
     }else{ // erase a part
         endb = (((uint32_t)end - FLASH_BASE) + blocksize - 1) / blocksize;
     }
@@ -167,7 +122,7 @@ static int erase_flash(const void *start, const void *end){
         /* (2) Select the page to erase (PNB) */
         /* (3) Set the STRT bit in the FLASH_CR register to start the erasing */
         /* (4) Wait until BSY1 cleared */
-        FLASH->CR |= FLASH_CR_PER | i << FLASH_CR_PNB_Pos; /* (1) (2) */
+        FLASH->CR = (FLASH->CR & ~FLASH_CR_PNB) | FLASH_CR_PER | i << FLASH_CR_PNB_Pos; /* (1) (2) */
         FLASH->CR |= FLASH_CR_STRT; /* (3) */
         while ((FLASH->SR & FLASH_SR_BSY1) != 0){} /* (4) */
         FLASH->SR = FLASH_SR_EOP;
@@ -178,13 +133,22 @@ static int erase_flash(const void *start, const void *end){
         }
         FLASH->CR &= ~FLASH_CR_PER; // clear PER
     }
+    FLASH->CR |= FLASH_CR_LOCK; // lock it back
     return ret;
 }
 
 void dump_userconf(){
+    int actsect;
+    uint32_t actseq, used;
+    kv_info(&actsect, &actseq, &used);
     SEND("flashsize="); printu(FLASH_SIZE);
     SEND("\nuserconf_addr="); printuhex((uint32_t)Flash_Data);
-    SEND("\nuserconf_idx="); usart3_sendstr(i2str(currentconfidx));
+    SEND("\nactive_sector="); usart3_sendstr(i2str(actsect));
+    SEND("\nsector_seq="); printu(actseq);
+    SEND("\nsector_used="); printu(used);
+    SEND("\nerases="); printu(flash_stat.erases);
+    SEND("\nrecords="); printu(flash_stat.records);
+    SEND("\nbytes="); printu(flash_stat.bytes);
     SEND("\nuserconf_sz="); printu(the_conf.userconf_sz);
     SEND("\nflagU16="); printuhex(the_conf.flagU16);
     SEND("\nflagU32="); printuhex(the_conf.flagU32);
@@ -192,7 +156,3 @@ void dump_userconf(){
     newline();
     usart3_sendbuf();
 }
-
-int erase_storage(){
-    return erase_flash(Flash_Data, NULL);
-}
@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <stdint.h>
+
 /*
  * struct to save user configurations
  */
@@ -29,7 +31,15 @@ typedef struct __attribute__((packed, aligned(8))){
 } user_conf;
 
 extern user_conf the_conf; // global user config (read from FLASH to RAM)
-// data from ld-file: start address of storage
+
+// storage statistics
+typedef struct{
+    uint32_t erases;    // amount of page erasings from start
+    uint32_t records;   // amount of records written from start
+    uint32_t bytes;     // amount of bytes written from start
+} flash_stat_t;
+
+extern flash_stat_t flash_stat;
 
 void flashstorage_init();
 int store_userconf();
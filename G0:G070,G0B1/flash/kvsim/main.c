@@ -0,0 +1,267 @@
+/*
+ * This file is part of the flash project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host checker of key/value config storage (../kvstore.c) on simulated G0 flash: two 2k pages programmed
+// by double words (only erased double word can be programmed). Power loss is injected in random
+// program/erase operation: interrupted programming leaves some bits of double word unprogrammed,
+// interrupted erasing leaves some bits of page not erased. After each "reboot" every field should have
+// its old or new value and storage should continue working. Amount of page erasings is compared with
+// old scheme (whole user_conf appended, all region erased when full).
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+#include "flash.h"
+#include "kvstore.h"
+
+#define PAGESZ      (2048)
+#define NOLOSS      (-1)
+
+user_conf the_conf = {
+     .userconf_sz = sizeof(user_conf)
+    ,.flagU16 = 0xabcd
+    ,.flagU32 = 0xdeadbeef
+    ,.str = "test string"
+};
+
+static user_conf defconf;
+static uint64_t simflash[2][PAGESZ / 8];
+static uint32_t simerases[2];   // erasings of each page
+static long opsleft = NOLOSS;   // operations before power loss
+static jmp_buf powerloss;
+static int losserase = 0, lossprog = 0; // amount of interrupted erasings and programmings
+
+static uint64_t rand64(){
+    return ((uint64_t)mrand48() << 32) ^ (uint32_t)mrand48();
+}
+
+static int powerfail(){
+    if(opsleft == NOLOSS) return 0;
+    return --opsleft == 0;
+}
+
+const uint8_t *kv_sector(int n){
+    return (const uint8_t*)simflash[n];
+}
+
+uint32_t kv_sectsize(){
+    return PAGESZ;
+}
+
+int kv_erase(int n){
+    if(powerfail()){ // some bits are still not erased
+        for(int i = 0; i < PAGESZ / 8; ++i) simflash[n][i] |= rand64() & rand64();
+        ++losserase;
+        longjmp(powerloss, 1);
+    }
+    memset(simflash[n], 0xff, PAGESZ);
+    ++simerases[n];
+    return 0;
+}
+
+int kv_program(const uint8_t *addr, const void *data, uint32_t len){
+    uint64_t *dst = (uint64_t*)addr;
+    const uint8_t *src = (const uint8_t*)data;
+    for(uint32_t i = 0; i < (len + 7) / 8; ++i, ++dst, src += 8){
+        uint64_t d;
+        memcpy(&d, src, 8);
+        if(*dst != UINT64_MAX) return 1; // PROGERR: double word isn't erased
+        if(powerfail()){ // some zeros are still not programmed
+            *dst = d | (rand64() & rand64());
+            ++lossprog;
+            longjmp(powerloss, 1);
+        }
+        *dst = d;
+    }
+    return 0;
+}
+
+static void reboot(){
+    opsleft = NOLOSS;
+    the_conf = defconf;
+    flashstorage_init();
+}
+
+static void clearflash(){
+    memset(simflash, 0xff, sizeof(simflash));
+    memset(simerases, 0, sizeof(simerases));
+    memset(&flash_stat, 0, sizeof(flash_stat));
+    reboot();
+}
+
+// change random fields (at least one) of `c`
+static void randconf(user_conf *c){
+    int m = 1 + lrand48() % 7;
+    if(m & 1) c->flagU16 = lrand48() & 0xffff;
+    if(m & 2) c->flagU32 = mrand48();
+    if(m & 4) for(int i = 0; i < (int)sizeof(c->str); ++i) c->str[i] = lrand48() & 0xff;
+}
+
+// each field of the_conf should be equal to one of `a` or `b`
+static int chkfields(const user_conf *a, const user_conf *b){
+    const user_conf *c = &the_conf;
+    if(c->userconf_sz != sizeof(user_conf)) return 1;
+    if(c->flagU16 != a->flagU16 && c->flagU16 != b->flagU16) return 1;
+    if(c->flagU32 != a->flagU32 && c->flagU32 != b->flagU32) return 1;
+    if(memcmp(c->str, a->str, sizeof(c->str)) && memcmp(c->str, b->str, sizeof(c->str))) return 1;
+    return 0;
+}
+
+// stores without power loss, random reboots
+static int chkstore(){
+    int bad = 0;
+    clearflash();
+    bad |= memcmp(&the_conf, &defconf, sizeof(user_conf)) != 0;
+    for(int i = 0; i < 20000 && !bad; ++i){
+        user_conf c = the_conf;
+        randconf(&c);
+        the_conf = c;
+        if(store_userconf()){
+            if(verbose) printf("store %d: error\n", i);
+            bad = 1;
+        }
+        if(lrand48() & 1) reboot();
+        if(memcmp(&the_conf, &c, sizeof(user_conf))){
+            if(verbose) printf("store %d: wrong data after reboot\n", i);
+            bad = 1;
+        }
+    }
+    if(verbose) printf("\t%u compactions, %u records, %u bytes\n", flash_stat.erases, flash_stat.records, flash_stat.bytes);
+    return chkfail("stores and reboots", bad);
+}
+
+static int chkpowerloss(){
+    volatile int bad = 0, nloss = 0;
+    clearflash();
+    for(int i = 0; i < 50000 && !bad; ++i){
+        user_conf old = the_conf, c = the_conf;
+        randconf(&c);
+        the_conf = c;
+        int loss = lrand48() & 1;
+        if(loss) opsleft = 1 + lrand48() % 12;
+        if(setjmp(powerloss)){
+            ++nloss;
+            reboot();
+            if(chkfields(&old, &c)){
+                if(verbose) printf("loss %d (store %d): field is neither old nor new\n", nloss, i);
+                bad = 1;
+            }
+            continue;
+        }
+        if(store_userconf()){
+            if(verbose) printf("store %d: error\n", i);
+            bad = 1;
+        }
+        reboot();
+        if(memcmp(&the_conf, &c, sizeof(user_conf))){
+            if(verbose) printf("store %d: wrong data after reboot\n", i);
+            bad = 1;
+        }
+    }
+    if(verbose) printf("\t%d power losses: %d in erasing, %d in programming\n", nloss, losserase, lossprog);
+    if(!losserase || !lossprog) bad = 1;
+    return chkfail("power loss", bad);
+}
+
+typedef struct{
+    uint32_t total;     // total page erasings
+    uint32_t perpage;   // max erasings of one page
+} wear_t;
+
+// old scheme: whole user_conf appended into `npages` pages, all pages erased when there's no place;
+// `maxrec` - amount of records (maxCnum)
+static wear_t oldscheme(int nstores, int npages, int maxrec){
+    wear_t w = {0, 0};
+    int idx = -1;
+    for(int i = 0; i < nstores; ++i){
+        if(idx > maxrec - 3){
+            idx = 0;
+            w.total += npages;
+            ++w.perpage;
+        }else ++idx;
+    }
+    return w;
+}
+
+// `nstores` stores with changed fields by mask `m` (1 - flagU16, 2 - flagU32, 4 - str)
+static wear_t kvscheme(int nstores, int m){
+    wear_t w;
+    clearflash();
+    for(int i = 0; i < nstores; ++i){
+        if(m & 1) ++the_conf.flagU16;
+        if(m & 2) ++the_conf.flagU32;
+        if(m & 4) ++the_conf.str[0];
+        store_userconf();
+    }
+    w.total = simerases[0] + simerases[1];
+    w.perpage = (simerases[0] > simerases[1]) ? simerases[0] : simerases[1];
+    return w;
+}
+
+static int chkwear(){
+    const int nstores = 100000;
+    // firmware of ~5k occupies 3 pages of 64, so 61 pages remain after __varsstart
+    const int flpages = 61, recsz = sizeof(user_conf);
+    struct{
+        const char *name;
+        wear_t w;
+    } old[] = {
+        // FLASH_SIZE is in bytes on G0, so old flashstorage_init() left maxCnum = 1024/sizeof(user_conf)
+        {"old, as built (25 records, erase 61 pages)", oldscheme(nstores, flpages, 1024 / recsz)},
+        {"old, same 2 pages", oldscheme(nstores, 2, 2 * PAGESZ / recsz)},
+        {"old, all 61 pages", oldscheme(nstores, flpages, flpages * PAGESZ / recsz)},
+    };
+    struct{
+        const char *name;
+        int mask;
+        wear_t w;
+    } kv[] = {
+        {"KV, flagU16 changed", 1, {0}},
+        {"KV, flagU32 changed", 2, {0}},
+        {"KV, str changed", 4, {0}},
+        {"KV, all fields changed", 7, {0}},
+    };
+    printf("page erasings for %d stores (total / max of one page):\n", nstores);
+    for(size_t i = 0; i < sizeof(old)/sizeof(old[0]); ++i)
+        printf("\t%-45s %7u / %u\n", old[i].name, old[i].w.total, old[i].w.perpage);
+    int bad = 0;
+    for(size_t i = 0; i < sizeof(kv)/sizeof(kv[0]); ++i){
+        kv[i].w = kvscheme(nstores, kv[i].mask);
+        printf("\t%-45s %7u / %u\n", kv[i].name, kv[i].w.total, kv[i].w.perpage);
+    }
+    // the same region: single small field should wear pages at least 4 times less
+    for(int i = 0; i < 2; ++i)
+        if(kv[i].w.perpage * 4 > old[1].w.perpage) bad = 1;
+    // pages are used in turn
+    for(size_t i = 0; i < sizeof(kv)/sizeof(kv[0]); ++i)
+        if(kv[i].w.total - kv[i].w.perpage > kv[i].w.perpage) bad = 1;
+    return chkfail("flash wear", bad);
+}
+
+int main(int argc, char **argv){
+    hosttest_opts(argc, argv);
+    defconf = the_conf;
+    int ret = chkstore();
+    ret |= chkpowerloss();
+    ret |= chkwear();
+    return hosttest_result(ret);
+}
@@ -0,0 +1,212 @@
+/*
+ * This file is part of the flash project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h> // offsetof
+#include <string.h> // memcpy
+#include "flash.h"
+#include "kvstore.h"
+
+/*
+ * Log-structured key/value storage in two flash pages (sectors).
+ * Each field of user_conf is a key; store_userconf() appends records only for changed fields.
+ * Sector: header (magic, sequence number and their complements) + records. Record: kvent_hdr + data
+ * padded to 8 bytes (G0 programs flash by double words). Records with bad CRC (interrupted writing) are skipped.
+ * When active sector is full, current values of all keys are copied into other (erased) sector
+ * and only after that its header is written, so power loss at any moment leaves valid data:
+ * at start sector with valid header and greatest sequence number is active. Complements in header
+ * reject sector with interrupted erasing (some bits set) even if magic survived.
+ */
+#define KV_MAGIC        (0x4b563032U)    // "KV02"
+#define KV_ALIGN        (8)
+#define KV_ENTSZ(len)   ((sizeof(kvent_hdr) + (len) + KV_ALIGN - 1) & ~(KV_ALIGN - 1))
+
+typedef struct{
+    uint32_t magic;
+    uint32_t seq;       // number of compaction (== amount of erase cycles of both sectors)
+    uint32_t nseq;      // ~seq
+    uint32_t nmagic;    // ~magic
+} kvsect_hdr;
+
+typedef struct{
+    uint8_t key;
+    uint8_t len;
+    uint16_t crc;       // CRC16 of key, len and data
+} kvent_hdr;
+
+// keys (fields of user_conf)
+#define UCFIELD(f)  {offsetof(user_conf, f), sizeof(((user_conf*)0)->f)}
+static const struct{
+    uint16_t offset;
+    uint16_t size;
+} fields[] = {
+    UCFIELD(flagU16),
+    UCFIELD(flagU32),
+    UCFIELD(str),
+};
+#define KV_NKEYS    (sizeof(fields)/sizeof(fields[0]))
+// max size of record
+#define KV_MAXENT   KV_ENTSZ(sizeof(user_conf))
+
+flash_stat_t flash_stat = {0};
+
+static user_conf stored_conf;   // values stored in flash (to find changed fields)
+static int actsect = -1;        // active sector (-1 if storage is empty)
+static uint32_t actseq = 0;     // its sequence number
+static uint32_t freeoff = 0;    // offset of first free record in active sector
+static uint16_t kvidx[KV_NKEYS];// RAM index: offset of last valid record for each key (0 - no record)
+
+static uint16_t crc16(const uint8_t *data, int len, uint16_t crc){
+    while(len--){
+        crc ^= (uint16_t)(*data++) << 8;
+        for(int i = 0; i < 8; ++i)
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+static uint16_t entcrc(const kvent_hdr *h, const uint8_t *data){
+    uint16_t crc = crc16(&h->key, 2, 0xffff);
+    return crc16(data, h->len, crc);
+}
+
+static const kvsect_hdr *secthdr(int n){
+    const kvsect_hdr *h = (const kvsect_hdr*)kv_sector(n);
+    if(h->magic != KV_MAGIC || h->nmagic != ~KV_MAGIC || h->nseq != ~h->seq) return NULL;
+    return h;
+}
+
+// scan active sector and build RAM index
+static void buildindex(){
+    const uint8_t *sect = kv_sector(actsect);
+    uint32_t blocksize = kv_sectsize();
+    memset(kvidx, 0, sizeof(kvidx));
+    uint32_t off = sizeof(kvsect_hdr);
+    while(off + sizeof(kvent_hdr) <= blocksize){
+        const kvent_hdr *h = (const kvent_hdr*)(sect + off);
+        if(*(const uint32_t*)h == 0xffffffff) break; // free space
+        uint32_t sz = KV_ENTSZ(h->len);
+        if(off + sz > blocksize){ // broken header: don't write anything here
+            off = blocksize;
+            break;
+        }
+        if(h->key < KV_NKEYS && h->len == fields[h->key].size && h->crc == entcrc(h, (const uint8_t*)(h + 1)))
+            kvidx[h->key] = (uint16_t)off;
+        off += sz;
+    }
+    freeoff = off;
+}
+
+/**
+ * @brief flashstorage_init - initialization of user conf storage
+ * run in once @ start
+ */
+void flashstorage_init(){
+    const kvsect_hdr *h0 = secthdr(0), *h1 = secthdr(1);
+    actsect = -1;
+    actseq = 0;
+    freeoff = 0;
+    memset(kvidx, 0, sizeof(kvidx));
+    if(h0 && (!h1 || h0->seq > h1->seq)) actsect = 0;
+    else if(h1) actsect = 1;
+    if(actsect > -1){
+        actseq = ((const kvsect_hdr*)kv_sector(actsect))->seq;
+        buildindex();
+        for(uint32_t k = 0; k < KV_NKEYS; ++k){
+            if(!kvidx[k]) continue; // default value
+            const kvent_hdr *e = (const kvent_hdr*)(kv_sector(actsect) + kvidx[k]);
+            memcpy((uint8_t*)&the_conf + fields[k].offset, e + 1, fields[k].size);
+        }
+    }
+    stored_conf = the_conf;
+}
+
+// write record for key `k` with data from `conf` at `off` of sector `n`
+static int writerec(int n, uint32_t off, uint8_t k, const user_conf *conf){
+    uint64_t buf[KV_MAXENT / 8];
+    kvent_hdr *h = (kvent_hdr*)buf;
+    uint32_t sz = KV_ENTSZ(fields[k].size);
+    memset(buf, 0xff, sz);
+    h->key = k;
+    h->len = (uint8_t)fields[k].size;
+    memcpy(h + 1, (const uint8_t*)conf + fields[k].offset, fields[k].size);
+    h->crc = entcrc(h, (const uint8_t*)(h + 1));
+    const uint8_t *addr = kv_sector(n) + off;
+    if(kv_program(addr, buf, sz)) return 1;
+    if(memcmp(addr, buf, sz)) return 1; // verify
+    ++flash_stat.records;
+    flash_stat.bytes += sz;
+    return 0;
+}
+
+// copy all values into other sector and make it active
+static int compact(){
+    int n = (actsect == 0) ? 1 : 0;
+    uint32_t off = sizeof(kvsect_hdr);
+    ++flash_stat.erases;
+    if(kv_erase(n)) return 1;
+    for(uint8_t k = 0; k < KV_NKEYS; ++k){
+        if(writerec(n, off, k, &the_conf)) return 1;
+        off += KV_ENTSZ(fields[k].size);
+    }
+    // commit: write header
+    kvsect_hdr h = {.magic = KV_MAGIC, .seq = actseq + 1, .nseq = ~(actseq + 1), .nmagic = ~KV_MAGIC};
+    if(kv_program(kv_sector(n), &h, sizeof(h))) return 1;
+    actsect = n;
+    actseq = h.seq;
+    buildindex();
+    stored_conf = the_conf;
+    return 0;
+}
+
+// store new configuration (only changed fields)
+// @return 0 if all OK
+int store_userconf(){
+    if(actsect < 0) return compact(); // empty storage: write all
+    uint32_t blocksize = kv_sectsize();
+    for(uint8_t k = 0; k < KV_NKEYS; ++k){
+        uint16_t o = fields[k].offset, sz = fields[k].size;
+        if(kvidx[k] && 0 == memcmp((uint8_t*)&the_conf + o, (uint8_t*)&stored_conf + o, sz)) continue;
+        uint32_t esz = KV_ENTSZ(sz);
+        if(freeoff + esz > blocksize) return compact(); // no more space: compaction will write all changes
+        if(writerec(actsect, freeoff, k, &the_conf)){ // skip bad place and try to write other sector
+            freeoff = blocksize;
+            return compact();
+        }
+        kvidx[k] = (uint16_t)freeoff;
+        freeoff += esz;
+        memcpy((uint8_t*)&stored_conf + o, (uint8_t*)&the_conf + o, sz);
+    }
+    return 0;
+}
+
+int erase_storage(){
+    int ret = kv_erase(0);
+    ret |= kv_erase(1);
+    flash_stat.erases += 2;
+    actsect = -1;
+    actseq = 0;
+    freeoff = 0;
+    memset(kvidx, 0, sizeof(kvidx));
+    return ret;
+}
+
+void kv_info(int *sect, uint32_t *seq, uint32_t *used){
+    *sect = actsect;
+    *seq = actseq;
+    *used = freeoff;
+}
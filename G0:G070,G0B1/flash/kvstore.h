@@ -0,0 +1,31 @@
+/*
+ * This file is part of the flash project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// storage backend: two sectors (pages) programmed by double words; implemented in flash.c
+// (or by host simulator in kvsim/)
+const uint8_t *kv_sector(int n);
+uint32_t kv_sectsize();
+int kv_erase(int n);
+int kv_program(const uint8_t *addr, const void *data, uint32_t len);
+
+// storage state: active sector (-1 if empty), its sequence number and used bytes
+void kv_info(int *sect, uint32_t *seq, uint32_t *used);
@@ -45,6 +45,8 @@ extern volatile uint32_t Tms;
     COMMAND(dumpconf,   "dump current config") \
     COMMAND(eraseflash, "erase full flash storage") \
     COMMAND(help,       "show this help") \
+    COMMAND(jitter,     "servo frames statistics: count, update->ISR latency min/max, ISR time (=0 to clear)") \
+    COMMAND(maxaccel,   "servoN maximal allowed acceleration (mks per 20ms^2, from 1 to " STR(SERVO_MAXACCEL) ", conf)") \
     COMMAND(maxpos,     "servoN maximal allowed position (conf)") \
     COMMAND(maxspeed,   "servoN maximal allowed speed (from 1 to " STR(SERVO_MAXSPEED) ", conf)") \
     COMMAND(mcureset,   "reset MCU") \
@@ -52,9 +54,10 @@ extern volatile uint32_t Tms;
     COMMAND(readconf,   "re-read config from flash") \
     COMMAND(saveconf,   "save config to flash") \
     COMMAND(servo,      "servoN value, mks (in allowed range)") \
-    COMMAND(servopos,   "servoN target position with given speed") \
-    COMMAND(servospeed, "servoN speed, mks per 20ms (1..maxspeed)") \
+    COMMAND(servopos,   "servoN target position (S-curve moving limited by servospeed and maxaccel)") \
+    COMMAND(servospeed, "servoN max moving speed, mks per 20ms (1..maxspeed, 0 - stop)") \
     COMMAND(startpos,   "servoN started position (from " STR(SERVO_MINPULSE) " to " STR(SERVO_MAXPULSE) ", conf)") \
+    COMMAND(syncmove,   "move servos synchronously: syncmove = pos0 pos1 ... (0 - don't move), returns time in 20ms frames") \
     COMMAND(time,       "show current time (ms)") \
     COMMAND(usart_speed,"speed of USART (set after reset, conf)") \
 
@@ -213,6 +216,7 @@ static errcodes_t cmd_dumpconf(const char*, char*){
         SHOWPARU("\nminpos", i, the_conf.minpulse[i]);
         SHOWPARU("\nmaxpos", i, the_conf.maxpulse[i]);
         SHOWPARU("\nmaxspeed", i, the_conf.maxspeed[i]);
+        SHOWPARU("\nmaxaccel", i, the_conf.maxaccel[i]);
     }
     SEND("\n");
     return ERR_AMOUNT;
@@ -266,6 +270,60 @@ static errcodes_t cmd_maxspeed(const char* cmd, char* args){
     return ERR_AMOUNT;
 }
 
+static errcodes_t cmd_maxaccel(const char* cmd, char* args){
+    int32_t val, parno;
+    if(argsvals(args, &parno, &val)){ // setter
+        if(parno < 0 || parno >= SERVO_AMOUNT) return ERR_BADPAR;
+        if(val < 1 || val > SERVO_MAXACCEL) return ERR_BADVAL;
+        the_conf.maxaccel[parno] = (uint16_t) val;
+    }
+    if(parno < 0 || parno >= SERVO_AMOUNT) return ERR_BADPAR;
+    SHOWPARU(cmd, parno, the_conf.maxaccel[parno]);
+    SEND("\n");
+    return ERR_AMOUNT;
+}
+
+static errcodes_t cmd_syncmove(const char* cmd, char* args){
+    char *setter = splitargs(args, NULL);
+    if(!setter) return ERR_BADVAL;
+    uint16_t pos[SERVO_AMOUNT] = {0};
+    for(int i = 0; i < SERVO_AMOUNT; ++i){
+        int32_t I32;
+        char *next = getint(setter, &I32);
+        if(next == setter) break;
+        if(I32 < 0 || I32 > SERVO_MAXPULSE) return ERR_BADVAL;
+        pos[i] = (uint16_t) I32;
+        setter = next;
+    }
+    uint32_t T = servo_syncmove(pos);
+    if(T == 0) return ERR_BADVAL;
+    CMDEQ();
+    SEND(u2str(T));
+    SEND("\n");
+    return ERR_AMOUNT;
+}
+
+static errcodes_t cmd_jitter(const char* cmd, char* args){
+    int32_t val;
+    if(argsvals(args, NULL, &val)){
+        if(val) return ERR_BADVAL;
+        servo_clear_jitter();
+    }
+    servo_jitter_t j;
+    NVIC_DisableIRQ(SERVO_DMAIRQ);
+    j = *(servo_jitter_t*)&servo_jitter;
+    NVIC_EnableIRQ(SERVO_DMAIRQ);
+    CMDEQ();
+    SEND(u2str(j.frames));
+    if(j.frames){
+        SEND(" "); SEND(u2str(j.latmin));
+        SEND(" "); SEND(u2str(j.latmax));
+        SEND(" "); SEND(u2str(j.calcmax));
+    }
+    SEND("\n");
+    return ERR_AMOUNT;
+}
+
 static errcodes_t cmd_help(const char*, char*){
     SEND(REPOURL);
     for(size_t i = 0; i < sizeof(cmdInfo)/sizeof(cmdInfo[0]); i++){
@@ -36,6 +36,7 @@ uint32_t maxCnum = 1024 / sizeof(user_conf); // can't use blocksize here
     ,.minpulse = {SG90_MINPULSE, SG90_MINPULSE, SG90_MINPULSE, SG90_MINPULSE} \
     ,.maxpulse = {SG90_MAXPULSE, SG90_MAXPULSE, SG90_MAXPULSE, SG90_MAXPULSE} \
     ,.maxspeed = {SG90_MAXSPEED, SG90_MAXSPEED, SG90_MAXSPEED, SG90_MAXSPEED} \
+    ,.maxaccel = {SG90_MAXACCEL, SG90_MAXACCEL, SG90_MAXACCEL, SG90_MAXACCEL} \
     }
 
 static int erase_flash(const void*, const void*);
@@ -39,6 +39,7 @@ typedef struct __attribute__((packed, aligned(8))){
     uint16_t minpulse[SERVO_AMOUNT];    // minimal position
     uint16_t maxpulse[SERVO_AMOUNT];    // maximal position
     uint16_t maxspeed[SERVO_AMOUNT];    // maximal speed
+    uint16_t maxaccel[SERVO_AMOUNT];    // maximal acceleration
 } user_conf;
 
 extern user_conf the_conf; // global user config (read from FLASH to RAM)
@@ -29,25 +29,11 @@ void sys_tick_handler(){
     ++Tms;
 }
 
-// try to set servo; if wrong return false
-bool set_servo(uint8_t N, uint16_t val){
-    if(N >= SERVO_AMOUNT) return false;
-    if(val < the_conf.minpulse[N] || val > the_conf.maxpulse[N]) return false;
-    volatile uint32_t *CCR = &(TIM3->CCR1);
-    CCR[N] = val;
-    return true;
-}
-
-bool get_servo(uint8_t N, uint16_t *val){
-    if(N >= SERVO_AMOUNT) return false;
-    volatile uint32_t *CCR = &(TIM3->CCR1);
-    if(val) *val = CCR[N];
-    return true;
-}
-
 static void tim3_setup(){
     RCC->APB1ENR1 |= RCC_APB1ENR1_TIM3EN;
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN | RCC_AHB1ENR_DMAMUX1EN;
     __DSB();
+    servo_init();
     // PWM mode 1 (active -> inactive) on all three channels; preload enabled
     TIM3->CCMR1 =   TIM_CCMR1_OC1M_2 | TIM_CCMR1_OC1M_1 |
                     TIM_CCMR1_OC2M_2 | TIM_CCMR1_OC2M_1 |
@@ -59,11 +45,24 @@ static void tim3_setup(){
     TIM3->PSC = 84; // 1MHz -> 1us per tick
     // ARR for PWM
     TIM3->ARR = 19999; // 20ms, 50Hz
-    // CCRx - minimal position
-    TIM3->CCR1 = the_conf.startpulse[0];
-    TIM3->CCR2 = the_conf.startpulse[1];
-    TIM3->CCR3 = the_conf.startpulse[2];
-    TIM3->CCR4 = the_conf.startpulse[3];
+    // CCRx - starting position
+    TIM3->CCR1 = servo_ccr[0];
+    TIM3->CCR2 = servo_ccr[1];
+    TIM3->CCR3 = servo_ccr[2];
+    TIM3->CCR4 = servo_ccr[3];
+    // DMA burst of 4 transfers (CCR1..CCR4) @ each update event; circular, so after each frame
+    // TIM3 gets values of `servo_ccr` calculated by interpolator in DMA TC interrupt
+    TIM3->DCR = (3 << TIM_DCR_DBL_Pos) | (((uint32_t)&TIM3->CCR1 - (uint32_t)TIM3) >> 2);
+    SERVO_DMACH->CCR = 0;
+    SERVO_DMACH->CPAR = (uint32_t) &TIM3->DMAR;
+    SERVO_DMACH->CMAR = (uint32_t) servo_ccr;
+    SERVO_DMACH->CNDTR = SERVO_AMOUNT;
+    SERVO_DMAMUX->CCR = SERVO_DMAMUXN;
+    // mem->periph, mem++, 32bit, circular, TC irq
+    SERVO_DMACH->CCR = DMA_CCR_DIR | DMA_CCR_MINC | DMA_CCR_PSIZE_1 | DMA_CCR_MSIZE_1 | DMA_CCR_CIRC |
+                       DMA_CCR_TCIE | DMA_CCR_EN;
+    NVIC_EnableIRQ(SERVO_DMAIRQ);
+    TIM3->DIER = TIM_DIER_UDE;
     // enable main output (don't need for TIM3)
     //TIMx->BDTR |= TIM_BDTR_MOE;
     // enable PWM output
@@ -38,5 +38,3 @@ extern volatile uint32_t Tms;
 
 void gpio_setup();
 
-bool set_servo(uint8_t N, uint16_t val);
-bool get_servo(uint8_t N, uint16_t *val);
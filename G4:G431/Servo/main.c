@@ -45,7 +45,6 @@ int main(void){
             const char *ans = parse_cmd(usart_sendstr, str);
             if(ans) usart_sendstr(ans);
         }
-        process_servo();
         if(Tms - Tblink > 499){
             LED_TOGG();
             Tblink = Tms;
@@ -0,0 +1,228 @@
+/*
+ * This file is part of the servo project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host checker of S-curve profiles (../profile.c): random moves from rest and retargeting during move
+// with SG90 ranges of positions, speeds and accelerations. Checked: starting state, exact endpoint with
+// zero velocity and acceleration, velocity and acceleration limits (analytic and by frame differences,
+// also across retargeting), minimality of duration, synchronous moves (duration greater than minimal).
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "hosttest.h"
+#include "profile.h"
+
+// SG90 (../servo.h)
+#define MINPULSE    (400)
+#define MAXPULSE    (2600)
+#define MAXSPEED    (93)
+#define MAXACCEL    (20)
+
+// relative tolerance of limits (float rounding)
+#define LIMTOL      (1e-3)
+
+static double worstv = 0., worsta = 0.; // max ratio of velocity/acceleration to limits
+
+static double rnd(double min, double max){
+    return min + drand48() * (max - min);
+}
+
+static int near(double x, double y, double tol){
+    return fabs(x - y) <= tol * (1. + fabs(y));
+}
+
+/**
+ * @brief runprof - run profile until its end checking limits
+ * @param p - profile (just started)
+ * @param hist - last two positions before start (to check frame differences across retargeting)
+ * @param nmax - max amount of frames to run (0 - up to end)
+ * @param vmax, amax - limits
+ * @return 0 if OK
+ */
+static int runprof(profile_t *p, double hist[2], uint32_t nmax, double vmax, double amax){
+    uint32_t T = p->T;
+    float target = p->target;
+    if(nmax == 0 || nmax > T + 2) nmax = T + 2; // two frames after end: should stay at target
+    for(uint32_t n = 0; n < nmax; ++n){
+        float pos, vel, acc;
+        prof_state(p, &pos, &vel, &acc);
+        double rv = fabs(vel) / vmax, ra = fabs(acc) / amax;
+        if(rv > worstv) worstv = rv;
+        if(ra > worsta) worsta = ra;
+        if(rv > 1. + LIMTOL || ra > 1. + LIMTOL){
+            if(verbose) printf("\tframe %u of %u: v=%g (max %g), a=%g (max %g)\n", n, T, vel, vmax, acc, amax);
+            return 1;
+        }
+        double x = prof_next(p);
+        // frame differences: mean velocity and acceleration
+        double dv = x - hist[1], da = x - 2. * hist[1] + hist[0];
+        if(fabs(dv) > vmax * (1. + LIMTOL) + 1e-3 || fabs(da) > amax * (1. + LIMTOL) + 1e-3){
+            if(verbose) printf("\tframe %u of %u: dx=%g, ddx=%g\n", n, T, dv, da);
+            return 1;
+        }
+        hist[0] = hist[1];
+        hist[1] = x;
+        if(n + 1 >= T && (x != target || p->T != 0)){
+            if(verbose) printf("\tframe %u of %u: x=%g instead of %g\n", n, T, x, target);
+            return 1;
+        }
+    }
+    if(nmax == T + 2){
+        float pos, vel, acc;
+        prof_state(p, &pos, &vel, &acc);
+        if(pos != target || vel != 0.f || acc != 0.f) return 1;
+    }
+    return 0;
+}
+
+// duration for move from rest (max velocity is 1.875*D/T, max acceleration is 5.7735*D/T^2)
+static double resttime(double D, double vmax, double amax){
+    double T = 1.875 * D / vmax, Ta = sqrt(5.7735 * D / amax);
+    return (Ta > T) ? Ta : T;
+}
+
+static int chkrest(){
+    int bad = 0;
+    for(int i = 0; i < 20000 && !bad; ++i){
+        double p0 = (int)rnd(MINPULSE, MAXPULSE), p1 = (int)rnd(MINPULSE, MAXPULSE);
+        double vmax = (int)rnd(1, MAXSPEED + 1), amax = (int)rnd(1, MAXACCEL + 1);
+        float a0 = 0.f;
+        uint32_t T = prof_mintime(p0, 0.f, &a0, p1, vmax, amax, 0);
+        double Tr = resttime(fabs(p1 - p0), vmax, amax);
+        if(T < Tr - 1e-3 || T > ceil(Tr) + 1 || T < 1){
+            if(verbose) printf("\tmove %g->%g (vmax=%g, amax=%g): T=%u, should be %g\n", p0, p1, vmax, amax, T, Tr);
+            bad = 1;
+            break;
+        }
+        profile_t p;
+        prof_start(&p, p0, 0.f, 0.f, p1, T);
+        float pos, vel, acc;
+        prof_state(&p, &pos, &vel, &acc);
+        bad |= pos != (float)p0 || vel != 0.f || acc != 0.f;
+        double hist[2] = {p0, p0};
+        bad |= runprof(&p, hist, 0, vmax, amax);
+        // longer duration (synchronous move) also keeps limits
+        uint32_t Tmin = T + lrand48() % (3 * T + 1);
+        T = prof_mintime(p0, 0.f, &a0, p1, vmax, amax, Tmin);
+        bad |= T != Tmin || a0 != 0.f;
+        prof_start(&p, p0, 0.f, 0.f, p1, T);
+        hist[0] = hist[1] = p0;
+        bad |= runprof(&p, hist, 0, vmax, amax);
+        if(bad && verbose) printf("\tmove %g->%g (vmax=%g, amax=%g), T=%u\n", p0, p1, vmax, amax, T);
+    }
+    return chkfail("moves from rest", bad);
+}
+
+// retargeting during move: new profile starts from current state, limits are kept across switching;
+// velocity limit could be decreased during move and duration could be greater than minimal (synchronous move)
+static int chkretarget(){
+    int bad = 0, nzeroed = 0, nretarg = 0;
+    for(int i = 0; i < 20000 && !bad; ++i){
+        double amax = (int)rnd(1, MAXACCEL + 1);
+        double x = (int)rnd(MINPULSE, MAXPULSE), hist[2] = {x, x};
+        profile_t p;
+        memset(&p, 0, sizeof(p));
+        p.p0 = x;
+        for(int k = 0; k < 5 && !bad; ++k){ // some retargetings
+            float pos, vel, acc;
+            prof_state(&p, &pos, &vel, &acc);
+            double p1 = (int)rnd(MINPULSE, MAXPULSE), vmax = (int)rnd(1, MAXSPEED + 1);
+            uint32_t Tmin = (lrand48() & 1) ? 0 : lrand48() % 300;
+            float a0 = acc;
+            uint32_t T = prof_mintime(pos, vel, &a0, p1, vmax, amax, Tmin);
+            if(T < Tmin || T == PROF_MAXT || (a0 != acc && a0 != 0.f)){
+                if(verbose) printf("\tT=%u (Tmin=%u), a0=%g\n", T, Tmin, a0);
+                bad = 1;
+            }
+            ++nretarg;
+            if(a0 != acc) ++nzeroed;
+            prof_start(&p, pos, vel, a0, p1, T);
+            float pos1, vel1, acc1;
+            prof_state(&p, &pos1, &vel1, &acc1);
+            if(!near(pos1, pos, 1e-6) || !near(vel1, vel, 1e-4) || !near(acc1, a0, 1e-4)){
+                if(verbose) printf("\tstart state (%g, %g, %g) instead of (%g, %g, %g)\n", pos1, vel1, acc1, pos, vel, a0);
+                bad = 1;
+            }
+            uint32_t n = (k == 4) ? 0 : 1 + lrand48() % T;
+            bad |= runprof(&p, hist, n, (fabs(vel) > vmax) ? fabs(vel) : vmax, amax);
+            if(bad && verbose) printf("\tretarget %d to %g (vmax=%g, amax=%g): T=%u\n", k, p1, vmax, amax, T);
+        }
+    }
+    if(verbose) printf("\tacceleration was zeroed in %d of %d retargetings\n", nzeroed, nretarg);
+    return chkfail("retargeting", bad);
+}
+
+static int chkbounds(){
+    int bad = 0;
+    profile_t p;
+    // zero distance: one frame
+    float a0 = 0.f;
+    uint32_t T = prof_mintime(1500.f, 0.f, &a0, 1500.f, 10.f, 10.f, 0);
+    prof_start(&p, 1500.f, 0.f, 0.f, 1500.f, T);
+    bad |= T != 1 || prof_next(&p) != 1500.f || p.T != 0;
+    // too slow: max duration
+    bad |= prof_mintime(400.f, 0.f, &a0, 2600.f, 0.01f, 1.f, 0) != PROF_MAXT;
+    // inactive profile keeps position
+    prof_start(&p, 700.f, 0.f, 0.f, 900.f, 0);
+    bad |= p.T != 1 || prof_next(&p) != 900.f || prof_next(&p) != 900.f;
+    return chkfail("bounds", bad);
+}
+
+static double dtime(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+// host timing of calculations (relative cost of ISR part and of planning under LOCK)
+static void timing(){
+    profile_t p;
+    float a0 = 0.f;
+    prof_start(&p, 400.f, 0.f, 0.f, 2600.f, PROF_MAXT);
+    volatile float x = 0.f;
+    double t0 = dtime();
+    for(int i = 0; i < 1000000; ++i){
+        x += prof_next(&p);
+        if(p.T == 0) prof_start(&p, 400.f, 0.f, 0.f, 2600.f, PROF_MAXT);
+    }
+    double tnext = (dtime() - t0) * 1e3, tsum = 0.;
+    for(int i = 0; i < 100000; ++i){
+        float p0 = rnd(MINPULSE, MAXPULSE), v0 = rnd(-MAXSPEED, MAXSPEED), acc = rnd(-MAXACCEL, MAXACCEL);
+        a0 = acc;
+        t0 = dtime();
+        prof_mintime(p0, v0, &a0, rnd(MINPULSE, MAXPULSE), rnd(1, MAXSPEED), rnd(1, MAXACCEL), 0);
+        tsum += (dtime() - t0) * 1e6;
+    }
+    printf("\thost timing: prof_next %.1fns, prof_mintime %.2fus\n", tnext, tsum / 1e5);
+}
+
+int main(int argc, char **argv){
+    hosttest_opts(argc, argv);
+    int ret = chkrest();
+    if(verbose) printf("\tmax ratio to limits: velocity %.4f, acceleration %.4f\n", worstv, worsta);
+    worstv = worsta = 0.;
+    ret |= chkretarget();
+    if(verbose) printf("\tmax ratio to limits: velocity %.4f, acceleration %.4f\n", worstv, worsta);
+    ret |= chkbounds();
+    if(verbose) timing();
+    return hosttest_result(ret);
+}
@@ -0,0 +1,180 @@
+/*
+ * This file is part of the servo project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stddef.h>
+
+#include "profile.h"
+
+// values of quintic and its derivatives by u
+static void poly(const profile_t *p, float u, float *x, float *dx, float *ddx){
+    if(x) *x = p->p0 + u*(p->V + u*(p->A2 + u*(p->c3 + u*(p->c4 + u*p->c5))));
+    if(dx) *dx = p->V + u*(2.f*p->A2 + u*(3.f*p->c3 + u*(4.f*p->c4 + u*5.f*p->c5)));
+    if(ddx) *ddx = 2.f*p->A2 + u*(6.f*p->c3 + u*(12.f*p->c4 + u*20.f*p->c5));
+}
+
+/**
+ * @brief prof_state - get current position, velocity and acceleration
+ * @param p - profile
+ * @param pos, vel, acc (o) - state (in us, us/frame, us/frame^2), could be NULL
+ */
+void prof_state(const profile_t *p, float *pos, float *vel, float *acc){
+    if(p->T == 0 || p->n >= p->T){
+        if(pos) *pos = (p->T == 0) ? p->p0 : p->target;
+        if(vel) *vel = 0.f;
+        if(acc) *acc = 0.f;
+        return;
+    }
+    float T = (float)p->T, dx, ddx;
+    poly(p, (float)p->n / T, pos, &dx, &ddx);
+    if(vel) *vel = dx / T;
+    if(acc) *acc = ddx / (T*T);
+}
+
+// set coefficients for given T
+static void coefs(profile_t *p, float p0, float v0, float a0, float p1, uint32_t T){
+    float Tf = (float)T, D = p1 - p0, V = v0 * Tf, A = a0 * Tf * Tf;
+    p->p0 = p0; p->V = V; p->A2 = A / 2.f;
+    p->c3 = 10.f*D - 6.f*V - 1.5f*A;
+    p->c4 = -15.f*D + 8.f*V + 1.5f*A;
+    p->c5 = 6.f*D - 3.f*V - 0.5f*A;
+    p->target = p1;
+    p->n = 0;
+    p->T = T;
+}
+
+// relative tolerance of limits (float rounding)
+#define PROF_TOL    (1e-4f)
+
+// add root `r` of jerk into list if it is inside (0, 1)
+static void addroot(float *u, int *n, float r){
+    if(r > 0.f && r < 1.f) u[(*n)++] = r;
+}
+
+// max velocity/acceleration ratio to limits: acceleration extrema are at ends and roots of jerk (quadratic),
+// acceleration is monotonic between them, so velocity extrema (roots of acceleration) are found by bisection
+static float peakratio(const profile_t *p, float vmax, float amax){
+    float T = (float)p->T, r = 0.f, u[4];
+    float a = 60.f*p->c5, b = 24.f*p->c4, c = 6.f*p->c3;
+    int n = 1;
+    u[0] = 0.f;
+    if(fabsf(a) > 1e-6f * (fabsf(b) + fabsf(c))){
+        float d = b*b - 4.f*a*c;
+        if(d > 0.f){
+            d = sqrtf(d);
+            float r1 = (-b - d) / (2.f*a), r2 = (-b + d) / (2.f*a);
+            if(r1 > r2){ float t = r1; r1 = r2; r2 = t; }
+            addroot(u, &n, r1);
+            addroot(u, &n, r2);
+        }
+    }else if(b != 0.f) addroot(u, &n, -c / b);
+    u[n++] = 1.f;
+    float ddx[4];
+    for(int i = 0; i < n; ++i){
+        float dx;
+        poly(p, u[i], NULL, &dx, &ddx[i]);
+        float rv = fabsf(dx) / T / vmax, ra = sqrtf(fabsf(ddx[i]) / amax) / T;
+        if(rv > r) r = rv;
+        if(ra > r) r = ra;
+    }
+    for(int i = 0; i < n - 1; ++i){
+        if((ddx[i] < 0.f) == (ddx[i+1] < 0.f)) continue;
+        float lo = u[i], hi = u[i+1], dx;
+        for(int j = 0; j < 24; ++j){
+            float mid = (lo + hi) / 2.f, dd;
+            poly(p, mid, NULL, NULL, &dd);
+            if((dd < 0.f) == (ddx[i] < 0.f)) lo = mid;
+            else hi = mid;
+        }
+        poly(p, (lo + hi) / 2.f, NULL, &dx, NULL);
+        float rv = fabsf(dx) / T / vmax;
+        if(rv > r) r = rv;
+    }
+    return r;
+}
+
+// find duration >= T for which limits are satisfied; @return 0 if not found in `niter` iterations
+static uint32_t search(float p0, float v0, float a0, float p1, float vmax, float amax, float T, int niter){
+    profile_t p;
+    for(int i = 0; i < niter; ++i){
+        if(T < 1.f) T = 1.f;
+        if(T > (float)PROF_MAXT) return 0;
+        coefs(&p, p0, v0, a0, p1, (uint32_t)ceilf(T));
+        float r = peakratio(&p, vmax, amax);
+        if(r <= 1.f + PROF_TOL) return p.T;
+        T = (float)p.T * (r > 1.05f ? r : 1.05f);
+    }
+    return 0;
+}
+
+/**
+ * @brief prof_mintime - calculate minimal duration of profile
+ * Acceleration `a0` can't always be kept: e.g. near max speed it leads to overspeed for any duration;
+ * in that case profile starts with zero acceleration (the jump is less than limit).
+ * If |v0| > vmax (limit was decreased during moving), velocity is limited by |v0|.
+ * @param p0, v0 - starting position and velocity
+ * @param a0 (io) - starting acceleration, could be replaced by 0
+ * @param p1 - target
+ * @param vmax, amax - limits (should be > 0)
+ * @param Tmin - minimal duration (e.g. for synchronous moving)
+ * @return duration in frames (max(1, Tmin)..PROF_MAXT)
+ */
+uint32_t prof_mintime(float p0, float v0, float *a0, float p1, float vmax, float amax, uint32_t Tmin){
+    float D = fabsf(p1 - p0);
+    if(fabsf(v0) > vmax) vmax = fabsf(v0);
+    // for v0 = a0 = 0: max velocity is 1.875*D/T, max acceleration is 5.7735*D/T^2
+    float T = 1.875f * D / vmax, Ta = sqrtf(5.7735f * D / amax);
+    if(Ta > T) T = Ta;
+    if(T < (float)Tmin) T = (float)Tmin;
+    uint32_t t = 0;
+    if(*a0 != 0.f) t = search(p0, v0, *a0, p1, vmax, amax, T, 16);
+    if(t == 0){
+        *a0 = 0.f;
+        t = search(p0, v0, 0.f, p1, vmax, amax, T, 256);
+    }
+    return t ? t : PROF_MAXT;
+}
+
+/**
+ * @brief prof_start - start new profile
+ * @param p - profile
+ * @param p0, v0, a0 - current state
+ * @param p1 - target
+ * @param T - duration (frames)
+ */
+void prof_start(profile_t *p, float p0, float v0, float a0, float p1, uint32_t T){
+    if(T < 1) T = 1;
+    coefs(p, p0, v0, a0, p1, T);
+}
+
+/**
+ * @brief prof_next - go to next frame
+ * @param p - profile
+ * @return new position
+ */
+float prof_next(profile_t *p){
+    if(p->T == 0) return p->p0;
+    if(++p->n >= p->T){
+        p->p0 = p->target;
+        p->T = 0;
+        return p->target;
+    }
+    float x;
+    poly(p, (float)p->n / (float)p->T, &x, NULL, NULL);
+    return x;
+}
@@ -0,0 +1,44 @@
+/*
+ * This file is part of the servo project.
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Minimum-jerk (quintic) profile from current state (position, velocity, acceleration)
+ * to target position with zero velocity and acceleration. All values are in pulse units
+ * (us) and servo frames (20ms): velocity in us/frame, acceleration in us/frame^2.
+ * Pure math without hardware, so it can be checked on host.
+ */
+
+typedef struct{
+    float p0, V, A2;        // p(u) = p0 + V*u + A2*u^2 + c3*u^3 + c4*u^4 + c5*u^5, u = n/T
+    float c3, c4, c5;
+    float target;           // final position
+    uint32_t n;             // current frame
+    uint32_t T;             // duration (frames), 0 - profile is inactive
+} profile_t;
+
+// max duration of profile (frames)
+#define PROF_MAXT       (65535)
+
+void prof_state(const profile_t *p, float *pos, float *vel, float *acc);
+uint32_t prof_mintime(float p0, float v0, float *a0, float p1, float vmax, float amax, uint32_t Tmin);
+void prof_start(profile_t *p, float p0, float v0, float a0, float p1, uint32_t T);
+float prof_next(profile_t *p);
@@ -21,46 +21,103 @@
 
 #include "flash.h"
 #include "hardware.h"
+#include "profile.h"
 #include "servo.h"
 
+// values for TIM3->CCRx, they are sent by DMA burst @ each update event
+volatile uint32_t servo_ccr[SERVO_AMOUNT];
+// frames' statistics
+volatile servo_jitter_t servo_jitter = {.latmin = 0xffffffff};
+
 static uint16_t servo_tagpos[SERVO_AMOUNT] = {SG90_MIDPULSE, SG90_MIDPULSE, SG90_MIDPULSE, SG90_MIDPULSE};
 static uint16_t servo_speed[SERVO_AMOUNT] = {0, 0, 0, 0};
+static profile_t prof[SERVO_AMOUNT];
+
+// profiles are changed by ISR, so block it when modify them
+#define LOCK()      NVIC_DisableIRQ(SERVO_DMAIRQ)
+#define UNLOCK()    NVIC_EnableIRQ(SERVO_DMAIRQ)
 
-void process_servo(){
-    static bool notinited = true;
-#if SERVO_AMOUNT != 4
-#error "Add timers' variables"
-#endif
-    static const uint32_t trgflags[SERVO_AMOUNT] = {TIM_SR_CC1IF, TIM_SR_CC2IF, TIM_SR_CC3IF, TIM_SR_CC4IF};
-    if(notinited){ // init tagpos with starting values from settings at first run
-        for(int i = 0; i < SERVO_AMOUNT; ++i) servo_tagpos[i] = the_conf.startpulse[i];
-        notinited = false;
+// init positions by starting values (run before TIM3 DMA setup)
+void servo_init(){
+    for(int i = 0; i < SERVO_AMOUNT; ++i){
+        servo_tagpos[i] = the_conf.startpulse[i];
+        servo_ccr[i] = the_conf.startpulse[i];
+        prof[i].p0 = (float)the_conf.startpulse[i];
+        prof[i].T = 0;
     }
-    uint32_t sr = TIM3->SR;
-    uint32_t clear_mask = 0;
-    for(uint8_t i = 0; i < SERVO_AMOUNT; ++i){
-        uint16_t curpos;
-        if(!get_servo(i, &curpos) || !(sr & trgflags[i])) continue;
-        clear_mask |= trgflags[i];
-        if(servo_tagpos[i] == curpos || servo_speed[i] < 1) continue;
-        int32_t newpos = curpos;
-        if(servo_tagpos[i] > curpos){
-            newpos += servo_speed[i];
-            if(newpos > servo_tagpos[i]) newpos = servo_tagpos[i];
-        }else{
-            newpos -= servo_speed[i];
-            if(newpos < servo_tagpos[i]) newpos = servo_tagpos[i];
-        }
-        set_servo(i, (uint16_t) newpos);
+}
+
+// DMA burst to CCR1..4 done: calculate values for next frame
+void dma1_channel3_isr(){
+    uint32_t t0 = TIM3->CNT; // us from update event
+    DMA1->IFCR = DMA_IFCR_CGIF3;
+    for(int i = 0; i < SERVO_AMOUNT; ++i){
+        if(prof[i].T == 0) continue;
+        float x = prof_next(&prof[i]);
+        if(x < the_conf.minpulse[i]) x = the_conf.minpulse[i];
+        else if(x > the_conf.maxpulse[i]) x = the_conf.maxpulse[i];
+        servo_ccr[i] = (uint32_t)(x + 0.5f);
     }
-    if(clear_mask) TIM3->SR &= ~clear_mask;
+    uint32_t t1 = TIM3->CNT;
+    ++servo_jitter.frames;
+    if(t0 < servo_jitter.latmin) servo_jitter.latmin = t0;
+    if(t0 > servo_jitter.latmax) servo_jitter.latmax = t0;
+    if(t1 - t0 > servo_jitter.calcmax) servo_jitter.calcmax = t1 - t0;
+}
+
+void servo_clear_jitter(){
+    LOCK();
+    servo_jitter.frames = 0;
+    servo_jitter.latmin = 0xffffffff;
+    servo_jitter.latmax = 0;
+    servo_jitter.calcmax = 0;
+    UNLOCK();
 }
 
-// set speed in steps per tick
+// try to set servo (stop moving); if wrong return false
+bool set_servo(uint8_t N, uint16_t val){
+    if(N >= SERVO_AMOUNT) return false;
+    if(val < the_conf.minpulse[N] || val > the_conf.maxpulse[N]) return false;
+    LOCK();
+    prof[N].T = 0;
+    prof[N].p0 = (float)val;
+    servo_ccr[N] = val;
+    servo_tagpos[N] = val;
+    UNLOCK();
+    return true;
+}
+
+bool get_servo(uint8_t N, uint16_t *val){
+    if(N >= SERVO_AMOUNT) return false;
+    if(val) *val = (uint16_t)servo_ccr[N];
+    return true;
+}
+
+// duration (>= Tmin) of move to `servo_tagpos` from state x, v, a (`a` could be zeroed)
+static uint32_t movetime(uint8_t N, float x, float v, float *a, uint32_t Tmin){
+    return prof_mintime(x, v, a, (float)servo_tagpos[N], (float)servo_speed[N], (float)the_conf.maxaccel[N], Tmin);
+}
+
+// start moving to `servo_tagpos` (call only under LOCK)
+static void startmove(uint8_t N){
+    if(servo_speed[N] < 1) return;
+    float x, v, a;
+    prof_state(&prof[N], &x, &v, &a);
+    uint32_t T = movetime(N, x, v, &a, 1);
+    prof_start(&prof[N], x, v, a, (float)servo_tagpos[N], T);
+}
+
+// set max speed in steps per tick (0 - stop moving)
 bool servo_set_speed(uint8_t N, uint16_t s){
     if(N >= SERVO_AMOUNT) return false;
     if(s > the_conf.maxspeed[N]) return false; // let s==0: this will allow to stop mowing to tagpos
+    LOCK();
     servo_speed[N] = s;
+    if(s == 0){ // freeze at current position
+        prof[N].p0 = (float)servo_ccr[N];
+        prof[N].T = 0;
+    }else if(prof[N].T == 0 && (uint16_t)servo_ccr[N] != servo_tagpos[N]) startmove(N);
+    UNLOCK();
     return true;
 }
 
@@ -73,7 +130,10 @@ bool servo_get_speed(uint8_t N, uint16_t *s){
 bool servo_set_tagpos(uint8_t N, uint16_t pos){
     if(N >= SERVO_AMOUNT) return false;
     if(pos < the_conf.minpulse[N] || pos > the_conf.maxpulse[N]) return false;
+    LOCK();
     servo_tagpos[N] = pos;
+    startmove(N);
+    UNLOCK();
     return true;
 }
 
@@ -82,3 +142,41 @@ bool servo_get_tagpos(uint8_t N, uint16_t *pos){
     if(pos) *pos = servo_tagpos[N];
     return true;
 }
+
+/**
+ * @brief servo_syncmove - move servos to given positions so that they all stop at the same time
+ * @param pos - target positions (0 - don't move this servo)
+ * @return duration of moving (frames) or 0 if some positions are wrong or speed is zero
+ */
+uint32_t servo_syncmove(const uint16_t pos[SERVO_AMOUNT]){
+    for(int i = 0; i < SERVO_AMOUNT; ++i){
+        if(pos[i] == 0) continue;
+        if(pos[i] < the_conf.minpulse[i] || pos[i] > the_conf.maxpulse[i] || servo_speed[i] < 1) return 0;
+    }
+    float x[SERVO_AMOUNT], v[SERVO_AMOUNT], a[SERVO_AMOUNT];
+    uint32_t T = 0;
+    LOCK();
+    for(int i = 0; i < SERVO_AMOUNT; ++i){
+        if(pos[i] == 0) continue;
+        servo_tagpos[i] = pos[i];
+        prof_state(&prof[i], &x[i], &v[i], &a[i]);
+        uint32_t t = movetime(i, x[i], v[i], &a[i], 1);
+        if(t > T) T = t;
+    }
+    // longer duration could break limits of moving servos: increase T until it suits all
+    for(int pass = 0; pass < 16; ++pass){
+        uint32_t Tn = T;
+        for(int i = 0; i < SERVO_AMOUNT; ++i){
+            if(pos[i] == 0) continue;
+            uint32_t t = movetime(i, x[i], v[i], &a[i], Tn);
+            if(t > Tn) Tn = t;
+        }
+        if(Tn == T) break;
+        T = Tn;
+    }
+    for(int i = 0; i < SERVO_AMOUNT; ++i){
+        if(pos[i]) prof_start(&prof[i], x[i], v[i], a[i], (float)pos[i], T);
+    }
+    UNLOCK();
+    return T;
+}
@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include "hardware.h"
+
 // Default starting values
 // minimal and maximal pulse length for SG90
 #define SG90_MINPULSE   400
@@ -26,13 +28,38 @@
 #define SG90_AMPL       (SG90_MAXPULSE-SG90_MINPULSE)
 // maximal speed: 0.1s (5 ticks) per 60degr (1/3 of range):  (SG90_AMPL/15)
 #define SG90_MAXSPEED   93
+// maximal acceleration: full speed after 5 ticks
+#define SG90_MAXACCEL   20
 
 // Limiting values
 #define SERVO_MINPULSE  100
 #define SERVO_MAXPULSE  5000
 #define SERVO_MAXSPEED  300
+#define SERVO_MAXACCEL  300
+
+// DMA channel for TIM3 burst: DMA1_Channel3 (DMAMUX1_Channel2), request TIM3_UP
+#define SERVO_DMACH     DMA1_Channel3
+#define SERVO_DMAMUX    DMAMUX1_Channel2
+#define SERVO_DMAMUXN   (65)
+#define SERVO_DMAIRQ    DMA1_Channel3_IRQn
+
+// statistics of servo frames: `latmin`/`latmax` - time from update event to
+// interpolator start (DMA burst + IRQ latency), `calcmax` - max interpolator time; all in us
+typedef struct{
+    uint32_t frames;
+    uint32_t latmin;
+    uint32_t latmax;
+    uint32_t calcmax;
+} servo_jitter_t;
+
+extern volatile uint32_t servo_ccr[SERVO_AMOUNT];
+extern volatile servo_jitter_t servo_jitter;
 
-void process_servo();
+void servo_init();
+void servo_clear_jitter();
+bool set_servo(uint8_t N, uint16_t val);
+bool get_servo(uint8_t N, uint16_t *val);
+uint32_t servo_syncmove(const uint16_t pos[SERVO_AMOUNT]);
 bool servo_set_speed(uint8_t N, uint16_t s);
 bool servo_get_speed(uint8_t N, uint16_t *s);
 bool servo_set_tagpos(uint8_t N, uint16_t pos);
@@ -0,0 +1,181 @@
+/*
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "flashlog.h"
+
+static flashlog_cfg cfg;
+static uint8_t logok = 0;                   // log is configured
+static uint32_t recperpage = 0;
+static uint32_t headpage = 0;               // current page number
+static uint32_t seq = 0;                    // next record number
+static uint8_t pagebuf[FLASHLOG_MAXPAGE] __attribute__((aligned(8))); // RAM copy of current page
+static uint32_t nbuf = 0;                   // records in `pagebuf`
+static uint32_t nflashed = 0;               // records of `pagebuf` already stored
+static uint8_t neederase = 0;               // head page should be erased before writing
+// statistics
+static uint32_t lost = 0, erases = 0, writes = 0;
+
+#define PAGE(n)     (cfg.area + (n) * cfg.pagesz)
+#define REC(p, i)   ((const flashlog_hdr*)((p) + (i) * cfg.recsz))
+
+// amount of records in page `n`
+static uint32_t pagerecs(uint32_t n){
+    const uint8_t *p = PAGE(n);
+    uint32_t i = 0;
+    while(i < recperpage && REC(p, i)->seq != FLASHLOG_EMPTY) ++i;
+    return i;
+}
+
+// erase head page if need; @return 0 if OK
+static int erasehead(){
+    if(!neederase) return 0;
+    ++erases;
+    if(flashlog_erasepage(PAGE(headpage))) return 1;
+    neederase = 0;
+    return 0;
+}
+
+// go to next page and erase it if need; @return 0 if OK
+static int nextpage(){
+    if(++headpage == cfg.npages) headpage = 0;
+    nbuf = nflashed = 0;
+    neederase = (REC(PAGE(headpage), 0)->seq != FLASHLOG_EMPTY);
+    return erasehead();
+}
+
+// write all unsaved records of `pagebuf`; @return 0 if OK
+static int writebuf(){
+    if(nflashed == nbuf) return 0;
+    ++writes;
+    uint32_t off = nflashed * cfg.recsz;
+    int r = flashlog_program(PAGE(headpage) + off, pagebuf + off, (nbuf - nflashed) * cfg.recsz);
+    if(r) return r;
+    nflashed = nbuf;
+    return 0;
+}
+
+/**
+ * @brief flashlog_init - find head of log, run once @ start
+ * @param c - log configuration
+ * @return 0 if OK, 1 if configuration is wrong
+ */
+int flashlog_init(const flashlog_cfg *c){
+    logok = 0;
+    if(!c->area || c->npages < 2 || c->pagesz > FLASHLOG_MAXPAGE || (c->recsz & 7)
+       || c->recsz <= sizeof(flashlog_hdr) || c->recsz > c->pagesz) return 1;
+    cfg = *c;
+    recperpage = cfg.pagesz / cfg.recsz;
+    headpage = 0; seq = 0;
+    uint8_t found = 0;
+    for(uint32_t i = 0; i < cfg.npages; ++i){
+        uint32_t s = REC(PAGE(i), 0)->seq;
+        if(s == FLASHLOG_EMPTY) continue;
+        if(!found || s > REC(PAGE(headpage), 0)->seq){
+            headpage = i;
+            found = 1;
+        }
+    }
+    nbuf = nflashed = 0;
+    neederase = 0;
+    logok = 1;
+    if(found){
+        nbuf = nflashed = pagerecs(headpage);
+        seq = REC(PAGE(headpage), nbuf - 1)->seq + 1;
+        if(nbuf == recperpage) nextpage(); // power was lost before next page erasing
+    }
+    return 0;
+}
+
+/**
+ * @brief flashlog_flush - write RAM buffer into flash
+ * @return 0 if all OK, 1 if can't write now or error
+ */
+int flashlog_flush(){
+    if(!logok || flashlog_busy()) return 1;
+    if(erasehead() || writebuf()) return 1;
+    if(nbuf == recperpage) return nextpage();
+    return 0;
+}
+
+/**
+ * @brief flashlog_put - add new record to log
+ * @param T - timestamp
+ * @param data - payload
+ * @param len - its length (<= recsz - sizeof(flashlog_hdr))
+ * @return 0 if all OK
+ */
+int flashlog_put(uint32_t T, const void *data, uint32_t len){
+    if(!logok || len > cfg.recsz - sizeof(flashlog_hdr)) return 1;
+    if(nbuf == recperpage && flashlog_flush()){ // buffer is full and can't be stored
+        ++lost;
+        return 1;
+    }
+    uint8_t *r = pagebuf + nbuf++ * cfg.recsz;
+    flashlog_hdr h = {.seq = seq++, .T = T};
+    memcpy(r, &h, sizeof(h));
+    memcpy(r + sizeof(h), data, len);
+    memset(r + sizeof(h) + len, 0, cfg.recsz - sizeof(h) - len);
+    if(nbuf == recperpage) flashlog_flush();
+    return 0;
+}
+
+// erase full log; @return 0 if all OK
+int flashlog_erase(){
+    if(!logok || flashlog_busy()) return 1;
+    for(uint32_t i = 0; i < cfg.npages; ++i){
+        if(REC(PAGE(i), 0)->seq == FLASHLOG_EMPTY) continue;
+        ++erases;
+        if(flashlog_erasepage(PAGE(i))) return 1;
+    }
+    headpage = 0; seq = 0;
+    nbuf = nflashed = 0;
+    neederase = 0;
+    return 0;
+}
+
+void flashlog_getstat(flashlog_stat *s){
+    s->capacity = logok ? cfg.npages * recperpage : 0;
+    s->headpage = headpage;
+    s->seq = seq;
+    s->pending = nbuf - nflashed;
+    s->lost = lost;
+    s->erases = erases;
+    s->writes = writes;
+}
+
+/**
+ * @brief flashlog_dump - send all records (oldest first) including records in RAM buffer
+ * @param send - function to send records (NULL to count only)
+ * @return amount of records
+ */
+uint32_t flashlog_dump(void (*send)(const uint8_t *buf, uint32_t len)){
+    if(!logok) return 0;
+    uint32_t total = 0, p = headpage;
+    for(uint32_t i = 0; i < cfg.npages; ++i){ // from page after head to head
+        if(++p == cfg.npages) p = 0;
+        uint32_t n = (p == headpage) ? nflashed : pagerecs(p); // head page could be not erased yet
+        if(n && send) send(PAGE(p), n * cfg.recsz);
+        total += n;
+    }
+    if(nbuf > nflashed){
+        if(send) send(pagebuf + nflashed * cfg.recsz, (nbuf - nflashed) * cfg.recsz);
+        total += nbuf - nflashed;
+    }
+    return total;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Ring log of timestamped records in `npages` flash pages.
+ * Records have fixed size `recsz` (multiple of 8): header (seq, T) + payload, the rest of record is zeroed;
+ * page contains pagesz/recsz records. Records are collected in RAM buffer of page size; buffer is written
+ * into flash when the page is full or by flashlog_flush().
+ * Empty cell have seq == FLASHLOG_EMPTY; head page is the page with max `seq` of first record;
+ * next (oldest) page is erased as soon as head page is full, so head page contains only new records.
+ * Flash access is made by functions of project (see "backend" below).
+ */
+
+// max page size (size of RAM buffer)
+#define FLASHLOG_MAXPAGE    (2048)
+// seq of empty cell
+#define FLASHLOG_EMPTY      (0xffffffff)
+// size of record for payload of `sz` bytes
+#define FLASHLOG_RECSZ(sz)  ((sizeof(flashlog_hdr) + (sz) + 7) & ~7)
+
+// record header, payload follows
+typedef struct{
+    uint32_t seq;       // record number from log start
+    uint32_t T;         // timestamp
+} flashlog_hdr;
+
+typedef struct{
+    const uint8_t *area;    // start of log (page-aligned)
+    uint32_t npages;        // amount of pages (>= 2)
+    uint32_t pagesz;        // page size (<= FLASHLOG_MAXPAGE)
+    uint32_t recsz;         // record size (multiple of 8, <= pagesz)
+} flashlog_cfg;
+
+typedef struct{
+    uint32_t capacity;      // max amount of records in flash
+    uint32_t headpage;      // current page number
+    uint32_t seq;           // number of next record
+    uint32_t pending;       // records in RAM buffer
+    uint32_t lost;          // records lost when buffer was full and flash was busy
+    uint32_t erases;        // page erasings
+    uint32_t writes;        // flash writings
+} flashlog_stat;
+
+// backend: program erased flash, erase page, check if flash can't be touched now; return 0 if OK
+int flashlog_program(const uint8_t *addr, const void *data, uint32_t len);
+int flashlog_erasepage(const uint8_t *page);
+int flashlog_busy();
+
+int flashlog_init(const flashlog_cfg *c);
+int flashlog_put(uint32_t T, const void *data, uint32_t len);
+int flashlog_flush();
+int flashlog_erase();
+void flashlog_getstat(flashlog_stat *s);
+uint32_t flashlog_dump(void (*send)(const uint8_t *buf, uint32_t len));
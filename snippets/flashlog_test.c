@@ -0,0 +1,312 @@
+/*
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host checker of flashlog.c on simulated flash (only erased halfword can be programmed):
+// record format for different record sizes, wrap-around with random flushes and reboots,
+// busy flash (lost records), failed erasing, wear of pages.
+// gcc -O2 -Wall -Wextra flashlog_test.c flashlog.c -o flashlog_test && ./flashlog_test [-s seed] [-v]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "flashlog.h"
+
+#define PAGESZ      (2048)
+#define NPAGES      (6)
+
+static int verbose = 0;
+static uint8_t simflash[NPAGES * PAGESZ] __attribute__((aligned(8)));
+static uint32_t simerases[NPAGES];
+static int busy = 0, erasefail = 0;
+
+int flashlog_program(const uint8_t *addr, const void *data, uint32_t len){
+    uint8_t *dst = (uint8_t*)addr;
+    if(dst < simflash || dst + len > simflash + sizeof(simflash) || ((dst - simflash) & 1)) return 1;
+    const uint8_t *src = (const uint8_t*)data;
+    for(uint32_t i = 0; i < len; i += 2){
+        if(dst[i] != 0xff || dst[i+1] != 0xff) return 1; // not erased
+        dst[i] = src[i];
+        dst[i+1] = src[i+1];
+    }
+    return 0;
+}
+
+int flashlog_erasepage(const uint8_t *page){
+    uint32_t n = (page - simflash) / PAGESZ;
+    if(n >= NPAGES || page != simflash + n * PAGESZ) return 1;
+    if(erasefail) return 1;
+    memset(simflash + n * PAGESZ, 0xff, PAGESZ);
+    ++simerases[n];
+    return 0;
+}
+
+int flashlog_busy(){
+    return busy;
+}
+
+static int chkfail(const char *what, int bad){
+    printf("%s: %s\n", what, bad ? "FAILED" : "OK");
+    return bad;
+}
+
+static void clearflash(){
+    memset(simflash, 0xff, sizeof(simflash));
+    memset(simerases, 0, sizeof(simerases));
+}
+
+static flashlog_cfg mkcfg(uint32_t npages, uint32_t recsz){
+    flashlog_cfg c = {.area = simflash, .npages = npages, .pagesz = PAGESZ, .recsz = recsz};
+    return c;
+}
+
+// payload of record `seq`: its length and bytes
+static uint32_t paylen(uint32_t seq, uint32_t recsz){
+    return seq % (recsz - sizeof(flashlog_hdr) + 1);
+}
+static uint8_t paybyte(uint32_t seq, uint32_t i){
+    return (uint8_t)(seq * 7 + i * 13 + 1);
+}
+
+static int put(uint32_t recsz){
+    flashlog_stat s;
+    flashlog_getstat(&s);
+    uint8_t buf[PAGESZ];
+    uint32_t l = paylen(s.seq, recsz);
+    for(uint32_t i = 0; i < l; ++i) buf[i] = paybyte(s.seq, i);
+    return flashlog_put(s.seq ^ 0x5a5a5a5a, buf, l);
+}
+
+// dump into `dump` buffer
+static uint8_t dump[NPAGES * PAGESZ + PAGESZ];
+static uint32_t dumplen = 0;
+static void send(const uint8_t *buf, uint32_t len){
+    memcpy(dump + dumplen, buf, len);
+    dumplen += len;
+}
+
+/**
+ * @brief chkdump - check records in dump: consecutive seq ending with `last`, right T and payload
+ * @param recsz - record size
+ * @param last - seq of last record
+ * @param minrec, maxrec - range of amount of records
+ * @return 0 if OK
+ */
+static int chkdump(uint32_t recsz, uint32_t last, uint32_t minrec, uint32_t maxrec){
+    dumplen = 0;
+    uint32_t n = flashlog_dump(send);
+    if(n * recsz != dumplen || n != flashlog_dump(NULL)){
+        if(verbose) printf("\tdump: %u records, %u bytes\n", n, dumplen);
+        return 1;
+    }
+    if(n < minrec || n > maxrec){
+        if(verbose) printf("\tdump: %u records instead of %u..%u\n", n, minrec, maxrec);
+        return 1;
+    }
+    for(uint32_t k = 0; k < n; ++k){
+        const uint8_t *r = dump + k * recsz;
+        flashlog_hdr h;
+        memcpy(&h, r, sizeof(h));
+        uint32_t seq = last + 1 - n + k;
+        if(h.seq != seq || h.T != (seq ^ 0x5a5a5a5a)){
+            if(verbose) printf("\trecord %u: seq=%u, T=0x%08x; should be %u\n", k, h.seq, h.T, seq);
+            return 1;
+        }
+        uint32_t l = paylen(seq, recsz);
+        for(uint32_t i = 0; i < recsz - sizeof(h); ++i){
+            uint8_t b = (i < l) ? paybyte(seq, i) : 0;
+            if(r[sizeof(h) + i] != b){
+                if(verbose) printf("\trecord %u (seq %u): byte %u is 0x%02x instead of 0x%02x\n", k, seq, i, r[sizeof(h) + i], b);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static const uint32_t recsizes[] = {16, 24, 56, 64, 136, 256, 2048};
+#define NSIZES  (sizeof(recsizes)/sizeof(recsizes[0]))
+
+static int chkformat(){
+    int bad = 0;
+    for(uint32_t k = 0; k < NSIZES && !bad; ++k){
+        uint32_t recsz = recsizes[k], rpp = PAGESZ / recsz;
+        clearflash();
+        flashlog_cfg c = mkcfg(NPAGES, recsz);
+        if(flashlog_init(&c)){
+            bad = 1;
+            break;
+        }
+        bad |= chkdump(recsz, 0xffffffff, 0, 0);
+        flashlog_stat s;
+        flashlog_getstat(&s);
+        uint32_t writes = s.writes; // statistics isn't cleared by init
+        // too long payload
+        uint8_t buf[PAGESZ];
+        bad |= flashlog_put(0, buf, recsz - sizeof(flashlog_hdr) + 1) != 1;
+        // less than page: all in RAM
+        for(uint32_t i = 0; i < rpp - 1 && !bad; ++i) bad |= put(recsz);
+        flashlog_getstat(&s);
+        bad |= s.pending != rpp - 1 || s.writes != writes || s.capacity != rpp * NPAGES;
+        bad |= chkdump(recsz, rpp - 2, rpp - 1, rpp - 1);
+        // flush and check flash content directly
+        bad |= flashlog_flush();
+        bad |= chkdump(recsz, rpp - 2, rpp - 1, rpp - 1);
+        for(uint32_t i = 0; i < rpp - 1 && !bad; ++i) bad |= memcmp(simflash + i * recsz, dump + i * recsz, recsz) != 0;
+        bad |= put(recsz); // page is full: written automatically
+        flashlog_getstat(&s);
+        bad |= s.pending != 0 || s.headpage != 1 || s.seq != rpp;
+        bad |= chkdump(recsz, rpp - 1, rpp, rpp);
+        if(bad && verbose) printf("\trecord size %u\n", recsz);
+    }
+    // wrong configurations
+    uint32_t wrong[][3] = {{1, PAGESZ, 64}, {NPAGES, PAGESZ, 60}, {NPAGES, PAGESZ, 8}, {NPAGES, 1024, 2048}, {NPAGES, 4096, 64}};
+    for(uint32_t i = 0; i < sizeof(wrong)/sizeof(wrong[0]); ++i){
+        flashlog_cfg c = {.area = simflash, .npages = wrong[i][0], .pagesz = wrong[i][1], .recsz = wrong[i][2]};
+        bad |= flashlog_init(&c) != 1 || put(64) != 1 || flashlog_dump(NULL) != 0;
+    }
+    return chkfail("record format", bad);
+}
+
+// many wraps with random flushes and reboots (RAM buffer is lost on reboot)
+static int chkwrap(){
+    int bad = 0;
+    for(uint32_t k = 0; k < NSIZES && !bad; ++k){
+        uint32_t recsz = recsizes[k], rpp = PAGESZ / recsz;
+        uint32_t npages = 2 + k % (NPAGES - 1);
+        clearflash();
+        flashlog_cfg c = mkcfg(npages, recsz);
+        flashlog_init(&c);
+        uint32_t n = 20 * npages * rpp, stored = 0; // `stored` - amount of records in flash and buffer
+        for(uint32_t i = 0; i < n && !bad; ++i){
+            bad |= put(recsz);
+            flashlog_stat s;
+            flashlog_getstat(&s);
+            if(++stored > (npages - 1) * rpp + s.pending) stored = (npages - 1) * rpp + s.pending;
+            if(0 == lrand48() % 50) bad |= flashlog_flush();
+            if(0 == lrand48() % 100){ // reboot
+                stored -= s.pending;
+                flashlog_init(&c);
+            }
+            flashlog_getstat(&s);
+            if(s.seq){
+                uint32_t minrec = (stored < s.pending) ? s.pending : stored;
+                bad |= chkdump(recsz, s.seq - 1, minrec, npages * rpp);
+            }
+        }
+        // each page is erased ~ the same number of times
+        uint32_t mn = 0xffffffff, mx = 0;
+        for(uint32_t i = 0; i < npages; ++i){
+            if(simerases[i] < mn) mn = simerases[i];
+            if(simerases[i] > mx) mx = simerases[i];
+        }
+        if(mx - mn > 1 || mx < 10){ // ~20 wraps, but records in buffer are lost on reboots
+            if(verbose) printf("\tpage erasings: %u..%u\n", mn, mx);
+            bad = 1;
+        }
+        if(bad && verbose) printf("\trecord size %u, %u pages\n", recsz, npages);
+    }
+    return chkfail("wrap-around and reboots", bad);
+}
+
+static int chkbusy(){
+    int bad = 0;
+    const uint32_t recsz = 64, rpp = PAGESZ / recsz;
+    clearflash();
+    flashlog_cfg c = mkcfg(3, recsz);
+    flashlog_init(&c);
+    for(uint32_t i = 0; i < 3 * rpp; ++i) put(recsz); // now head page is 0
+    busy = 1;
+    for(uint32_t i = 0; i < rpp; ++i) bad |= put(recsz);
+    flashlog_stat s;
+    flashlog_getstat(&s);
+    bad |= s.pending != rpp || s.lost != 0;
+    bad |= put(recsz) != 1 || flashlog_flush() != 1 || flashlog_erase() != 1;
+    flashlog_getstat(&s);
+    bad |= s.lost != 1;
+    bad |= chkdump(recsz, 4 * rpp - 1, 3 * rpp, 3 * rpp);
+    busy = 0;
+    bad |= flashlog_flush();
+    flashlog_getstat(&s);
+    bad |= s.pending != 0 || s.seq != 4 * rpp;
+    bad |= chkdump(recsz, 4 * rpp - 1, 2 * rpp, 2 * rpp);
+    // erase: empty log from seq 0
+    bad |= flashlog_erase();
+    bad |= flashlog_dump(NULL) != 0;
+    bad |= put(recsz);
+    bad |= chkdump(recsz, 0, 1, 1);
+    return chkfail("busy flash", bad);
+}
+
+// erasing fails (or power lost before erasing): records wait in buffer, next page is erased later
+static int chkerasefail(){
+    int bad = 0;
+    const uint32_t recsz = 128, rpp = PAGESZ / recsz;
+    clearflash();
+    flashlog_cfg c = mkcfg(2, recsz);
+    flashlog_init(&c);
+    for(uint32_t i = 0; i < 2 * rpp - 1; ++i) bad |= put(recsz);
+    // both pages will be full, page 0 should be erased then
+    erasefail = 1;
+    for(uint32_t i = 0; i < rpp + 1; ++i) bad |= put(recsz);
+    flashlog_stat s;
+    flashlog_getstat(&s);
+    bad |= s.headpage != 0 || s.pending != rpp;
+    bad |= chkdump(recsz, 3 * rpp - 1, 2 * rpp, 2 * rpp); // old page 0 isn't in dump
+    // reboot: page 1 is head and it's full
+    flashlog_init(&c);
+    bad |= chkdump(recsz, 2 * rpp - 1, rpp, rpp);
+    erasefail = 0;
+    bad |= flashlog_flush();
+    bad |= put(recsz) || flashlog_flush();
+    bad |= chkdump(recsz, 2 * rpp, rpp + 1, rpp + 1);
+    flashlog_init(&c);
+    bad |= chkdump(recsz, 2 * rpp, rpp + 1, rpp + 1);
+    return chkfail("failed erasing", bad);
+}
+
+static void usage(const char *self){
+    fprintf(stderr, "Usage: %s [options]\n", self);
+    fprintf(stderr, "\t-s - seed for random generator\n");
+    fprintf(stderr, "\t-v - verbose\n");
+    exit(1);
+}
+
+int main(int argc, char **argv){
+    int opt;
+    long seed = 1;
+    while((opt = getopt(argc, argv, "s:v")) != -1){
+        switch(opt){
+            case 's':
+                seed = atol(optarg);
+            break;
+            case 'v':
+                ++verbose;
+            break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    srand48(seed);
+    int ret = chkformat();
+    ret |= chkwrap();
+    ret |= chkbusy();
+    ret |= chkerasefail();
+    printf("%s\n", ret ? "FAILED" : "OK");
+    return ret ? 2 : 0;
+}
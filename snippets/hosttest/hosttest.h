@@ -0,0 +1,62 @@
+/*
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Common part of host checkers (included once, by main.c; Makefile fragment hosttest.mk adds include path).
+// Checker returns 0 if all checks passed, 2 if some failed and 1 on wrong arguments.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// verbosity level (`-v` could be repeated)
+static int verbose __attribute__((unused)) = 0;
+
+// print result of check `what`; @return `bad`
+static inline int chkfail(const char *what, int bad){
+    printf("%s: %s\n", what, bad ? "FAILED" : "OK");
+    return bad;
+}
+
+// print summary; @return exit code
+static inline int hosttest_result(int ret){
+    printf("%s\n", ret ? "FAILED" : "OK");
+    return ret ? 2 : 0;
+}
+
+// standard options of checkers without own ones: `-s seed` (random generator is initialized by it) and `-v`
+static inline void hosttest_opts(int argc, char **argv){
+    int opt;
+    long seed = 1;
+    while((opt = getopt(argc, argv, "s:v")) != -1){
+        switch(opt){
+            case 's':
+                seed = atol(optarg);
+            break;
+            case 'v':
+                ++verbose;
+            break;
+            default:
+                fprintf(stderr, "Usage: %s [options]\n", argv[0]);
+                fprintf(stderr, "\t-s - seed for random generator\n");
+                fprintf(stderr, "\t-v - verbose (could be repeated)\n");
+                exit(1);
+        }
+    }
+    srand48(seed);
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "timfactor.h"
+
+#if TIMFACTOR_NITER
+uint32_t timfactor_niter = 0;
+#define NITER(c)    do{++(c)->niter;}while(0)
+#else
+#define NITER(c)
+#endif
+
+// primes < 256: residue after dividing by them is prime if it's less than 257^2
+static const uint8_t primes[] = {
+      2,   3,   5,   7,  11,  13,  17,  19,  23,  29,  31,  37,  41,  43,  47,  53,
+     59,  61,  67,  71,  73,  79,  83,  89,  97, 101, 103, 107, 109, 113, 127, 131,
+    137, 139, 149, 151, 157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223,
+    227, 229, 233, 239, 241, 251
+};
+#define NPRIMES     (sizeof(primes))
+// max amount of different prime divisors of 32-bit number
+#define MAXFACTORS  (10)
+
+// state of one timfactor() call
+typedef struct{
+    uint32_t fact[MAXFACTORS];  // factors (last could be composite if it's >= 257^2)
+    uint8_t pwr[MAXFACTORS];    // and their powers
+    uint8_t nfact;
+    uint32_t dmin, dbest;       // limits and result of divisors search
+#if TIMFACTOR_NITER
+    uint32_t niter;
+#endif
+} tfctx_t;
+
+// find least divisor of N >= dmin among products of fact[i..]
+static void divsearch(tfctx_t *c, uint8_t i, uint32_t d){
+    NITER(c);
+    if(d >= c->dbest) return;
+    if(d >= c->dmin){
+        c->dbest = d;
+        return;
+    }
+    if(i == c->nfact) return;
+    for(uint8_t k = 0; k <= c->pwr[i]; ++k){
+        divsearch(c, i + 1, d);
+        d *= c->fact[i];
+        if(d >= c->dbest) break;
+    }
+}
+
+// floor(sqrt(x))
+static uint32_t isqrt(uint32_t x){
+    uint32_t r = 0;
+    for(uint32_t b = 1UL << 30; b; b >>= 2){
+        if(x >= r + b){
+            x -= r + b;
+            r = (r >> 1) + b;
+        }else r >>= 1;
+    }
+    return r;
+}
+
+/**
+ * @brief timfactor - find PSC+1 and ARR+1 for given period
+ * @param N - period in timer clock ticks
+ * @param P - prescaler divider (PSC = P - 1)
+ * @param A - autoreload divider (ARR = A - 1)
+ * @return |N - P*A|
+ */
+uint32_t timfactor(uint32_t N, uint16_t *P, uint16_t *A){
+    tfctx_t c;
+#if TIMFACTOR_NITER
+    c.niter = 0;
+#define RETURN(x)   do{timfactor_niter = c.niter; return (x);}while(0)
+#else
+#define RETURN(x)   return (x)
+#endif
+    if(N == 0) N = 1;
+    if(N <= 0xffff){
+        *P = 1; *A = (uint16_t)N;
+        RETURN(0);
+    }
+    if(N >= 0xffffUL * 0xffffUL){
+        *P = *A = 0xffff;
+        RETURN(N - 0xffffUL * 0xffffUL);
+    }
+    // factorize N by small primes, the rest is one factor
+    uint32_t r = N;
+    c.nfact = 0;
+    for(uint8_t i = 0; i < NPRIMES; ++i){
+        uint32_t p = primes[i];
+        NITER(&c);
+        if(p * p > r) break;
+        if(r % p) continue;
+        c.fact[c.nfact] = p; c.pwr[c.nfact] = 0;
+        do{
+            r /= p;
+            ++c.pwr[c.nfact];
+        }while(r % p == 0);
+        ++c.nfact;
+    }
+    if(r > 1){ c.fact[c.nfact] = r; c.pwr[c.nfact++] = 1; }
+    c.dmin = (N + 0xfffe) / 0xffff; c.dbest = 0x10000;
+    divsearch(&c, 0, 1);
+    if(c.dbest < 0x10000){ // found exact decomposition
+        *P = (uint16_t)c.dbest; *A = (uint16_t)(N / c.dbest);
+        RETURN(0);
+    }
+    /*
+     * full search by smaller divider: for given P the best A is round(N/P); smaller divider of best pair
+     * lays in [N/65536, sqrt(N)+1], so no more than 16386 iterations (N = 2^30)
+     */
+    uint32_t err = 0xffffffff, pmax = isqrt(N) + 1;
+    if(pmax > 0xffff) pmax = 0xffff;
+    for(uint32_t p = N >> 16; p <= pmax; ++p){
+        NITER(&c);
+        uint32_t a = (N + p/2) / p;
+        if(a > 0xffff) a = 0xffff;
+        uint32_t x = p * a, e = (x > N) ? x - N : N - x;
+        if(e < err){
+            err = e; *P = (uint16_t)p; *A = (uint16_t)a;
+            if(e == 0) break; // composite big factor could hide exact decomposition
+        }
+    }
+    RETURN(err);
+#undef RETURN
+}
+
+/**
+ * @brief timfreq - find PSC+1 and ARR+1 for given frequency
+ * @param clk - timer clock frequency (Hz)
+ * @param freq - target frequency (Hz)
+ * @param P, A - dividers (PSC = P - 1, ARR = A - 1)
+ * @return error of period (in clock ticks)
+ */
+uint32_t timfreq(uint32_t clk, uint32_t freq, uint16_t *P, uint16_t *A){
+    if(freq == 0) freq = 1;
+    return timfactor(TIMFREQ_N(clk, freq), P, A);
+}
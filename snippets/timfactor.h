@@ -0,0 +1,77 @@
+/*
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Split timer period N (in timer clock ticks) into two 16-bit dividers: N ~= P * A,
+ * P = PSC + 1, A = ARR + 1 (both 1..65535); `timfactor` returns |N - P*A| (the least possible).
+ * First it looks for exact decomposition (divisors of N built from its factors by primes < 256),
+ * if there's no such - searches smaller divider in [N/65536, sqrt(N)+1].
+ * Usually it takes some hundreds of iterations, not more than ~18k (N ~ 2^30 without exact decomposition).
+ * Reentrant (all state is local) except of `timfactor_niter` debugging counter.
+ */
+
+// set to 1 to count iterations
+#ifndef TIMFACTOR_NITER
+#define TIMFACTOR_NITER     0
+#endif
+
+// compile-time variant (closed form, error <= P/2): minimal prescaler and rounded ARR
+#define TIMFACTOR_P(N)      ((uint16_t)(((N) + 65534UL) / 65535UL))
+#define TIMFACTOR_A(N)      ((uint16_t)(((N) + TIMFACTOR_P(N)/2) / TIMFACTOR_P(N)))
+// the same by clock and frequency
+#define TIMFREQ_N(clk, f)   (((clk) + (f)/2) / (f))
+
+#if TIMFACTOR_NITER
+// amount of iterations made by last call
+extern uint32_t timfactor_niter;
+#endif
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+uint32_t timfactor(uint32_t N, uint16_t *P, uint16_t *A);
+uint32_t timfreq(uint32_t clk, uint32_t freq, uint16_t *P, uint16_t *A);
+#ifdef __cplusplus
+}
+
+// constexpr variant: best (minimal error, then minimal P) decomposition by full search
+struct timfactor_t{
+    uint16_t P, A;
+    uint32_t err;
+};
+
+constexpr timfactor_t timfactor_ce(uint32_t N){
+    if(N == 0) N = 1;
+    if(N <= 0xffff) return {1, (uint16_t)N, 0};
+    if(N >= 0xffffUL * 0xffffUL) return {0xffff, 0xffff, (uint32_t)(N - 0xffffUL * 0xffffUL)};
+    timfactor_t best{0xffff, 0xffff, 0xffffffffUL};
+    for(uint32_t p = (N + 0xfffeUL) / 0xffffUL; p <= 0xffff; ++p){
+        uint32_t a = (N + p/2) / p;
+        if(a > 0xffff) a = 0xffff;
+        uint32_t x = p * a, err = (x > N) ? x - N : N - x;
+        if(err < best.err){
+            best = {(uint16_t)p, (uint16_t)a, err};
+            if(err == 0) break;
+        }
+    }
+    return best;
+}
+#endif
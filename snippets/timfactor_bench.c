@@ -0,0 +1,191 @@
+/*
+ * Copyright 2026 Edward V. Emelianov <edward.emelianoff@gmail.com>.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host benchmark of timfactor() against factorize2.c and full search; also checks that timfactor()
+// gives the least possible error (full search) for known hard periods, random periods and
+// products of primes > 256
+// gcc -O2 timfactor_bench.c -o timfactor_bench && ./timfactor_bench [N]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define TIMFACTOR_NITER     1
+#include "timfactor.c"
+
+// copy of factorize() from factorize2.c
+static uint16_t factorize(uint32_t in, uint16_t *o1, uint16_t *o2, uint16_t *niter){
+    uint16_t min = 0xffff, minI = 2, i;
+    *niter = 0;
+    uint16_t start = (uint16_t)(in / 0xffff);
+    if(start < 2) start = 2;
+    for(i = start; i < 0xffff; ++i){
+        ++(*niter);
+        uint32_t a = in/i;
+        if(a > 0xffff) continue;
+        uint16_t d = in - i*a;
+        if(d < min){
+            min = d; minI = i;
+        }
+        if(min == 0) break;
+    }
+    *o1 = in/minI;
+    *o2 = minI;
+    return min;
+}
+
+static double dtime(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+typedef struct{
+    double niter, err, relerr, exact;
+    uint32_t maxiter, maxerr;
+    double t;
+} stat_t;
+
+static void addstat(stat_t *s, uint32_t n, uint32_t N, uint32_t err){
+    s->niter += n;
+    if(n > s->maxiter) s->maxiter = n;
+    s->err += err;
+    if(err > s->maxerr) s->maxerr = err;
+    s->relerr += (double)err / N;
+    if(err == 0) ++s->exact;
+}
+
+static void prstat(const char *name, const stat_t *s, double N){
+    printf("%-10s <niter>=%-9.1f max=%-6u <err>=%-8.2f max=%-6u <relerr>=%-9.3g exact=%5.1f%% %.3gus/call\n",
+        name, s->niter/N, s->maxiter, s->err/N, s->maxerr, s->relerr/N, s->exact/N*100., s->t/N*1e6);
+}
+
+// full search of the least error (the same as timfactor_ce())
+static uint32_t fullsearch(uint32_t N, uint32_t *niter){
+    uint32_t best = 0xffffffff;
+    *niter = 0;
+    for(uint32_t p = (N + 0xfffe) / 0xffff; p <= 0xffff; ++p){
+        ++(*niter);
+        uint32_t a = (N + p/2) / p;
+        if(a > 0xffff) a = 0xffff;
+        uint32_t x = p * a, err = (x > N) ? x - N : N - x;
+        if(err < best){
+            best = err;
+            if(err == 0) break;
+        }
+    }
+    return best;
+}
+
+static int isprimeslow(uint32_t n){
+    if(n < 2) return 0;
+    for(uint32_t d = 2; d * d <= n; ++d) if(n % d == 0) return 0;
+    return 1;
+}
+
+static uint32_t bigprime(){
+    uint32_t p;
+    do p = 257 + lrand48() % (0xffff - 257); while(!isprimeslow(p));
+    return p;
+}
+
+// check one period: returned error should be right and zero if exact decomposition exists
+static int chkone(uint32_t N){
+    uint16_t P, A;
+    uint32_t e = timfactor(N, &P, &A), x = (uint32_t)P * A, n;
+    if(P == 0 || A == 0 || e != (x > N ? x - N : N - x) || e != fullsearch(N, &n)){
+        printf("timfactor(%u): P=%u, A=%u, err=%u\n", N, P, A, e);
+        return 1;
+    }
+    return 0;
+}
+
+static int chkexact(int n){
+    int bad = 0;
+    // products of big primes: cofactor after dividing by primes < 256 isn't prime
+    const uint32_t hard[] = {70747 /* 263*269 */, 495229 /* 7*263*269 */, 4292870399U /* 65519*65521 */,
+        18181979 /* 257*263*269 (no exact) */, 1073741827 /* prime ~2^30 */, 1073741789 /* prime <2^30 */, 66049 /* 257^2 */, 16974593 /* 257^3 */, 4294836225U /* 65535^2 */,
+        2 * 3 * 5 * 7 * 11 * 13 * 17 * 19 * 23, 1048576U * 4093, 65537 * 65521U, 65537};
+    for(size_t i = 0; i < sizeof(hard)/sizeof(hard[0]); ++i) bad += chkone(hard[i]);
+    for(int i = 0; i < n; ++i){
+        uint32_t N;
+        do N = (uint32_t)mrand48(); while(N < 0x10000 || N >= 0xffffUL*0xffffUL);
+        bad += chkone(N);
+        // two or three big primes with random small part
+        uint64_t M;
+        do{
+            M = (uint64_t)bigprime() * bigprime();
+            if(lrand48() & 1) M *= bigprime();
+            M *= 1 + lrand48() % 64;
+        }while(M >= 0xffffUL*0xffffUL);
+        bad += chkone((uint32_t)M);
+    }
+    printf("least errors (%d known, %d random, %d products of big primes): %s\n",
+           (int)(sizeof(hard)/sizeof(hard[0])), n, n, bad ? "FAILED" : "OK");
+    return bad;
+}
+
+int main(int argc, char **argv){
+    int Nrnd = 100000;
+    if(argc > 1) Nrnd = atoi(argv[1]);
+    if(Nrnd < 1) Nrnd = 1;
+    uint32_t *in = malloc(Nrnd * sizeof(uint32_t));
+    srand48(time(NULL));
+    // factorize2 can't work with N >= 0xffff*0xffff (uint16_t overflow) or N < 0x10000
+    for(int i = 0; i < Nrnd; ++i){
+        do in[i] = (uint32_t)mrand48(); while(in[i] < 0x10000 || in[i] >= 0xffffUL*0xffffUL);
+    }
+    stat_t s1 = {0}, s2 = {0}, s4 = {0};
+    uint16_t P, A, n;
+    uint32_t nf;
+    volatile uint32_t sink = 0; // don't let compiler throw away calls
+    double t0 = dtime();
+    for(int i = 0; i < Nrnd; ++i) sink += factorize(in[i], &P, &A, &n);
+    s1.t = dtime() - t0;
+    t0 = dtime();
+    for(int i = 0; i < Nrnd; ++i) sink += timfactor(in[i], &P, &A);
+    s2.t = dtime() - t0;
+    t0 = dtime();
+    for(int i = 0; i < Nrnd; ++i) sink += fullsearch(in[i], &nf);
+    s4.t = dtime() - t0;
+    int bad = 0;
+    for(int i = 0; i < Nrnd; ++i){
+        uint32_t e = factorize(in[i], &P, &A, &n);
+        addstat(&s1, n, in[i], e);
+        uint32_t ef = fullsearch(in[i], &nf);
+        addstat(&s4, nf, in[i], ef);
+        e = timfactor(in[i], &P, &A);
+        addstat(&s2, timfactor_niter, in[i], e);
+        uint32_t x = (uint32_t)P * A;
+        if(P == 0 || A == 0 || e != (x > in[i] ? x - in[i] : in[i] - x) || e != ef) ++bad;
+    }
+    printf("%d random periods in [0x10000, 0xffff*0xffff)\n", Nrnd);
+    prstat("factorize2", &s1, Nrnd);
+    prstat("fullsearch", &s4, Nrnd);
+    prstat("timfactor", &s2, Nrnd);
+    // closed form (compile-time macros)
+    stat_t s3 = {0};
+    for(int i = 0; i < Nrnd; ++i){
+        uint32_t x = (uint32_t)TIMFACTOR_P(in[i]) * TIMFACTOR_A(in[i]);
+        addstat(&s3, 1, in[i], x > in[i] ? x - in[i] : in[i] - x);
+    }
+    prstat("macros", &s3, Nrnd);
+    if(bad) printf("%d WRONG results!\n", bad);
+    free(in);
+    bad += chkexact(2000);
+    return bad ? 1 : 0;
+}